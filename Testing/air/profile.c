@@ -0,0 +1,97 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/air.h"
+
+/*
+** Tests:
+** airProfileTotal sums the counts of all threads, including those that
+**   have finished
+** the records of finished threads are released: after airProfileReset,
+**   only the calling thread's record remains
+**
+** Also uses:
+** airProfileEnable, airProfileReset, airProfileCount
+** airThreadRun
+*/
+
+#define THREAD_NUM 4
+#define ROUND_NUM 20
+
+typedef struct {
+  unsigned int idx;
+} profTask;
+
+static void *
+profBody(void *_task) {
+  profTask *task = (profTask *)_task;
+
+  airProfileCount(airProfileKernelEval, 1000 + task->idx);
+  return _task;
+}
+
+int
+main(int argc, const char *argv[]) {
+  profTask task[THREAD_NUM];
+  double count[AIR_PROFILE_MAX+1], want;
+  unsigned int ti, ri, num, wantNum, failIdx;
+
+  AIR_UNUSED(argc);
+  airProfileEnable(AIR_TRUE);
+  airProfileReset();
+  airProfileCount(airProfileGageProbe, 5);
+  want = 0;
+  for (ri=0; ri<ROUND_NUM; ri++) {
+    for (ti=0; ti<THREAD_NUM; ti++) {
+      task[ti].idx = ti;
+      want += 1000 + ti;
+    }
+    failIdx = airThreadRun(THREAD_NUM, profBody, task, sizeof(profTask),
+                           NULL, NULL);
+    if (failIdx) {
+      fprintf(stderr, "%s: couldn't start thread %u\n", argv[0], failIdx);
+      return 1;
+    }
+  }
+  num = airProfileTotal(count, NULL);
+  /* task 0 runs in this thread; without threads, all of them do */
+  wantNum = airThreadCapable ? 1 + ROUND_NUM*(THREAD_NUM-1) : 1;
+  if (5 != count[airProfileGageProbe] || want != count[airProfileKernelEval]
+      || wantNum != num) {
+    fprintf(stderr, "%s: got counts %g, %g from %u threads; "
+            "wanted 5, %g from %u\n", argv[0], count[airProfileGageProbe],
+            count[airProfileKernelEval], num, want, wantNum);
+    return 1;
+  }
+  airProfileReset();
+  num = airProfileTotal(count, NULL);
+  if (0 != count[airProfileGageProbe] || 0 != count[airProfileKernelEval]
+      || 1 != num) {
+    fprintf(stderr, "%s: after reset, got counts %g, %g from %u threads; "
+            "wanted 0, 0 from 1\n", argv[0], count[airProfileGageProbe],
+            count[airProfileKernelEval], num);
+    return 1;
+  }
+  airProfileEnable(AIR_FALSE);
+  return 0;
+}
@@ -0,0 +1,213 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/alan.h"
+
+/*
+** Tests:
+** alanRun results (morphogens, averageChange, stop, iter) are identical
+**   for any number of threads, in 2D and 3D, with and without wrapping
+** with a single texel per row, each texel is only updated once
+** a non-existent update outranks divergence, no matter which thread
+**   finds which
+*/
+
+static alanContext *
+setup(airArray *mop, unsigned int dim, const unsigned int size[3],
+      int wrap, int threadNum, int maxIter, double maxPixelChange) {
+  static const char me[]="setup";
+  alanContext *actx;
+  int E;
+
+  actx = alanContextNew();
+  airMopAdd(mop, actx, (airMopper)alanContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= alanDimensionSet(actx, AIR_INT(dim));
+  if (!E) E |= (2 == dim
+                ? alan2DSizeSet(actx, AIR_INT(AIR_MAX(10, size[0])),
+                                AIR_INT(size[1]))
+                : alan3DSizeSet(actx, AIR_INT(size[0]), AIR_INT(size[1]),
+                                AIR_INT(size[2])));
+  if (!E && 1 == size[0]) {
+    /* the size setters insist on 10 or more texels along each axis,
+       but a single column is possible via alanTensorSet */
+    actx->size[0] = 1;
+  }
+  if (!E) E |= alanParmSet(actx, alanParmTextureType, alanTextureTypeTuring);
+  if (!E) E |= alanParmSet(actx, alanParmWrapAround, wrap);
+  if (!E) E |= alanParmSet(actx, alanParmNumThreads, threadNum);
+  if (!E) E |= alanParmSet(actx, alanParmMaxIteration, maxIter);
+  if (!E) E |= alanParmSet(actx, alanParmSaveInterval, 0);
+  if (!E) E |= alanParmSet(actx, alanParmFrameInterval, 0);
+  if (!E) E |= alanParmSet(actx, alanParmMinAverageChange, 0);
+  if (!E) E |= alanParmSet(actx, alanParmMaxPixelChange, maxPixelChange);
+  if (!E) E |= alanParmSet(actx, alanParmRandRange, 4.0);
+  if (!E) E |= alanParmSet(actx, alanParmK, 0.0125);
+  if (!E) E |= alanParmSet(actx, alanParmDiffA, 0.25);
+  if (!E) E |= alanParmSet(actx, alanParmDiffB, 0.0625);
+  if (!E) E |= alanUpdate(actx);
+  if (E) {
+    char *err;
+    airMopAdd(mop, err = biffGetDone(ALAN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble:\n%s", me, err);
+    return NULL;
+  }
+  return actx;
+}
+
+static int
+run(alanContext *actx, const Nrrd *nlevInit) {
+  static const char me[]="run";
+
+  airSrandMT(4242);
+  if (alanInit(actx, nlevInit, NULL)
+      || alanRun(actx)) {
+    char *err;
+    err = biffGetDone(ALAN);
+    fprintf(stderr, "%s: trouble:\n%s", me, err);
+    free(err);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  alanContext *aref, *atst;
+  unsigned int dim, wrap, yi, sy;
+  int threadNum;
+  static const unsigned int size[2][3] = {{23, 19, 1}, {12, 10, 11}};
+  static const unsigned int size1[3] = {1, 13, 1};
+  double change, lapA, AA, BB, deltaA;
+  Nrrd *ninit;
+  alan_t *init;
+  size_t elNum;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+
+  for (dim=2; dim<=3; dim++) {
+    for (wrap=0; wrap<=1; wrap++) {
+      if (!(aref = setup(mop, dim, size[dim-2], AIR_INT(wrap), 1, 25, 6))
+          || run(aref, NULL)) {
+        airMopError(mop); return 1;
+      }
+      elNum = nrrdElementNumber(aref->nlev);
+      for (threadNum=2; threadNum<=5; threadNum++) {
+        if (!(atst = setup(mop, dim, size[dim-2], AIR_INT(wrap),
+                           threadNum, 25, 6))
+            || run(atst, NULL)) {
+          airMopError(mop); return 1;
+        }
+        if (!( aref->stop == atst->stop
+               && aref->iter == atst->iter
+               && aref->averageChange == atst->averageChange
+               && !memcmp(aref->nlev->data, atst->nlev->data,
+                          elNum*sizeof(alan_t)) )) {
+          fprintf(stderr, "%s: %uD (wrap %u) with %d threads: stop %d, "
+                  "iter %d, averageChange %g; with 1 thread: %d, %d, %g "
+                  "(or morphogens differ)\n", argv[0], dim, wrap,
+                  threadNum, atst->stop, atst->iter, atst->averageChange,
+                  aref->stop, aref->iter, aref->averageChange);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+
+  /* one iteration of a single column of texels, with averageChange
+     recomputed here from the same initial values */
+  ninit = nrrdNew();
+  airMopAdd(mop, ninit, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(ninit, alan_nt, 3, AIR_CAST(size_t, 2),
+                        AIR_CAST(size_t, size1[0]),
+                        AIR_CAST(size_t, size1[1]))) {
+    char *err;
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  init = AIR_CAST(alan_t *, ninit->data);
+  elNum = nrrdElementNumber(ninit);
+  airSrandMT(99);
+  for (yi=0; yi<elNum; yi++) {
+    init[yi] = AIR_CAST(alan_t, 4 + airDrandMT());
+  }
+  if (!(aref = setup(mop, 2, size1, AIR_FALSE, 1, 1, 100))
+      || run(aref, ninit)) {
+    airMopError(mop); return 1;
+  }
+  sy = size1[1];
+  change = 0;
+  for (yi=0; yi<sy; yi++) {
+    AA = init[0 + 2*yi];
+    BB = init[1 + 2*yi];
+    lapA = (init[0 + 2*(yi ? yi-1 : 0)]
+            + init[0 + 2*(yi < sy-1 ? yi+1 : yi)] - 2*AA);
+    deltaA = aref->deltaT*(aref->react*aref->K*(aref->alpha - AA*BB)
+                           + aref->diffA/pow(aref->deltaX, 2)*lapA);
+    change += fabs(deltaA);
+  }
+  change /= sy;
+  if (!( fabs(change - aref->averageChange) < 1e-4*change )) {
+    fprintf(stderr, "%s: single-column averageChange %g != expected %g\n",
+            argv[0], aref->averageChange, change);
+    airMopError(mop); return 1;
+  }
+
+  /* a non-existent value in the first row, and one diverging in the
+     last: whatever the threads, non-existence is what's reported */
+  ninit = nrrdNew();
+  airMopAdd(mop, ninit, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(ninit, alan_nt, 3, AIR_CAST(size_t, 2),
+                        AIR_CAST(size_t, size[0][0]),
+                        AIR_CAST(size_t, size[0][1]))) {
+    char *err;
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  init = AIR_CAST(alan_t *, ninit->data);
+  elNum = nrrdElementNumber(ninit);
+  for (yi=0; yi<elNum; yi++) {
+    init[yi] = AIR_CAST(alan_t, 4 + airDrandMT());
+  }
+  init[0 + 2*3] = AIR_CAST(alan_t, AIR_NAN);
+  init[0 + 2*(size[0][0]*size[0][1] - 5)] = 1000;
+  for (threadNum=1; threadNum<=5; threadNum++) {
+    if (!(atst = setup(mop, 2, size[0], AIR_FALSE, threadNum, 10, 6))
+        || run(atst, ninit)) {
+      airMopError(mop); return 1;
+    }
+    if (alanStopNonExist != atst->stop) {
+      fprintf(stderr, "%s: with %d threads, stopped with %s, not %s\n",
+              argv[0], threadNum, airEnumStr(alanStop, atst->stop),
+              airEnumStr(alanStop, alanStopNonExist));
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,230 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/bane.h"
+
+/*
+** Tests:
+** baneMakeHVol with one and with several threads: the histogram volume
+** and the measrVol it leaves behind are supposed to be bit-wise
+** identical for any number of threads, with percentile (and range
+** ratio) inclusions and with absolute inclusions.  Also, giving
+** baneMakeHVol a measrVol from a previous run (with measrVolDone) has
+** to produce the same histogram volume as measuring from scratch.
+*/
+
+#define SIZE 30
+
+/*
+** makes histogram volume hvol and copies the measurement volume to nmv,
+** optionally starting from the previous measurement volume nmvIn
+*/
+static int
+makeHVol(Nrrd *hvol, Nrrd *nmv, Nrrd *nin, int absolute,
+         unsigned int threadNum, const Nrrd *nmvIn) {
+  static const char me[]="makeHVol";
+  baneHVolParm *hvp;
+  baneMeasr *measr;
+  baneInc *inc;
+  baneClip *clip;
+  double parm[BANE_PARM_NUM];
+  airArray *mop;
+  int mtype[3] = {baneMeasrGradMag, baneMeasr2ndDD,
+                  baneMeasrValueAnywhere};
+  unsigned int ai;
+
+  mop = airMopNew();
+  hvp = baneHVolParmNew();
+  airMopAdd(mop, hvp, (airMopper)baneHVolParmNix, airMopAlways);
+  baneHVolParmGKMSInit(hvp);
+  for (ai=0; ai<3; ai++) {
+    measr = baneMeasrNew(mtype[ai], parm);
+    airMopAdd(mop, measr, (airMopper)baneMeasrNix, airMopAlways);
+    if (absolute) {
+      /* generous bounds, well past all measured values */
+      parm[0] = -100;
+      parm[1] = 100;
+      inc = baneIncNew(baneIncAbsolute, measr->range, parm);
+    } else if (ai < 2) {
+      parm[0] = 1024;
+      parm[1] = 5;
+      inc = baneIncNew(baneIncPercentile, measr->range, parm);
+    } else {
+      parm[0] = 1.0;
+      inc = baneIncNew(baneIncRangeRatio, measr->range, parm);
+    }
+    if (!inc) {
+      biffAddf(BANE, "%s: couldn't create inclusion %u", me, ai);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, inc, (airMopper)baneIncNix, airMopAlways);
+    baneHVolParmAxisSet(hvp, ai, 40, measr, inc);
+  }
+  parm[0] = 0.3;
+  clip = baneClipNew(baneClipPeakRatio, parm);
+  airMopAdd(mop, clip, (airMopper)baneClipNix, airMopAlways);
+  baneHVolParmClipSet(hvp, clip);
+  hvp->threadNum = threadNum;
+  hvp->makeMeasrVol = AIR_TRUE;
+  if (nmvIn) {
+    hvp->measrVol = nrrdNew();
+    if (nrrdCopy(hvp->measrVol, nmvIn)) {
+      biffMovef(BANE, NRRD, "%s: couldn't copy measrVol", me);
+      airMopError(mop); return 1;
+    }
+    hvp->measrVolDone = AIR_TRUE;
+  }
+  if (baneMakeHVol(hvol, nin, hvp)) {
+    biffAddf(BANE, "%s: trouble making hvol", me);
+    airMopError(mop); return 1;
+  }
+  if (!( hvp->measrVol && hvp->measrVolDone )) {
+    biffAddf(BANE, "%s: didn't get a filled measrVol", me);
+    airMopError(mop); return 1;
+  }
+  if (nrrdCopy(nmv, hvp->measrVol)) {
+    biffMovef(BANE, NRRD, "%s: couldn't copy measrVol out", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/* returns non-zero if the two nrrds have different data, or (for
+   histogram volumes) different axis min or max */
+static int
+differ(const Nrrd *na, const Nrrd *nb) {
+  unsigned int ai;
+
+  if (na->type != nb->type || na->dim != nb->dim
+      || nrrdElementNumber(na) != nrrdElementNumber(nb)) {
+    return 1;
+  }
+  for (ai=0; ai<na->dim; ai++) {
+    if (na->axis[ai].size != nb->axis[ai].size
+        || !(na->axis[ai].min == nb->axis[ai].min
+             || (!AIR_EXISTS(na->axis[ai].min)
+                 && !AIR_EXISTS(nb->axis[ai].min)))
+        || !(na->axis[ai].max == nb->axis[ai].max
+             || (!AIR_EXISTS(na->axis[ai].max)
+                 && !AIR_EXISTS(nb->axis[ai].max)))) {
+      return 1;
+    }
+  }
+  return !!memcmp(na->data, nb->data,
+                  nrrdElementNumber(na)*nrrdElementSize(na));
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nin, *hvol[2], *nmv[2], *hvolR, *nmvR;
+  float *in;
+  unsigned int xi, yi, zi, ti, threadNum[2] = {1, 3};
+  int absolute;
+  char *err;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  for (ti=0; ti<2; ti++) {
+    hvol[ti] = nrrdNew();
+    airMopAdd(mop, hvol[ti], (airMopper)nrrdNuke, airMopAlways);
+    nmv[ti] = nrrdNew();
+    airMopAdd(mop, nmv[ti], (airMopper)nrrdNuke, airMopAlways);
+  }
+  hvolR = nrrdNew();
+  airMopAdd(mop, hvolR, (airMopper)nrrdNuke, airMopAlways);
+  nmvR = nrrdNew();
+  airMopAdd(mop, nmvR, (airMopper)nrrdNuke, airMopAlways);
+
+  /* noisy sphere: a blurry step from 1 inside to 0 outside */
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, SIZE),
+                        AIR_CAST(size_t, SIZE), AIR_CAST(size_t, SIZE))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  in = AIR_CAST(float *, nin->data);
+  for (zi=0; zi<SIZE; zi++) {
+    for (yi=0; yi<SIZE; yi++) {
+      for (xi=0; xi<SIZE; xi++) {
+        double xx, yy, zz, rr;
+        xx = AIR_AFFINE(0, xi, SIZE-1, -1, 1);
+        yy = AIR_AFFINE(0, yi, SIZE-1, -1, 1);
+        zz = AIR_AFFINE(0, zi, SIZE-1, -1, 1);
+        rr = sqrt(xx*xx + yy*yy + zz*zz);
+        in[xi + SIZE*(yi + SIZE*zi)] =
+          AIR_CAST(float, 1/(1 + exp(10*(rr - 0.6)))
+                   + 0.05*(airDrandMT_r(rng) - 0.5));
+      }
+    }
+  }
+
+  for (absolute=0; absolute<2; absolute++) {
+    for (ti=0; ti<2; ti++) {
+      if (makeHVol(hvol[ti], nmv[ti], nin, absolute, threadNum[ti], NULL)) {
+        airMopAdd(mop, err = biffGetDone(BANE), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble (absolute=%d, %u threads):\n%s",
+                argv[0], absolute, threadNum[ti], err);
+        airMopError(mop); return 1;
+      }
+    }
+    if (differ(hvol[0], hvol[1])) {
+      fprintf(stderr, "%s: (absolute=%d) hvol with %u threads differs "
+              "from hvol with %u\n", argv[0], absolute,
+              threadNum[1], threadNum[0]);
+      airMopError(mop); return 1;
+    }
+    if (differ(nmv[0], nmv[1])) {
+      fprintf(stderr, "%s: (absolute=%d) measrVol with %u threads differs "
+              "from measrVol with %u\n", argv[0], absolute,
+              threadNum[1], threadNum[0]);
+      airMopError(mop); return 1;
+    }
+    /* start again from the measurement volume */
+    for (ti=0; ti<2; ti++) {
+      if (makeHVol(hvolR, nmvR, nin, absolute, threadNum[ti], nmv[0])) {
+        airMopAdd(mop, err = biffGetDone(BANE), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble re-using measrVol (absolute=%d, "
+                "%u threads):\n%s", argv[0], absolute, threadNum[ti], err);
+        airMopError(mop); return 1;
+      }
+      if (differ(hvol[0], hvolR)) {
+        fprintf(stderr, "%s: (absolute=%d, %u threads) hvol from given "
+                "measrVol differs from hvol measured from scratch\n",
+                argv[0], absolute, threadNum[ti]);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,137 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/coil.h"
+
+/*
+** Tests:
+** coilIterate output is bit-identical to that of one unblocked thread,
+** for any number of threads, temporal block size, and slab size,
+** with radius 1 and 2, and for methods with and without parameters
+** that depend on the neighborhood
+*/
+
+#define SX 13
+#define SY 11
+#define SZ 17
+#define ITER 7
+
+static int
+filter(Nrrd *nout, const Nrrd *nin, const coilMethod *method,
+       double parm[COIL_PARMS_NUM], unsigned int radius,
+       unsigned int threadNum, unsigned int blockIter,
+       unsigned int blockSlab) {
+  static const char me[]="filter";
+  coilContext *cctx;
+  airArray *mop;
+
+  mop = airMopNew();
+  cctx = coilContextNew();
+  airMopAdd(mop, cctx, (airMopper)coilContextNix, airMopAlways);
+  if (coilContextAllSet(cctx, nin, coilKindScalar, method,
+                        radius, threadNum, 0 /* verbose */, parm)
+      || coilContextBlockSet(cctx, blockIter, blockSlab)
+      || coilStart(cctx)
+      || coilIterate(cctx, ITER)
+      || coilFinish(cctx)
+      || coilOutputGet(nout, cctx)) {
+    char *err;
+    airMopAdd(mop, err = biffGetDone(COIL), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble (%s, radius %u, %u threads, block %u/%u):"
+            "\n%s", me, method->name, radius, threadNum, blockIter,
+            blockSlab, err);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  Nrrd *nin, *nref, *ntst;
+  float *data;
+  size_t jj;
+  char *err;
+  unsigned int mi, radius, threadNum, bii, bsi;
+  static const unsigned int blockIter[4] = {0, 2, 3, ITER+1},
+    blockSlab[4] = {0, 1, 4, SZ};
+  const coilMethod *method[2];
+  double parm[2][COIL_PARMS_NUM] = {{0.05, 0, 0, 0, 0, 0},
+                                    {0.05, 0.3, 0.5, 0, 0, 0}};
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nref = nrrdNew();
+  airMopAdd(mop, nref, (airMopper)nrrdNuke, airMopAlways);
+  ntst = nrrdNew();
+  airMopAdd(mop, ntst, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, SX),
+                        AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  airSrandMT(4242);
+  data = AIR_CAST(float *, nin->data);
+  for (jj=0; jj<SX*SY*SZ; jj++) {
+    data[jj] = AIR_CAST(float, airDrandMT());
+  }
+  method[0] = coilMethodArray[coilMethodTypeHomogeneous];
+  method[1] = coilMethodArray[coilMethodTypeModifiedCurvature];
+
+  for (mi=0; mi<2; mi++) {
+    for (radius=1; radius<=2; radius++) {
+      if (filter(nref, nin, method[mi], parm[mi], radius, 1, 0, 0)) {
+        airMopError(mop); return 1;
+      }
+      for (threadNum=1; threadNum<=3; threadNum++) {
+        for (bii=0; bii<4; bii++) {
+          for (bsi=0; bsi<4; bsi++) {
+            if (!blockIter[bii] && bsi) {
+              /* slab size moot without blocking */
+              continue;
+            }
+            if (filter(ntst, nin, method[mi], parm[mi], radius, threadNum,
+                       blockIter[bii], blockSlab[bsi])) {
+              airMopError(mop); return 1;
+            }
+            if (memcmp(nref->data, ntst->data, SX*SY*SZ*sizeof(coil_t))) {
+              fprintf(stderr, "%s: %s, radius %u, %u threads, block %u/%u: "
+                      "output differs from unblocked single thread\n",
+                      argv[0], method[mi]->name, radius, threadNum,
+                      blockIter[bii], blockSlab[bsi]);
+              airMopError(mop); return 1;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,129 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/dye.h"
+
+/*
+** Tests:
+** dyeNrrdConvert, without approx, gives exactly what dyeConvert gives
+**   for each color, between any two spaces, for any number of threads
+** with approx, the results differ from dyeConvert's by less than 0.001
+**   for colors within the gamut of RGB [0,1]^3
+**
+** Also uses:
+** dyeColorSet, dyeColorGet
+*/
+
+#define COLOR_NUM 5000
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  Nrrd *nrgb, *nin, *nout;
+  dyeColor col;
+  float *rgb, *in, *out, want[3], got;
+  unsigned int ii, jj, threadNum;
+  int inSpace, outSpace, approx, bad;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  nrgb = nrrdNew();
+  airMopAdd(mop, nrgb, (airMopper)nrrdNuke, airMopAlways);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nout = nrrdNew();
+  airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nrgb, nrrdTypeFloat, 2, AIR_CAST(size_t, 3),
+                        AIR_CAST(size_t, COLOR_NUM))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  airSrandMT(4242);
+  rgb = AIR_CAST(float *, nrgb->data);
+  for (ii=0; ii<3*COLOR_NUM; ii++) {
+    rgb[ii] = AIR_CAST(float, airDrandMT());
+  }
+  /* include the corners of the gamut */
+  for (ii=0; ii<8; ii++) {
+    ELL_3V_SET(rgb + 3*ii, ii & 1, (ii >> 1) & 1, (ii >> 2) & 1);
+  }
+
+  for (inSpace=dyeSpaceUnknown+1; inSpace<dyeSpaceLast; inSpace++) {
+    /* the same in-gamut colors, in inSpace */
+    if (dyeNrrdConvert(nin, nrgb, dyeSpaceRGB, inSpace, AIR_FALSE, 1)) {
+      airMopAdd(mop, err = biffGetDone(DYE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble:\n%s", me, err);
+      airMopError(mop); return 1;
+    }
+    in = AIR_CAST(float *, nin->data);
+    for (outSpace=dyeSpaceUnknown+1; outSpace<dyeSpaceLast; outSpace++) {
+      for (approx=0; approx<=1; approx++) {
+        for (threadNum=1; threadNum<=3; threadNum++) {
+          if (dyeNrrdConvert(nout, nin, inSpace, outSpace, approx,
+                             threadNum)) {
+            airMopAdd(mop, err = biffGetDone(DYE), airFree, airMopAlways);
+            fprintf(stderr, "%s: trouble:\n%s", me, err);
+            airMopError(mop); return 1;
+          }
+          out = AIR_CAST(float *, nout->data);
+          for (ii=0; ii<COLOR_NUM; ii++) {
+            dyeColorSet(&col, inSpace, in[0 + 3*ii], in[1 + 3*ii],
+                        in[2 + 3*ii]);
+            if (dyeConvert(&col, outSpace)) {
+              airMopAdd(mop, err = biffGetDone(DYE), airFree, airMopAlways);
+              fprintf(stderr, "%s: trouble:\n%s", me, err);
+              airMopError(mop); return 1;
+            }
+            dyeColorGet(want + 0, want + 1, want + 2, &col);
+            for (jj=0; jj<3; jj++) {
+              got = out[jj + 3*ii];
+              if (!approx) {
+                /* same bits; black has no LUV hue, giving NaNs */
+                bad = memcmp(&got, want + jj, sizeof(float));
+              } else if (AIR_EXISTS(want[jj])) {
+                bad = !( AIR_ABS(got - want[jj]) < 0.001f );
+              } else {
+                bad = AIR_EXISTS(got);
+              }
+              if (bad) {
+                fprintf(stderr, "%s: %s -> %s (approx %d, %u threads): "
+                        "color %u[%u] is %.9g, not %.9g\n", me,
+                        airEnumStr(dyeSpace, inSpace),
+                        airEnumStr(dyeSpace, outSpace), approx, threadNum,
+                        ii, jj, got, want[jj]);
+                airMopError(mop); return 1;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,189 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/elf.h"
+
+/*
+** Tests:
+** elfBallStickFitVolume_f works with the default elfBallStickVolumeParm
+**   (which only optimizes when levmar is available), and rejects bad
+**   parameters and too few DWIs
+** results are identical for any number of threads, with and without
+**   initialization from the ODF maxima
+** background voxels are skipped, and the stick direction is recovered
+**   in single-stick voxels of noise-free data
+*/
+
+#define DWI_NUM 60
+#define SX 6
+#define SY 5
+#define SZ 4
+#define VOX_NUM (SX*SY*SZ)
+
+/* ball-and-one-stick signal; direction varies along y, and is
+   nearly constant along each x scanline */
+static void
+simulate(float *b0s, float *dwis, float *vdir, const float *grads,
+         float b) {
+  unsigned int xi, yi, zi, gi;
+  for (zi=0; zi<SZ; zi++) {
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        unsigned int vi = xi + SX*(yi + SY*zi);
+        double th = AIR_PI*(yi + 0.5)/SY, ph = 0.3*zi + 0.05*xi, v[3];
+        const double d = 0.002, fiso = 0.3;
+        ELL_3V_SET(v, cos(ph)*sin(th), sin(ph)*sin(th), cos(th));
+        ELL_3V_COPY_TT(vdir + 3*vi, float, v);
+        b0s[vi] = (0 == xi && 0 == zi) ? 0.0f : 1.0f; /* background */
+        for (gi=0; gi<DWI_NUM; gi++) {
+          double dp = ELL_3V_DOT(grads + 3*gi, v);
+          dwis[gi + DWI_NUM*vi] =
+            AIR_CAST(float, b0s[vi]*(fiso*exp(-b*d)
+                                     + (1-fiso)*exp(-b*d*dp*dp)));
+        }
+      }
+    }
+  }
+}
+
+int
+main(int argc, const char **argv) {
+  static const unsigned int size[3] = {SX, SY, SZ};
+  airArray *mop;
+  elfBallStickVolumeParm *vparm;
+  elfBallStickParms *parms, *parms1;
+  elfMaximaContext *emc;
+  float grads[3*DWI_NUM], *b0s, *dwis, *vdir, b = 1000;
+  unsigned int gi, vi, ti, useEmc;
+  int ret;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  vparm = elfBallStickVolumeParmNew();
+  airMopAdd(mop, vparm, (airMopper)elfBallStickVolumeParmNix, airMopAlways);
+  emc = elfMaximaContextNew(tijk_4o3d_sym, 3);
+  airMopAdd(mop, emc, (airMopper)elfMaximaContextNix, airMopAlways);
+  parms = AIR_CALLOC(VOX_NUM, elfBallStickParms);
+  airMopAdd(mop, parms, airFree, airMopAlways);
+  parms1 = AIR_CALLOC(VOX_NUM, elfBallStickParms);
+  airMopAdd(mop, parms1, airFree, airMopAlways);
+  b0s = AIR_CALLOC(VOX_NUM, float);
+  airMopAdd(mop, b0s, airFree, airMopAlways);
+  dwis = AIR_CALLOC(DWI_NUM*VOX_NUM, float);
+  airMopAdd(mop, dwis, airFree, airMopAlways);
+  vdir = AIR_CALLOC(3*VOX_NUM, float);
+  airMopAdd(mop, vdir, airFree, airMopAlways);
+  if (!( vparm && emc && parms && parms1 && b0s && dwis && vdir )) {
+    fprintf(stderr, "%s: couldn't allocate\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+
+  airSrandMT(42);
+  for (gi=0; gi<DWI_NUM; gi++) {
+    double gg[3], len;
+    do {
+      ELL_3V_SET(gg, 2*airDrandMT()-1, 2*airDrandMT()-1, 2*airDrandMT()-1);
+      len = ELL_3V_LEN(gg);
+    } while (!( len > 0.1 && len < 1 ));
+    ELL_3V_SCALE_TT(grads + 3*gi, float, 1.0/len, gg);
+  }
+  simulate(b0s, dwis, vdir, grads, b);
+
+#if TEEM_LEVMAR
+  if (!vparm->optimize) {
+    fprintf(stderr, "%s: with levmar, optimize should default on\n",
+            argv[0]);
+    airMopError(mop); return 1;
+  }
+#else
+  if (vparm->optimize) {
+    fprintf(stderr, "%s: without levmar, optimize should default off\n",
+            argv[0]);
+    airMopError(mop); return 1;
+  }
+  vparm->optimize = 1;
+  ret = elfBallStickFitVolume_f(parms, b0s, dwis, grads, DWI_NUM, b, size,
+                                vparm);
+  if (3 != ret) {
+    fprintf(stderr, "%s: optimizing without levmar returned %d, not 3\n",
+            argv[0], ret);
+    airMopError(mop); return 1;
+  }
+  vparm->optimize = 0;
+#endif
+  vparm->fiberct = 0;
+  ret = elfBallStickFitVolume_f(parms, b0s, dwis, grads, DWI_NUM, b, size,
+                                vparm);
+  if (1 != ret) {
+    fprintf(stderr, "%s: zero sticks returned %d, not 1\n", argv[0], ret);
+    airMopError(mop); return 1;
+  }
+  vparm->fiberct = 1;
+  ret = elfBallStickFitVolume_f(parms, b0s, dwis, grads, 10, b, size,
+                                vparm);
+  if (2 != ret) {
+    fprintf(stderr, "%s: 10 DWIs at order 4 returned %d, not 2\n",
+            argv[0], ret);
+    airMopError(mop); return 1;
+  }
+
+  for (useEmc=0; useEmc<=1; useEmc++) {
+    vparm->emc = useEmc ? emc : NULL;
+    for (ti=1; ti<=4; ti++) {
+      vparm->threadNum = ti;
+      ret = elfBallStickFitVolume_f(ti > 1 ? parms : parms1, b0s, dwis,
+                                    grads, DWI_NUM, b, size, vparm);
+      if (ret) {
+        fprintf(stderr, "%s: fit (emc %u, %u threads) returned %d\n",
+                argv[0], useEmc, ti, ret);
+        airMopError(mop); return 1;
+      }
+      if (ti > 1 && memcmp(parms, parms1, VOX_NUM*sizeof(*parms))) {
+        fprintf(stderr, "%s: fit (emc %u) with %u threads differs from "
+                "with 1\n", argv[0], useEmc, ti);
+        airMopError(mop); return 1;
+      }
+    }
+    for (vi=0; vi<VOX_NUM; vi++) {
+      elfBallStickParms *pp = parms1 + vi;
+      double dot;
+      if (!b0s[vi]) {
+        if (pp->fiberct) {
+          fprintf(stderr, "%s: background voxel %u has %u sticks\n",
+                  argv[0], vi, pp->fiberct);
+          airMopError(mop); return 1;
+        }
+        continue;
+      }
+      dot = ELL_3V_DOT(pp->vs, vdir + 3*vi);
+      if (1 != pp->fiberct || !( fabs(dot) > 0.95 )) {
+        fprintf(stderr, "%s: voxel %u (emc %u): %u sticks, |dot| = %g\n",
+                argv[0], vi, useEmc, pp->fiberct, fabs(dot));
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
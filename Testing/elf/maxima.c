@@ -0,0 +1,165 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/elf.h"
+
+/*
+** Tests:
+** elfMaximaFindBatch gives exactly the same maxima as elfMaximaFind,
+**   in double and single precision, for any number of threads (which
+**   share one elfMaximaContext), truncating to and zero-padding up to
+**   kmax maxima per tensor
+*/
+
+#define TEN_NUM 120
+#define KMAX 2
+
+#define CHECK(TYPE, SUF)                                                \
+  static int                                                            \
+  check_##SUF(const char *me, elfMaximaContext *emc, const TYPE *ten,   \
+              airArray *mop) {                                          \
+    unsigned int num = emc->type->num, nn, ii, ti, *got;                \
+    TYPE *ls, *vs;                                                      \
+                                                                        \
+    ls = AIR_CALLOC(KMAX*TEN_NUM, TYPE);                                \
+    vs = AIR_CALLOC(3*KMAX*TEN_NUM, TYPE);                              \
+    got = AIR_CALLOC(TEN_NUM, unsigned int);                            \
+    airMopAdd(mop, ls, airFree, airMopAlways);                          \
+    airMopAdd(mop, vs, airFree, airMopAlways);                          \
+    airMopAdd(mop, got, airFree, airMopAlways);                         \
+    if (!( ls && vs && got )) {                                         \
+      fprintf(stderr, "%s: couldn't allocate buffers\n", me);           \
+      return 1;                                                         \
+    }                                                                   \
+    for (ti=1; ti<=4; ti++) {                                           \
+      if (elfMaximaFindBatch_##SUF(ls, vs, got, ten, TEN_NUM, KMAX,     \
+                                   emc, ti)) {                          \
+        fprintf(stderr, "%s: elfMaximaFindBatch_" #SUF " (%u threads) " \
+                "failed\n", me, ti);                                    \
+        return 1;                                                       \
+      }                                                                 \
+      for (nn=0; nn<TEN_NUM; nn++) {                                    \
+        TYPE *l1=NULL, *v1=NULL;                                        \
+        int found;                                                      \
+        unsigned int want;                                              \
+        found = elfMaximaFind_##SUF(&l1, &v1, ten + nn*num, emc);       \
+        if (found < 0) {                                                \
+          fprintf(stderr, "%s: elfMaximaFind_" #SUF "[%u] failed\n",    \
+                  me, nn);                                              \
+          return 1;                                                     \
+        }                                                               \
+        want = AIR_MIN(KMAX, AIR_UINT(found));                          \
+        for (ii=0; ii<KMAX; ii++) {                                     \
+          TYPE *bl = ls + ii + KMAX*nn, *bv = vs + 3*(ii + KMAX*nn);    \
+          if (ii < want                                                 \
+              ? !( *bl == l1[ii] && ELL_3V_EQUAL(bv, v1 + 3*ii) )       \
+              : !( 0 == *bl && 0 == ELL_3V_DOT(bv, bv) ))               \
+            break;                                                      \
+        }                                                               \
+        if (found > 0) {                                                \
+          free(l1); free(v1);                                           \
+        }                                                               \
+        if (got[nn] != want || ii < KMAX) {                             \
+          fprintf(stderr, "%s: " #SUF " tensor %u (%u threads): batch " \
+                  "has %u maxima, differing at %u; want %u\n",          \
+                  me, nn, ti, got[nn], ii, want);                       \
+          return 1;                                                     \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+    return 0;                                                           \
+  }
+
+CHECK(double, d)
+CHECK(float, f)
+
+int
+main(int argc, const char **argv) {
+  const tijk_type *type = tijk_4o3d_sym;
+  airArray *mop;
+  elfMaximaContext *emc;
+  double *ten_d, vv[3];
+  float *ten_f;
+  unsigned int nn, ii, jj, many;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  emc = elfMaximaContextNew(type, 3);
+  if (!emc) {
+    fprintf(stderr, "%s: couldn't create context\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, emc, (airMopper)elfMaximaContextNix, airMopAlways);
+  ten_d = AIR_CALLOC(TEN_NUM*type->num, double);
+  ten_f = AIR_CALLOC(TEN_NUM*type->num, float);
+  airMopAdd(mop, ten_d, airFree, airMopAlways);
+  airMopAdd(mop, ten_f, airFree, airMopAlways);
+  if (!( ten_d && ten_f )) {
+    fprintf(stderr, "%s: couldn't allocate tensors\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+  /* sums of 1 to 4 rank-1 terms, plus noise */
+  airSrandMT(42);
+  many = 0;
+  for (nn=0; nn<TEN_NUM; nn++) {
+    double *tt = ten_d + nn*type->num, rk1[TIJK_TYPE_MAX_NUM];
+    for (jj=0; jj<1+nn%4; jj++) {
+      double len;
+      do {
+        ELL_3V_SET(vv, 2*airDrandMT()-1, 2*airDrandMT()-1,
+                   2*airDrandMT()-1);
+        len = ELL_3V_LEN(vv);
+      } while (!( len > 0.1 && len < 1 ));
+      ELL_3V_SCALE(vv, 1.0/len, vv);
+      (*type->sym->make_rank1_d)(rk1, 0.5 + airDrandMT(), vv);
+      for (ii=0; ii<type->num; ii++) {
+        tt[ii] += rk1[ii];
+      }
+    }
+    for (ii=0; ii<type->num; ii++) {
+      tt[ii] += 0.05*(2*airDrandMT() - 1);
+      ten_f[ii + nn*type->num] = AIR_CAST(float, tt[ii]);
+    }
+  }
+  if (check_d(argv[0], emc, ten_d, mop)
+      || check_f(argv[0], emc, ten_f, mop)) {
+    airMopError(mop); return 1;
+  }
+  /* make sure that truncation to KMAX was tested */
+  many = 0;
+  for (nn=0; nn<TEN_NUM; nn++) {
+    double *ls, *vs;
+    int found = elfMaximaFind_d(&ls, &vs, ten_d + nn*type->num, emc);
+    if (found > 0) {
+      many += (AIR_UINT(found) > KMAX);
+      free(ls); free(vs);
+    }
+  }
+  if (!many) {
+    fprintf(stderr, "%s: no tensors with more than %u maxima\n",
+            argv[0], KMAX);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
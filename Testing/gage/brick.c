@@ -0,0 +1,178 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** gageProbe on volumes bricked by gagePerVolumeAttach (gageParmBrickSize),
+** and on a gageContextCopy of that context (which shares the bricks),
+** against gageProbe on the same volumes in the usual layout.  The volume
+** sizes are not multiples of the brick size, and the probes (a mix of
+** random jumps and unit steps) go all the way out to the edges.
+** Answers and ctx->edgeFrac should be identical.
+*/
+
+#define SX 23
+#define SY 19
+#define SZ 17
+#define PROBE_NUM 4000
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  Nrrd *nscl, *nvec;
+  float *scl;
+  double *vec, kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 1.0, 0.0}, pos[3];
+  gageContext *gctx[3];
+  gagePerVolume *pvlScl, *pvlVec;
+  const double *sansVal[3], *sansGrad[3], *sansHess[3], *vansVec[3],
+    *vansJac[3];
+  unsigned int ii, ci, pi;
+  char *err;
+  int E;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  nscl = nrrdNew();
+  airMopAdd(mop, nscl, (airMopper)nrrdNuke, airMopAlways);
+  nvec = nrrdNew();
+  airMopAdd(mop, nvec, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nscl, nrrdTypeFloat, 3, AIR_CAST(size_t, SX),
+                        AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ))
+      || nrrdMaybeAlloc_va(nvec, nrrdTypeDouble, 4, AIR_CAST(size_t, 3),
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY),
+                           AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nscl, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  nrrdAxisInfoSet_va(nvec, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  airSrandMT(4343);
+  scl = AIR_CAST(float *, nscl->data);
+  vec = AIR_CAST(double *, nvec->data);
+  for (ii=0; ii<SX*SY*SZ; ii++) {
+    scl[ii] = AIR_CAST(float, airDrandMT());
+    ELL_3V_SET(vec + 3*ii, airDrandMT(), airDrandMT(), airDrandMT());
+  }
+
+  /* gctx[0] uses the volumes as they are; gctx[1] bricks them, and
+     gctx[2] is a copy of gctx[1] */
+  for (ci=0; ci<2; ci++) {
+    gctx[ci] = gageContextNew();
+    airMopAdd(mop, gctx[ci], (airMopper)gageContextNix, airMopAlways);
+    gageParmSet(gctx[ci], gageParmBrickSize, ci ? 4 : 0);
+    E = 0;
+    if (!E) E |= !(pvlScl = gagePerVolumeNew(gctx[ci], nscl, gageKindScl));
+    if (!E) E |= gagePerVolumeAttach(gctx[ci], pvlScl);
+    if (!E) E |= !(pvlVec = gagePerVolumeNew(gctx[ci], nvec, gageKindVec));
+    if (!E) E |= gagePerVolumeAttach(gctx[ci], pvlVec);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel00,
+                               nrrdKernelBCCubic, kparm);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel11,
+                               nrrdKernelBCCubicD, kparm);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel22,
+                               nrrdKernelBCCubicDD, kparm);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlScl, gageSclValue);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlScl, gageSclGradVec);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlScl, gageSclHessian);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlVec, gageVecVector);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlVec, gageVecJacobian);
+    if (!E) E |= gageUpdate(gctx[ci]);
+    if (E) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble setting up gage:\n%s", argv[0], err);
+      airMopError(mop); return 1;
+    }
+    if (!( (!ci) == (!pvlScl->brick) && (!ci) == (!pvlVec->brick) )) {
+      fprintf(stderr, "%s: context %u: bricks not as expected\n",
+              argv[0], ci);
+      airMopError(mop); return 1;
+    }
+  }
+  if (!(gctx[2] = gageContextCopy(gctx[1]))) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble copying context:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, gctx[2], (airMopper)gageContextNix, airMopAlways);
+  if (!( gctx[2]->pvl[0]->brick == gctx[1]->pvl[0]->brick
+         && 2 == gctx[1]->pvl[0]->brick->refCount )) {
+    fprintf(stderr, "%s: copied context doesn't share bricks\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+  for (ci=0; ci<3; ci++) {
+    sansVal[ci] = gageAnswerPointer(gctx[ci], gctx[ci]->pvl[0],
+                                    gageSclValue);
+    sansGrad[ci] = gageAnswerPointer(gctx[ci], gctx[ci]->pvl[0],
+                                     gageSclGradVec);
+    sansHess[ci] = gageAnswerPointer(gctx[ci], gctx[ci]->pvl[0],
+                                     gageSclHessian);
+    vansVec[ci] = gageAnswerPointer(gctx[ci], gctx[ci]->pvl[1],
+                                    gageVecVector);
+    vansJac[ci] = gageAnswerPointer(gctx[ci], gctx[ci]->pvl[1],
+                                    gageVecJacobian);
+  }
+
+  ELL_3V_SET(pos, SX/2, SY/2, SZ/2);
+  for (pi=0; pi<PROBE_NUM; pi++) {
+    unsigned int ax;
+    ax = airRandInt(3);
+    if (airDrandMT() < 0.5) {
+      pos[ax] += airDrandMT() < 0.5 ? -1 : 1;
+    } else {
+      ELL_3V_SET(pos, (SX+2)*airDrandMT() - 1, (SY+2)*airDrandMT() - 1,
+                 (SZ+2)*airDrandMT() - 1);
+    }
+    pos[0] = AIR_CLAMP(0, pos[0], SX-1);
+    pos[1] = AIR_CLAMP(0, pos[1], SY-1);
+    pos[2] = AIR_CLAMP(0, pos[2], SZ-1);
+    for (ci=0; ci<3; ci++) {
+      if (gageProbe(gctx[ci], pos[0], pos[1], pos[2])) {
+        fprintf(stderr, "%s: probe %u (context %u) at (%g,%g,%g) "
+                "failed: %s\n", argv[0], pi, ci, pos[0], pos[1], pos[2],
+                gctx[ci]->errStr);
+        airMopError(mop); return 1;
+      }
+    }
+    for (ci=1; ci<3; ci++) {
+      if (sansVal[0][0] != sansVal[ci][0]
+          || memcmp(sansGrad[0], sansGrad[ci], 3*sizeof(double))
+          || memcmp(sansHess[0], sansHess[ci], 9*sizeof(double))
+          || memcmp(vansVec[0], vansVec[ci], 3*sizeof(double))
+          || memcmp(vansJac[0], vansJac[ci], 9*sizeof(double))
+          || gctx[0]->edgeFrac != gctx[ci]->edgeFrac) {
+        fprintf(stderr, "%s: probe %u at (%g,%g,%g): context %u answers "
+                "differ (value %.17g vs %.17g; edgeFrac %g vs %g)\n",
+                argv[0], pi, pos[0], pos[1], pos[2], ci, sansVal[0][0],
+                sansVal[ci][0], gctx[0]->edgeFrac, gctx[ci]->edgeFrac);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,164 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** gageProbe with the shifting iv3 cache (when probes move by one voxel
+** along an axis), against gageProbe with iv3 caches always completely
+** refilled (by resetting the gagePoint before every probe), for scalar
+** and vector volumes, with probes that go all the way out to the edges.
+** Answers and ctx->edgeFrac should be identical.
+*/
+
+#define SX 23
+#define SY 19
+#define SZ 17
+#define PROBE_NUM 4000
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  Nrrd *nscl, *nvec;
+  double *scl, *vec, kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 1.0, 0.0},
+    pos[3];
+  gageContext *gctx[2];
+  gagePerVolume *pvlScl, *pvlVec;
+  const double *sansVal[2], *sansGrad[2], *sansHess[2], *vansVec[2],
+    *vansJac[2];
+  unsigned int ii, ci, pi;
+  char *err, stmp[3][AIR_STRLEN_SMALL];
+  int E;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  nscl = nrrdNew();
+  airMopAdd(mop, nscl, (airMopper)nrrdNuke, airMopAlways);
+  nvec = nrrdNew();
+  airMopAdd(mop, nvec, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nscl, nrrdTypeDouble, 3, AIR_CAST(size_t, SX),
+                        AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ))
+      || nrrdMaybeAlloc_va(nvec, nrrdTypeDouble, 4, AIR_CAST(size_t, 3),
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY),
+                           AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nscl, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  nrrdAxisInfoSet_va(nvec, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  airSrandMT(4242);
+  scl = AIR_CAST(double *, nscl->data);
+  vec = AIR_CAST(double *, nvec->data);
+  for (ii=0; ii<SX*SY*SZ; ii++) {
+    scl[ii] = airDrandMT();
+    ELL_3V_SET(vec + 3*ii, airDrandMT(), airDrandMT(), airDrandMT());
+  }
+
+  /* gctx[0] probes as usual; gctx[1] has its point reset before every
+     probe, so that every iv3 is filled completely */
+  for (ci=0; ci<2; ci++) {
+    gctx[ci] = gageContextNew();
+    airMopAdd(mop, gctx[ci], (airMopper)gageContextNix, airMopAlways);
+    E = 0;
+    if (!E) E |= !(pvlScl = gagePerVolumeNew(gctx[ci], nscl, gageKindScl));
+    if (!E) E |= gagePerVolumeAttach(gctx[ci], pvlScl);
+    if (!E) E |= !(pvlVec = gagePerVolumeNew(gctx[ci], nvec, gageKindVec));
+    if (!E) E |= gagePerVolumeAttach(gctx[ci], pvlVec);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel00,
+                               nrrdKernelBCCubic, kparm);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel11,
+                               nrrdKernelBCCubicD, kparm);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel22,
+                               nrrdKernelBCCubicDD, kparm);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlScl, gageSclValue);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlScl, gageSclGradVec);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlScl, gageSclHessian);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlVec, gageVecVector);
+    if (!E) E |= gageQueryItemOn(gctx[ci], pvlVec, gageVecJacobian);
+    if (!E) E |= gageUpdate(gctx[ci]);
+    if (E) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble setting up gage:\n%s", argv[0], err);
+      airMopError(mop); return 1;
+    }
+    sansVal[ci] = gageAnswerPointer(gctx[ci], pvlScl, gageSclValue);
+    sansGrad[ci] = gageAnswerPointer(gctx[ci], pvlScl, gageSclGradVec);
+    sansHess[ci] = gageAnswerPointer(gctx[ci], pvlScl, gageSclHessian);
+    vansVec[ci] = gageAnswerPointer(gctx[ci], pvlVec, gageVecVector);
+    vansJac[ci] = gageAnswerPointer(gctx[ci], pvlVec, gageVecJacobian);
+  }
+
+  /* a random walk, mostly of unit steps along one axis, sometimes
+     with sub-voxel jitter, or a jump; clamped to the volume */
+  ELL_3V_SET(pos, SX/2, SY/2, SZ/2);
+  for (pi=0; pi<PROBE_NUM; pi++) {
+    double rr;
+    unsigned int ax;
+    rr = airDrandMT();
+    ax = airRandInt(3);
+    if (rr < 0.75) {
+      pos[ax] += airDrandMT() < 0.5 ? -1 : 1;
+    } else if (rr < 0.95) {
+      pos[ax] += 0.5*(airDrandMT() - 0.5);
+    } else {
+      ELL_3V_SET(pos, SX*airDrandMT(), SY*airDrandMT(), SZ*airDrandMT());
+    }
+    pos[0] = AIR_CLAMP(0, pos[0], SX-1);
+    pos[1] = AIR_CLAMP(0, pos[1], SY-1);
+    pos[2] = AIR_CLAMP(0, pos[2], SZ-1);
+    gagePointReset(&(gctx[1]->point));
+    if (gageProbe(gctx[0], pos[0], pos[1], pos[2])
+        || gageProbe(gctx[1], pos[0], pos[1], pos[2])) {
+      fprintf(stderr, "%s: probe %u at (%g,%g,%g) failed: %s %s\n", argv[0],
+              pi, pos[0], pos[1], pos[2], gctx[0]->errStr, gctx[1]->errStr);
+      airMopError(mop); return 1;
+    }
+    if (sansVal[0][0] != sansVal[1][0]
+        || memcmp(sansGrad[0], sansGrad[1], 3*sizeof(double))
+        || memcmp(sansHess[0], sansHess[1], 9*sizeof(double))
+        || memcmp(vansVec[0], vansVec[1], 3*sizeof(double))
+        || memcmp(vansJac[0], vansJac[1], 9*sizeof(double))
+        || gctx[0]->edgeFrac != gctx[1]->edgeFrac) {
+      fprintf(stderr, "%s: probe %u at (%g,%g,%g): answers differ "
+              "(value %.17g vs %.17g; edgeFrac %g vs %g)\n", argv[0], pi,
+              pos[0], pos[1], pos[2], sansVal[0][0], sansVal[1][0],
+              gctx[0]->edgeFrac, gctx[1]->edgeFrac);
+      airMopError(mop); return 1;
+    }
+  }
+  fprintf(stderr, "%s: iv3 hits %s, fills %s, shifts %s\n", argv[0],
+          airSprintSize_t(stmp[0], gctx[0]->iv3HitNum),
+          airSprintSize_t(stmp[1], gctx[0]->iv3FillNum),
+          airSprintSize_t(stmp[2], gctx[0]->iv3ShiftNum));
+  if (!( gctx[0]->iv3ShiftNum && gctx[0]->iv3HitNum
+         && !gctx[1]->iv3ShiftNum )) {
+    fprintf(stderr, "%s: iv3 cache shifting not exercised\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
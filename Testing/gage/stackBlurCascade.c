@@ -0,0 +1,234 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** gageStackBlur with threadNum > 1 (identical to one thread)
+** gageStackBlur with cascade (close to direct blurring with wrap boundary,
+**   and identical for any number of threads)
+** gageStackBlurManage re-using a prefix of levels already saved in files,
+**   for direct and for cascaded blurring (identical to blurring all levels)
+*/
+
+#define SX 20
+#define SY 18
+#define SZ 16
+#define NUM 6
+#define FORMAT "tsbc-%02u.nrrd"
+
+static int
+blur(Nrrd *nblur[NUM], const char *str, const Nrrd *nin) {
+  static const char me[]="blur";
+  gageStackBlurParm *sbp;
+  airArray *mop;
+  unsigned int ii;
+
+  mop = airMopNew();
+  sbp = gageStackBlurParmNew();
+  airMopAdd(mop, sbp, (airMopper)gageStackBlurParmNix, airMopAlways);
+  for (ii=0; ii<NUM; ii++) {
+    nrrdEmpty(nblur[ii]);
+  }
+  if (gageStackBlurParmParse(sbp, NULL, NULL, str)
+      || gageStackBlurParmVerboseSet(sbp, 0)
+      || gageStackBlur(nblur, sbp, nin, gageKindScl)) {
+    char *err;
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with \"%s\":\n%s", me, str, err);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/* max abs difference between two levels, relative to the max of the first */
+static double
+levelDiff(const Nrrd *na, const Nrrd *nb) {
+  const float *aa, *bb;
+  double dmax, amax;
+  size_t ii, nn;
+
+  aa = AIR_CAST(const float *, na->data);
+  bb = AIR_CAST(const float *, nb->data);
+  nn = nrrdElementNumber(na);
+  dmax = amax = 0;
+  for (ii=0; ii<nn; ii++) {
+    dmax = AIR_MAX(dmax, fabs(aa[ii] - bb[ii]));
+    amax = AIR_MAX(amax, fabs(aa[ii]));
+  }
+  return dmax/amax;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  Nrrd *nin, *nref[NUM], *ntst[NUM], **nman;
+  gageStackBlurParm *sbp;
+  float *data;
+  unsigned int ii, kk;
+  size_t jj;
+  char *err, fname[AIR_STRLEN_SMALL];
+  static const char *kstr[2] = {"1-6-4-uc/k=gauss:1,4/b=wrap",
+                                "1-6-4-u/k=dgauss:1,5/b=bleed"},
+    *mstr[2] = {"1-6-4-u/k=gauss:1,4/b=wrap",
+                "1-6-4-uc/k=gauss:1,4/b=wrap"};
+  int recomputed;
+  double diff;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, SX),
+                        AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  airSrandMT(4444);
+  data = AIR_CAST(float *, nin->data);
+  for (jj=0; jj<SX*SY*SZ; jj++) {
+    data[jj] = AIR_CAST(float, airDrandMT() < 0.02 ? 100 : 0);
+  }
+  for (ii=0; ii<NUM; ii++) {
+    nref[ii] = nrrdNew();
+    airMopAdd(mop, nref[ii], (airMopper)nrrdNuke, airMopAlways);
+    ntst[ii] = nrrdNew();
+    airMopAdd(mop, ntst[ii], (airMopper)nrrdNuke, airMopAlways);
+  }
+
+  /* independent levels: threads don't change anything */
+  if (blur(nref, "1-6-4-u/k=gauss:1,4/b=bleed", nin)
+      || blur(ntst, "1-6-4-u/k=gauss:1,4/b=bleed/t=3", nin)) {
+    airMopError(mop); return 1;
+  }
+  for (ii=0; ii<NUM; ii++) {
+    if (memcmp(nref[ii]->data, ntst[ii]->data,
+               nrrdElementNumber(nin)*sizeof(float))) {
+      fprintf(stderr, "%s: threaded level %u differs\n", argv[0], ii);
+      airMopError(mop); return 1;
+    }
+  }
+
+  /* cascaded levels: close to direct, with wrap boundary */
+  if (blur(nref, "1-6-4-u/k=gauss:1,4/b=wrap", nin)
+      || blur(ntst, "1-6-4-uc/k=gauss:1,4/b=wrap", nin)) {
+    airMopError(mop); return 1;
+  }
+  for (jj=0; jj<NUM; jj++) {
+    diff = levelDiff(nref[jj], ntst[jj]);
+    if (diff > 0.02) {
+      fprintf(stderr, "%s: cascaded level %u off by %g\n",
+              argv[0], AIR_CAST(unsigned int, jj), diff);
+      airMopError(mop); return 1;
+    }
+  }
+
+  /* cascaded and discrete Gaussian levels: threads don't change anything */
+  for (kk=0; kk<2; kk++) {
+    if (blur(nref, kstr[kk], nin)) {
+      airMopError(mop); return 1;
+    }
+    for (ii=2; ii<=NUM+1; ii++) {
+      sprintf(fname, "%s/t=%u", kstr[kk], ii);
+      if (blur(ntst, fname, nin)) {
+        airMopError(mop); return 1;
+      }
+      for (jj=0; jj<NUM; jj++) {
+        if (memcmp(nref[jj]->data, ntst[jj]->data,
+                   nrrdElementNumber(nin)*sizeof(float))) {
+          fprintf(stderr, "%s: \"%s\" level %u differs from 1 thread\n",
+                  argv[0], fname, AIR_CAST(unsigned int, jj));
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+
+  /* for direct and for cascaded blurring: save all levels, mark the
+     saved level 1 (to see if it is re-used), and remove the last two
+     levels; then only those are recomputed, exactly as before */
+  for (kk=0; kk<2; kk++) {
+    if (blur(nref, mstr[kk], nin)) {
+      airMopError(mop); return 1;
+    }
+    sbp = gageStackBlurParmNew();
+    airMopAdd(mop, sbp, (airMopper)gageStackBlurParmNix, airMopAlways);
+    if (gageStackBlurParmParse(sbp, NULL, NULL, mstr[kk])
+        || gageStackBlurParmVerboseSet(sbp, 0)
+        || gageStackBlurManage(&nman, &recomputed, sbp, FORMAT, AIR_TRUE,
+                               NULL, nin, gageKindScl)) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with first \"%s\" manage:\n%s",
+              argv[0], mstr[kk], err);
+      airMopError(mop); return 1;
+    }
+    for (ii=0; ii<NUM; ii++) {
+      nrrdNuke(nman[ii]);
+    }
+    airFree(nman);
+    AIR_CAST(float *, nref[1]->data)[0] = -42;
+    sprintf(fname, FORMAT, 1);
+    if (nrrdSave(fname, nref[1], NULL)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble saving:\n%s", argv[0], err);
+      airMopError(mop); return 1;
+    }
+    sprintf(fname, FORMAT, NUM-2);
+    remove(fname);
+    sprintf(fname, FORMAT, NUM-1);
+    remove(fname);
+    if (gageStackBlurManage(&nman, &recomputed, sbp, FORMAT, AIR_TRUE, NULL,
+                            nin, gageKindScl)) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with second \"%s\" manage:\n%s",
+              argv[0], mstr[kk], err);
+      airMopError(mop); return 1;
+    }
+    for (ii=0; ii<NUM; ii++) {
+      airMopAdd(mop, nman[ii], (airMopper)nrrdNuke, airMopAlways);
+    }
+    airMopAdd(mop, nman, airFree, airMopAlways);
+    if (!( recomputed
+           && -42 == AIR_CAST(float *, nman[1]->data)[0]
+           && !memcmp(nman[NUM-2]->data, nref[NUM-2]->data,
+                      nrrdElementNumber(nin)*sizeof(float))
+           && !memcmp(nman[NUM-1]->data, nref[NUM-1]->data,
+                      nrrdElementNumber(nin)*sizeof(float)) )) {
+      fprintf(stderr, "%s: prefix of \"%s\" levels not re-used as "
+              "expected\n", argv[0], mstr[kk]);
+      airMopError(mop); return 1;
+    }
+    for (ii=0; ii<NUM; ii++) {
+      sprintf(fname, FORMAT, ii);
+      remove(fname);
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,216 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "teem/limn.h"
+
+/*
+** Tests:
+** limnPolyDataWriteLMPD2 (raw and gzip) and limnPolyDataSave, followed by
+** limnPolyDataReadLMPD, should give back exactly the polydata written;
+** and limnPolyDataReadLMPD should still read the original LMPD format.
+** An LMPD2 file with an unrecognized endian field must be rejected.
+*/
+
+static int
+pldCompare(const limnPolyData *pldA, const limnPolyData *pldB) {
+
+  return !(pldA->xyzwNum == pldB->xyzwNum
+           && pldA->rgbaNum == pldB->rgbaNum
+           && pldA->normNum == pldB->normNum
+           && pldA->indxNum == pldB->indxNum
+           && pldA->primNum == pldB->primNum
+           && limnPolyDataInfoBitFlag(pldA) == limnPolyDataInfoBitFlag(pldB)
+           && !memcmp(pldA->xyzw, pldB->xyzw,
+                      4*sizeof(float)*pldA->xyzwNum)
+           && !memcmp(pldA->rgba, pldB->rgba, 4*pldA->rgbaNum)
+           && !memcmp(pldA->norm, pldB->norm,
+                      3*sizeof(float)*pldA->normNum)
+           && !memcmp(pldA->indx, pldB->indx,
+                      sizeof(unsigned int)*pldA->indxNum)
+           && !memcmp(pldA->type, pldB->type, pldA->primNum)
+           && !memcmp(pldA->icnt, pldB->icnt,
+                      sizeof(unsigned int)*pldA->primNum));
+}
+
+/* how: 0 for LMPD2 raw, 1 for LMPD2 gzip, 2 for limnPolyDataSave */
+static int
+roundTrip(const limnPolyData *pld, const char *fname, int how) {
+  static const char me[]="roundTrip";
+  limnPolyData *pldB;
+  airArray *mop;
+  FILE *file;
+  char *err;
+
+  mop = airMopNew();
+  pldB = limnPolyDataNew();
+  airMopAdd(mop, pldB, (airMopper)limnPolyDataNix, airMopAlways);
+  if (2 == how) {
+    if (limnPolyDataSave(fname, pld)) {
+      airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble saving %s:\n%s", me, fname, err);
+      airMopError(mop); return 1;
+    }
+  } else {
+    if (!(file = fopen(fname, "wb"))) {
+      fprintf(stderr, "%s: couldn't open %s for writing\n", me, fname);
+      airMopError(mop); return 1;
+    }
+    if (limnPolyDataWriteLMPD2(file, pld, how)) {
+      airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble writing %s:\n%s", me, fname, err);
+      fclose(file);
+      airMopError(mop); return 1;
+    }
+    fclose(file);
+  }
+  if (!(file = fopen(fname, "rb"))) {
+    fprintf(stderr, "%s: couldn't open %s for reading\n", me, fname);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, file, (airMopper)airFclose, airMopAlways);
+  if (limnPolyDataReadLMPD(pldB, file)) {
+    airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading %s:\n%s", me, fname, err);
+    airMopError(mop); return 1;
+  }
+  if (pldCompare(pld, pldB)) {
+    fprintf(stderr, "%s: %s: read polydata different than written\n",
+            me, fname);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/* writes pld to fname as raw LMPD2, with endian field set to bogus, and
+   makes sure that reading it fails because of that */
+static int
+badEndian(const limnPolyData *pld, const char *fname, unsigned int bogus) {
+  static const char me[]="badEndian";
+  limnPolyData *pldB;
+  airArray *mop;
+  FILE *file;
+  char *err;
+
+  mop = airMopNew();
+  pldB = limnPolyDataNew();
+  airMopAdd(mop, pldB, (airMopper)limnPolyDataNix, airMopAlways);
+  if (!(file = fopen(fname, "wb"))) {
+    fprintf(stderr, "%s: couldn't open %s for writing\n", me, fname);
+    airMopError(mop); return 1;
+  }
+  if (limnPolyDataWriteLMPD2(file, pld, AIR_FALSE)) {
+    airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble writing %s:\n%s", me, fname, err);
+    fclose(file);
+    airMopError(mop); return 1;
+  }
+  /* endian field follows the 8-byte magic */
+  if (fseek(file, 8, SEEK_SET)
+      || 1 != fwrite(&bogus, sizeof(unsigned int), 1, file)) {
+    fprintf(stderr, "%s: couldn't overwrite endian field\n", me);
+    fclose(file);
+    airMopError(mop); return 1;
+  }
+  fclose(file);
+  if (!(file = fopen(fname, "rb"))) {
+    fprintf(stderr, "%s: couldn't open %s for reading\n", me, fname);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, file, (airMopper)airFclose, airMopAlways);
+  if (!limnPolyDataReadLMPD(pldB, file)) {
+    fprintf(stderr, "%s: read %s with bogus endian field %u\n",
+            me, fname, bogus);
+    airMopError(mop); return 1;
+  }
+  err = biffGetDone(LIMN);
+  airMopAdd(mop, err, airFree, airMopAlways);
+  if (!strstr(err, "endian")) {
+    fprintf(stderr, "%s: reading %s failed, but not on endian field:\n%s",
+            me, fname, err);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  limnPolyData *pld;
+  unsigned int vi;
+  char *err;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  pld = limnPolyDataNew();
+  airMopAdd(mop, pld, (airMopper)limnPolyDataNix, airMopAlways);
+  if (limnPolyDataSuperquadric(pld, ((1 << limnPolyDataInfoRGBA)
+                                     | (1 << limnPolyDataInfoNorm)),
+                               0.8f, 1.5f, 37, 23)) {
+    airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble making polydata:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  for (vi=0; vi<pld->rgbaNum; vi++) {
+    ELL_4V_SET(pld->rgba + 4*vi, vi % 256, (3*vi) % 256, (7*vi) % 256, 255);
+  }
+  if (roundTrip(pld, "lmpd2A.lmpd", 0)
+      || (nrrdEncodingGzip->available()
+          && roundTrip(pld, "lmpd2B.lmpd", 1))
+      || roundTrip(pld, "lmpd2C.lmpd2", 2)
+      || roundTrip(pld, "lmpd2D.lmpd", 2)) {
+    fprintf(stderr, "%s: round trip failed\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+  /* neither endianness, neither endianness byte-swapped, and the
+     byte-swapped value of this machine's endianness */
+  if (badEndian(pld, "lmpd2F.lmpd", 0)
+      || badEndian(pld, "lmpd2F.lmpd", 0x01020304)
+      || badEndian(pld, "lmpd2F.lmpd",
+                   (airEndianLittle == airMyEndian()
+                    ? 0xd2040000 : 0xe1100000))) {
+    fprintf(stderr, "%s: bad endian field not caught\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+
+  /* no info, and no indices */
+  pld = limnPolyDataNew();
+  airMopAdd(mop, pld, (airMopper)limnPolyDataNix, airMopAlways);
+  if (limnPolyDataAlloc(pld, 0, 5, 0, 0)) {
+    airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  for (vi=0; vi<pld->xyzwNum; vi++) {
+    ELL_4V_SET(pld->xyzw + 4*vi, vi, 2.0f*vi, 3.0f*vi, 1.0f);
+  }
+  if (roundTrip(pld, "lmpd2E.lmpd", 0)) {
+    fprintf(stderr, "%s: round trip of points failed\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
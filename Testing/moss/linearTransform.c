@@ -0,0 +1,200 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/moss.h"
+
+/*
+** Tests:
+** mossLinearTransform against calling mossSamplerSample for every output
+** pixel, with pad, bleed, and wrap boundaries, for a rotation and for an
+** axis-aligned scaling (which uses separable weight tables), on one- and
+** three-color images.  The output region is bigger than the input, so
+** that every boundary behavior is exercised.  Results with one and with
+** several threads (via mossDefThreadNum) have to be the same.
+*/
+
+#define SX 37
+#define SY 29
+#define PAD 6
+
+static int
+sampleLoop(Nrrd *nout, Nrrd *nin, double *mat, mossSampler *msp,
+           double xMin, double xMax, double yMin, double yMax,
+           int xSize, int ySize, int xCent, int yCent) {
+  int ncol, xi, yi, ci, ax0;
+  float *val, (*ins)(void *v, size_t I, float f), (*clamp)(float val);
+  double inv[6], xInPos, xOutPos, yInPos, yOutPos;
+
+  ax0 = MOSS_AXIS0(nin);
+  ncol = MOSS_NCOL(nin);
+  if (mossImageAlloc(nout, nin->type, xSize, ySize, ncol)) {
+    return 1;
+  }
+  val = AIR_CAST(float *, calloc(ncol, sizeof(float)));
+  if (!val) {
+    biffAddf(MOSS, "sampleLoop: couldn't allocate values");
+    return 1;
+  }
+  ins = nrrdFInsert[nin->type];
+  clamp = nrrdFClamp[nin->type];
+  mossMatInvert(inv, mat);
+  for (yi=0; yi<ySize; yi++) {
+    yOutPos = NRRD_POS(yCent, yMin, yMax, ySize, yi);
+    for (xi=0; xi<xSize; xi++) {
+      xOutPos = NRRD_POS(xCent, xMin, xMax, xSize, xi);
+      mossMatApply(&xInPos, &yInPos, inv, xOutPos, yOutPos);
+      xInPos = NRRD_IDX(xCent, nin->axis[ax0+0].min, nin->axis[ax0+0].max,
+                        nin->axis[ax0+0].size, xInPos);
+      yInPos = NRRD_IDX(yCent, nin->axis[ax0+1].min, nin->axis[ax0+1].max,
+                        nin->axis[ax0+1].size, yInPos);
+      if (mossSamplerSample(val, msp, xInPos, yInPos)) {
+        free(val);
+        return 1;
+      }
+      for (ci=0; ci<ncol; ci++) {
+        ins(nout->data, ci + ncol*(xi + xSize*yi), clamp(val[ci]));
+      }
+    }
+  }
+  free(val);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nin, *nslow, *none, *nmany;
+  mossSampler *msp;
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 0.0, 0.5},
+    mat[6], xMin, xMax, yMin, yMax;
+  float bg[4] = {10, 20, 30, 40};
+  int ncol, bi, ax0, differ, boundary[3] = {nrrdBoundaryPad,
+                                            nrrdBoundaryBleed,
+                                            nrrdBoundaryWrap};
+  unsigned int mi;
+  size_t II, NN;
+  char *err, explain[AIR_STRLEN_LARGE];
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nslow = nrrdNew();
+  airMopAdd(mop, nslow, (airMopper)nrrdNuke, airMopAlways);
+  none = nrrdNew();
+  airMopAdd(mop, none, (airMopper)nrrdNuke, airMopAlways);
+  nmany = nrrdNew();
+  airMopAdd(mop, nmany, (airMopper)nrrdNuke, airMopAlways);
+  msp = mossSamplerNew();
+  airMopAdd(mop, msp, (airMopper)mossSamplerNix, airMopAlways);
+  if (mossSamplerKernelSet(msp, nrrdKernelBCCubic, kparm)) {
+    airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with sampler:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+
+  /* a float image with 1 color, then a uchar image with 3 */
+  for (ncol=1; ncol<=3; ncol+=2) {
+    if (mossImageAlloc(nin, 1 == ncol ? nrrdTypeFloat : nrrdTypeUChar,
+                       SX, SY, ncol)) {
+      airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+      airMopError(mop); return 1;
+    }
+    NN = nrrdElementNumber(nin);
+    for (II=0; II<NN; II++) {
+      nrrdDInsert[nin->type](nin->data, II,
+                             127*(1 + sin(0.3*II)) + 2*airDrandMT_r(rng));
+    }
+    ax0 = MOSS_AXIS0(nin);
+    nrrdAxisInfoMinMaxSet(nin, ax0+0, mossDefCenter);
+    nrrdAxisInfoMinMaxSet(nin, ax0+1, mossDefCenter);
+    xMin = nin->axis[ax0+0].min - PAD;
+    xMax = nin->axis[ax0+0].max + PAD;
+    yMin = nin->axis[ax0+1].min - PAD;
+    yMax = nin->axis[ax0+1].max + PAD;
+    for (mi=0; mi<2; mi++) {
+      if (!mi) {
+        mossMatRotateSet(mat, 20);
+      } else {
+        mossMatScaleSet(mat, 1.3, 0.8);
+      }
+      mat[2] = 3.5;
+      mat[5] = -2.25;
+      for (bi=0; bi<3; bi++) {
+        msp->boundary = boundary[bi];
+        mossDefThreadNum = 1;
+        if (mossLinearTransform(none, nin, bg, mat, msp, xMin, xMax,
+                                yMin, yMax, SX + 2*PAD, SY + 2*PAD)) {
+          airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+          fprintf(stderr, "%s: trouble transforming:\n%s", argv[0], err);
+          airMopError(mop); return 1;
+        }
+        mossDefThreadNum = 3;
+        if (mossLinearTransform(nmany, nin, bg, mat, msp, xMin, xMax,
+                                yMin, yMax, SX + 2*PAD, SY + 2*PAD)
+            || sampleLoop(nslow, nin, mat, msp, xMin, xMax, yMin, yMax,
+                          SX + 2*PAD, SY + 2*PAD,
+                          none->axis[ax0+0].center,
+                          none->axis[ax0+1].center)) {
+          airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+          fprintf(stderr, "%s: trouble transforming:\n%s", argv[0], err);
+          airMopError(mop); return 1;
+        }
+        if (nrrdCompare(none, nslow, AIR_TRUE /* onlyData */,
+                        0.0 /* epsilon */, &differ, explain)) {
+          airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+          fprintf(stderr, "%s: trouble comparing:\n%s", argv[0], err);
+          airMopError(mop); return 1;
+        }
+        if (differ) {
+          fprintf(stderr, "%s: (%d colors, %s, %s) mossLinearTransform "
+                  "differs from mossSamplerSample: %s\n", argv[0], ncol,
+                  mi ? "scaling" : "rotation",
+                  airEnumStr(nrrdBoundary, boundary[bi]), explain);
+          airMopError(mop); return 1;
+        }
+        if (nrrdCompare(none, nmany, AIR_TRUE /* onlyData */,
+                        0.0 /* epsilon */, &differ, explain)) {
+          airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+          fprintf(stderr, "%s: trouble comparing:\n%s", argv[0], err);
+          airMopError(mop); return 1;
+        }
+        if (differ) {
+          fprintf(stderr, "%s: (%d colors, %s, %s) 1 and 3 threads "
+                  "differ: %s\n", argv[0], ncol,
+                  mi ? "scaling" : "rotation",
+                  airEnumStr(nrrdBoundary, boundary[bi]), explain);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
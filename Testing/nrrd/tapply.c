@@ -0,0 +1,231 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdApply1DRegMap
+** nrrdApply1DRegMapQuantize
+** nrrdApply1DLut
+** nrrdApply2DLut
+**
+** the table-based mapping of 8 and 16 bit input (unsigned and signed),
+** and the threaded mapping of int and float input, have to give exactly
+** what mapping the same values as floats (or doubles, for float input)
+** in one thread gives, and the fused quantizing has to give what
+** mapping to double and then nrrdQuantize gives
+*/
+
+/* enough values that tables and 3 threads will be used */
+#define SX 1000
+#define SY 800
+
+static int
+compare(const char *me, const char *what, const Nrrd *na, const Nrrd *nb) {
+  char *err, explain[AIR_STRLEN_LARGE];
+  int differ;
+
+  if (nrrdCompare(na, nb, AIR_TRUE /* onlyData */, 0.0 /* epsilon */,
+                  &differ, explain)) {
+    err = biffGetDone(NRRD);
+    fprintf(stderr, "%s: trouble comparing %s:\n%s", me, what, err);
+    free(err);
+    return 1;
+  }
+  if (differ) {
+    fprintf(stderr, "%s: %s differ: %s\n", me, what, explain);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** maps nin (with 3 threads, so possibly via a table) and a copy of nin
+** converted to nrrdTypeFloat, or nrrdTypeDouble for float input (in one
+** thread), with all the functions being tested, and compares the results
+*/
+static int
+check(const char *me, const char *what, const Nrrd *nin, const Nrrd *nmap,
+      const Nrrd *nlut2, const NrrdRange *qrange) {
+  char *err, msg[AIR_STRLEN_MED];
+  airArray *mop;
+  Nrrd *nref, *nin2, *nref2, *nta, *ntb, *ndbl;
+  int E;
+
+  mop = airMopNew();
+#define NEW(N) N = nrrdNew(); airMopAdd(mop, N, (airMopper)nrrdNuke, airMopAlways)
+  NEW(nref); NEW(nin2); NEW(nref2); NEW(nta); NEW(ntb); NEW(ndbl);
+#undef NEW
+
+  /* reference results in one thread, with float (or double) input */
+  nrrdStateThreadNum = 1;
+  E = 0;
+  if (!E) E |= nrrdConvert(nref, nin, (nrrdTypeFloat == nin->type
+                                        ? nrrdTypeDouble : nrrdTypeFloat));
+  if (!E) E |= nrrdApply1DRegMap(nta, nref, NULL, nmap, nrrdTypeFloat,
+                                 AIR_FALSE);
+  nrrdStateThreadNum = 3;
+  if (!E) E |= nrrdApply1DRegMap(ntb, nin, NULL, nmap, nrrdTypeFloat,
+                                 AIR_FALSE);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble (%s):\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  sprintf(msg, "rmap %s", what);
+  if (compare(me, msg, nta, ntb)) {
+    airMopError(mop); return 1;
+  }
+
+  if (nrrdApply1DLut(nta, nref, NULL, nmap, nrrdTypeFloat, AIR_FALSE)
+      || nrrdApply1DLut(ntb, nin, NULL, nmap, nrrdTypeFloat, AIR_FALSE)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble (%s):\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  sprintf(msg, "lut %s", what);
+  if (compare(me, msg, nta, ntb)) {
+    airMopError(mop); return 1;
+  }
+
+  if (nrrdApply1DRegMap(ndbl, nref, NULL, nmap, nrrdTypeDouble, AIR_FALSE)
+      || nrrdQuantize(nta, ndbl, qrange, 8)
+      || nrrdApply1DRegMapQuantize(ntb, nin, NULL, nmap, AIR_FALSE,
+                                   qrange->min, qrange->max)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble (%s):\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  sprintf(msg, "rmap+quantize,fused %s", what);
+  if (compare(me, msg, nta, ntb)) {
+    airMopError(mop); return 1;
+  }
+
+  /* 2D lut: pairs of values along axis 0 */
+  if (nrrdReshape_va(nin2, nin, 3, AIR_CAST(size_t, 2),
+                     AIR_CAST(size_t, SX/2), AIR_CAST(size_t, SY))
+      || nrrdReshape_va(nref2, nref, 3, AIR_CAST(size_t, 2),
+                        AIR_CAST(size_t, SX/2), AIR_CAST(size_t, SY))
+      || nrrdApply2DLut(ntb, nin2, 0, NULL, NULL, nlut2, nrrdTypeFloat,
+                        AIR_TRUE, AIR_TRUE)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble (%s):\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  nrrdStateThreadNum = 1;
+  if (nrrdApply2DLut(nta, nref2, 0, NULL, NULL, nlut2, nrrdTypeFloat,
+                     AIR_TRUE, AIR_TRUE)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble (%s):\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  sprintf(msg, "lut2 %s", what);
+  if (compare(me, msg, nta, ntb)) {
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  Nrrd *nus, *nsh, *nint, *nfl, *nmap, *nlut2;
+  NrrdRange *qrange;
+  unsigned short *us;
+  short *sh;
+  int *in;
+  float *map, *fl;
+  unsigned int ii;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+#define NEW(N) N = nrrdNew(); airMopAdd(mop, N, (airMopper)nrrdNuke, airMopAlways)
+  NEW(nus); NEW(nsh); NEW(nint); NEW(nfl); NEW(nmap); NEW(nlut2);
+#undef NEW
+  qrange = nrrdRangeNew(0.1, 0.9);
+  airMopAdd(mop, qrange, (airMopper)nrrdRangeNix, airMopAlways);
+
+  if (nrrdMaybeAlloc_va(nus, nrrdTypeUShort, 2,
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(nsh, nrrdTypeShort, 2,
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(nint, nrrdTypeInt, 2,
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(nfl, nrrdTypeFloat, 2,
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(nmap, nrrdTypeFloat, 2,
+                           AIR_CAST(size_t, 4), AIR_CAST(size_t, 23))
+      || nrrdMaybeAlloc_va(nlut2, nrrdTypeFloat, 3, AIR_CAST(size_t, 3),
+                           AIR_CAST(size_t, 17), AIR_CAST(size_t, 13))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  airSrandMT(4343);
+  us = AIR_CAST(unsigned short *, nus->data);
+  sh = AIR_CAST(short *, nsh->data);
+  in = AIR_CAST(int *, nint->data);
+  fl = AIR_CAST(float *, nfl->data);
+  for (ii=0; ii<SX*SY; ii++) {
+    us[ii] = AIR_CAST(unsigned short, airRandInt(60000));
+    sh[ii] = AIR_CAST(short, AIR_CAST(int, airRandInt(60000)) - 30000);
+    /* small enough to be exact as float */
+    in[ii] = AIR_CAST(int, airRandInt(3000000)) - 1500000;
+    /* including values outside the map's range */
+    fl[ii] = AIR_CAST(float, 60000*airDrandMT() - 5000);
+  }
+  map = AIR_CAST(float *, nmap->data);
+  for (ii=0; ii<4*23; ii++) {
+    map[ii] = AIR_CAST(float, airDrandMT());
+  }
+  map = AIR_CAST(float *, nlut2->data);
+  for (ii=0; ii<3*17*13; ii++) {
+    map[ii] = AIR_CAST(float, airDrandMT());
+  }
+
+  nmap->axis[1].min = 1000;
+  nmap->axis[1].max = 50000;
+  if (check(me, "ushort", nus, nmap, nlut2, qrange)
+      || check(me, "float", nfl, nmap, nlut2, qrange)) {
+    airMopError(mop); return 1;
+  }
+  nmap->axis[1].min = -20000;
+  nmap->axis[1].max = 25000;
+  if (check(me, "short", nsh, nmap, nlut2, qrange)) {
+    airMopError(mop); return 1;
+  }
+  nmap->axis[1].min = -1000000;
+  nmap->axis[1].max = 1200000;
+  if (check(me, "int", nint, nmap, nlut2, qrange)) {
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,141 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdRangePercentileSet
+** nrrdStateThreadNum
+**
+** checks exact percentiles (hbins == 0) against sorting all the values,
+** checks that histogram-based percentiles are within their error bound,
+** and checks that threading doesn't change either
+*/
+
+/* enough values that 3 threads will be used */
+#define NUM (3*NRRD_THREAD_GRAIN + 17)
+
+static int
+percSet(NrrdRange *range, const Nrrd *nin, double minPerc, double maxPerc,
+        unsigned int hbins, unsigned int threadNum) {
+
+  nrrdStateThreadNum = threadNum;
+  return nrrdRangePercentileSet(range, nin, minPerc, maxPerc, hbins,
+                                nrrdBlind8BitRangeFalse);
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  Nrrd *nin;
+  NrrdRange *rone, *rthr, *rhst;
+  float *in;
+  double *sorted, want[2], perc[][2] = {{1, 1}, {0.001, 37}, {50, 50},
+                                        {-2, 0}, {0, 100}};
+  size_t ii, rank;
+  unsigned int pi;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  rone = nrrdRangeNew(AIR_NAN, AIR_NAN);
+  airMopAdd(mop, rone, (airMopper)nrrdRangeNix, airMopAlways);
+  rthr = nrrdRangeNew(AIR_NAN, AIR_NAN);
+  airMopAdd(mop, rthr, (airMopper)nrrdRangeNix, airMopAlways);
+  rhst = nrrdRangeNew(AIR_NAN, AIR_NAN);
+  airMopAdd(mop, rhst, (airMopper)nrrdRangeNix, airMopAlways);
+  sorted = AIR_CALLOC(NUM, double);
+  airMopAdd(mop, sorted, airFree, airMopAlways);
+  if (!sorted
+      || nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 1, AIR_CAST(size_t, NUM))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  in = AIR_CAST(float *, nin->data);
+  airSrandMT(4242);
+  for (ii=0; ii<NUM; ii++) {
+    /* long tail, and lots of repeated values */
+    in[ii] = AIR_CAST(float, (ii % 5
+                              ? 1/(0.001 + airDrandMT())
+                              : AIR_CAST(int, ii % 13)));
+    sorted[ii] = in[ii];
+  }
+  qsort(sorted, NUM, sizeof(double), nrrdValCompare[nrrdTypeDouble]);
+
+  for (pi=0; pi<AIR_UINT(sizeof(perc)/sizeof(perc[0])); pi++) {
+    if (percSet(rone, nin, perc[pi][0], perc[pi][1], 0, 1)
+        || percSet(rthr, nin, perc[pi][0], perc[pi][1], 0, 3)
+        || percSet(rhst, nin, perc[pi][0], perc[pi][1], 2000, 3)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with percentiles %g %g:\n%s", me,
+              perc[pi][0], perc[pi][1], err);
+      airMopError(mop); return 1;
+    }
+    /* lowest value with (at least) minPerc of the values at or below
+       it, and highest value with maxPerc of the values at or above it */
+    want[0] = sorted[0];
+    if (perc[pi][0]) {
+      rank = AIR_CAST(size_t, ceil(AIR_ABS(perc[pi][0])*NUM/100.0));
+      want[0] = sorted[AIR_MAX(1, rank) - 1];
+      want[0] = perc[pi][0] > 0 ? want[0] : 2*sorted[0] - want[0];
+    }
+    want[1] = sorted[NUM-1];
+    if (perc[pi][1]) {
+      rank = AIR_CAST(size_t, ceil(AIR_ABS(perc[pi][1])*NUM/100.0));
+      want[1] = sorted[NUM - AIR_MAX(1, rank)];
+      want[1] = perc[pi][1] > 0 ? want[1] : 2*sorted[NUM-1] - want[1];
+    }
+    if (!( want[0] == rone->min && want[1] == rone->max
+           && !rone->minErr && !rone->maxErr )) {
+      fprintf(stderr, "%s: exact %g,%g percentiles %.17g,%.17g (err %g,%g); "
+              "wanted %.17g,%.17g\n", me, perc[pi][0], perc[pi][1],
+              rone->min, rone->max, rone->minErr, rone->maxErr,
+              want[0], want[1]);
+      airMopError(mop); return 1;
+    }
+    if (!( rone->min == rthr->min && rone->max == rthr->max )) {
+      fprintf(stderr, "%s: exact %g,%g percentiles %.17g,%.17g with "
+              "threads; wanted %.17g,%.17g\n", me, perc[pi][0], perc[pi][1],
+              rthr->min, rthr->max, rone->min, rone->max);
+      airMopError(mop); return 1;
+    }
+    if (!( AIR_ABS(rhst->min - want[0]) <= rhst->minErr
+           && AIR_ABS(rhst->max - want[1]) <= rhst->maxErr )) {
+      fprintf(stderr, "%s: histogram %g,%g percentiles %.17g,%.17g not "
+              "within %g,%g of %.17g,%.17g\n", me, perc[pi][0], perc[pi][1],
+              rhst->min, rhst->max, rhst->minErr, rhst->maxErr,
+              want[0], want[1]);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,131 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdCastClampRound
+** nrrdQuantize
+** nrrdUnquantize
+** nrrdStateThreadNum
+**
+** checks values against airIndex and floor, and checks that splitting
+** the work across threads doesn't change the results
+*/
+
+/* enough values that 3 threads will be used */
+#define NUM (3*NRRD_THREAD_GRAIN + 17)
+
+static int
+runAll(Nrrd *nout[3], const Nrrd *nin, unsigned int threadNum) {
+
+  nrrdStateThreadNum = threadNum;
+  return (nrrdCastClampRound(nout[0], nin, nrrdTypeShort,
+                             AIR_TRUE /* clamp */, 1 /* round */)
+          || nrrdQuantize(nout[1], nin, NULL, 16)
+          || nrrdUnquantize(nout[2], nout[1], nrrdTypeFloat));
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  char *err, explain[AIR_STRLEN_LARGE];
+  airArray *mop;
+  Nrrd *nin, *none[3], *nthr[3];
+  float *in;
+  short *rnd;
+  unsigned short *qnt;
+  double min, max, want;
+  size_t ii;
+  unsigned int ni;
+  int differ;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  for (ni=0; ni<3; ni++) {
+    none[ni] = nrrdNew();
+    airMopAdd(mop, none[ni], (airMopper)nrrdNuke, airMopAlways);
+    nthr[ni] = nrrdNew();
+    airMopAdd(mop, nthr[ni], (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 1, AIR_CAST(size_t, NUM))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  in = AIR_CAST(float *, nin->data);
+  airSrandMT(4242);
+  for (ii=0; ii<NUM; ii++) {
+    /* wide enough to need clamping to short; some exact halves */
+    in[ii] = AIR_CAST(float, (ii % 7
+                              ? 80000*(airDrandMT() - 0.5)
+                              : 0.5*AIR_CAST(int, ii % 1001) - 250));
+  }
+
+  if (runAll(none, nin, 1) || runAll(nthr, nin, 3)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  rnd = AIR_CAST(short *, none[0]->data);
+  qnt = AIR_CAST(unsigned short *, none[1]->data);
+  min = none[1]->oldMin;
+  max = none[1]->oldMax;
+  for (ii=0; ii<NUM; ii++) {
+    want = AIR_CLAMP(SHRT_MIN, floor(in[ii] + 0.5), SHRT_MAX);
+    if (want != rnd[ii]) {
+      fprintf(stderr, "%s: round(%.17g) = %d; wanted %g\n", me,
+              in[ii], rnd[ii], want);
+      airMopError(mop); return 1;
+    }
+    want = airIndex(min, in[ii], max, 1 << 16);
+    if (want != qnt[ii]) {
+      fprintf(stderr, "%s: quantize(%.17g) = %u; wanted %g\n", me,
+              in[ii], qnt[ii], want);
+      airMopError(mop); return 1;
+    }
+  }
+
+  for (ni=0; ni<3; ni++) {
+    if (nrrdCompare(none[ni], nthr[ni], AIR_FALSE /* onlyData */,
+                    0.0 /* epsilon */, &differ, explain)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble comparing:\n%s", me, err);
+      airMopError(mop); return 1;
+    }
+    if (differ) {
+      fprintf(stderr, "%s: output %u differs with threads: %s\n",
+              me, ni, explain);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
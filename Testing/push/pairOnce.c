@@ -0,0 +1,272 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/push.h"
+
+/*
+** Tests:
+** pushEnergy->evalN agrees with pushEnergy->eval for every energy
+** with pairOnce, the energy at the first iteration (with a step too
+**   small for the order of updates to matter) is the same as without,
+**   for any number of threads
+** after iterations that re-bin only the points that moved, every
+**   point is in the bin in which pushRebin would put it
+*/
+
+#define DIST_NUM 300
+
+static int
+evalNCheck(const char *me) {
+  static const char *spec[] = {"spring:0.4", "gauss:2.5", "coulomb:1.3",
+                               "cotan", "zero"};
+  pushEnergySpec *ensp;
+  double dist[DIST_NUM], enrN[DIST_NUM], frcN[DIST_NUM], enr, frc, supp;
+  unsigned int si, ii;
+  int ret;
+
+  ensp = pushEnergySpecNew();
+  ret = 0;
+  for (si=0; si<sizeof(spec)/sizeof(spec[0]) && !ret; si++) {
+    if (pushEnergySpecParse(ensp, spec[si])) {
+      char *err = biffGetDone(PUSH);
+      fprintf(stderr, "%s: trouble parsing \"%s\":\n%s", me, spec[si], err);
+      free(err);
+      ret = 1; break;
+    }
+    supp = ensp->energy->support(ensp->parm);
+    for (ii=0; ii<DIST_NUM; ii++) {
+      /* from just above zero to past the support */
+      dist[ii] = AIR_AFFINE(0, ii, DIST_NUM-1, 0.01, 1.5*supp);
+    }
+    ensp->energy->evalN(enrN, frcN, dist, DIST_NUM, ensp->parm);
+    for (ii=0; ii<DIST_NUM; ii++) {
+      ensp->energy->eval(&enr, &frc, dist[ii], ensp->parm);
+      if (!( fabs(enr - enrN[ii]) <= 1e-12*(1 + fabs(enr))
+             && fabs(frc - frcN[ii]) <= 1e-12*(1 + fabs(frc)) )) {
+        fprintf(stderr, "%s: %s at dist %g: eval gave (%g,%g), "
+                "evalN gave (%g,%g)\n", me, ensp->energy->name, dist[ii],
+                enr, frc, enrN[ii], frcN[ii]);
+        ret = 1; break;
+      }
+    }
+  }
+  pushEnergySpecNix(ensp);
+  return ret;
+}
+
+/* a smoothly varying field of anisotropic tensors, all inside the mask;
+   without a space, world space is about 2 units across */
+static int
+fieldMake(Nrrd *nin) {
+  static const char me[]="fieldMake";
+  unsigned int sx, sy, sz, xi, yi, zi;
+  double xx, yy, zz;
+  float *ten;
+
+  sx = 16; sy = 15; sz = 14;
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 4, AIR_CAST(size_t, 7),
+                        AIR_CAST(size_t, sx), AIR_CAST(size_t, sy),
+                        AIR_CAST(size_t, sz))) {
+    biffMovef(PUSH, NRRD, "%s: trouble allocating", me);
+    return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  ten = AIR_CAST(float *, nin->data);
+  for (zi=0; zi<sz; zi++) {
+    zz = AIR_AFFINE(0, zi, sz-1, -1, 1);
+    for (yi=0; yi<sy; yi++) {
+      yy = AIR_AFFINE(0, yi, sy-1, -1, 1);
+      for (xi=0; xi<sx; xi++) {
+        xx = AIR_AFFINE(0, xi, sx-1, -1, 1);
+        TEN_T_SET_TT(ten, float, 1.0,
+                     1.0 + 0.3*xx, 0.2*yy, 0.1*zz,
+                     0.8 - 0.2*yy, 0.1*xx,
+                     0.7 + 0.1*zz);
+        ten += 7;
+      }
+    }
+  }
+  return 0;
+}
+
+static pushContext *
+pushMake(airArray *mop, Nrrd *nin, int pairOnce, unsigned int threadNum,
+         double step) {
+  static const char me[]="pushMake";
+  pushContext *pctx;
+
+  pctx = pushContextNew();
+  airMopAdd(mop, pctx, (airMopper)pushContextNix, airMopAlways);
+  pctx->nin = nin;
+  pctx->pointNum = 700;
+  pctx->scale = 0.08;
+  pctx->stepInitial = step;
+  pctx->neighborTrueProb = 1.0;
+  pctx->probeProb = 1.0;
+  pctx->threadNum = threadNum;
+  pctx->pairOnce = pairOnce;
+  pctx->binIncr = 32;
+  pctx->seedThreshItem = tenGageUnknown;
+  if (pushEnergySpecParse(pctx->ensp, "cotan")) {
+    biffMovef(NRRD, PUSH, "%s: trouble setting energy", me);
+    return NULL;
+  }
+  if (nrrdKernelSpecParse(pctx->ksp00, "tent")
+      || nrrdKernelSpecParse(pctx->ksp11, "fordif")
+      || nrrdKernelSpecParse(pctx->ksp22, "cubicdd:1,0")) {
+    biffAddf(NRRD, "%s: trouble setting kernels", me);
+    return NULL;
+  }
+  return pctx;
+}
+
+/* every point knows its own bin, and pushRebin doesn't change any bin */
+static int
+binCheck(const char *me, pushContext *pctx, unsigned int *count) {
+  unsigned int bi, pi, total;
+
+  total = 0;
+  for (bi=0; bi<pctx->binNum; bi++) {
+    for (pi=0; pi<pctx->bin[bi].pointNum; pi++) {
+      if (bi != pctx->bin[bi].point[pi]->binIdx) {
+        fprintf(stderr, "%s: point %u in bin %u thinks it's in bin %u\n", me,
+                pctx->bin[bi].point[pi]->ttaagg, bi,
+                pctx->bin[bi].point[pi]->binIdx);
+        return 1;
+      }
+    }
+    count[bi] = pctx->bin[bi].pointNum;
+    total += count[bi];
+  }
+  if (total != pctx->pointNum) {
+    fprintf(stderr, "%s: have %u points in bins, not %u\n", me,
+            total, pctx->pointNum);
+    return 1;
+  }
+  if (pushRebin(pctx)) {
+    return 1;
+  }
+  for (bi=0; bi<pctx->binNum; bi++) {
+    if (count[bi] != pctx->bin[bi].pointNum) {
+      fprintf(stderr, "%s: bin %u had %u points, but %u after pushRebin\n",
+              me, bi, count[bi], pctx->bin[bi].pointNum);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  Nrrd *nin;
+  pushContext *pctx;
+  unsigned int threadNum, iter, *count;
+  double enrRef;
+  int pairOnce;
+  char *err;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  if (evalNCheck(argv[0])) {
+    airMopError(mop); return 1;
+  }
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (fieldMake(nin)) {
+    airMopAdd(mop, err = biffGetDone(PUSH), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+
+  /* first iteration energy */
+  enrRef = AIR_NAN;
+  for (pairOnce=0; pairOnce<=1; pairOnce++) {
+    for (threadNum=1; threadNum<=(pairOnce ? 4 : 1); threadNum++) {
+      if (!(pctx = pushMake(mop, nin, pairOnce, threadNum, 1e-16))) {
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+        airMopError(mop); return 1;
+      }
+      if (pushStart(pctx)
+          || pushIterate(pctx)
+          || pushFinish(pctx)) {
+        airMopAdd(mop, err = biffGetDone(PUSH), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+        airMopError(mop); return 1;
+      }
+      if (!pairOnce) {
+        enrRef = pctx->energySum;
+      } else if (!( fabs(pctx->energySum - enrRef) < 1e-9*fabs(enrRef) )) {
+        fprintf(stderr, "%s: with pairOnce and %u threads, energy %.17g "
+                "!= %.17g without\n", argv[0], threadNum,
+                pctx->energySum, enrRef);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+  if (!( enrRef > 0 )) {
+    fprintf(stderr, "%s: first iteration energy %g not > 0; "
+            "points not interacting?\n", argv[0], enrRef);
+    airMopError(mop); return 1;
+  }
+
+  /* binning after points have moved */
+  for (pairOnce=0; pairOnce<=1; pairOnce++) {
+    for (threadNum=1; threadNum<=3; threadNum += 2) {
+      if (!(pctx = pushMake(mop, nin, pairOnce, threadNum, 1.0))) {
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+        airMopError(mop); return 1;
+      }
+      if (pushStart(pctx)) {
+        airMopAdd(mop, err = biffGetDone(PUSH), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+        airMopError(mop); return 1;
+      }
+      count = AIR_CALLOC(pctx->binNum, unsigned int);
+      airMopAdd(mop, count, airFree, airMopAlways);
+      for (iter=0; iter<8; iter++) {
+        if (pushIterate(pctx)) {
+          airMopAdd(mop, err = biffGetDone(PUSH), airFree, airMopAlways);
+          fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+          airMopError(mop); return 1;
+        }
+        if (binCheck(argv[0], pctx, count)) {
+          fprintf(stderr, "%s: (pairOnce %d, %u threads, iter %u)\n",
+                  argv[0], pairOnce, threadNum, iter);
+          airMopError(mop); return 1;
+        }
+      }
+      if (pushFinish(pctx)) {
+        airMopAdd(mop, err = biffGetDone(PUSH), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,225 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/seek.h"
+
+/*
+** Tests:
+** seekExtract with several threads against seekExtract with one thread,
+** for isocontours (of a plain scalar volume, and through gage) and ridge
+** surfaces (with strength).  The output polydata should be identical.
+*/
+
+#define SX 41
+#define SY 37
+#define SZ 33
+
+static int
+extractCompare(seekContext *sctx, const char *what) {
+  static const char me[]="extractCompare";
+  limnPolyData *pldA, *pldB;
+  unsigned int threadNum[3] = {2, 3, 16}, ti;
+  airArray *mop;
+  char *err;
+
+  mop = airMopNew();
+  pldA = limnPolyDataNew();
+  airMopAdd(mop, pldA, (airMopper)limnPolyDataNix, airMopAlways);
+  pldB = limnPolyDataNew();
+  airMopAdd(mop, pldB, (airMopper)limnPolyDataNix, airMopAlways);
+  if (seekThreadNumSet(sctx, 1)
+      || seekUpdate(sctx)
+      || seekExtract(sctx, pldA)) {
+    airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+    fprintf(stderr, "%s: %s: trouble with 1 thread:\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  if (!(pldA->xyzwNum && pldA->indxNum)) {
+    fprintf(stderr, "%s: %s: got empty surface (%u verts, %u indices)\n",
+            me, what, pldA->xyzwNum, pldA->indxNum);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<3; ti++) {
+    if (seekThreadNumSet(sctx, threadNum[ti])
+        || seekUpdate(sctx)
+        || seekExtract(sctx, pldB)) {
+      airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+      fprintf(stderr, "%s: %s: trouble with %u threads:\n%s", me, what,
+              threadNum[ti], err);
+      airMopError(mop); return 1;
+    }
+    if (!(pldA->xyzwNum == pldB->xyzwNum
+          && pldA->normNum == pldB->normNum
+          && pldA->indxNum == pldB->indxNum
+          && pldA->icnt[0] == pldB->icnt[0])) {
+      fprintf(stderr, "%s: %s: %u threads gave %u verts, %u norms, %u indices "
+              "!= %u, %u, %u from 1 thread\n", me, what, threadNum[ti],
+              pldB->xyzwNum, pldB->normNum, pldB->indxNum,
+              pldA->xyzwNum, pldA->normNum, pldA->indxNum);
+      airMopError(mop); return 1;
+    }
+    if (memcmp(pldA->xyzw, pldB->xyzw, 4*sizeof(float)*pldA->xyzwNum)
+        || (pldA->normNum
+            && memcmp(pldA->norm, pldB->norm, 3*sizeof(float)*pldA->normNum))
+        || memcmp(pldA->indx, pldB->indx,
+                  sizeof(unsigned int)*pldA->indxNum)) {
+      fprintf(stderr, "%s: %s: %u threads gave different geometry\n",
+              me, what, threadNum[ti]);
+      airMopError(mop); return 1;
+    }
+  }
+  fprintf(stderr, "%s: %s: %u verts, %u tris: same with all thread counts\n",
+          me, what, pldA->xyzwNum, pldA->indxNum/3);
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  Nrrd *nin;
+  float *vol;
+  unsigned int xi, yi, zi;
+  size_t samples[3];
+  gageContext *gctx;
+  gagePerVolume *pvl;
+  seekContext *sctx;
+  double kparm[3] = {1.0, 1.0, 0.0};
+  char *err;
+  int E;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3,
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY),
+                        AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  vol = AIR_CAST(float *, nin->data);
+  for (zi=0; zi<SZ; zi++) {
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        double dd;
+        /* ridge surface (with gaussian profile) around a curved sheet */
+        dd = zi - (SZ/2 + 2*sin(0.15*xi) + 1.5*cos(0.12*yi));
+        vol[xi + SX*(yi + SY*zi)] = AIR_CAST(float, exp(-dd*dd/(2*2.5*2.5)));
+      }
+    }
+  }
+
+  /* isocontour of plain scalar volume, normals by differencing */
+  sctx = seekContextNew();
+  airMopAdd(mop, sctx, (airMopper)seekContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= seekDataSet(sctx, nin, NULL, 0);
+  if (!E) E |= seekNormalsFindSet(sctx, AIR_TRUE);
+  if (!E) E |= seekTypeSet(sctx, seekTypeIsocontour);
+  if (!E) E |= seekIsovalueSet(sctx, 0.3);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  if (extractCompare(sctx, "isocontour")) {
+    airMopError(mop); return 1;
+  }
+
+  /* everything else goes through gage */
+  gctx = gageContextNew();
+  airMopAdd(mop, gctx, (airMopper)gageContextNix, airMopAlways);
+  pvl = gagePerVolumeNew(gctx, nin, gageKindScl);
+  E = 0;
+  if (!E) E |= !pvl;
+  if (!E) E |= gagePerVolumeAttach(gctx, pvl);
+  if (!E) E |= gageKernelSet(gctx, gageKernel00, nrrdKernelBCCubic, kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel11, nrrdKernelBCCubicD, kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel22, nrrdKernelBCCubicDD, kparm);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclValue);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclNormal);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclGradVec);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclHessEval);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclHessEval2);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclHessEvec);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclHessEvec2);
+  if (!E) E |= gageUpdate(gctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up gage:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+
+  /* isocontour through gage, with up-sampling and normals from gage */
+  sctx = seekContextNew();
+  airMopAdd(mop, sctx, (airMopper)seekContextNix, airMopAlways);
+  samples[0] = 50;
+  samples[1] = 45;
+  samples[2] = 40;
+  E = 0;
+  if (!E) E |= seekDataSet(sctx, NULL, gctx, 0);
+  if (!E) E |= seekSamplesSet(sctx, samples);
+  if (!E) E |= seekItemScalarSet(sctx, gageSclValue);
+  if (!E) E |= seekItemNormalSet(sctx, gageSclNormal);
+  if (!E) E |= seekNormalsFindSet(sctx, AIR_TRUE);
+  if (!E) E |= seekTypeSet(sctx, seekTypeIsocontour);
+  if (!E) E |= seekIsovalueSet(sctx, 0.5);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  if (extractCompare(sctx, "gage isocontour")) {
+    airMopError(mop); return 1;
+  }
+
+  /* ridge surface, with strength */
+  sctx = seekContextNew();
+  airMopAdd(mop, sctx, (airMopper)seekContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= seekDataSet(sctx, NULL, gctx, 0);
+  if (!E) E |= seekSamplesSet(sctx, samples);
+  if (!E) E |= seekItemGradientSet(sctx, gageSclGradVec);
+  if (!E) E |= seekItemEigensystemSet(sctx, gageSclHessEval,
+                                      gageSclHessEvec);
+  if (!E) E |= seekItemNormalSet(sctx, gageSclHessEvec2);
+  if (!E) E |= seekStrengthUseSet(sctx, AIR_TRUE);
+  if (!E) E |= seekStrengthSet(sctx, -1, 5);
+  if (!E) E |= seekItemStrengthSet(sctx, gageSclHessEval2);
+  if (!E) E |= seekNormalsFindSet(sctx, AIR_TRUE);
+  if (!E) E |= seekTypeSet(sctx, seekTypeRidgeSurface);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  if (extractCompare(sctx, "ridge surface")) {
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
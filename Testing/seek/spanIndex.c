@@ -0,0 +1,215 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "teem/seek.h"
+
+/*
+** Tests:
+** isocontour extraction using the span space index (built by seekUpdate,
+** or given back with seekSpanIndexSet) against the plain slab-by-slab
+** extraction, at several isovalues (including ones outside the range of
+** values).  The output polydata should be identical.
+*/
+
+#define SX 41
+#define SY 37
+#define SZ 33
+
+static int
+pldCompare(const limnPolyData *pldA, const limnPolyData *pldB) {
+
+  return !(pldA->xyzwNum == pldB->xyzwNum
+           && pldA->normNum == pldB->normNum
+           && pldA->indxNum == pldB->indxNum
+           && pldA->icnt[0] == pldB->icnt[0]
+           && !memcmp(pldA->xyzw, pldB->xyzw,
+                      4*sizeof(float)*pldA->xyzwNum)
+           && (!pldA->normNum
+               || !memcmp(pldA->norm, pldB->norm,
+                          3*sizeof(float)*pldA->normNum))
+           && !memcmp(pldA->indx, pldB->indx,
+                      sizeof(unsigned int)*pldA->indxNum));
+}
+
+static int
+extractCompare(seekContext *sctx, const char *what) {
+  static const char me[]="extractCompare";
+  limnPolyData *pldA, *pldB;
+  double isoval[6] = {-1.0, 0.05, 0.3, 0.5, 0.9, 2.0};
+  unsigned int ii;
+  Nrrd *nidx;
+  airArray *mop;
+  char *err;
+
+  mop = airMopNew();
+  pldA = limnPolyDataNew();
+  airMopAdd(mop, pldA, (airMopper)limnPolyDataNix, airMopAlways);
+  pldB = limnPolyDataNew();
+  airMopAdd(mop, pldB, (airMopper)limnPolyDataNix, airMopAlways);
+  nidx = nrrdNew();
+  airMopAdd(mop, nidx, (airMopper)nrrdNuke, airMopAlways);
+  for (ii=0; ii<6; ii++) {
+    if (seekIsovalueSet(sctx, isoval[ii])
+        || seekSpanIndexUseSet(sctx, AIR_FALSE)
+        || seekUpdate(sctx)
+        || seekExtract(sctx, pldA)
+        || seekSpanIndexUseSet(sctx, AIR_TRUE)
+        || seekUpdate(sctx)
+        || seekExtract(sctx, pldB)) {
+      airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+      fprintf(stderr, "%s: %s: trouble at isovalue %g:\n%s", me, what,
+              isoval[ii], err);
+      airMopError(mop); return 1;
+    }
+    if (pldCompare(pldA, pldB)) {
+      fprintf(stderr, "%s: %s: isovalue %g: indexed extraction gave "
+              "%u verts, %u indices != %u, %u\n", me, what, isoval[ii],
+              pldB->xyzwNum, pldB->indxNum, pldA->xyzwNum, pldA->indxNum);
+      airMopError(mop); return 1;
+    }
+    fprintf(stderr, "%s: %s: isovalue %g: %u verts, %u tris: same\n",
+            me, what, isoval[ii], pldA->xyzwNum, pldA->indxNum/3);
+  }
+
+  /* save the index, and give it back */
+  if (nrrdCopy(nidx, sctx->nspanIndex)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: %s: trouble copying index:\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  if (seekSpanIndexUseSet(sctx, AIR_FALSE)
+      || seekSpanIndexSet(sctx, nidx)
+      || seekUpdate(sctx)
+      || seekExtract(sctx, pldB)) {
+    airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+    fprintf(stderr, "%s: %s: trouble with given index:\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  if (pldCompare(pldA, pldB)) {
+    fprintf(stderr, "%s: %s: given index gave different output\n", me, what);
+    airMopError(mop); return 1;
+  }
+  if (seekSpanIndexSet(sctx, NULL)) {
+    airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+    fprintf(stderr, "%s: %s: trouble forgetting index:\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  Nrrd *nin;
+  float *vol;
+  unsigned int xi, yi, zi;
+  size_t samples[3];
+  gageContext *gctx;
+  gagePerVolume *pvl;
+  seekContext *sctx;
+  double kparm[3] = {1.0, 1.0, 0.0};
+  char *err;
+  int E;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3,
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY),
+                        AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  vol = AIR_CAST(float *, nin->data);
+  for (zi=0; zi<SZ; zi++) {
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        double dd;
+        dd = zi - (SZ/2 + 2*sin(0.15*xi) + 1.5*cos(0.12*yi));
+        vol[xi + SX*(yi + SY*zi)] = AIR_CAST(float, exp(-dd*dd/(2*2.5*2.5)));
+      }
+    }
+  }
+
+  /* isocontour of plain scalar volume, normals by differencing */
+  sctx = seekContextNew();
+  airMopAdd(mop, sctx, (airMopper)seekContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= seekDataSet(sctx, nin, NULL, 0);
+  if (!E) E |= seekNormalsFindSet(sctx, AIR_TRUE);
+  if (!E) E |= seekTypeSet(sctx, seekTypeIsocontour);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  if (extractCompare(sctx, "isocontour")) {
+    airMopError(mop); return 1;
+  }
+
+  /* isocontour through gage, with up-sampling and normals from gage */
+  gctx = gageContextNew();
+  airMopAdd(mop, gctx, (airMopper)gageContextNix, airMopAlways);
+  pvl = gagePerVolumeNew(gctx, nin, gageKindScl);
+  E = 0;
+  if (!E) E |= !pvl;
+  if (!E) E |= gagePerVolumeAttach(gctx, pvl);
+  if (!E) E |= gageKernelSet(gctx, gageKernel00, nrrdKernelBCCubic, kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel11, nrrdKernelBCCubicD, kparm);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclValue);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclNormal);
+  if (!E) E |= gageUpdate(gctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up gage:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  sctx = seekContextNew();
+  airMopAdd(mop, sctx, (airMopper)seekContextNix, airMopAlways);
+  samples[0] = 50;
+  samples[1] = 45;
+  samples[2] = 40;
+  E = 0;
+  if (!E) E |= seekDataSet(sctx, NULL, gctx, 0);
+  if (!E) E |= seekSamplesSet(sctx, samples);
+  if (!E) E |= seekItemScalarSet(sctx, gageSclValue);
+  if (!E) E |= seekItemNormalSet(sctx, gageSclNormal);
+  if (!E) E |= seekNormalsFindSet(sctx, AIR_TRUE);
+  if (!E) E |= seekTypeSet(sctx, seekTypeIsocontour);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(SEEK), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  if (extractCompare(sctx, "gage isocontour")) {
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,114 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenAnisoVolume and tenAnisoVolumeParallel against per-voxel
+** tenAnisoTen_f, for every anisotropy measure, with one and with several
+** threads.  Measures needing eigenvalues come from batched eigensolves,
+** which are supposed to give bit-wise identical results.  The volume
+** is big enough to need more than one batch.
+*/
+
+#define SIZE 41
+#define THRESH 0.5
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nten, *nout;
+  float *ten, *out, want;
+  size_t ii, NN;
+  unsigned int ti, threadNum[3] = {0, 1, 4};
+  int aniso;
+  char *err;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  nout = nrrdNew();
+  airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_CAST(size_t, 7),
+                        AIR_CAST(size_t, SIZE), AIR_CAST(size_t, SIZE),
+                        AIR_CAST(size_t, SIZE))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  nten->axis[0].kind = nrrdKind3DMaskedSymMatrix;
+  NN = nrrdElementNumber(nten)/7;
+  ten = AIR_CAST(float *, nten->data);
+  for (ii=0; ii<NN; ii++) {
+    float *tt, conf;
+    tt = ten + 7*ii;
+    conf = AIR_CAST(float, airDrandMT_r(rng));
+    if (!(ii % 5)) {
+      /* isotropic, for repeated roots */
+      TEN_T_SET(tt, conf, 2.0f, 0.0f, 0.0f, 2.0f, 0.0f, 2.0f);
+    } else {
+      /* diagonally dominant, so positive-definite */
+      TEN_T_SET(tt, conf,
+                AIR_CAST(float, 1 + airDrandMT_r(rng)),
+                AIR_CAST(float, (airDrandMT_r(rng) - 0.5)/2),
+                AIR_CAST(float, (airDrandMT_r(rng) - 0.5)/2),
+                AIR_CAST(float, 1 + airDrandMT_r(rng)),
+                AIR_CAST(float, (airDrandMT_r(rng) - 0.5)/2),
+                AIR_CAST(float, 1 + airDrandMT_r(rng)));
+    }
+  }
+
+  for (aniso=tenAnisoUnknown+1; aniso<tenAnisoLast; aniso++) {
+    /* threadNum 0 means: use the serial tenAnisoVolume */
+    for (ti=0; ti<3; ti++) {
+      if (threadNum[ti]
+          ? tenAnisoVolumeParallel(nout, nten, aniso, THRESH, threadNum[ti])
+          : tenAnisoVolume(nout, nten, aniso, THRESH)) {
+        airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+        airMopError(mop); return 1;
+      }
+      out = AIR_CAST(float *, nout->data);
+      for (ii=0; ii<NN; ii++) {
+        want = ((tenAniso_Conf != aniso && ten[7*ii] < THRESH)
+                ? 0.0f
+                : tenAnisoTen_f(ten + 7*ii, aniso));
+        if (memcmp(&want, out + ii, sizeof(float))) {
+          fprintf(stderr, "%s: (%s, %u threads) voxel %u: volume %g "
+                  "!= single %g\n", argv[0], airEnumStr(tenAniso, aniso),
+                  threadNum[ti], AIR_CAST(unsigned int, ii), out[ii], want);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenEigensolveBatch_f (and so ell_3ms_eigensolve_batch_f) against
+** tenEigensolve_f, and ell_3m_eigensolve_batch_d against
+** ell_3m_eigensolve_d, on random tensors and matrices (including ones
+** with repeated eigenvalues), with one and with several threads.
+** The batch versions are supposed to give bit-wise identical results.
+*/
+
+#define NUM 5000
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  float *ten, *evalB, *evecB, eval[3], evec[9];
+  double *mat, *evalBD, *evecBD, evalD[3], evecD[9];
+  int *rootsBD, roots;
+  unsigned int ii, ti, threadNum[2] = {1, 4};
+  char *err;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  ten = AIR_CALLOC(7*NUM, float);
+  airMopAdd(mop, ten, airFree, airMopAlways);
+  evalB = AIR_CALLOC(3*NUM, float);
+  airMopAdd(mop, evalB, airFree, airMopAlways);
+  evecB = AIR_CALLOC(9*NUM, float);
+  airMopAdd(mop, evecB, airFree, airMopAlways);
+  mat = AIR_CALLOC(9*NUM, double);
+  airMopAdd(mop, mat, airFree, airMopAlways);
+  evalBD = AIR_CALLOC(3*NUM, double);
+  airMopAdd(mop, evalBD, airFree, airMopAlways);
+  evecBD = AIR_CALLOC(9*NUM, double);
+  airMopAdd(mop, evecBD, airFree, airMopAlways);
+  rootsBD = AIR_CALLOC(NUM, int);
+  airMopAdd(mop, rootsBD, airFree, airMopAlways);
+  if (!(ten && evalB && evecB && mat && evalBD && evecBD && rootsBD)) {
+    fprintf(stderr, "%s: couldn't allocate buffers\n", argv[0]);
+    airMopError(mop); return 1;
+  }
+
+  for (ii=0; ii<NUM; ii++) {
+    float *tt;
+    double *mm;
+    tt = ten + 7*ii;
+    mm = mat + 9*ii;
+    switch (ii % 5) {
+    case 0:
+      /* isotropic */
+      TEN_T_SET(tt, 1.0f, 2.0f, 0.0f, 0.0f, 2.0f, 0.0f, 2.0f);
+      break;
+    case 1:
+      /* cylindrically symmetric */
+      TEN_T_SET(tt, 1.0f, 3.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
+      break;
+    default:
+      TEN_T_SET(tt, AIR_CAST(float, airDrandMT_r(rng)),
+                AIR_CAST(float, airDrandMT_r(rng) - 0.5),
+                AIR_CAST(float, airDrandMT_r(rng) - 0.5),
+                AIR_CAST(float, airDrandMT_r(rng) - 0.5),
+                AIR_CAST(float, airDrandMT_r(rng) - 0.5),
+                AIR_CAST(float, airDrandMT_r(rng) - 0.5),
+                AIR_CAST(float, airDrandMT_r(rng) - 0.5));
+      break;
+    }
+    /* not symmetric, so some will have only a single real root */
+    ELL_3M_SET(mm, airDrandMT_r(rng), airDrandMT_r(rng), airDrandMT_r(rng),
+               airDrandMT_r(rng), airDrandMT_r(rng), airDrandMT_r(rng),
+               airDrandMT_r(rng), airDrandMT_r(rng), airDrandMT_r(rng));
+  }
+
+  for (ti=0; ti<2; ti++) {
+    if (tenEigensolveBatch_f(evalB, evecB, ten, NUM, threadNum[ti])) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+      airMopError(mop); return 1;
+    }
+    for (ii=0; ii<NUM; ii++) {
+      tenEigensolve_f(eval, evec, ten + 7*ii);
+      if (memcmp(eval, evalB + 3*ii, 3*sizeof(float))
+          || memcmp(evec, evecB + 9*ii, 9*sizeof(float))) {
+        fprintf(stderr, "%s: (%u threads) tensor %u: batch eigensystem "
+                "(%g,%g,%g) != single (%g,%g,%g)\n", argv[0],
+                threadNum[ti], ii, evalB[0 + 3*ii], evalB[1 + 3*ii],
+                evalB[2 + 3*ii], eval[0], eval[1], eval[2]);
+        airMopError(mop); return 1;
+      }
+    }
+    if (ell_3m_eigensolve_batch_d(evalBD, evecBD, rootsBD, mat, NUM,
+                                  AIR_TRUE, threadNum[ti])) {
+      airMopAdd(mop, err = biffGetDone(ELL), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble:\n%s", argv[0], err);
+      airMopError(mop); return 1;
+    }
+    for (ii=0; ii<NUM; ii++) {
+      unsigned int vi;
+      roots = ell_3m_eigensolve_d(evalD, evecD, mat + 9*ii, AIR_TRUE);
+      if (roots != rootsBD[ii]) {
+        fprintf(stderr, "%s: (%u threads) matrix %u: batch roots %d "
+                "!= single %d\n", argv[0], threadNum[ti], ii,
+                rootsBD[ii], roots);
+        airMopError(mop); return 1;
+      }
+      /* with a single root, the other values are NaN */
+      for (vi=0; vi<9; vi++) {
+        if ((vi < 3
+             && !(evalD[vi] == evalBD[vi + 3*ii]
+                  || (!AIR_EXISTS(evalD[vi])
+                      && !AIR_EXISTS(evalBD[vi + 3*ii]))))
+            || !(evecD[vi] == evecBD[vi + 9*ii]
+                 || (!AIR_EXISTS(evecD[vi])
+                     && !AIR_EXISTS(evecBD[vi + 9*ii])))) {
+          fprintf(stderr, "%s: (%u threads) matrix %u: batch eigensystem "
+                  "differs from single (at %u)\n", argv[0],
+                  threadNum[ti], ii, vi);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
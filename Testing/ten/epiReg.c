@@ -0,0 +1,171 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenEpiRegister4DParallel, on synthetic DWIs in which each slice of an
+** ellipse is sheared, scaled, and translated along Y according to
+** the gradient direction.  The registration has to give the same
+** result with one and with several threads, and (with and without
+** downsampling for the estimation) has to undo most of the distortion.
+*/
+
+#define SX 64
+#define SY 72
+#define SZ 8
+#define DWI_NUM 13
+#define THRESH 400
+
+/* the number of DWI voxels on the wrong side of the undistorted ellipse */
+static size_t
+maskErrors(const Nrrd *ndwi) {
+  const unsigned short *dwi;
+  unsigned int xi, yi, zi, ni;
+  double xx, yy, rz;
+  size_t bad;
+
+  dwi = AIR_CAST(const unsigned short *, ndwi->data);
+  bad = 0;
+  for (zi=0; zi<SZ; zi++) {
+    rz = 1 - (zi - SZ/2.0)*(zi - SZ/2.0)/(0.6*SZ*0.6*SZ);
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        xx = (xi - SX/2.0)/22;
+        yy = (yi - SY/2.0)/28;
+        for (ni=1; ni<DWI_NUM; ni++) {
+          bad += ((xx*xx + yy*yy < rz)
+                  != (dwi[ni + DWI_NUM*(xi + SX*(yi + SY*zi))] > THRESH));
+        }
+      }
+    }
+  }
+  return bad;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nin, *ngrad, *nout[3];
+  unsigned short *dwi;
+  double *grad, len, kparm[3] = {1.0, 0.0, 0.5};
+  unsigned int xi, yi, zi, ni, oi,
+    threadNum[3] = {1, 3, 3}, shrink[3] = {1, 1, 2};
+  size_t inBad, outBad;
+  char *err, explain[AIR_STRLEN_LARGE];
+  int differ;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  ngrad = nrrdNew();
+  airMopAdd(mop, ngrad, (airMopper)nrrdNuke, airMopAlways);
+  for (oi=0; oi<3; oi++) {
+    nout[oi] = nrrdNew();
+    airMopAdd(mop, nout[oi], (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeUShort, 4, AIR_CAST(size_t, DWI_NUM),
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY),
+                        AIR_CAST(size_t, SZ))
+      || nrrdMaybeAlloc_va(ngrad, nrrdTypeDouble, 2, AIR_CAST(size_t, 3),
+                           AIR_CAST(size_t, DWI_NUM))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  dwi = AIR_CAST(unsigned short *, nin->data);
+  grad = AIR_CAST(double *, ngrad->data);
+  for (ni=0; ni<DWI_NUM; ni++) {
+    double *gg, hh, ss, tt, rz, xx, yy;
+    gg = grad + 3*ni;
+    if (ni) {
+      ELL_3V_SET(gg, airDrandMT_r(rng) - 0.5, airDrandMT_r(rng) - 0.5,
+                 airDrandMT_r(rng) - 0.5);
+      ELL_3V_NORM(gg, gg, len);
+    } else {
+      ELL_3V_SET(gg, 0, 0, 0);
+    }
+    hh = 0.06*gg[0];
+    ss = 1 + 0.05*gg[1];
+    tt = 2.5*gg[2];
+    for (zi=0; zi<SZ; zi++) {
+      rz = 1 - (zi - SZ/2.0)*(zi - SZ/2.0)/(0.6*SZ*0.6*SZ);
+      for (yi=0; yi<SY; yi++) {
+        for (xi=0; xi<SX; xi++) {
+          xx = xi - SX/2.0;
+          yy = (yi - SY/2.0 - hh*xx - tt)/ss;
+          xx /= 22;
+          yy /= 28;
+          dwi[ni + DWI_NUM*(xi + SX*(yi + SY*zi))] = AIR_CAST(
+            unsigned short, (xx*xx + yy*yy < rz
+                             ? 800 + 200*sin(0.3*xi)*cos(0.2*yi)
+                             : 30) + 40*airDrandMT_r(rng));
+        }
+      }
+    }
+  }
+
+  for (oi=0; oi<3; oi++) {
+    if (tenEpiRegister4DParallel(nout[oi], nin, ngrad, -1 /* reference */,
+                                 1.0, 2.0 /* bwX, bwY */, 0.7 /* fitFrac */,
+                                 AIR_NAN /* DWthr */, AIR_TRUE /* doCC */,
+                                 shrink[oi], nrrdKernelBCCubic, kparm,
+                                 threadNum[oi], AIR_FALSE, AIR_FALSE)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble registering (%u threads, shrink %u):\n%s",
+              argv[0], threadNum[oi], shrink[oi], err);
+      airMopError(mop); return 1;
+    }
+  }
+  if (nrrdCompare(nout[0], nout[1], AIR_TRUE /* onlyData */, 0.0,
+                  &differ, explain)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble comparing:\n%s", argv[0], err);
+    airMopError(mop); return 1;
+  }
+  if (differ) {
+    fprintf(stderr, "%s: result with %u threads differs from with %u: %s\n",
+            argv[0], threadNum[1], threadNum[0], explain);
+    airMopError(mop); return 1;
+  }
+  inBad = maskErrors(nin);
+  for (oi=1; oi<3; oi++) {
+    outBad = maskErrors(nout[oi]);
+    if (!( 3*outBad < inBad )) {
+      char stmp1[AIR_STRLEN_SMALL], stmp2[AIR_STRLEN_SMALL];
+      fprintf(stderr, "%s: (shrink %u) registration left %s voxels "
+              "mis-segmented (of %s before)\n", argv[0], shrink[oi],
+              airSprintSize_t(stmp1, outBad), airSprintSize_t(stmp2, inBad));
+      airMopError(mop); return 1;
+    }
+  }
+
+  printf("All ok.\n");
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,295 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenFiberMultiMap, tenFiberPolyDataMap
+**
+** maps from fibers traced in a synthetic tensor field have to be the
+** same with one and with several threads, and every fiber has to be
+** counted at its seed point.  Maps from straight fibers along rows of
+** voxels have to have exactly the expected density, color, and
+** connectivity.
+*/
+
+#define SX 20
+#define SY 14
+#define SZ 11
+#define SEED_NUM 400
+
+static void
+makeTen(Nrrd *nten) {
+  float *ten;
+  double vv[3], mat[9], len;
+  unsigned int xi, yi, zi;
+
+  ten = AIR_CAST(float *, nten->data);
+  for (zi=0; zi<SZ; zi++) {
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        ELL_3V_SET(vv, 1, 0.6*sin(0.4*yi + 0.3*zi), 0.4*cos(0.5*xi));
+        ELL_3V_NORM(vv, vv, len);
+        ELL_3MV_OUTER(mat, vv, vv);
+        ELL_3M_SCALE(mat, 0.8, mat);
+        mat[0] += 0.2; mat[4] += 0.2; mat[8] += 0.2;
+        TEN_M2T_TT(ten, float, mat);
+        ten[0] = 1.0;
+        ten += 7;
+      }
+    }
+  }
+}
+
+static int
+compare(const char *me, const char *what, const Nrrd *na, const Nrrd *nb) {
+  char *err, explain[AIR_STRLEN_LARGE];
+  int differ;
+
+  if (nrrdCompare(na, nb, AIR_FALSE /* onlyData */, 0.0 /* epsilon */,
+                  &differ, explain)) {
+    err = biffGetDone(NRRD);
+    fprintf(stderr, "%s: trouble comparing %s:\n%s", me, what, err);
+    free(err);
+    return 1;
+  }
+  if (differ) {
+    fprintf(stderr, "%s: %s differ with 1 and 3 threads: %s\n",
+            me, what, explain);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nten, *nseed, *nlab, *nmap[2][3];
+  tenFiberContext *tfx;
+  tenFiberMulti *tfml;
+  limnPolyData *pld;
+  double *seed, ipos[3], wpos[3];
+  const unsigned int *dens, *conn;
+  const float *rgb;
+  unsigned char *lab;
+  unsigned int ii, mi, fi, vi, xi, yi, zi, rowNum, hit[SY*SZ],
+    fiberNum, connSum;
+  int E;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  nseed = nrrdNew();
+  airMopAdd(mop, nseed, (airMopper)nrrdNuke, airMopAlways);
+  nlab = nrrdNew();
+  airMopAdd(mop, nlab, (airMopper)nrrdNuke, airMopAlways);
+  for (ii=0; ii<2; ii++) {
+    for (mi=0; mi<3; mi++) {
+      nmap[ii][mi] = nrrdNew();
+      airMopAdd(mop, nmap[ii][mi], (airMopper)nrrdNuke, airMopAlways);
+    }
+  }
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_CAST(size_t, 7),
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY),
+                        AIR_CAST(size_t, SZ))
+      || nrrdMaybeAlloc_va(nseed, nrrdTypeDouble, 2, AIR_CAST(size_t, 3),
+                           AIR_CAST(size_t, SEED_NUM))
+      || nrrdMaybeAlloc_va(nlab, nrrdTypeUChar, 3, AIR_CAST(size_t, SX),
+                           AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  makeTen(nten);
+  nten->axis[0].kind = nrrdKind3DMaskedSymMatrix;
+  nten->axis[1].spacing = 1.5;
+  nten->axis[2].spacing = 1.0;
+  nten->axis[3].spacing = 1.2;
+  /* label 1 on the low-x half, label 2 on the high-x half */
+  lab = AIR_CAST(unsigned char *, nlab->data);
+  for (ii=0; ii<SX*SY*SZ; ii++) {
+    lab[ii] = (ii % SX < SX/2 ? 1 : 2);
+  }
+
+  tfx = tenFiberContextNew(nten);
+  if (!tfx) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble creating context:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, tfx, (airMopper)tenFiberContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= tenFiberTypeSet(tfx, tenFiberTypeEvec0);
+  if (!E) E |= tenFiberKernelSet(tfx, nrrdKernelTent, NULL);
+  if (!E) E |= tenFiberIntgSet(tfx, tenFiberIntgRK4);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmStepSize, 0.3);
+  if (!E) E |= tenFiberStopSet(tfx, tenFiberStopLength, 12.0);
+  if (!E) E |= tenFiberUpdate(tfx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up context:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  seed = AIR_CAST(double *, nseed->data);
+  for (ii=0; ii<SEED_NUM; ii++) {
+    ELL_3V_SET(ipos, AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SX-2),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SY-2),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SZ-2));
+    gageShapeItoW(tfx->gtx->shape, seed + 3*ii, ipos);
+  }
+  tfml = tenFiberMultiNew();
+  airMopAdd(mop, tfml, (airMopper)tenFiberMultiNix, airMopAlways);
+  if (tenFiberMultiTraceParallel(tfx, tfml, nseed, 1)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble tracing:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  /* traced fibers, with 1 and 3 threads */
+  for (ii=0; ii<2; ii++) {
+    if (tenFiberMultiMap(tfx, nmap[ii][0], nmap[ii][1], nmap[ii][2],
+                         tfml, nlab, 3, ii ? 3 : 1)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble mapping:\n%s", me, err);
+      airMopError(mop); return 1;
+    }
+  }
+  if (compare(me, "densities", nmap[0][0], nmap[1][0])
+      || compare(me, "colors", nmap[0][1], nmap[1][1])
+      || compare(me, "connectivities", nmap[0][2], nmap[1][2])) {
+    airMopError(mop); return 1;
+  }
+  if (!( 3 == nmap[0][0]->dim && SX == nmap[0][0]->axis[0].size
+         && 1.5 == nmap[0][0]->axis[0].spacing
+         && 4 == nmap[0][1]->dim && 3 == nmap[0][1]->axis[0].size
+         && 3 == nmap[0][2]->axis[0].size )) {
+    fprintf(stderr, "%s: maps have wrong shape\n", me);
+    airMopError(mop); return 1;
+  }
+  dens = AIR_CAST(const unsigned int *, nmap[0][0]->data);
+  fiberNum = 0;
+  for (fi=0; fi<tfml->fiberNum; fi++) {
+    if (tenFiberStopUnknown != tfml->fiber[fi].whyNowhere) {
+      continue;
+    }
+    fiberNum++;
+    gageShapeWtoI(tfx->gtx->shape, ipos, tfml->fiber[fi].seedPos);
+    xi = AIR_CAST(unsigned int, floor(ipos[0] + 0.5));
+    yi = AIR_CAST(unsigned int, floor(ipos[1] + 0.5));
+    zi = AIR_CAST(unsigned int, floor(ipos[2] + 0.5));
+    if (!dens[xi + SX*(yi + SY*zi)]) {
+      fprintf(stderr, "%s: fiber %u not counted at its seed\n", me, fi);
+      airMopError(mop); return 1;
+    }
+  }
+  conn = AIR_CAST(const unsigned int *, nmap[0][2]->data);
+  connSum = 0;
+  for (ii=0; ii<9; ii++) {
+    connSum += conn[ii];
+  }
+  /* each fiber adds 1 on the diagonal or 2 off it */
+  if (!( fiberNum > SEED_NUM/2
+         && connSum == 2*fiberNum - conn[0] - conn[4] - conn[8] )) {
+    fprintf(stderr, "%s: connectivity total %u wrong for %u fibers\n",
+            me, connSum, fiberNum);
+    airMopError(mop); return 1;
+  }
+
+  /* straight fibers, in index space, along some of the rows of voxels,
+     plus one that is entirely outside */
+  pld = limnPolyDataNew();
+  airMopAdd(mop, pld, (airMopper)limnPolyDataNix, airMopAlways);
+  rowNum = 60;
+  if (limnPolyDataAlloc(pld, 0, 3*(rowNum+1), 3*(rowNum+1), rowNum+1)) {
+    airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  for (ii=0; ii<SY*SZ; ii++) {
+    hit[ii] = 0;
+  }
+  for (fi=0; fi<=rowNum; fi++) {
+    yi = airUIrandMT_r(rng) % SY;
+    zi = airUIrandMT_r(rng) % SZ;
+    if (fi < rowNum) {
+      hit[yi + SY*zi]++;
+    } else {
+      zi = SZ + 3;
+    }
+    for (vi=0; vi<3; vi++) {
+      ELL_4V_SET(pld->xyzw + 4*(vi + 3*fi),
+                 AIR_AFFINE(0, vi, 2, -0.45, SX-0.55),
+                 yi + 0.4*airDrandMT_r(rng) - 0.2,
+                 zi + 0.4*airDrandMT_r(rng) - 0.2, 1.0);
+      pld->indx[vi + 3*fi] = vi + 3*fi;
+    }
+    pld->type[fi] = limnPrimitiveLineStrip;
+    pld->icnt[fi] = 3;
+  }
+  if (tenFiberPolyDataMap(nmap[0][0], nmap[0][1], nmap[0][2], pld, nten,
+                          AIR_TRUE, nlab, 4, 2)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble mapping:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  dens = AIR_CAST(const unsigned int *, nmap[0][0]->data);
+  rgb = AIR_CAST(const float *, nmap[0][1]->data);
+  for (ii=0; ii<SX*SY*SZ; ii++) {
+    unsigned int want;
+    want = hit[ii/SX];
+    if (dens[ii] != want) {
+      fprintf(stderr, "%s: density[%u] = %u, not %u\n", me, ii,
+              dens[ii], want);
+      airMopError(mop); return 1;
+    }
+    ELL_3V_SET(wpos, want ? 1 : 0, 0, 0);
+    ELL_3V_SUB(wpos, wpos, rgb + 3*ii);
+    if (ELL_3V_LEN(wpos) > 0.06) {
+      fprintf(stderr, "%s: color[%u] = (%g,%g,%g), not (%u,0,0)\n", me, ii,
+              rgb[0 + 3*ii], rgb[1 + 3*ii], rgb[2 + 3*ii], want ? 1 : 0);
+      airMopError(mop); return 1;
+    }
+  }
+  conn = AIR_CAST(const unsigned int *, nmap[0][2]->data);
+  for (ii=0; ii<9; ii++) {
+    unsigned int want;
+    want = (5 == ii || 7 == ii ? rowNum : (0 == ii ? 1 : 0));
+    if (conn[ii] != want) {
+      fprintf(stderr, "%s: connectivity[%u] = %u, not %u\n", me, ii,
+              conn[ii], want);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,215 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenFiberMultiTraceParallel
+**
+** fibers traced from the same seed points in a synthetic tensor field
+** have to come out in the same order and with exactly the same content
+** (vertices, lengths, step counts, stop reasons) with 1, 2, and 5
+** threads, and with the same total number of probes
+*/
+
+#define SX 18
+#define SY 15
+#define SZ 12
+#define SEED_NUM 300
+
+static void
+makeTen(Nrrd *nten) {
+  float *ten;
+  double vv[3], mat[9], len, cl;
+  unsigned int xi, yi, zi;
+
+  ten = AIR_CAST(float *, nten->data);
+  for (zi=0; zi<SZ; zi++) {
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        ELL_3V_SET(vv, 1, 0.7*sin(0.5*yi + 0.2*zi), 0.5*cos(0.4*xi + 0.3*yi));
+        ELL_3V_NORM(vv, vv, len);
+        /* anisotropy varies, so some fibers stop early on it */
+        cl = 0.5 + 0.45*sin(0.35*xi + 0.25*zi);
+        ELL_3MV_OUTER(mat, vv, vv);
+        ELL_3M_SCALE(mat, cl, mat);
+        mat[0] += 0.1; mat[4] += 0.1; mat[8] += 0.1;
+        TEN_M2T_TT(ten, float, mat);
+        ten[0] = 1.0;
+        ten += 7;
+      }
+    }
+  }
+}
+
+static int
+compareFiber(const char *me, unsigned int fi, unsigned int threadNum,
+             const tenFiberSingle *ta, const tenFiberSingle *tb) {
+  char *err, explain[AIR_STRLEN_LARGE];
+  int differ;
+
+  if (!( ELL_3V_EQUAL(ta->seedPos, tb->seedPos)
+         && ta->dirIdx == tb->dirIdx && ta->dirNum == tb->dirNum
+         && ta->whyNowhere == tb->whyNowhere )) {
+    fprintf(stderr, "%s: fiber %u seed or direction differs with %u threads\n",
+            me, fi, threadNum);
+    return 1;
+  }
+  if (tenFiberStopUnknown != ta->whyNowhere) {
+    return 0;
+  }
+  if (!( ta->halfLen[0] == tb->halfLen[0] && ta->halfLen[1] == tb->halfLen[1]
+         && ta->stepNum[0] == tb->stepNum[0]
+         && ta->stepNum[1] == tb->stepNum[1]
+         && ta->whyStop[0] == tb->whyStop[0]
+         && ta->whyStop[1] == tb->whyStop[1]
+         && ta->seedIdx == tb->seedIdx )) {
+    fprintf(stderr, "%s: fiber %u length, steps, or stop reason differs "
+            "with %u threads\n", me, fi, threadNum);
+    return 1;
+  }
+  if (nrrdCompare(ta->nvert, tb->nvert, AIR_FALSE /* onlyData */,
+                  0.0 /* epsilon */, &differ, explain)) {
+    err = biffGetDone(NRRD);
+    fprintf(stderr, "%s: trouble comparing fiber %u:\n%s", me, fi, err);
+    free(err);
+    return 1;
+  }
+  if (differ) {
+    fprintf(stderr, "%s: fiber %u vertices differ with %u threads: %s\n",
+            me, fi, threadNum, explain);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  airRandMTState *rng;
+  Nrrd *nten, *nseed;
+  tenFiberContext *tfx;
+  tenFiberMulti *tfml[3];
+  double *seed, ipos[3];
+  unsigned int ii, fi, threadNum[3] = {1, 2, 5}, startNum;
+  int E;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  rng = airRandMTStateNew(4242);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  nseed = nrrdNew();
+  airMopAdd(mop, nseed, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_CAST(size_t, 7),
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY),
+                        AIR_CAST(size_t, SZ))
+      || nrrdMaybeAlloc_va(nseed, nrrdTypeDouble, 2, AIR_CAST(size_t, 3),
+                           AIR_CAST(size_t, SEED_NUM))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  makeTen(nten);
+  nten->axis[0].kind = nrrdKind3DMaskedSymMatrix;
+  nten->axis[1].spacing = 1.1;
+  nten->axis[2].spacing = 1.0;
+  nten->axis[3].spacing = 1.3;
+
+  tfx = tenFiberContextNew(nten);
+  if (!tfx) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble creating context:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, tfx, (airMopper)tenFiberContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= tenFiberTypeSet(tfx, tenFiberTypeEvec0);
+  if (!E) E |= tenFiberKernelSet(tfx, nrrdKernelTent, NULL);
+  if (!E) E |= tenFiberIntgSet(tfx, tenFiberIntgRK4);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmStepSize, 0.25);
+  if (!E) E |= tenFiberStopSet(tfx, tenFiberStopLength, 10.0);
+  if (!E) E |= tenFiberStopSet(tfx, tenFiberStopAniso, tenAniso_Cl1, 0.3);
+  if (!E) E |= tenFiberUpdate(tfx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up context:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  seed = AIR_CAST(double *, nseed->data);
+  for (ii=0; ii<SEED_NUM; ii++) {
+    ELL_3V_SET(ipos, AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SX-2),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SY-2),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 1, SZ-2));
+    gageShapeItoW(tfx->gtx->shape, seed + 3*ii, ipos);
+  }
+  for (ii=0; ii<3; ii++) {
+    tfml[ii] = tenFiberMultiNew();
+    airMopAdd(mop, tfml[ii], (airMopper)tenFiberMultiNix, airMopAlways);
+    if (tenFiberMultiTraceParallel(tfx, tfml[ii], nseed, threadNum[ii])) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble tracing with %u threads:\n%s", me,
+              threadNum[ii], err);
+      airMopError(mop); return 1;
+    }
+  }
+
+  startNum = 0;
+  for (fi=0; fi<tfml[0]->fiberNum; fi++) {
+    startNum += (tenFiberStopUnknown == tfml[0]->fiber[fi].whyNowhere);
+  }
+  if (!( tfml[0]->fiberNum >= SEED_NUM && startNum > SEED_NUM/2 )) {
+    fprintf(stderr, "%s: only %u of %u fibers (from %u seeds) started\n",
+            me, startNum, tfml[0]->fiberNum, SEED_NUM);
+    airMopError(mop); return 1;
+  }
+  for (ii=1; ii<3; ii++) {
+    if (tfml[ii]->fiberNum != tfml[0]->fiberNum) {
+      fprintf(stderr, "%s: %u fibers with %u threads, but %u with 1\n", me,
+              tfml[ii]->fiberNum, threadNum[ii], tfml[0]->fiberNum);
+      airMopError(mop); return 1;
+    }
+    if (tfml[ii]->probeNum != tfml[0]->probeNum) {
+      char stmp[2][AIR_STRLEN_SMALL];
+      fprintf(stderr, "%s: %s probes with %u threads, but %s with 1\n", me,
+              airSprintSize_t(stmp[0], tfml[ii]->probeNum), threadNum[ii],
+              airSprintSize_t(stmp[1], tfml[0]->probeNum));
+      airMopError(mop); return 1;
+    }
+    for (fi=0; fi<tfml[0]->fiberNum; fi++) {
+      if (compareFiber(me, fi, threadNum[ii],
+                       tfml[0]->fiber + fi, tfml[ii]->fiber + fi)) {
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,240 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenGlyphInstanceGen, tenGlyphInstancePolyData
+**
+** on random tensors, both positive-definite ones on a grid and
+** mixed-sign ones at given positions: the instances have to be the
+** same with one and with several threads, there have to be as many
+** glyphs as parts made by tenGlyphGen, and each glyph in the
+** limnPolyData has to have the same bounding box as its part
+*/
+
+#define SIZE 12
+#define POS_NUM 500
+
+static void
+randTen(float ten[7], airRandMTState *rng, int mixed) {
+  double mat[9], rnd[9], tmp[9];
+  unsigned int ii;
+
+  for (ii=0; ii<9; ii++) {
+    airNormalRand_r(rnd + ii, NULL, rng);
+  }
+  if (mixed) {
+    ELL_3M_TRANSPOSE(mat, rnd);
+    ELL_3M_ADD2(mat, mat, rnd);
+    ELL_3M_SCALE(mat, 0.5, mat);
+  } else {
+    ELL_3M_TRANSPOSE(tmp, rnd);
+    ELL_3M_MUL(mat, rnd, tmp);
+    mat[0] += 0.05; mat[4] += 0.05; mat[8] += 0.05;
+  }
+  TEN_M2T_TT(ten, float, mat);
+  ten[0] = airDrandMT_r(rng) < 0.9;
+}
+
+static int
+check(const char *me, const char *what, tenGlyphParm *parm,
+      const Nrrd *nten, const Nrrd *npos) {
+  airArray *mop;
+  limnObject *obj;
+  limnPolyData *pld;
+  tenGlyphInstance *gin[2];
+  const unsigned int *shapeIdx;
+  unsigned int gi, vi, vv, gv, glyphNum, vertBase, ii;
+  double omin[3], omax[3], pmin[3], pmax[3], diff, scl;
+  const float *xyzw;
+  char *err, explain[AIR_STRLEN_LARGE];
+  int differ;
+
+  mop = airMopNew();
+  obj = limnObjectNew(1000, AIR_FALSE);
+  airMopAdd(mop, obj, (airMopper)limnObjectNix, airMopAlways);
+  pld = limnPolyDataNew();
+  airMopAdd(mop, pld, (airMopper)limnPolyDataNix, airMopAlways);
+  for (ii=0; ii<2; ii++) {
+    gin[ii] = tenGlyphInstanceNew();
+    airMopAdd(mop, gin[ii], (airMopper)tenGlyphInstanceNix, airMopAlways);
+    parm->threadNum = ii ? 3 : 1;
+    if (tenGlyphInstanceGen(gin[ii], parm, nten, npos)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: %s: trouble making instances:\n%s", me, what, err);
+      airMopError(mop); return 1;
+    }
+  }
+  if (tenGlyphGen(obj, NULL, parm, nten, npos, NULL)
+      || tenGlyphInstancePolyData(pld, gin[0])) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: %s: trouble making glyphs:\n%s", me, what, err);
+    airMopError(mop); return 1;
+  }
+  if (gin[0]->shapeNum != gin[1]->shapeNum) {
+    fprintf(stderr, "%s: %s: %u shapes with 1 thread, but %u with 3\n",
+            me, what, gin[0]->shapeNum, gin[1]->shapeNum);
+    airMopError(mop); return 1;
+  }
+  for (ii=0; ii<3; ii++) {
+    const Nrrd *nA, *nB;
+    nA = (0 == ii ? gin[0]->nshape : 1 == ii ? gin[0]->nxform : gin[0]->nrgba);
+    nB = (0 == ii ? gin[1]->nshape : 1 == ii ? gin[1]->nxform : gin[1]->nrgba);
+    if (nrrdCompare(nA, nB, AIR_TRUE /* onlyData */, 0.0 /* epsilon */,
+                    &differ, explain)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: %s: trouble comparing:\n%s", me, what, err);
+      airMopError(mop); return 1;
+    }
+    if (differ) {
+      fprintf(stderr, "%s: %s: 1 and 3 threads differ: %s\n",
+              me, what, explain);
+      airMopError(mop); return 1;
+    }
+  }
+  glyphNum = AIR_UINT(gin[0]->nshape->axis[0].size);
+  if (!( glyphNum > 10 && glyphNum == obj->partNum )) {
+    fprintf(stderr, "%s: %s: got %u glyphs, but %u limnObject parts\n",
+            me, what, glyphNum, obj->partNum);
+    airMopError(mop); return 1;
+  }
+  shapeIdx = AIR_CAST(const unsigned int *, gin[0]->nshape->data);
+  vertBase = 0;
+  for (gi=0; gi<glyphNum; gi++) {
+    ELL_3V_SET(omin, AIR_POS_INF, AIR_POS_INF, AIR_POS_INF);
+    ELL_3V_SET(omax, AIR_NEG_INF, AIR_NEG_INF, AIR_NEG_INF);
+    for (vi=0; vi<obj->part[gi]->vertIdxNum; vi++) {
+      xyzw = obj->vert[obj->part[gi]->vertIdx[vi]].world;
+      for (vv=0; vv<3; vv++) {
+        omin[vv] = AIR_MIN(omin[vv], xyzw[vv]/xyzw[3]);
+        omax[vv] = AIR_MAX(omax[vv], xyzw[vv]/xyzw[3]);
+      }
+    }
+    ELL_3V_COPY(pmin, omax);
+    ELL_3V_COPY(pmax, omin);
+    gv = gin[0]->shape[shapeIdx[gi]]->xyzwNum;
+    for (vi=0; vi<gv; vi++) {
+      xyzw = pld->xyzw + 4*(vertBase + vi);
+      for (vv=0; vv<3; vv++) {
+        pmin[vv] = AIR_MIN(pmin[vv], xyzw[vv]/xyzw[3]);
+        pmax[vv] = AIR_MAX(pmax[vv], xyzw[vv]/xyzw[3]);
+      }
+    }
+    vertBase += gv;
+    diff = AIR_MAX(ELL_3V_DIST(omin, pmin), ELL_3V_DIST(omax, pmax));
+    scl = ELL_3V_DIST(omin, omax);
+    if (!( diff <= 1e-4*scl )) {
+      fprintf(stderr, "%s: %s: glyph %u bounding box [%g,%g,%g]-[%g,%g,%g] "
+              "!= part's [%g,%g,%g]-[%g,%g,%g]\n", me, what, gi,
+              pmin[0], pmin[1], pmin[2], pmax[0], pmax[1], pmax[2],
+              omin[0], omin[1], omin[2], omax[0], omax[1], omax[2]);
+      airMopError(mop); return 1;
+    }
+  }
+  if (vertBase != pld->xyzwNum) {
+    fprintf(stderr, "%s: %s: used %u of %u vertices\n", me, what,
+            vertBase, pld->xyzwNum);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  airArray *mop;
+  airRandMTState *rng;
+  tenGlyphParm *parm;
+  Nrrd *nten, *nmten, *npos;
+  float *ten, *pos;
+  unsigned int ii, gtype[2] = {tenGlyphTypeSuperquad, tenGlyphTypeBox};
+  char *err;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  nmten = nrrdNew();
+  airMopAdd(mop, nmten, (airMopper)nrrdNuke, airMopAlways);
+  npos = nrrdNew();
+  airMopAdd(mop, npos, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_CAST(size_t, 7),
+                        AIR_CAST(size_t, SIZE), AIR_CAST(size_t, SIZE),
+                        AIR_CAST(size_t, SIZE))
+      || nrrdMaybeAlloc_va(nmten, nrrdTypeFloat, 2, AIR_CAST(size_t, 7),
+                           AIR_CAST(size_t, POS_NUM))
+      || nrrdMaybeAlloc_va(npos, nrrdTypeFloat, 2, AIR_CAST(size_t, 3),
+                           AIR_CAST(size_t, POS_NUM))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nten->axis[0].kind = nrrdKind3DMaskedSymMatrix;
+  for (ii=1; ii<4; ii++) {
+    nten->axis[ii].spacing = 1.0;
+  }
+  ten = AIR_CAST(float *, nten->data);
+  for (ii=0; ii<SIZE*SIZE*SIZE; ii++) {
+    randTen(ten + 7*ii, rng, AIR_FALSE);
+  }
+  ten = AIR_CAST(float *, nmten->data);
+  pos = AIR_CAST(float *, npos->data);
+  for (ii=0; ii<POS_NUM; ii++) {
+    randTen(ten + 7*ii, rng, AIR_TRUE);
+    ELL_3V_SET(pos + 3*ii, SIZE*airDrandMT_r(rng), SIZE*airDrandMT_r(rng),
+               SIZE*airDrandMT_r(rng));
+  }
+
+  parm = tenGlyphParmNew();
+  airMopAdd(mop, parm, (airMopper)tenGlyphParmNix, airMopAlways);
+  parm->anisoType = tenAniso_FA;
+  parm->colAnisoType = tenAniso_FA;
+  parm->confThresh = 0.5;
+  parm->glyphScale = 0.3f;
+  parm->facetRes = 6;
+  /* fine enough that quantizing the exponents doesn't matter */
+  parm->shapeRes = 10000;
+  for (ii=0; ii<2; ii++) {
+    parm->glyphType = gtype[ii];
+    parm->onlyPositive = AIR_TRUE;
+    parm->anisoThresh = 0.2f;
+    if (check(me, "grid", parm, nten, NULL)) {
+      airMopError(mop); return 1;
+    }
+    parm->onlyPositive = AIR_FALSE;
+    parm->anisoThresh = 0;
+    if (check(me, "positions", parm, nmten, npos)) {
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
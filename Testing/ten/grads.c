@@ -0,0 +1,135 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenGradientGenerate, with and without the octree approximation
+** (tenGradientParm->theta), and with several restarts on one and on
+** several threads.  The octree should give about the same quality as
+** the exact computation, and the restarts should not depend on the
+** number of threads.  The restarts are also balanced (tenGradientBalance),
+** which is done after the restarts, but should be as if each restart were
+** balanced on its own.
+*/
+
+#define NUM 40
+
+static int
+generate(Nrrd *nout, tenGradientParm *tgparm, double theta,
+         unsigned int restartNum, unsigned int threadNum, unsigned int seed,
+         int balance) {
+  tgparm->verbose = 0;
+  if (!balance) {
+    tgparm->minMean = 0;
+    tgparm->minMeanImprovement = 0;
+  }
+  tgparm->theta = theta;
+  tgparm->restartNum = restartNum;
+  tgparm->threadNum = threadNum;
+  tgparm->seed = seed;
+  return tenGradientGenerate(nout, NUM, tgparm);
+}
+
+static int
+differ(const Nrrd *na, const Nrrd *nb) {
+  return (nrrdElementNumber(na) != nrrdElementNumber(nb)
+          || memcmp(na->data, nb->data, nrrdElementNumber(na)*sizeof(double)));
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  tenGradientParm *tgExact, *tgTree, *tgRest1, *tgRestN, *tgBest;
+  Nrrd *nExact, *nTree, *nRest1, *nRestN, *nBest;
+  double relPot;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+#define NEW(tg, nn)                                                \
+  tg = tenGradientParmNew();                                       \
+  airMopAdd(mop, tg, (airMopper)tenGradientParmNix, airMopAlways); \
+  nn = nrrdNew();                                                  \
+  airMopAdd(mop, nn, (airMopper)nrrdNuke, airMopAlways)
+  NEW(tgExact, nExact);
+  NEW(tgTree, nTree);
+  NEW(tgRest1, nRest1);
+  NEW(tgRestN, nRestN);
+  NEW(tgBest, nBest);
+#undef NEW
+
+  if (generate(nExact, tgExact, 0, 1, 1, 42, AIR_FALSE)
+      || generate(nTree, tgTree, 0.5, 1, 1, 42, AIR_FALSE)
+      || generate(nRest1, tgRest1, 0, 4, 1, 42, AIR_TRUE)
+      || generate(nRestN, tgRestN, 0, 4, 3, 42, AIR_TRUE)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble generating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  relPot = (tgTree->potentialNorm - tgExact->potentialNorm)
+    /tgExact->potentialNorm;
+  if (!( AIR_ABS(relPot) < 1e-4
+         && tgTree->angle > 0.95*tgExact->angle )) {
+    fprintf(stderr, "%s: octree quality (potential %g, angle %g) not close "
+            "to exact (potential %g, angle %g)\n", me,
+            tgTree->potentialNorm, tgTree->angle,
+            tgExact->potentialNorm, tgExact->angle);
+    airMopError(mop); return 1;
+  }
+
+  if (differ(nRest1, nRestN)
+      || tgRest1->restartBest != tgRestN->restartBest) {
+    fprintf(stderr, "%s: restarts on 1 and 3 threads differ "
+            "(best %u vs %u)\n", me, tgRest1->restartBest,
+            tgRestN->restartBest);
+    airMopError(mop); return 1;
+  }
+  if (tgRest1->potential > tgExact->potential) {
+    fprintf(stderr, "%s: best of restarts potential %.17g > first %.17g\n",
+            me, tgRest1->potential, tgExact->potential);
+    airMopError(mop); return 1;
+  }
+  /* the best restart is the same as a single run with its seed */
+  if (generate(nBest, tgBest, 0, 1, 1, 42 + tgRest1->restartBest,
+               AIR_TRUE)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble generating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (differ(nBest, nRest1)
+      || tgBest->potential != tgRest1->potential
+      || tgBest->itersUsed != tgRest1->itersUsed) {
+    fprintf(stderr, "%s: best restart %u isn't same as single run with "
+            "seed %u\n", me, tgRest1->restartBest,
+            42 + tgRest1->restartBest);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
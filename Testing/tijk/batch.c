@@ -0,0 +1,253 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/tijk.h"
+
+/*
+** Tests:
+** the batched functions in batchTijk.c (tsp, norm, s_form, eval_esh,
+**   init_rank1, refine_rank1) agree with the per-tensor functions up to
+**   rounding, in double and single precision, including a partial block
+** tijk_approx_rankk_3d_batch gives exactly the same results as
+**   tijk_approx_rankk_3d, for any number of threads
+*/
+
+/* not a multiple of the block length in batchTijk.c */
+#define TEN_NUM 150
+#define DIR_NUM 40
+#define RANK 3
+
+static int
+close_d(double aa, double bb, double tol) {
+  return fabs(aa-bb) <= tol*AIR_MAX(1.0, fabs(aa)+fabs(bb));
+}
+
+static void
+randDirs(double *dir_d, float *dir_f, double *tp_d, float *tp_f,
+         unsigned int num) {
+  unsigned int ii;
+  for (ii=0; ii<num; ii++) {
+    double *dd = dir_d + 3*ii, len;
+    do {
+      ELL_3V_SET(dd, 2*airDrandMT()-1, 2*airDrandMT()-1, 2*airDrandMT()-1);
+      len = ELL_3V_LEN(dd);
+    } while (!( len > 0.1 && len < 1 ));
+    ELL_3V_SCALE(dd, 1.0/len, dd);
+    ELL_3V_COPY_TT(dir_f + 3*ii, float, dd);
+    tp_d[0 + 2*ii] = AIR_PI*airDrandMT();
+    tp_d[1 + 2*ii] = 2*AIR_PI*airDrandMT() - AIR_PI;
+    tp_f[0 + 2*ii] = AIR_CAST(float, tp_d[0 + 2*ii]);
+    tp_f[1 + 2*ii] = AIR_CAST(float, tp_d[1 + 2*ii]);
+  }
+}
+
+static int
+typeCheck(const char *me, const tijk_type *type, airArray *mop) {
+  unsigned int num = type->num, nn, jj, eshlen, order, ti;
+  double *ten_d, *res_d, *dir_d, *tp_d, *ss_d, *vv_d, s_d, v_d[3];
+  float *ten_f, *res_f, *dir_f, *tp_f, *ss_f, *vv_f, s_f, v_f[3];
+  double *ls_d, *vs_d, *rr_d, *ls1_d, *vs1_d, *rr1_d;
+
+  order = type->order;
+  eshlen = tijk_esh_len[order/2];
+  ten_d = AIR_CALLOC(TEN_NUM*AIR_MAX(num, eshlen), double);
+  ten_f = AIR_CALLOC(TEN_NUM*AIR_MAX(num, eshlen), float);
+  res_d = AIR_CALLOC(TEN_NUM*DIR_NUM, double);
+  res_f = AIR_CALLOC(TEN_NUM*DIR_NUM, float);
+  dir_d = AIR_CALLOC(3*DIR_NUM, double);
+  dir_f = AIR_CALLOC(3*DIR_NUM, float);
+  tp_d = AIR_CALLOC(2*DIR_NUM, double);
+  tp_f = AIR_CALLOC(2*DIR_NUM, float);
+  ss_d = AIR_CALLOC(TEN_NUM, double);
+  ss_f = AIR_CALLOC(TEN_NUM, float);
+  vv_d = AIR_CALLOC(3*TEN_NUM, double);
+  vv_f = AIR_CALLOC(3*TEN_NUM, float);
+  ls_d = AIR_CALLOC(RANK*TEN_NUM, double);
+  vs_d = AIR_CALLOC(3*RANK*TEN_NUM, double);
+  rr_d = AIR_CALLOC(num*TEN_NUM, double);
+  ls1_d = AIR_CALLOC(RANK, double);
+  vs1_d = AIR_CALLOC(3*RANK, double);
+  rr1_d = AIR_CALLOC(num, double);
+  airMopAdd(mop, ten_d, airFree, airMopAlways);
+  airMopAdd(mop, ten_f, airFree, airMopAlways);
+  airMopAdd(mop, res_d, airFree, airMopAlways);
+  airMopAdd(mop, res_f, airFree, airMopAlways);
+  airMopAdd(mop, dir_d, airFree, airMopAlways);
+  airMopAdd(mop, dir_f, airFree, airMopAlways);
+  airMopAdd(mop, tp_d, airFree, airMopAlways);
+  airMopAdd(mop, tp_f, airFree, airMopAlways);
+  airMopAdd(mop, ss_d, airFree, airMopAlways);
+  airMopAdd(mop, ss_f, airFree, airMopAlways);
+  airMopAdd(mop, vv_d, airFree, airMopAlways);
+  airMopAdd(mop, vv_f, airFree, airMopAlways);
+  airMopAdd(mop, ls_d, airFree, airMopAlways);
+  airMopAdd(mop, vs_d, airFree, airMopAlways);
+  airMopAdd(mop, rr_d, airFree, airMopAlways);
+  airMopAdd(mop, ls1_d, airFree, airMopAlways);
+  airMopAdd(mop, vs1_d, airFree, airMopAlways);
+  airMopAdd(mop, rr1_d, airFree, airMopAlways);
+  if (!( ten_d && ten_f && res_d && res_f && dir_d && dir_f && tp_d && tp_f
+         && ss_d && ss_f && vv_d && vv_f && ls_d && vs_d && rr_d
+         && ls1_d && vs1_d && rr1_d )) {
+    fprintf(stderr, "%s: couldn't allocate buffers\n", me);
+    return 1;
+  }
+  for (nn=0; nn<TEN_NUM*AIR_MAX(num, eshlen); nn++) {
+    ten_d[nn] = 2*airDrandMT() - 1;
+    ten_f[nn] = AIR_CAST(float, ten_d[nn]);
+  }
+  randDirs(dir_d, dir_f, tp_d, tp_f, DIR_NUM);
+
+  /* tsp and norm; B is A shifted by one tensor */
+  tijk_tsp_batch_d(res_d, ten_d, ten_d + num, type, TEN_NUM-1);
+  tijk_tsp_batch_f(res_f, ten_f, ten_f + num, type, TEN_NUM-1);
+  for (nn=0; nn<TEN_NUM-1; nn++) {
+    double want = (*type->tsp_d)(ten_d + nn*num, ten_d + (nn+1)*num);
+    if (!( close_d(res_d[nn], want, 1e-13)
+           && close_d(res_f[nn], want, 1e-5) )) {
+      fprintf(stderr, "%s: %s tsp[%u]: batch %g (%g) != %g\n", me,
+              type->name, nn, res_d[nn], res_f[nn], want);
+      return 1;
+    }
+  }
+  tijk_norm_batch_d(res_d, ten_d, type, TEN_NUM);
+  tijk_norm_batch_f(res_f, ten_f, type, TEN_NUM);
+  for (nn=0; nn<TEN_NUM; nn++) {
+    double want = (*type->norm_d)(ten_d + nn*num);
+    if (!( close_d(res_d[nn], want, 1e-13)
+           && close_d(res_f[nn], want, 1e-5) )) {
+      fprintf(stderr, "%s: %s norm[%u]: batch %g (%g) != %g\n", me,
+              type->name, nn, res_d[nn], res_f[nn], want);
+      return 1;
+    }
+  }
+
+  /* homogeneous form at given directions */
+  if (tijk_s_form_batch_d(res_d, ten_d, TEN_NUM, dir_d, DIR_NUM, type)
+      || tijk_s_form_batch_f(res_f, ten_f, TEN_NUM, dir_f, DIR_NUM, type)) {
+    fprintf(stderr, "%s: %s s_form_batch failed\n", me, type->name);
+    return 1;
+  }
+  for (nn=0; nn<TEN_NUM; nn++) {
+    for (jj=0; jj<DIR_NUM; jj++) {
+      double want = (*type->sym->s_form_d)(ten_d + nn*num, dir_d + 3*jj);
+      if (!( close_d(res_d[jj + DIR_NUM*nn], want, 1e-13)
+             && close_d(res_f[jj + DIR_NUM*nn], want, 1e-5) )) {
+        fprintf(stderr, "%s: %s s_form[%u,%u]: batch %g (%g) != %g\n", me,
+                type->name, nn, jj, res_d[jj + DIR_NUM*nn],
+                res_f[jj + DIR_NUM*nn], want);
+        return 1;
+      }
+    }
+  }
+
+  /* SH series of the same order */
+  if (tijk_eval_esh_batch_d(res_d, ten_d, TEN_NUM, order, tp_d, DIR_NUM)
+      || tijk_eval_esh_batch_f(res_f, ten_f, TEN_NUM, order, tp_f, DIR_NUM)) {
+    fprintf(stderr, "%s: eval_esh_batch (order %u) failed\n", me, order);
+    return 1;
+  }
+  for (nn=0; nn<TEN_NUM; nn++) {
+    for (jj=0; jj<DIR_NUM; jj++) {
+      double want = tijk_eval_esh_d(ten_d + nn*eshlen, order,
+                                    tp_d[0 + 2*jj], tp_d[1 + 2*jj]);
+      if (!( close_d(res_d[jj + DIR_NUM*nn], want, 1e-13)
+             && close_d(res_f[jj + DIR_NUM*nn], want, 1e-5) )) {
+        fprintf(stderr, "%s: eval_esh (order %u) [%u,%u]: batch %g (%g) "
+                "!= %g\n", me, order, nn, jj, res_d[jj + DIR_NUM*nn],
+                res_f[jj + DIR_NUM*nn], want);
+        return 1;
+      }
+    }
+  }
+
+  /* rank-1 initialization (one of the fixed candidates) and refinement */
+  if (tijk_init_rank1_3d_batch_d(ss_d, vv_d, ten_d, type, TEN_NUM)
+      || tijk_init_rank1_3d_batch_f(ss_f, vv_f, ten_f, type, TEN_NUM)) {
+    fprintf(stderr, "%s: %s init_rank1_3d_batch failed\n", me, type->name);
+    return 1;
+  }
+  for (nn=0; nn<TEN_NUM; nn++) {
+    tijk_init_rank1_3d_d(&s_d, v_d, ten_d + nn*num, type);
+    tijk_init_rank1_3d_f(&s_f, v_f, ten_f + nn*num, type);
+    if (!( close_d(ss_d[nn], s_d, 1e-13) && ELL_3V_EQUAL(vv_d + 3*nn, v_d)
+           && close_d(ss_f[nn], s_f, 1e-5) && ELL_3V_EQUAL(vv_f + 3*nn, v_f)
+           )) {
+      fprintf(stderr, "%s: %s init_rank1[%u]: batch %g (%g) != %g (%g)\n",
+              me, type->name, nn, ss_d[nn], ss_f[nn], s_d, s_f);
+      return 1;
+    }
+  }
+  if (1 == tijk_refine_rank1_3d_batch_d(ss_d, vv_d, ten_d, type, NULL,
+                                        TEN_NUM)) {
+    fprintf(stderr, "%s: %s refine_rank1_3d_batch failed\n", me, type->name);
+    return 1;
+  }
+  for (nn=0; nn<TEN_NUM; nn++) {
+    tijk_init_rank1_3d_d(&s_d, v_d, ten_d + nn*num, type);
+    tijk_refine_rank1_3d_d(&s_d, v_d, ten_d + nn*num, type, NULL);
+    if (!( ss_d[nn] == s_d && ELL_3V_EQUAL(vv_d + 3*nn, v_d) )) {
+      fprintf(stderr, "%s: %s refine_rank1[%u]: batch %g != %g\n",
+              me, type->name, nn, ss_d[nn], s_d);
+      return 1;
+    }
+  }
+
+  /* rank-k approximation, with any number of threads */
+  for (ti=1; ti<=4; ti++) {
+    if (tijk_approx_rankk_3d_batch_d(ls_d, vs_d, rr_d, ten_d, type, RANK,
+                                     NULL, TEN_NUM, ti)) {
+      fprintf(stderr, "%s: %s approx_rankk_3d_batch (%u threads) failed\n",
+              me, type->name, ti);
+      return 1;
+    }
+    for (nn=0; nn<TEN_NUM; nn++) {
+      tijk_approx_rankk_3d_d(ls1_d, vs1_d, rr1_d, ten_d + nn*num, type,
+                             RANK, NULL);
+      if (memcmp(ls1_d, ls_d + RANK*nn, RANK*sizeof(double))
+          || memcmp(vs1_d, vs_d + 3*RANK*nn, 3*RANK*sizeof(double))
+          || memcmp(rr1_d, rr_d + num*nn, num*sizeof(double))) {
+        fprintf(stderr, "%s: %s approx_rankk[%u] (%u threads): batch "
+                "differs\n", me, type->name, nn, ti);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+
+  AIR_UNUSED(argc);
+  mop = airMopNew();
+  airSrandMT(42);
+  if (typeCheck(argv[0], tijk_2o3d_sym, mop)
+      || typeCheck(argv[0], tijk_4o3d_sym, mop)
+      || typeCheck(argv[0], tijk_6o3d_sym, mop)) {
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
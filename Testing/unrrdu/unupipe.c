@@ -0,0 +1,149 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/unrrdu.h"
+
+/*
+** Tests:
+** unrrdu_pipeCmd
+**
+** runs "unu pipe" on a chain of three commands, and compares the result
+** with what the same commands give when run one at a time via files
+*/
+
+#define IN_NAME "tunupipe-in.nrrd"
+#define MID0_NAME "tunupipe-mid0.nrrd"
+#define MID1_NAME "tunupipe-mid1.nrrd"
+#define SEP_NAME "tunupipe-sep.nrrd"
+#define PIPE_NAME "tunupipe-pipe.nrrd"
+
+static int
+runCmd(const unrrduCmd *cmd, const char **argv, hestParm *hparm) {
+  int argc;
+
+  for (argc=0; argv[argc]; argc++)
+    ;
+  return cmd->main(argc, argv, cmd->name, hparm);
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  hestParm *hparm;
+  Nrrd *nin, *nsep, *npipe;
+  double *in;
+  unsigned int ii, sx=41, sy=37;
+  int differ;
+  char explain[AIR_STRLEN_LARGE];
+  const char *resampleArgv[] = {"-s", "x2", "x0.5", "-k", "tent",
+                                "-i", IN_NAME, "-o", MID0_NAME, NULL};
+  const char *axinsertArgv[] = {"-a", "0", "-i", MID0_NAME,
+                                "-o", MID1_NAME, NULL};
+  const char *quantizeArgv[] = {"-b", "8", "-i", MID1_NAME,
+                                "-o", SEP_NAME, NULL};
+  const char *pipeArgv[] = {"resample", "-s", "x2", "x0.5", "-k", "tent",
+                            "-i", IN_NAME, "::",
+                            "axinsert", "-a", "0", "::",
+                            "quantize", "-b", "8", "-o", PIPE_NAME, NULL};
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  hparm = hestParmNew();
+  airMopAdd(mop, hparm, (airMopper)hestParmFree, airMopAlways);
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeDouble, 2,
+                        AIR_CAST(size_t, sx), AIR_CAST(size_t, sy))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  in = AIR_CAST(double *, nin->data);
+  for (ii=0; ii<sx*sy; ii++) {
+    in[ii] = sin(0.1*(ii % sx))*cos(0.07*(ii / sx)) + 0.001*ii;
+  }
+  if (nrrdSave(IN_NAME, nin, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble saving:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  if (runCmd(&unrrdu_resampleCmd, resampleArgv, hparm)
+      || runCmd(&unrrdu_axinsertCmd, axinsertArgv, hparm)
+      || runCmd(&unrrdu_quantizeCmd, quantizeArgv, hparm)) {
+    fprintf(stderr, "%s: trouble running separate commands\n", me);
+    airMopError(mop); return 1;
+  }
+  if (runCmd(&unrrdu_pipeCmd, pipeArgv, hparm)) {
+    fprintf(stderr, "%s: trouble running pipe\n", me);
+    airMopError(mop); return 1;
+  }
+
+  nsep = nrrdNew();
+  airMopAdd(mop, nsep, (airMopper)nrrdNuke, airMopAlways);
+  npipe = nrrdNew();
+  airMopAdd(mop, npipe, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdLoad(nsep, SEP_NAME, NULL)
+      || nrrdLoad(npipe, PIPE_NAME, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble loading results:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (!( 3 == npipe->dim && nrrdTypeUChar == npipe->type )) {
+    fprintf(stderr, "%s: pipe output dim %u type %s; wanted 3 %s\n", me,
+            npipe->dim, airEnumStr(nrrdType, npipe->type),
+            airEnumStr(nrrdType, nrrdTypeUChar));
+    airMopError(mop); return 1;
+  }
+  if (nrrdCompare(nsep, npipe, AIR_FALSE /* onlyData */, 0.0 /* epsilon */,
+                  &differ, explain)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble comparing:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (differ) {
+    fprintf(stderr, "%s: pipe and separate commands differ: %s\n",
+            me, explain);
+    airMopError(mop); return 1;
+  }
+
+  /* a stage that reads "-" after one that didn't write "-" has to fail */
+  pipeArgv[8] = "-o";
+  pipeArgv[9] = MID0_NAME;
+  pipeArgv[10] = "::";
+  pipeArgv[11] = "quantize";
+  pipeArgv[12] = "-b";
+  pipeArgv[13] = "8";
+  pipeArgv[14] = NULL;
+  if (!runCmd(&unrrdu_pipeCmd, pipeArgv, hparm)) {
+    fprintf(stderr, "%s: pipe with nothing to read didn't fail\n", me);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
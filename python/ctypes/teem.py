@@ -1646,6 +1646,9 @@ airThreadBarrierWait.argtypes = [POINTER(airThreadBarrier)]
 airThreadBarrierNix = libteem.airThreadBarrierNix
 airThreadBarrierNix.restype = POINTER(airThreadBarrier)
 airThreadBarrierNix.argtypes = [POINTER(airThreadBarrier)]
+airThreadRun = libteem.airThreadRun
+airThreadRun.restype = c_uint
+airThreadRun.argtypes = [c_uint, CFUNCTYPE(c_void_p, c_void_p), c_void_p, c_size_t, POINTER(c_int), POINTER(airThreadMutex)]
 class airFloat(Union):
     pass
 airFloat._fields_ = [
@@ -2118,9 +2121,13 @@ alanContext_t._fields_ = [
     ('nlev', POINTER(Nrrd)),
     ('nparm', POINTER(Nrrd)),
     ('averageChange', alan_t),
-    ('changeCount', c_int),
+    ('_wwChange', POINTER(alan_t)),
+    ('changeCount', c_int * 2),
+    ('_stop', c_int * 2),
+    ('iterDecided', c_int),
+    ('threadIter', c_int * 256),
     ('changeMutex', POINTER(airThreadMutex)),
-    ('iterBarrier', POINTER(airThreadBarrier)),
+    ('iterCond', POINTER(airThreadCond)),
     ('stop', c_int),
 ]
 alanContext = alanContext_t
@@ -2269,6 +2276,7 @@ baneHVolParm._fields_ = [
     ('makeMeasrVol', c_int),
     ('renormalize', c_int),
     ('k3pack', c_int),
+    ('threadNum', c_uint),
     ('k', POINTER(NrrdKernel) * 8),
     ('kparm', c_double * 8 * 8),
     ('clip', POINTER(baneClip)),
@@ -2283,6 +2291,7 @@ baneDefMakeMeasrVol = (c_int).in_dll(libteem, 'baneDefMakeMeasrVol')
 baneDefIncLimit = (c_double).in_dll(libteem, 'baneDefIncLimit')
 baneDefRenormalize = (c_int).in_dll(libteem, 'baneDefRenormalize')
 baneDefPercHistBins = (c_int).in_dll(libteem, 'baneDefPercHistBins')
+baneDefThreadNum = (c_uint).in_dll(libteem, 'baneDefThreadNum')
 baneStateHistEqBins = (c_int).in_dll(libteem, 'baneStateHistEqBins')
 baneStateHistEqSmart = (c_int).in_dll(libteem, 'baneStateHistEqSmart')
 baneHack = (c_int).in_dll(libteem, 'baneHack')
@@ -2532,6 +2541,15 @@ coilKind._fields_ = [
     ('filter', CFUNCTYPE(None, POINTER(coil_t), c_int, c_int, c_int, POINTER(POINTER(coil_t)), POINTER(c_double), POINTER(c_double)) * 9),
     ('update', CFUNCTYPE(None, POINTER(coil_t), POINTER(coil_t))),
 ]
+class coilStat(Structure):
+    pass
+coilStat._pack_ = 4
+coilStat._fields_ = [
+    ('iter', c_uint),
+    ('activeNum', c_size_t),
+    ('deltaMax', c_double),
+    ('deltaMean', c_double),
+]
 class coilTask(Structure):
     pass
 class coilContext_t(Structure):
@@ -2543,6 +2561,8 @@ coilTask._fields_ = [
     ('_iv3', POINTER(coil_t)),
     ('iv3', POINTER(POINTER(coil_t))),
     ('iv3Fill', CFUNCTYPE(None, POINTER(POINTER(coil_t)), POINTER(coil_t), c_uint, c_int, c_int, c_int, c_int, c_int, c_int, c_int)),
+    ('slab', POINTER(coil_t)),
+    ('stat', POINTER(coilStat)),
     ('returnPtr', c_void_p),
 ]
 coilContext_t._pack_ = 4
@@ -2554,18 +2574,28 @@ coilContext_t._fields_ = [
     ('numThreads', c_uint),
     ('verbose', c_int),
     ('parm', c_double * 6),
+    ('blockIter', c_uint),
+    ('blockSlab', c_uint),
+    ('activeTol', c_double),
     ('iter', c_uint),
+    ('iterNum', c_uint),
     ('size', c_size_t * 3),
     ('nextSlice', c_size_t),
+    ('nextUpdateSlice', c_size_t),
+    ('slabNum', c_size_t),
+    ('slabSize', c_size_t),
     ('spacing', c_double * 3),
     ('nvol', POINTER(Nrrd)),
+    ('nact', POINTER(Nrrd)),
     ('finished', c_int),
-    ('todoFilter', c_int),
-    ('todoUpdate', c_int),
     ('nextSliceMutex', POINTER(airThreadMutex)),
     ('task', POINTER(POINTER(coilTask))),
     ('filterBarrier', POINTER(airThreadBarrier)),
     ('updateBarrier', POINTER(airThreadBarrier)),
+    ('iterBarrier', POINTER(airThreadBarrier)),
+    ('stat', POINTER(coilStat)),
+    ('statArr', POINTER(airArray)),
+    ('nnext', POINTER(Nrrd)),
 ]
 coilContext = coilContext_t
 coilPresent = (c_int).in_dll(libteem, 'coilPresent')
@@ -2588,6 +2618,12 @@ coilVolumeCheck.argtypes = [POINTER(Nrrd), POINTER(coilKind)]
 coilContextAllSet = libteem.coilContextAllSet
 coilContextAllSet.restype = c_int
 coilContextAllSet.argtypes = [POINTER(coilContext), POINTER(Nrrd), POINTER(coilKind), POINTER(coilMethod), c_uint, c_uint, c_int, POINTER(c_double)]
+coilContextBlockSet = libteem.coilContextBlockSet
+coilContextBlockSet.restype = c_int
+coilContextBlockSet.argtypes = [POINTER(coilContext), c_uint, c_uint]
+coilContextActiveSet = libteem.coilContextActiveSet
+coilContextActiveSet.restype = c_int
+coilContextActiveSet.argtypes = [POINTER(coilContext), c_double]
 coilOutputGet = libteem.coilOutputGet
 coilOutputGet.restype = c_int
 coilOutputGet.argtypes = [POINTER(Nrrd), POINTER(coilContext)]
@@ -3101,6 +3137,8 @@ elfMaximaContext._fields_ = [
     ('nbstride', c_uint),
     ('vertices_f', POINTER(c_float)),
     ('vertices_d', POINTER(c_double)),
+    ('basis_f', POINTER(c_float)),
+    ('basis_d', POINTER(c_double)),
 ]
 elfMaximaContextNew = libteem.elfMaximaContextNew
 elfMaximaContextNew.restype = POINTER(elfMaximaContext)
@@ -3120,6 +3158,12 @@ elfMaximaFind_d.argtypes = [POINTER(POINTER(c_double)), POINTER(POINTER(c_double
 elfMaximaFind_f = libteem.elfMaximaFind_f
 elfMaximaFind_f.restype = c_int
 elfMaximaFind_f.argtypes = [POINTER(POINTER(c_float)), POINTER(POINTER(c_float)), POINTER(c_float), POINTER(elfMaximaContext)]
+elfMaximaFindBatch_d = libteem.elfMaximaFindBatch_d
+elfMaximaFindBatch_d.restype = c_int
+elfMaximaFindBatch_d.argtypes = [POINTER(c_double), POINTER(c_double), POINTER(c_uint), POINTER(c_double), c_uint, c_uint, POINTER(elfMaximaContext), c_uint]
+elfMaximaFindBatch_f = libteem.elfMaximaFindBatch_f
+elfMaximaFindBatch_f.restype = c_int
+elfMaximaFindBatch_f.argtypes = [POINTER(c_float), POINTER(c_float), POINTER(c_uint), POINTER(c_float), c_uint, c_uint, POINTER(elfMaximaContext), c_uint]
 elfCart2Thetaphi_d = libteem.elfCart2Thetaphi_d
 elfCart2Thetaphi_d.restype = None
 elfCart2Thetaphi_d.argtypes = [POINTER(c_double), POINTER(c_double), c_uint]
@@ -3171,6 +3215,25 @@ elfBallStickPredict_f.argtypes = [POINTER(elfBallStickParms), POINTER(c_float),
 elfBallStickOptimize_f = libteem.elfBallStickOptimize_f
 elfBallStickOptimize_f.restype = c_int
 elfBallStickOptimize_f.argtypes = [POINTER(elfBallStickParms), POINTER(elfSingleShellDWI)]
+class elfBallStickVolumeParm(Structure):
+    pass
+elfBallStickVolumeParm._fields_ = [
+    ('fiberct', c_uint),
+    ('order', c_uint),
+    ('emc', POINTER(elfMaximaContext)),
+    ('optimize', c_int),
+    ('warm', c_int),
+    ('threadNum', c_uint),
+]
+elfBallStickVolumeParmNew = libteem.elfBallStickVolumeParmNew
+elfBallStickVolumeParmNew.restype = POINTER(elfBallStickVolumeParm)
+elfBallStickVolumeParmNew.argtypes = []
+elfBallStickVolumeParmNix = libteem.elfBallStickVolumeParmNix
+elfBallStickVolumeParmNix.restype = POINTER(elfBallStickVolumeParm)
+elfBallStickVolumeParmNix.argtypes = [POINTER(elfBallStickVolumeParm)]
+elfBallStickFitVolume_f = libteem.elfBallStickFitVolume_f
+elfBallStickFitVolume_f.restype = c_int
+elfBallStickFitVolume_f.argtypes = [POINTER(elfBallStickParms), POINTER(c_float), POINTER(c_float), POINTER(c_float), c_uint, c_float, POINTER(c_uint), POINTER(elfBallStickVolumeParm)]
 ellPresent = (c_int).in_dll(libteem, 'ellPresent')
 ell_biff_key = (STRING).in_dll(libteem, 'ell_biff_key')
 ell_cubic_root = (POINTER(airEnum)).in_dll(libteem, 'ell_cubic_root')
@@ -3502,6 +3565,7 @@ gageParm_t._fields_ = [
     ('orientationFromSpacing', c_int),
     ('generateErrStr', c_int),
     ('twoDimZeroZ', c_int),
+    ('brickSize', c_int),
 ]
 gageParm = gageParm_t
 class gagePoint_t(Structure):
@@ -3517,6 +3581,18 @@ class NrrdKernelSpec(Structure):
     pass
 class gagePerVolume_t(Structure):
     pass
+class gageBrick(Structure):
+    pass
+gageBrick._fields_ = [
+    ('edge', c_uint),
+    ('shift', c_uint),
+    ('mask', c_uint),
+    ('bnum', c_uint * 3),
+    ('tupleSize', c_size_t),
+    ('data', STRING),
+    ('refCount', c_uint),
+    ('refMutex', POINTER(airThreadMutex)),
+]
 gageContext_t._pack_ = 4
 gageContext_t._fields_ = [
     ('verbose', c_int),
@@ -3540,6 +3616,9 @@ gageContext_t._fields_ = [
     ('errStr', c_char * 513),
     ('errNum', c_int),
     ('edgeFrac', c_double),
+    ('iv3HitNum', c_size_t),
+    ('iv3FillNum', c_size_t),
+    ('iv3ShiftNum', c_size_t),
 ]
 class gageKind_t(Structure):
     pass
@@ -3575,6 +3654,8 @@ gagePerVolume_t._fields_ = [
     ('answer', POINTER(c_double)),
     ('directAnswer', POINTER(POINTER(c_double))),
     ('data', c_void_p),
+    ('iv3Idx', c_uint * 3),
+    ('brick', POINTER(gageBrick)),
 ]
 gageKind = gageKind_t
 class gageItemSpec(Structure):
@@ -3606,6 +3687,8 @@ gageStackBlurParm._fields_ = [
     ('needSpatialBlur', c_int),
     ('verbose', c_int),
     ('dgGoodSigmaMax', c_double),
+    ('cascade', c_int),
+    ('threadNum', c_uint),
 ]
 class gageOptimSigContext(Structure):
     pass
@@ -5588,6 +5671,8 @@ NrrdRange._fields_ = [
     ('min', c_double),
     ('max', c_double),
     ('hasNonExist', c_int),
+    ('minErr', c_double),
+    ('maxErr', c_double),
 ]
 nrrdRangeCopy = libteem.nrrdRangeCopy
 nrrdRangeCopy.restype = POINTER(NrrdRange)
@@ -6558,6 +6643,7 @@ pushPoint_t._fields_ = [
     ('neigh', POINTER(POINTER(pushPoint_t))),
     ('neighNum', c_uint),
     ('neighArr', POINTER(airArray)),
+    ('binIdx', c_uint),
 ]
 pushPoint = pushPoint_t
 class pushBin_t(Structure):
@@ -6567,6 +6653,8 @@ pushBin_t._fields_ = [
     ('point', POINTER(POINTER(pushPoint))),
     ('pointArr', POINTER(airArray)),
     ('neighbor', POINTER(POINTER(pushBin_t))),
+    ('half', POINTER(POINTER(pushBin_t))),
+    ('pointBase', c_uint),
 ]
 pushBin = pushBin_t
 class pushTask_t(Structure):
@@ -6589,6 +6677,14 @@ pushTask_t._fields_ = [
     ('energySum', c_double),
     ('deltaFracSum', c_double),
     ('rng', POINTER(airRandMTState)),
+    ('moved', POINTER(POINTER(pushPoint))),
+    ('movedNum', c_uint),
+    ('movedArr', POINTER(airArray)),
+    ('pairFrc', POINTER(c_double)),
+    ('pairBuf', POINTER(c_double)),
+    ('pairIdx', POINTER(c_uint)),
+    ('pairFrcLen', c_uint),
+    ('pairBufLen', c_uint),
     ('returnPtr', c_void_p),
 ]
 pushTask = pushTask_t
@@ -6599,6 +6695,7 @@ pushEnergy._fields_ = [
     ('parmNum', c_uint),
     ('eval', CFUNCTYPE(None, POINTER(c_double), POINTER(c_double), c_double, POINTER(c_double))),
     ('support', CFUNCTYPE(c_double, POINTER(c_double))),
+    ('evalN', CFUNCTYPE(None, POINTER(c_double), POINTER(c_double), POINTER(c_double), c_uint, POINTER(c_double))),
 ]
 class pushEnergySpec(Structure):
     pass
@@ -6640,6 +6737,7 @@ pushContext_t._fields_ = [
     ('ensp', POINTER(pushEnergySpec)),
     ('binSingle', c_int),
     ('binIncr', c_uint),
+    ('pairOnce', c_int),
     ('ksp00', POINTER(NrrdKernelSpec)),
     ('ksp11', POINTER(NrrdKernelSpec)),
     ('ksp22', POINTER(NrrdKernelSpec)),
@@ -6657,7 +6755,11 @@ pushContext_t._fields_ = [
     ('binsEdge', c_uint * 3),
     ('binNum', c_uint),
     ('binIdx', c_uint),
+    ('binMoveIdx', c_uint),
     ('binMutex', POINTER(airThreadMutex)),
+    ('pntPos', POINTER(c_double)),
+    ('pntInv', POINTER(c_double)),
+    ('pntNum', c_uint),
     ('step', c_double),
     ('maxDist', c_double),
     ('maxEval', c_double),
@@ -6667,6 +6769,7 @@ pushContext_t._fields_ = [
     ('task', POINTER(POINTER(pushTask))),
     ('iterBarrierA', POINTER(airThreadBarrier)),
     ('iterBarrierB', POINTER(airThreadBarrier)),
+    ('iterBarrierC', POINTER(airThreadBarrier)),
     ('deltaFrac', c_double),
     ('timeIteration', c_double),
     ('timeRun', c_double),
@@ -6776,6 +6879,8 @@ seekContext._fields_ = [
     ('facesPerVoxel', c_double),
     ('vertsPerVoxel', c_double),
     ('pldArrIncr', c_uint),
+    ('spanIndexUse', c_int),
+    ('threadNum', c_uint),
     ('flag', POINTER(c_int)),
     ('nin', POINTER(Nrrd)),
     ('baseDim', c_uint),
@@ -6793,6 +6898,8 @@ seekContext._fields_ = [
     ('txfNormal', c_double * 9),
     ('spanSize', c_size_t),
     ('nspanHist', POINTER(Nrrd)),
+    ('nspanIndex', POINTER(Nrrd)),
+    ('spanIndexGiven', c_int),
     ('range', POINTER(NrrdRange)),
     ('sx', c_size_t),
     ('sy', c_size_t),
@@ -6954,6 +7061,18 @@ tenGlyphParm._fields_ = [
     ('sliceOffset', c_float),
     ('sliceBias', c_float),
     ('sliceGamma', c_float),
+    ('threadNum', c_uint),
+    ('shapeRes', c_uint),
+]
+class tenGlyphInstance(Structure):
+    pass
+tenGlyphInstance._fields_ = [
+    ('shape', POINTER(POINTER(limnPolyData))),
+    ('shapeNum', c_uint),
+    ('nshape', POINTER(Nrrd)),
+    ('nxform', POINTER(Nrrd)),
+    ('nrgba', POINTER(Nrrd)),
+    ('shapeArr', POINTER(airArray)),
 ]
 class tenEvecRGBParm(Structure):
     pass
@@ -6969,6 +7088,7 @@ tenEvecRGBParm._fields_ = [
     ('maxSat', c_double),
     ('typeOut', c_int),
     ('genAlpha', c_int),
+    ('threadNum', c_uint),
 ]
 class tenFiberContext(Structure):
     pass
@@ -7028,6 +7148,7 @@ tenFiberContext._fields_ = [
     ('numSteps', c_uint * 2),
     ('whyStop', c_int * 2),
     ('whyNowhere', c_int),
+    ('probeNum', c_size_t),
 ]
 class tenFiberSingle(Structure):
     pass
@@ -7051,6 +7172,8 @@ tenFiberMulti._fields_ = [
     ('fiber', POINTER(tenFiberSingle)),
     ('fiberNum', c_uint),
     ('fiberArr', POINTER(airArray)),
+    ('traceTime', c_double),
+    ('probeNum', c_size_t),
 ]
 class tenEMBimodalParm(Structure):
     pass
@@ -7091,6 +7214,7 @@ tenGradientParm._fields_ = [
     ('minPotentialChange', c_double),
     ('minMean', c_double),
     ('minMeanImprovement', c_double),
+    ('theta', c_double),
     ('single', c_int),
     ('insertZeroVec', c_int),
     ('verbose', c_int),
@@ -7101,14 +7225,19 @@ tenGradientParm._fields_ = [
     ('maxEdgeShrink', c_uint),
     ('minIteration', c_uint),
     ('maxIteration', c_uint),
+    ('restartNum', c_uint),
+    ('threadNum', c_uint),
     ('expo_d', c_double),
     ('step', c_double),
     ('nudge', c_double),
     ('itersUsed', c_uint),
+    ('restartBest', c_uint),
     ('potential', c_double),
     ('potentialNorm', c_double),
     ('angle', c_double),
     ('edge', c_double),
+    ('potentialChange', c_double),
+    ('velocity', c_double),
 ]
 class tenEstimateContext(Structure):
     pass
@@ -7379,6 +7508,18 @@ tenGlyphParmCheck.argtypes = [POINTER(tenGlyphParm), POINTER(Nrrd), POINTER(Nrrd
 tenGlyphGen = libteem.tenGlyphGen
 tenGlyphGen.restype = c_int
 tenGlyphGen.argtypes = [POINTER(limnObject), POINTER(echoScene), POINTER(tenGlyphParm), POINTER(Nrrd), POINTER(Nrrd), POINTER(Nrrd)]
+tenGlyphInstanceNew = libteem.tenGlyphInstanceNew
+tenGlyphInstanceNew.restype = POINTER(tenGlyphInstance)
+tenGlyphInstanceNew.argtypes = []
+tenGlyphInstanceNix = libteem.tenGlyphInstanceNix
+tenGlyphInstanceNix.restype = POINTER(tenGlyphInstance)
+tenGlyphInstanceNix.argtypes = [POINTER(tenGlyphInstance)]
+tenGlyphInstanceGen = libteem.tenGlyphInstanceGen
+tenGlyphInstanceGen.restype = c_int
+tenGlyphInstanceGen.argtypes = [POINTER(tenGlyphInstance), POINTER(tenGlyphParm), POINTER(Nrrd), POINTER(Nrrd)]
+tenGlyphInstancePolyData = libteem.tenGlyphInstancePolyData
+tenGlyphInstancePolyData.restype = c_int
+tenGlyphInstancePolyData.argtypes = [POINTER(limnPolyData), POINTER(tenGlyphInstance)]
 tenGlyphBqdZoneEval = libteem.tenGlyphBqdZoneEval
 tenGlyphBqdZoneEval.restype = c_uint
 tenGlyphBqdZoneEval.argtypes = [POINTER(c_double)]
@@ -7583,9 +7724,15 @@ tenAnisoPlot.argtypes = [POINTER(Nrrd), c_int, c_uint, c_int, c_int, c_int]
 tenAnisoVolume = libteem.tenAnisoVolume
 tenAnisoVolume.restype = c_int
 tenAnisoVolume.argtypes = [POINTER(Nrrd), POINTER(Nrrd), c_int, c_double]
+tenAnisoVolumeParallel = libteem.tenAnisoVolumeParallel
+tenAnisoVolumeParallel.restype = c_int
+tenAnisoVolumeParallel.argtypes = [POINTER(Nrrd), POINTER(Nrrd), c_int, c_double, c_uint]
 tenAnisoHistogram = libteem.tenAnisoHistogram
 tenAnisoHistogram.restype = c_int
 tenAnisoHistogram.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(Nrrd), c_int, c_int, c_uint]
+tenAnisoHistogramParallel = libteem.tenAnisoHistogramParallel
+tenAnisoHistogramParallel.restype = c_int
+tenAnisoHistogramParallel.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(Nrrd), c_int, c_int, c_uint, c_uint]
 tenEvecRGBParmNew = libteem.tenEvecRGBParmNew
 tenEvecRGBParmNew.restype = POINTER(tenEvecRGBParm)
 tenEvecRGBParmNew.argtypes = []
@@ -7607,6 +7754,9 @@ tenEvecRGB.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(tenEvecRGBParm)]
 tenEvqVolume = libteem.tenEvqVolume
 tenEvqVolume.restype = c_int
 tenEvqVolume.argtypes = [POINTER(Nrrd), POINTER(Nrrd), c_int, c_int, c_int]
+tenEvqVolumeParallel = libteem.tenEvqVolumeParallel
+tenEvqVolumeParallel.restype = c_int
+tenEvqVolumeParallel.argtypes = [POINTER(Nrrd), POINTER(Nrrd), c_int, c_int, c_int, c_uint]
 tenBMatrixCheck = libteem.tenBMatrixCheck
 tenBMatrixCheck.restype = c_int
 tenBMatrixCheck.argtypes = [POINTER(Nrrd), c_int, c_uint]
@@ -7709,9 +7859,21 @@ tenFiberMultiPolyData.argtypes = [POINTER(tenFiberContext), POINTER(limnPolyData
 tenFiberMultiProbeVals = libteem.tenFiberMultiProbeVals
 tenFiberMultiProbeVals.restype = c_int
 tenFiberMultiProbeVals.argtypes = [POINTER(tenFiberContext), POINTER(Nrrd), POINTER(tenFiberMulti)]
+tenFiberMultiMap = libteem.tenFiberMultiMap
+tenFiberMultiMap.restype = c_int
+tenFiberMultiMap.argtypes = [POINTER(tenFiberContext), POINTER(Nrrd), POINTER(Nrrd), POINTER(Nrrd), POINTER(tenFiberMulti), POINTER(Nrrd), c_uint, c_uint]
+tenFiberPolyDataMap = libteem.tenFiberPolyDataMap
+tenFiberPolyDataMap.restype = c_int
+tenFiberPolyDataMap.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(Nrrd), POINTER(limnPolyData), POINTER(Nrrd), c_int, POINTER(Nrrd), c_uint, c_uint]
+tenEpiRegister3DParallel = libteem.tenEpiRegister3DParallel
+tenEpiRegister3DParallel.restype = c_int
+tenEpiRegister3DParallel.argtypes = [POINTER(POINTER(Nrrd)), POINTER(POINTER(Nrrd)), c_uint, POINTER(Nrrd), c_int, c_double, c_double, c_double, c_double, c_int, c_uint, POINTER(NrrdKernel), POINTER(c_double), c_uint, c_int, c_int]
 tenEpiRegister3D = libteem.tenEpiRegister3D
 tenEpiRegister3D.restype = c_int
 tenEpiRegister3D.argtypes = [POINTER(POINTER(Nrrd)), POINTER(POINTER(Nrrd)), c_uint, POINTER(Nrrd), c_int, c_double, c_double, c_double, c_double, c_int, POINTER(NrrdKernel), POINTER(c_double), c_int, c_int]
+tenEpiRegister4DParallel = libteem.tenEpiRegister4DParallel
+tenEpiRegister4DParallel.restype = c_int
+tenEpiRegister4DParallel.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(Nrrd), c_int, c_double, c_double, c_double, c_double, c_int, c_uint, POINTER(NrrdKernel), POINTER(c_double), c_uint, c_int, c_int]
 tenEpiRegister4D = libteem.tenEpiRegister4D
 tenEpiRegister4D.restype = c_int
 tenEpiRegister4D.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(Nrrd), c_int, c_double, c_double, c_double, c_double, c_int, POINTER(NrrdKernel), POINTER(c_double), c_int, c_int]
@@ -7845,6 +8007,7 @@ tend_gradsCmd = (unrrduCmd).in_dll(libteem, 'tend_gradsCmd')
 tend_mconvCmd = (unrrduCmd).in_dll(libteem, 'tend_mconvCmd')
 tend_avgCmd = (unrrduCmd).in_dll(libteem, 'tend_avgCmd')
 tend_fiberCmd = (unrrduCmd).in_dll(libteem, 'tend_fiberCmd')
+tend_fibmapCmd = (unrrduCmd).in_dll(libteem, 'tend_fibmapCmd')
 tend_shrinkCmd = (unrrduCmd).in_dll(libteem, 'tend_shrinkCmd')
 tend_mfitCmd = (unrrduCmd).in_dll(libteem, 'tend_mfitCmd')
 tend_bfitCmd = (unrrduCmd).in_dll(libteem, 'tend_bfitCmd')
@@ -8106,6 +8269,60 @@ tijk_approx_heur_3d_d.argtypes = [POINTER(c_double), POINTER(c_double), POINTER(
 tijk_approx_heur_3d_f = libteem.tijk_approx_heur_3d_f
 tijk_approx_heur_3d_f.restype = c_int
 tijk_approx_heur_3d_f.argtypes = [POINTER(c_float), POINTER(c_float), POINTER(c_float), POINTER(c_float), POINTER(tijk_type), c_uint, POINTER(tijk_approx_heur_parm)]
+tijk_tsp_batch_d = libteem.tijk_tsp_batch_d
+tijk_tsp_batch_d.restype = None
+tijk_tsp_batch_d.argtypes = [POINTER(c_double), POINTER(c_double), POINTER(c_double), POINTER(tijk_type), c_uint]
+tijk_tsp_batch_f = libteem.tijk_tsp_batch_f
+tijk_tsp_batch_f.restype = None
+tijk_tsp_batch_f.argtypes = [POINTER(c_float), POINTER(c_float), POINTER(c_float), POINTER(tijk_type), c_uint]
+tijk_norm_batch_d = libteem.tijk_norm_batch_d
+tijk_norm_batch_d.restype = None
+tijk_norm_batch_d.argtypes = [POINTER(c_double), POINTER(c_double), POINTER(tijk_type), c_uint]
+tijk_norm_batch_f = libteem.tijk_norm_batch_f
+tijk_norm_batch_f.restype = None
+tijk_norm_batch_f.argtypes = [POINTER(c_float), POINTER(c_float), POINTER(tijk_type), c_uint]
+tijk_basis_eval_batch_d = libteem.tijk_basis_eval_batch_d
+tijk_basis_eval_batch_d.restype = c_int
+tijk_basis_eval_batch_d.argtypes = [POINTER(c_double), POINTER(c_double), c_uint, POINTER(c_double), c_uint, c_uint]
+tijk_basis_eval_batch_f = libteem.tijk_basis_eval_batch_f
+tijk_basis_eval_batch_f.restype = c_int
+tijk_basis_eval_batch_f.argtypes = [POINTER(c_float), POINTER(c_float), c_uint, POINTER(c_float), c_uint, c_uint]
+tijk_s_form_basis_d = libteem.tijk_s_form_basis_d
+tijk_s_form_basis_d.restype = c_int
+tijk_s_form_basis_d.argtypes = [POINTER(c_double), POINTER(c_double), c_uint, POINTER(tijk_type)]
+tijk_s_form_basis_f = libteem.tijk_s_form_basis_f
+tijk_s_form_basis_f.restype = c_int
+tijk_s_form_basis_f.argtypes = [POINTER(c_float), POINTER(c_float), c_uint, POINTER(tijk_type)]
+tijk_s_form_batch_d = libteem.tijk_s_form_batch_d
+tijk_s_form_batch_d.restype = c_int
+tijk_s_form_batch_d.argtypes = [POINTER(c_double), POINTER(c_double), c_uint, POINTER(c_double), c_uint, POINTER(tijk_type)]
+tijk_s_form_batch_f = libteem.tijk_s_form_batch_f
+tijk_s_form_batch_f.restype = c_int
+tijk_s_form_batch_f.argtypes = [POINTER(c_float), POINTER(c_float), c_uint, POINTER(c_float), c_uint, POINTER(tijk_type)]
+tijk_eval_esh_batch_d = libteem.tijk_eval_esh_batch_d
+tijk_eval_esh_batch_d.restype = c_int
+tijk_eval_esh_batch_d.argtypes = [POINTER(c_double), POINTER(c_double), c_uint, c_uint, POINTER(c_double), c_uint]
+tijk_eval_esh_batch_f = libteem.tijk_eval_esh_batch_f
+tijk_eval_esh_batch_f.restype = c_int
+tijk_eval_esh_batch_f.argtypes = [POINTER(c_float), POINTER(c_float), c_uint, c_uint, POINTER(c_float), c_uint]
+tijk_init_rank1_3d_batch_d = libteem.tijk_init_rank1_3d_batch_d
+tijk_init_rank1_3d_batch_d.restype = c_int
+tijk_init_rank1_3d_batch_d.argtypes = [POINTER(c_double), POINTER(c_double), POINTER(c_double), POINTER(tijk_type), c_uint]
+tijk_init_rank1_3d_batch_f = libteem.tijk_init_rank1_3d_batch_f
+tijk_init_rank1_3d_batch_f.restype = c_int
+tijk_init_rank1_3d_batch_f.argtypes = [POINTER(c_float), POINTER(c_float), POINTER(c_float), POINTER(tijk_type), c_uint]
+tijk_refine_rank1_3d_batch_d = libteem.tijk_refine_rank1_3d_batch_d
+tijk_refine_rank1_3d_batch_d.restype = c_int
+tijk_refine_rank1_3d_batch_d.argtypes = [POINTER(c_double), POINTER(c_double), POINTER(c_double), POINTER(tijk_type), POINTER(tijk_refine_rank1_parm), c_uint]
+tijk_refine_rank1_3d_batch_f = libteem.tijk_refine_rank1_3d_batch_f
+tijk_refine_rank1_3d_batch_f.restype = c_int
+tijk_refine_rank1_3d_batch_f.argtypes = [POINTER(c_float), POINTER(c_float), POINTER(c_float), POINTER(tijk_type), POINTER(tijk_refine_rank1_parm), c_uint]
+tijk_approx_rankk_3d_batch_d = libteem.tijk_approx_rankk_3d_batch_d
+tijk_approx_rankk_3d_batch_d.restype = c_int
+tijk_approx_rankk_3d_batch_d.argtypes = [POINTER(c_double), POINTER(c_double), POINTER(c_double), POINTER(c_double), POINTER(tijk_type), c_uint, POINTER(tijk_refine_rankk_parm), c_uint, c_uint]
+tijk_approx_rankk_3d_batch_f = libteem.tijk_approx_rankk_3d_batch_f
+tijk_approx_rankk_3d_batch_f.restype = c_int
+tijk_approx_rankk_3d_batch_f.argtypes = [POINTER(c_float), POINTER(c_float), POINTER(c_float), POINTER(c_float), POINTER(tijk_type), c_uint, POINTER(tijk_refine_rankk_parm), c_uint, c_uint]
 tijk_esh_len = (c_uint * 0).in_dll(libteem, 'tijk_esh_len')
 tijk_max_esh_order = (c_uint).in_dll(libteem, 'tijk_max_esh_order')
 tijk_eval_esh_basis_d = libteem.tijk_eval_esh_basis_d
@@ -8912,7 +9129,8 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'nrrdIoStateBzip2BlockSize', 'hooverErrRenderBegin',
            'hooverErrRayBegin', 'airFPPartsToVal_f', 'hestVerbosity',
            'alanParmMaxIteration', 'nrrdDefaultWriteEncodingType',
-           'limnLight', 'tenAnisoVolume', 'echoMatterGlassKa',
+           'limnLight', 'tenAnisoVolume', 'tenAnisoVolumeParallel',
+           'echoMatterGlassKa',
            'airHalton', 'echoMatterGlassKd', 'nrrdAxisInfoCopy',
            'NrrdRange', 'airMyDio', 'tenBMatrixCheck',
            'limnObjectDescribe', 'nrrdBinaryOpRicianRand',
@@ -8945,7 +9163,7 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'nrrdEncodingTypeGzip', 'gageParm', 'tenGageOmegaHessian',
            'unrrdu_lut2Cmd', 'alanBiffKey', 'limnWindowNix',
            'nrrdEnvVarDefaultCenter', 'unrrdu_3opCmd',
-           'tijk_esh_convolve_f', 'tenEvqVolume',
+           'tijk_esh_convolve_f', 'tenEvqVolume', 'tenEvqVolumeParallel',
            'nrrdEncodingTypeRaw', 'ell_aa_to_4m_f',
            'nrrdKernelBSpline4D', 'nrrdSpaceDimensionSet',
            'tijk_type', 'nrrdFormatEPS', 'unrrduScaleLast',
@@ -9186,7 +9404,8 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'gageStackPerVolumeAttach', 'biffGetStrlen',
            'gageDefCheckIntegrals', 'coilBiffKey',
            'nrrdBinaryOpCompare', 'tend_normCmd', 'airNoDio_okay',
-           'airTypeUnknown', 'tenAnisoHistogram', 'tenGageFA',
+           'airTypeUnknown', 'tenAnisoHistogram',
+           'tenAnisoHistogramParallel', 'tenGageFA',
            'airTeemVersionSprint', 'alanStopNot', 'tenDwiGageJustDWI',
            'tenDwiGageTensorLLSError', 'tenDwiGageTensorAllDWIError',
            'tenDwiGage', 'nrrdCastClampRound', 'tijk_2d_sym_to_efs_f',
@@ -9222,6 +9441,7 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'unrrdu_tileCmd', 'pullInterTypeSeparable',
            'nrrdKind2DMaskedSymMatrix',
            'pullSysParmFracNeighNixedMax', 'baneDefPercHistBins',
+           'baneDefThreadNum',
            'limnPolyDataPrimitiveSort', 'tenGageTraceHessian',
            'nrrdField_space_directions', 'baneRangeAnywhere',
            'nrrdHasNonExist', 'tenTripleConvertSingle_f',
@@ -9259,6 +9479,8 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'gagePointReset', 'nrrdKernelC5SepticDD', 'hestOpt',
            'nrrdMeasureLineError', 'alanParmWrapAround',
            'elfBallStickOptimize_f', 'nrrdKernelBCCubicDD',
+           'elfBallStickVolumeParm', 'elfBallStickVolumeParmNew',
+           'elfBallStickVolumeParmNix', 'elfBallStickFitVolume_f',
            'limnOptsPS', 'nrrdSpacingStatusLast',
            'tenFiberStopBounds', 'airSrandMT_r', 'pullProp',
            'limnSplineInfo2Vector', 'nrrdKernelBSpline7ApproxInverse',
@@ -9450,6 +9672,7 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'hooverStubThreadEnd', 'nrrdArrayCompare', 'tenGageEvec',
            'tenDwiGageTensorLLS', 'limnSplineParse',
            'baneClipPercentile', 'tenEpiRegister4D',
+           'tenEpiRegister4DParallel',
            'seekItemNormalSet', 'limnSpaceLast', 'miteRenderBegin',
            'airMyEndian', 'pullPropNeighCovar', 'miteRangeRed',
            'gageVecVector2', 'gageVecVector1', 'nrrdBinaryOpMin',
@@ -9459,7 +9682,8 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'tenDwiGageTensorWLSErrorLog', 'meetBiffKey',
            'echoThreadStateNix', 'airThreadStart', 'tenFiberSingle',
            'ell_3m_to_q_d', 'ell_3m_to_q_f', 'airFP_POS_DENORM',
-           'nrrdAxesInsert', 'airThreadBarrierNew', 'gageSclHessian',
+           'nrrdAxesInsert', 'airThreadBarrierNew', 'airThreadRun',
+           'gageSclHessian',
            'baneIncNew', 'limnSpline', 'meetPullInfoNix',
            'limnDeviceLast', 'airTypeULongInt', 'nrrdSample_va',
            'limnPolyDataSmoothHC', 'tenGageOmegaHessianContrTenEvec2',
@@ -9468,7 +9692,8 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'tijk_class_esh', 'nrrdResampleNonExistent',
            'tenGageFA2ndDD', 'elfSingleShellDWI', 'tenGageCl1GradMag',
            'tenFiberContextNew',  'tenGageFANormal',
-           'tenGageBNormal', 'tenEpiRegister3D', 'baneGkmsUsage',
+           'tenGageBNormal', 'tenEpiRegister3D', 'tenEpiRegister3DParallel',
+           'baneGkmsUsage',
            'echoSphere', 'nrrdApply1DSubstitution', 'airEnumFmtDesc',
            'seekPresent', 'tenExperSpecFromKeyValueSet',
            'echoJittablePixel', 'tenGageTraceHessianEval2',
@@ -9631,6 +9856,16 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'gageParmUnknown', 'pushBin', 'miteShadeMethodUnknown',
            'nrrdBinaryOpPow', 'elfMaximaFind_d', 'biffMsgNoop',
            'baneIncPercentile', 'elfMaximaFind_f',
+           'tijk_tsp_batch_d', 'tijk_tsp_batch_f',
+           'tijk_norm_batch_d', 'tijk_norm_batch_f',
+           'tijk_basis_eval_batch_d', 'tijk_basis_eval_batch_f',
+           'tijk_s_form_basis_d', 'tijk_s_form_basis_f',
+           'tijk_s_form_batch_d', 'tijk_s_form_batch_f',
+           'tijk_eval_esh_batch_d', 'tijk_eval_esh_batch_f',
+           'tijk_init_rank1_3d_batch_d', 'tijk_init_rank1_3d_batch_f',
+           'tijk_refine_rank1_3d_batch_d', 'tijk_refine_rank1_3d_batch_f',
+           'tijk_approx_rankk_3d_batch_d', 'tijk_approx_rankk_3d_batch_f',
+           'elfMaximaFindBatch_d', 'elfMaximaFindBatch_f',
            'nrrdTernaryOpLast', 'tenGageTensorLogEuclidean',
            'pullVolumeLookup', 'unrrduScaleDivide', 'airParseStr',
            'unrrdu_fftCmd', 'pullInitMethodHalton',
@@ -9832,8 +10067,9 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'tenAnisoLast', 'nrrdKernelCheck', 'nrrdDescribe',
            'limnObjectEdgeAdd', 'gageStackProbeSpace',
            'nrrdDeringRadialKernelSet', 'nrrdKernelBox',
-           'tenModelBall1StickEMD', 'coilContextAllSet',
-           'gageContext_t', 'nrrdTypeUInt', 'tenShrink',
+           'tenModelBall1StickEMD', 'coilContextAllSet', 'coilContextBlockSet',
+           'coilContextActiveSet', 'coilStat',
+           'gageContext_t', 'gageBrick', 'nrrdTypeUInt', 'tenShrink',
            'tenLogSingle_f', 'limnObjectCylinderAdd',
            'gageErrBoundsSpace', 'gageSclShapeIndex',
            'pullSysParmOpporStepScale', 'nrrdKernelHannDD',
@@ -355,6 +355,76 @@ AIR_EXPORT airThreadCond *airThreadCondNix(airThreadCond *cond);
 AIR_EXPORT airThreadBarrier *airThreadBarrierNew(unsigned numUsers);
 AIR_EXPORT int airThreadBarrierWait(airThreadBarrier *barrier);
 AIR_EXPORT airThreadBarrier *airThreadBarrierNix(airThreadBarrier *barrier);
+AIR_EXPORT unsigned int airThreadRun(unsigned int threadNum,
+                                     void *(*threadBody)(void *),
+                                     void *task, size_t taskSize,
+                                     int *abortP, airThreadMutex *mutex);
+
+/*
+******** airProfile* enum
+**
+** the named hot-path counters and timers that Teem libraries feed when
+** profiling is compiled in (TEEM_PROFILE) and switched on at run-time
+** (airProfileEnable).  Each has a count (the unit is noted below) and an
+** accumulated time in seconds; the time is only meaningful for the ones
+** that are bracketed with AIR_PROFILE_START/AIR_PROFILE_STOP.
+*/
+enum {
+  airProfileUnknown,        /*  0: nobody knows */
+  airProfileGageProbe,      /*  1: calls to gageProbe and friends */
+  airProfileGageIv3Fill,    /*  2: refills of the gage value cache (iv3) */
+  airProfileKernelEval,     /*  3: individual kernel evaluations */
+  airProfilePullBinVisit,   /*  4: bins visited in pull neighbor search */
+  airProfileResamplePass,   /*  5: per-axis passes of nrrdResampleExecute */
+  airProfileNrrdRead,       /*  6: bytes of data read by nrrdLoad/Read */
+  airProfileNrrdWrite,      /*  7: bytes of data written by nrrdSave/Write */
+  airProfilePullIter,       /*  8: pull system iterations */
+  airProfileHooverRender,   /*  9: rays cast by hooverRender */
+  airProfileSeekExtract,    /* 10: calls to seekExtract */
+  airProfileLast
+};
+#define AIR_PROFILE_MAX        10
+
+/* profileAir.c: lightweight per-thread hot-path counters and timers */
+/*
+******** airProfileCapable
+**
+** non-zero iff Teem was compiled with TEEM_PROFILE, so that the
+** AIR_PROFILE_* macros sprinkled through the libraries do something
+*/
+AIR_EXPORT const int airProfileCapable;
+/*
+******** airProfileEnabled
+**
+** run-time switch; only looked at (but not set) by the AIR_PROFILE_*
+** macros, so use airProfileEnable() to change it
+*/
+AIR_EXPORT int airProfileEnabled;
+AIR_EXPORT const airEnum *const airProfile;
+AIR_EXPORT void airProfileEnable(int enable);
+AIR_EXPORT void airProfileReset(void);
+AIR_EXPORT void airProfileCount(int which, double num);
+AIR_EXPORT void airProfileStart(int which);
+AIR_EXPORT void airProfileStop(int which);
+AIR_EXPORT unsigned int airProfileTotal(double count[AIR_PROFILE_MAX+1],
+                                        double time[AIR_PROFILE_MAX+1]);
+/*
+** The macros used at instrumentation sites: these compile to nothing
+** without TEEM_PROFILE, and cost one branch when profiling is compiled
+** in but not enabled.
+*/
+#if TEEM_PROFILE
+#  define AIR_PROFILE_COUNT(w, n) \
+  (airProfileEnabled ? airProfileCount((w), AIR_CAST(double, (n))) : (void)0)
+#  define AIR_PROFILE_START(w) \
+  (airProfileEnabled ? airProfileStart(w) : (void)0)
+#  define AIR_PROFILE_STOP(w) \
+  (airProfileEnabled ? airProfileStop(w) : (void)0)
+#else
+#  define AIR_PROFILE_COUNT(w, n) ((void)0)
+#  define AIR_PROFILE_START(w) ((void)0)
+#  define AIR_PROFILE_STOP(w) ((void)0)
+#endif
 
 /* ---- END non-NrrdIO */
 
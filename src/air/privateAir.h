@@ -24,3 +24,6 @@
 /* miscAir.c */
 extern double _airSanityHelper(double val);
 
+/* profileAir.c */
+extern void _airProfileThreadDone(void);
+
@@ -0,0 +1,322 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "air.h"
+#include "privateAir.h"
+
+/*
+** The counters and timers are kept in one record per thread, so that
+** the hot paths never contend for a lock: a thread finds its record
+** through a thread-local pointer, and only the first use in each thread
+** takes the mutex, to link the new record into the global list that
+** airProfileTotal() walks.  When a thread started by airThreadStart
+** finishes, its counts and times are added into one record for all
+** finished threads, and its own record is unlinked and freed, so the
+** list only holds the records of threads that are still running.
+** airProfileReset() zeroes all of them.  Without compiler support for
+** thread-local storage, all threads share one record (which is never
+** freed), and counts from concurrent threads may be lost; single-threaded
+** use is still exact.
+*/
+
+#if TEEM_PROFILE
+const int airProfileCapable = AIR_TRUE;
+#else
+const int airProfileCapable = AIR_FALSE;
+#endif
+
+int airProfileEnabled = AIR_FALSE;
+
+static const char *
+_airProfileStr[AIR_PROFILE_MAX+1] = {
+  "(unknown_profile)",
+  "gage-probe",
+  "gage-iv3-fill",
+  "kernel-eval",
+  "pull-bin-visit",
+  "resample-pass",
+  "nrrd-read",
+  "nrrd-write",
+  "pull-iter",
+  "hoover-render",
+  "seek-extract"
+};
+
+static const char *
+_airProfileDesc[AIR_PROFILE_MAX+1] = {
+  "unknown profile counter",
+  "calls to gageProbe (and gageProbeSpace)",
+  "refills of the gage value cache",
+  "individual kernel evaluations",
+  "bins visited while finding pull neighbors",
+  "per-axis passes of nrrdResampleExecute",
+  "bytes of data read by nrrdLoad and nrrdRead",
+  "bytes of data written by nrrdSave and nrrdWrite",
+  "iterations of the pull system",
+  "rays cast by hooverRender",
+  "calls to seekExtract"
+};
+
+static const airEnum
+_airProfile = {
+  "profile",
+  AIR_PROFILE_MAX,
+  _airProfileStr, NULL,
+  _airProfileDesc,
+  NULL, NULL,
+  AIR_FALSE
+};
+const airEnum *const
+airProfile = &_airProfile;
+
+typedef struct _airProfileRecord {
+  double count[AIR_PROFILE_MAX+1],
+    time[AIR_PROFILE_MAX+1],
+    start[AIR_PROFILE_MAX+1];
+  struct _airProfileRecord *next;
+} _airProfileRecord;
+
+static _airProfileRecord *_airProfileList = NULL;
+static airThreadMutex *_airProfileMutex = NULL;
+/* totals of the threads that have finished, and how many there were */
+static _airProfileRecord _airProfileDone;
+static unsigned int _airProfileDoneNum = 0;
+
+#if defined(_MSC_VER)
+#  define _AIR_PROFILE_TLS __declspec(thread)
+#  define _AIR_PROFILE_HAVE_TLS 1
+#elif defined(__GNUC__)
+#  define _AIR_PROFILE_TLS __thread
+#  define _AIR_PROFILE_HAVE_TLS 1
+#else
+#  define _AIR_PROFILE_TLS
+#  define _AIR_PROFILE_HAVE_TLS 0
+#endif
+static _AIR_PROFILE_TLS _airProfileRecord *_airProfileMine = NULL;
+
+static _airProfileRecord *
+_airProfileRecordGet(void) {
+  _airProfileRecord *rec;
+
+  if (_airProfileMine) {
+    return _airProfileMine;
+  }
+  rec = AIR_CALLOC(1, _airProfileRecord);
+  if (!rec) {
+    /* nowhere to count; turn profiling off rather than crash */
+    airProfileEnabled = AIR_FALSE;
+    return NULL;
+  }
+  if (_airProfileMutex) {
+    airThreadMutexLock(_airProfileMutex);
+  }
+  rec->next = _airProfileList;
+  _airProfileList = rec;
+  if (_airProfileMutex) {
+    airThreadMutexUnlock(_airProfileMutex);
+  }
+  _airProfileMine = rec;
+  return rec;
+}
+
+/*
+** _airProfileThreadDone
+**
+** called by the threads started with airThreadStart when their body
+** returns: the calling thread's counts and times are added into
+** _airProfileDone, and its record is unlinked and freed
+*/
+void
+_airProfileThreadDone(void) {
+#if _AIR_PROFILE_HAVE_TLS
+  _airProfileRecord *rec, **prevP;
+  unsigned int pi;
+
+  rec = _airProfileMine;
+  if (!rec) {
+    /* this thread didn't profile anything */
+    return;
+  }
+  if (_airProfileMutex) {
+    airThreadMutexLock(_airProfileMutex);
+  }
+  for (prevP = &_airProfileList; *prevP; prevP = &((*prevP)->next)) {
+    if (rec == *prevP) {
+      *prevP = rec->next;
+      break;
+    }
+  }
+  for (pi=0; pi<=AIR_PROFILE_MAX; pi++) {
+    _airProfileDone.count[pi] += rec->count[pi];
+    _airProfileDone.time[pi] += rec->time[pi];
+  }
+  _airProfileDoneNum++;
+  if (_airProfileMutex) {
+    airThreadMutexUnlock(_airProfileMutex);
+  }
+  _airProfileMine = NULL;
+  free(rec);
+#endif
+  return;
+}
+
+/*
+******** airProfileEnable
+**
+** turns profiling on or off at run-time.  This should be called (to
+** turn profiling on) from the main thread before any other threads are
+** started, since it creates the mutex that guards record registration.
+** Turning profiling on when Teem was not compiled with TEEM_PROFILE
+** is allowed, but nothing will be counted.
+*/
+void
+airProfileEnable(int enable) {
+
+  if (enable && airThreadCapable && !_airProfileMutex) {
+    _airProfileMutex = airThreadMutexNew();
+  }
+  airProfileEnabled = !!enable;
+  return;
+}
+
+/*
+******** airProfileReset
+**
+** zeroes the counts and times of all threads
+*/
+void
+airProfileReset(void) {
+  _airProfileRecord *rec;
+  unsigned int pi;
+
+  if (_airProfileMutex) {
+    airThreadMutexLock(_airProfileMutex);
+  }
+  for (rec = _airProfileList; rec; rec = rec->next) {
+    for (pi=0; pi<=AIR_PROFILE_MAX; pi++) {
+      rec->count[pi] = rec->time[pi] = rec->start[pi] = 0;
+    }
+  }
+  for (pi=0; pi<=AIR_PROFILE_MAX; pi++) {
+    _airProfileDone.count[pi] = _airProfileDone.time[pi] = 0;
+  }
+  _airProfileDoneNum = 0;
+  if (_airProfileMutex) {
+    airThreadMutexUnlock(_airProfileMutex);
+  }
+  return;
+}
+
+/*
+******** airProfileCount
+**
+** adds num to the count of counter "which" for the calling thread.
+** Normally called via AIR_PROFILE_COUNT, which does the check of
+** airProfileEnabled; invalid "which" are silently ignored.
+*/
+void
+airProfileCount(int which, double num) {
+  _airProfileRecord *rec;
+
+  if (which > airProfileUnknown && which < airProfileLast
+      && (rec = _airProfileRecordGet())) {
+    rec->count[which] += num;
+  }
+  return;
+}
+
+/*
+******** airProfileStart, airProfileStop
+**
+** bracket a timed region for timer "which" in the calling thread; the
+** elapsed time is added to the timer at airProfileStop.  These are
+** not re-entrant per thread and timer: a second Start before the Stop
+** restarts the clock.
+*/
+void
+airProfileStart(int which) {
+  _airProfileRecord *rec;
+
+  if (which > airProfileUnknown && which < airProfileLast
+      && (rec = _airProfileRecordGet())) {
+    rec->start[which] = airTime();
+  }
+  return;
+}
+
+void
+airProfileStop(int which) {
+  _airProfileRecord *rec;
+
+  if (which > airProfileUnknown && which < airProfileLast
+      && (rec = _airProfileRecordGet())
+      && rec->start[which]) {
+    rec->time[which] += airTime() - rec->start[which];
+    rec->start[which] = 0;
+  }
+  return;
+}
+
+/*
+******** airProfileTotal
+**
+** sums the per-thread counts and times (including those of finished
+** threads) into the given arrays (either of which may be NULL), and
+** returns the number of threads that have recorded anything: those
+** still running, plus those that finished since the last
+** airProfileReset.
+*/
+unsigned int
+airProfileTotal(double count[AIR_PROFILE_MAX+1],
+                double time[AIR_PROFILE_MAX+1]) {
+  _airProfileRecord *rec;
+  unsigned int pi, recNum;
+
+  if (_airProfileMutex) {
+    airThreadMutexLock(_airProfileMutex);
+  }
+  for (pi=0; pi<=AIR_PROFILE_MAX; pi++) {
+    if (count) {
+      count[pi] = _airProfileDone.count[pi];
+    }
+    if (time) {
+      time[pi] = _airProfileDone.time[pi];
+    }
+  }
+  recNum = _airProfileDoneNum;
+  for (rec = _airProfileList; rec; rec = rec->next) {
+    for (pi=0; pi<=AIR_PROFILE_MAX; pi++) {
+      if (count) {
+        count[pi] += rec->count[pi];
+      }
+      if (time) {
+        time[pi] += rec->time[pi];
+      }
+    }
+    recNum++;
+  }
+  if (_airProfileMutex) {
+    airThreadMutexUnlock(_airProfileMutex);
+  }
+  return recNum;
+}
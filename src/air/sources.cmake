@@ -13,6 +13,7 @@ set(AIR_SOURCES
   mop.c
   parseAir.c
   privateAir.h
+  profileAir.c
   randMT.c
   sane.c
   string.c
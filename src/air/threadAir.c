@@ -22,6 +22,7 @@
 */
 
 #include "air.h"
+#include "privateAir.h"
 
 /* HEY: the whole matter of function returns has to be standardized. */
 
@@ -37,6 +38,8 @@ const int airThreadCapable = AIR_TRUE;
 
 struct _airThread {
   pthread_t id;
+  void *(*body)(void *);
+  void *arg;
 };
 
 struct _airThreadMutex {
@@ -56,15 +59,29 @@ airThreadNew(void) {
   return thread;
 }
 
+static void *
+_airThreadPthreadBody(void *_thread) {
+  airThread *thread;
+  void *ret;
+
+  thread = (airThread *)_thread;
+  ret = thread->body(thread->arg);
+  _airProfileThreadDone();
+  return ret;
+}
+
 int
 airThreadStart(airThread *thread, void *(*threadBody)(void *), void *arg) {
   pthread_attr_t attr;
 
+  thread->body = threadBody;
+  thread->arg = arg;
   pthread_attr_init(&attr);
 #ifdef __sgi
   pthread_attr_setscope(&attr, PTHREAD_SCOPE_BOUND_NP);
 #endif
-  return pthread_create(&(thread->id), &attr, threadBody, arg);
+  return pthread_create(&(thread->id), &attr, _airThreadPthreadBody,
+                        (void *)thread);
 }
 
 int
@@ -214,6 +231,7 @@ WINAPI _airThreadWin32Body(void *_thread) {
 
   thread = (airThread *)_thread;
   thread->ret = thread->body(thread->arg);
+  _airProfileThreadDone();
   return 0;
 }
 
@@ -593,3 +611,71 @@ airThreadBarrierNix(airThreadBarrier *barrier) {
   airFree(barrier);
   return NULL;
 }
+
+/*
+******** airThreadRun
+**
+** runs threadBody on each of the threadNum task structs (each of size
+** taskSize, in one array starting at task): task 0 in the calling thread,
+** and each of the others in a new thread, and then waits for them all.
+**
+** If a thread can't be started, then (if abortP is non-NULL) *abortP is
+** set to non-zero (while holding mutex, if that is non-NULL) so that the
+** threads already running can stop early, those threads are joined, and
+** the index (>= 1) of the thread that couldn't be started is returned;
+** task 0 is not run in that case.  Otherwise returns 0 when all the work
+** is done.
+*/
+unsigned int
+airThreadRun(unsigned int threadNum, void *(*threadBody)(void *),
+             void *task, size_t taskSize,
+             int *abortP, airThreadMutex *mutex) {
+  airThread **thread;
+  char *tbase;
+  unsigned int ti, failIdx;
+  void *ret;
+
+  tbase = AIR_CAST(char *, task);
+  if (threadNum <= 1) {
+    threadBody(task);
+    return 0;
+  }
+  thread = AIR_CALLOC(threadNum, airThread *);
+  if (!thread) {
+    /* can't start any threads */
+    return 1;
+  }
+  failIdx = 0;
+  for (ti=1; ti<threadNum; ti++) {
+    if (!( (thread[ti] = airThreadNew())
+           && !airThreadStart(thread[ti], threadBody,
+                              AIR_CAST(void *, tbase + ti*taskSize)) )) {
+      failIdx = ti;
+      break;
+    }
+  }
+  if (failIdx) {
+    if (abortP) {
+      if (mutex) {
+        airThreadMutexLock(mutex);
+      }
+      *abortP = AIR_TRUE;
+      if (mutex) {
+        airThreadMutexUnlock(mutex);
+      }
+    }
+  } else {
+    threadBody(task);
+  }
+  /* wait for the ones that were started */
+  for (ti=1; ti<(failIdx ? failIdx : threadNum); ti++) {
+    airThreadJoin(thread[ti], &ret);
+  }
+  for (ti=1; ti<threadNum; ti++) {
+    if (thread[ti]) {
+      airThreadNix(thread[ti]);
+    }
+  }
+  airFree(thread);
+  return failIdx;
+}
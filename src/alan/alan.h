@@ -146,12 +146,22 @@ typedef struct alanContext_t {
     *nlev;            /* pointer to last iterations output */
   Nrrd *nparm;        /* alpha, beta values for all texels */
   alan_t
-    averageChange;    /* average amount of "change" in last iteration */
-  int changeCount;    /* # of contributions to averageChange */
-                      /* to control update of averageChange and changeCount */
+    averageChange,    /* average amount of "change" in last iteration */
+    *_wwChange;       /* sum of change in each row (2D) or slice (3D), for
+                         iterations of both parities (threads can be one
+                         iteration apart): 2 x size[1] (or size[2]) array.
+                         Summed in order once the iteration is done, so
+                         that averageChange doesn't depend on threads */
+  int changeCount[2], /* # of threads done with iteration, by parity */
+    _stop[2],         /* stop conditions found while computing iteration */
+    iterDecided,      /* # of iterations finished by all threads, and for
+                         which the decision to stop or go on has been made */
+    threadIter[ALAN_THREAD_MAX];
+                      /* # of iterations finished by each thread */
+                      /* to control update of all the above */
   airThreadMutex *changeMutex;
-                      /* to synchronize separate iterations of simulation */
-  airThreadBarrier *iterBarrier;
+                      /* signaled whenever a thread finishes an iteration */
+  airThreadCond *iterCond;
 
   /* OUTPUT ---------------------------- */
   int stop;          /* why we stopped */
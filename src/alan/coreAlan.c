@@ -213,7 +213,6 @@ _alanPerIteration(alanContext *actx, int iter) {
   return 0;
 }
 
-
 typedef struct {
   /* these two are genuine input to each worker thread */
   alanContext *actx;
@@ -227,20 +226,134 @@ typedef struct {
   void *me;
 } alanTask;
 
-void *
-_alanTuringWorker(void *_task) {
+/*
+** the reaction and update at texel x of a row, given the laplacians
+** of the two morphogens.  This is what the per-texel code in
+** _alanTuringSlab does with conf == 1 and no correction terms.  Rather
+** than branching on the stopping conditions, it accumulates the sum and
+** max of |deltaA|, and a sum ("check") which stays zero unless some
+** deltaA or deltaB doesn't exist.
+*/
+#define _ALAN_TURING_TEXEL(x, lapA, lapB)                               \
+  A = row[0 + 2*(x)];                                                   \
+  B = row[1 + 2*(x)];                                                   \
+  deltaA = parm[0 + 3*(x)]*(rk*(parm[1 + 3*(x)] - A*B) + diffA*(lapA)); \
+  deltaB = parm[0 + 3*(x)]*(rk*(A*B - B - parm[2 + 3*(x)])              \
+                            + diffB*(lapB));                            \
+  absA = AIR_ABS(deltaA);                                               \
+  change += absA;                                                       \
+  maxA = AIR_MAX(maxA, absA);                                           \
+  check += 0*deltaA + 0*deltaB;                                         \
+  out[0 + 2*(x)] = A + deltaA;                                          \
+  B += deltaB;                                                          \
+  out[1 + 2*(x)] = AIR_MAX(0, B)
+
+/*
+** one row of the Turing update in the absence of tensors.  "row" is
+** the row itself in the old levels, "out" is where it goes in the new
+** levels, and nb[] points to the rows on either side: Y-1 and Y+1 in
+** 2D, Z-1, Y-1, Y+1, Z+1 in 3D (in the same order as the terms of the
+** laplacian in the per-texel code, so that the results are identical).
+** The first and last texels of the row are done separately, so that the
+** loop over the rest has no boundary logic and no branches, and only
+** unit-stride access (within the interleaving of morphogens and
+** parameters) to contiguous memory, and so can be vectorized.
+*/
+static void
+_alanTuringRow(alan_t *out, const alan_t *row, const alan_t *const *nb,
+               const alan_t *parm, int sx, int dim, int wrap,
+               alan_t rk, alan_t diffA, alan_t diffB, alan_t sum[3]) {
+  alan_t A, B, deltaA, deltaB, absA, change, maxA, check, lapA, lapB;
+  const alan_t *n0, *n1, *n2, *n3;
+  int x, mx, px, ei, end[2];
+
+  change = maxA = check = 0;
+  n0 = nb[0];
+  n1 = nb[1];
+  n2 = (3 == dim ? nb[2] : NULL);
+  n3 = (3 == dim ? nb[3] : NULL);
+  end[0] = 0;
+  end[1] = sx-1;
+  /* (with sx == 1, there is only one end) */
+  for (ei=0; ei<(sx > 1 ? 2 : 1); ei++) {
+    x = end[ei];
+    if (wrap) {
+      px = AIR_MOD(x+1, sx);
+      mx = AIR_MOD(x-1, sx);
+    } else {
+      px = AIR_MIN(x+1, sx-1);
+      mx = AIR_MAX(x-1, 0);
+    }
+    if (2 == dim) {
+      lapA = (n0[0 + 2*x] + row[0 + 2*mx] + row[0 + 2*px] + n1[0 + 2*x]
+              - 4*row[0 + 2*x]);
+      lapB = (n0[1 + 2*x] + row[1 + 2*mx] + row[1 + 2*px] + n1[1 + 2*x]
+              - 4*row[1 + 2*x]);
+    } else {
+      lapA = (n0[0 + 2*x] + n1[0 + 2*x] + row[0 + 2*mx]
+              + row[0 + 2*px] + n2[0 + 2*x] + n3[0 + 2*x] - 6*row[0 + 2*x]);
+      lapB = (n0[1 + 2*x] + n1[1 + 2*x] + row[1 + 2*mx]
+              + row[1 + 2*px] + n2[1 + 2*x] + n3[1 + 2*x] - 6*row[1 + 2*x]);
+    }
+    _ALAN_TURING_TEXEL(x, lapA, lapB);
+  }
+  if (2 == dim) {
+    for (x=1; x<sx-1; x++) {
+      _ALAN_TURING_TEXEL(x,
+                         (n0[0 + 2*x] + row[0 + 2*x - 2] + row[0 + 2*x + 2]
+                          + n1[0 + 2*x] - 4*row[0 + 2*x]),
+                         (n0[1 + 2*x] + row[1 + 2*x - 2] + row[1 + 2*x + 2]
+                          + n1[1 + 2*x] - 4*row[1 + 2*x]));
+    }
+  } else {
+    for (x=1; x<sx-1; x++) {
+      _ALAN_TURING_TEXEL(x,
+                         (n0[0 + 2*x] + n1[0 + 2*x] + row[0 + 2*x - 2]
+                          + row[0 + 2*x + 2] + n2[0 + 2*x] + n3[0 + 2*x]
+                          - 6*row[0 + 2*x]),
+                         (n0[1 + 2*x] + n1[1 + 2*x] + row[1 + 2*x - 2]
+                          + row[1 + 2*x + 2] + n2[1 + 2*x] + n3[1 + 2*x]
+                          - 6*row[1 + 2*x]));
+    }
+  }
+  sum[0] += change;
+  sum[1] = AIR_MAX(sum[1], maxA);
+  sum[2] += check;
+  return;
+}
+
+/*
+** of two stop conditions found in computing an iteration, the one to
+** report: NonExist over any other, and anything over alanStopNot
+*/
+static int
+_alanStopMerge(int stopA, int stopB) {
+
+  if (alanStopNonExist == stopA || alanStopNonExist == stopB) {
+    return alanStopNonExist;
+  }
+  return (alanStopNot != stopA ? stopA : stopB);
+}
+
+/*
+** computes one iteration, from lev0 into lev1, on rows (2D) or
+** slices (3D) [startW, endW).  Returns the stop condition found,
+** and the sum of |deltaA| in each row or slice ww in wwChange[ww]
+*/
+static int
+_alanTuringSlab(alanTask *task, const alan_t *lev0, alan_t *lev1,
+                int startW, int endW, alan_t *wwChange) {
   alan_t *tendata, *ten, react,
     conf, Dxx, Dxy, Dyy, /* Dxz, Dyz, */
     *tpx, *tmx, *tpy, *tmy, /* *tpz, *tmz, */
-    *lev0, *lev1, *parm, deltaT, alpha, beta, A, B,
-    *v[27], lapA, lapB, corrA, corrB,
-    deltaA, deltaB, diffA, diffB, change;
-  int dim, iter, stop, startW, endW, idx,
+    *parm, deltaT, alpha, beta, A, B,
+    lapA, lapB, corrA, corrB,
+    deltaA, deltaB, diffA, diffB, change, sum[3];
+  const alan_t *v[27];
+  int dim, stop, idx,
     px, mx, py, my, pz, mz,
     startY, endY, startZ, endZ, sx, sy, sz, x, y, z;
-  alanTask *task;
 
-  task = (alanTask *)_task;
   dim = task->actx->dim;
   sx = task->actx->size[0];
   sy = task->actx->size[1];
@@ -248,8 +361,6 @@ _alanTuringWorker(void *_task) {
   parm = (alan_t*)(task->actx->nparm->data);
   diffA = AIR_CAST(alan_t, task->actx->diffA/pow(task->actx->deltaX, dim));
   diffB = AIR_CAST(alan_t, task->actx->diffB/pow(task->actx->deltaX, dim));
-  startW = task->idx*sy/task->actx->numThreads;
-  endW = (task->idx+1)*sy/task->actx->numThreads;
   tendata = task->actx->nten ? (alan_t *)task->actx->nten->data : NULL;
   react = task->actx->react;
 
@@ -265,37 +376,42 @@ _alanTuringWorker(void *_task) {
     endY = sy;
   }
 
-  for (iter = 0;
-       (alanStopNot == task->actx->stop
-        && (0 == task->actx->maxIteration
-            || iter < task->actx->maxIteration));
-       iter++) {
-
-    if (0 == task->idx) {
-      task->actx->iter = iter;
-      task->actx->nlev = task->actx->_nlev[(iter+1) % 2];
+  stop = alanStopNot;
+  change = 0;
+  ELL_3V_SET(sum, 0, 0, 0);
+  conf = 1;  /* if you have no data; this will stay 1 */
+  for (z = startZ; z < endZ; z++) {
+    if (task->actx->wrap) {
+      pz = AIR_MOD(z+1, sz);
+      mz = AIR_MOD(z-1, sz);
+    } else {
+      pz = AIR_MIN(z+1, sz-1);
+      mz = AIR_MAX(z-1, 0);
     }
-    lev0 = (alan_t*)(task->actx->_nlev[iter % 2]->data);
-    lev1 = (alan_t*)(task->actx->_nlev[(iter+1) % 2]->data);
-    stop = alanStopNot;
-    change = 0;
-    conf = 1;  /* if you have no data; this will stay 1 */
-    for (z = startZ; z < endZ; z++) {
+    for (y = startY; y < endY; y++) {
       if (task->actx->wrap) {
-        pz = AIR_MOD(z+1, sz);
-        mz = AIR_MOD(z-1, sz);
+        py = AIR_MOD(y+1, sy);
+        my = AIR_MOD(y-1, sy);
       } else {
-        pz = AIR_MIN(z+1, sz-1);
-        mz = AIR_MAX(z-1, 0);
+        py = AIR_MIN(y+1, sy-1);
+        my = AIR_MAX(y-1, 0);
       }
-      for (y = startY; y < endY; y++) {
-        if (task->actx->wrap) {
-          py = AIR_MOD(y+1, sy);
-          my = AIR_MOD(y-1, sy);
+      if (!tendata) {
+        /* the common case, done a row at a time */
+        idx = sx*(y + sy*z);
+        if (2 == dim) {
+          v[0] = lev0 + 2*sx*(my);
+          v[1] = lev0 + 2*sx*(py);
         } else {
-          py = AIR_MIN(y+1, sy-1);
-          my = AIR_MAX(y-1, 0);
+          v[0] = lev0 + 2*sx*( y + sy*(mz));
+          v[1] = lev0 + 2*sx*(my + sy*( z));
+          v[2] = lev0 + 2*sx*(py + sy*( z));
+          v[3] = lev0 + 2*sx*( y + sy*(pz));
         }
+        _alanTuringRow(lev1 + 2*idx, lev0 + 2*idx, v, parm + 3*idx,
+                       sx, dim, task->actx->wrap,
+                       react*conf*task->actx->K, diffA, diffB, sum);
+      } else {
         for (x = 0; x < sx; x++) {
           if (task->actx->wrap) {
             px = AIR_MOD(x+1, sx);
@@ -323,93 +439,57 @@ _alanTuringWorker(void *_task) {
             v[3] = lev0 + 2*(mx + sx*( y));
             v[5] = lev0 + 2*(px + sx*( y));
             v[7] = lev0 + 2*( x + sx*(py));
-            if (tendata) {
-              /*
-              **  0 1 2    Dxy/2          Dyy        -Dxy/2
-              **  3 4 5     Dxx     -2*(Dxx + Dyy)     Dxx
-              **  6 7 8   -Dxy/2          Dyy         Dxy/2
-              */
-              v[0] = lev0 + 2*(mx + sx*(my));
-              v[2] = lev0 + 2*(px + sx*(my));
-              v[6] = lev0 + 2*(mx + sx*(py));
-              v[8] = lev0 + 2*(px + sx*(py));
-              ten = tendata + 4*idx;
-              conf = AIR_CAST(alan_t, (AIR_CLAMP(0.3, ten[0], 1) - 0.3)/0.7);
-              if (conf) {
-                Dxx = ten[1];
-                Dxy = ten[2];
-                Dyy = ten[3];
-                lapA = (Dxy*(v[0][0] + v[8][0] - v[2][0] - v[6][0])/2
-                        + Dxx*(v[3][0] + v[5][0]) + Dyy*(v[1][0] + v[7][0])
-                        - 2*(Dxx + Dyy)*A);
-                lapB = (Dxy*(v[0][1] + v[8][1] - v[2][1] - v[6][1])/2
-                        + Dxx*(v[3][1] + v[5][1]) + Dyy*(v[1][1] + v[7][1])
-                        - 2*(Dxx + Dyy)*B);
-                if (!(task->actx->homogAniso)) {
-                  tpx = tendata + 4*(px + sx*( y + sy*( z)));
-                  tmx = tendata + 4*(mx + sx*( y + sy*( z)));
-                  tpy = tendata + 4*( x + sx*(py + sy*( z)));
-                  tmy = tendata + 4*( x + sx*(my + sy*( z)));
-                  corrA = ((tpx[1]-tmx[1])*(v[5][0]-v[3][0])/4+ /* Dxx,x*A,x */
-                           (tpx[2]-tmx[2])*(v[7][0]-v[1][0])/4+ /* Dxy,x*A,y */
-                           (tpy[2]-tmy[2])*(v[5][0]-v[3][0])/4+ /* Dxy,y*A,x */
-                           (tpy[3]-tmy[3])*(v[7][0]-v[1][0]));  /* Dyy,y*A,y */
-                  corrB = ((tpx[1]-tmx[1])*(v[5][1]-v[3][1])/4+ /* Dxx,x*B,x */
-                           (tpx[2]-tmx[2])*(v[7][1]-v[1][1])/4+ /* Dxy,x*B,y */
-                           (tpy[2]-tmy[2])*(v[5][1]-v[3][1])/4+ /* Dxy,y*B,x */
-                           (tpy[3]-tmy[3])*(v[7][1]-v[1][1]));  /* Dyy,y*B,y */
-                }
-              } else {
-                /* no confidence; you diffuse */
-                lapA = v[1][0] + v[3][0] + v[5][0] + v[7][0] - 4*A;
-                lapB = v[1][1] + v[3][1] + v[5][1] + v[7][1] - 4*B;
+            /*
+            **  0 1 2    Dxy/2          Dyy        -Dxy/2
+            **  3 4 5     Dxx     -2*(Dxx + Dyy)     Dxx
+            **  6 7 8   -Dxy/2          Dyy         Dxy/2
+            */
+            v[0] = lev0 + 2*(mx + sx*(my));
+            v[2] = lev0 + 2*(px + sx*(my));
+            v[6] = lev0 + 2*(mx + sx*(py));
+            v[8] = lev0 + 2*(px + sx*(py));
+            ten = tendata + 4*idx;
+            conf = AIR_CAST(alan_t, (AIR_CLAMP(0.3, ten[0], 1) - 0.3)/0.7);
+            if (conf) {
+              Dxx = ten[1];
+              Dxy = ten[2];
+              Dyy = ten[3];
+              lapA = (Dxy*(v[0][0] + v[8][0] - v[2][0] - v[6][0])/2
+                      + Dxx*(v[3][0] + v[5][0]) + Dyy*(v[1][0] + v[7][0])
+                      - 2*(Dxx + Dyy)*A);
+              lapB = (Dxy*(v[0][1] + v[8][1] - v[2][1] - v[6][1])/2
+                      + Dxx*(v[3][1] + v[5][1]) + Dyy*(v[1][1] + v[7][1])
+                      - 2*(Dxx + Dyy)*B);
+              if (!(task->actx->homogAniso)) {
+                tpx = tendata + 4*(px + sx*( y + sy*( z)));
+                tmx = tendata + 4*(mx + sx*( y + sy*( z)));
+                tpy = tendata + 4*( x + sx*(py + sy*( z)));
+                tmy = tendata + 4*( x + sx*(my + sy*( z)));
+                corrA = ((tpx[1]-tmx[1])*(v[5][0]-v[3][0])/4+ /* Dxx,x*A,x */
+                         (tpx[2]-tmx[2])*(v[7][0]-v[1][0])/4+ /* Dxy,x*A,y */
+                         (tpy[2]-tmy[2])*(v[5][0]-v[3][0])/4+ /* Dxy,y*A,x */
+                         (tpy[3]-tmy[3])*(v[7][0]-v[1][0]));  /* Dyy,y*A,y */
+                corrB = ((tpx[1]-tmx[1])*(v[5][1]-v[3][1])/4+ /* Dxx,x*B,x */
+                         (tpx[2]-tmx[2])*(v[7][1]-v[1][1])/4+ /* Dxy,x*B,y */
+                         (tpy[2]-tmy[2])*(v[5][1]-v[3][1])/4+ /* Dxy,y*B,x */
+                         (tpy[3]-tmy[3])*(v[7][1]-v[1][1]));  /* Dyy,y*B,y */
               }
             } else {
-              /* no data; you diffuse */
+              /* no confidence; you diffuse */
               lapA = v[1][0] + v[3][0] + v[5][0] + v[7][0] - 4*A;
               lapB = v[1][1] + v[3][1] + v[5][1] + v[7][1] - 4*B;
             }
           } else {
-            /* 3 == dim */
-            /*
-            **          0   1   2   ---- X
-            **        3   4   5
-            **      6   7   8
-            **    /
-            **  /       9  10  11
-            ** Y     12  13  14
-            **     15  16  17
-            **
-            **         18  19  20
-            **       21  22  23
-            **     24  25  26
-            **         |
-            **         |
-            **         Z
-            */
-            v[ 4] = lev0 + 2*( x + sx*( y + sy*(mz)));
-            v[10] = lev0 + 2*( x + sx*(my + sy*( z)));
-            v[12] = lev0 + 2*(mx + sx*( y + sy*( z)));
-            v[14] = lev0 + 2*(px + sx*( y + sy*( z)));
-            v[16] = lev0 + 2*( x + sx*(py + sy*( z)));
-            v[22] = lev0 + 2*( x + sx*( y + sy*(pz)));
-            if (tendata) {
+            /* 3 == dim, with tensors: HEY not implemented */
+            if (!(task->actx->homogAniso)) {
 
-              if (!(task->actx->homogAniso)) {
-
-              }
-            } else {
-              lapA = (v[ 4][0] + v[10][0] + v[12][0]
-                      + v[14][0] + v[16][0] + v[22][0] - 6*A);
-              lapB = (v[ 4][1] + v[10][1] + v[12][1]
-                      + v[14][1] + v[16][1] + v[22][1] - 6*B);
             }
           }
 
           deltaA = deltaT*(react*conf*task->actx->K*(alpha - A*B)
                            + diffA*(lapA + corrA));
           if (AIR_ABS(deltaA) > task->actx->maxPixelChange) {
-            stop = alanStopDiverged;
+            stop = _alanStopMerge(stop, alanStopDiverged);
           }
           change += AIR_ABS(deltaA);
           deltaB = deltaT*(react*conf*task->actx->K*(A*B - B - beta)
@@ -424,44 +504,163 @@ _alanTuringWorker(void *_task) {
           lev1[1 + 2*idx] = B;
         }
       }
+      if (2 == dim) {
+        /* (only one of change and sum[0] is in use) */
+        wwChange[y] = change + sum[0];
+        change = sum[0] = 0;
+      }
+    }
+    if (3 == dim) {
+      wwChange[z] = change + sum[0];
+      change = sum[0] = 0;
     }
+  }
+  if (!tendata) {
+    if (!AIR_EXISTS(sum[2])) {
+      stop = alanStopNonExist;
+    } else if (sum[1] > task->actx->maxPixelChange) {
+      stop = alanStopDiverged;
+    }
+  }
+  return stop;
+}
 
-    /* add change to global sum in a threadsafe way */
-    airThreadMutexLock(task->actx->changeMutex);
-    task->actx->averageChange += change/(sx*sy*sz);
-    task->actx->changeCount += 1;
-    if (task->actx->changeCount == task->actx->numThreads) {
-      /* I must be the last thread to reach this point; all
-         others must have passed the mutex unlock, and are
-         sitting at the barrier */
-      if (alanStopNot != stop) {
-        /* there was some problem in going from lev0 to lev1, which
-           we deal with now by setting actx->stop */
-        task->actx->stop = stop;
-      } else if (task->actx->averageChange < task->actx->minAverageChange) {
-        /* we converged */
-        task->actx->stop = alanStopConverged;
-      } else {
-        /* we keep going */
-        _alanPerIteration(task->actx, iter);
-        if (task->actx->perIteration) {
-          task->actx->perIteration(task->actx, iter);
-        }
-      }
-      task->actx->averageChange = 0;
-      task->actx->changeCount = 0;
+/*
+** decides, once all threads have finished iteration iter, whether
+** to stop; called by the last thread to finish, with changeMutex locked
+*/
+static void
+_alanIterationDecide(alanContext *actx, int iter) {
+  unsigned int ww, wwNum;
+  alan_t change;
+  int par;
+
+  par = iter % 2;
+  actx->iter = iter;
+  actx->nlev = actx->_nlev[(iter+1) % 2];
+  wwNum = (2 == actx->dim ? actx->size[1] : actx->size[2]);
+  change = 0;
+  for (ww=0; ww<wwNum; ww++) {
+    change += actx->_wwChange[ww + wwNum*par];
+  }
+  actx->averageChange = change/(actx->size[0]*actx->size[1]
+                                *(2 == actx->dim ? 1 : actx->size[2]));
+  if (alanStopNot != actx->_stop[par]) {
+    /* there was some problem in going from lev0 to lev1, which
+       we deal with now by setting actx->stop */
+    actx->stop = actx->_stop[par];
+  } else if (actx->averageChange < actx->minAverageChange) {
+    /* we converged */
+    actx->stop = alanStopConverged;
+  } else {
+    /* we keep going */
+    _alanPerIteration(actx, iter);
+    if (actx->perIteration) {
+      actx->perIteration(actx, iter);
     }
-    airThreadMutexUnlock(task->actx->changeMutex);
+    if (iter+1 == actx->maxIteration) {
+      actx->stop = alanStopMaxIteration;
+    }
+  }
+  actx->iterDecided = iter+1;
+  return;
+}
+
+/*
+** which thread owns row (2D) or slice (3D) ww, of wwNum
+*/
+static int
+_alanOwner(int ww, int wwNum, int numThreads) {
+  int tid;
 
-    /* force all threads to line up here, once per iteration */
-    airThreadBarrierWait(task->actx->iterBarrier);
+  for (tid=0; tid<numThreads; tid++) {
+    if (ww < (tid+1)*wwNum/numThreads) {
+      break;
+    }
   }
+  return tid;
+}
 
-  if (iter == task->actx->maxIteration) {
-    /* HEY: all threads will agree on this, right? */
-    task->actx->stop = alanStopMaxIteration;
+/*
+** Each thread works on a slab of rows (2D) or slices (3D).  Rather
+** than having all threads line up at a barrier after every iteration,
+** a thread starts iteration iter as soon as (1) the threads owning the
+** rows on either side of its slab (its halo) have finished iteration
+** iter-1, so that the halo values it reads are current, and the halo
+** values from iteration iter-2, in the buffer it is about to write,
+** are no longer needed, and (2) the decision to stop or go on has been
+** made for iteration iter-2 (which ensures that when we stop after an
+** iteration, its results in actx->nlev are not overwritten).  Threads
+** can thus drift one iteration apart.  Convergence is checked by
+** having each thread record the change in each of its rows or slices,
+** and the last thread to finish an iteration makes the decision, after
+** summing those in order (so that it doesn't depend on the number of
+** threads).
+*/
+void *
+_alanTuringWorker(void *_task) {
+  alanTask *task;
+  alanContext *actx;
+  alan_t *lev0, *lev1;
+  int iter, stop, go, par, wwNum, startW, endW, loTid, hiTid;
+
+  task = (alanTask *)_task;
+  actx = task->actx;
+  wwNum = (2 == actx->dim ? actx->size[1] : actx->size[2]);
+  startW = task->idx*wwNum/actx->numThreads;
+  endW = (task->idx+1)*wwNum/actx->numThreads;
+  /* learn the threads owning our halo (or -1 if there's no need) */
+  loTid = hiTid = -1;
+  if (startW < endW) {
+    if (startW > 0 || actx->wrap) {
+      loTid = _alanOwner(AIR_MOD(startW-1, wwNum), wwNum, actx->numThreads);
+    }
+    if (endW < wwNum || actx->wrap) {
+      hiTid = _alanOwner(AIR_MOD(endW, wwNum), wwNum, actx->numThreads);
+    }
+    loTid = (loTid == task->idx ? -1 : loTid);
+    hiTid = (hiTid == task->idx ? -1 : hiTid);
   }
-  /* else: the non-alanStopNot value of task->actx->stop made us stop */
+
+  for (iter = 0; ; iter++) {
+    airThreadMutexLock(actx->changeMutex);
+    while (alanStopNot == actx->stop
+           && !(actx->iterDecided >= iter-1
+                && (-1 == loTid || actx->threadIter[loTid] >= iter)
+                && (-1 == hiTid || actx->threadIter[hiTid] >= iter))) {
+      airThreadCondWait(actx->iterCond, actx->changeMutex);
+    }
+    go = (alanStopNot == actx->stop);
+    airThreadMutexUnlock(actx->changeMutex);
+    if (!go) {
+      break;
+    }
+
+    lev0 = (alan_t*)(actx->_nlev[iter % 2]->data);
+    lev1 = (alan_t*)(actx->_nlev[(iter+1) % 2]->data);
+    par = iter % 2;
+    stop = _alanTuringSlab(task, lev0, lev1, startW, endW,
+                           actx->_wwChange + wwNum*par);
+
+    /* record that we're done with this iteration in a threadsafe way */
+    airThreadMutexLock(actx->changeMutex);
+    actx->threadIter[task->idx] = iter+1;
+    actx->_stop[par] = _alanStopMerge(actx->_stop[par], stop);
+    actx->changeCount[par] += 1;
+    if (actx->changeCount[par] == actx->numThreads) {
+      /* I must be the last thread to finish this iteration; but we
+         may have already stopped after the previous one */
+      if (alanStopNot == actx->stop) {
+        _alanIterationDecide(actx, iter);
+      }
+      actx->_stop[par] = alanStopNot;
+      actx->changeCount[par] = 0;
+    }
+    airThreadCondBroadcast(actx->iterCond);
+    airThreadMutexUnlock(actx->changeMutex);
+  }
+
+  /* the non-alanStopNot value of actx->stop made us stop */
   return _task;
 }
 
@@ -480,16 +679,33 @@ alanRun(alanContext *actx) {
              "call alanUpdate + alanInit", me);
     return 1;
   }
+  if (!( 1 <= actx->numThreads && actx->numThreads <= ALAN_THREAD_MAX )) {
+    biffAddf(ALAN, "%s: numThreads %d not in [1,%d]", me,
+             actx->numThreads, ALAN_THREAD_MAX);
+    return 1;
+  }
+  actx->_wwChange = AIR_CALLOC(2*(2 == actx->dim
+                                  ? actx->size[1] : actx->size[2]), alan_t);
+  if (!actx->_wwChange) {
+    biffAddf(ALAN, "%s: couldn't allocate per-%s change", me,
+             2 == actx->dim ? "row" : "slice");
+    return 1;
+  }
 
   if (!airThreadCapable && 1 == actx->numThreads) {
     hack = airThreadNoopWarning;
     airThreadNoopWarning = AIR_FALSE;
   }
   actx->changeMutex = airThreadMutexNew();
-  actx->iterBarrier = airThreadBarrierNew(actx->numThreads);
+  actx->iterCond = airThreadCondNew();
   actx->averageChange = 0;
-  actx->changeCount = 0;
+  actx->_stop[0] = actx->_stop[1] = alanStopNot;
+  actx->changeCount[0] = actx->changeCount[1] = 0;
+  actx->iterDecided = 0;
   actx->stop = alanStopNot;
+  for (tid=0; tid<actx->numThreads; tid++) {
+    actx->threadIter[tid] = 0;
+  }
   for (tid=0; tid<actx->numThreads; tid++) {
     task[tid].actx = actx;
     task[tid].idx = tid;
@@ -501,8 +717,9 @@ alanRun(alanContext *actx) {
     airThreadJoin(task[tid].thread, &(task[tid].me));
     task[tid].thread = airThreadNix(task[tid].thread);
   }
-  actx->iterBarrier = airThreadBarrierNix(actx->iterBarrier);
+  actx->iterCond = airThreadCondNix(actx->iterCond);
   actx->changeMutex = airThreadMutexNix(actx->changeMutex);
+  actx->_wwChange = (alan_t *)airFree(actx->_wwChange);
 
   if (!airThreadCapable && 1 == actx->numThreads) {
     airThreadNoopWarning = hack;
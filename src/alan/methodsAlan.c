@@ -76,6 +76,7 @@ alanContextNew(void) {
   actx->nlev = NULL;
   actx->nparm = NULL;
   actx->nten = NULL;
+  actx->_wwChange = NULL;
   alanContextInit(actx);
   return actx;
 }
@@ -142,7 +143,7 @@ alan2DSizeSet(alanContext *actx, int sizeX, int sizeY) {
 
 int
 alan3DSizeSet(alanContext *actx, int sizeX, int sizeY, int sizeZ) {
-  static const char me[]="alan2DSizeSet";
+  static const char me[]="alan3DSizeSet";
 
   GOT_NULL;
   DIM_SET;
@@ -222,7 +223,7 @@ alanParmSet(alanContext *actx, int whichParm, double parm) {
     actx->verbose = parmI;
     break;
   case alanParmTextureType:
-    parmI = !!parm;
+    parmI = AIR_INT(parm);
     switch(parmI) {
     case alanTextureTypeTuring:
       actx->initA = 4.0;
@@ -244,7 +245,7 @@ alanParmSet(alanContext *actx, int whichParm, double parm) {
     actx->textureType = parmI;
     break;
   case alanParmNumThreads:
-    parmI = !!parm;
+    parmI = AIR_INT(parm);
     if (!airThreadCapable) {
       fprintf(stderr, "%s: WARNING: no multi-threading available, so 1 thread "
               "will be used, not %d\n", me, parmI);
@@ -257,15 +258,15 @@ alanParmSet(alanContext *actx, int whichParm, double parm) {
     actx->homogAniso = parmI;
     break;
   case alanParmSaveInterval:
-    parmI = !!parm;
+    parmI = AIR_INT(parm);
     actx->saveInterval = parmI;
     break;
   case alanParmFrameInterval:
-    parmI = !!parm;
+    parmI = AIR_INT(parm);
     actx->frameInterval = parmI;
     break;
   case alanParmMaxIteration:
-    parmI = !!parm;
+    parmI = AIR_INT(parm);
     actx->maxIteration = parmI;
     break;
   case alanParmConstantFilename:
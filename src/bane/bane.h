@@ -279,6 +279,8 @@ typedef struct {
                                           measured (as many as) three times */
     renormalize,                       /* use gage's mask renormalization */
     k3pack;
+  unsigned int threadNum;              /* number of threads to measure and
+                                          histogram with */
   const NrrdKernel *k[GAGE_KERNEL_MAX+1];
   double kparm[GAGE_KERNEL_MAX+1][NRRD_KERNEL_PARMS_NUM];
   baneClip *clip;
@@ -287,7 +289,11 @@ typedef struct {
                                           has been determined */
   baneAxis axis[3];
   /* -------------- internal */
-  Nrrd *measrVol;
+  Nrrd *measrVol;                      /* 3 x X x Y x Z floats.  Can be set
+                                          (along with measrVolDone) from a
+                                          previous run with the same input
+                                          and parameters, to skip measuring
+                                          altogether */
   int measrVolDone;                    /* values in measrVol are filled */
 } baneHVolParm;
 
@@ -298,6 +304,7 @@ BANE_EXPORT int baneDefMakeMeasrVol;
 BANE_EXPORT double baneDefIncLimit;
 BANE_EXPORT int baneDefRenormalize;
 BANE_EXPORT int baneDefPercHistBins;
+BANE_EXPORT unsigned int baneDefThreadNum;
 BANE_EXPORT int baneStateHistEqBins;
 BANE_EXPORT int baneStateHistEqSmart;
 BANE_EXPORT int baneHack;
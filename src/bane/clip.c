@@ -183,7 +183,6 @@ baneClip *
 baneClipNix(baneClip *clip) {
 
   if (clip) {
-    airFree(clip->name);
     airFree(clip);
   }
   return NULL;
@@ -41,6 +41,9 @@ baneDefRenormalize = AIR_TRUE;
 int
 baneDefPercHistBins = 1024;
 
+unsigned int
+baneDefThreadNum = 1;
+
 int
 baneStateHistEqBins = 4096;
 
@@ -39,7 +39,9 @@ baneGkms_hvolMain(int argc, const char **argv, const char *me,
   char *out, *perr;
   Nrrd *nin, *nout;
   airArray *mop;
+  char *mviS, *mvoS;
   int pret, dim[3], lapl, slow, gz = AIR_FALSE;
+  unsigned int threadNum;
   double inc[3*(1+BANE_PARM_NUM)];
   baneHVolParm *hvp;
   NrrdIoState *nio;
@@ -78,6 +80,15 @@ baneGkms_hvolMain(int argc, const char **argv, const char *me,
              "Instead of allocating a floating point VGH volume and measuring "
              "V,G,H once, measure V,G,H multiple times on separate passes "
              "(slower, but needs less memory)");
+  hestOptAdd(&opt, "nt", "# threads", airTypeUInt, 1, 1, &threadNum, "1",
+             "number of threads to measure and histogram with");
+  hestOptAdd(&opt, "mvi", "VGHin", airTypeString, 1, 1, &mviS, "",
+             "if a filename is given here, the VGH volume is read from it "
+             "(as saved by \"-mvo\", with the same input and kernels) "
+             "instead of measured");
+  hestOptAdd(&opt, "mvo", "VGHout", airTypeString, 1, 1, &mvoS, "",
+             "if a filename is given here, the VGH volume is saved to it, "
+             "for re-use with \"-mvi\"");
   if (nrrdEncodingGzip->available()) {
     hestOptAdd(&opt, "gz", NULL, airTypeInt, 0, 0, &gz, NULL,
                "Use gzip compression for output histo-volume; "
@@ -103,6 +114,16 @@ baneGkms_hvolMain(int argc, const char **argv, const char *me,
   airMopAdd(mop, hvp, (airMopper)baneHVolParmNix, airMopAlways);
   baneHVolParmGKMSInit(hvp);
   hvp->makeMeasrVol = !slow;
+  hvp->threadNum = threadNum;
+  if (airStrlen(mviS)) {
+    hvp->measrVol = nrrdNew();
+    if (nrrdLoad(hvp->measrVol, mviS, NULL)) {
+      biffMovef(BANE, NRRD, "%s: trouble reading VGH volume", me);
+      airMopError(mop); return 1;
+    }
+    hvp->makeMeasrVol = AIR_TRUE;
+    hvp->measrVolDone = AIR_TRUE;
+  }
 
   fprintf(stderr, "!%s: need to be using baneHVolParmAxisSet\n", me);
   /*
@@ -126,6 +147,17 @@ baneGkms_hvolMain(int argc, const char **argv, const char *me,
     airMopError(mop); return 1;
   }
 
+  if (airStrlen(mvoS)) {
+    if (!hvp->measrVol) {
+      biffAddf(BANE, "%s: no VGH volume to save (with \"-slow\"?)", me);
+      airMopError(mop); return 1;
+    }
+    if (nrrdSave(mvoS, hvp->measrVol, NULL)) {
+      biffMovef(BANE, NRRD, "%s: error saving VGH volume", me);
+      airMopError(mop); return 1;
+    }
+  }
+
   nio->encoding = gz ? nrrdEncodingGzip : nrrdEncodingRaw;
   if (nrrdSave(out, nout, nio)) {
     biffMovef(BANE, NRRD, "%s: error saving histogram volume", me);
@@ -74,9 +74,14 @@ baneProbe(double val[3],
     val[1] = baneMeasrAnswer(hvp->axis[1].measr, ctx);
     val[2] = baneMeasrAnswer(hvp->axis[2].measr, ctx);
     if (hvp->makeMeasrVol) {
+      /* later passes (or later runs, given this measrVol) will see the
+         values as floats, so this pass has to as well */
       data[0] = AIR_CAST(float, val[0]);
       data[1] = AIR_CAST(float, val[1]);
       data[2] = AIR_CAST(float, val[2]);
+      val[0] = data[0];
+      val[1] = data[1];
+      val[2] = data[2];
     }
   } else {
     val[0] = data[0];
@@ -86,23 +91,315 @@ baneProbe(double val[3],
   return;
 }
 
-int
-baneFindInclusion(double min[3], double max[3],
-                  Nrrd *nin, baneHVolParm *hvp, gageContext *ctx) {
-  static const char me[]="baneFindInclusion";
-  char prog[13],
-    aname[3][AIR_STRLEN_SMALL] = {"grad-mag", "2nd deriv", "data value"};
-  int sx, sy, sz, x, y, z, E, ai;
-  baneInc *inc[3];
-  /* HEY HEY HEY:  The variable "hist" is used before its value is set.
-  Nrrd *hist[3];
-  */
+/*
+** the measurement and histogramming work of baneFindInclusion and
+** baneMakeHVol is split across hvp->threadNum threads, each one
+** doing a contiguous range of z slices
+*/
+enum {
+  _baneStagePassA,       /* inclusion pass A (inc->process[0]) */
+  _baneStagePassB,       /* inclusion pass B (inc->process[1]) */
+  _baneStageMeasr,       /* only fill hvp->measrVol */
+  _baneStageHist         /* fill raw histogram volume */
+};
+
+typedef struct {
+  Nrrd *nin;
+  baneHVolParm *hvp;
+  gageContext *gctx;     /* thread 0 uses the caller's, others a copy */
+  unsigned int threadIdx,
+    lo[3], hi[3];        /* voxels [lo,hi) along each axis */
+  int stage;             /* which _baneStage* to do */
+  baneInc *inc[3];       /* for passes A and B: private inclusions, merged
+                            into hvp->axis[].inc when threadNum > 1 */
+  double *zsum;          /* for passes A and B: if non-NULL, where the
+                            sums (S, SS) of each baneIncStdv inclusion
+                            are saved (and then reset) after each z
+                            slice, at zsum[0,1 + 2*(axis + 3*z)] */
+  double min[3], max[3]; /* for the histogram: inclusion ranges */
+  int *hist;             /* private raw histogram volume */
+  size_t included;       /* number of voxels that hit the histogram */
+} _baneTask;
+
+static void *
+_baneWorker(void *_task) {
+  char prog[13];
+  _baneTask *task;
+  baneHVolParm *hvp;
+  unsigned int x, y, z, ai, pi, res[3], sy, sz;
+  size_t hidx;
   double val[3];
 
+  task = (_baneTask *)_task;
+  hvp = task->hvp;
+  pi = (_baneStagePassB == task->stage);
+  for (ai=0; ai<3; ai++) {
+    res[ai] = hvp->axis[ai].res;
+  }
+  sy = task->hi[1] - task->lo[1];
+  sz = task->hi[2] - task->lo[2];
+  for (z=task->lo[2]; z<task->hi[2]; z++) {
+    for (y=task->lo[1]; y<task->hi[1]; y++) {
+      if (hvp->verbose && !task->threadIdx
+          && !((y - task->lo[1] + sy*(z - task->lo[2]))%200)) {
+        fprintf(stderr, "%s", airDoneStr(0, y - task->lo[1]
+                                         + sy*(z - task->lo[2]),
+                                         sy*sz, prog));
+        fflush(stderr);
+      }
+      for (x=task->lo[0]; x<task->hi[0]; x++) {
+        baneProbe(val, task->nin, hvp, task->gctx, x, y, z);
+        switch (task->stage) {
+        case _baneStageMeasr:
+          break;
+        case _baneStagePassA:
+        case _baneStagePassB:
+          for (ai=0; ai<3; ai++) {
+            if (task->inc[ai]->process[pi]) {
+              task->inc[ai]->process[pi](task->inc[ai], val[ai]);
+            }
+          }
+          break;
+        case _baneStageHist:
+          if (!( AIR_IN_CL(task->min[0], val[0], task->max[0]) &&
+                 AIR_IN_CL(task->min[1], val[1], task->max[1]) &&
+                 AIR_IN_CL(task->min[2], val[2], task->max[2]) )) {
+            continue;
+          }
+          /* else this voxel will contribute to the histovol */
+          hidx = (airIndex(task->min[0], val[0], task->max[0], res[0])
+                  + res[0]*(airIndex(task->min[1], val[1], task->max[1],
+                                     res[1])
+                            + res[1]*airIndex(task->min[2], val[2],
+                                              task->max[2], res[2])));
+          if (task->hist[hidx] < INT_MAX) {
+            ++task->hist[hidx];
+          }
+          ++task->included;
+          break;
+        }
+      }
+    }
+    if (task->zsum) {
+      for (ai=0; ai<3; ai++) {
+        if (baneIncStdv == task->inc[ai]->type) {
+          task->zsum[0 + 2*(ai + 3*z)] = task->inc[ai]->S;
+          task->zsum[1 + 2*(ai + 3*z)] = task->inc[ai]->SS;
+          task->inc[ai]->S = task->inc[ai]->SS = 0;
+        }
+      }
+    }
+  }
+  return _task;
+}
+
+/*
+** sets up threadNum tasks, each with its own gageContext, all of
+** which are added to the mop
+*/
+static _baneTask *
+_baneTaskSetup(Nrrd *nin, baneHVolParm *hvp, gageContext *ctx,
+               airArray *mop) {
+  static const char me[]="_baneTaskSetup";
+  _baneTask *task;
+  unsigned int ti, ai;
+
+  task = AIR_CALLOC(hvp->threadNum, _baneTask);
+  if (!task) {
+    biffAddf(BANE, "%s: couldn't allocate %u tasks", me, hvp->threadNum);
+    return NULL;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  for (ti=0; ti<hvp->threadNum; ti++) {
+    task[ti].nin = nin;
+    task[ti].hvp = hvp;
+    task[ti].threadIdx = ti;
+    if (!ti) {
+      task[ti].gctx = ctx;
+    } else {
+      if (!( task[ti].gctx = gageContextCopy(ctx) )) {
+        biffMovef(BANE, GAGE, "%s: couldn't copy gage context for thread %u",
+                  me, ti);
+        return NULL;
+      }
+      airMopAdd(mop, task[ti].gctx, (airMopper)gageContextNix, airMopAlways);
+    }
+    for (ai=0; ai<3; ai++) {
+      task[ti].inc[ai] = NULL;
+    }
+    task[ti].zsum = NULL;
+    task[ti].hist = NULL;
+    task[ti].included = 0;
+  }
+  return task;
+}
+
+/*
+** runs the given stage over voxels [lo,hi), split by z slice.  If a
+** thread can't be started, the ones already running finish their
+** slices (there is no early exit), and this returns 1 with a biff
+** message
+*/
+static int
+_baneTaskRun(_baneTask *task, unsigned int threadNum, int stage,
+             const unsigned int lo[3], const unsigned int hi[3]) {
+  static const char me[]="_baneTaskRun";
+  unsigned int ti, failIdx;
+  size_t sz;
+
+  sz = hi[2] - lo[2];
+  for (ti=0; ti<threadNum; ti++) {
+    task[ti].stage = stage;
+    ELL_3V_COPY(task[ti].lo, lo);
+    ELL_3V_COPY(task[ti].hi, hi);
+    task[ti].lo[2] = AIR_UINT(lo[2] + sz*ti/threadNum);
+    task[ti].hi[2] = AIR_UINT(lo[2] + sz*(ti+1)/threadNum);
+  }
+  failIdx = airThreadRun(threadNum, _baneWorker, AIR_VOIDP(task),
+                         sizeof(_baneTask), NULL, NULL);
+  if (failIdx) {
+    biffAddf(BANE, "%s: couldn't start thread %u of %u",
+             me, failIdx, threadNum);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** allocates hvp->measrVol, which is filled (by baneProbe) on the
+** first pass through the volume
+*/
+static int
+_baneMeasrVolAlloc(Nrrd *nin, baneHVolParm *hvp) {
+  static const char me[]="_baneMeasrVolAlloc";
+
+  if (hvp->makeMeasrVol && !hvp->measrVol) {
+    if (nrrdMaybeAlloc_va(hvp->measrVol=nrrdNew(), nrrdTypeFloat, 4,
+                          AIR_CAST(size_t, 3),
+                          nin->axis[0].size,
+                          nin->axis[1].size,
+                          nin->axis[2].size)) {
+      biffMovef(BANE, NRRD, "%s: couldn't allocate 3x%ux%ux%u VGH volume",
+                me, AIR_UINT(nin->axis[0].size), AIR_UINT(nin->axis[1].size),
+                AIR_UINT(nin->axis[2].size));
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+** one pass of inclusion initialization.  With multiple threads, each
+** works on its own copies of the inclusions, which are then merged.
+** The first such pass also fills hvp->measrVol (if we're making it).
+**
+** Merging the histograms and ranges gives the same result however the
+** volume is split, but the floating-point sums of baneIncStdv don't, so
+** those are instead saved per z slice and added up here, in z order
+*/
+static int
+_baneIncPass(_baneTask *task, Nrrd *nin, baneHVolParm *hvp,
+             unsigned int passIdx, airArray *mop) {
+  static const char me[]="_baneIncPass";
+  unsigned int ti, ai, zi, sz, lo[3], hi[3];
+  double *zsum, S0[3], SS0[3];
+  baneInc *inc;
+
+  if (_baneMeasrVolAlloc(nin, hvp)) {
+    biffAddf(BANE, "%s: trouble", me);
+    return 1;
+  }
+
+  for (ti=0; ti<hvp->threadNum; ti++) {
+    for (ai=0; ai<3; ai++) {
+      inc = hvp->axis[ai].inc;
+      if (1 == hvp->threadNum) {
+        task[ti].inc[ai] = inc;
+        continue;
+      }
+      if (!( task[ti].inc[ai] = baneIncCopy(inc) )) {
+        biffAddf(BANE, "%s: couldn't copy inclusion %u for thread %u",
+                 me, ai, ti);
+        return 1;
+      }
+      airMopAdd(mop, task[ti].inc[ai], (airMopper)baneIncNix, airMopAlways);
+      if (inc->nhist && task[ti].inc[ai]->nhist) {
+        /* pass B may need the range learned in pass A */
+        task[ti].inc[ai]->nhist->axis[0].min = inc->nhist->axis[0].min;
+        task[ti].inc[ai]->nhist->axis[0].max = inc->nhist->axis[0].max;
+      }
+    }
+  }
+  sz = AIR_UINT(nin->axis[2].size);
+  zsum = NULL;
+  ELL_3V_SET(S0, 0, 0, 0);
+  ELL_3V_SET(SS0, 0, 0, 0);
+  for (ai=0; ai<3; ai++) {
+    inc = hvp->axis[ai].inc;
+    if (baneIncStdv == inc->type && inc->process[passIdx]) {
+      if (!zsum) {
+        if (!( zsum = AIR_CALLOC(2*3*sz, double) )) {
+          biffAddf(BANE, "%s: couldn't allocate per-slice sums", me);
+          return 1;
+        }
+        airMopAdd(mop, zsum, airFree, airMopAlways);
+      }
+      /* the sums start over, for slice 0 (with one thread, task[0]
+         is using hvp's inclusions) */
+      S0[ai] = inc->S;
+      SS0[ai] = inc->SS;
+      inc->S = inc->SS = 0;
+    }
+  }
+  for (ti=0; ti<hvp->threadNum; ti++) {
+    task[ti].zsum = zsum;
+  }
+  ELL_3V_SET(lo, 0, 0, 0);
+  ELL_3V_SET(hi, nin->axis[0].size, nin->axis[1].size, nin->axis[2].size);
+  if (_baneTaskRun(task, hvp->threadNum,
+                   passIdx ? _baneStagePassB : _baneStagePassA, lo, hi)) {
+    biffAddf(BANE, "%s: trouble", me);
+    return 1;
+  }
+  for (ti=0; ti<hvp->threadNum; ti++) {
+    task[ti].zsum = NULL;
+  }
+  if (hvp->makeMeasrVol) {
+    hvp->measrVolDone = AIR_TRUE;
+  }
+  if (hvp->threadNum > 1) {
+    for (ti=0; ti<hvp->threadNum; ti++) {
+      for (ai=0; ai<3; ai++) {
+        _baneIncMerge(hvp->axis[ai].inc, task[ti].inc[ai], passIdx);
+      }
+    }
+  }
+  if (zsum) {
+    for (ai=0; ai<3; ai++) {
+      inc = hvp->axis[ai].inc;
+      if (baneIncStdv == inc->type && inc->process[passIdx]) {
+        /* (the merge above added nothing to these sums) */
+        inc->S = S0[ai];
+        inc->SS = SS0[ai];
+        for (zi=0; zi<sz; zi++) {
+          inc->S += zsum[0 + 2*(ai + 3*zi)];
+          inc->SS += zsum[1 + 2*(ai + 3*zi)];
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+static int
+_baneFindInclusion(double min[3], double max[3], _baneTask *task,
+                   Nrrd *nin, baneHVolParm *hvp, airArray *mop) {
+  static const char me[]="_baneFindInclusion";
+  char aname[3][AIR_STRLEN_SMALL] = {"grad-mag", "2nd deriv", "data value"};
+  int E, ai;
+  baneInc *inc[3];
+
   /* conveniance copies */
-  sx = nin->axis[0].size;
-  sy = nin->axis[1].size;
-  sz = nin->axis[2].size;
   inc[0] = hvp->axis[0].inc;
   inc[1] = hvp->axis[1].inc;
   inc[2] = hvp->axis[2].inc;
@@ -112,10 +409,6 @@ baneFindInclusion(double min[3], double max[3],
     fprintf(stderr, "%s: measures: %s %s %s\n", me,
             hvp->axis[0].measr->name, hvp->axis[1].measr->name,
             hvp->axis[2].measr->name);
-    /*
-    fprintf(stderr, "%s: gage query:\n", me);
-    ctx->pvl[0]->kind->queryPrint(stderr, ctx->pvl[0]->query);
-    */
   }
 
   /* Determining the inclusion ranges for the histogram volume takes
@@ -134,50 +427,13 @@ baneFindInclusion(double min[3], double max[3],
   if (inc[0]->process[0]
       || inc[1]->process[0]
       || inc[2]->process[0]) {
-    /*
-    fprintf(stderr, "%s: inclusion pass CBs = %p %p %p \n", me,
-            incPass[0], incPass[1], incPass[2]);
-    */
-    if (hvp->makeMeasrVol && !hvp->measrVol) {
-      if (nrrdMaybeAlloc_va(hvp->measrVol=nrrdNew(), nrrdTypeFloat, 4,
-                            AIR_CAST(size_t, 3),
-                            AIR_CAST(size_t, sx),
-                            AIR_CAST(size_t, sy),
-                            AIR_CAST(size_t, sz))) {
-        biffMovef(BANE, NRRD, "%s: couldn't allocate 3x%dx%dx%d VGH volume",
-                  me, sx, sy, sz);
-        return 1;
-      }
-    }
-    for (z=0; z<sz; z++) {
-      for (y=0; y<sy; y++) {
-        if (hvp->verbose && !((y+sy*z)%200)) {
-          fprintf(stderr, "%s", airDoneStr(0, y+sy*z, sy*sz, prog));
-          fflush(stderr);
-        }
-        for (x=0; x<sx; x++) {
-          baneProbe(val, nin, hvp, ctx, x, y, z);
-          if (inc[0]->process[0]) inc[0]->process[0](inc[0], val[0]);
-          if (inc[1]->process[0]) inc[1]->process[0](inc[1], val[1]);
-          if (inc[2]->process[0]) inc[2]->process[0](inc[2], val[2]);
-        }
-      }
-    }
-    if (hvp->makeMeasrVol) {
-      hvp->measrVolDone = AIR_TRUE;
-      /* nrrdSave("VGH.nrrd", hvp->measrVol, NULL); */
+    if (_baneIncPass(task, nin, hvp, 0, mop)) {
+      biffAddf(BANE, "%s: trouble on pass A", me);
+      return 1;
     }
   }
   if (hvp->verbose)
     fprintf(stderr, "\b\b\b\b\b\b  done\n");
-  /* HEY HEY HEY:  The variable "hist" is used before its value is set.
-  if (hvp->verbose > 1) {
-    fprintf(stderr, "%s: after pass A; ranges: [%g,%g] [%g,%g] [%g,%g]\n", me,
-            hist[0]->axis[0].min, hist[0]->axis[0].max,
-            hist[1]->axis[0].min, hist[1]->axis[0].max,
-            hist[2]->axis[0].min, hist[2]->axis[0].max);
-  }
-  */
 
   /* second stage of initialization, includes creating histograms */
   if (hvp->verbose) {
@@ -187,45 +443,13 @@ baneFindInclusion(double min[3], double max[3],
   if (inc[0]->process[1]
       || inc[1]->process[1]
       || inc[2]->process[1]) {
-    if (hvp->makeMeasrVol && !hvp->measrVol) {
-      if (nrrdMaybeAlloc_va(hvp->measrVol=nrrdNew(), nrrdTypeFloat, 4,
-                            AIR_CAST(size_t, 3),
-                            AIR_CAST(size_t, sx),
-                            AIR_CAST(size_t, sy),
-                            AIR_CAST(size_t, sz))) {
-        biffMovef(BANE, NRRD, "%s: couldn't allocate 3x%dx%dx%d VGH volume",
-                  me, sx, sy, sz);
-        return 1;
-      }
-    }
-    for (z=0; z<sz; z++) {
-      for (y=0; y<sy; y++) {
-        if (hvp->verbose && !((y+sy*z)%200)) {
-          fprintf(stderr, "%s", airDoneStr(0, y+sy*z, sy*sz, prog));
-          fflush(stderr);
-        }
-        for (x=0; x<sx; x++) {
-          baneProbe(val, nin, hvp, ctx, x, y, z);
-          if (inc[0]->process[1]) inc[0]->process[1](inc[0], val[0]);
-          if (inc[1]->process[1]) inc[1]->process[1](inc[1], val[1]);
-          if (inc[2]->process[1]) inc[2]->process[1](inc[2], val[2]);
-        }
-      }
-    }
-    if (hvp->makeMeasrVol) {
-      hvp->measrVolDone = AIR_TRUE;
+    if (_baneIncPass(task, nin, hvp, 1, mop)) {
+      biffAddf(BANE, "%s: trouble on pass B", me);
+      return 1;
     }
   }
   if (hvp->verbose)
     fprintf(stderr, "\b\b\b\b\b\b  done\n");
-  /* HEY HEY HEY:  The variable "hist" is used before its value is set.
-  if (hvp->verbose > 1) {
-    fprintf(stderr, "%s: after pass B; ranges: [%g,%g] [%g,%g] [%g,%g]\n", me,
-            hist[0]->axis[0].min, hist[0]->axis[0].max,
-            hist[1]->axis[0].min, hist[1]->axis[0].max,
-            hist[2]->axis[0].min, hist[2]->axis[0].max);
-  }
-  */
 
   /* now the real work of determining the inclusion */
   if (hvp->verbose) {
@@ -253,11 +477,23 @@ baneFindInclusion(double min[3], double max[3],
   if (hvp->verbose)
     fprintf(stderr, "done\n");
 
-  /* HEY HEY HEY:  The variable "hist" is used before its value is set.
-  nrrdNuke(hist[0]);
-  nrrdNuke(hist[1]);
-  nrrdNuke(hist[2]);
-  */
+  return 0;
+}
+
+int
+baneFindInclusion(double min[3], double max[3],
+                  Nrrd *nin, baneHVolParm *hvp, gageContext *ctx) {
+  static const char me[]="baneFindInclusion";
+  _baneTask *task;
+  airArray *mop;
+
+  mop = airMopNew();
+  if (!( task = _baneTaskSetup(nin, hvp, ctx, mop) )
+      || _baneFindInclusion(min, max, task, nin, hvp, mop)) {
+    biffAddf(BANE, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
   return 0;
 }
 
@@ -267,15 +503,17 @@ baneMakeHVol(Nrrd *hvol, Nrrd *nin, baneHVolParm *hvp) {
   char prog[13];
   gageContext *ctx;
   gagePerVolume *pvl;
-  int E, sx, sy, sz, shx, shy, shz, x, y, z, hx, hy, hz,
+  int E, sx, sy, sz, shx, shy, shz, hx, hy, hz,
     *rhvdata, clipVal, hval, pad;
   /* these are doubles because ultimately the inclusion functions
      use doubles, because I wanted the most generality */
-  double val[3], min[3], max[3];
-  size_t hidx, included;
+  double min[3], max[3];
+  unsigned int ti, lo[3], hi[3];
+  size_t hidx, hnum, included;
   float fracIncluded;
   unsigned char *nhvdata;
   Nrrd *rawhvol;
+  _baneTask *task;
   airArray *mop;
 
   if (!(hvol && nin && hvp)) {
@@ -322,8 +560,12 @@ baneMakeHVol(Nrrd *hvol, Nrrd *nin, baneHVolParm *hvp) {
     airMopError(mop); return 1;
   }
   pad = ctx->radius;
+  if (!( task = _baneTaskSetup(nin, hvp, ctx, mop) )) {
+    biffAddf(BANE, "%s: trouble setting up threads", me);
+    airMopError(mop); return 1;
+  }
 
-  if (baneFindInclusion(min, max, nin, hvp, ctx)) {
+  if (_baneFindInclusion(min, max, task, nin, hvp, mop)) {
     biffAddf(BANE, "%s: trouble finding inclusion ranges", me);
     airMopError(mop); return 1;
   }
@@ -368,32 +610,57 @@ baneMakeHVol(Nrrd *hvol, Nrrd *nin, baneHVolParm *hvp) {
   }
   airMopAdd(mop, rawhvol, (airMopper)nrrdNuke, airMopAlways);
   rhvdata = (int *)rawhvol->data;
-  included = 0;
-
-  for (z=pad; z<sz-pad; z++) {
-    for (y=pad; y<sy-pad; y++) {
-      if (hvp->verbose && !((y-pad+(sy-2*pad)*(z-pad))%200)) {
-        fprintf(stderr, "%s", airDoneStr(0, y-pad+(sy-2*pad)*(z-pad),
-                                         (sy-2*pad)*(sz-2*pad), prog));
-        fflush(stderr);
+  hnum = nrrdElementNumber(rawhvol);
+  /* with multiple threads, each fills its own histogram */
+  for (ti=0; ti<hvp->threadNum; ti++) {
+    ELL_3V_COPY(task[ti].min, min);
+    ELL_3V_COPY(task[ti].max, max);
+    task[ti].included = 0;
+    if (1 == hvp->threadNum) {
+      task[ti].hist = rhvdata;
+    } else {
+      if (!( task[ti].hist = AIR_CALLOC(hnum, int) )) {
+        biffAddf(BANE, "%s: couldn't allocate histogram for thread %u",
+                 me, ti);
+        airMopError(mop); return 1;
       }
-      for (x=pad; x<sx-pad; x++) {
-        baneProbe(val, nin, hvp, ctx, x, y, z);
-        if (!( AIR_IN_CL(min[0], val[0], max[0]) &&
-               AIR_IN_CL(min[1], val[1], max[1]) &&
-               AIR_IN_CL(min[2], val[2], max[2]) )) {
-          continue;
-        }
-        /* else this voxel will contribute to the histovol */
-        hx = airIndex(min[0], val[0], max[0], shx);
-        hy = airIndex(min[1], val[1], max[1], shy);
-        hz = airIndex(min[2], val[2], max[2], shz);
-        hidx = hx + shx*(hy + shy*hz);
-        if (rhvdata[hidx] < INT_MAX) {
-          ++rhvdata[hidx];
-        }
-        ++included;
+      airMopAdd(mop, task[ti].hist, airFree, airMopAlways);
+    }
+  }
+  if (_baneMeasrVolAlloc(nin, hvp)) {
+    biffAddf(BANE, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  if (hvp->makeMeasrVol && !hvp->measrVolDone) {
+    /* no inclusion pass measured the volume; the histogram only covers
+       voxels away from the boundary, but all of measrVol has to be
+       valid (e.g. to be saved and re-used) */
+    ELL_3V_SET(lo, 0, 0, 0);
+    ELL_3V_SET(hi, sx, sy, sz);
+    if (_baneTaskRun(task, hvp->threadNum, _baneStageMeasr, lo, hi)) {
+      biffAddf(BANE, "%s: trouble measuring", me);
+      airMopError(mop); return 1;
+    }
+    hvp->measrVolDone = AIR_TRUE;
+  }
+  ELL_3V_SET(lo, pad, pad, pad);
+  ELL_3V_SET(hi, sx-pad, sy-pad, sz-pad);
+  if (_baneTaskRun(task, hvp->threadNum, _baneStageHist, lo, hi)) {
+    biffAddf(BANE, "%s: trouble histogramming", me);
+    airMopError(mop); return 1;
+  }
+  included = 0;
+  for (ti=0; ti<hvp->threadNum; ti++) {
+    included += task[ti].included;
+  }
+  if (hvp->threadNum > 1) {
+    for (hidx=0; hidx<hnum; hidx++) {
+      size_t sum;
+      sum = 0;
+      for (ti=0; ti<hvp->threadNum; ti++) {
+        sum += task[ti].hist[hidx];
       }
+      rhvdata[hidx] = AIR_INT(AIR_MIN(sum, INT_MAX));
     }
   }
   fracIncluded = (float)included/((sz-2*pad)*(sy-2*pad)*(sx-2*pad));
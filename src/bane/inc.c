@@ -376,6 +376,38 @@ baneIncAnswer(baneInc *inc, double *minP, double *maxP) {
   return 0;
 }
 
+/*
+** _baneIncMerge: adds what was learned by "part" on the given pass
+** into "inc"; part has to be a copy of inc (via baneIncCopy), and
+** for pass 1, the range of its nhist has to be set from inc's
+*/
+void
+_baneIncMerge(baneInc *inc, baneInc *part, int passIdx) {
+  void (*process)(baneInc *, double);
+  int *hist, *phist;
+  size_t ii, nn;
+
+  process = inc->process[passIdx];
+  if (_baneIncProcess_LearnMinMax == process) {
+    if (AIR_EXISTS(part->nhist->axis[0].min)) {
+      _baneIncProcess_LearnMinMax(inc, part->nhist->axis[0].min);
+      _baneIncProcess_LearnMinMax(inc, part->nhist->axis[0].max);
+    }
+  } else if (_baneIncProcess_HistFill == process) {
+    hist = (int*)inc->nhist->data;
+    phist = (int*)part->nhist->data;
+    nn = nrrdElementNumber(inc->nhist);
+    for (ii=0; ii<nn; ii++) {
+      hist[ii] += phist[ii];
+    }
+  } else if (_baneIncProcess_Stdv == process) {
+    inc->S += part->S;
+    inc->SS += part->SS;
+    inc->num += part->num;
+  }
+  return;
+}
+
 baneInc *
 baneIncCopy(baneInc *inc) {
   static const char me[]="baneIncCopy";
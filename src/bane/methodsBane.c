@@ -52,6 +52,7 @@ baneHVolParmNew() {
   if (hvp) {
     hvp->verbose = baneDefVerbose;
     hvp->makeMeasrVol = baneDefMakeMeasrVol;
+    hvp->threadNum = baneDefThreadNum;
     hvp->measrVol = NULL;
     hvp->measrVolDone = AIR_FALSE;
     _baneAxisInit(hvp->axis + 0);
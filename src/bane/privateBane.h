@@ -31,6 +31,9 @@ extern "C" {
 /* hvol.c */
 extern int _baneAxisCheck(baneAxis *axis);
 
+/* inc.c */
+extern void _baneIncMerge(baneInc *inc, baneInc *part, int passIdx);
+
 #define BANE_GKMS_CMD(name, info) \
 unrrduCmd baneGkms_##name##Cmd = { #name, info, \
                                    baneGkms_##name##Main, AIR_FALSE }
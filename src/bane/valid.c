@@ -59,6 +59,28 @@ baneInputCheck (Nrrd *nin, baneHVolParm *hvp) {
     biffAddf(BANE, "%s: got NULL baneClip", me);
     return 1;
   }
+  if (!( hvp->threadNum >= 1 )) {
+    biffAddf(BANE, "%s: threadNum %u not >= 1", me, hvp->threadNum);
+    return 1;
+  }
+  if (hvp->measrVolDone) {
+    if (!( hvp->measrVol
+           && nrrdTypeFloat == hvp->measrVol->type
+           && 4 == hvp->measrVol->dim
+           && 3 == hvp->measrVol->axis[0].size
+           && nin->axis[0].size == hvp->measrVol->axis[1].size
+           && nin->axis[1].size == hvp->measrVol->axis[2].size
+           && nin->axis[2].size == hvp->measrVol->axis[3].size )) {
+      biffAddf(BANE, "%s: measrVol isn't a 3 x %u x %u x %u float array", me,
+               AIR_UINT(nin->axis[0].size), AIR_UINT(nin->axis[1].size),
+               AIR_UINT(nin->axis[2].size));
+      return 1;
+    }
+    if (!hvp->makeMeasrVol) {
+      biffAddf(BANE, "%s: have measrVol but makeMeasrVol is false", me);
+      return 1;
+    }
+  }
 
   /* all okay */
   return 0;
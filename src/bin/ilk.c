@@ -108,6 +108,9 @@ main(int argc, const char *argv[]) {
   hestOptAdd(&hopt, "a", "avg #", airTypeUInt, 1, 1, &avgNum, "0",
              "number of averages (if there there is only one "
              "rotation)");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeInt, 1, 1,
+             &mossDefThreadNum, "1",
+             "number of threads to split the output rows among");
   hestOptAdd(&hopt, "o", "filename", airTypeString, 1, 1, &outS, "-",
              "file to write output nrrd to");
   hestParseOrDie(hopt, argc-1, argv+1, hparm,
@@ -28,6 +28,7 @@
 #include <teem/limn.h>
 #include <teem/hoover.h>
 #include <teem/mite.h>
+#include <teem/meet.h>
 
 static const char *miteInfo =
   ("A simple but effective little volume renderer.");
@@ -48,6 +49,8 @@ main(int argc, const char *argv[]) {
   Nrrd *nin;
 
   me = argv[0];
+  /* TEEM_PROFILE: report hot-path counters and timers at exit */
+  meetProfileGetenv();
   mop = airMopNew();
   hparm = hestParmNew();
   airMopAdd(mop, hparm, (airMopper)hestParmFree, airMopAlways);
@@ -279,6 +282,13 @@ main(int argc, const char *argv[]) {
   fprintf(stderr, "\n");
   fprintf(stderr, "%s: rendering time = %g secs\n", me, muu->rendTime);
   fprintf(stderr, "%s: sampling rate = %g Khz\n", me, muu->sampRate);
+  {
+    char stmp[3][AIR_STRLEN_SMALL];
+    fprintf(stderr, "%s: iv3 cache: %s hits, %s shifts, %s fills\n", me,
+            airSprintSize_t(stmp[0], muu->iv3HitNum),
+            airSprintSize_t(stmp[1], muu->iv3ShiftNum),
+            airSprintSize_t(stmp[2], muu->iv3FillNum));
+  }
   if (muu->ndebug) {
     /* if its been generated, we should save it */
     sprintf(debugStr, "%04d-%04d-debug.nrrd", verbPix[0], verbPix[1]);
@@ -759,6 +759,8 @@ main(int argc, const char **argv) {
     backStepScale, opporStepScale, energyDecreaseMin, energyDecreasePopCntlMin,
     neighborTrueProb, probeProb, fracNeighNixedMax;
 
+  /* TEEM_PROFILE: report hot-path counters and timers at exit */
+  meetProfileGetenv();
   mop = airMopNew();
   hparm = hestParmNew();
   airMopAdd(mop, hparm, (airMopper)hestParmFree, airMopAlways);
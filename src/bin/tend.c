@@ -22,6 +22,7 @@
 */
 
 #include <teem/ten.h>
+#include <teem/meet.h>
 
 #define TEND "tend"
 
@@ -39,6 +40,8 @@ main(int argc, const char **argv) {
      or nrrdState* variables in a way that nrrdSanity() should see */
   nrrdDefaultGetenv();
   nrrdStateGetenv();
+  /* TEEM_PROFILE: report hot-path counters and timers at exit */
+  meetProfileGetenv();
 
   /* no harm done in making sure we're sane */
   nrrdSanityOrDie(me);
@@ -22,6 +22,7 @@
 */
 
 #include <teem/unrrdu.h>
+#include <teem/meet.h>
 
 /* learning columns
 #include <sys/types.h>
@@ -44,6 +45,8 @@ main(int argc, const char **argv) {
      or nrrdState* variables in a way that nrrdSanity() should see */
   nrrdDefaultGetenv();
   nrrdStateGetenv();
+  /* TEEM_PROFILE: report hot-path counters and timers at exit */
+  meetProfileGetenv();
 
   /* if user hasn't tried to set nrrdStateKindNoop by an environment
      variable, we set it to false, since its probably what people expect */
@@ -150,6 +150,23 @@ typedef struct {
   void (*update)(coil_t *val, coil_t *delta); /* how to apply update */
 } coilKind;
 
+/*
+******** coilStat struct
+**
+** convergence statistics for one iteration, as accumulated by
+** coilIterate() into coilContext->stat
+*/
+typedef struct {
+  unsigned int iter;               /* which iteration (counting from the
+                                      last coilStart) these are for */
+  size_t activeNum;                /* number of voxels that were filtered and
+                                      updated; this is all of them unless
+                                      in active-set mode (activeTol > 0) */
+  double deltaMax,                 /* over all updated voxels, the maximum of
+                                      the largest absolute update component */
+    deltaMean;                     /* mean of same over updated voxels */
+} coilStat;
+
 struct coilContext_t;
 
 /*
@@ -169,6 +186,13 @@ typedef struct {
                                    /* how to fill iv3 */
   void (*iv3Fill)(coil_t **iv3, coil_t *here, unsigned int radius, int valLen,
                   int x0, int y0, int z0, int sizeX, int sizeY, int sizeZ);
+  coil_t *slab;                    /* in temporally blocked mode with more
+                                      than one slab: private copy of one slab
+                                      and its halo, in the same layout as
+                                      cctx->nvol */
+  coilStat *stat;                  /* per-iteration statistics accumulated by
+                                      this thread in the current block (array
+                                      of length max(1, cctx->blockIter)) */
   void *returnPtr;                 /* for airThreadJoin */
 } coilTask;
 
@@ -190,30 +214,66 @@ typedef struct coilContext_t {
   double parm[COIL_PARMS_NUM];     /* all the parameters used to control the
                                       action of the filtering.  The timestep is
                                       probably the first value. */
+  unsigned int blockIter,          /* if > 1: temporal blocking; up to this
+                                      many iterations are advanced within a
+                                      wavefront moving through each z-slab,
+                                      before moving on to the next slab */
+    blockSlab;                     /* number of slices per slab in temporally
+                                      blocked mode, or 0 to use
+                                      ceil(size[2]/numThreads).  With more than
+                                      one slab, each thread works on a private
+                                      copy of its slab plus a halo of
+                                      blockIter*radius slices on either side */
+  double activeTol;                /* if > 0: active-set mode; voxels for which
+                                      no update in their neighborhood exceeded
+                                      this (in largest absolute component) in
+                                      the previous iteration are skipped.
+                                      Can't be combined with blockIter > 1 */
   /* ---------- internal */
-  unsigned int iter;               /* what iteration we're on */
+  unsigned int iter,               /* what iteration we're on */
+    iterNum;                       /* how many iterations are being done in
+                                      current block (1 unless blockIter > 1) */
   size_t size[3],                  /* size of volume */
-    nextSlice;                     /* global indicator of next slice needing
-                                      to be processed, either in filter or
-                                      in update stage.  Stage is done when
-                                      nextSlice == size[2] */
+    nextSlice,                     /* global indicator of next slice (or slab,
+                                      in blocked mode) needing to be filtered.
+                                      Stage is done when it reaches size[2]
+                                      (or slabNum) */
+    nextUpdateSlice,               /* next slice needing to be updated */
+    slabNum, slabSize;             /* in blocked mode: number of slabs, and
+                                      number of slices in each (but the last) */
   double spacing[3];               /* sample spacings we'll use- we perhaps
                                       should be using a gageShape, but this is
                                       actually all we really need . . . */
   Nrrd *nvol;                      /* an interleaved volume of (1st) the last
                                       filtering result, and (2nd) the update
                                       values from the current iteration */
-  int finished,                    /* used to signal all threads to return */
-    todoFilter, todoUpdate;        /* flags to signal which is scheduled to
-                                      come next, used as part of doling out
-                                      slices to workers */
-  airThreadMutex *nextSliceMutex;  /* mutex around nextSlice (and effectively,
-                                      also the "todo" flags above) */
+  Nrrd *nact;                      /* in active-set mode, 2 x size[0] x size[1]
+                                      x size[2] array of uchar flags: whether
+                                      each voxel changed by more than activeTol
+                                      in its last update, and whether it is
+                                      active in the current iteration */
+  int finished;                    /* used to signal all threads to return */
+  airThreadMutex *nextSliceMutex;  /* mutex around nextSlice and
+                                      nextUpdateSlice */
   coilTask **task;                 /* dynamically allocated array of tasks */
   airThreadBarrier *filterBarrier, /* so that thread 0 can see if filtering
                                       should go onward, and set "finished" */
-    *updateBarrier;                /* after the update values have been
+    *updateBarrier,                /* after the update values have been
                                       applied to current values */
+    *iterBarrier;                  /* after all threads finished iteration,
+                                      so that thread 0 can tally statistics */
+  /* ---------- output */
+  coilStat *stat;                  /* statistics for every iteration since
+                                      the last coilStart(), managed by statArr;
+                                      number of iterations is statArr->len */
+  airArray *statArr;
+  Nrrd *nnext;                     /* in temporally blocked mode with more
+                                      than one slab, size[0] x size[1] x
+                                      size[2] (tuples of valLen) volume of the
+                                      new values: written by the first stage,
+                                      and copied into nvol by the second, so
+                                      that nvol is only read while threads
+                                      copy their slabs and halos from it */
 } coilContext;
 
 /* defaultsCoil.c */
@@ -247,6 +307,9 @@ COIL_EXPORT int coilContextAllSet(coilContext *cctx, const Nrrd *nin,
                                   const coilMethod *method,
                                   unsigned int radius, unsigned int numThreads,
                                   int verbose, double parm[COIL_PARMS_NUM]);
+COIL_EXPORT int coilContextBlockSet(coilContext *cctx, unsigned int blockIter,
+                                    unsigned int blockSlab);
+COIL_EXPORT int coilContextActiveSet(coilContext *cctx, double activeTol);
 COIL_EXPORT int coilOutputGet(Nrrd *nout, coilContext *cctx);
 COIL_EXPORT coilContext *coilContextNix(coilContext *cctx);
 
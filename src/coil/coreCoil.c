@@ -110,34 +110,25 @@ _coilIv3Fill_1_7(coil_t **iv3, coil_t *here, unsigned int radius, int valLen,
   return;
 }
 
-int
-_coilThisZGet(coilTask *task, int doFilter) {
-  int thisZ, *thisFlag, *thatFlag;
-
-  if (doFilter) {
-    thisFlag = &(task->cctx->todoFilter);
-    thatFlag = &(task->cctx->todoUpdate);
-  } else {
-    thisFlag = &(task->cctx->todoUpdate);
-    thatFlag = &(task->cctx->todoFilter);
-  }
+/*
+** hands out the next unit of work (a slice, or in blocked mode a slab,
+** when doFilter; a slice to update otherwise), or num when there is
+** no more work in this stage.  The counters are reset by thread 0
+** before each iteration (or block)
+*/
+size_t
+_coilThisZGet(coilTask *task, int doFilter, size_t num) {
+  size_t thisZ, *next;
 
+  next = (doFilter
+          ? &(task->cctx->nextSlice)
+          : &(task->cctx->nextUpdateSlice));
   if (task->cctx->numThreads > 1) {
     airThreadMutexLock(task->cctx->nextSliceMutex);
   }
-  if (task->cctx->nextSlice == task->cctx->size[2]
-      && *thisFlag) {
-    /* we're the first thread to start this phase */
-    task->cctx->nextSlice = 0;
-    *thisFlag = AIR_FALSE;
-  }
-  thisZ = task->cctx->nextSlice;
-  if (task->cctx->nextSlice < task->cctx->size[2]) {
-    task->cctx->nextSlice++;
-    if (task->cctx->nextSlice == task->cctx->size[2]) {
-      /* we just grabbed the last slice of this phase */
-      *thatFlag = AIR_TRUE;
-    }
+  thisZ = *next;
+  if (*next < num) {
+    (*next)++;
   }
   if (task->cctx->numThreads > 1) {
     airThreadMutexUnlock(task->cctx->nextSliceMutex);
@@ -145,68 +136,336 @@ _coilThisZGet(coilTask *task, int doFilter) {
   return thisZ;
 }
 
-void
-_coilProcess(coilTask *task, int doFilter) {
-  static const char me[]="_coilProcess";
-  int xi, yi, sizeX, sizeY, thisZ, sizeZ, valLen, radius;
+/*
+** in active-set mode: whether any voxel in the neighborhood of
+** (xi,yi,zi) changed by more than activeTol in its last update
+*/
+static int
+_coilNeighborChanged(const unsigned char *act, int radius, int xi, int yi,
+                     int zi, int sizeX, int sizeY, int sizeZ) {
+  int xx, yy, zz, xlo, xhi, ylo, yhi, zlo, zhi;
+
+  xlo = AIR_MAX(0, xi - radius); xhi = AIR_MIN(sizeX-1, xi + radius);
+  ylo = AIR_MAX(0, yi - radius); yhi = AIR_MIN(sizeY-1, yi + radius);
+  zlo = AIR_MAX(0, zi - radius); zhi = AIR_MIN(sizeZ-1, zi + radius);
+  for (zz=zlo; zz<=zhi; zz++) {
+    for (yy=ylo; yy<=yhi; yy++) {
+      for (xx=xlo; xx<=xhi; xx++) {
+        if (act[0 + 2*(xx + sizeX*(yy + sizeY*zz))]) {
+          return AIR_TRUE;
+        }
+      }
+    }
+  }
+  return AIR_FALSE;
+}
+
+/*
+** computes update values for slice zi of vol, which has the layout
+** of cctx->nvol but sizeZ slices, the first of which is slice zOff
+** of the whole volume
+*/
+static void
+_coilSliceFilter(coilTask *task, coil_t *vol, int zi, int sizeZ, int zOff) {
+  coilContext *cctx;
+  int xi, yi, sizeX, sizeY, valLen, radius;
   coil_t *here;
+  unsigned char *act;
   void (*filter)(coil_t *delta, int xi, int yi, int zi,
                  coil_t **iv3, double spacing[3],
                  double parm[COIL_PARMS_NUM]);
 
-  sizeX = task->cctx->size[0];
-  sizeY = task->cctx->size[1];
+  cctx = task->cctx;
+  sizeX = AIR_INT(cctx->size[0]);
+  sizeY = AIR_INT(cctx->size[1]);
+  valLen = cctx->kind->valLen;
+  radius = cctx->radius;
+  filter = cctx->kind->filter[cctx->method->type];
+  here = vol + 2*valLen*sizeX*sizeY*zi;
+  /* active-set mode is only used without blocking, so vol is nvol */
+  act = (cctx->activeTol > 0
+         ? (unsigned char *)(cctx->nact->data)
+         : NULL);
+  for (yi=0; yi<sizeY; yi++) {
+    for (xi=0; xi<sizeX; xi++) {
+      if (act) {
+        act[1 + 2*(xi + sizeX*(yi + sizeY*zi))] =
+          _coilNeighborChanged(act, radius, xi, yi, zi, sizeX, sizeY, sizeZ);
+        if (!act[1 + 2*(xi + sizeX*(yi + sizeY*zi))]) {
+          here += 2*valLen;
+          continue;
+        }
+      }
+      task->iv3Fill(task->iv3, here + 0*valLen, radius, valLen,
+                    xi, yi, zi, sizeX, sizeY, sizeZ);
+      filter(here + 1*valLen, xi, yi, zi + zOff, task->iv3,
+             cctx->spacing, cctx->parm);
+      here += 2*valLen;
+    }
+  }
+  return;
+}
+
+/*
+** applies update values to slice zi of vol; if stat is non-NULL,
+** the updates are also tallied there
+*/
+static void
+_coilSliceUpdate(coilTask *task, coil_t *vol, int zi, coilStat *stat) {
+  coilContext *cctx;
+  size_t ii, sliceLen;
+  unsigned int vi, valLen;
+  coil_t *here;
+  unsigned char *act;
+  double dd, dmax;
+
+  cctx = task->cctx;
+  valLen = cctx->kind->valLen;
+  sliceLen = cctx->size[0]*cctx->size[1];
+  here = vol + 2*valLen*sliceLen*zi;
+  act = (cctx->activeTol > 0
+         ? (unsigned char *)(cctx->nact->data) + 2*sliceLen*zi
+         : NULL);
+  for (ii=0; ii<sliceLen; ii++) {
+    if (act && !act[1]) {
+      act[0] = AIR_FALSE;
+      act += 2;
+      here += 2*valLen;
+      continue;
+    }
+    dmax = 0;
+    for (vi=0; vi<valLen; vi++) {
+      dd = AIR_ABS(here[vi + 1*valLen]);
+      dmax = AIR_MAX(dmax, dd);
+    }
+    cctx->kind->update(here + 0*valLen, here + 1*valLen);
+    if (act) {
+      act[0] = dmax > cctx->activeTol;
+      act += 2;
+    }
+    if (stat) {
+      stat->activeNum++;
+      stat->deltaMax = AIR_MAX(stat->deltaMax, dmax);
+      stat->deltaMean += dmax;   /* divided by activeNum in tally */
+    }
+    here += 2*valLen;
+  }
+  return;
+}
+
+void
+_coilProcess(coilTask *task, int doFilter) {
+  static const char me[]="_coilProcess";
+  size_t thisZ, sizeZ;
+  coil_t *vol;
+
   sizeZ = task->cctx->size[2];
-  valLen = task->cctx->kind->valLen;
-  radius = task->cctx->radius;
-  filter = task->cctx->kind->filter[task->cctx->method->type];
+  vol = (coil_t*)(task->cctx->nvol->data);
   if (doFilter) {
     while (1) {
-      thisZ = _coilThisZGet(task, doFilter);
+      thisZ = _coilThisZGet(task, doFilter, sizeZ);
       if (thisZ == sizeZ) {
         break;
       }
       if (task->cctx->verbose > 2) {
         fprintf(stderr, "%s(%u),f: iter=%u, z=%d\n",
-                me, task->threadIdx, task->cctx->iter, thisZ);
-      }
-      here = (coil_t*)(task->cctx->nvol->data) + 2*valLen*sizeX*sizeY*thisZ;
-      for (yi=0; yi<sizeY; yi++) {
-        for (xi=0; xi<sizeX; xi++) {
-          task->iv3Fill(task->iv3, here + 0*valLen, radius, valLen,
-                        xi, yi, thisZ, sizeX, sizeY, sizeZ);
-          filter(here + 1*valLen, xi, yi, thisZ, task->iv3,
-                 task->cctx->spacing, task->cctx->parm);
-          here += 2*valLen;
-        }
+                me, task->threadIdx, task->cctx->iter, AIR_INT(thisZ));
       }
+      _coilSliceFilter(task, vol, AIR_INT(thisZ), AIR_INT(sizeZ), 0);
     }
   } else {
     while (1) {
-      thisZ = _coilThisZGet(task, doFilter);
+      thisZ = _coilThisZGet(task, doFilter, sizeZ);
       if (thisZ == sizeZ) {
         break;
       }
       if (task->cctx->verbose > 3) {
         fprintf(stderr, "%s(%u),u: iter=%u, z=%d\n",
-                me, task->threadIdx, task->cctx->iter, thisZ);
+                me, task->threadIdx, task->cctx->iter, AIR_INT(thisZ));
       }
-      here = (coil_t*)(task->cctx->nvol->data) + 2*valLen*sizeX*sizeY*thisZ;
-      for (yi=0; yi<sizeY; yi++) {
-        for (xi=0; xi<sizeX; xi++) {
-          task->cctx->kind->update(here + 0*valLen, here + 1*valLen);
-          here += 2*valLen;
+      _coilSliceUpdate(task, vol, AIR_INT(thisZ), task->stat + 0);
+    }
+  }
+  return;
+}
+
+/*
+** advances cctx->iterNum iterations on vol (sizeZ slices, starting at
+** slice zOff), in a single wavefront.  At step ww, iteration (level) li
+** filters slice ww - 2*radius*li, and then updates the slice radius
+** behind that, which no later filtering at this level will need to
+** see.  Thus the next level can filter the slice radius behind that.
+** Updates are only tallied for slices in [keepLo, keepHi).
+*/
+static void
+_coilWavefront(coilTask *task, coil_t *vol, int sizeZ, int zOff,
+               int keepLo, int keepHi) {
+  int ww, wwNum, fz, uz, radius, levNum, li;
+
+  radius = task->cctx->radius;
+  levNum = task->cctx->iterNum;
+  wwNum = sizeZ + (2*levNum - 1)*radius;
+  for (ww=0; ww<wwNum; ww++) {
+    for (li=0; li<levNum; li++) {
+      fz = ww - 2*radius*li;
+      if (AIR_IN_CL(0, fz, sizeZ-1)) {
+        _coilSliceFilter(task, vol, fz, sizeZ, zOff);
+      }
+      uz = fz - radius;
+      if (AIR_IN_CL(0, uz, sizeZ-1)) {
+        _coilSliceUpdate(task, vol, uz,
+                         (AIR_IN_OP(keepLo-1, uz, keepHi)
+                          ? task->stat + li
+                          : NULL));
+      }
+    }
+  }
+  return;
+}
+
+/*
+** the first stage of temporally blocked processing: running the
+** wavefront over each slab.  With just one slab, this is done in
+** place.  Otherwise the slab (with its halo) is copied into task->slab,
+** and the (valid) results are put into cctx->nnext, from which they're
+** copied back by _coilSlabCopy, once no one needs the current values for
+** their halos.  Nothing writes to nvol in this stage, so the copying of
+** overlapping halos by different threads is race-free.
+*/
+static void
+_coilSlabProcess(coilTask *task) {
+  static const char me[]="_coilSlabProcess";
+  coilContext *cctx;
+  size_t si, zi, z0, z1, b0, b1, halo, sliceLen, ii;
+  unsigned int vi, valLen;
+  coil_t *vol, *src, *dst;
+
+  cctx = task->cctx;
+  vol = (coil_t*)(cctx->nvol->data);
+  if (1 == cctx->slabNum) {
+    if (0 == _coilThisZGet(task, AIR_TRUE, 1)) {
+      _coilWavefront(task, vol, AIR_INT(cctx->size[2]), 0,
+                     0, AIR_INT(cctx->size[2]));
+    }
+    return;
+  }
+  valLen = cctx->kind->valLen;
+  sliceLen = cctx->size[0]*cctx->size[1];
+  halo = cctx->iterNum*cctx->radius;
+  while (1) {
+    si = _coilThisZGet(task, AIR_TRUE, cctx->slabNum);
+    if (si == cctx->slabNum) {
+      break;
+    }
+    z0 = si*cctx->slabSize;
+    z1 = AIR_MIN(z0 + cctx->slabSize, cctx->size[2]);
+    b0 = z0 > halo ? z0 - halo : 0;
+    b1 = AIR_MIN(z1 + halo, cctx->size[2]);
+    if (cctx->verbose > 2) {
+      fprintf(stderr, "%s(%u): iter=%u, slab %d: z=[%d,%d)\n",
+              me, task->threadIdx, cctx->iter, AIR_INT(si),
+              AIR_INT(z0), AIR_INT(z1));
+    }
+    memcpy(task->slab, vol + 2*valLen*sliceLen*b0,
+           2*valLen*sliceLen*(b1 - b0)*sizeof(coil_t));
+    _coilWavefront(task, task->slab, AIR_INT(b1 - b0), AIR_INT(b0),
+                   AIR_INT(z0 - b0), AIR_INT(z1 - b0));
+    for (zi=z0; zi<z1; zi++) {
+      src = task->slab + 2*valLen*sliceLen*(zi - b0);
+      dst = (coil_t*)(cctx->nnext->data) + valLen*sliceLen*zi;
+      for (ii=0; ii<sliceLen; ii++) {
+        for (vi=0; vi<valLen; vi++) {
+          dst[vi] = src[vi + 0*valLen];
         }
+        src += 2*valLen;
+        dst += valLen;
+      }
+    }
+  }
+  return;
+}
+
+/*
+** the second stage of temporally blocked processing (with more than
+** one slab): the new values are copied from cctx->nnext
+*/
+static void
+_coilSlabCopy(coilTask *task) {
+  coilContext *cctx;
+  size_t zi, ii, sliceLen;
+  unsigned int vi, valLen;
+  coil_t *here, *next;
+
+  cctx = task->cctx;
+  valLen = cctx->kind->valLen;
+  sliceLen = cctx->size[0]*cctx->size[1];
+  while (1) {
+    zi = _coilThisZGet(task, AIR_FALSE, cctx->size[2]);
+    if (zi == cctx->size[2]) {
+      break;
+    }
+    here = (coil_t*)(cctx->nvol->data) + 2*valLen*sliceLen*zi;
+    next = (coil_t*)(cctx->nnext->data) + valLen*sliceLen*zi;
+    for (ii=0; ii<sliceLen; ii++) {
+      for (vi=0; vi<valLen; vi++) {
+        here[vi + 0*valLen] = next[vi];
       }
+      here += 2*valLen;
+      next += valLen;
     }
   }
   return;
 }
 
+/*
+** the work of one iteration (or one block of iterations), as done
+** by every thread, including thread 0
+*/
+static void
+_coilRun(coilTask *task) {
+  static const char me[]="_coilRun";
+  coilContext *cctx;
+
+  cctx = task->cctx;
+  if (cctx->blockIter > 1) {
+    if (cctx->verbose > 1) {
+      fprintf(stderr, "%s(%u): %u blocked iterations ... \n",
+              me, task->threadIdx, cctx->iterNum);
+    }
+    _coilSlabProcess(task);
+    if (cctx->slabNum > 1) {
+      if (cctx->numThreads > 1) {
+        airThreadBarrierWait(cctx->updateBarrier);
+      }
+      _coilSlabCopy(task);
+    }
+  } else {
+    /* first: filter */
+    if (cctx->verbose > 1) {
+      fprintf(stderr, "%s(%u): filtering ... \n", me, task->threadIdx);
+    }
+    _coilProcess(task, AIR_TRUE);
+
+    /* second: update */
+    if (cctx->numThreads > 1) {
+      airThreadBarrierWait(cctx->updateBarrier);
+    }
+    if (cctx->verbose > 1) {
+      fprintf(stderr, "%s(%u): updating ... \n", me, task->threadIdx);
+    }
+    _coilProcess(task, AIR_FALSE);
+  }
+  if (cctx->numThreads > 1) {
+    airThreadBarrierWait(cctx->iterBarrier);
+  }
+  return;
+}
+
 coilTask *
 _coilTaskNew(coilContext *cctx, int threadIdx) {
   coilTask *task;
   int len, diam, xi;
+  size_t slabLen;
 
   len = cctx->kind->valLen;
   diam = 1 + 2*cctx->radius;
@@ -227,7 +486,27 @@ _coilTaskNew(coilContext *cctx, int threadIdx) {
     } else {
       task->iv3Fill = _coilIv3Fill_R_L;
     }
+    if (cctx->blockIter > 1 && cctx->slabNum > 1) {
+      slabLen = AIR_MIN(cctx->size[2],
+                        cctx->slabSize + 2*cctx->blockIter*cctx->radius);
+      task->slab = (coil_t*)calloc(2*len*cctx->size[0]*cctx->size[1]*slabLen,
+                                   sizeof(coil_t));
+    } else {
+      task->slab = NULL;
+    }
+    task->stat = (coilStat*)calloc(AIR_MAX(1, cctx->blockIter),
+                                   sizeof(coilStat));
     task->returnPtr = NULL;
+    if (!( task->stat
+           && (task->slab || !(cctx->blockIter > 1 && cctx->slabNum > 1)) )) {
+      airFree(task->stat);
+      airFree(task->slab);
+      task->thread = airThreadNix(task->thread);
+      airFree(task->_iv3);
+      airFree(task->iv3);
+      airFree(task);
+      task = NULL;
+    }
   }
   return task;
 }
@@ -239,6 +518,8 @@ _coilTaskNix(coilTask *task) {
     task->thread = airThreadNix(task->thread);
     task->_iv3 = (coil_t *)airFree(task->_iv3);
     task->iv3 = (coil_t **)airFree(task->iv3);
+    task->slab = (coil_t *)airFree(task->slab);
+    task->stat = (coilStat *)airFree(task->stat);
     free(task);
   }
   return NULL;
@@ -267,24 +548,7 @@ _coilWorker(void *_task) {
       break;
     }
     /* else there's work to do ... */
-
-    /* first: filter */
-    if (task->cctx->verbose > 1) {
-      fprintf(stderr, "%s(%d): filtering ... \n",
-              me, task->threadIdx);
-    }
-    _coilProcess(task, AIR_TRUE);
-
-    /* second: update */
-    if (task->cctx->numThreads > 1) {
-      airThreadBarrierWait(task->cctx->updateBarrier);
-    }
-    if (task->cctx->verbose > 1) {
-      fprintf(stderr, "%s(%d): updating ... \n",
-              me, task->threadIdx);
-    }
-    _coilProcess(task, AIR_FALSE);
-
+    _coilRun(task);
   }
 
   return _task;
@@ -296,11 +560,52 @@ coilStart(coilContext *cctx) {
   int valIdx, valLen;
   coil_t (*lup)(const void*, size_t), *val;
   unsigned tidx, elIdx;
+  size_t elNum;
 
   if (!cctx) {
     biffAddf(COIL, "%s: got NULL pointer", me);
     return 1;
   }
+  if (cctx->blockIter > 1 && cctx->activeTol > 0) {
+    biffAddf(COIL, "%s: sorry, can't use active-set mode (activeTol %g) with "
+             "temporal blocking (blockIter %u)", me, cctx->activeTol,
+             cctx->blockIter);
+    return 1;
+  }
+  if (cctx->blockIter > 1) {
+    cctx->slabSize = (cctx->blockSlab
+                      ? cctx->blockSlab
+                      : (cctx->size[2] + cctx->numThreads - 1)/cctx->numThreads);
+    cctx->slabSize = AIR_MIN(cctx->slabSize, cctx->size[2]);
+    cctx->slabNum = (cctx->size[2] + cctx->slabSize - 1)/cctx->slabSize;
+  } else {
+    cctx->slabSize = cctx->slabNum = 0;
+  }
+  elNum = cctx->size[0]*cctx->size[1]*cctx->size[2];
+  if (cctx->activeTol > 0) {
+    if (nrrdMaybeAlloc_va(cctx->nact, nrrdTypeUChar, 4,
+                          AIR_CAST(size_t, 2), cctx->size[0],
+                          cctx->size[1], cctx->size[2])) {
+      biffMovef(COIL, NRRD, "%s: couldn't allocate active flags", me);
+      return 1;
+    }
+    /* all voxels start out as having changed */
+    memset(cctx->nact->data, 1, 2*elNum);
+  } else {
+    nrrdEmpty(cctx->nact);
+  }
+  if (cctx->blockIter > 1 && cctx->slabNum > 1) {
+    if (nrrdMaybeAlloc_va(cctx->nnext, coil_nrrdType, 4,
+                          AIR_CAST(size_t, cctx->kind->valLen), cctx->size[0],
+                          cctx->size[1], cctx->size[2])) {
+      biffMovef(COIL, NRRD, "%s: couldn't allocate new value buffer", me);
+      return 1;
+    }
+  } else {
+    nrrdEmpty(cctx->nnext);
+  }
+  airArrayLenSet(cctx->statArr, 0);
+
   cctx->task = (coilTask **)calloc(cctx->numThreads, sizeof(coilTask *));
   if (!(cctx->task)) {
     biffAddf(COIL, "%s: couldn't allocate array of tasks", me);
@@ -322,6 +627,7 @@ coilStart(coilContext *cctx) {
     cctx->nextSliceMutex = airThreadMutexNew();
     cctx->filterBarrier = airThreadBarrierNew(cctx->numThreads);
     cctx->updateBarrier = airThreadBarrierNew(cctx->numThreads);
+    cctx->iterBarrier = airThreadBarrierNew(cctx->numThreads);
   }
 
   /* initialize the values in cctx->nvol */
@@ -332,7 +638,7 @@ coilStart(coilContext *cctx) {
 #else
   lup = nrrdDLookup[cctx->nin->type];
 #endif
-  for (elIdx=0; elIdx<cctx->size[0]*cctx->size[1]*cctx->size[2]; elIdx++) {
+  for (elIdx=0; elIdx<elNum; elIdx++) {
     for (valIdx=0; valIdx<valLen; valIdx++) {
       val[valIdx + 0*valLen] = lup(cctx->nin->data, valIdx + valLen*elIdx);
       val[valIdx + 1*valLen] = 0;
@@ -351,18 +657,59 @@ coilStart(coilContext *cctx) {
     }
   }
 
-  /* set things as though we've just finished an update phase */
-  cctx->nextSlice = cctx->size[2];
-  cctx->todoFilter = AIR_TRUE;
-  cctx->todoUpdate = AIR_FALSE;
+  cctx->nextSlice = 0;
+  cctx->nextUpdateSlice = 0;
+
+  return 0;
+}
 
+/*
+** sums the per-thread statistics for the iterations just done,
+** and appends them to cctx->stat
+*/
+static int
+_coilStatTally(coilContext *cctx) {
+  static const char me[]="_coilStatTally";
+  unsigned int li, tidx, statIdx;
+  coilStat *stat, *tst;
+  char stmp[AIR_STRLEN_SMALL];
+
+  for (li=0; li<cctx->iterNum; li++) {
+    statIdx = airArrayLenIncr(cctx->statArr, 1);
+    if (!cctx->stat) {
+      biffAddf(COIL, "%s: couldn't allocate statistics", me);
+      return 1;
+    }
+    stat = cctx->stat + statIdx;
+    stat->iter = statIdx;
+    stat->activeNum = 0;
+    stat->deltaMax = 0;
+    stat->deltaMean = 0;
+    for (tidx=0; tidx<cctx->numThreads; tidx++) {
+      tst = cctx->task[tidx]->stat + li;
+      stat->activeNum += tst->activeNum;
+      stat->deltaMax = AIR_MAX(stat->deltaMax, tst->deltaMax);
+      stat->deltaMean += tst->deltaMean;
+    }
+    stat->deltaMean = (stat->activeNum
+                       ? stat->deltaMean/stat->activeNum
+                       : 0);
+    if (cctx->verbose) {
+      fprintf(stderr, "%s: iter %u: %s active, max delta %g, mean %g\n", me,
+              stat->iter, airSprintSize_t(stmp, stat->activeNum),
+              stat->deltaMax, stat->deltaMean);
+    }
+  }
   return 0;
 }
 
 /*
 ******** coilIterate
 **
-** (documentation)
+** does numIterations more iterations of filtering, appending the
+** statistics of each to cctx->stat.  With temporal blocking
+** (cctx->blockIter > 1), iterations are done in blocks of (at most)
+** blockIter.
 **
 ** NB: this implements the body of thread 0
 */
@@ -370,6 +717,7 @@ int
 coilIterate(coilContext *cctx, int numIterations) {
   static const char me[]="coilIterate";
   int iter;
+  unsigned int tidx;
   double time0, time1;
 
   if (!cctx) {
@@ -378,32 +726,34 @@ coilIterate(coilContext *cctx, int numIterations) {
   }
 
   time0 = airTime();
-  for (iter=0; iter<numIterations; iter++) {
+  iter = 0;
+  while (iter < numIterations) {
     cctx->iter = iter;
+    cctx->iterNum = (cctx->blockIter > 1
+                     ? AIR_MIN(cctx->blockIter, AIR_UINT(numIterations - iter))
+                     : 1);
     if (cctx->verbose) {
       fprintf(stderr, "%s: starting iter %d (of %d)\n", me, iter,
               numIterations);
     }
+    /* all other threads are waiting at filterBarrier */
+    cctx->nextSlice = 0;
+    cctx->nextUpdateSlice = 0;
+    for (tidx=0; tidx<cctx->numThreads; tidx++) {
+      memset(cctx->task[tidx]->stat, 0, cctx->iterNum*sizeof(coilStat));
+    }
     cctx->finished = AIR_FALSE;
     if (cctx->numThreads > 1) {
       airThreadBarrierWait(cctx->filterBarrier);
     }
 
-    /* first: filter */
-    if (cctx->verbose > 1) {
-      fprintf(stderr, "%s: filtering ... \n", me);
-    }
-    _coilProcess(cctx->task[0], AIR_TRUE);
+    _coilRun(cctx->task[0]);
 
-    /* second: update */
-    if (cctx->verbose > 1) {
-      fprintf(stderr, "%s: updating ... \n", me);
-    }
-    if (cctx->numThreads > 1) {
-      airThreadBarrierWait(cctx->updateBarrier);
+    if (_coilStatTally(cctx)) {
+      biffAddf(COIL, "%s: trouble after iter %d", me, iter);
+      return 1;
     }
-    _coilProcess(cctx->task[0], AIR_FALSE);
-
+    iter += cctx->iterNum;
   }
   time1 = airTime();
   if (cctx->verbose) {
@@ -443,6 +793,7 @@ coilFinish(coilContext *cctx) {
     cctx->nextSliceMutex = airThreadMutexNix(cctx->nextSliceMutex);
     cctx->filterBarrier = airThreadBarrierNix(cctx->filterBarrier);
     cctx->updateBarrier = airThreadBarrierNix(cctx->updateBarrier);
+    cctx->iterBarrier = airThreadBarrierNix(cctx->iterBarrier);
   }
 
   return 0;
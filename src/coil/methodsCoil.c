@@ -56,13 +56,22 @@ coilContextNew() {
     cctx->nin = NULL;
     cctx->radius = coilDefaultRadius;
     cctx->numThreads = 1;
+    cctx->blockIter = 0;
+    cctx->blockSlab = 0;
+    cctx->activeTol = 0.0;
     ELL_3V_SET(cctx->spacing, AIR_NAN, AIR_NAN, AIR_NAN);
     cctx->nvol = NULL;
+    cctx->nact = nrrdNew();
     cctx->finished = AIR_FALSE;
     cctx->task = NULL;
     cctx->nextSliceMutex = NULL;
     cctx->filterBarrier = NULL;
     cctx->updateBarrier = NULL;
+    cctx->iterBarrier = NULL;
+    cctx->stat = NULL;
+    cctx->statArr = airArrayNew((void**)&(cctx->stat), NULL,
+                                sizeof(coilStat), 64);
+    cctx->nnext = nrrdNew();
   }
   return cctx;
 }
@@ -183,6 +192,66 @@ coilContextAllSet(coilContext *cctx, const Nrrd *nin,
   return 0;
 }
 
+/*
+******** coilContextBlockSet
+**
+** sets up temporal blocking: coilIterate() will advance blockIter
+** iterations at a time, in a wavefront moving through z-slabs of
+** blockSlab slices (0 for one slab per thread), so that the data
+** for each slab is streamed through memory once per block rather
+** than twice per iteration.  Results are the same as without
+** blocking.  blockIter of 0 or 1 turns this off.  Has to be called
+** before coilStart().
+*/
+int
+coilContextBlockSet(coilContext *cctx, unsigned int blockIter,
+                    unsigned int blockSlab) {
+  static const char me[]="coilContextBlockSet";
+
+  if (!cctx) {
+    biffAddf(COIL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (cctx->task) {
+    biffAddf(COIL, "%s: can't change blocking after coilStart()", me);
+    return 1;
+  }
+  cctx->blockIter = blockIter;
+  cctx->blockSlab = blockSlab;
+  return 0;
+}
+
+/*
+******** coilContextActiveSet
+**
+** sets up active-set iteration: once the largest absolute update
+** component at a voxel, and at all voxels in its neighborhood, has
+** fallen to activeTol or below, the voxel is no longer filtered or
+** updated (until something in its neighborhood changes again).  This
+** is an approximation, which converges to the full result as activeTol
+** goes to zero; activeTol of 0 turns this off.  Has to be called before
+** coilStart().
+*/
+int
+coilContextActiveSet(coilContext *cctx, double activeTol) {
+  static const char me[]="coilContextActiveSet";
+
+  if (!cctx) {
+    biffAddf(COIL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (cctx->task) {
+    biffAddf(COIL, "%s: can't change active-set mode after coilStart()", me);
+    return 1;
+  }
+  if (!( AIR_EXISTS(activeTol) && activeTol >= 0 )) {
+    biffAddf(COIL, "%s: activeTol %g not >= 0", me, activeTol);
+    return 1;
+  }
+  cctx->activeTol = activeTol;
+  return 0;
+}
+
 /*
 ******** coilOutputGet
 **
@@ -229,6 +298,9 @@ coilContextNix(coilContext *cctx) {
   if (cctx) {
     /* thread machinery destroyed with coilFinish() */
     cctx->nvol = nrrdNuke(cctx->nvol);
+    cctx->nact = nrrdNuke(cctx->nact);
+    cctx->statArr = airArrayNuke(cctx->statArr);
+    cctx->nnext = nrrdNuke(cctx->nnext);
     airFree(cctx);
   }
   return NULL;
@@ -34,6 +34,8 @@ main(int argc, const char *argv[]) {
 
   int numIters, numThreads, methodType, kindType, _parmLen, pi, radius,
     verbose;
+  unsigned int blockIter, blockSlab;
+  double activeTol;
   Nrrd *nin, *nout;
   coilContext *cctx;
   double *_parm, parm[COIL_PARMS_NUM];
@@ -52,6 +54,15 @@ main(int argc, const char *argv[]) {
              "all the parameters required for filtering method", &_parmLen);
   hestOptAdd(&hopt, "r", "radius", airTypeInt, 1, 1, &radius, "1",
              "radius of filtering neighborhood");
+  hestOptAdd(&hopt, "bi", "# iters", airTypeUInt, 1, 1, &blockIter, "0",
+             "if > 1, number of iterations to advance at a time within "
+             "each z-slab (temporal blocking)");
+  hestOptAdd(&hopt, "bs", "# slices", airTypeUInt, 1, 1, &blockSlab, "0",
+             "number of slices per slab with temporal blocking, or 0 for "
+             "one slab per thread");
+  hestOptAdd(&hopt, "at", "tol", airTypeDouble, 1, 1, &activeTol, "0",
+             "if > 0, skip voxels for which no update in their neighborhood "
+             "exceeded this in the previous iteration");
   hestOptAdd(&hopt, "v", "verbose", airTypeInt, 1, 1, &verbose, "1",
              "verbosity level");
   hestOptAdd(&hopt, "i", "nin", airTypeOther, 1, 1, &(nin), "",
@@ -82,6 +93,8 @@ main(int argc, const char *argv[]) {
                         coilKindArray[kindType], coilMethodArray[methodType],
                         radius, numThreads, verbose,
                         parm)
+      || coilContextBlockSet(cctx, blockIter, blockSlab)
+      || coilContextActiveSet(cctx, activeTol)
       || coilStart(cctx)
       || coilIterate(cctx, numIters)
       || coilFinish(cctx)
@@ -23,6 +23,7 @@
 
 
 #include "dye.h"
+#include "privateDye.h"
 
 /*
 ** values in these matrices were copied from:
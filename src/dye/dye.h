@@ -31,6 +31,7 @@
 #include <teem/air.h>
 #include <teem/biff.h>
 #include <teem/ell.h>
+#include <teem/nrrd.h>
 
 #if defined(_WIN32) && !defined(__CYGWIN__) && !defined(TEEM_STATIC)
 #  if defined(TEEM_BUILD) || defined(dye_EXPORTS) || defined(teem_EXPORTS)
@@ -113,6 +114,11 @@ DYE_EXPORT void dyeLUVtoXYZ(float *X, float *Y, float *Z,
 DYE_EXPORT dyeConverter dyeSimpleConvert[DYE_MAX_SPACE+1][DYE_MAX_SPACE+1];
 DYE_EXPORT int dyeConvert(dyeColor *col, int space);
 
+/* nrrdDye.c */
+DYE_EXPORT int dyeNrrdConvert(Nrrd *nout, const Nrrd *nin,
+                              int inSpace, int outSpace,
+                              int approx, unsigned int threadNum);
+
 #ifdef __cplusplus
 }
 #endif
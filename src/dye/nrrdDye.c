@@ -0,0 +1,224 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "dye.h"
+#include "privateDye.h"
+
+/*
+** dyeLcbrt (from convertDye.c) with a float-only cube root: an initial
+** guess from the bits of t (good to about 4%), followed by two Halley
+** iterations, which gets within a few float ulps of airCbrt(t).  Unlike
+** airCbrt, it involves no calls to libm, so compilers can inline it
+** and vectorize the loops around it.
+*/
+static float
+_dyeLcbrtFast(float t) {
+  airFloat fu;
+  float yy, y3;
+
+  if (!(t > 0.008856f)) {
+    return AIR_CAST(float, 7.787*t + 16.0/116.0);
+  }
+  fu.f = t;
+  fu.i = fu.i/3 + 709921077u;
+  yy = fu.f;
+  y3 = yy*yy*yy;
+  yy = yy*(y3 + 2*t)/(2*y3 + t);
+  y3 = yy*yy*yy;
+  yy = yy*(y3 + 2*t)/(2*y3 + t);
+  return yy;
+}
+
+/* dyeXYZtoLAB, but with _dyeLcbrtFast */
+static void
+_dyeXYZtoLABFast(float *L, float *A, float *B,
+                 float  X, float  Y, float  Z) {
+  float Xc, Yc, Zc;
+
+  Xc = _dyeLcbrtFast(X/dyeWhiteXYZ_n[0]);
+  Yc = _dyeLcbrtFast(Y/dyeWhiteXYZ_n[1]);
+  Zc = _dyeLcbrtFast(Z/dyeWhiteXYZ_n[2]);
+  *L = 116.0f*Yc - 16.0f;
+  *A = 500.0f*(Xc - Yc);
+  *B = 200.0f*(Yc - Zc);
+}
+
+/* dyeXYZtoLUV, but with _dyeLcbrtFast */
+static void
+_dyeXYZtoLUVFast(float *L, float *U, float *V,
+                 float  X, float  Y, float  Z) {
+  float up, vp, den;
+
+  *L = 116.0f*_dyeLcbrtFast(Y/dyeWhiteXYZ_n[1]) - 16.0f;
+  den = X + 15.0f*Y + 3.0f*Z;
+  up = 4.0f*X/den;
+  vp = 9.0f*Y/den;
+  *U = 13.0f*(*L)*(up - dyeWhiteuvp_n[0]);
+  *V = 13.0f*(*L)*(vp - dyeWhiteuvp_n[1]);
+}
+
+/*
+** the sequence of simple converters that dyeConvert goes through
+** to get from inSpace to outSpace; returns the number of them (at most
+** 4: HSV or HSL -> RGB -> XYZ -> LAB or LUV, or the reverse)
+*/
+static unsigned int
+_dyeConvertChain(dyeConverter conv[4], int inSpace, int outSpace,
+                 int approx) {
+  unsigned int cn;
+  int cur, next;
+
+  cn = 0;
+  cur = inSpace;
+  do {
+    if (dyeSimpleConvert[cur][outSpace]) {
+      next = outSpace;
+    } else if (cur < dyeSpaceRGB) {
+      next = dyeSpaceRGB;
+    } else if (cur > dyeSpaceXYZ) {
+      next = dyeSpaceXYZ;
+    } else {
+      /* RGB going up, or XYZ going down */
+      next = (dyeSpaceRGB == cur ? dyeSpaceXYZ : dyeSpaceRGB);
+    }
+    conv[cn] = dyeSimpleConvert[cur][next];
+    if (approx && dyeSpaceXYZ == cur && dyeSpaceLAB == next) {
+      conv[cn] = _dyeXYZtoLABFast;
+    } else if (approx && dyeSpaceXYZ == cur && dyeSpaceLUV == next) {
+      conv[cn] = _dyeXYZtoLUVFast;
+    }
+    cn++;
+    cur = next;
+  } while (cur != outSpace);
+  return cn;
+}
+
+typedef struct {
+  float *data;
+  size_t lo, hi;     /* range of colors (triples) to convert */
+  dyeConverter conv[4];
+  unsigned int convNum;
+} _dyeNrrdTask;
+
+static void *
+_dyeNrrdWorker(void *_task) {
+  _dyeNrrdTask *task;
+  dyeConverter *conv;
+  float *dd, v0, v1, v2;
+  size_t II;
+  unsigned int ci, cn;
+
+  task = AIR_CAST(_dyeNrrdTask *, _task);
+  conv = task->conv;
+  cn = task->convNum;
+  for (II=task->lo; II<task->hi; II++) {
+    dd = task->data + 3*II;
+    v0 = dd[0]; v1 = dd[1]; v2 = dd[2];
+    for (ci=0; ci<cn; ci++) {
+      conv[ci](dd + 0, dd + 1, dd + 2, v0, v1, v2);
+      v0 = dd[0]; v1 = dd[1]; v2 = dd[2];
+    }
+  }
+  return _task;
+}
+
+/*
+******** dyeNrrdConvert
+**
+** converts every color in nin, a nrrd of any type with 3 values along
+** axis 0, from inSpace to outSpace, putting the result (always of type
+** float) in nout, which can be the same as nin if nin is float.  Each
+** color goes through the same simple converters as with dyeConvert, in
+** one pass over the array, and (without approx) the results are exactly
+** those of dyeConvert.  With approx, cube roots (for XYZ -> LAB and
+** LUV) are computed with float-only arithmetic; the resulting L*, a*,
+** b*, u*, and v* differ from dyeConvert's by less than 0.001 for XYZ
+** colors within the gamut of RGB [0,1]^3.  The colors are split among
+** threadNum threads.
+*/
+int
+dyeNrrdConvert(Nrrd *nout, const Nrrd *nin, int inSpace, int outSpace,
+               int approx, unsigned int threadNum) {
+  static const char me[]="dyeNrrdConvert";
+  _dyeNrrdTask *task;
+  airArray *mop;
+  size_t NN;
+  unsigned int ti, failIdx;
+
+  if (!(nout && nin)) {
+    biffAddf(DYE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!( DYE_VALID_SPACE(inSpace) && DYE_VALID_SPACE(outSpace) )) {
+    biffAddf(DYE, "%s: invalid input (%d) or output (%d) space", me,
+             inSpace, outSpace);
+    return 1;
+  }
+  if (!( nrrdTypeBlock != nin->type && 3 == nin->axis[0].size )) {
+    biffAddf(DYE, "%s: need non-%s nrrd with axis 0 size 3 (not %s, %u)",
+             me, airEnumStr(nrrdType, nrrdTypeBlock),
+             airEnumStr(nrrdType, nin->type),
+             AIR_CAST(unsigned int, nin->axis[0].size));
+    return 1;
+  }
+  if (nout != nin || nrrdTypeFloat != nin->type) {
+    if (nrrdConvert(nout, nin, nrrdTypeFloat)) {
+      biffMovef(DYE, NRRD, "%s: trouble converting to %s", me,
+                airEnumStr(nrrdType, nrrdTypeFloat));
+      return 1;
+    }
+  }
+  if (inSpace == outSpace) {
+    return 0;
+  }
+
+  NN = nrrdElementNumber(nout)/3;
+  threadNum = AIR_MAX(1, threadNum);
+  if (!airThreadCapable || NN < threadNum) {
+    threadNum = 1;
+  }
+  mop = airMopNew();
+  task = AIR_CALLOC(threadNum, _dyeNrrdTask);
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (!task) {
+    biffAddf(DYE, "%s: couldn't allocate %u thread records", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    task[ti].data = AIR_CAST(float *, nout->data);
+    task[ti].lo = AIR_CAST(size_t, AIR_CAST(airULLong, NN)*ti/threadNum);
+    task[ti].hi = AIR_CAST(size_t, AIR_CAST(airULLong, NN)*(ti+1)/threadNum);
+    task[ti].convNum = _dyeConvertChain(task[ti].conv, inSpace, outSpace,
+                                        approx);
+  }
+  failIdx = airThreadRun(threadNum, _dyeNrrdWorker, task,
+                         sizeof(_dyeNrrdTask), NULL, NULL);
+  if (failIdx) {
+    biffAddf(DYE, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
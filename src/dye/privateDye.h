@@ -0,0 +1,39 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2010, 2009, 2008 Thomas Schultz
+  Copyright (C) 2010, 2009, 2008 Gordon Kindlmann
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#ifndef DYE_PRIVATE_HAS_BEEN_INCLUDED
+#define DYE_PRIVATE_HAS_BEEN_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* convertDye.c */
+extern float dyeWhiteXYZ_n[3];
+extern float dyeWhiteuvp_n[2];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DYE_PRIVATE_HAS_BEEN_INCLUDED */
@@ -4,6 +4,8 @@ set(DYE_SOURCES
   convertDye.c
   dye.h
   methodsDye.c
+  nrrdDye.c
+  privateDye.h
   )
 
 ADD_TEEM_LIBRARY(dye ${DYE_SOURCES})
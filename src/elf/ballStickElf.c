@@ -184,8 +184,8 @@ int elfBallStickPredict_f(elfBallStickParms *parms, float *odf,
   return 0;
 }
 
-#if TEEM_LEVMAR
-/* Callbacks for levmar-based optimization of ball-and-stick model */
+/* Callbacks for levmar-based optimization of ball-and-stick model.
+ * The first one (signal prediction) is also used without levmar */
 
 /* pp[0]: log(d) pp[1]: VF1 pp[2]: theta1 pp[3]: phi1
  * pp[4]: VF2 pp[5]: theta2 pp[6]: phi2
@@ -231,6 +231,7 @@ _levmarBallStickCB(double *pp, double *xx, int mm, int nn, void *_data) {
   }
 }
 
+#if TEEM_LEVMAR
 static void
 _levmarBallStickJacCB(double *p, double *jac, int m, int n, void *_data) {
   elfSingleShellDWI *data = (elfSingleShellDWI *) _data;
@@ -309,90 +310,54 @@ _levmarBallStickJacCB(double *p, double *jac, int m, int n, void *_data) {
 }
 #endif /* levmar support */
 
-/* elfBallStickOptimize:
- *
- * Based on an initial guess of parms, use Levenberg-Marquardt optimization
- * to improve the fit w.r.t. the given DWI data.
- * Requires teem to be compiled with levmar support
- * Returns 0 upon success
- *         1 if fiberct outside {1,2,3}
- *         2 if levmar returned an error
- *         3 if levmar support is missing in this version of teem
- */
-int elfBallStickOptimize_f(elfBallStickParms *parms,
-                           const elfSingleShellDWI *dwi) {
-#if TEEM_LEVMAR
-  double lmparms[10], *dwis;
-  int lmret=0;
-  unsigned int k;
-  const int parmct=3*parms->fiberct+1;
-  const int maxitr=200;
-  double opts[LM_OPTS_SZ]={LM_INIT_MU,1e-2,1e-8,1e-8,1e-8};
-  double info[9];
-  double sumfs;
-  double mind=1e-5, minvf=1e-3; /* some minimal values for stability */
-
-  if (parms->fiberct==0 || parms->fiberct>3)
-    return 1;
-
-  /* we need a double precision version of the dwis */
-  dwis = (double*) malloc(sizeof(double)*dwi->dwino);
-  for (k=0; k<dwi->dwino; k++)
-    dwis[k]=dwi->dwis[k];
 
-  /* set parameters for optimization */
-  lmparms[0]=log(AIR_MAX(mind,parms->d));
-  parms->fs[1]=AIR_MAX(minvf,parms->fs[1]);
-  if (parms->fs[1]<0.5) lmparms[1]=log(2*parms->fs[1]);
-  else lmparms[1]=-log(2.0-2.0*parms->fs[1]);
-  lmparms[2]=acos(parms->vs[2]);
-  lmparms[3]=atan2(parms->vs[1],parms->vs[0]);
-  if (parms->fiberct>1) {
-    parms->fs[2]=AIR_MAX(minvf,parms->fs[2]);
-    if (parms->fs[2]<0.5) lmparms[4]=log(2*parms->fs[2]);
-    else lmparms[4]=-log(2.0-2.0*parms->fs[2]);
-    lmparms[5]=acos(parms->vs[5]);
-    lmparms[6]=atan2(parms->vs[4],parms->vs[3]);
-    if (parms->fiberct>2) {
-      parms->fs[3]=AIR_MAX(minvf,parms->fs[3]);
-      if (parms->fs[3]<0.5) lmparms[7]=log(2*parms->fs[3]);
-      else lmparms[7]=-log(2.0-2.0*parms->fs[3]);
-      lmparms[8]=acos(parms->vs[8]);
-      lmparms[9]=atan2(parms->vs[7],parms->vs[6]);
-    }
-  }
+/* conversion between elfBallStickParms and the parameter vector used
+ * in the levmar callbacks (and back, in _elfBallStickFromLM); minimal
+ * values are enforced for stability */
+static const double _elfBallStickMinD=1e-5, _elfBallStickMinVF=1e-3;
 
-  lmret = dlevmar_der(_levmarBallStickCB,_levmarBallStickJacCB,
-                      lmparms, dwis,
-                      parmct, dwi->dwino, maxitr, opts, info,
-                      NULL, NULL, (void*)dwi);
-  if (lmret==-1 && (int)info[6]==4) {
-    /* try again with larger mu */
-    opts[0]*=10;
-    lmret = dlevmar_der(_levmarBallStickCB,_levmarBallStickJacCB,
-                        lmparms, dwis,
-                        parmct, dwi->dwino, maxitr, opts, info,
-                        NULL, NULL, (void*)dwi);
+static void
+_elfBallStickToLM(double *lmparms, elfBallStickParms *parms) {
+  unsigned int k;
+  lmparms[0]=log(AIR_MAX(_elfBallStickMinD,parms->d));
+  for (k=0; k<parms->fiberct; k++) {
+    parms->fs[k+1]=AIR_MAX(_elfBallStickMinVF,parms->fs[k+1]);
+    if (parms->fs[k+1]<0.5) lmparms[1+3*k]=log(2*parms->fs[k+1]);
+    else lmparms[1+3*k]=-log(2.0-2.0*parms->fs[k+1]);
+    lmparms[2+3*k]=acos(parms->vs[3*k+2]);
+    lmparms[3+3*k]=atan2(parms->vs[3*k+1],parms->vs[3*k]);
   }
+}
 
-  free(dwis); /* no longer needed */
+/* squared error of the signal predicted by parms, w.r.t. dwisd (a
+ * double precision copy of dwi->dwis); pred is dwi->dwino scratch values */
+static double
+_elfBallStickSqrErr(elfBallStickParms *parms, const elfSingleShellDWI *dwi,
+                    const double *dwisd, double *pred) {
+  double lmparms[10], err=0.0;
+  unsigned int k;
+  _elfBallStickToLM(lmparms, parms);
+  _levmarBallStickCB(lmparms, pred, 3*parms->fiberct+1, dwi->dwino,
+                     (void*)dwi);
+  for (k=0; k<dwi->dwino; k++)
+    err += (pred[k]-dwisd[k])*(pred[k]-dwisd[k]);
+  return err;
+}
 
-  /* output the results (whether or not levmar signalled an error) */
+#if TEEM_LEVMAR
+static void
+_elfBallStickFromLM(elfBallStickParms *parms, const double *lmparms) {
+  double sumfs;
+  unsigned int k;
   parms->d = exp(lmparms[0]);
   parms->fs[0] = 0.0;
-  if (lmparms[1]>=0) parms->fs[1]=1.0-0.5*exp(-lmparms[1]);
-  else parms->fs[1]=0.5*exp(lmparms[1]);
-  if (parms->fiberct>1) {
-    if (lmparms[4]>=0) parms->fs[2]=1.0-0.5*exp(-lmparms[4]);
-    else parms->fs[2]=0.5*exp(lmparms[4]);
-  } else {
-    parms->fs[2]=0.0;
-  }
-  if (parms->fiberct>2) {
-    if (lmparms[7]>=0) parms->fs[3]=1.0-0.5*exp(-lmparms[7]);
-    else parms->fs[3]=0.5*exp(lmparms[7]);
-  } else {
-    parms->fs[3]=0.0;
+  for (k=0; k<3; k++) {
+    if (k<parms->fiberct) {
+      if (lmparms[1+3*k]>=0) parms->fs[k+1]=1.0-0.5*exp(-lmparms[1+3*k]);
+      else parms->fs[k+1]=0.5*exp(lmparms[1+3*k]);
+    } else {
+      parms->fs[k+1]=0.0;
+    }
   }
   sumfs = parms->fs[1] + parms->fs[2] + parms->fs[3];
   if (sumfs>1.0) {
@@ -407,6 +372,39 @@ int elfBallStickOptimize_f(elfBallStickParms *parms,
                stheta*sin(lmparms[3+3*k]),
                cos(lmparms[2+3*k]));
   }
+}
+
+/* the actual work of elfBallStickOptimize, with dwisd a double precision
+ * copy of dwi->dwis and work either NULL or LM_DER_WORKSZ(3*fiberct+1,
+ * dwino) values of levmar workspace */
+static int
+_elfBallStickOptimize(elfBallStickParms *parms, const elfSingleShellDWI *dwi,
+                      double *dwisd, double *work) {
+  double lmparms[10];
+  int lmret=0;
+  const int parmct=3*parms->fiberct+1;
+  const int maxitr=200;
+  double opts[LM_OPTS_SZ]={LM_INIT_MU,1e-2,1e-8,1e-8,1e-8};
+  double info[LM_INFO_SZ];
+
+  /* set parameters for optimization */
+  _elfBallStickToLM(lmparms, parms);
+
+  lmret = dlevmar_der(_levmarBallStickCB,_levmarBallStickJacCB,
+                      lmparms, dwisd,
+                      parmct, dwi->dwino, maxitr, opts, info,
+                      work, NULL, (void*)dwi);
+  if (lmret==-1 && (int)info[6]==4) {
+    /* try again with larger mu */
+    opts[0]*=10;
+    lmret = dlevmar_der(_levmarBallStickCB,_levmarBallStickJacCB,
+                        lmparms, dwisd,
+                        parmct, dwi->dwino, maxitr, opts, info,
+                        work, NULL, (void*)dwi);
+  }
+
+  /* output the results (whether or not levmar signalled an error) */
+  _elfBallStickFromLM(parms, lmparms);
 
   /* record statistical information */
   parms->stopreason = (int) (info[6])-1;
@@ -415,8 +413,283 @@ int elfBallStickOptimize_f(elfBallStickParms *parms,
 
   if (lmret==-1) return 2;
   return 0;
+}
+#endif
+
+/* elfBallStickOptimize:
+ *
+ * Based on an initial guess of parms, use Levenberg-Marquardt optimization
+ * to improve the fit w.r.t. the given DWI data.
+ * Requires teem to be compiled with levmar support
+ * Returns 0 upon success
+ *         1 if fiberct outside {1,2,3}
+ *         2 if levmar returned an error
+ *         3 if levmar support is missing in this version of teem
+ */
+int elfBallStickOptimize_f(elfBallStickParms *parms,
+                           const elfSingleShellDWI *dwi) {
+#if TEEM_LEVMAR
+  double *dwis;
+  unsigned int k;
+  int ret;
+
+  if (parms->fiberct==0 || parms->fiberct>3)
+    return 1;
+
+  /* we need a double precision version of the dwis */
+  dwis = (double*) malloc(sizeof(double)*dwi->dwino);
+  for (k=0; k<dwi->dwino; k++)
+    dwis[k]=dwi->dwis[k];
+
+  ret = _elfBallStickOptimize(parms, dwi, dwis, NULL);
+
+  free(dwis);
+  return ret;
 #else /* no levmar support, out of luck */
   (void) parms; (void) dwi; /* not using the parameters in this case */
   return 3;
 #endif
 }
+
+elfBallStickVolumeParm *elfBallStickVolumeParmNew(void) {
+  elfBallStickVolumeParm *vparm;
+  vparm = (elfBallStickVolumeParm*) malloc(sizeof(elfBallStickVolumeParm));
+  if (vparm!=NULL) {
+    vparm->fiberct=2;
+    vparm->order=4;
+    vparm->emc=NULL;
+#if TEEM_LEVMAR
+    vparm->optimize=1;
+#else
+    vparm->optimize=0; /* elfBallStickFitVolume_f would return 3 */
+#endif
+    vparm->warm=1;
+    vparm->threadNum=1;
+  }
+  return vparm;
+}
+
+elfBallStickVolumeParm *
+elfBallStickVolumeParmNix(elfBallStickVolumeParm *vparm) {
+  airFree(vparm); /* emc is not ours */
+  return NULL;
+}
+
+/* initial guess for a single voxel, from the maxima of the ODF tensor
+ * (if vparm->emc is set and there are enough of them), or from its
+ * rank-k decomposition (elfBallStickPredict) */
+static int
+_elfBallStickInit(elfBallStickParms *parms, float *ten,
+                  const tijk_type *type, float fiso, float d,
+                  const elfBallStickVolumeParm *vparm) {
+  unsigned int i, k=vparm->fiberct;
+  if (vparm->emc!=NULL) {
+    float *ls, *vs, totalfs=0;
+    int num=elfMaximaFind_f(&ls, &vs, ten, vparm->emc);
+    if (num>0) {
+      for (i=0; i<k && i<(unsigned int)num; i++)
+        totalfs+=ls[i];
+      if (num>=(int)k && totalfs>0) {
+        parms->d = d;
+        parms->fiberct = k;
+        parms->fs[0] = fiso;
+        for (i=0; i<k; i++) {
+          parms->fs[i+1] = ls[i]*(1.0f-fiso)/totalfs;
+          ELL_3V_COPY(parms->vs+3*i, vs+3*i);
+        }
+        free(ls); free(vs);
+        return 0;
+      }
+      free(ls); free(vs);
+    }
+  }
+  return elfBallStickPredict_f(parms, ten, type, k, d, fiso);
+}
+
+/* information passed to each thread of elfBallStickFitVolume */
+typedef struct {
+  elfBallStickParms *parms;
+  const float *b0s, *dwis, *grads, *T;
+  float b;
+  unsigned int dwino, sx,
+    lo, hi;                     /* range of scanlines to process */
+  const tijk_type *type;        /* type of ODF tensor */
+  const elfBallStickVolumeParm *vparm;
+  int retval;
+} _elfBallStickTask;
+
+static void *
+_elfBallStickWorker(void *_task) {
+  _elfBallStickTask *task = (_elfBallStickTask *)_task;
+  const elfBallStickVolumeParm *vparm = task->vparm;
+  float odf[TIJK_TYPE_MAX_NUM], ten[TIJK_TYPE_MAX_NUM];
+  double *dwisd, *pred, *work=NULL;
+  elfSingleShellDWI dwi;
+  unsigned int line, xi, k;
+
+  dwisd = (double*) malloc(sizeof(double)*task->dwino);
+  pred = (double*) malloc(sizeof(double)*task->dwino);
+#if TEEM_LEVMAR
+  /* levmar workspace, large enough for three sticks */
+  work = (double*) malloc(sizeof(double)*LM_DER_WORKSZ(10, task->dwino));
+  if (work==NULL) task->retval=4;
+#endif
+  if (dwisd==NULL || pred==NULL) task->retval=4;
+  dwi.b = task->b;
+  dwi.grads = (float*) task->grads;
+  dwi.dwino = task->dwino;
+  for (line=task->lo; line<task->hi && !task->retval; line++) {
+    elfBallStickParms *prev=NULL; /* previous voxel along scanline */
+    for (xi=0; xi<task->sx; xi++) {
+      size_t vi = (size_t)line*task->sx + xi;
+      elfBallStickParms *parms = task->parms + vi;
+      float fiso, d;
+      memset(parms, 0, sizeof(elfBallStickParms));
+      parms->stopreason = -1;
+      dwi.b0 = task->b0s[vi];
+      dwi.dwis = (float*) (task->dwis + vi*task->dwino);
+      if (!(dwi.b0>0)
+          || elfBallStickODF_f(odf, &fiso, &d, &dwi, task->T,
+                               vparm->order, 0)) {
+        /* background, or no valid diffusivity estimate */
+        parms->fiberct = 0;
+        prev = NULL;
+        continue;
+      }
+      tijk_esh_to_3d_sym_f(ten, odf, vparm->order);
+      if (_elfBallStickInit(parms, ten, task->type, fiso, d, vparm)) {
+        parms->fiberct = 0;
+        prev = NULL;
+        continue;
+      }
+      for (k=0; k<task->dwino; k++)
+        dwisd[k] = dwi.dwis[k];
+      parms->sqrerr = _elfBallStickSqrErr(parms, &dwi, dwisd, pred);
+      if (vparm->warm && prev!=NULL) {
+        /* start from the neighbor's solution if it fits better */
+        elfBallStickParms guess = *prev;
+        guess.sqrerr = _elfBallStickSqrErr(&guess, &dwi, dwisd, pred);
+        if (guess.sqrerr<parms->sqrerr) {
+          *parms = guess;
+        }
+      }
+      parms->stopreason = -1;
+      parms->itr = 0;
+#if TEEM_LEVMAR
+      if (vparm->optimize) {
+        _elfBallStickOptimize(parms, &dwi, dwisd, work);
+      }
+#endif
+      prev = parms;
+    }
+  }
+  airFree(dwisd);
+  airFree(pred);
+  airFree(work);
+  return _task;
+}
+
+/* elfBallStickFitVolume:
+ *
+ * Fits the ball-and-multi-stick model to all voxels of a volume, using
+ * vparm->threadNum threads, each of which processes a range of scanlines.
+ * In each voxel, the initial guess comes from the ODF (see
+ * elfBallStickODF and _elfBallStickInit); with vparm->warm, the solution
+ * at the previous voxel along the scanline is used instead when it
+ * predicts the data better.  With vparm->optimize, it is then refined by
+ * levmar (as in elfBallStickOptimize), re-using per-thread workspaces.
+ *
+ * Output:
+ *  parms  - one per voxel. fiberct is zero where no fit was possible
+ *           (b0<=0 or no valid diffusivity); itr and stopreason report
+ *           levmar iterations and termination reason (-1 if levmar was
+ *           not run), sqrerr the final squared error.
+ * Input:
+ *  b0s    - unweighted measurements, one per voxel
+ *  dwis   - dwino diffusion-weighted measurements per voxel
+ *  grads  - normalized gradient vectors (Cartesian 3D)
+ *  b      - b value
+ *  size   - number of voxels along each axis, fastest first
+ *
+ * Returns 0 on success
+ *         1 upon erroneous parameters
+ *         2 if there are too few DWIs for the ESH order
+ *         3 if optimization is requested, but levmar support is missing
+ *         4 if memory allocation failed
+ *         5 if a thread could not be started
+ */
+int elfBallStickFitVolume_f(elfBallStickParms *parms, const float *b0s,
+                            const float *dwis, const float *grads,
+                            unsigned int dwino, float b,
+                            const unsigned int size[3],
+                            const elfBallStickVolumeParm *vparm) {
+  float zero[TIJK_TYPE_MAX_NUM], ten[TIJK_TYPE_MAX_NUM];
+  float *thetaphi=NULL, *T=NULL;
+  const tijk_type *type;
+  _elfBallStickTask *task=NULL;
+  unsigned int lineNum, threadNum, ti;
+  int ret=0;
+
+  if (parms==NULL || b0s==NULL || dwis==NULL || grads==NULL
+      || size==NULL || vparm==NULL)
+    return 1;
+  if (vparm->fiberct==0 || vparm->fiberct>3
+      || vparm->order>tijk_max_esh_order || vparm->order%2!=0)
+    return 1;
+  memset(zero, 0, sizeof(zero));
+  type = tijk_esh_to_3d_sym_f(ten, zero, vparm->order);
+  if (type==NULL || (vparm->emc!=NULL && vparm->emc->type!=type))
+    return 1;
+#if !TEEM_LEVMAR
+  if (vparm->optimize)
+    return 3;
+#endif
+  if (dwino<tijk_esh_len[vparm->order/2])
+    return 2;
+
+  thetaphi = (float*) malloc(sizeof(float)*2*dwino);
+  T = (float*) malloc(sizeof(float)*tijk_esh_len[vparm->order/2]*dwino);
+  lineNum = size[1]*size[2];
+  threadNum = AIR_MAX(1, AIR_MIN(vparm->threadNum, lineNum));
+  task = (_elfBallStickTask*) calloc(threadNum, sizeof(_elfBallStickTask));
+  if (thetaphi==NULL || T==NULL || task==NULL) {
+    ret=4;
+    goto cleanup_and_exit;
+  }
+  elfCart2Thetaphi_f(thetaphi, grads, dwino);
+  if (elfESHEstimMatrix_f(T, NULL, vparm->order, thetaphi, dwino,
+                          0.0f, NULL)) {
+    ret=2;
+    goto cleanup_and_exit;
+  }
+
+  for (ti=0; ti<threadNum; ti++) {
+    task[ti].parms = parms;
+    task[ti].b0s = b0s;
+    task[ti].dwis = dwis;
+    task[ti].grads = grads;
+    task[ti].T = T;
+    task[ti].b = b;
+    task[ti].dwino = dwino;
+    task[ti].sx = size[0];
+    task[ti].lo = AIR_UINT(AIR_CAST(airULLong, lineNum)*ti/threadNum);
+    task[ti].hi = AIR_UINT(AIR_CAST(airULLong, lineNum)*(ti+1)/threadNum);
+    task[ti].type = type;
+    task[ti].vparm = vparm;
+    task[ti].retval = 0;
+  }
+  if (airThreadRun(threadNum, _elfBallStickWorker, task,
+                   sizeof(_elfBallStickTask), NULL, NULL)) {
+    ret=5;
+    goto cleanup_and_exit;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    if (task[ti].retval) ret=task[ti].retval;
+  }
+
+ cleanup_and_exit:
+  airFree(thetaphi);
+  airFree(T);
+  airFree(task);
+  return ret;
+}
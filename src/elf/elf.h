@@ -79,7 +79,11 @@ typedef struct {
   int *neighbors;
   unsigned int nbstride;
   float *vertices_f; /* we're only storing the non-redundant ones */
-  double *vertices_d; /* only filled when needed */
+  double *vertices_d;
+  /* bases for evaluating the form at all vertices at once (see
+   * tijk_s_form_basis) */
+  float *basis_f;
+  double *basis_d;
 } elfMaximaContext;
 
 /* maximaElf.c */
@@ -93,6 +97,16 @@ ELF_EXPORT int elfMaximaFind_d(double **ls, double **vs, const double *ten,
                                elfMaximaContext *emc);
 ELF_EXPORT int elfMaximaFind_f(float **ls, float **vs, const float *ten,
                                elfMaximaContext *emc);
+ELF_EXPORT int elfMaximaFindBatch_d(double *ls, double *vs,
+                                    unsigned int *num, const double *ten,
+                                    unsigned int N, unsigned int kmax,
+                                    elfMaximaContext *emc,
+                                    unsigned int threadNum);
+ELF_EXPORT int elfMaximaFindBatch_f(float *ls, float *vs,
+                                    unsigned int *num, const float *ten,
+                                    unsigned int N, unsigned int kmax,
+                                    elfMaximaContext *emc,
+                                    unsigned int threadNum);
 
 /* ESHEstimElf.c */
 ELF_EXPORT void elfCart2Thetaphi_d(double *thetaphi, const double *dirs,
@@ -156,6 +170,35 @@ ELF_EXPORT int elfBallStickPredict_f(elfBallStickParms *parms, float *odf,
 ELF_EXPORT int elfBallStickOptimize_f(elfBallStickParms *parms,
                                       const elfSingleShellDWI *dwi);
 
+/* elfBallStickVolumeParm:
+ *
+ * Controls fitting the ball-and-multi-stick model to a whole volume
+ * (elfBallStickFitVolume)
+ */
+typedef struct {
+  unsigned int fiberct;  /* number of sticks (1..3) */
+  unsigned int order;    /* ESH order of the ODF used for initialization */
+  elfMaximaContext *emc; /* if non-NULL, initial directions are the largest
+                          * maxima of the ODF; needs to match order. Not
+                          * nix'ed along with the parm */
+  int optimize;          /* if non-zero, refine with levmar; defaults to
+                          * non-zero only when Teem was built with levmar
+                          * (TEEM_LEVMAR) */
+  int warm;              /* if non-zero, start from the previous voxel's
+                          * solution when it fits the data better */
+  unsigned int threadNum;
+} elfBallStickVolumeParm;
+
+ELF_EXPORT elfBallStickVolumeParm *elfBallStickVolumeParmNew(void);
+ELF_EXPORT elfBallStickVolumeParm
+  *elfBallStickVolumeParmNix(elfBallStickVolumeParm *vparm);
+ELF_EXPORT int elfBallStickFitVolume_f(elfBallStickParms *parms,
+                                       const float *b0s, const float *dwis,
+                                       const float *grads,
+                                       unsigned int dwino, float b,
+                                       const unsigned int size[3],
+                                       const elfBallStickVolumeParm *vparm);
+
 #ifdef __cplusplus
 }
 #endif
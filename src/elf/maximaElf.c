@@ -50,8 +50,26 @@ elfMaximaContext *elfMaximaContextNew(const tijk_type *type,
   for (vert=0; vert<sphere->xyzwNum; vert+=2) {
     ELL_3V_COPY(retval->vertices_f+3*(vert/2), sphere->xyzw+4*vert);
   }
-  retval->vertices_d = NULL;
   sphere=limnPolyDataNix(sphere);
+  /* the double precision vertices and both bases are set up here, so
+   * that elfMaximaFind_d and _f can be called from several threads at
+   * once */
+  retval->vertices_d = (double*) malloc(sizeof(double)*3*(retval->num/2));
+  retval->basis_f = (float*) malloc(sizeof(float)*type->num
+                                    *(retval->num/2));
+  retval->basis_d = (double*) malloc(sizeof(double)*type->num
+                                     *(retval->num/2));
+  if (retval->vertices_d==NULL || retval->basis_f==NULL
+      || retval->basis_d==NULL)
+    return elfMaximaContextNix(retval);
+  for (vert=0; vert<retval->num/2; vert++) {
+    ELL_3V_COPY(retval->vertices_d+3*vert, retval->vertices_f+3*vert);
+  }
+  if (tijk_s_form_basis_f(retval->basis_f, retval->vertices_f,
+                          retval->num/2, type)
+      || tijk_s_form_basis_d(retval->basis_d, retval->vertices_d,
+                             retval->num/2, type))
+    return elfMaximaContextNix(retval);
   return retval;
 }
 
@@ -59,8 +77,9 @@ elfMaximaContext *elfMaximaContextNix(elfMaximaContext *emc) {
   if (emc!=NULL) {
     free(emc->neighbors);
     free(emc->vertices_f);
-    if (emc->vertices_d!=NULL)
-      free(emc->vertices_d);
+    airFree(emc->vertices_d);
+    airFree(emc->basis_f);
+    airFree(emc->basis_d);
     if (emc->parm!=NULL)
       tijk_refine_rank1_parm_nix(emc->parm);
     free(emc);
@@ -101,16 +120,14 @@ int elfMaximaFind_d(double **ls, double **vs, const double *ten,
   airHeap *heap;
   if (ls==NULL || vs==NULL || ten==NULL || emc==NULL)
     return -1;
-  if (emc->vertices_d==NULL) { /* we need to allocate these */
-    emc->vertices_d = (double*) malloc(sizeof(double)*3*(emc->num/2));
-    for (i=0; i<emc->num/2; i++) {
-      ELL_3V_COPY(emc->vertices_d+3*i, emc->vertices_f+3*i);
-    }
-  }
   /* evaluate all unique directions */
   vals = (double*) malloc(sizeof(double)*(emc->num/2));
-  for (i=0; i<emc->num/2; i++) {
-    vals[i]=(*emc->type->sym->s_form_d)(ten, emc->vertices_d+3*i);
+  if (vals==NULL)
+    return -1;
+  if (tijk_basis_eval_batch_d(vals, emc->basis_d, emc->num/2, ten,
+                              emc->type->num, 1)) {
+    free(vals);
+    return -1;
   }
   heap = airHeapNew(sizeof(double)*3, 20);
   /* identify discrete maxima */
@@ -159,8 +176,12 @@ int elfMaximaFind_f(float **ls, float **vs, const float *ten,
     return -1;
   /* evaluate all unique directions */
   vals = (float*) malloc(sizeof(float)*(emc->num/2));
-  for (i=0; i<emc->num/2; i++) {
-    vals[i]=(*emc->type->sym->s_form_f)(ten, emc->vertices_f+3*i);
+  if (vals==NULL)
+    return -1;
+  if (tijk_basis_eval_batch_f(vals, emc->basis_f, emc->num/2, ten,
+                              emc->type->num, 1)) {
+    free(vals);
+    return -1;
   }
   heap = airHeapNew(sizeof(float)*3, 20);
   /* identify discrete maxima */
@@ -196,3 +217,108 @@ int elfMaximaFind_f(float **ls, float **vs, const float *ten,
   free(vals);
   return retval;
 }
+
+/* information passed to each thread of elfMaximaFindBatch */
+typedef struct {
+  elfMaximaContext *emc;
+  unsigned int kmax, lo, hi;    /* max. #maxima, range of tensors */
+  void *ls, *vs;                /* outputs */
+  unsigned int *num;            /* output (possibly NULL) */
+  const void *ten;              /* input */
+  int retval;
+} _elfMaximaTask;
+
+#define ELFMAXIMAWORKER(TYPE, SUF)                                      \
+  static void *                                                         \
+  _elfMaximaWorker_##SUF(void *_task) {                                 \
+    _elfMaximaTask *task=(_elfMaximaTask *)_task;                       \
+    const unsigned int kmax=task->kmax, tnum=task->emc->type->num;      \
+    const TYPE *ten=(const TYPE *)task->ten;                            \
+    TYPE *ls=(TYPE *)task->ls, *vs=(TYPE *)task->vs;                    \
+    unsigned int nn, ii;                                                \
+    for (nn=task->lo; nn<task->hi; nn++) {                              \
+      TYPE *fls=NULL, *fvs=NULL;                                        \
+      unsigned int got;                                                 \
+      int found;                                                        \
+      found=elfMaximaFind_##SUF(&fls, &fvs, ten+nn*tnum, task->emc);    \
+      if (found<0) {                                                    \
+        task->retval=1;                                                 \
+        found=0;                                                        \
+      }                                                                 \
+      got=AIR_MIN(kmax, (unsigned int)found);                           \
+      for (ii=0; ii<kmax; ii++) {                                       \
+        if (ii<got) {                                                   \
+          ls[nn*kmax+ii]=fls[ii];                                       \
+          ELL_3V_COPY(vs+3*(nn*kmax+ii), fvs+3*ii);                     \
+        } else {                                                        \
+          ls[nn*kmax+ii]=0;                                             \
+          ELL_3V_SET(vs+3*(nn*kmax+ii), 0, 0, 0);                       \
+        }                                                               \
+      }                                                                 \
+      if (task->num!=NULL)                                              \
+        task->num[nn]=got;                                              \
+      if (found>0) {                                                    \
+        free(fls); free(fvs);                                           \
+      }                                                                 \
+    }                                                                   \
+    return _task;                                                       \
+  }
+
+ELFMAXIMAWORKER(double, d)
+ELFMAXIMAWORKER(float, f)
+
+/* elfMaximaFindBatch:
+ *
+ * Same as elfMaximaFind, for N tensors that are stored contiguously
+ * (i.e., tensor n starts at n*emc->type->num), such as all voxels of a
+ * volume, using threadNum threads (each of which handles a contiguous
+ * range of tensors). Since emc is only read, all threads share it.
+ *
+ * For each tensor, the kmax largest maxima are stored in ls (N*kmax
+ * values, sorted in descending order) and vs (N*3*kmax values); if
+ * there are fewer maxima, the remaining entries are set to zero. If num
+ * is non-NULL, num[n] is set to the number of maxima stored for tensor n.
+ *
+ * Returns 0 on success, 1 upon erroneous parameters or if memory
+ * allocation or starting a thread failed.
+ */
+#define ELFMAXIMAFINDBATCH(TYPE, SUF)                                   \
+  int elfMaximaFindBatch_##SUF(TYPE *ls, TYPE *vs, unsigned int *num,   \
+                               const TYPE *ten, unsigned int N,         \
+                               unsigned int kmax, elfMaximaContext *emc,\
+                               unsigned int threadNum) {                \
+    _elfMaximaTask *task;                                               \
+    unsigned int ti;                                                    \
+    int retval=0;                                                       \
+    if (ls==NULL || vs==NULL || ten==NULL || emc==NULL || kmax==0)      \
+      return 1;                                                         \
+    if (N==0)                                                           \
+      return 0;                                                         \
+    threadNum=AIR_MAX(1, AIR_MIN(threadNum, N));                        \
+    task=AIR_CALLOC(threadNum, _elfMaximaTask);                         \
+    if (task==NULL)                                                     \
+      return 1;                                                         \
+    for (ti=0; ti<threadNum; ti++) {                                    \
+      task[ti].emc=emc;                                                 \
+      task[ti].kmax=kmax;                                               \
+      task[ti].lo=AIR_UINT(AIR_CAST(airULLong, N)*ti/threadNum);        \
+      task[ti].hi=AIR_UINT(AIR_CAST(airULLong, N)*(ti+1)/threadNum);    \
+      task[ti].ls=ls;                                                   \
+      task[ti].vs=vs;                                                   \
+      task[ti].num=num;                                                 \
+      task[ti].ten=ten;                                                 \
+      task[ti].retval=0;                                                \
+    }                                                                   \
+    if (airThreadRun(threadNum, _elfMaximaWorker_##SUF, task,           \
+                     sizeof(_elfMaximaTask), NULL, NULL)) {             \
+      retval=1; /* couldn't start all threads */                        \
+    }                                                                   \
+    for (ti=0; ti<threadNum; ti++) {                                    \
+      retval|=task[ti].retval;                                          \
+    }                                                                   \
+    free(task);                                                         \
+    return retval;                                                      \
+  }
+
+ELFMAXIMAFINDBATCH(double, d)
+ELFMAXIMAFINDBATCH(float, f)
@@ -0,0 +1,458 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "ell.h"
+
+/*
+** Batched eigensolves of 3x3 matrices.
+**
+** The input is processed in blocks of _ELL_BATCH_LEN matrices, which are
+** transposed into a structure-of-arrays layout (one array per matrix
+** entry), so that the loops over the elements of a block are free of
+** data-dependent control flow and can be vectorized by the compiler.
+**
+** Within a block, the most common case (three distinct real roots of
+** the characteristic polynomial) is handled in straight-line code that
+** repeats, in the same order of operations, the computations done by
+** ell_3m_eigenvalues_d, ell_cubic, and _ell_3m_evecs_d.  Results are
+** therefore the same as calling ell_3m_eigensolve_d on each matrix.
+** Anything else (repeated roots, single root) is handed off to the
+** per-matrix ell_3m_eigensolve_d, since those cases need branches and
+** are in any case rare in real data.
+*/
+
+#define _ELL_BATCH_LEN 64
+
+/* value of epsilon in ell_cubic() */
+#define _ELL_BATCH_CUBIC_EPS 1.0E-11
+
+typedef struct {
+  double mm[9][_ELL_BATCH_LEN],  /* (deviatoric) matrix entries */
+    trc[_ELL_BATCH_LEN],         /* what was subtracted from diagonal */
+    scl[_ELL_BATCH_LEN],         /* one over frobenius norm */
+    sub[_ELL_BATCH_LEN], QQ[_ELL_BATCH_LEN], RR[_ELL_BATCH_LEN],
+    QQQ[_ELL_BATCH_LEN],         /* from cubic coefficients */
+    eval[3][_ELL_BATCH_LEN],
+    evec[9][_ELL_BATCH_LEN];
+  int three[_ELL_BATCH_LEN];     /* three distinct roots */
+} _ellBatchBlock;
+
+/*
+** the same as ell_3m_1d_nullspace_d, on m - e*I
+*/
+static void
+_ellBatchNullspace(double ans[3], const double m[9], double e) {
+  double n[9], t[9], d0, d1, d2, ref[3], sgn, len;
+  int Mi;
+
+  ELL_3M_TRANSPOSE(n, m);
+  n[0] -= e; n[4] -= e; n[8] -= e;
+  ELL_3V_CROSS(t+0, n+0, n+3);
+  ELL_3V_CROSS(t+3, n+0, n+6);
+  ELL_3V_CROSS(t+6, n+3, n+6);
+  /* same as _ell_align3_d(t), but with selects instead of indexing */
+  d0 = ELL_3V_DOT(t+0, t+0);
+  d1 = ELL_3V_DOT(t+3, t+3);
+  d2 = ELL_3V_DOT(t+6, t+6);
+  Mi = ELL_MAX3_IDX(d0, d1, d2);
+  ref[0] = (0 == Mi ? t[0] : (1 == Mi ? t[3] : t[6]));
+  ref[1] = (0 == Mi ? t[1] : (1 == Mi ? t[4] : t[7]));
+  ref[2] = (0 == Mi ? t[2] : (1 == Mi ? t[5] : t[8]));
+  /* the dot of ref with itself is never negative, so it isn't flipped */
+  sgn = ELL_3V_DOT(ref, t+0) < 0 ? -1 : 1;
+  ELL_3V_SCALE(t+0, sgn, t+0);
+  sgn = ELL_3V_DOT(ref, t+3) < 0 ? -1 : 1;
+  ELL_3V_SCALE(t+3, sgn, t+3);
+  sgn = ELL_3V_DOT(ref, t+6) < 0 ? -1 : 1;
+  ELL_3V_SCALE(t+6, sgn, t+6);
+  ELL_3V_ADD3(ans, t+0, t+3, t+6);
+  ELL_3V_NORM(ans, ans, len);
+  return;
+}
+
+/*
+** the same as _ell_3m_enforce_orthogonality followed by
+** _ell_3m_make_right_handed_d
+*/
+static void
+_ellBatchOrthoRight(double v[9]) {
+  double d00, d10, d11, d20, d21, d22, scl, tv[3], xx[3], sgn;
+
+  d00 = ELL_3V_DOT(v+3*0, v+3*0);
+  d10 = ELL_3V_DOT(v+3*1, v+3*0);
+  d11 = ELL_3V_DOT(v+3*1, v+3*1);
+  ELL_3V_SCALE_ADD2(tv, 1, v+3*1, -d10/d00, v+3*0);
+  scl = sqrt(d11/ELL_3V_DOT(tv, tv));
+  ELL_3V_SCALE(v+3*1, scl, tv);
+  d20 = ELL_3V_DOT(v+3*2, v+3*0);
+  d21 = ELL_3V_DOT(v+3*2, v+3*1);
+  d22 = ELL_3V_DOT(v+3*2, v+3*2);
+  ELL_3V_SCALE_ADD3(tv, 1, v+3*2, -d20/d00, v+3*0, -d21/d00, v+3*1);
+  scl = sqrt(d22/ELL_3V_DOT(tv, tv));
+  ELL_3V_SCALE(v+3*2, scl, tv);
+  ELL_3V_CROSS(xx, v+3*0, v+3*1);
+  sgn = 0 > ELL_3V_DOT(xx, v+3*2) ? -1 : 1;
+  ELL_3V_SCALE(v+3*2, sgn, v+3*2);
+  return;
+}
+
+/*
+** solves the matrices in bb->mm[][0..num-1]; when wantEvec is
+** zero only the eigenvalues are computed.  Matrices that did NOT have
+** three distinct roots (bb->three[ii] == 0) are left for the caller.
+*/
+static void
+_ellBatchBlockSolve(_ellBatchBlock *bb, unsigned int num, int wantEvec) {
+  unsigned int ii;
+
+  /* coefficients of the cubic, as in ell_3m_eigenvalues_d */
+  for (ii=0; ii<num; ii++) {
+    double m[9], frob, scale, A, B, C, AA, Q, R, QQQ, D;
+    m[0] = bb->mm[0][ii]; m[1] = bb->mm[1][ii]; m[2] = bb->mm[2][ii];
+    m[3] = bb->mm[3][ii]; m[4] = bb->mm[4][ii]; m[5] = bb->mm[5][ii];
+    m[6] = bb->mm[6][ii]; m[7] = bb->mm[7][ii]; m[8] = bb->mm[8][ii];
+    frob = ELL_3M_FROB(m);
+    scale = frob ? 1.0/frob : 1.0;
+    ELL_3M_SCALE(m, scale, m);
+    A = -m[0] - m[4] - m[8];
+    B = m[0]*m[4] - m[3]*m[1]
+      + m[0]*m[8] - m[6]*m[2]
+      + m[4]*m[8] - m[7]*m[5];
+    C = (m[6]*m[4] - m[3]*m[7])*m[2]
+      + (m[0]*m[7] - m[6]*m[1])*m[5]
+      + (m[3]*m[1] - m[0]*m[4])*m[8];
+    /* as in ell_cubic */
+    AA = A*A;
+    Q = (AA/3.0 - B)/3.0;
+    R = (-2.0*A*AA/27.0 + A*B/3.0 - C)/2.0;
+    QQQ = Q*Q*Q;
+    D = R*R - QQQ;
+    bb->scl[ii] = scale;
+    bb->sub[ii] = A/3.0;
+    bb->QQ[ii] = Q;
+    bb->RR[ii] = R;
+    bb->QQQ[ii] = QQQ;
+    bb->three[ii] = (D < -_ELL_BATCH_CUBIC_EPS);
+  }
+  /* three distinct roots, as in ell_cubic */
+  for (ii=0; ii<num; ii++) {
+    double theta, tt, isc;
+    if (!bb->three[ii]) {
+      bb->eval[0][ii] = bb->eval[1][ii] = bb->eval[2][ii] = 0.0;
+      continue;
+    }
+    theta = acos(bb->RR[ii]/sqrt(bb->QQQ[ii]))/3.0;
+    tt = 2*sqrt(bb->QQ[ii]);
+    isc = 1.0/bb->scl[ii];
+    bb->eval[0][ii] = isc*(tt*cos(theta) - bb->sub[ii]);
+    bb->eval[1][ii] = isc*(tt*cos(theta - 2*AIR_PI/3.0) - bb->sub[ii]);
+    bb->eval[2][ii] = isc*(tt*cos(theta + 2*AIR_PI/3.0) - bb->sub[ii]);
+  }
+  if (wantEvec) {
+    /* this is computed for all elements, including those that will be
+       over-written by the caller, so that there are no branches */
+    for (ii=0; ii<num; ii++) {
+      double m[9], vv[9];
+      m[0] = bb->mm[0][ii]; m[1] = bb->mm[1][ii]; m[2] = bb->mm[2][ii];
+      m[3] = bb->mm[3][ii]; m[4] = bb->mm[4][ii]; m[5] = bb->mm[5][ii];
+      m[6] = bb->mm[6][ii]; m[7] = bb->mm[7][ii]; m[8] = bb->mm[8][ii];
+      _ellBatchNullspace(vv+0, m, bb->eval[0][ii]);
+      _ellBatchNullspace(vv+3, m, bb->eval[1][ii]);
+      _ellBatchNullspace(vv+6, m, bb->eval[2][ii]);
+      _ellBatchOrthoRight(vv);
+      bb->evec[0][ii] = vv[0]; bb->evec[1][ii] = vv[1];
+      bb->evec[2][ii] = vv[2]; bb->evec[3][ii] = vv[3];
+      bb->evec[4][ii] = vv[4]; bb->evec[5][ii] = vv[5];
+      bb->evec[6][ii] = vv[6]; bb->evec[7][ii] = vv[7];
+      bb->evec[8][ii] = vv[8];
+    }
+  }
+  return;
+}
+
+enum {
+  _ellBatchInputUnknown,
+  _ellBatchInput3M_d,        /* 9 doubles per matrix */
+  _ellBatchInput3MS_f,       /* 6 floats (xx xy xz yy yz zz) per matrix,
+                                at a given stride */
+  _ellBatchInputLast
+};
+
+typedef struct {
+  /* input parameters */
+  int input, deviatoric, newton;
+  const double *mat_d;
+  const float *sym_f;
+  size_t stride;
+  /* outputs (any may be NULL) */
+  double *eval_d, *evec_d;
+  float *eval_f, *evec_f;
+  int *roots;
+  /* assigned to this thread */
+  size_t lo, hi;
+  int error;                 /* couldn't allocate working block */
+} _ellBatchTask;
+
+static void
+_ellBatchLoad(double m[9], const _ellBatchTask *task, size_t II) {
+  const float *ss;
+
+  if (_ellBatchInput3M_d == task->input) {
+    ELL_3M_COPY(m, task->mat_d + 9*II);
+  } else {
+    ss = task->sym_f + task->stride*II;
+    ELL_3M_SET(m,
+               ss[0], ss[1], ss[2],
+               ss[1], ss[3], ss[4],
+               ss[2], ss[4], ss[5]);
+  }
+  return;
+}
+
+static void
+_ellBatchStore(const _ellBatchTask *task, size_t II, int roots,
+               const double eval[3], const double evec[9], double trc) {
+
+  if (task->roots) {
+    task->roots[II] = roots;
+  }
+  if (task->eval_d) {
+    ELL_3V_SET(task->eval_d + 3*II, eval[0] + trc, eval[1] + trc,
+               eval[2] + trc);
+  }
+  if (task->eval_f) {
+    ELL_3V_SET_TT(task->eval_f + 3*II, float, eval[0] + trc,
+                  eval[1] + trc, eval[2] + trc);
+  }
+  if (task->evec_d) {
+    ELL_3M_COPY(task->evec_d + 9*II, evec);
+  }
+  if (task->evec_f) {
+    ELL_3M_COPY_TT(task->evec_f + 9*II, float, evec);
+  }
+  return;
+}
+
+static void
+_ellBatchRange(_ellBatchBlock *bb, const _ellBatchTask *task) {
+  size_t base;
+  unsigned int ii, kk, num;
+  int wantEvec;
+  double m[9], iso[9], trc, eval[3], evec[9];
+
+  wantEvec = !!(task->evec_d || task->evec_f);
+  ELL_3M_ZERO_SET(evec);
+  for (base=task->lo; base<task->hi; base+=num) {
+    num = AIR_CAST(unsigned int, AIR_MIN(_ELL_BATCH_LEN, task->hi - base));
+    for (ii=0; ii<num; ii++) {
+      _ellBatchLoad(m, task, base + ii);
+      if (task->deviatoric) {
+        /* as in tenEigensolve_d */
+        trc = ELL_3M_TRACE(m)/3.0;
+        ELL_3M_SCALE_SET(iso, -trc, -trc, -trc);
+        ELL_3M_ADD2(m, m, iso);
+      } else {
+        trc = 0.0;
+      }
+      bb->trc[ii] = trc;
+      for (kk=0; kk<9; kk++) {
+        bb->mm[kk][ii] = m[kk];
+      }
+    }
+    _ellBatchBlockSolve(bb, num, wantEvec);
+    for (ii=0; ii<num; ii++) {
+      int roots;
+      if (bb->three[ii]) {
+        roots = ell_cubic_root_three;
+        ELL_3V_SET(eval, bb->eval[0][ii], bb->eval[1][ii], bb->eval[2][ii]);
+        if (wantEvec) {
+          for (kk=0; kk<9; kk++) {
+            evec[kk] = bb->evec[kk][ii];
+          }
+        }
+      } else {
+        for (kk=0; kk<9; kk++) {
+          m[kk] = bb->mm[kk][ii];
+        }
+        roots = (wantEvec
+                 ? ell_3m_eigensolve_d(eval, evec, m, task->newton)
+                 : ell_3m_eigenvalues_d(eval, m, task->newton));
+      }
+      _ellBatchStore(task, base + ii, roots, eval, evec, bb->trc[ii]);
+    }
+  }
+  return;
+}
+
+static void *
+_ellBatchWorker(void *_task) {
+  _ellBatchTask *task;
+  _ellBatchBlock *bb;
+
+  task = AIR_CAST(_ellBatchTask *, _task);
+  /* the block is about 20K; kept off the thread's stack */
+  bb = AIR_CALLOC(1, _ellBatchBlock);
+  if (!bb) {
+    task->error = AIR_TRUE;
+    return _task;
+  }
+  _ellBatchRange(bb, task);
+  free(bb);
+  return _task;
+}
+
+static int
+_ellBatchRun(const _ellBatchTask *task, size_t num, unsigned int threadNum) {
+  static const char me[]="_ellBatchRun";
+  _ellBatchTask *tt;
+  airArray *mop;
+  unsigned int ti, failIdx;
+  int bad;
+
+  if (!num) {
+    return 0;
+  }
+  if (!airThreadCapable || !threadNum) {
+    threadNum = 1;
+  }
+  threadNum = AIR_CAST(unsigned int, AIR_MIN(threadNum, num));
+  mop = airMopNew();
+  tt = AIR_CALLOC(threadNum, _ellBatchTask);
+  airMopAdd(mop, tt, airFree, airMopAlways);
+  if (!tt) {
+    biffAddf(ELL, "%s: couldn't allocate %u task records", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    tt[ti] = *task;
+    tt[ti].lo = num*ti/threadNum;
+    tt[ti].hi = num*(ti+1)/threadNum;
+    tt[ti].error = AIR_FALSE;
+  }
+  /* the threads have fixed ranges, so there's nothing to abort */
+  failIdx = airThreadRun(threadNum, _ellBatchWorker, tt,
+                         sizeof(_ellBatchTask), NULL, NULL);
+  if (failIdx) {
+    biffAddf(ELL, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
+  bad = AIR_FALSE;
+  for (ti=0; ti<threadNum; ti++) {
+    bad |= tt[ti].error;
+  }
+  if (bad) {
+    biffAddf(ELL, "%s: couldn't allocate working block", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** ell_3m_eigensolve_batch_d()
+**
+** For num 3x3 matrices stored contiguously (9 doubles each) in mat,
+** does the same as calling ell_3m_eigensolve_d() (or, if evec is NULL,
+** ell_3m_eigenvalues_d()) on each, but more efficiently, and using
+** threadNum threads.  eval must have room for 3*num doubles, and evec
+** (if non-NULL) for 9*num; if roots is non-NULL it gets the num return
+** values of ell_3m_eigensolve_d.
+**
+** This DOES use biff, for problems with thread creation or memory
+*/
+int
+ell_3m_eigensolve_batch_d(double *eval, double *evec, int *roots,
+                          const double *mat, size_t num,
+                          const int newton, unsigned int threadNum) {
+  static const char me[]="ell_3m_eigensolve_batch_d";
+  _ellBatchTask task;
+
+  if (!(eval && mat)) {
+    biffAddf(ELL, "%s: got NULL pointer (%p,%p)", me,
+             AIR_VOIDP(eval), AIR_CVOIDP(mat));
+    return 1;
+  }
+  memset(&task, 0, sizeof(task));
+  task.input = _ellBatchInput3M_d;
+  task.mat_d = mat;
+  task.newton = newton;
+  task.eval_d = eval;
+  task.evec_d = evec;
+  task.roots = roots;
+  if (_ellBatchRun(&task, num, threadNum)) {
+    biffAddf(ELL, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+******** ell_3ms_eigensolve_batch_f()
+**
+** like ell_3m_eigensolve_batch_d, but for symmetric matrices given by
+** their six unique values (xx, xy, xz, yy, yz, zz) in sym, with
+** successive matrices "stride" floats apart (so a stride of 7 and
+** sym = ten+1 works for a contiguous array of teem 7-element tensors).
+** Computation is in double; results are stored as float.
+**
+** If "deviatoric" is non-zero, the isotropic part is removed prior to
+** eigensolving and then added back to the eigenvalues, which is what
+** tenEigensolve_f does for accuracy (and which this matches).
+**
+** This DOES use biff, for problems with thread creation or memory
+*/
+int
+ell_3ms_eigensolve_batch_f(float *eval, float *evec, int *roots,
+                           const float *sym, size_t stride, size_t num,
+                           int deviatoric, const int newton,
+                           unsigned int threadNum) {
+  static const char me[]="ell_3ms_eigensolve_batch_f";
+  _ellBatchTask task;
+
+  if (!(eval && sym)) {
+    biffAddf(ELL, "%s: got NULL pointer (%p,%p)", me,
+             AIR_VOIDP(eval), AIR_CVOIDP(sym));
+    return 1;
+  }
+  if (stride < 6) {
+    biffAddf(ELL, "%s: stride %u < 6 doesn't make sense", me,
+             AIR_CAST(unsigned int, stride));
+    return 1;
+  }
+  memset(&task, 0, sizeof(task));
+  task.input = _ellBatchInput3MS_f;
+  task.sym_f = sym;
+  task.stride = stride;
+  task.deviatoric = deviatoric;
+  task.newton = newton;
+  task.eval_f = eval;
+  task.evec_f = evec;
+  task.roots = roots;
+  if (_ellBatchRun(&task, num, threadNum)) {
+    biffAddf(ELL, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
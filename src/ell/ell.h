@@ -266,6 +266,17 @@ ELL_EXPORT int ell_3m_svd_d(double uu[9], double sval[3], double vv[9],
 ELL_EXPORT int ell_6ms_eigensolve_d(double eval[6], double evec[36],
                                     const double mat[21], const double eps);
 
+/* batchEll.c */
+ELL_EXPORT int ell_3m_eigensolve_batch_d(double *eval, double *evec,
+                                         int *roots, const double *mat,
+                                         size_t num, const int newton,
+                                         unsigned int threadNum);
+ELL_EXPORT int ell_3ms_eigensolve_batch_f(float *eval, float *evec,
+                                          int *roots, const float *sym,
+                                          size_t stride, size_t num,
+                                          int deviatoric, const int newton,
+                                          unsigned int threadNum);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,7 @@
 # This variable will help provide a master list of all the sources.
 # Add new source files here.
 set(ELL_SOURCES
+  batchEll.c
   cubicEll.c
   eigen.c
   ell.h
@@ -0,0 +1,233 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "gage.h"
+#include "privateGage.h"
+
+/*
+** _gageBrickNew()
+**
+** makes a bricked copy (see gageBrick) of the data of nin, which has
+** already been checked as a 3D volume of the given shape, with valLen
+** values per sample
+*/
+gageBrick *
+_gageBrickNew(const Nrrd *nin, const gageShape *shape,
+              unsigned int valLen, unsigned int edge) {
+  static const char me[]="_gageBrickNew";
+  gageBrick *brick;
+  unsigned int shift, xb, yy, zz, len;
+  size_t brickNum;
+  const char *data;
+
+  if (!( nin && shape )) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return NULL;
+  }
+  for (shift=1; shift<=8; shift++) {
+    if (edge == (1U << shift)) {
+      break;
+    }
+  }
+  if (shift > 8) {
+    biffAddf(GAGE, "%s: brick size %u not a power of two in [2,256]",
+             me, edge);
+    return NULL;
+  }
+  brick = AIR_CALLOC(1, gageBrick);
+  if (!brick) {
+    biffAddf(GAGE, "%s: couldn't allocate brick", me);
+    return NULL;
+  }
+  brick->edge = edge;
+  brick->shift = shift;
+  brick->mask = edge - 1;
+  brick->bnum[0] = (shape->size[0] + edge - 1) >> shift;
+  brick->bnum[1] = (shape->size[1] + edge - 1) >> shift;
+  brick->bnum[2] = (shape->size[2] + edge - 1) >> shift;
+  brick->tupleSize = valLen*nrrdTypeSize[nin->type];
+  brickNum = AIR_CAST(size_t, brick->bnum[0])*brick->bnum[1]*brick->bnum[2];
+  brick->data = AIR_CALLOC(brickNum*edge*edge*edge*brick->tupleSize, char);
+  if (!brick->data) {
+    biffAddf(GAGE, "%s: couldn't allocate %u x %u x %u bricks of %u^3 "
+             "samples", me, brick->bnum[0], brick->bnum[1], brick->bnum[2],
+             edge);
+    airFree(brick); return NULL;
+  }
+  brick->refCount = 1;
+  brick->refMutex = airThreadMutexNew();
+  if (!brick->refMutex) {
+    biffAddf(GAGE, "%s: couldn't create reference count mutex", me);
+    airFree(brick->data); airFree(brick); return NULL;
+  }
+
+  /* copy scanline pieces of (up to) one brick edge at a time */
+  data = AIR_CAST(const char *, nin->data);
+  for (zz=0; zz<shape->size[2]; zz++) {
+    for (yy=0; yy<shape->size[1]; yy++) {
+      for (xb=0; xb<brick->bnum[0]; xb++) {
+        size_t inIdx, outIdx;
+        len = AIR_MIN(edge, shape->size[0] - (xb << shift));
+        inIdx = (xb << shift)
+          + shape->size[0]*(yy + AIR_CAST(size_t, shape->size[1])*zz);
+        outIdx = _GAGE_BRICK_INDEX(brick, xb << shift, yy, zz);
+        memcpy(brick->data + outIdx*brick->tupleSize,
+               data + inIdx*brick->tupleSize, len*brick->tupleSize);
+      }
+    }
+  }
+  return brick;
+}
+
+/*
+** _gageBrickRef()
+**
+** adds one reference to the brick, and returns it
+*/
+gageBrick *
+_gageBrickRef(gageBrick *brick) {
+
+  if (brick) {
+    airThreadMutexLock(brick->refMutex);
+    brick->refCount++;
+    airThreadMutexUnlock(brick->refMutex);
+  }
+  return brick;
+}
+
+/*
+** _gageBrickNix()
+**
+** releases one reference to the brick, and frees it when that was the
+** last one.  Always returns NULL
+*/
+gageBrick *
+_gageBrickNix(gageBrick *brick) {
+  unsigned int left;
+
+  if (brick) {
+    airThreadMutexLock(brick->refMutex);
+    left = --brick->refCount;
+    airThreadMutexUnlock(brick->refMutex);
+    if (!left) {
+      airThreadMutexNix(brick->refMutex);
+      airFree(brick->data);
+      airFree(brick);
+    }
+  }
+  return NULL;
+}
+
+/*
+** _gageBrickIv3Fill()
+**
+** the bricked counterpart of the 3D (sz > 1) part of gageIv3Fill(): fills
+** pvl->iv3 (and ctx->edgeFrac) from pvl->brick, with the same clamping.
+** Per-axis brick and within-brick offsets are computed once per slice
+** and scanline, so the inner loop is only a few adds and masks
+*/
+void
+_gageBrickIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
+  const gageBrick *brick;
+  int lx, ly, lz, _xx, _yy, _zz;
+  unsigned int xx, yy, zz, sx, sy, sz, fr, fd, fddd, tup, valLen,
+    cacheIdx, edgeNum, bshift;
+  size_t zoff, yoff, xoff;
+  const char *here;
+  double *iv3;
+
+  brick = pvl->brick;
+  sx = ctx->shape->size[0];
+  sy = ctx->shape->size[1];
+  sz = ctx->shape->size[2];
+  fr = ctx->radius;
+  fd = 2*fr;
+  fddd = fd*fd*fd;
+  valLen = pvl->kind->valLen;
+  iv3 = pvl->iv3;
+  bshift = 3*brick->shift;
+  /* idx[0]-1: see Thu Jan 14 comment in filter.c */
+  lx = ctx->point.idx[0]-1 - (fr - 1);
+  ly = ctx->point.idx[1]-1 - (fr - 1);
+  lz = ctx->point.idx[2]-1 - (fr - 1);
+  if (lx >= 0 && ly >= 0 && lz >= 0
+      && (lx >> brick->shift) == ((lx + AIR_CAST(int, fd) - 1) >> brick->shift)
+      && (ly >> brick->shift) == ((ly + AIR_CAST(int, fd) - 1) >> brick->shift)
+      && (lz >> brick->shift) == ((lz + AIR_CAST(int, fd) - 1) >> brick->shift)
+      && lx + fd <= sx && ly + fd <= sy && lz + fd <= sz) {
+    /* the common case: the whole neighborhood is inside one brick, so no
+       clamping is needed, and the samples are at fixed strides */
+    unsigned int xi, yi, zi;
+    const char *corner;
+    size_t ystride, zstride;
+    ystride = brick->tupleSize << brick->shift;
+    zstride = ystride << brick->shift;
+    corner = brick->data
+      + brick->tupleSize*_GAGE_BRICK_INDEX(brick, lx, ly, lz);
+    cacheIdx = 0;
+    for (zi=0; zi<fd; zi++) {
+      for (yi=0; yi<fd; yi++) {
+        here = corner + zi*zstride + yi*ystride;
+        for (xi=0; xi<fd; xi++) {
+          for (tup=0; tup<valLen; tup++) {
+            iv3[cacheIdx + fddd*tup] = pvl->lup(here, tup);
+          }
+          here += brick->tupleSize;
+          cacheIdx++;
+        }
+      }
+    }
+    ctx->edgeFrac = 0;
+    return;
+  }
+  edgeNum = 0;
+  cacheIdx = 0;
+  for (_zz=lz; _zz<lz+AIR_CAST(int, fd); _zz++) {
+    zz = AIR_CLAMP(0, _zz, AIR_CAST(int, sz-1));
+    zoff = ((AIR_CAST(size_t, zz >> brick->shift)*brick->bnum[1]
+             *brick->bnum[0]) << bshift)
+      + ((zz & brick->mask) << (2*brick->shift));
+    for (_yy=ly; _yy<ly+AIR_CAST(int, fd); _yy++) {
+      yy = AIR_CLAMP(0, _yy, AIR_CAST(int, sy-1));
+      yoff = zoff + ((AIR_CAST(size_t, yy >> brick->shift)*brick->bnum[0])
+                     << bshift)
+        + ((yy & brick->mask) << brick->shift);
+      for (_xx=lx; _xx<lx+AIR_CAST(int, fd); _xx++) {
+        xx = AIR_CLAMP(0, _xx, AIR_CAST(int, sx-1));
+        edgeNum += ((AIR_CAST(int, zz) != _zz)
+                    || (AIR_CAST(int, yy) != _yy)
+                    || (AIR_CAST(int, xx) != _xx));
+        xoff = (AIR_CAST(size_t, xx >> brick->shift) << bshift)
+          + (xx & brick->mask);
+        here = brick->data + (yoff + xoff)*brick->tupleSize;
+        for (tup=0; tup<valLen; tup++) {
+          iv3[cacheIdx + fddd*tup] = pvl->lup(here, tup);
+        }
+        cacheIdx++;
+      }
+    }
+  }
+  ctx->edgeFrac = AIR_CAST(double, edgeNum)/fddd;
+  return;
+}
@@ -75,6 +75,7 @@ gageContextNew() {
     strcpy(ctx->errStr, "");
     ctx->errNum = gageErrNone;
     ctx->edgeFrac = 0;
+    gageIv3CountReset(ctx);
   }
   return ctx;
 }
@@ -160,6 +161,7 @@ gageContextCopy(gageContext *ctx) {
 
   /* make sure gageProbe() has to refill caches */
   gagePointReset(&ntx->point);
+  gageIv3CountReset(ntx);
 
   return ntx;
 }
@@ -378,6 +380,10 @@ gageParmSet(gageContext *ctx, int which, double val) {
   case gageParmTwoDimZeroZ:
     ctx->parm.twoDimZeroZ = AIR_CAST(int, val);
     break;
+  case gageParmBrickSize:
+    ctx->parm.brickSize = AIR_CAST(int, val);
+    /* affects future calls to gagePerVolumeAttach */
+    break;
   default:
     fprintf(stderr, "\n%s: sorry, which = %d not valid\n\n", me, which);
     break;
@@ -448,6 +454,14 @@ gagePerVolumeAttach(gageContext *ctx, gagePerVolume *pvl) {
     }
     gageShapeNix(shape);
   }
+  if (ctx->parm.brickSize && ctx->shape->size[2] > 1 && !pvl->brick) {
+    pvl->brick = _gageBrickNew(pvl->nin, ctx->shape, pvl->kind->valLen,
+                               AIR_CAST(unsigned int, ctx->parm.brickSize));
+    if (!pvl->brick) {
+      biffAddf(GAGE, "%s: couldn't brick volume", me);
+      return 1;
+    }
+  }
   /* here we go */
   newidx = airArrayLenIncr(ctx->pvlArr, 1);
   if (!ctx->pvl) {
@@ -541,6 +555,12 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
     fprintf(stderr, "%s:     l %d %d %d; h %d %d %d; fddd %u\n", me,
             lx, ly, lz, hx, hy, hz, fddd);
   }
+  if (pvl->brick) {
+    /* bricked volumes are always 3D, and handled separately */
+    _gageBrickIv3Fill(ctx, pvl);
+    ELL_3V_COPY(pvl->iv3Idx, ctx->point.idx);
+    return;
+  }
   data = (char*)pvl->nin->data;
   if (lx >= 0 && ly >= 0 && lz >= 0
       && hx < AIR_CAST(int, sx)
@@ -683,12 +703,147 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
     }
     ctx->edgeFrac = AIR_CAST(double, edgeNum)/fddd;
   }
+  ELL_3V_COPY(pvl->iv3Idx, ctx->point.idx);
   if (ctx->verbose > 1) {
     fprintf(stderr, "%s: ^^^ bye\n", me);
   }
   return;
 }
 
+/*
+** _gageIv3Shift()
+**
+** for when the probe has moved by one voxel along axis "ax" (by "step",
+** either +1 or -1) since pvl->iv3 was filled: the values already in the
+** iv3 are moved over by one, and only the new face of the neighborhood
+** is loaded from the volume.  The result is identical to what
+** gageIv3Fill() would give, as is ctx->edgeFrac.  Because the tuple
+** axis is slowest, the values that the single memmove() carries across
+** scanlines (or slices, or tuple components) land exactly in the face
+** that is re-loaded.  Only used for 3D volumes (sz > 1).
+*/
+static void
+_gageIv3Shift(gageContext *ctx, gagePerVolume *pvl,
+              unsigned int ax, int step) {
+  int lo[3], cc[3], _cc[3];
+  unsigned int fr, fd, fddd, size[3], stride[3], valLen, tup, ui, vi,
+    axU, axV, inNum[3], cacheIdx, dataIdx, dataStride;
+  char *data, *here;
+  double *iv3;
+
+  fr = ctx->radius;
+  fd = 2*fr;
+  fddd = fd*fd*fd;
+  ELL_3V_COPY(size, ctx->shape->size);
+  ELL_3V_SET(stride, 1, fd, fd*fd);
+  valLen = pvl->kind->valLen;
+  dataStride = AIR_UINT(valLen*nrrdTypeSize[pvl->nin->type]);
+  data = pvl->brick ? pvl->brick->data : (char*)pvl->nin->data;
+  iv3 = pvl->iv3;
+
+  if (step > 0) {
+    memmove(iv3, iv3 + stride[ax], (fddd*valLen - stride[ax])*sizeof(double));
+    cc[ax] = fd-1;
+  } else {
+    memmove(iv3 + stride[ax], iv3, (fddd*valLen - stride[ax])*sizeof(double));
+    cc[ax] = 0;
+  }
+  /* same lower corner of neighborhood as in gageIv3Fill */
+  lo[0] = ctx->point.idx[0]-1 - (fr - 1);
+  lo[1] = ctx->point.idx[1]-1 - (fr - 1);
+  lo[2] = ctx->point.idx[2]-1 - (fr - 1);
+  axU = (ax + 1) % 3;
+  axV = (ax + 2) % 3;
+  _cc[ax] = lo[ax] + cc[ax];
+  _cc[ax] = AIR_CLAMP(0, _cc[ax], AIR_CAST(int, size[ax]-1));
+  for (vi=0; vi<fd; vi++) {
+    cc[axV] = vi;
+    _cc[axV] = lo[axV] + vi;
+    _cc[axV] = AIR_CLAMP(0, _cc[axV], AIR_CAST(int, size[axV]-1));
+    for (ui=0; ui<fd; ui++) {
+      cc[axU] = ui;
+      _cc[axU] = lo[axU] + ui;
+      _cc[axU] = AIR_CLAMP(0, _cc[axU], AIR_CAST(int, size[axU]-1));
+      cacheIdx = cc[0] + fd*(cc[1] + fd*cc[2]);
+      if (pvl->brick) {
+        here = data + dataStride*_GAGE_BRICK_INDEX(pvl->brick,
+                                                   _cc[0], _cc[1], _cc[2]);
+      } else {
+        dataIdx = _cc[0] + size[0]*(_cc[1] + size[1]*_cc[2]);
+        here = data + dataIdx*dataStride;
+      }
+      for (tup=0; tup<valLen; tup++) {
+        iv3[cacheIdx + fddd*tup] = pvl->lup(here, tup);
+      }
+    }
+  }
+
+  /* a sample is invented (as counted by gageIv3Fill) if its
+     coordinate along any axis is outside the volume */
+  for (ui=0; ui<3; ui++) {
+    int hi;
+    hi = lo[ui] + AIR_CAST(int, fd) - 1;
+    inNum[ui] = AIR_UINT(AIR_MAX(0, (AIR_MIN(hi, AIR_CAST(int, size[ui])-1)
+                                     - AIR_MAX(lo[ui], 0) + 1)));
+  }
+  ctx->edgeFrac = AIR_CAST(double, fddd - inNum[0]*inNum[1]*inNum[2])/fddd;
+  ELL_3V_COPY(pvl->iv3Idx, ctx->point.idx);
+  return;
+}
+
+/*
+** _gageIv3Update()
+**
+** brings pvl->iv3 up to date with ctx->point.idx, either by shifting
+** (if it was last filled one voxel away along one axis), or with a
+** full gageIv3Fill()
+*/
+static void
+_gageIv3Update(gageContext *ctx, gagePerVolume *pvl) {
+  unsigned int ax, diffNum, diffAx=0;
+  int step=0;
+
+  diffNum = 0;
+  for (ax=0; ax<3; ax++) {
+    if (pvl->iv3Idx[ax] != ctx->point.idx[ax]) {
+      diffNum++;
+      diffAx = ax;
+      step = (pvl->iv3Idx[ax] + 1 == ctx->point.idx[ax]
+              ? 1
+              : (pvl->iv3Idx[ax] == ctx->point.idx[ax] + 1
+                 ? -1
+                 : 0));
+    }
+  }
+  if (1 == diffNum && step
+      && UINT_MAX != pvl->iv3Idx[diffAx]
+      && ctx->shape->size[2] > 1) {
+    _gageIv3Shift(ctx, pvl, diffAx, step);
+    ctx->iv3ShiftNum++;
+  } else if (diffNum) {
+    gageIv3Fill(ctx, pvl);
+    ctx->iv3FillNum++;
+    AIR_PROFILE_COUNT(airProfileGageIv3Fill, 1);
+  }
+  return;
+}
+
+/*
+******** gageIv3CountReset
+**
+** zeros the counts (in the gageContext) of how the iv3 caches were updated
+*/
+void
+gageIv3CountReset(gageContext *ctx) {
+
+  if (ctx) {
+    ctx->iv3HitNum = 0;
+    ctx->iv3FillNum = 0;
+    ctx->iv3ShiftNum = 0;
+  }
+  return;
+}
+
 /*
 ** _gageProbe
 **
@@ -711,12 +866,20 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
   if (!ctx) {
     return 1;
   }
+  AIR_PROFILE_COUNT(airProfileGageProbe, 1);
   if (ctx->verbose > 3) {
     fprintf(stderr, "%s: hello(%g,%g,%g,%g) _____________ \n", me,
             _xi, _yi, _zi, _si);
   }
   ELL_4V_COPY(oldIdx, ctx->point.idx);
   oldNnz = ctx->point.stackFwNonZeroNum;
+  if (UINT_MAX == oldIdx[0]) {
+    /* the point was reset (by gageUpdate, or by a caller who has changed
+       the volume values), so no pervolume iv3 can be trusted */
+    for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
+      ELL_3V_SET(ctx->pvl[pvlIdx]->iv3Idx, UINT_MAX, UINT_MAX, UINT_MAX);
+    }
+  }
   if (_gageLocationSet(ctx, _xi, _yi, _zi, _si)) {
     /* we're outside the volume; leave ctx->errNum and ctx->errStr set;
        as they have just been set by _gageLocationSet() */
@@ -756,7 +919,7 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
           fprintf(stderr, "%s: gageIv3Fill(pvl[%u/%u] %s): .......\n", me,
                   pvlIdx, ctx->pvlNum, ctx->pvl[pvlIdx]->kind->name);
         }
-        gageIv3Fill(ctx, ctx->pvl[pvlIdx]);
+        _gageIv3Update(ctx, ctx->pvl[pvlIdx]);
       }
     } else {
       for (pvlIdx=0; pvlIdx<ctx->pvlNum-1; pvlIdx++) {
@@ -770,7 +933,7 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
             fprintf(stderr, "%s: stackFw[%u] == %g -> iv3fill needed\n", me,
                     pvlIdx, ctx->stackFw[pvlIdx]);
           }
-          gageIv3Fill(ctx, ctx->pvl[pvlIdx]);
+          _gageIv3Update(ctx, ctx->pvl[pvlIdx]);
         } else {
           if (ctx->verbose > 3) {
             fprintf(stderr, "%s: stackFw[%u] == %g -> NO iv3fill\n", me,
@@ -779,6 +942,8 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
         }
       }
     }
+  } else {
+    ctx->iv3HitNum++;
   }
   if (ctx->parm.stackUse) {
     unsigned int baseIdx, vi;
@@ -154,6 +154,7 @@ _gageFwSet(gageContext *ctx, unsigned int sidx, double sfrac) {
     /* we evaluate weights for all three axes with one call */
     ctx->ksp[kidx]->kernel->evalN_d(ctx->fw + fd*3*kidx, ctx->fsl,
                                     fd*3, ctx->ksp[kidx]->parm);
+    AIR_PROFILE_COUNT(airProfileKernelEval, fd*3);
   }
 
   if (ctx->verbose > 2) {
@@ -401,6 +402,7 @@ _gageLocationSet(gageContext *ctx,
     sksp = ctx->ksp[gageKernelStack];
     sksp->kernel->evalN_d(ctx->stackFw, ctx->stackFsl,
                           ctx->pvlNum-1, sksp->parm);
+    AIR_PROFILE_COUNT(airProfileKernelEval, ctx->pvlNum-1);
     if (ctx->verbose > 2) {
       for (ii=0; ii<ctx->pvlNum-1; ii++) {
         fprintf(stderr, "%s: ctx->stackFw[%u] = %g\n",
@@ -132,6 +132,7 @@ enum {
   gageParmOrientationFromSpacing,  /* int */
   gageParmGenerateErrStr,          /* int */
   gageParmTwoDimZeroZ,             /* int */
+  gageParmBrickSize,               /* int */
   gageParmLast
 };
 
@@ -552,6 +553,16 @@ typedef struct gageParm_t {
                                  correctly handling it ultimately falls to the
                                  "answer" functions of the various
                                  gageKinds */
+  int brickSize;              /* if non-zero: the edge length (a power of
+                                 two) of the cubical bricks into which the
+                                 data of a 3D volume is re-laid out by
+                                 gagePerVolumeAttach, so that gageIv3Fill
+                                 touches fewer cache lines and pages on
+                                 large volumes (see gageBrick). This costs
+                                 a copy of the volume, and only affects
+                                 pervolumes attached after it is set; the
+                                 copy does not track later changes to the
+                                 values in nin->data */
 } gageParm;
 
 /*
@@ -778,8 +789,43 @@ typedef struct gageContext_t {
      value is NOT meaningfully set if there is no clamping, and the probe
      location as fallen outside the volume */
   double edgeFrac;
+
+  /* how the pervolume iv3 caches were (or weren't) updated by gageProbe:
+     iv3HitNum is the number of probes that re-used all the caches as is,
+     iv3FillNum and iv3ShiftNum count the individual pervolume caches that
+     were completely filled, or shifted (with only one face loaded). These
+     are zeroed by gageContextNew, gageContextCopy, and gageIv3CountReset */
+  size_t iv3HitNum, iv3FillNum, iv3ShiftNum;
 } gageContext;
 
+/*
+******** gageBrick struct
+**
+** a copy of a pervolume's data, re-laid out as cubical bricks of
+** edge^3 samples (in nin->type, with each sample's tuple of valLen values
+** still contiguous).  Samples within a brick are in x-fastest order, as
+** are the bricks themselves.  The last brick along each axis is padded
+** out to full size, but the padding is never read.  A brick is created
+** by gagePerVolumeAttach (when ctx->parm.brickSize is set), and shared
+** (by reference count) among the copies of that pervolume made by
+** gageContextCopy.  The brick is a snapshot of nin->data at the time of
+** attachment: later changes to the values in nin->data are NOT seen by
+** probing, so a new pervolume has to be made and attached after such
+** changes.
+*/
+typedef struct {
+  unsigned int edge,          /* samples along each edge of a brick */
+    shift,                    /* log_2(edge) */
+    mask,                     /* edge - 1 */
+    bnum[3];                  /* number of bricks along each axis */
+  size_t tupleSize;           /* bytes per sample (valLen*type size) */
+  char *data;                 /* all the bricks */
+  unsigned int refCount;      /* number of pervolumes using this */
+  airThreadMutex *refMutex;   /* guards refCount, since copies of the
+                                 pervolume may be nixed from different
+                                 threads */
+} gageBrick;
+
 /*
 ******** gagePerVolume
 **
@@ -816,6 +862,14 @@ typedef struct gagePerVolume_t {
                                  so there is no channel for extra info to be
                                  passed into the pvl->data, other that what
                                  was put into kind->data */
+  unsigned int iv3Idx[3];     /* the ctx->point.idx[0,1,2] for which iv3 was
+                                 last filled, or all UINT_MAX if iv3 has
+                                 not been filled since the last gageUpdate.
+                                 When the probe moves by one voxel along one
+                                 axis, the iv3 is shifted, and only the new
+                                 face of the neighborhood is loaded */
+  gageBrick *brick;           /* if non-NULL, the bricked copy of nin->data
+                                 from which the iv3 is filled */
 } gagePerVolume;
 
 /*
@@ -946,6 +1000,22 @@ typedef struct {
                             doing spatial as opposed to frequency-space
                             blurring), the diffusion is done iteratively, with
                             steps in diffusion time of goodSigmaMax^2 */
+  int cascade;           /* (only with nrrdKernelGaussian) instead of blurring
+                            every level from the input volume, blur level i+1
+                            from level i, with the incremental sigma
+                            sqrt(sigma[i+1]^2 - sigma[i]^2) (as is always
+                            done with nrrdKernelDiscreteGaussian).  Faster
+                            with many levels, but the result is only close
+                            to that of direct blurring: the sampled Gaussian
+                            is not exactly a semigroup at small sigma, and
+                            (other than with the wrap boundary) values within
+                            a few sigma of the volume boundary differ */
+  unsigned int threadNum;/* number of threads for spatial-domain blurring.
+                            Independent levels are handed out one at a time.
+                            Cascaded (or discrete-Gaussian) levels are each
+                            blurred from the one before, so they are done
+                            in order by one thread; the result never
+                            depends on threadNum */
 } gageStackBlurParm;
 
 /*
@@ -1050,6 +1120,7 @@ GAGE_EXPORT double gageDefStackNormalizeDerivBias;
 GAGE_EXPORT int gageDefOrientationFromSpacing;
 GAGE_EXPORT int gageDefGenerateErrStr;
 GAGE_EXPORT int gageDefTwoDimZeroZ;
+GAGE_EXPORT int gageDefBrickSize;
 
 /* miscGage.c */
 GAGE_EXPORT const int gagePresent;
@@ -1238,6 +1309,10 @@ GAGE_EXPORT int gageStackBlurParmNeedSpatialBlurSet(gageStackBlurParm *sbp,
                                                     int sblur);
 GAGE_EXPORT int gageStackBlurParmVerboseSet(gageStackBlurParm *sbp,
                                             int verbose);
+GAGE_EXPORT int gageStackBlurParmCascadeSet(gageStackBlurParm *sbp,
+                                           int cascade);
+GAGE_EXPORT int gageStackBlurParmThreadNumSet(gageStackBlurParm *sbp,
+                                              unsigned int threadNum);
 GAGE_EXPORT int gageStackBlurParmOneDimSet(gageStackBlurParm *sbp,
                                            int oneDim);
 GAGE_EXPORT int gageStackBlurParmCheck(const gageStackBlurParm *sbp);
@@ -1280,6 +1355,7 @@ GAGE_EXPORT void gageKernelReset(gageContext *ctx);
 GAGE_EXPORT int gageProbe(gageContext *ctx, double xi, double yi, double zi);
 GAGE_EXPORT int gageProbeSpace(gageContext *ctx, double x, double y, double z,
                                int indexSpace, int clamp);
+GAGE_EXPORT void gageIv3CountReset(gageContext *ctx);
 
 /* update.c */
 GAGE_EXPORT int gageUpdate(gageContext *ctx);
@@ -62,6 +62,22 @@ extern void _gagePrint_fslw(FILE *, gageContext *ctx);
 extern int _gageLocationSet(gageContext *ctx,
                             double x, double y, double z, double s);
 
+/* brick.c */
+/* index (in samples) of (xx,yy,zz) within gageBrick bk */
+#define _GAGE_BRICK_INDEX(bk, xx, yy, zz)                                  \
+  (((AIR_CAST(size_t, (xx) >> (bk)->shift)                                 \
+     + (bk)->bnum[0]*(AIR_CAST(size_t, (yy) >> (bk)->shift)                \
+                      + (bk)->bnum[1]*AIR_CAST(size_t, (zz) >> (bk)->shift))) \
+    << (3*(bk)->shift))                                                    \
+   + ((xx) & (bk)->mask)                                                   \
+   + (AIR_CAST(size_t, (yy) & (bk)->mask) << (bk)->shift)                  \
+   + (AIR_CAST(size_t, (zz) & (bk)->mask) << (2*(bk)->shift)))
+extern gageBrick *_gageBrickNew(const Nrrd *nin, const gageShape *shape,
+                                unsigned int valLen, unsigned int edge);
+extern gageBrick *_gageBrickRef(gageBrick *brick);
+extern gageBrick *_gageBrickNix(gageBrick *brick);
+extern void _gageBrickIv3Fill(gageContext *ctx, gagePerVolume *pvl);
+
 /* stack.c */
 extern int _gageStackBaseIv3Fill(gageContext *ctx);
 
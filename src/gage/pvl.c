@@ -96,6 +96,8 @@ gagePerVolumeNew(gageContext *ctx, const Nrrd *nin, const gageKind *kind) {
     pvl->flag[ii] = AIR_FALSE;
   }
   pvl->iv3 = pvl->iv2 = pvl->iv1 = NULL;
+  ELL_3V_SET(pvl->iv3Idx, UINT_MAX, UINT_MAX, UINT_MAX);
+  pvl->brick = NULL;
   pvl->lup = nrrdDLookup[nin->type];
   pvl->answer = AIR_CALLOC(gageKindTotalAnswerLength(kind), double);
   airMopAdd(mop, pvl->answer, airFree, airMopOnError);
@@ -149,6 +151,7 @@ _gagePerVolumeCopy(gagePerVolume *pvl, unsigned int fd) {
   nvl->iv3 = AIR_CALLOC(fd*fd*fd*nvl->kind->valLen, double);
   nvl->iv2 = AIR_CALLOC(fd*fd*nvl->kind->valLen, double);
   nvl->iv1 = AIR_CALLOC(fd*nvl->kind->valLen, double);
+  ELL_3V_SET(nvl->iv3Idx, UINT_MAX, UINT_MAX, UINT_MAX);
   airMopAdd(mop, nvl->iv3, airFree, airMopOnError);
   airMopAdd(mop, nvl->iv2, airFree, airMopOnError);
   airMopAdd(mop, nvl->iv1, airFree, airMopOnError);
@@ -177,6 +180,8 @@ _gagePerVolumeCopy(gagePerVolume *pvl, unsigned int fd) {
   } else {
     nvl->data = NULL;
   }
+  /* the (read-only) brick is shared with the original */
+  nvl->brick = _gageBrickRef(nvl->brick);
 
   airMopOkay(mop);
   return nvl;
@@ -199,6 +204,7 @@ gagePerVolumeNix(gagePerVolume *pvl) {
     pvl->iv3 = (double *)airFree(pvl->iv3);
     pvl->iv2 = (double *)airFree(pvl->iv2);
     pvl->iv1 = (double *)airFree(pvl->iv1);
+    pvl->brick = _gageBrickNix(pvl->brick);
     pvl->answer = (double *)airFree(pvl->answer);
     pvl->directAnswer = (double **)airFree(pvl->directAnswer);
     airFree(pvl);
@@ -1,6 +1,7 @@
 # This variable will help provide a master list of all the sources.
 # Add new source files here.
 set(GAGE_SOURCES
+  brick.c
   ctx.c
   deconvolve.c
   defaultsGage.c
@@ -91,6 +91,8 @@ gageStackBlurParmInit(gageStackBlurParm *parm) {
     parm->needSpatialBlur = AIR_FALSE;
     parm->verbose = 1; /* HEY: this may be revisited */
     parm->dgGoodSigmaMax = nrrdKernelDiscreteGaussianGoodSigmaMax;
+    parm->cascade = AIR_FALSE;
+    parm->threadNum = 1;
   }
   return;
 }
@@ -181,6 +183,10 @@ gageStackBlurParmCompare(const gageStackBlurParm *aa, const char *_nameA,
      leeching in meet.  And for leeching, a difference in verbose is moot */
   /* CHECK(verbose, %d); */
   CHECK(dgGoodSigmaMax, %.17g);
+  CHECK(cascade, %d);
+  /* Likewise threadNum, which changes how the blurrings are computed,
+     but not what they are */
+  /* CHECK(threadNum, %u); */
 #undef CHECK
   if (aa->sigmaSampling != bb->sigmaSampling) {
     if (explain) {
@@ -250,6 +256,8 @@ gageStackBlurParmCopy(gageStackBlurParm *dst,
       || gageStackBlurParmBoundarySpecSet(dst, src->bspec)
       || gageStackBlurParmNeedSpatialBlurSet(dst, src->needSpatialBlur)
       || gageStackBlurParmVerboseSet(dst, src->verbose)
+      || gageStackBlurParmCascadeSet(dst, src->cascade)
+      || gageStackBlurParmThreadNumSet(dst, src->threadNum)
       || gageStackBlurParmOneDimSet(dst, src->oneDim)) {
     biffAddf(GAGE, "%s: problem setting dst parm", me);
     return 1;
@@ -493,6 +501,35 @@ gageStackBlurParmVerboseSet(gageStackBlurParm *sbp, int verbose) {
   return 0;
 }
 
+int
+gageStackBlurParmCascadeSet(gageStackBlurParm *sbp, int cascade) {
+  static const char me[]="gageStackBlurParmCascadeSet";
+
+  if (!sbp) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  sbp->cascade = cascade;
+  return 0;
+}
+
+int
+gageStackBlurParmThreadNumSet(gageStackBlurParm *sbp,
+                              unsigned int threadNum) {
+  static const char me[]="gageStackBlurParmThreadNumSet";
+
+  if (!sbp) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!threadNum) {
+    biffAddf(GAGE, "%s: need threadNum >= 1", me);
+    return 1;
+  }
+  sbp->threadNum = threadNum;
+  return 0;
+}
+
 int
 gageStackBlurParmDgGoodSigmaMaxSet(gageStackBlurParm *sbp,
                                  double dgGoodSigmaMax) {
@@ -551,6 +588,18 @@ gageStackBlurParmCheck(const gageStackBlurParm *sbp) {
   }
   /* HEY: no sanity check on kernel because there is no
      nrrdKernelSpecCheck(), but there should be! */
+  if (sbp->cascade
+      && !( nrrdKernelGaussian == sbp->kspec->kernel
+            || nrrdKernelDiscreteGaussian == sbp->kspec->kernel )) {
+    biffAddf(GAGE, "%s: can only cascade blurrings with %s or %s kernels, "
+             "not %s", me, nrrdKernelGaussian->name,
+             nrrdKernelDiscreteGaussian->name, sbp->kspec->kernel->name);
+    return 1;
+  }
+  if (!sbp->threadNum) {
+    biffAddf(GAGE, "%s: need threadNum >= 1", me);
+    return 1;
+  }
   if (nrrdBoundarySpecCheck(sbp->bspec)) {
     biffMovef(GAGE, NRRD, "%s: problem with boundary", me);
     return 1;
@@ -567,8 +616,9 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
   char *str, *mnmfS, *stok, *slast=NULL, *parmS, *eps;
   int flagSeen[256];
   double sigmaMin, sigmaMax, dggsm;
-  unsigned int sigmaNum, parmNum;
+  unsigned int sigmaNum, parmNum, threadNum;
   int haveFlags, verbose, verboseGot=AIR_FALSE, dggsmGot=AIR_FALSE,
+    threadNumGot=AIR_FALSE,
     sampling = AIR_FALSE, samplingGot=AIR_FALSE, E;
   airArray *mop, *epsArr;
   NrrdKernelSpec *kspec=NULL;
@@ -642,8 +692,9 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
          'u': uniform (in sigma) sampling
          'o': optimized (3d l2l2) sampling
          'p': need spatial blur
+         'c': cascade blurrings
       */
-      if (strchr("1ruop", *ff)) {
+      if (strchr("1ruopc", *ff)) {
         flagSeen[AIR_CAST(unsigned char, *ff)] = AIR_TRUE;
       } else {
         if (extraFlags) {
@@ -720,6 +771,14 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
           airMopError(mop); return 1;
         }
         dggsmGot = AIR_TRUE;
+      } else if (strcpy(xeq, "t=") && strstr(stok, xeq) == stok) {
+        pval = stok + strlen(xeq);
+        if (!( 1 == sscanf(pval, "%u", &threadNum) && threadNum )) {
+          biffAddf(GAGE, "%s: couldn't parse \"%s\" as threadNum >= 1",
+                   me, pval);
+          airMopError(mop); return 1;
+        }
+        threadNumGot = AIR_TRUE;
       } else {
         /* doesn't match any of the parms we know how to parse */
         if (extraParmsP) {
@@ -781,6 +840,12 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
   if (flagSeen['1']) {
     if (!E) E |= gageStackBlurParmOneDimSet(sbp, AIR_TRUE);
   }
+  if (flagSeen['c']) {
+    if (!E) E |= gageStackBlurParmCascadeSet(sbp, AIR_TRUE);
+  }
+  if (threadNumGot) {
+    if (!E) E |= gageStackBlurParmThreadNumSet(sbp, threadNum);
+  }
   /* NOT doing the final check, because if this is being called from
      hest, the caller won't have had time to set the default info in
      the sbp (like the default kernel), so it will probably look
@@ -829,12 +894,14 @@ gageStackBlurParmSprint(char str[AIR_STRLEN_LARGE],
   needFlags = (sbp->oneDim
                || sbp->renormalize
                || sbp->needSpatialBlur
+               || sbp->cascade
                || hef);
   if (needFlags) {
     strcat(out, "-");
     if (sbp->oneDim)          { strcat(out, "1"); }
     if (sbp->renormalize)     { strcat(out, "r"); }
     if (sbp->needSpatialBlur) { strcat(out, "p"); }
+    if (sbp->cascade)         { strcat(out, "c"); }
     if (hef) {
       for (fi=0; fi<256; fi++) {
         if (extraFlag[fi]) {
@@ -873,6 +940,11 @@ gageStackBlurParmSprint(char str[AIR_STRLEN_LARGE],
     strcat(out, stmp);
   }
 
+  if (sbp->threadNum > 1) {
+    sprintf(stmp, "/t=%u", sbp->threadNum);
+    strcat(out, stmp);
+  }
+
   if (sbp->kspec
       && nrrdKernelDiscreteGaussian == sbp->kspec->kernel
       && nrrdKernelDiscreteGaussianGoodSigmaMax != sbp->dgGoodSigmaMax) {
@@ -957,7 +1029,7 @@ _checkNrrd(Nrrd *const nblur[], const Nrrd *const ncheck[],
   return 0;
 }
 
-#define KVP_NUM 9
+#define KVP_NUM 10
 
 static const char
 _blurKey[KVP_NUM][AIR_STRLEN_LARGE] = {/*  0  */ "gageStackBlur",
@@ -969,16 +1041,18 @@ _blurKey[KVP_NUM][AIR_STRLEN_LARGE] = {/*  0  */ "gageStackBlur",
                                        /*  6  */ "onedim",
                                        /*  7  */ "spatialblurred",
 #define KVP_SBLUR_IDX                      7
-                                       /*  8  */ "dgGoodSigmaMax"
+                                       /*  8  */ "dgGoodSigmaMax",
 #define KVP_DGGSM_IDX                      8
-                                       /* (9 == KVP_NUM, above) */};
+                                       /*  9  */ "cascade"
+#define KVP_CASCADE_IDX                    9
+                                       /* (10 == KVP_NUM, above) */};
 
 typedef struct {
   char val[KVP_NUM][AIR_STRLEN_LARGE];
 } blurVal_t;
 
 static blurVal_t *
-_blurValAlloc(airArray *mop, gageStackBlurParm *sbp, NrrdKernelSpec *kssb,
+_blurValAlloc(airArray *mop, const gageStackBlurParm *sbp, NrrdKernelSpec *kssb,
               const Nrrd *nin, int spatialBlurred) {
   static const char me[]="_blurValAlloc";
   blurVal_t *blurVal;
@@ -1004,6 +1078,7 @@ _blurValAlloc(airArray *mop, gageStackBlurParm *sbp, NrrdKernelSpec *kssb,
     sprintf(blurVal[blIdx].val[7], "%s",
             spatialBlurred ? "true" : "false");
     sprintf(blurVal[blIdx].val[8], "%.17g", sbp->dgGoodSigmaMax);
+    sprintf(blurVal[blIdx].val[9], "true");
   }
   airMopAdd(mop, blurVal, airFree, airMopAlways);
   return blurVal;
@@ -1017,8 +1092,9 @@ _blurValAlloc(airArray *mop, gageStackBlurParm *sbp, NrrdKernelSpec *kssb,
 ** precision, the FFT can produce very low amplitude noise.
 */
 static int
-_stackBlurDiscreteGaussFFT(Nrrd *const nblur[], gageStackBlurParm *sbp,
-                           const Nrrd *nin, const gageKind *kind) {
+_stackBlurDiscreteGaussFFT(Nrrd *const nblur[], const gageStackBlurParm *sbp,
+                           const Nrrd *nin, const gageKind *kind,
+                           unsigned int blLo) {
   static const char me[]="_stackBlurDiscreteGaussFFT";
   size_t sizeAll[NRRD_DIM_MAX], *size, ii, xi, yi, zi, nn;
   Nrrd *ninC, /* complex version of input, same as input type */
@@ -1114,7 +1190,7 @@ _stackBlurDiscreteGaussFFT(Nrrd *const nblur[], gageStackBlurParm *sbp,
   */
   inFT = AIR_CAST(double *, ninFT->data);
   outFT = AIR_CAST(double *, noutFT->data);
-  for (blIdx=0; blIdx<sbp->num; blIdx++) {
+  for (blIdx=blLo; blIdx<sbp->num; blIdx++) {
     if (sbp->verbose) {
       fprintf(stderr, "%s: . . . %u/%u (scale %g, tau %g) . . . ", me,
               blIdx, sbp->num, sbp->sigma[blIdx],
@@ -1196,15 +1272,29 @@ _stackBlurDiscreteGaussFFT(Nrrd *const nblur[], gageStackBlurParm *sbp,
   return 0;
 }
 
+/*
+** _stackBlurSpatial()
+**
+** spatial-domain blurring of levels blLo through blHi-1.  When iterating
+** (with the discrete Gaussian, or when cascading with the Gaussian), each
+** level is blurred (at nrrdResample_t precision) from the one before, and
+** the first from nin.  Then the levels before blLo are also recomputed,
+** but not saved, so that levels blLo and up are the same as if all levels
+** had been blurred (the saved levels are rounded to nin's type, and
+** starting from level blLo-1 would not be).  kssb is modified here, so
+** each thread needs its own.
+*/
 static int
-_stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
+_stackBlurSpatial(Nrrd *const nblur[], const gageStackBlurParm *sbp,
                   NrrdKernelSpec *kssb,
-                  const Nrrd *nin, const gageKind *kind) {
+                  const Nrrd *nin, const gageKind *kind,
+                  unsigned int blLo, unsigned int blHi, int verbose) {
   static const char me[]="_stackBlurSpatial";
   NrrdResampleContext *rsmc;
   Nrrd *niter;
   unsigned int axi, blIdx;
   int E, iterative, rsmpType;
+  unsigned int blStart;
   double timeStepMax, /* max length of diffusion time allowed per blur,
                          as determined by sbp->dgGoodSigmaMax */
     timeDone,         /* amount of diffusion time just applied */
@@ -1214,7 +1304,8 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
   mop = airMopNew();
   rsmc = nrrdResampleContextNew();
   airMopAdd(mop, rsmc, (airMopper)nrrdResampleContextNix, airMopAlways);
-  if (nrrdKernelDiscreteGaussian == kssb->kernel) {
+  if (nrrdKernelDiscreteGaussian == kssb->kernel
+      || (sbp->cascade && nrrdKernelGaussian == kssb->kernel)) {
     iterative = AIR_TRUE;
     /* we don't want to lose precision when iterating */
     rsmpType = nrrdResample_nt;
@@ -1253,9 +1344,13 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
   }
 
   timeDone = 0;
-  timeStepMax = (sbp->dgGoodSigmaMax)*(sbp->dgGoodSigmaMax);
-  for (blIdx=0; blIdx<sbp->num; blIdx++) {
-    if (sbp->verbose) {
+  blStart = iterative ? 0 : blLo;
+  timeStepMax = (nrrdKernelDiscreteGaussian == kssb->kernel
+                 ? (sbp->dgGoodSigmaMax)*(sbp->dgGoodSigmaMax)
+                 /* the Gaussian kernel is fine with any sigma */
+                 : AIR_POS_INF);
+  for (blIdx=blStart; blIdx<blHi; blIdx++) {
+    if (verbose) {
       fprintf(stderr, "%s: . . . blurring %u / %u (scale %g) . . . ",
               me, blIdx, sbp->num, sbp->sigma[blIdx]);
       fflush(stderr);
@@ -1264,7 +1359,7 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
       double timeNow = sbp->sigma[blIdx]*sbp->sigma[blIdx];
       unsigned int passIdx = 0;
       timeLeft = timeNow - timeDone;
-      if (sbp->verbose) {
+      if (verbose) {
         fprintf(stderr, "\n");
         fprintf(stderr, "%s: scale %g == time %g (tau %g);\n"
                 "               timeLeft %g = %g - %g\n",
@@ -1278,8 +1373,8 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
       }
       do {
         double timeDo;
-        if (blIdx || passIdx) {
-          /* either we're past the first scale (blIdx >= 1), or
+        if (blIdx > blStart || passIdx) {
+          /* either we're past the first scale (blIdx > blStart), or
              (unlikely) we're on the first scale but after the first
              pass of a multi-pass blurring, so we have to feed the
              previous result back in as input.
@@ -1316,7 +1411,7 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
                                                nrrdKernelBox, boxparm);
           }
         }
-        if (sbp->verbose) {
+        if (verbose) {
           fprintf(stderr, "  pass %u (timeLeft=%g => "
                   "time=%g, sigma=%g) ...\n",
                   passIdx, timeLeft, timeDo, kssb->parm[0]);
@@ -1343,10 +1438,12 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
          in nrrd/resampleContext.c), since we've gently hijacked
          the resampling to access the nrrdResample_t blurring
          result (for further blurring) */
-      if (!E) E |= nrrdCastClampRound(nblur[blIdx], niter, nin->type,
-                                      AIR_TRUE,
-                                      nrrdTypeIsIntegral[nin->type]);
-      if (!E) E |= nrrdContentSet_va(nblur[blIdx], "blur", nin, "");
+      if (blIdx >= blLo) {
+        if (!E) E |= nrrdCastClampRound(nblur[blIdx], niter, nin->type,
+                                        AIR_TRUE,
+                                        nrrdTypeIsIntegral[nin->type]);
+        if (!E) E |= nrrdContentSet_va(nblur[blIdx], "blur", nin, "");
+      }
       timeDone = timeNow;
     } else { /* do blurring in one shot */
       kssb->parm[0] = sbp->sigma[blIdx];
@@ -1358,14 +1455,14 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
       if (!E) E |= nrrdResampleExecute(rsmc, nblur[blIdx]);
     }
     if (E) {
-      if (sbp->verbose) {
+      if (verbose) {
         fprintf(stderr, "problem!\n");
       }
       biffMovef(GAGE, NRRD, "%s: trouble w/ %u of %u (scale %g)",
                 me, blIdx, sbp->num, sbp->sigma[blIdx]);
       airMopError(mop); return 1;
     }
-    if (sbp->verbose) {
+    if (verbose) {
       fprintf(stderr, "  done.\n");
     }
   } /* for blIdx */
@@ -1375,35 +1472,174 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
 }
 
 /*
-** little helper function to do pre-blurring of a given nrrd
-** of the sort that might be useful for scale-space gage use
+** levels are blurred one from the next, and so can't be done
+** concurrently; see _stackBlurSpatial
+*/
+static int
+_stackBlurIterative(const gageStackBlurParm *sbp) {
+  return (nrrdKernelDiscreteGaussian == sbp->kspec->kernel
+          || (sbp->cascade && nrrdKernelGaussian == sbp->kspec->kernel));
+}
+
+typedef struct {
+  Nrrd *const *nblur;
+  const gageStackBlurParm *sbp;
+  const Nrrd *nin;
+  const gageKind *kind;
+  NrrdKernelSpec *kssb;          /* this thread's own copy */
+  unsigned int levelHi,          /* one past the last level to blur */
+    *levelNext;                  /* next level to hand out */
+  int *abort;
+  airThreadMutex *mutex;
+  unsigned int threadIdx;
+  int error;
+} _stackBlurTask;
+
+static void *
+_stackBlurWorker(void *_task) {
+  static const char me[]="_stackBlurWorker";
+  _stackBlurTask *task;
+  unsigned int blIdx;
+
+  task = AIR_CAST(_stackBlurTask *, _task);
+  while (1) {
+    airThreadMutexLock(task->mutex);
+    if (*(task->abort)) {
+      blIdx = task->levelHi;
+    } else {
+      blIdx = *(task->levelNext);
+      if (blIdx < task->levelHi) {
+        *(task->levelNext) += 1;
+      }
+    }
+    airThreadMutexUnlock(task->mutex);
+    if (blIdx == task->levelHi) {
+      break;
+    }
+    if (_stackBlurSpatial(task->nblur, task->sbp, task->kssb,
+                          task->nin, task->kind, blIdx, blIdx+1,
+                          AIR_FALSE)) {
+      /* biff is not thread-safe, so add to it only under the mutex */
+      airThreadMutexLock(task->mutex);
+      biffAddf(GAGE, "%s(%u): trouble blurring level %u", me,
+               task->threadIdx, blIdx);
+      task->error = AIR_TRUE;
+      *(task->abort) = AIR_TRUE;
+      airThreadMutexUnlock(task->mutex);
+      return _task;
+    }
+    if (task->sbp->verbose) {
+      airThreadMutexLock(task->mutex);
+      fprintf(stderr, "%s(%u): blurred level %u\n", me,
+              task->threadIdx, blIdx);
+      airThreadMutexUnlock(task->mutex);
+    }
+  }
+  return _task;
+}
+
+/*
+** _stackBlurSpatialThreaded()
 **
-** nblur has to already be allocated for "blNum" Nrrd*s, AND, they all
-** have to point to valid (possibly empty) Nrrds, so they can hold the
-** results of blurring
+** spatial blurring of levels blLo through sbp->num-1 with (up to)
+** sbp->threadNum threads, which are handed the levels one at a time.
+** Levels that are blurred one from the next (_stackBlurIterative) are
+** done in order by one thread, so that the result never depends on the
+** number of threads.
 */
-int
-gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
-              const Nrrd *nin, const gageKind *kind) {
-  static const char me[]="gageStackBlur";
+static int
+_stackBlurSpatialThreaded(Nrrd *const nblur[], const gageStackBlurParm *sbp,
+                          const NrrdKernelSpec *kssb, const Nrrd *nin,
+                          const gageKind *kind, unsigned int blLo) {
+  static const char me[]="_stackBlurSpatialThreaded";
+  unsigned int threadNum, threadIdx, levelNext, levelNum, failIdx;
+  _stackBlurTask *task;
+  airThreadMutex *mutex;
+  airArray *mop;
+  int abort, hadErr;
+
+  mop = airMopNew();
+  levelNum = sbp->num - blLo;
+  threadNum = (airThreadCapable && !_stackBlurIterative(sbp)
+               ? AIR_MIN(sbp->threadNum, levelNum)
+               : 1);
+  if (1 == threadNum) {
+    NrrdKernelSpec *kcopy;
+    kcopy = nrrdKernelSpecCopy(kssb);
+    airMopAdd(mop, kcopy, (airMopper)nrrdKernelSpecNix, airMopAlways);
+    if (_stackBlurSpatial(nblur, sbp, kcopy, nin, kind, blLo, sbp->num,
+                          sbp->verbose)) {
+      biffAddf(GAGE, "%s: trouble", me);
+      airMopError(mop); return 1;
+    }
+    airMopOkay(mop);
+    return 0;
+  }
+  task = AIR_CALLOC(threadNum, _stackBlurTask);
+  if (!task) {
+    biffAddf(GAGE, "%s: couldn't allocate %u tasks", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  mutex = airThreadMutexNew();
+  airMopAdd(mop, mutex, (airMopper)airThreadMutexNix, airMopAlways);
+  levelNext = blLo;
+  abort = AIR_FALSE;
+  for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+    task[threadIdx].nblur = nblur;
+    task[threadIdx].sbp = sbp;
+    task[threadIdx].nin = nin;
+    task[threadIdx].kind = kind;
+    task[threadIdx].kssb = nrrdKernelSpecCopy(kssb);
+    airMopAdd(mop, task[threadIdx].kssb, (airMopper)nrrdKernelSpecNix,
+              airMopAlways);
+    task[threadIdx].levelHi = sbp->num;
+    task[threadIdx].levelNext = &levelNext;
+    task[threadIdx].abort = &abort;
+    task[threadIdx].mutex = mutex;
+    task[threadIdx].threadIdx = threadIdx;
+    task[threadIdx].error = AIR_FALSE;
+  }
+  if (sbp->verbose) {
+    fprintf(stderr, "%s: blurring %u levels with %u threads\n",
+            me, levelNum, threadNum);
+  }
+  failIdx = airThreadRun(threadNum, _stackBlurWorker, task,
+                         sizeof(_stackBlurTask), &abort, mutex);
+  if (failIdx) {
+    biffAddf(GAGE, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
+  hadErr = AIR_FALSE;
+  for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+    hadErr |= task[threadIdx].error;
+  }
+  if (hadErr) {
+    biffAddf(GAGE, "%s: trouble blurring with %u threads", me, threadNum);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** _stackBlurRange()
+**
+** gageStackBlur() for levels blLo through sbp->num-1 only (the others
+** are not touched)
+*/
+static int
+_stackBlurRange(Nrrd *const nblur[], const gageStackBlurParm *sbp,
+                const Nrrd *nin, const gageKind *kind, unsigned int blLo) {
+  static const char me[]="_stackBlurRange";
   unsigned int blIdx, kvpIdx;
   NrrdKernelSpec *kssb;
   blurVal_t *blurVal;
   airArray *mop;
   int E, fftable, spatialBlurred;
 
-  if (!(nblur && sbp && nin && kind)) {
-    biffAddf(GAGE, "%s: got NULL pointer", me);
-    return 1;
-  }
-  if (gageStackBlurParmCheck(sbp)) {
-    biffAddf(GAGE, "%s: problem with parms", me);
-    return 1;
-  }
-  if (_checkNrrd(nblur, NULL, sbp->num, AIR_FALSE, nin, kind)) {
-    biffAddf(GAGE, "%s: problem with input ", me);
-    return 1;
-  }
   mop = airMopNew();
   kssb = nrrdKernelSpecCopy(sbp->kspec);
   airMopAdd(mop, kssb, (airMopper)nrrdKernelSpecNix, airMopAlways);
@@ -1413,7 +1649,7 @@ gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
              && nrrdKernelDiscreteGaussian == sbp->kspec->kernel);
   if (fftable && nrrdFFTWEnabled) {
     /* go directly to FFT-based blurring */
-    if (_stackBlurDiscreteGaussFFT(nblur, sbp, nin, kind)) {
+    if (_stackBlurDiscreteGaussFFT(nblur, sbp, nin, kind, blLo)) {
       biffAddf(GAGE, "%s: trouble with frequency-space blurring", me);
       airMopError(mop); return 1;
     }
@@ -1435,7 +1671,7 @@ gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
                 sbp->needSpatialBlur ? "yes" : "no", bstr, kstr);
       }
     }
-    if (_stackBlurSpatial(nblur, sbp, kssb, nin, kind)) {
+    if (_stackBlurSpatialThreaded(nblur, sbp, kssb, nin, kind, blLo)) {
       biffAddf(GAGE, "%s: trouble with spatial-domain blurring", me);
       airMopError(mop); return 1;
     }
@@ -1447,12 +1683,11 @@ gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
     airMopError(mop); return 1;
   }
   E = 0;
-  for (blIdx=0; blIdx<sbp->num; blIdx++) {
+  for (blIdx=blLo; blIdx<sbp->num; blIdx++) {
     for (kvpIdx=0; kvpIdx<KVP_NUM; kvpIdx++) {
-      if (KVP_DGGSM_IDX != kvpIdx) {
-        if (!E) E |= nrrdKeyValueAdd(nblur[blIdx], _blurKey[kvpIdx],
-                                     blurVal[blIdx].val[kvpIdx]);
-      } else {
+      /* in case nblur[blIdx] was loaded with different KVPs */
+      nrrdKeyValueErase(nblur[blIdx], _blurKey[kvpIdx]);
+      if (KVP_DGGSM_IDX == kvpIdx) {
         /* only need to save dgGoodSigmaMax if it was spatially blurred
            with the discrete gaussian kernel */
         if (spatialBlurred
@@ -1460,6 +1695,15 @@ gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
           if (!E) E |= nrrdKeyValueAdd(nblur[blIdx], _blurKey[kvpIdx],
                                        blurVal[blIdx].val[kvpIdx]);
         }
+      } else if (KVP_CASCADE_IDX == kvpIdx) {
+        /* only saved if cascading changed the result */
+        if (sbp->cascade && nrrdKernelGaussian == kssb->kernel) {
+          if (!E) E |= nrrdKeyValueAdd(nblur[blIdx], _blurKey[kvpIdx],
+                                       blurVal[blIdx].val[kvpIdx]);
+        }
+      } else {
+        if (!E) E |= nrrdKeyValueAdd(nblur[blIdx], _blurKey[kvpIdx],
+                                     blurVal[blIdx].val[kvpIdx]);
       }
     }
   }
@@ -1473,31 +1717,60 @@ gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
 }
 
 /*
-******** gageStackBlurCheck
-**
-** (docs)
+** little helper function to do pre-blurring of a given nrrd
+** of the sort that might be useful for scale-space gage use
 **
+** nblur has to already be allocated for "blNum" Nrrd*s, AND, they all
+** have to point to valid (possibly empty) Nrrds, so they can hold the
+** results of blurring
 */
 int
-gageStackBlurCheck(const Nrrd *const nblur[],
-                   gageStackBlurParm *sbp,
-                   const Nrrd *nin, const gageKind *kind) {
-  static const char me[]="gageStackBlurCheck";
+gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
+              const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="gageStackBlur";
+
+  if (!(nblur && sbp && nin && kind)) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (gageStackBlurParmCheck(sbp)) {
+    biffAddf(GAGE, "%s: problem with parms", me);
+    return 1;
+  }
+  if (_checkNrrd(nblur, NULL, sbp->num, AIR_FALSE, nin, kind)) {
+    biffAddf(GAGE, "%s: problem with input ", me);
+    return 1;
+  }
+  if (_stackBlurRange(nblur, sbp, nin, kind, 0)) {
+    biffAddf(GAGE, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** _stackBlurCheck()
+**
+** gageStackBlurCheck() for the first blNum levels; *goodNumP is set to
+** the number of levels, from the start, that passed the check
+*/
+static int
+_stackBlurCheck(const Nrrd *const nblur[], unsigned int blNum,
+                unsigned int *goodNumP, const gageStackBlurParm *sbp,
+                const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_stackBlurCheck";
   gageShape *shapeOld, *shapeNew;
   blurVal_t *blurVal;
   airArray *mop;
   unsigned int blIdx, kvpIdx;
   NrrdKernelSpec *kssb;
 
-  if (!(nblur && sbp && nin && kind)) {
-    biffAddf(GAGE, "%s: got NULL pointer", me);
-    return 1;
-  }
+  *goodNumP = 0;
   mop = airMopNew();
   kssb = nrrdKernelSpecCopy(sbp->kspec);
   airMopAdd(mop, kssb, (airMopper)nrrdKernelSpecNix, airMopAlways);
   if (gageStackBlurParmCheck(sbp)
-      || _checkNrrd(NULL, nblur, sbp->num, AIR_TRUE, nin, kind)
+      || _checkNrrd(NULL, nblur, blNum, AIR_TRUE, nin, kind)
       || (!( blurVal = _blurValAlloc(mop, sbp, kssb, nin,
                                      (sbp->needSpatialBlur
                                       ? AIR_TRUE
@@ -1515,7 +1788,8 @@ gageStackBlurCheck(const Nrrd *const nblur[],
   shapeOld = gageShapeNew();
   airMopAdd(mop, shapeOld, (airMopper)gageShapeNix, airMopAlways);
 
-  for (blIdx=0; blIdx<sbp->num; blIdx++) {
+  for (blIdx=0; blIdx<blNum; blIdx++) {
+    *goodNumP = blIdx;
     if (nin->type != nblur[blIdx]->type) {
       biffAddf(GAGE, "%s: nblur[%u]->type %s != nin type %s\n", me,
                blIdx, airEnumStr(nrrdType, nblur[blIdx]->type),
@@ -1534,6 +1808,19 @@ gageStackBlurCheck(const Nrrd *const nblur[],
       char *tmpval;
       tmpval = nrrdKeyValueGet(nblur[blIdx], _blurKey[kvpIdx]);
       airMopAdd(mop, tmpval, airFree, airMopAlways);
+      if (KVP_CASCADE_IDX == kvpIdx) {
+        /* this KVP is present only if cascading changed the result,
+           so its presence has to match what we want */
+        int want;
+        want = (sbp->cascade && nrrdKernelGaussian == sbp->kspec->kernel);
+        if (want != !!tmpval) {
+          biffAddf(GAGE, "%s: nblur[%u] %s cascaded, but want %s", me,
+                   blIdx, tmpval ? "was" : "wasn't",
+                   want ? "cascaded" : "not cascaded");
+          airMopError(mop); return 1;
+        }
+        continue;
+      }
       if (KVP_DGGSM_IDX != kvpIdx) {
         if (!tmpval) {
           biffAddf(GAGE, "%s: didn't see key \"%s\" in nblur[%u]", me,
@@ -1578,21 +1865,49 @@ gageStackBlurCheck(const Nrrd *const nblur[],
       }
     }
   }
+  *goodNumP = blNum;
 
   airMopOkay(mop);
   return 0;
 }
 
+/*
+******** gageStackBlurCheck
+**
+** (docs)
+**
+*/
 int
-gageStackBlurGet(Nrrd *const nblur[], int *recomputedP,
-                 gageStackBlurParm *sbp,
-                 const char *format,
-                 const Nrrd *nin, const gageKind *kind) {
-  static const char me[]="gageStackBlurGet";
-  airArray *mop;
-  int recompute;
-  unsigned int ii;
+gageStackBlurCheck(const Nrrd *const nblur[],
+                   gageStackBlurParm *sbp,
+                   const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="gageStackBlurCheck";
+  unsigned int goodNum;
 
+  if (!(nblur && sbp && nin && kind)) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (_stackBlurCheck(nblur, sbp->num, &goodNum, sbp, nin, kind)) {
+    biffAddf(GAGE, "%s: problem", me);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** _stackBlurGet()
+**
+** gageStackBlurGet(), which also says (in *reuseNumP) how many of the
+** levels, from the start, were loaded from files rather than recomputed
+*/
+static int
+_stackBlurGet(Nrrd *const nblur[], unsigned int *reuseNumP,
+              gageStackBlurParm *sbp, const char *format,
+              const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_stackBlurGet";
+  airArray *mop;
+  unsigned int ii, loadNum, reuseNum;
 
   if (!( nblur && sbp && nin && kind )) {
     biffAddf(GAGE, "%s: got NULL pointer", me);
@@ -1610,16 +1925,15 @@ gageStackBlurGet(Nrrd *const nblur[], int *recomputedP,
   }
   mop = airMopNew();
 
-  /* set recompute flag */
+  /* learn how many levels, from the start, can be re-used */
+  reuseNum = 0;
   if (!airStrlen(format)) {
     /* no info about files to load, obviously have to recompute */
     if (sbp->verbose) {
       fprintf(stderr, "%s: no file info, must recompute blurrings\n", me);
     }
-    recompute = AIR_TRUE;
   } else {
     char *fname, *suberr;
-    int firstExists;
     FILE *file;
     /* do have info about files to load, but may fail in many ways */
     fname = AIR_CALLOC(strlen(format) + AIR_STRLEN_SMALL, char);
@@ -1628,60 +1942,94 @@ gageStackBlurGet(Nrrd *const nblur[], int *recomputedP,
       airMopError(mop); return 1;
     }
     airMopAdd(mop, fname, airFree, airMopAlways);
-    /* see if we can get the first file (number 0) */
-    sprintf(fname, format, 0);
-    firstExists = !!(file = fopen(fname, "r"));
-    airFclose(file);
-    if (!firstExists) {
-      if (sbp->verbose) {
-        fprintf(stderr, "%s: no file \"%s\"; will recompute blurrings\n",
-                me, fname);
-      }
-      recompute = AIR_TRUE;
-    } else if (nrrdLoadMulti(nblur, sbp->num, format, 0, NULL)) {
-      airMopAdd(mop, suberr = biffGetDone(NRRD), airFree, airMopAlways);
-      if (sbp->verbose) {
-        fprintf(stderr, "%s: will recompute blurrings that couldn't be "
-                "read:\n%s\n", me, suberr);
+    for (loadNum=0; loadNum<sbp->num; loadNum++) {
+      sprintf(fname, format, loadNum);
+      if (!(file = fopen(fname, "r"))) {
+        if (sbp->verbose) {
+          fprintf(stderr, "%s: no file \"%s\"; will recompute blurrings "
+                  "from there\n", me, fname);
+        }
+        break;
       }
-      recompute = AIR_TRUE;
-    } else if (gageStackBlurCheck(AIR_CAST(const Nrrd*const*, nblur),
-                                  sbp, nin, kind)) {
-      airMopAdd(mop, suberr = biffGetDone(GAGE), airFree, airMopAlways);
-      if (sbp->verbose) {
-        fprintf(stderr, "%s: will recompute blurrings (from \"%s\") "
-                "that don't match:\n%s\n", me, format, suberr);
+      airFclose(file);
+      if (nrrdLoad(nblur[loadNum], fname, NULL)) {
+        airMopAdd(mop, suberr = biffGetDone(NRRD), airFree, airMopAlways);
+        if (sbp->verbose) {
+          fprintf(stderr, "%s: will recompute blurrings from \"%s\", "
+                  "which couldn't be read:\n%s\n", me, fname, suberr);
+        }
+        break;
       }
-      recompute = AIR_TRUE;
-    } else {
-      /* else precomputed blurrings could all be read, and did match */
-      if (sbp->verbose) {
-        fprintf(stderr, "%s: will reuse %u %s pre-blurrings.\n", me,
-                sbp->num, format);
+    }
+    if (loadNum) {
+      if (_stackBlurCheck(AIR_CAST(const Nrrd*const*, nblur), loadNum,
+                          &reuseNum, sbp, nin, kind)) {
+        airMopAdd(mop, suberr = biffGetDone(GAGE), airFree, airMopAlways);
+        if (sbp->verbose) {
+          fprintf(stderr, "%s: will recompute blurrings (from \"%s\") "
+                  "from level %u, which doesn't match:\n%s\n", me, format,
+                  reuseNum, suberr);
+        }
       }
-      recompute = AIR_FALSE;
+    }
+    if (reuseNum && sbp->verbose) {
+      fprintf(stderr, "%s: will reuse %u of %u %s pre-blurrings.\n", me,
+              reuseNum, sbp->num, format);
     }
   }
-  if (recompute) {
-    if (gageStackBlur(nblur, sbp, nin, kind)) {
+  if (reuseNum < sbp->num) {
+    if (_stackBlurRange(nblur, sbp, nin, kind, reuseNum)) {
       biffAddf(GAGE, "%s: trouble computing blurrings", me);
       airMopError(mop); return 1;
     }
   }
-  if (recomputedP) {
-    *recomputedP = recompute;
-  }
+  *reuseNumP = reuseNum;
 
   airMopOkay(mop);
   return 0;
 }
 
+/*
+******** gageStackBlurGet
+**
+** loads the blurrings from the files named by format (as a sprintf
+** format with "%u"), and checks them against the given parameters;
+** levels (after the last good one at the start of the stack) which are
+** missing or don't match are recomputed. *recomputedP is set to non-zero
+** if any levels were recomputed.
+**
+** NOTE: with cascaded blurring or the discrete Gaussian kernel, level i
+** is computed from level i-1, at full precision, so recomputing from
+** level i starts again from level 0 (only levels i and up are saved
+** into nblur).  Reusing a prefix of the stack from disk then saves only
+** the I/O of those levels, not their computation.
+*/
+int
+gageStackBlurGet(Nrrd *const nblur[], int *recomputedP,
+                 gageStackBlurParm *sbp,
+                 const char *format,
+                 const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="gageStackBlurGet";
+  unsigned int reuseNum;
+
+  if (_stackBlurGet(nblur, &reuseNum, sbp, format, nin, kind)) {
+    biffAddf(GAGE, "%s: trouble", me);
+    return 1;
+  }
+  if (recomputedP) {
+    *recomputedP = (reuseNum < sbp->num);
+  }
+  return 0;
+}
+
 /*
 ******** gageStackBlurManage
 **
 ** does the work of gageStackBlurGet and then some:
 ** allocates the array of Nrrds, allocates an array of doubles for scale,
-** and saves output if recomputed
+** and saves output (of the levels that were) if recomputed.  As with
+** gageStackBlurGet, for cascaded or discrete Gaussian blurring, any
+** recomputation redoes all the levels before it too.
 */
 int
 gageStackBlurManage(Nrrd ***nblurP, int *recomputedP,
@@ -1691,7 +2039,7 @@ gageStackBlurManage(Nrrd ***nblurP, int *recomputedP,
                     const Nrrd *nin, const gageKind *kind) {
   static const char me[]="gageStackBlurManage";
   Nrrd **nblur;
-  unsigned int ii;
+  unsigned int ii, reuseNum;
   airArray *mop;
   int recomputed;
 
@@ -1712,10 +2060,11 @@ gageStackBlurManage(Nrrd ***nblurP, int *recomputedP,
     nblur[ii] = nrrdNew();
     airMopAdd(mop, nblur[ii], (airMopper)nrrdNuke, airMopOnError);
   }
-  if (gageStackBlurGet(nblur, &recomputed, sbp, format, nin, kind)) {
+  if (_stackBlurGet(nblur, &reuseNum, sbp, format, nin, kind)) {
     biffAddf(GAGE, "%s: trouble getting nblur", me);
     airMopError(mop); return 1;
   }
+  recomputed = (reuseNum < sbp->num);
   if (recomputedP) {
     *recomputedP = recomputed;
   }
@@ -1735,9 +2084,10 @@ gageStackBlurManage(Nrrd ***nblurP, int *recomputedP,
     } else {
       nio = NULL;
     }
+    /* the re-used levels are already there */
     if (!E) E |= nrrdSaveMulti(format, AIR_CAST(const Nrrd *const *,
-                                                nblur),
-                               sbp->num, 0, nio);
+                                                nblur + reuseNum),
+                               sbp->num - reuseNum, reuseNum, nio);
     if (E) {
       biffMovef(GAGE, NRRD, "%s: trouble saving blurrings", me);
       airMopError(mop); return 1;
@@ -0,0 +1,204 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "../gage.h"
+
+static const char *brickbenchInfo =
+  ("times gageProbe of value and gradient with and without bricking "
+   "(gageParmBrickSize), for random probe locations and for locations "
+   "along rays, and checks that the answers are the same");
+
+/* sets up ctx to probe value and gradient of nin */
+static int
+setup(gageContext *ctx, gagePerVolume **pvlP, const Nrrd *nin,
+      int brickSize, const NrrdKernelSpec *k00, const NrrdKernelSpec *k11) {
+  int E;
+
+  gageParmSet(ctx, gageParmBrickSize, brickSize);
+  E = 0;
+  if (!E) E |= !(*pvlP = gagePerVolumeNew(ctx, nin, gageKindScl));
+  if (!E) E |= gagePerVolumeAttach(ctx, *pvlP);
+  if (!E) E |= gageKernelSet(ctx, gageKernel00, k00->kernel, k00->parm);
+  if (!E) E |= gageKernelSet(ctx, gageKernel11, k11->kernel, k11->parm);
+  if (!E) E |= gageQueryItemOn(ctx, *pvlP, gageSclValue);
+  if (!E) E |= gageQueryItemOn(ctx, *pvlP, gageSclGradVec);
+  if (!E) E |= gageUpdate(ctx);
+  return E;
+}
+
+/* probes at all num locations in pos, saves answers in ans, returns time */
+static double
+probeLoop(double *ans, gageContext *ctx, gagePerVolume *pvl,
+          const double *pos, size_t num) {
+  const double *val, *grad;
+  double time0;
+  size_t II;
+
+  val = gageAnswerPointer(ctx, pvl, gageSclValue);
+  grad = gageAnswerPointer(ctx, pvl, gageSclGradVec);
+  time0 = airTime();
+  for (II=0; II<num; II++) {
+    gageProbe(ctx, pos[0 + 3*II], pos[1 + 3*II], pos[2 + 3*II]);
+    ans[0 + 4*II] = val[0];
+    ans[1 + 4*II] = grad[0];
+    ans[2 + 4*II] = grad[1];
+    ans[3 + 4*II] = grad[2];
+  }
+  return airTime() - time0;
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  char *err;
+  hestOpt *hopt=NULL;
+  airArray *mop;
+  Nrrd *nin;
+  NrrdKernelSpec *k00, *k11;
+  gageContext *ctxPlain, *ctxBrick;
+  gagePerVolume *pvlPlain, *pvlBrick;
+  unsigned int size, pi;
+  int brickSize;
+  size_t II, NN, probeNum, differ;
+  double *pos, *ansPlain, *ansBrick, step, tplain, tbrick;
+  float *data;
+  static const char *pattern[2] = {"random", "ray"};
+
+  me = argv[0];
+  mop = airMopNew();
+  hestOptAdd(&hopt, "s", "size", airTypeUInt, 1, 1, &size, "512",
+             "size of (cubical) input volume");
+  hestOptAdd(&hopt, "b", "brick", airTypeInt, 1, 1, &brickSize, "16",
+             "brick size to compare against no bricking");
+  hestOptAdd(&hopt, "n", "# probes", airTypeSize_t, 1, 1, &probeNum,
+             "1000000", "number of probes for each access pattern");
+  hestOptAdd(&hopt, "st", "step", airTypeDouble, 1, 1, &step, "0.5",
+             "step size (in index space) between probes along rays");
+  hestOptAdd(&hopt, "k00", "kernel", airTypeOther, 1, 1, &k00,
+             "cubic:0,0.5", "value reconstruction kernel",
+             NULL, NULL, nrrdHestKernelSpec);
+  hestOptAdd(&hopt, "k11", "kernel", airTypeOther, 1, 1, &k11,
+             "cubicd:0,0.5", "first derivative kernel",
+             NULL, NULL, nrrdHestKernelSpec);
+  hestParseOrDie(hopt, argc-1, argv+1, NULL,
+                 me, brickbenchInfo, AIR_TRUE, AIR_TRUE, AIR_TRUE);
+  airMopAdd(mop, hopt, (airMopper)hestOptFree, airMopAlways);
+  airMopAdd(mop, hopt, (airMopper)hestParseFree, airMopAlways);
+  if (!( size >= 2 && probeNum && step > 0 )) {
+    fprintf(stderr, "%s: need size >= 2, # probes > 0, step > 0\n", me);
+    airMopError(mop); return 1;
+  }
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, size),
+                        AIR_CAST(size_t, size), AIR_CAST(size_t, size))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  airSrandMT(42);
+  data = AIR_CAST(float *, nin->data);
+  NN = nrrdElementNumber(nin);
+  for (II=0; II<NN; II++) {
+    data[II] = AIR_CAST(float, sin(0.001*II) + 0.1*airDrandMT());
+  }
+
+  pos = AIR_CALLOC(3*probeNum, double);
+  airMopAdd(mop, pos, airFree, airMopAlways);
+  ansPlain = AIR_CALLOC(4*probeNum, double);
+  airMopAdd(mop, ansPlain, airFree, airMopAlways);
+  ansBrick = AIR_CALLOC(4*probeNum, double);
+  airMopAdd(mop, ansBrick, airFree, airMopAlways);
+  if (!( pos && ansPlain && ansBrick )) {
+    fprintf(stderr, "%s: couldn't allocate probe buffers\n", me);
+    airMopError(mop); return 1;
+  }
+
+  ctxPlain = gageContextNew();
+  airMopAdd(mop, ctxPlain, (airMopper)gageContextNix, airMopAlways);
+  ctxBrick = gageContextNew();
+  airMopAdd(mop, ctxBrick, (airMopper)gageContextNix, airMopAlways);
+  if (setup(ctxPlain, &pvlPlain, nin, 0, k00, k11)
+      || setup(ctxBrick, &pvlBrick, nin, brickSize, k00, k11)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up gage:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  for (pi=0; pi<2; pi++) {
+    if (!pi) {
+      /* uniformly random within the volume */
+      for (II=0; II<3*probeNum; II++) {
+        pos[II] = AIR_AFFINE(0.0, airDrandMT(), 1.0, 0.0, size-1);
+      }
+    } else {
+      /* along rays of random position and direction, each of which
+         continues until it leaves the volume */
+      double pp[3], dir[3], len;
+      II = 0;
+      while (II < probeNum) {
+        ELL_3V_SET(pp, AIR_AFFINE(0.0, airDrandMT(), 1.0, 0.0, size-1),
+                   AIR_AFFINE(0.0, airDrandMT(), 1.0, 0.0, size-1),
+                   AIR_AFFINE(0.0, airDrandMT(), 1.0, 0.0, size-1));
+        do {
+          ELL_3V_SET(dir, airDrandMT() - 0.5, airDrandMT() - 0.5,
+                     airDrandMT() - 0.5);
+          len = ELL_3V_LEN(dir);
+        } while (len < 0.01);
+        ELL_3V_SCALE(dir, step/len, dir);
+        while (II < probeNum
+               && AIR_IN_CL(0, pp[0], size-1)
+               && AIR_IN_CL(0, pp[1], size-1)
+               && AIR_IN_CL(0, pp[2], size-1)) {
+          ELL_3V_COPY(pos + 3*II, pp);
+          ELL_3V_INCR(pp, dir);
+          II++;
+        }
+      }
+    }
+    ctxPlain->iv3HitNum = ctxPlain->iv3FillNum = ctxPlain->iv3ShiftNum = 0;
+    tplain = probeLoop(ansPlain, ctxPlain, pvlPlain, pos, probeNum);
+    tbrick = probeLoop(ansBrick, ctxBrick, pvlBrick, pos, probeNum);
+    differ = 0;
+    for (II=0; II<4*probeNum; II++) {
+      differ += (ansPlain[II] != ansBrick[II]);
+    }
+    fprintf(stderr, "%s: %s (%u^3, %lu probes): unbricked %g sec; "
+            "%d-bricked %g sec (%g x); iv3 hit/shift/fill = %lu/%lu/%lu\n",
+            me, pattern[pi], size, AIR_CAST(unsigned long, probeNum),
+            tplain, brickSize, tbrick, tplain/tbrick,
+            AIR_CAST(unsigned long, ctxPlain->iv3HitNum),
+            AIR_CAST(unsigned long, ctxPlain->iv3ShiftNum),
+            AIR_CAST(unsigned long, ctxPlain->iv3FillNum));
+    if (differ) {
+      fprintf(stderr, "%s: %s: %lu answers differ with bricking\n", me,
+              pattern[pi], AIR_CAST(unsigned long, differ));
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -422,6 +422,7 @@ gageUpdate(gageContext *ctx) {
   gagePointReset(&ctx->point);
 
   for (pi=0; pi<ctx->pvlNum; pi++) {
+    ELL_3V_SET(ctx->pvl[pi]->iv3Idx, UINT_MAX, UINT_MAX, UINT_MAX);
     if (ctx->pvl[pi]->kind->pvlDataUpdate) {
       if (ctx->pvl[pi]->kind->pvlDataUpdate(ctx->pvl[pi]->kind,
                                             ctx,
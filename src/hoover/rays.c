@@ -415,6 +415,7 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
     airMopError(mop);
     return hooverErrRenderBegin;
   }
+  AIR_PROFILE_START(airProfileHooverRender);
 
   for (threadIdx=0; threadIdx<ctx->numThreads; threadIdx++) {
     args[threadIdx].ctx = ctx;
@@ -479,6 +480,9 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
   if (1 < ctx->numThreads) {
     ctx->workMutex = airThreadMutexNix(ctx->workMutex);
   }
+  AIR_PROFILE_STOP(airProfileHooverRender);
+  AIR_PROFILE_COUNT(airProfileHooverRender,
+                    AIR_CAST(double, ctx->imgSize[0])*ctx->imgSize[1]);
 
   if ( (ret = (ctx->renderEnd)(render, ctx->user)) ) {
     *errCodeP = ret;
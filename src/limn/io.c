@@ -442,6 +442,438 @@ limnObjectReadOFF(limnObject *obj, FILE *file) {
   return 0;
 }
 
+/*
+** LMPD2: binary polydata format, for fast reading of large polydata.
+**
+** The file starts with a header of LMPD2_HEAD_FIX bytes:
+**   8 bytes: LMPD2_MAGIC (no newline)
+**   8 unsigned ints: endianness of writer (airEndian value), total
+**     size of header (including section table), xyzwNum, indxNum,
+**     primNum, limnPolyDataInfoBitFlag, number of sections, and 0
+** followed by a section table, with for each section:
+**   2 unsigned ints: section id (lmpd2Sect* below), encoding (0 for raw,
+**     1 for gzip)
+**   3 airULLongs: offset of section data from start of file, size of
+**     (uncompressed) data, size of data as stored in file
+** and then the sections themselves: type, icnt, indx, xyzw, and then any
+** per-vertex info arrays, in order of limnPolyDataInfo value.  All
+** values (in header and data) are in the endianness of the writer, and
+** every section starts at a multiple of LMPD2_ALIGN bytes in the file,
+** so raw sections can be read (or mapped) directly into place.  Reading
+** gzip-compressed sections requires a seekable file, since the
+** decompression may read beyond the end of the section.
+*/
+#define LMPD2_MAGIC "LIMN0002"
+#define LMPD2_HEAD_FIX (8 + 8*sizeof(unsigned int))
+#define LMPD2_SECT_SIZE (2*sizeof(unsigned int) + 3*sizeof(airULLong))
+#define LMPD2_ALIGN 64
+#define LMPD2_SECT_MAX 8
+
+enum {
+  lmpd2SectUnknown,
+  lmpd2SectType,   /* 1 */
+  lmpd2SectIcnt,   /* 2 */
+  lmpd2SectIndx,   /* 3 */
+  lmpd2SectXyzw,   /* 4 */
+  lmpd2SectInfo    /* 5: info arrays are lmpd2SectInfo - 1 + info */
+};
+
+typedef struct {
+  unsigned int id, encoding;
+  airULLong offset, rawSize, storedSize;
+  void *data;
+  int type;             /* nrrdType of data values */
+  size_t elNum;         /* number of values */
+} _lmpd2Sect;
+
+static airULLong
+_lmpd2Align(airULLong off) {
+  return LMPD2_ALIGN*((off + LMPD2_ALIGN - 1)/LMPD2_ALIGN);
+}
+
+static void
+_lmpd2Swap(void *_data, size_t size) {
+  unsigned char *data, tmp;
+  size_t ii;
+
+  data = AIR_CAST(unsigned char *, _data);
+  for (ii=0; ii<size/2; ii++) {
+    tmp = data[ii];
+    data[ii] = data[size-1-ii];
+    data[size-1-ii] = tmp;
+  }
+  return;
+}
+
+/*
+** learns sections from a polydata that has been allocated for
+** the given info bitflag, and returns the number of them
+*/
+static unsigned int
+_lmpd2Sections(_lmpd2Sect *sect, const limnPolyData *pld,
+               unsigned int infoFlag) {
+  unsigned int sectNum, info;
+
+  sectNum = 0;
+#define SECT(ID, DATA, TYPE, NUM)                  \
+  sect[sectNum].id = (ID);                        \
+  sect[sectNum].data = AIR_CAST(void *, (DATA));  \
+  sect[sectNum].type = (TYPE);                    \
+  sect[sectNum].elNum = (NUM);                    \
+  sect[sectNum].rawSize = (AIR_CAST(airULLong, sect[sectNum].elNum) \
+                           *nrrdTypeSize[TYPE]);  \
+  sectNum++
+  SECT(lmpd2SectType, pld->type, nrrdTypeUChar, pld->primNum);
+  SECT(lmpd2SectIcnt, pld->icnt, nrrdTypeUInt, pld->primNum);
+  SECT(lmpd2SectIndx, pld->indx, nrrdTypeUInt, pld->indxNum);
+  SECT(lmpd2SectXyzw, pld->xyzw, nrrdTypeFloat, 4*pld->xyzwNum);
+  for (info=limnPolyDataInfoUnknown+1;
+       info<limnPolyDataInfoLast;
+       info++) {
+    if (!(infoFlag & (1 << info))) {
+      continue;
+    }
+    switch (info) {
+    case limnPolyDataInfoRGBA:
+      SECT(lmpd2SectInfo - 1 + info, pld->rgba, nrrdTypeUChar,
+           4*pld->rgbaNum);
+      break;
+    case limnPolyDataInfoNorm:
+      SECT(lmpd2SectInfo - 1 + info, pld->norm, nrrdTypeFloat,
+           3*pld->normNum);
+      break;
+    case limnPolyDataInfoTex2:
+      SECT(lmpd2SectInfo - 1 + info, pld->tex2, nrrdTypeFloat,
+           2*pld->tex2Num);
+      break;
+    case limnPolyDataInfoTang:
+      SECT(lmpd2SectInfo - 1 + info, pld->tang, nrrdTypeFloat,
+           3*pld->tangNum);
+      break;
+    }
+  }
+#undef SECT
+  return sectNum;
+}
+
+static void
+_lmpd2HeadSet(unsigned char *head, const unsigned int fix[8],
+              const _lmpd2Sect *sect, unsigned int sectNum) {
+  unsigned char *hh;
+  unsigned int si;
+
+  memcpy(head, LMPD2_MAGIC, 8);
+  memcpy(head + 8, fix, 8*sizeof(unsigned int));
+  hh = head + LMPD2_HEAD_FIX;
+  for (si=0; si<sectNum; si++) {
+    memcpy(hh, &(sect[si].id), sizeof(unsigned int));
+    hh += sizeof(unsigned int);
+    memcpy(hh, &(sect[si].encoding), sizeof(unsigned int));
+    hh += sizeof(unsigned int);
+    memcpy(hh, &(sect[si].offset), sizeof(airULLong));
+    hh += sizeof(airULLong);
+    memcpy(hh, &(sect[si].rawSize), sizeof(airULLong));
+    hh += sizeof(airULLong);
+    memcpy(hh, &(sect[si].storedSize), sizeof(airULLong));
+    hh += sizeof(airULLong);
+  }
+  return;
+}
+
+/*
+******** limnPolyDataWriteLMPD2
+**
+** writes a limnPolyData in the binary LMPD2 format.  If "gzip" is
+** non-zero, the sections are gzip-compressed (which requires that
+** file be seekable, and that Teem was built with zlib); otherwise the
+** file can be written to a pipe.
+*/
+int
+limnPolyDataWriteLMPD2(FILE *file, const limnPolyData *pld, int gzip) {
+  static const char me[]="limnPolyDataWriteLMPD2";
+  _lmpd2Sect sect[LMPD2_SECT_MAX];
+  unsigned int fix[8], sectNum, si, primIdx;
+  unsigned char *head;
+  airULLong headSize, pos;
+  long int start=0, here;
+  Nrrd *nrrd;
+  NrrdIoState *nio;
+  airArray *mop;
+
+  if (!(file && pld)) {
+    biffAddf(LIMN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  for (primIdx=0; primIdx<pld->primNum; primIdx++) {
+    if (limnPrimitiveNoop == pld->type[primIdx]) {
+      biffAddf(LIMN, "%s: sorry, can't save with prim[%u] type %s", me,
+               primIdx, airEnumStr(limnPrimitive, pld->type[primIdx]));
+      return 1;
+    }
+  }
+  if (gzip) {
+    if (!nrrdEncodingGzip->available()) {
+      biffAddf(LIMN, "%s: sorry, gzip compression not available", me);
+      return 1;
+    }
+    start = ftell(file);
+    if (-1 == start) {
+      biffAddf(LIMN, "%s: gzip compression needs seekable file", me);
+      return 1;
+    }
+  }
+
+  fix[0] = airMyEndian();
+  fix[2] = pld->xyzwNum;
+  fix[3] = pld->indxNum;
+  fix[4] = pld->primNum;
+  fix[5] = limnPolyDataInfoBitFlag(pld);
+  sectNum = _lmpd2Sections(sect, pld, fix[5]);
+  fix[6] = sectNum;
+  fix[7] = 0;
+  headSize = LMPD2_HEAD_FIX + sectNum*LMPD2_SECT_SIZE;
+  fix[1] = AIR_CAST(unsigned int, headSize);
+  /* offsets (and sizes) are final only if not compressing */
+  pos = _lmpd2Align(headSize);
+  for (si=0; si<sectNum; si++) {
+    sect[si].encoding = gzip ? 1 : 0;
+    sect[si].offset = pos;
+    sect[si].storedSize = sect[si].rawSize;
+    pos = _lmpd2Align(pos + sect[si].storedSize);
+  }
+
+  mop = airMopNew();
+  head = AIR_CALLOC(LMPD2_ALIGN + headSize, unsigned char);
+  airMopAdd(mop, head, airFree, airMopAlways);
+  nrrd = nrrdNew();
+  airMopAdd(mop, nrrd, (airMopper)nrrdNix, airMopAlways); /* nix, not nuke */
+  nio = nrrdIoStateNew();
+  airMopAdd(mop, nio, (airMopper)nrrdIoStateNix, airMopAlways);
+  if (!(head && nrrd && nio)) {
+    biffAddf(LIMN, "%s: couldn't allocate buffers", me);
+    airMopError(mop); return 1;
+  }
+  _lmpd2HeadSet(head, fix, sect, sectNum);
+  /* the padding after the header is zeros from calloc */
+  pos = _lmpd2Align(headSize);
+  if (pos != fwrite(head, 1, AIR_CAST(size_t, pos), file)) {
+    biffAddf(LIMN, "%s: couldn't write %u-byte header", me,
+             AIR_CAST(unsigned int, pos));
+    airMopError(mop); return 1;
+  }
+  memset(head, 0, LMPD2_ALIGN);
+  for (si=0; si<sectNum; si++) {
+    if (pos < sect[si].offset) {
+      size_t padNum;
+      padNum = AIR_CAST(size_t, sect[si].offset - pos);
+      if (padNum != fwrite(head, 1, padNum, file)) {
+        biffAddf(LIMN, "%s: couldn't pad before section %u", me, si);
+        airMopError(mop); return 1;
+      }
+    }
+    if (!sect[si].rawSize) {
+      sect[si].storedSize = 0;
+    } else if (!gzip) {
+      if (sect[si].elNum != fwrite(sect[si].data, nrrdTypeSize[sect[si].type],
+                                   sect[si].elNum, file)) {
+        biffAddf(LIMN, "%s: couldn't write section %u", me, si);
+        airMopError(mop); return 1;
+      }
+    } else {
+      if (nrrdWrap_va(nrrd, sect[si].data, sect[si].type, 1, sect[si].elNum)
+          || nrrdEncodingGzip->write(file, sect[si].data, sect[si].elNum,
+                                     nrrd, nio)) {
+        biffMovef(LIMN, NRRD, "%s: problem writing section %u", me, si);
+        airMopError(mop); return 1;
+      }
+      here = ftell(file);
+      sect[si].storedSize = AIR_CAST(airULLong, here - start) - sect[si].offset;
+    }
+    pos = sect[si].offset + sect[si].storedSize;
+    if (si < sectNum-1) {
+      sect[si+1].offset = _lmpd2Align(pos);
+    }
+  }
+  if (gzip) {
+    /* go back to write the actual sizes and offsets in the header */
+    _lmpd2HeadSet(head, fix, sect, sectNum);
+    if (fseek(file, start, SEEK_SET)
+        || headSize != fwrite(head, 1, AIR_CAST(size_t, headSize), file)
+        || fseek(file, 0, SEEK_END)) {
+      biffAddf(LIMN, "%s: couldn't re-write header", me);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** reads the rest of an LMPD2 file, after the magic
+*/
+static int
+_limnPolyDataReadLMPD2(limnPolyData *pld, FILE *file) {
+  static const char me[]="_limnPolyDataReadLMPD2";
+  _lmpd2Sect sect[LMPD2_SECT_MAX], want[LMPD2_SECT_MAX];
+  unsigned int fix[8], endian, sectNum, si, ii, primIdx;
+  unsigned char *head, *hh;
+  airULLong pos;
+  long int start;
+  int swap, seek;
+  Nrrd *nrrd;
+  NrrdIoState *nio;
+  airArray *mop;
+
+  /* may be -1 if file isn't seekable; only matters with gzip */
+  start = ftell(file);
+  if (-1 != start) {
+    start -= 8;
+  }
+  if (8 != fread(fix, sizeof(unsigned int), 8, file)) {
+    biffAddf(LIMN, "%s: couldn't read header", me);
+    return 1;
+  }
+  /* fix[0] is the writer's airMyEndian(); swap only if, once swapped,
+     it is the other endianness, and fail if it is neither */
+  endian = fix[0];
+  _lmpd2Swap(&endian, sizeof(unsigned int));
+  if (airMyEndian() == AIR_CAST(int, fix[0])) {
+    swap = AIR_FALSE;
+  } else if ((airEndianLittle == AIR_CAST(int, endian)
+              || airEndianBig == AIR_CAST(int, endian))
+             && airMyEndian() != AIR_CAST(int, endian)) {
+    swap = AIR_TRUE;
+    for (ii=0; ii<8; ii++) {
+      _lmpd2Swap(fix + ii, sizeof(unsigned int));
+    }
+  } else {
+    biffAddf(LIMN, "%s: endian field %u not recognized", me, fix[0]);
+    return 1;
+  }
+  sectNum = fix[6];
+  if (!( 4 <= sectNum && sectNum <= LMPD2_SECT_MAX
+         && fix[1] == LMPD2_HEAD_FIX + sectNum*LMPD2_SECT_SIZE )) {
+    biffAddf(LIMN, "%s: header size %u or section number %u invalid",
+             me, fix[1], sectNum);
+    return 1;
+  }
+  if (limnPolyDataAlloc(pld, fix[5], fix[2], fix[3], fix[4])) {
+    biffAddf(LIMN, "%s: couldn't allocate polydata", me);
+    return 1;
+  }
+  /* actually, caller owns pld, so we don't register it with mop */
+  if (sectNum != _lmpd2Sections(want, pld, fix[5])) {
+    biffAddf(LIMN, "%s: have %u sections, but info flag %u implies %u", me,
+             sectNum, fix[5], _lmpd2Sections(want, pld, fix[5]));
+    return 1;
+  }
+
+  mop = airMopNew();
+  head = AIR_CALLOC(LMPD2_ALIGN + fix[1], unsigned char);
+  airMopAdd(mop, head, airFree, airMopAlways);
+  nrrd = nrrdNew();
+  airMopAdd(mop, nrrd, (airMopper)nrrdNix, airMopAlways); /* nix, not nuke */
+  nio = nrrdIoStateNew();
+  airMopAdd(mop, nio, (airMopper)nrrdIoStateNix, airMopAlways);
+  if (!(head && nrrd && nio)) {
+    biffAddf(LIMN, "%s: couldn't allocate buffers", me);
+    airMopError(mop); return 1;
+  }
+  if (sectNum*LMPD2_SECT_SIZE != fread(head, 1, sectNum*LMPD2_SECT_SIZE,
+                                       file)) {
+    biffAddf(LIMN, "%s: couldn't read section table", me);
+    airMopError(mop); return 1;
+  }
+  hh = head;
+  for (si=0; si<sectNum; si++) {
+    memcpy(&(sect[si].id), hh, sizeof(unsigned int));
+    hh += sizeof(unsigned int);
+    memcpy(&(sect[si].encoding), hh, sizeof(unsigned int));
+    hh += sizeof(unsigned int);
+    memcpy(&(sect[si].offset), hh, sizeof(airULLong));
+    hh += sizeof(airULLong);
+    memcpy(&(sect[si].rawSize), hh, sizeof(airULLong));
+    hh += sizeof(airULLong);
+    memcpy(&(sect[si].storedSize), hh, sizeof(airULLong));
+    hh += sizeof(airULLong);
+    if (swap) {
+      _lmpd2Swap(&(sect[si].id), sizeof(unsigned int));
+      _lmpd2Swap(&(sect[si].encoding), sizeof(unsigned int));
+      _lmpd2Swap(&(sect[si].offset), sizeof(airULLong));
+      _lmpd2Swap(&(sect[si].rawSize), sizeof(airULLong));
+      _lmpd2Swap(&(sect[si].storedSize), sizeof(airULLong));
+    }
+    if (!( want[si].id == sect[si].id
+           && want[si].rawSize == sect[si].rawSize
+           && sect[si].encoding <= 1
+           && (sect[si].encoding || sect[si].rawSize == sect[si].storedSize)
+           && !(sect[si].offset % LMPD2_ALIGN) )) {
+      biffAddf(LIMN, "%s: section %u (id %u, encoding %u, size %u) not "
+               "expected (id %u, size %u)", me, si, sect[si].id,
+               sect[si].encoding, AIR_CAST(unsigned int, sect[si].rawSize),
+               want[si].id, AIR_CAST(unsigned int, want[si].rawSize));
+      airMopError(mop); return 1;
+    }
+  }
+
+  pos = fix[1];
+  seek = AIR_FALSE;
+  for (si=0; si<sectNum; si++) {
+    if (!sect[si].rawSize) {
+      continue;
+    }
+    if (seek) {
+      /* after gzip decompression, file position is unknown */
+      if (-1 == start
+          || fseek(file, start + AIR_CAST(long int, sect[si].offset),
+                   SEEK_SET)) {
+        biffAddf(LIMN, "%s: couldn't seek to section %u "
+                 "(gzip compression needs seekable file)", me, si);
+        airMopError(mop); return 1;
+      }
+    } else if (pos < sect[si].offset) {
+      size_t padNum;
+      padNum = AIR_CAST(size_t, sect[si].offset - pos);
+      if (padNum > LMPD2_ALIGN + fix[1]
+          || padNum != fread(head, 1, padNum, file)) {
+        biffAddf(LIMN, "%s: couldn't skip to section %u", me, si);
+        airMopError(mop); return 1;
+      }
+    }
+    if (sect[si].encoding) {
+      if (nrrdWrap_va(nrrd, want[si].data, want[si].type, 1, want[si].elNum)
+          || nrrdEncodingGzip->read(file, want[si].data, want[si].elNum,
+                                    nrrd, nio)) {
+        biffMovef(LIMN, NRRD, "%s: problem reading section %u", me, si);
+        airMopError(mop); return 1;
+      }
+      seek = AIR_TRUE;
+    } else {
+      if (want[si].elNum != fread(want[si].data, nrrdTypeSize[want[si].type],
+                                  want[si].elNum, file)) {
+        biffAddf(LIMN, "%s: couldn't read section %u", me, si);
+        airMopError(mop); return 1;
+      }
+    }
+    pos = sect[si].offset + sect[si].storedSize;
+    if (swap && nrrdTypeSize[want[si].type] > 1) {
+      nrrdWrap_va(nrrd, want[si].data, want[si].type, 1, want[si].elNum);
+      nrrdSwapEndian(nrrd);
+    }
+  }
+  for (primIdx=0; primIdx<pld->primNum; primIdx++) {
+    if (airEnumValCheck(limnPrimitive, pld->type[primIdx])) {
+      biffAddf(LIMN, "%s: prim[%u] type %u invalid", me, primIdx,
+               pld->type[primIdx]);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
 /*
 http://www.npr.org/templates/story/story.php?storyId=4531695
 */
@@ -574,7 +1006,8 @@ limnPolyDataWriteLMPD(FILE *file, const limnPolyData *pld) {
 /*
 ******** limnPolyDataReadLMPD
 **
-** reads a limnPolyData from an LMPD file
+** reads a limnPolyData from an LMPD file (either the original text-based
+** format, or the binary LMPD2 format written by limnPolyDataWriteLMPD2)
 **
 ** HEY: this was written in a hurry, is pretty hacky, and so it
 ** needs some serious clean-up
@@ -595,14 +1028,27 @@ limnPolyDataReadLMPD(limnPolyData *pld, FILE *file) {
   }
 
   sprintf(name, "magic");
-  lineLen = airOneLine(file, line, AIR_STRLEN_MED);
-  if (!lineLen) {
-    biffAddf(LIMN, "%s: didn't get %s line", me, name);
+  /* the LMPD2 magic (with no newline) is the same length */
+  if (strlen(LMPD_MAGIC) != fread(line, 1, strlen(LMPD_MAGIC), file)) {
+    biffAddf(LIMN, "%s: didn't get %s", me, name);
     return 1;
   }
+  line[strlen(LMPD_MAGIC)] = '\0';
+  if (!strcmp(line, LMPD2_MAGIC)) {
+    if (_limnPolyDataReadLMPD2(pld, file)) {
+      biffAddf(LIMN, "%s: trouble reading LMPD2", me);
+      return 1;
+    }
+    return 0;
+  }
   if (strcmp(line, LMPD_MAGIC)) {
-    biffAddf(LIMN, "%s: %s line \"%s\" not expected \"%s\"",
-             me, name, line, LMPD_MAGIC);
+    biffAddf(LIMN, "%s: %s \"%s\" not expected \"%s\" or \"%s\"",
+             me, name, line, LMPD_MAGIC, LMPD2_MAGIC);
+    return 1;
+  }
+  lineLen = airOneLine(file, line, AIR_STRLEN_MED);
+  if (1 != lineLen) {
+    biffAddf(LIMN, "%s: didn't get end of %s line", me, name);
     return 1;
   }
 
@@ -1209,6 +1655,8 @@ limnPolyDataSave(const char *_fname, const limnPolyData *lpld) {
     ret = limnPolyDataWriteVTK(file, lpld);
   } else if (airEndsWith(fname, ".iv")) {
     ret = limnPolyDataWriteIV(file, lpld);
+  } else if (airEndsWith(fname, ".lmpd2")) {
+    ret = limnPolyDataWriteLMPD2(file, lpld, AIR_FALSE);
   } else {
     if (strcmp(_fname, "-") && !airEndsWith(fname, ".lmpd")) {
       fprintf(stderr, "%s: WARNING: unknown or no suffix on \"%s\"; "
@@ -735,6 +735,8 @@ LIMN_EXPORT int limnObjectWriteOFF(FILE *file, const limnObject *obj);
 LIMN_EXPORT int limnPolyDataWriteIV(FILE *file, const limnPolyData *pld);
 LIMN_EXPORT int limnPolyDataWriteLMPD(FILE *file, const limnPolyData *pld);
 LIMN_EXPORT int limnPolyDataReadLMPD(limnPolyData *pld, FILE *file);
+LIMN_EXPORT int limnPolyDataWriteLMPD2(FILE *file, const limnPolyData *pld,
+                                       int gzip);
 LIMN_EXPORT int limnPolyDataWriteVTK(FILE *file, const limnPolyData *pld);
 LIMN_EXPORT int limnPolyDataReadOFF(limnPolyData *pld, FILE *file);
 LIMN_EXPORT int limnPolyDataSave(const char *fname, const limnPolyData *lpld);
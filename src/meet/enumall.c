@@ -69,6 +69,7 @@ meetAirEnumAll() {
   /* air */
   ii = airArrayLenIncr(arr, 1); enm[ii] = airEndian;
   ii = airArrayLenIncr(arr, 1); enm[ii] = airBool;
+  ii = airArrayLenIncr(arr, 1); enm[ii] = airProfile;
 
   /* hest: no airEnums */
 
@@ -192,6 +192,25 @@ MEET_EXPORT int meetPullInfoAddMulti(pullContext *pctx,
                                      meetPullInfo **minf,
                                      unsigned int minfNum);
 
+/*
+******** meetProfileReport
+**
+** a snapshot of the air profiling counters and timers (see airProfile),
+** summed over all threads; indexed by the airProfile* enum
+*/
+typedef struct {
+  unsigned int threadNum;            /* # threads that recorded anything */
+  double count[AIR_PROFILE_MAX+1],   /* counts, in units given by airProfile */
+    time[AIR_PROFILE_MAX+1];         /* accumulated seconds */
+} meetProfileReport;
+
+/* meetProfile.c */
+MEET_EXPORT const char *const meetEnvVarProfile;
+MEET_EXPORT void meetProfileReportGet(meetProfileReport *rep);
+MEET_EXPORT void meetProfileReportPrint(FILE *file,
+                                        const meetProfileReport *rep);
+MEET_EXPORT int meetProfileGetenv(void);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,141 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "meet.h"
+
+const char *const
+meetEnvVarProfile = "TEEM_PROFILE";
+
+/*
+******** meetProfileReportGet
+**
+** gathers the current totals (over all threads) of the air profiling
+** counters and timers into the given report
+*/
+void
+meetProfileReportGet(meetProfileReport *rep) {
+
+  if (rep) {
+    rep->threadNum = airProfileTotal(rep->count, rep->time);
+  }
+  return;
+}
+
+/*
+******** meetProfileReportPrint
+**
+** prints one line per counter that was touched: the counter name, the
+** count, the accumulated time (in seconds, or "-" if the counter isn't
+** timed), and the count per second.  The columns are whitespace
+** separated, with a leading "#" comment line, so that the output can be
+** read by other programs.
+*/
+void
+meetProfileReportPrint(FILE *file, const meetProfileReport *rep) {
+  unsigned int pi;
+
+  if (!(file && rep)) {
+    return;
+  }
+  fprintf(file, "# %s: %s (%u thread%s)\n", meetEnvVarProfile,
+          airProfileCapable ? "profile" : "profiling not compiled in",
+          rep->threadNum, 1 == rep->threadNum ? "" : "s");
+  fprintf(file, "# %-16s %16s %12s %14s\n", "name", "count", "seconds",
+          "count/sec");
+  for (pi=airProfileUnknown+1; pi<airProfileLast; pi++) {
+    if (!rep->count[pi] && !rep->time[pi]) {
+      continue;
+    }
+    if (rep->time[pi]) {
+      fprintf(file, "  %-16s %16.0f %12.6f %14.6g\n",
+              airEnumStr(airProfile, pi), rep->count[pi], rep->time[pi],
+              rep->count[pi]/rep->time[pi]);
+    } else {
+      fprintf(file, "  %-16s %16.0f %12s %14s\n",
+              airEnumStr(airProfile, pi), rep->count[pi], "-", "-");
+    }
+  }
+  return;
+}
+
+static char *
+_meetProfileFilename = NULL;
+
+static void
+_meetProfileAtexit(void) {
+  meetProfileReport rep;
+  FILE *file;
+
+  meetProfileReportGet(&rep);
+  file = NULL;
+  if (_meetProfileFilename) {
+    file = fopen(_meetProfileFilename, "w");
+    if (!file) {
+      fprintf(stderr, "%s: couldn't open \"%s\" for writing; "
+              "using stderr\n", meetEnvVarProfile, _meetProfileFilename);
+    }
+  }
+  meetProfileReportPrint(file ? file : stderr, &rep);
+  if (file) {
+    fclose(file);
+  }
+  return;
+}
+
+/*
+******** meetProfileGetenv
+**
+** for command-line tools: looks at the TEEM_PROFILE environment
+** variable, and if it is set to something true (or set to nothing),
+** turns on air profiling and arranges for a report to be printed to
+** stderr at exit.  If it is set to something that isn't a bool, that
+** string is taken to be the name of the file to which the report is
+** written.  Returns non-zero iff profiling was turned on.
+*/
+int
+meetProfileGetenv(void) {
+  int val, ret;
+  char *envStr;
+
+  val = AIR_FALSE;
+  ret = nrrdGetenvBool(&val, &envStr, meetEnvVarProfile);
+  if (-1 == ret) {
+    /* not set */
+    return 0;
+  }
+  if (AIR_FALSE == ret) {
+    /* not a bool; must be a filename */
+    _meetProfileFilename = airStrdup(envStr);
+    val = AIR_TRUE;
+  }
+  if (!val) {
+    return 0;
+  }
+  if (!airProfileCapable) {
+    fprintf(stderr, "%s: WARNING: Teem not compiled with TEEM_PROFILE; "
+            "report will be empty\n", meetEnvVarProfile);
+  }
+  airProfileEnable(AIR_TRUE);
+  atexit(_meetProfileAtexit);
+  return 1;
+}
@@ -5,6 +5,7 @@ set(MEET_SOURCES
   meetNrrd.c
   meetGage.c
   meetPull.c
+  meetProfile.c
   meet.h
   )
 
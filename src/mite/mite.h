@@ -196,6 +196,9 @@ typedef struct {
   /* output information from last rendering */
   double rendTime,       /* rendering time, in seconds */
     sampRate;            /* rate (KHz) at which samples were rendered */
+  size_t iv3HitNum,      /* summed over all threads' gageContexts: how many */
+    iv3FillNum,          /* probes re-used, re-filled, or shifted the iv3 */
+    iv3ShiftNum;         /* value caches (see gageIv3CountReset) */
 } miteUser;
 
 struct miteThread_t;
@@ -168,6 +168,8 @@ miteRenderBegin(miteRender **mrrP, miteUser *muu) {
               (airMopper)miteThreadNix, airMopAlways);
   }
 
+  /* thread 0 probes with gctx0 itself; the copies start counting at 0 */
+  gageIv3CountReset(muu->gctx0);
   (*mrrP)->time0 = airTime();
   return 0;
 }
@@ -179,8 +181,14 @@ miteRenderEnd(miteRender *mrr, miteUser *muu) {
 
   muu->rendTime = airTime() - mrr->time0;
   samples = 0;
+  muu->iv3HitNum = muu->iv3FillNum = muu->iv3ShiftNum = 0;
   for (thr=0; thr<muu->hctx->numThreads; thr++) {
     samples += mrr->tt[thr]->samples;
+    if (mrr->tt[thr]->gctx) {
+      muu->iv3HitNum += mrr->tt[thr]->gctx->iv3HitNum;
+      muu->iv3FillNum += mrr->tt[thr]->gctx->iv3FillNum;
+      muu->iv3ShiftNum += mrr->tt[thr]->gctx->iv3ShiftNum;
+    }
   }
   muu->sampRate = samples/(1000.0*muu->rendTime);
   _miteRenderNix(mrr);
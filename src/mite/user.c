@@ -72,6 +72,7 @@ miteUserNew() {
   muu->verbUi = muu->verbVi = -1;
   muu->rendTime = 0;
   muu->sampRate = 0;
+  muu->iv3HitNum = muu->iv3FillNum = muu->iv3ShiftNum = 0;
   return muu;
 }
 
@@ -35,3 +35,6 @@ mossDefCenter = nrrdCenterCell;
 
 int
 mossVerbose = 0;
+
+int
+mossDefThreadNum = 1;
@@ -90,6 +90,7 @@ MOSS_EXPORT const char *mossBiffKey;
 MOSS_EXPORT int mossDefBoundary;
 MOSS_EXPORT int mossDefCenter;
 MOSS_EXPORT int mossVerbose;
+MOSS_EXPORT int mossDefThreadNum;
 
 /* methodsMoss.c */
 MOSS_EXPORT const int mossPresent;
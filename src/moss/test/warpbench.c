@@ -0,0 +1,175 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "../moss.h"
+
+/*
+** times mossLinearTransform against the per-pixel mossSamplerSample
+** loop that it used to be (and that "ilk" used to run), and checks that
+** they give the same output
+*/
+
+static int
+sampleLoop(Nrrd *nout, Nrrd *nin, double *mat, mossSampler *msp,
+           double xMin, double xMax, double yMin, double yMax,
+           int xSize, int ySize, int xCent, int yCent) {
+  int ncol, xi, yi, ci, ax0;
+  float *val, (*ins)(void *v, size_t I, float f), (*clamp)(float val);
+  double inv[6], xInPos, xOutPos, yInPos, yOutPos;
+
+  ax0 = MOSS_AXIS0(nin);
+  ncol = MOSS_NCOL(nin);
+  if (mossImageAlloc(nout, nin->type, xSize, ySize, ncol)) {
+    return 1;
+  }
+  val = (float*)calloc(ncol, sizeof(float));
+  ins = nrrdFInsert[nin->type];
+  clamp = nrrdFClamp[nin->type];
+  mossMatInvert(inv, mat);
+  for (yi=0; yi<ySize; yi++) {
+    yOutPos = NRRD_POS(yCent, yMin, yMax, ySize, yi);
+    for (xi=0; xi<xSize; xi++) {
+      xOutPos = NRRD_POS(xCent, xMin, xMax, xSize, xi);
+      mossMatApply(&xInPos, &yInPos, inv, xOutPos, yOutPos);
+      xInPos = NRRD_IDX(xCent, nin->axis[ax0+0].min, nin->axis[ax0+0].max,
+                        nin->axis[ax0+0].size, xInPos);
+      yInPos = NRRD_IDX(yCent, nin->axis[ax0+1].min, nin->axis[ax0+1].max,
+                        nin->axis[ax0+1].size, yInPos);
+      mossSamplerSample(val, msp, xInPos, yInPos);
+      for (ci=0; ci<ncol; ci++) {
+        ins(nout->data, ci + ncol*(xi + xSize*yi), clamp(val[ci]));
+      }
+    }
+  }
+  free(val);
+  return 0;
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me, *info="times and checks mossLinearTransform";
+  char *err, explain[AIR_STRLEN_LARGE];
+  hestOpt *hopt=NULL;
+  airArray *mop;
+  Nrrd *nin, *nfast, *nslow;
+  NrrdKernelSpec *ksp;
+  mossSampler *msp;
+  double *mat, time0, time1, time2;
+  float bg[4] = {0, 0, 0, 0};
+  int size[2], ncol, bound, threadNum, ax0, differ, reps, ri;
+  size_t II, NN;
+
+  me = argv[0];
+  mop = airMopNew();
+  hestOptAdd(&hopt, "s", "sx sy", airTypeInt, 2, 2, size, "1024 1024",
+             "size of input and output images");
+  hestOptAdd(&hopt, "c", "ncol", airTypeInt, 1, 1, &ncol, "3",
+             "number of colors (1 to 4)");
+  hestOptAdd(&hopt, "t", "transform", airTypeOther, 1, 1, &mat, "rotate:20",
+             "transform to apply to image (as with \"ilk -t\")",
+             NULL, NULL, mossHestTransform);
+  hestOptAdd(&hopt, "k", "kernel", airTypeOther, 1, 1, &ksp,
+             "cubic:0,0.5", "reconstruction kernel",
+             NULL, NULL, nrrdHestKernelSpec);
+  hestOptAdd(&hopt, "b", "boundary", airTypeEnum, 1, 1, &bound, "bleed",
+             "boundary behavior", NULL, nrrdBoundary);
+  hestOptAdd(&hopt, "nt", "# threads", airTypeInt, 1, 1, &threadNum, "1",
+             "number of threads for mossLinearTransform");
+  hestOptAdd(&hopt, "r", "reps", airTypeInt, 1, 1, &reps, "1",
+             "number of times to run mossLinearTransform");
+  hestParseOrDie(hopt, argc-1, argv+1, NULL,
+                 me, info, AIR_TRUE, AIR_TRUE, AIR_TRUE);
+  airMopAdd(mop, hopt, (airMopper)hestOptFree, airMopAlways);
+  airMopAdd(mop, hopt, (airMopper)hestParseFree, airMopAlways);
+  if (!AIR_IN_CL(1, ncol, 4)) {
+    fprintf(stderr, "%s: # colors %d not in [1,4]\n", me, ncol);
+    airMopError(mop); return 1;
+  }
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nfast = nrrdNew();
+  airMopAdd(mop, nfast, (airMopper)nrrdNuke, airMopAlways);
+  nslow = nrrdNew();
+  airMopAdd(mop, nslow, (airMopper)nrrdNuke, airMopAlways);
+  msp = mossSamplerNew();
+  airMopAdd(mop, msp, (airMopper)mossSamplerNix, airMopAlways);
+  if (mossImageAlloc(nin, nrrdTypeUChar, size[0], size[1], ncol)) {
+    airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  NN = nrrdElementNumber(nin);
+  airSrandMT(42);
+  for (II=0; II<NN; II++) {
+    AIR_CAST(unsigned char *, nin->data)[II] =
+      AIR_CAST(unsigned char, 127*(1 + sin(0.01*II)) + 2*airDrandMT());
+  }
+  ax0 = MOSS_AXIS0(nin);
+  nrrdAxisInfoMinMaxSet(nin, ax0+0, mossDefCenter);
+  nrrdAxisInfoMinMaxSet(nin, ax0+1, mossDefCenter);
+  msp->boundary = bound;
+  if (mossSamplerKernelSet(msp, ksp->kernel, ksp->parm)) {
+    airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with sampler:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  mossDefThreadNum = threadNum;
+  time0 = airTime();
+  for (ri=0; ri<reps; ri++) {
+    if (mossLinearTransform(nfast, nin, bg, mat, msp,
+                            nin->axis[ax0+0].min, nin->axis[ax0+0].max,
+                            nin->axis[ax0+1].min, nin->axis[ax0+1].max,
+                            size[0], size[1])) {
+      airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble transforming:\n%s", me, err);
+      airMopError(mop); return 1;
+    }
+  }
+  time1 = airTime();
+  sampleLoop(nslow, nin, mat, msp,
+             nin->axis[ax0+0].min, nin->axis[ax0+0].max,
+             nin->axis[ax0+1].min, nin->axis[ax0+1].max,
+             size[0], size[1],
+             nfast->axis[ax0+0].center, nfast->axis[ax0+1].center);
+  time2 = airTime();
+  fprintf(stderr, "%s: mossLinearTransform (%d thread%s): %g sec; "
+          "per-pixel mossSamplerSample: %g sec (%g x)\n", me,
+          threadNum, 1 == threadNum ? "" : "s", (time1 - time0)/reps,
+          time2 - time1, (time2 - time1)/((time1 - time0)/reps));
+
+  if (nrrdCompare(nfast, nslow, AIR_TRUE /* onlyData */, 0.0 /* epsilon */,
+                  &differ, explain)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble comparing:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (differ) {
+    fprintf(stderr, "%s: outputs differ: %s\n", me, explain);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -140,6 +140,251 @@ mossMatApply (double *ox, double *oy, double *mat, double ix, double iy) {
   *oy = mat[3]*ix + mat[4]*iy + mat[5];
 }
 
+/*
+** the state shared by the threads of mossLinearTransform.  The input
+** image is seen as floats (fin), with ncol values per pixel.  When the
+** transform is axis-aligned, the sample indices and kernel weights only
+** depend on the output x index (for the input x position) or y index
+** (for input y), so they are computed once into the {x,y}TabIdx and
+** {x,y}TabW tables, with fdiam entries per output index.
+*/
+typedef struct {
+  const float *fin, *bg;
+  int sx, sy, ncol, fdiam, boundary, xSize, ySize, xCent, yCent;
+  const NrrdKernel *kernel;
+  const double *kparm;
+  double inv[6], xMin, xMax, yMin, yMax,
+    xInMin, xInMax, yInMin, yInMax;
+  int *xTabIdx, *yTabIdx;
+  double *xTabW, *yTabW;
+  void *out;
+  float (*ins)(void *v, size_t I, float f), (*clamp)(float val);
+} _mossWarpParm;
+
+/*
+** per-thread scratch space, and which output rows to do.  For the
+** axis-aligned case, rowBuf caches rowNum input rows that have been
+** filtered along x (to xSize*ncol values each): rowKey[] is which input
+** row (or -1 for the padding row) each holds, and rowUsed[] the last
+** output row that used it.
+*/
+typedef struct {
+  const _mossWarpParm *parm;
+  int yLo, yHi;
+  int *xIdx, *yIdx;
+  double *xw, *yw, *tmp;
+  float *val;
+  int rowNum, rowNext, *rowKey, *rowUsed;
+  double *rowBuf;
+  const double **row;
+} _mossWarpTask;
+
+/*
+** sets the fdiam sample indices and kernel weights around (index-space)
+** position pos along an axis with size samples, in the same way as
+** mossSamplerSample.  With nrrdBoundaryPad, indices outside the image
+** are set to -1.
+*/
+static void
+_mossWarpTaps(int *idx, double *wght, double pos, int size,
+              const _mossWarpParm *parm) {
+  int ii, pi, fdiam, frad;
+  double pf;
+
+  fdiam = parm->fdiam;
+  frad = fdiam/2;
+  pi = (int)floor(pos); pf = pos - pi;
+  for (ii=0; ii<fdiam; ii++) {
+    idx[ii] = pi + ii - frad + 1;
+    wght[ii] = pf - ii + frad - 1;
+    switch (parm->boundary) {
+    case nrrdBoundaryBleed:
+      idx[ii] = AIR_CLAMP(0, idx[ii], size-1);
+      break;
+    case nrrdBoundaryWrap:
+      idx[ii] = AIR_MOD(idx[ii], size);
+      break;
+    case nrrdBoundaryPad:
+      idx[ii] = AIR_IN_CL(0, idx[ii], size-1) ? idx[ii] : -1;
+      break;
+    }
+  }
+  parm->kernel->evalN_d(wght, wght, fdiam, parm->kparm);
+}
+
+/*
+** separable convolution at one output pixel, with the same arithmetic
+** (per color) as mossSamplerSample, but with colors in the inner loop
+*/
+static void
+_mossWarpPixel(_mossWarpTask *task, const int *xIdx, const double *xw,
+               const int *yIdx, const double *yw) {
+  const _mossWarpParm *parm;
+  const float *pix;
+  double *tmp, ww;
+  float *val;
+  int xi, yi, ci, ncol, fdiam;
+
+  parm = task->parm;
+  ncol = parm->ncol;
+  fdiam = parm->fdiam;
+  tmp = task->tmp;
+  val = task->val;
+  for (ci=0; ci<ncol; ci++) {
+    val[ci] = 0;
+  }
+  for (yi=0; yi<fdiam; yi++) {
+    for (ci=0; ci<ncol; ci++) {
+      tmp[ci] = 0;
+    }
+    for (xi=0; xi<fdiam; xi++) {
+      ww = xw[xi];
+      pix = (xIdx[xi] < 0 || yIdx[yi] < 0
+             ? parm->bg
+             : parm->fin + ncol*(xIdx[xi] + parm->sx*yIdx[yi]));
+      for (ci=0; ci<ncol; ci++) {
+        tmp[ci] += ww*pix[ci];
+      }
+    }
+    for (ci=0; ci<ncol; ci++) {
+      val[ci] += AIR_CAST(float, yw[yi]*tmp[ci]);
+    }
+  }
+}
+
+/*
+** returns the input row key filtered along x for all output x, for use
+** by output row yo; this is the "tmp" of _mossWarpPixel for every
+** output pixel in the row and y tap at row key
+*/
+static const double *
+_mossWarpRow(_mossWarpTask *task, int key, int yo) {
+  const _mossWarpParm *parm;
+  const float *pix;
+  const int *xIdx;
+  const double *xw;
+  double *row, *tmp, ww;
+  int si, xo, xi, ci, ncol, fdiam;
+
+  for (si=0; si<task->rowNum; si++) {
+    if (key == task->rowKey[si]) {
+      task->rowUsed[si] = yo;
+      return task->rowBuf + si*task->parm->xSize*task->parm->ncol;
+    }
+  }
+  /* not cached; replace a row not needed by this output row (there are
+     twice as many slots as taps, so one is always available) */
+  while (yo == task->rowUsed[task->rowNext]) {
+    task->rowNext = (task->rowNext + 1) % task->rowNum;
+  }
+  si = task->rowNext;
+  task->rowNext = (task->rowNext + 1) % task->rowNum;
+  task->rowKey[si] = key;
+  task->rowUsed[si] = yo;
+  parm = task->parm;
+  ncol = parm->ncol;
+  fdiam = parm->fdiam;
+  row = task->rowBuf + si*parm->xSize*ncol;
+  for (xo=0; xo<parm->xSize; xo++) {
+    xIdx = parm->xTabIdx + fdiam*xo;
+    xw = parm->xTabW + fdiam*xo;
+    tmp = row + ncol*xo;
+    for (ci=0; ci<ncol; ci++) {
+      tmp[ci] = 0;
+    }
+    for (xi=0; xi<fdiam; xi++) {
+      ww = xw[xi];
+      pix = (xIdx[xi] < 0 || key < 0
+             ? parm->bg
+             : parm->fin + ncol*(xIdx[xi] + parm->sx*key));
+      for (ci=0; ci<ncol; ci++) {
+        tmp[ci] += ww*pix[ci];
+      }
+    }
+  }
+  return row;
+}
+
+static void *
+_mossWarpWorker(void *_task) {
+  _mossWarpTask *task;
+  const _mossWarpParm *parm;
+  int xi, yi, ci, ti, ncol, fdiam, *xIdx, *yIdx;
+  double xInPos, xOutPos, yInPos, yOutPos, *xw, *yw;
+  size_t outIdx;
+
+  task = AIR_CAST(_mossWarpTask *, _task);
+  parm = task->parm;
+  ncol = parm->ncol;
+  fdiam = parm->fdiam;
+  if (parm->xTabIdx) {
+    /* axis-aligned: filter (and cache) input rows along x, then
+       combine them along y */
+    for (yi=task->yLo; yi<task->yHi; yi++) {
+      yIdx = parm->yTabIdx + fdiam*yi;
+      yw = parm->yTabW + fdiam*yi;
+      for (ti=0; ti<fdiam; ti++) {
+        task->row[ti] = _mossWarpRow(task, yIdx[ti], yi);
+      }
+      for (xi=0; xi<parm->xSize; xi++) {
+        for (ci=0; ci<ncol; ci++) {
+          task->val[ci] = 0;
+        }
+        for (ti=0; ti<fdiam; ti++) {
+          for (ci=0; ci<ncol; ci++) {
+            task->val[ci] += AIR_CAST(float,
+                                      yw[ti]*task->row[ti][ci + ncol*xi]);
+          }
+        }
+        outIdx = AIR_CAST(size_t, ncol)*(xi + AIR_CAST(size_t, parm->xSize)*yi);
+        for (ci=0; ci<ncol; ci++) {
+          parm->ins(parm->out, ci + outIdx, parm->clamp(task->val[ci]));
+        }
+      }
+    }
+    return _task;
+  }
+  for (yi=task->yLo; yi<task->yHi; yi++) {
+    yOutPos = NRRD_POS(parm->yCent, parm->yMin, parm->yMax, parm->ySize, yi);
+    for (xi=0; xi<parm->xSize; xi++) {
+      xOutPos = NRRD_POS(parm->xCent, parm->xMin, parm->xMax,
+                         parm->xSize, xi);
+      mossMatApply(&xInPos, &yInPos, AIR_CAST(double *, parm->inv),
+                   xOutPos, yOutPos);
+      xInPos = NRRD_IDX(parm->xCent, parm->xInMin, parm->xInMax,
+                        parm->sx, xInPos);
+      yInPos = NRRD_IDX(parm->yCent, parm->yInMin, parm->yInMax,
+                        parm->sy, yInPos);
+      xIdx = task->xIdx;
+      xw = task->xw;
+      yIdx = task->yIdx;
+      yw = task->yw;
+      _mossWarpTaps(xIdx, xw, xInPos, parm->sx, parm);
+      _mossWarpTaps(yIdx, yw, yInPos, parm->sy, parm);
+      _mossWarpPixel(task, xIdx, xw, yIdx, yw);
+      outIdx = AIR_CAST(size_t, ncol)*(xi + AIR_CAST(size_t, parm->xSize)*yi);
+      for (ci=0; ci<ncol; ci++) {
+        parm->ins(parm->out, ci + outIdx, parm->clamp(task->val[ci]));
+      }
+    }
+  }
+  return _task;
+}
+
+/*
+******** mossLinearTransform
+**
+** resamples nin into nout (xSize by ySize samples covering world-space
+** [xMin,xMax] by [yMin,yMax]) under the transform mat, using the kernel
+** and boundary behavior of msp.  This gives the same results as calling
+** mossSamplerSample for every output pixel, but the input is converted
+** to float only once, and output rows are split among mossDefThreadNum
+** threads.  When mat is axis-aligned (no rotation or shear), the kernel
+** weights are computed once per output row and column, and each input
+** row is filtered along x once and cached while nearby output rows
+** use it, so the work per output pixel is proportional to the kernel
+** diameter rather than its square.
+*/
 int
 mossLinearTransform (Nrrd *nout, Nrrd *nin, float *bg,
                      double *mat, mossSampler *msp,
@@ -147,9 +392,14 @@ mossLinearTransform (Nrrd *nout, Nrrd *nin, float *bg,
                      double yMin, double yMax,
                      int xSize, int ySize) {
   static const char me[]="mossLinearTransform";
-  int ncol, xi, yi, ci, ax0, xCent, yCent;
-  float *val, (*ins)(void *v, size_t I, float f), (*clamp)(float val);
-  double inv[6], xInPos, xOutPos, yInPos, yOutPos;
+  _mossWarpParm parm;
+  _mossWarpTask *task;
+  airArray *mop;
+  unsigned int failIdx;
+  float *val, *fin, (*lup)(const void *v, size_t I);
+  int ncol, ax0, xi, yi, ti, threadNum, fdiam;
+  double xInPos, xOutPos, yInPos, yOutPos;
+  size_t II, NN;
 
   if (!(nout && nin && mat && msp && !mossImageCheck(nin))) {
     biffAddf(MOSS, "%s: got NULL pointer or bad image", me);
@@ -177,47 +427,168 @@ mossLinearTransform (Nrrd *nout, Nrrd *nin, float *bg,
   if (mossImageAlloc(nout, nin->type, xSize, ySize, ncol)) {
     biffAddf(MOSS, "%s: ", me); return 1;
   }
+  mop = airMopNew();
   val = (float*)calloc(ncol, sizeof(float));
+  airMopAdd(mop, val, airFree, airMopAlways);
   if (nrrdCenterUnknown == nout->axis[ax0+0].center)
     nout->axis[ax0+0].center = _mossCenter(nin->axis[ax0+0].center);
-  xCent = nout->axis[ax0+0].center;
+  parm.xCent = nout->axis[ax0+0].center;
   if (nrrdCenterUnknown == nout->axis[ax0+1].center)
     nout->axis[ax0+1].center = _mossCenter(nin->axis[ax0+1].center);
-  yCent = nout->axis[ax0+1].center;
+  parm.yCent = nout->axis[ax0+1].center;
   nout->axis[ax0+0].min = xMin;
   nout->axis[ax0+0].max = xMax;
   nout->axis[ax0+1].min = yMin;
   nout->axis[ax0+1].max = yMax;
-  ins = nrrdFInsert[nin->type];
-  clamp = nrrdFClamp[nin->type];
 
+  /* this catches unimplemented boundary behaviors */
   if (mossSamplerSample(val, msp, 0, 0)) {
     biffAddf(MOSS, "%s: trouble in sampler", me);
-    free(val); return 1;
+    airMopError(mop); return 1;
   }
 
-  mossMatInvert(inv, mat);
-  for (yi=0; yi<ySize; yi++) {
-    yOutPos = NRRD_POS(yCent, yMin, yMax, ySize, yi);
+  fdiam = msp->fdiam;
+  parm.sx = MOSS_SX(nin);
+  parm.sy = MOSS_SY(nin);
+  parm.ncol = ncol;
+  parm.fdiam = fdiam;
+  parm.boundary = msp->boundary;
+  parm.bg = msp->bg;
+  parm.kernel = msp->kernel;
+  parm.kparm = msp->kparm;
+  mossMatInvert(parm.inv, mat);
+  parm.xMin = xMin;
+  parm.xMax = xMax;
+  parm.yMin = yMin;
+  parm.yMax = yMax;
+  parm.xSize = xSize;
+  parm.ySize = ySize;
+  parm.xInMin = nin->axis[ax0+0].min;
+  parm.xInMax = nin->axis[ax0+0].max;
+  parm.yInMin = nin->axis[ax0+1].min;
+  parm.yInMax = nin->axis[ax0+1].max;
+  parm.out = nout->data;
+  parm.ins = nrrdFInsert[nin->type];
+  parm.clamp = nrrdFClamp[nin->type];
+
+  /* the input values, as floats */
+  if (nrrdTypeFloat == nin->type) {
+    parm.fin = AIR_CAST(const float *, nin->data);
+  } else {
+    NN = nrrdElementNumber(nin);
+    fin = AIR_CAST(float *, calloc(NN, sizeof(float)));
+    airMopAdd(mop, fin, airFree, airMopAlways);
+    if (!fin) {
+      biffAddf(MOSS, "%s: couldn't allocate float copy of input", me);
+      airMopError(mop); return 1;
+    }
+    lup = nrrdFLookup[nin->type];
+    for (II=0; II<NN; II++) {
+      fin[II] = lup(nin->data, II);
+    }
+    parm.fin = fin;
+  }
+
+  parm.xTabIdx = parm.yTabIdx = NULL;
+  parm.xTabW = parm.yTabW = NULL;
+  if (!parm.inv[1] && !parm.inv[3]) {
+    /* axis-aligned: input x only depends on output x, y on y */
+    parm.xTabIdx = AIR_CAST(int *, calloc(fdiam*xSize, sizeof(int)));
+    parm.xTabW = AIR_CAST(double *, calloc(fdiam*xSize, sizeof(double)));
+    parm.yTabIdx = AIR_CAST(int *, calloc(fdiam*ySize, sizeof(int)));
+    parm.yTabW = AIR_CAST(double *, calloc(fdiam*ySize, sizeof(double)));
+    airMopAdd(mop, parm.xTabIdx, airFree, airMopAlways);
+    airMopAdd(mop, parm.xTabW, airFree, airMopAlways);
+    airMopAdd(mop, parm.yTabIdx, airFree, airMopAlways);
+    airMopAdd(mop, parm.yTabW, airFree, airMopAlways);
+    if (!(parm.xTabIdx && parm.xTabW && parm.yTabIdx && parm.yTabW)) {
+      biffAddf(MOSS, "%s: couldn't allocate weight tables", me);
+      airMopError(mop); return 1;
+    }
     for (xi=0; xi<xSize; xi++) {
-      /*
-      mossVerbose = ( (36 == xi && 72 == yi) ||
-                      (37 == xi && 73 == yi) ||
-                      (105 == xi && 175 == yi) );
-      */
-      xOutPos = NRRD_POS(xCent, xMin, xMax, xSize, xi);
-      mossMatApply(&xInPos, &yInPos, inv, xOutPos, yOutPos);
-      xInPos = NRRD_IDX(xCent, nin->axis[ax0+0].min, nin->axis[ax0+0].max,
-                        nin->axis[ax0+0].size, xInPos);
-      yInPos = NRRD_IDX(yCent, nin->axis[ax0+1].min, nin->axis[ax0+1].max,
-                        nin->axis[ax0+1].size, yInPos);
-      mossSamplerSample(val, msp, xInPos, yInPos);
-      for (ci=0; ci<ncol; ci++) {
-        ins(nout->data, ci + ncol*(xi + xSize*yi), clamp(val[ci]));
+      xOutPos = NRRD_POS(parm.xCent, xMin, xMax, xSize, xi);
+      mossMatApply(&xInPos, &yInPos, parm.inv, xOutPos, 0);
+      xInPos = NRRD_IDX(parm.xCent, parm.xInMin, parm.xInMax,
+                        parm.sx, xInPos);
+      _mossWarpTaps(parm.xTabIdx + fdiam*xi, parm.xTabW + fdiam*xi,
+                    xInPos, parm.sx, &parm);
+    }
+    for (yi=0; yi<ySize; yi++) {
+      yOutPos = NRRD_POS(parm.yCent, yMin, yMax, ySize, yi);
+      mossMatApply(&xInPos, &yInPos, parm.inv, 0, yOutPos);
+      yInPos = NRRD_IDX(parm.yCent, parm.yInMin, parm.yInMax,
+                        parm.sy, yInPos);
+      _mossWarpTaps(parm.yTabIdx + fdiam*yi, parm.yTabW + fdiam*yi,
+                    yInPos, parm.sy, &parm);
+    }
+  }
+
+  threadNum = AIR_CLAMP(1, mossDefThreadNum, ySize);
+  if (!airThreadCapable) {
+    threadNum = 1;
+  }
+  task = AIR_CAST(_mossWarpTask *, calloc(threadNum, sizeof(_mossWarpTask)));
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (!task) {
+    biffAddf(MOSS, "%s: couldn't allocate %d thread records", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    task[ti].parm = &parm;
+    task[ti].yLo = AIR_CAST(int, AIR_CAST(airLLong, ySize)*ti/threadNum);
+    task[ti].yHi = AIR_CAST(int, AIR_CAST(airLLong, ySize)*(ti+1)/threadNum);
+    task[ti].xIdx = AIR_CAST(int *, calloc(fdiam, sizeof(int)));
+    task[ti].yIdx = AIR_CAST(int *, calloc(fdiam, sizeof(int)));
+    task[ti].xw = AIR_CAST(double *, calloc(fdiam, sizeof(double)));
+    task[ti].yw = AIR_CAST(double *, calloc(fdiam, sizeof(double)));
+    task[ti].tmp = AIR_CAST(double *, calloc(ncol, sizeof(double)));
+    task[ti].val = AIR_CAST(float *, calloc(ncol, sizeof(float)));
+    airMopAdd(mop, task[ti].xIdx, airFree, airMopAlways);
+    airMopAdd(mop, task[ti].yIdx, airFree, airMopAlways);
+    airMopAdd(mop, task[ti].xw, airFree, airMopAlways);
+    airMopAdd(mop, task[ti].yw, airFree, airMopAlways);
+    airMopAdd(mop, task[ti].tmp, airFree, airMopAlways);
+    airMopAdd(mop, task[ti].val, airFree, airMopAlways);
+    if (!(task[ti].xIdx && task[ti].yIdx && task[ti].xw && task[ti].yw
+          && task[ti].tmp && task[ti].val)) {
+      biffAddf(MOSS, "%s: couldn't allocate scratch for thread %d", me, ti);
+      airMopError(mop); return 1;
+    }
+    if (parm.xTabIdx) {
+      task[ti].rowNum = 2*fdiam;
+      task[ti].rowNext = 0;
+      task[ti].rowKey = AIR_CAST(int *, calloc(2*fdiam, sizeof(int)));
+      task[ti].rowUsed = AIR_CAST(int *, calloc(2*fdiam, sizeof(int)));
+      task[ti].rowBuf = AIR_CAST(double *, calloc(2*fdiam*xSize*ncol,
+                                                  sizeof(double)));
+      task[ti].row = AIR_CAST(const double **, calloc(fdiam,
+                                                      sizeof(double *)));
+      airMopAdd(mop, task[ti].rowKey, airFree, airMopAlways);
+      airMopAdd(mop, task[ti].rowUsed, airFree, airMopAlways);
+      airMopAdd(mop, task[ti].rowBuf, airFree, airMopAlways);
+      airMopAdd(mop, AIR_CAST(void *, task[ti].row), airFree, airMopAlways);
+      if (!(task[ti].rowKey && task[ti].rowUsed && task[ti].rowBuf
+            && task[ti].row)) {
+        biffAddf(MOSS, "%s: couldn't allocate row cache for thread %d",
+                 me, ti);
+        airMopError(mop); return 1;
+      }
+      for (yi=0; yi<2*fdiam; yi++) {
+        /* -1 is the padding row, and no output row is -1 */
+        task[ti].rowKey[yi] = -2;
+        task[ti].rowUsed[yi] = -1;
       }
     }
   }
+  /* each thread has its own rows, so there's nothing to abort */
+  failIdx = airThreadRun(AIR_UINT(threadNum), _mossWarpWorker, task,
+                         sizeof(_mossWarpTask), NULL, NULL);
+  if (failIdx) {
+    biffAddf(MOSS, "%s: couldn't start thread %u of %d", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
 
-  free(val);
+  airMopOkay(mop);
   return 0;
 }
@@ -273,19 +273,168 @@ _nrrdApply1DSetUp(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
   return 0;
 }
 
+/*
+** the state shared by the threads of _nrrdApply1DLutOrRegMap: everything
+** that used to be local to its loops, plus:
+** mapD: if non-NULL, the (non-multi) map, converted to doubles, so that
+**   the inner loop doesn't need the per-value nrrdDLookup
+** tab, tabMin: if tab is non-NULL, the output entries for every possible
+**   value of the (8 or 16 bit integral) input, starting with value tabMin,
+**   so that mapping a value is just copying one entry
+** quantize, qmin, qmax: if quantize is non-zero, map values are quantized
+**   to 8 bits over [qmin,qmax] (with airIndexClamp), and stored in the
+**   (unsigned char) output
+*/
+typedef struct {
+  const char *inData, *mapData, *tab;
+  char *outData;
+  const double *mapD;
+  const NrrdRange *range;
+  double (*inLoad)(const void *v), (*mapLup)(const void *v, size_t I),
+    (*outInsert)(void *v, size_t I, double d);
+  double domMin, domMax, tabMin, qmin, qmax;
+  unsigned int mapLen, entSize, entLen, inSize, outSize;
+  int inType, ramps, rescale, multi, quantize;
+} _nrrdApply1DParm;
+
+/* how _nrrdApply1DLutOrRegMapBody gets component i of map entry ent */
+#define MAP_VAL(parm, mapData, ent, i)                                  \
+  ((parm)->mapD                                                         \
+   ? (parm)->mapD[(i) + (parm)->entLen*(ent)]                           \
+   : (parm)->mapLup((mapData) + (ent)*(parm)->entSize, (i)))
+
+/* how _nrrdApply1DLutOrRegMapBody stores component i of the output;
+   the quantization is airIndexClamp(qmin, val, qmax, 256), written out
+   for the usual case of qmin < qmax */
+#define OUT_SET(parm, outData, i, val)                                  \
+  if (!(parm)->quantize) {                                              \
+    (parm)->outInsert((outData), (i), (val));                           \
+  } else if (!AIR_EXISTS(val)) {                                        \
+    AIR_CAST(unsigned char *, (outData))[(i)] = 0;                      \
+  } else if ((parm)->qmin < (parm)->qmax) {                             \
+    unsigned int qidx;                                                  \
+    qidx = AIR_UINT(256*(AIR_CLAMP((parm)->qmin, (val), (parm)->qmax)   \
+                         - (parm)->qmin)/((parm)->qmax - (parm)->qmin)); \
+    AIR_CAST(unsigned char *, (outData))[(i)] =                         \
+      AIR_CAST(unsigned char, AIR_MIN(qidx, 255));                      \
+  } else {                                                              \
+    AIR_CAST(unsigned char *, (outData))[(i)] =                         \
+      AIR_CAST(unsigned char, airIndexClamp((parm)->qmin, (val),        \
+                                            (parm)->qmax, 256));        \
+  }
+
+/* the table lookup for one type of integral input */
+#define TAB_LOOP(TYPE)                                                  \
+  for (I=lo; I<hi; I++) {                                               \
+    memcpy(outData, parm->tab                                           \
+           + parm->outSize*AIR_CAST(size_t, (*AIR_CAST(const TYPE *,    \
+                                                      inData)           \
+                                             - tabMin)),                \
+           parm->outSize);                                              \
+    inData += parm->inSize;                                             \
+    outData += parm->outSize;                                           \
+  }
+
+static void
+_nrrdApply1DLutOrRegMapBody(void *_parm, unsigned int threadIdx,
+                            size_t lo, size_t hi) {
+  _nrrdApply1DParm *parm;
+  const char *inData, *mapData;
+  char *outData;
+  size_t I;
+  double val, mapIdxFrac, domMin, domMax;
+  int tabMin;
+  unsigned int i, mapLen, mapIdx, entLen;
+
+  parm = AIR_CAST(_nrrdApply1DParm *, _parm);
+  AIR_UNUSED(threadIdx);
+  inData = parm->inData + lo*parm->inSize;
+  outData = parm->outData + lo*parm->outSize;
+  mapData = parm->mapData;
+  mapLen = parm->mapLen;
+  entLen = parm->entLen;
+  if (parm->multi) {
+    mapData += lo*mapLen*parm->entSize;
+  }
+  if (parm->tab) {
+    tabMin = AIR_CAST(int, parm->tabMin);
+    switch (parm->inType) {
+    case nrrdTypeChar:   TAB_LOOP(signed char);    break;
+    case nrrdTypeUChar:  TAB_LOOP(unsigned char);  break;
+    case nrrdTypeShort:  TAB_LOOP(signed short);   break;
+    case nrrdTypeUShort: TAB_LOOP(unsigned short); break;
+    }
+    return;
+  }
+  domMin = parm->domMin;
+  domMax = parm->domMax;
+  for (I=lo; I<hi; I++) {
+    val = parm->inLoad(inData);
+    if (parm->rescale) {
+      val = (parm->range->min != parm->range->max
+             ? AIR_AFFINE(parm->range->min, val, parm->range->max,
+                          domMin, domMax)
+             : domMin);
+    }
+    if (AIR_EXISTS(val)) {
+      if (parm->ramps) {
+        /* regular map */
+        val = AIR_CLAMP(domMin, val, domMax);
+        mapIdxFrac = AIR_AFFINE(domMin, val, domMax, 0, mapLen-1);
+        mapIdx = (unsigned int)mapIdxFrac;
+        mapIdx -= mapIdx == mapLen-1;
+        mapIdxFrac -= mapIdx;
+        for (i=0; i<entLen; i++) {
+          val = ((1-mapIdxFrac)*MAP_VAL(parm, mapData, mapIdx, i) +
+                 mapIdxFrac*MAP_VAL(parm, mapData, mapIdx+1, i));
+          OUT_SET(parm, outData, i, val);
+        }
+      } else {
+        /* lookup table */
+        mapIdx = airIndexClamp(domMin, val, domMax, mapLen);
+        for (i=0; i<entLen; i++) {
+          val = MAP_VAL(parm, mapData, mapIdx, i);
+          OUT_SET(parm, outData, i, val);
+        }
+      }
+    } else {
+      /* copy non-existent values from input to output */
+      for (i=0; i<entLen; i++) {
+        OUT_SET(parm, outData, i, val);
+      }
+    }
+    inData += parm->inSize;
+    outData += parm->outSize;
+    if (parm->multi) {
+      mapData += mapLen*parm->entSize;
+    }
+  }
+  return;
+}
+
 /*
 ** _nrrdApply1DLutOrRegMap()
 **
-** the guts of nrrdApply1DLut and nrrdApply1DRegMap
+** the guts of nrrdApply1DLut and nrrdApply1DRegMap (and their multi
+** and quantizing variants)
 **
-** yikes, does NOT use biff, since we're only supposed to be called
-** after copious error checking.
+** only supposed to be called after copious error checking; the only
+** errors (reported with biff) are from allocating or threading.
 **
 ** FOR INSTANCE, this allows nout == nin, which could be a big
 ** problem if mapAxis == 1.
 **
 ** we don't need a typeOut arg because nout has already been allocated
-** as some specific type; we'll look at that.
+** as some specific type; we'll look at that.  If quantize is non-zero,
+** nout has to be unsigned char, and the map values are quantized to 8
+** bits over [qmin,qmax] (which have to exist) as they are stored.
+**
+** The per-value work is split among nrrdStateThreadNum threads.  For
+** 8 and 16 bit integral input (with a non-multi map, and enough input
+** values to make it worth it), every possible input value is mapped
+** once, into a table, and then the output is copied from the table.
+** This gives exactly the same results, since it is the same code
+** mapping the same values.
 **
 ** NOTE: non-existent values get passed through regular maps and luts
 ** "unchanged".  However, if the output type is integral, the results
@@ -295,127 +444,109 @@ _nrrdApply1DSetUp(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
 */
 int
 _nrrdApply1DLutOrRegMap(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
-                        const Nrrd *nmap, int ramps, int rescale, int multi) {
-  /* static const char me[]="_nrrdApply1DLutOrRegMap"; */
-  char *inData, *outData, *mapData, *entData0, *entData1;
-  size_t N, I;
-  double (*inLoad)(const void *v), (*mapLup)(const void *v, size_t I),
-    (*outInsert)(void *v, size_t I, double d),
-    val, mapIdxFrac, domMin, domMax;
-  unsigned int i, mapAxis, mapLen, mapIdx, entSize, entLen, inSize, outSize;
+                        const Nrrd *nmap, int ramps, int rescale, int multi,
+                        int quantize, double qmin, double qmax) {
+  static const char me[]="_nrrdApply1DLutOrRegMap";
+  _nrrdApply1DParm parm, tparm;
+  unsigned int mapAxis, tabLen, ti;
+  size_t N, mi, mapNum;
+  double *mapD;
+  char *tab, *tabIn;
+  airArray *mop;
 
   if (!multi) {
     mapAxis = nmap->dim - 1;           /* axis of nmap containing entries */
   } else {
     mapAxis = nmap->dim - nin->dim - 1;
   }
-  mapData = (char *)nmap->data;        /* map data, as char* */
+  parm.mapData = (const char *)nmap->data; /* map data, as char* */
                                        /* low end of map domain */
-  domMin = _nrrdApplyDomainMin(nmap, ramps, mapAxis);
+  parm.domMin = _nrrdApplyDomainMin(nmap, ramps, mapAxis);
                                        /* high end of map domain */
-  domMax = _nrrdApplyDomainMax(nmap, ramps, mapAxis);
-  mapLen = AIR_CAST(unsigned int, nmap->axis[mapAxis].size);   /* number of entries in map */
-  mapLup = nrrdDLookup[nmap->type];    /* how to get doubles out of map */
-  inData = (char *)nin->data;          /* input data, as char* */
-  inLoad = nrrdDLoad[nin->type];       /* how to get doubles out of nin */
-  inSize = AIR_CAST(unsigned int, nrrdElementSize(nin));       /* size of one input value */
-  outData = (char *)nout->data;        /* output data, as char* */
-  outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
-  entLen = (mapAxis                    /* number of elements in one entry */
-            ? AIR_CAST(unsigned int, nmap->axis[0].size)
-            : 1);
-  outSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nout)); /* size of entry in output */
-  entSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nmap)); /* size of entry in map */
-
+  parm.domMax = _nrrdApplyDomainMax(nmap, ramps, mapAxis);
+                                       /* number of entries in map */
+  parm.mapLen = AIR_CAST(unsigned int, nmap->axis[mapAxis].size);
+  parm.mapLup = nrrdDLookup[nmap->type]; /* how to get doubles out of map */
+  parm.inData = (const char *)nin->data; /* input data, as char* */
+  parm.inLoad = nrrdDLoad[nin->type];  /* how to get doubles out of nin */
+  parm.inType = nin->type;
+                                       /* size of one input value */
+  parm.inSize = AIR_CAST(unsigned int, nrrdElementSize(nin));
+  parm.outData = (char *)nout->data;   /* output data, as char* */
+  parm.outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
+  parm.entLen = (mapAxis               /* number of elements in one entry */
+                 ? AIR_CAST(unsigned int, nmap->axis[0].size)
+                 : 1);
+                                       /* size of entry in output */
+  parm.outSize = parm.entLen*AIR_CAST(unsigned int, nrrdElementSize(nout));
+                                       /* size of entry in map */
+  parm.entSize = parm.entLen*AIR_CAST(unsigned int, nrrdElementSize(nmap));
+  parm.range = range;
+  parm.ramps = ramps;
+  parm.rescale = rescale;
+  parm.multi = multi;
+  parm.quantize = quantize;
+  parm.qmin = qmin;
+  parm.qmax = qmax;
+  parm.mapD = NULL;
+  parm.tab = NULL;
+  parm.tabMin = 0;
   N = nrrdElementNumber(nin);       /* the number of values to be mapped */
-  if (ramps) {
-    /* regular map */
-    for (I=0; I<N; I++) {
-      /* ...
-      if (!(I % 100)) fprintf(stderr, "I = %d\n", (int)I);
-      ... */
-      val = inLoad(inData);
-      /* ...
-      fprintf(stderr, "##%s: val = \na% 31.15f --> ", me, val);
-      ... */
-      if (rescale) {
-        val = (range->min != range->max
-               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
-               : domMin);
-        /* ...
-        fprintf(stderr, "\nb% 31.15f (min,max = %g,%g)--> ", val,
-                range->min, range->max);
-        ... */
-      }
-      /* ...
-      fprintf(stderr, "\nc% 31.15f --> clamp(%g,%g), %d --> ",
-              val, domMin, domMax, mapLen);
-      ... */
-      if (AIR_EXISTS(val)) {
-        val = AIR_CLAMP(domMin, val, domMax);
-        mapIdxFrac = AIR_AFFINE(domMin, val, domMax, 0, mapLen-1);
-        /* ...
-        fprintf(stderr, "mapIdxFrac = \nd% 31.15f --> ",
-                mapIdxFrac);
-        ... */
-        mapIdx = (unsigned int)mapIdxFrac;
-        mapIdx -= mapIdx == mapLen-1;
-        mapIdxFrac -= mapIdx;
-        /* ...
-        fprintf(stderr, "%s: (%d,\ne% 31.15f) --> \n",
-                me, mapIdx, mapIdxFrac);
-        ... */
-        entData0 = mapData + mapIdx*entSize;
-        entData1 = mapData + (mapIdx+1)*entSize;
-        for (i=0; i<entLen; i++) {
-          val = ((1-mapIdxFrac)*mapLup(entData0, i) +
-                 mapIdxFrac*mapLup(entData1, i));
-          outInsert(outData, i, val);
-          /* ...
-          fprintf(stderr, "f% 31.15f\n", val);
-          ... */
-        }
-      } else {
-        /* copy non-existent values from input to output */
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, val);
-        }
-      }
-      inData += inSize;
-      outData += outSize;
-      if (multi) {
-        mapData += mapLen*entSize;
-      }
+
+  mop = airMopNew();
+  if (!multi) {
+    mapNum = AIR_CAST(size_t, parm.mapLen)*parm.entLen;
+    mapD = AIR_CALLOC(mapNum, double);
+    if (!mapD) {
+      biffAddf(NRRD, "%s: couldn't allocate %u-entry map", me, parm.mapLen);
+      airMopError(mop); return 1;
     }
-  } else {
-    /* lookup table */
-    for (I=0; I<N; I++) {
-      val = inLoad(inData);
-      if (rescale) {
-        val = (range->min != range->max
-               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
-               : domMin);
-      }
-      if (AIR_EXISTS(val)) {
-        mapIdx = airIndexClamp(domMin, val, domMax, mapLen);
-        entData0 = mapData + mapIdx*entSize;
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, mapLup(entData0, i));
-        }
-      } else {
-        /* copy non-existent values from input to output */
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, val);
-        }
+    airMopAdd(mop, mapD, airFree, airMopAlways);
+    for (mi=0; mi<mapNum; mi++) {
+      mapD[mi] = parm.mapLup(nmap->data, mi);
+    }
+    parm.mapD = mapD;
+    switch (nin->type) {
+    case nrrdTypeChar:
+    case nrrdTypeUChar:
+      tabLen = 1 << 8;
+      break;
+    case nrrdTypeShort:
+    case nrrdTypeUShort:
+      tabLen = 1 << 16;
+      break;
+    default:
+      tabLen = 0;
+      break;
+    }
+    if (tabLen && N > 2*tabLen) {
+      /* map every possible input value into the table, using a copy
+         of parm that points to the table instead of nout */
+      parm.tabMin = nrrdTypeMin[nin->type];
+      tab = AIR_CALLOC(AIR_CAST(size_t, tabLen)*parm.outSize, char);
+      tabIn = AIR_CALLOC(AIR_CAST(size_t, tabLen)*parm.inSize, char);
+      airMopAdd(mop, tab, airFree, airMopAlways);
+      airMopAdd(mop, tabIn, airFree, airMopAlways);
+      if (!(tab && tabIn)) {
+        biffAddf(NRRD, "%s: couldn't allocate %u-entry table", me, tabLen);
+        airMopError(mop); return 1;
       }
-      inData += inSize;
-      outData += outSize;
-      if (multi) {
-        mapData += mapLen*entSize;
+      for (ti=0; ti<tabLen; ti++) {
+        nrrdDInsert[nin->type](tabIn, ti, parm.tabMin + ti);
       }
+      tparm = parm;
+      tparm.inData = tabIn;
+      tparm.outData = tab;
+      _nrrdApply1DLutOrRegMapBody(&tparm, 0, 0, tabLen);
+      parm.tab = tab;
     }
   }
+  if (_nrrdThreadRun(_nrrdApply1DLutOrRegMapBody, &parm, N)) {
+    biffAddf(NRRD, "%s: trouble mapping", me);
+    airMopError(mop); return 1;
+  }
 
+  airMopOkay(mop);
   return 0;
 }
 
@@ -459,7 +590,8 @@ nrrdApply1DLut(Nrrd *nout, const Nrrd *nin,
   if (_nrrdApply1DSetUp(nout, nin, range, nlut, kindLut, typeOut,
                         rescale, AIR_FALSE /* multi */)
       || _nrrdApply1DLutOrRegMap(nout, nin, range, nlut, AIR_FALSE /* ramps */,
-                                 rescale, AIR_FALSE /* multi */)) {
+                                 rescale, AIR_FALSE /* multi */,
+                                 AIR_FALSE /* quantize */, 0, 0)) {
     biffAddf(NRRD, "%s:", me);
     airMopError(mop); return 1;
   }
@@ -491,7 +623,8 @@ nrrdApplyMulti1DLut(Nrrd *nout, const Nrrd *nin,
                         rescale, AIR_TRUE /* multi */)
       || _nrrdApply1DLutOrRegMap(nout, nin, range, nmlut,
                                  AIR_FALSE /* ramps */,
-                                 rescale, AIR_TRUE /* multi */)) {
+                                 rescale, AIR_TRUE /* multi */,
+                                 AIR_FALSE /* quantize */, 0, 0)) {
     biffAddf(NRRD, "%s:", me);
     airMopError(mop); return 1;
   }
@@ -540,7 +673,8 @@ nrrdApply1DRegMap(Nrrd *nout, const Nrrd *nin,
   if (_nrrdApply1DSetUp(nout, nin, range, nmap, kindRmap, typeOut,
                         rescale, AIR_FALSE /* multi */)
       || _nrrdApply1DLutOrRegMap(nout, nin, range, nmap, AIR_TRUE /* ramps */,
-                                 rescale, AIR_FALSE /* multi */)) {
+                                 rescale, AIR_FALSE /* multi */,
+                                 AIR_FALSE /* quantize */, 0, 0)) {
     biffAddf(NRRD, "%s:", me);
     airMopError(mop); return 1;
   }
@@ -571,14 +705,100 @@ nrrdApplyMulti1DRegMap(Nrrd *nout, const Nrrd *nin,
   if (_nrrdApply1DSetUp(nout, nin, range, nmmap, kindRmap, typeOut,
                         rescale, AIR_TRUE /* multi */)
       || _nrrdApply1DLutOrRegMap(nout, nin, range, nmmap, AIR_TRUE /* ramps */,
-                                 rescale, AIR_TRUE /* multi */)) {
+                                 rescale, AIR_TRUE /* multi */,
+                                 AIR_FALSE /* quantize */, 0, 0)) {
+    biffAddf(NRRD, "%s:", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+static int
+_nrrdApply1DQuantize(Nrrd *nout, const Nrrd *nin,
+                     const NrrdRange *_range, const Nrrd *nmap,
+                     int ramps, int rescale, double qmin, double qmax) {
+  static const char me[]="_nrrdApply1DQuantize";
+  NrrdRange *range, *qrange;
+  airArray *mop;
+
+  if (!(nout && nmap && nin)) {
+    biffAddf(NRRD, "%s: got NULL pointer", me);
+    return 1;
+  }
+  mop = airMopNew();
+  if (_range) {
+    range = nrrdRangeCopy(_range);
+    nrrdRangeSafeSet(range, nin, nrrdBlind8BitRangeState);
+  } else {
+    range = nrrdRangeNewSet(nin, nrrdBlind8BitRangeState);
+  }
+  airMopAdd(mop, range, (airMopper)nrrdRangeNix, airMopAlways);
+  if (_nrrdApply1DSetUp(nout, nin, range, nmap,
+                        ramps ? kindRmap : kindLut, nrrdTypeUChar,
+                        rescale, AIR_FALSE /* multi */)) {
+    biffAddf(NRRD, "%s:", me);
+    airMopError(mop); return 1;
+  }
+  if (!( AIR_EXISTS(qmin) && AIR_EXISTS(qmax) )) {
+    /* the setup has checked that all the map values exist */
+    qrange = nrrdRangeNewSet(nmap, AIR_FALSE /* blind */);
+    airMopAdd(mop, qrange, (airMopper)nrrdRangeNix, airMopAlways);
+    qmin = AIR_EXISTS(qmin) ? qmin : qrange->min;
+    qmax = AIR_EXISTS(qmax) ? qmax : qrange->max;
+  }
+  if (_nrrdApply1DLutOrRegMap(nout, nin, range, nmap, ramps,
+                              rescale, AIR_FALSE /* multi */,
+                              AIR_TRUE /* quantize */, qmin, qmax)) {
     biffAddf(NRRD, "%s:", me);
     airMopError(mop); return 1;
   }
+  nout->oldMin = qmin;
+  nout->oldMax = qmax;
   airMopOkay(mop);
   return 0;
 }
 
+/*
+******** nrrdApply1DLutQuantize, nrrdApply1DRegMapQuantize
+**
+** like nrrdApply1DLut and nrrdApply1DRegMap, but with unsigned char
+** output: map values are quantized to 8 bits, over the range [qmin,qmax],
+** as they are stored.  This gives the same result as mapping to double
+** and then calling nrrdQuantize with range [qmin,qmax] (including the
+** setting of oldMin and oldMax), but without the intermediate output.
+** This is meant for colormapping (to RGB or RGBA) prior to display.
+** If either qmin or qmax does not exist, it is set from the range of
+** values in the map.
+*/
+int
+nrrdApply1DLutQuantize(Nrrd *nout, const Nrrd *nin,
+                       const NrrdRange *_range, const Nrrd *nlut,
+                       int rescale, double qmin, double qmax) {
+  static const char me[]="nrrdApply1DLutQuantize";
+
+  if (_nrrdApply1DQuantize(nout, nin, _range, nlut, AIR_FALSE /* ramps */,
+                           rescale, qmin, qmax)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
+
+int
+nrrdApply1DRegMapQuantize(Nrrd *nout, const Nrrd *nin,
+                          const NrrdRange *_range, const Nrrd *nmap,
+                          int rescale, double qmin, double qmax) {
+  static const char me[]="nrrdApply1DRegMapQuantize";
+
+  if (_nrrdApply1DQuantize(nout, nin, _range, nmap, AIR_TRUE /* ramps */,
+                           rescale, qmin, qmax)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
+
 /*
 ******** nrrd1DIrregMapCheck()
 **
@@ -856,6 +1076,113 @@ nrrd1DIrregAclGenerate(Nrrd *nacl, const Nrrd *nmap, size_t aclLen) {
   return 0;
 }
 
+/* the state shared by the threads of nrrdApply1DIrregMap */
+typedef struct {
+  const char *inData, *mapData;
+  char *outData;
+  const double *pos;
+  const unsigned short *acl;
+  const NrrdRange *range;
+  double (*mapLup)(const void *v, size_t I),
+    (*inLoad)(const void *v), (*outInsert)(void *v, size_t I, double d);
+  double domMin, domMax;
+  int entLen, posLen, aclLen, entSize, colSize, inSize, baseI, rescale;
+} _nrrdApply1DIrregParm;
+
+static void
+_nrrdApply1DIrregMapBody(void *_parm, unsigned int threadIdx,
+                         size_t lo, size_t hi) {
+  static const char me[]="nrrdApply1DIrregMap";
+  _nrrdApply1DIrregParm *parm;
+  size_t I;
+  int i, entLen, mapIdx, aclIdx, aclLo, aclHi, baseI;
+  double val, domMin, domMax, mapIdxFrac;
+  const double *pos;
+  const char *inData, *entData0, *entData1;
+  char *outData;
+
+  parm = AIR_CAST(_nrrdApply1DIrregParm *, _parm);
+  AIR_UNUSED(threadIdx);
+  inData = parm->inData + lo*parm->inSize;
+  outData = parm->outData + lo*parm->colSize;
+  entLen = parm->entLen;
+  baseI = parm->baseI;
+  pos = parm->pos;
+  domMin = parm->domMin;
+  domMax = parm->domMax;
+  for (I=lo;
+       I<hi;
+       I++, inData += parm->inSize, outData += parm->colSize) {
+    val = parm->inLoad(inData);
+    if (!AIR_EXISTS(val)) {
+      /* got a non-existent value */
+      if (baseI) {
+        /* and we know how to deal with them */
+        switch (airFPClass_d(val)) {
+        case airFP_NEG_INF:
+          mapIdx = 0;
+          break;
+        case airFP_SNAN:
+        case airFP_QNAN:
+          mapIdx = 1;
+          break;
+        case airFP_POS_INF:
+          mapIdx = 2;
+          break;
+        default:
+          mapIdx = 0;
+          fprintf(stderr, "%s: PANIC: non-existent value/class %g/%d "
+                  "not handled\n",
+                  me, val, airFPClass_d(val));
+          exit(1);
+        }
+        entData0 = parm->mapData + mapIdx*parm->entSize;
+        for (i=1; i<entLen; i++) {
+          parm->outInsert(outData, i-1, parm->mapLup(entData0, i));
+        }
+        continue;  /* we're done! (with this value) */
+      } else {
+        /* we don't know how to properly deal with this non-existent value:
+           we use the first entry, and then fall through to code below */
+        mapIdx = 0;
+        mapIdxFrac = 0.0;
+      }
+    } else {
+      /* we have an existent value */
+      if (parm->rescale) {
+        val = (parm->range->min != parm->range->max
+               ? AIR_AFFINE(parm->range->min, val, parm->range->max,
+                            domMin, domMax)
+               : domMin);
+      }
+      val = AIR_CLAMP(domMin, val, domMax);
+      if (parm->acl) {
+        aclIdx = airIndex(domMin, val, domMax, parm->aclLen);
+        aclLo = parm->acl[0 + 2*aclIdx];
+        aclHi = parm->acl[1 + 2*aclIdx];
+      } else {
+        aclLo = 0;
+        aclHi = parm->posLen-2;
+      }
+      if (aclLo < aclHi) {
+        mapIdx = _nrrd1DIrregFindInterval(pos, val, aclLo, aclHi);
+      } else {
+        /* acl did its job ==> aclLo == aclHi */
+        mapIdx = aclLo;
+      }
+    }
+    mapIdxFrac = AIR_AFFINE(pos[mapIdx], val, pos[mapIdx+1], 0.0, 1.0);
+    entData0 = parm->mapData + (baseI+mapIdx)*parm->entSize;
+    entData1 = parm->mapData + (baseI+mapIdx+1)*parm->entSize;
+    for (i=1; i<entLen; i++) {
+      val = ((1-mapIdxFrac)*parm->mapLup(entData0, i) +
+             mapIdxFrac*parm->mapLup(entData1, i));
+      parm->outInsert(outData, i-1, val);
+    }
+  }
+  return;
+}
+
 /*
 ******** nrrdApply1DIrregMap()
 **
@@ -877,26 +1204,19 @@ nrrd1DIrregAclGenerate(Nrrd *nacl, const Nrrd *nmap, size_t aclLen) {
 **
 ** This assumes that nrrd1DIrregMapCheck has been called on "nmap",
 ** and that nrrd1DIrregAclCheck has been called on "nacl" (if it is
-** non-NULL).
+** non-NULL).  The per-value work is split among nrrdStateThreadNum
+** threads.
 */
 int
 nrrdApply1DIrregMap(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
                     const Nrrd *nmap, const Nrrd *nacl,
                     int typeOut, int rescale) {
   static const char me[]="nrrdApply1DIrregMap";
-  size_t N, I;
-  int i, *acl, entLen, posLen, aclLen, mapIdx, aclIdx,
-    entSize, colSize, inSize, lo, hi, baseI;
-  double val, *pos, domMin, domMax, mapIdxFrac,
-    (*mapLup)(const void *v, size_t I),
-    (*inLoad)(const void *v), (*outInsert)(void *v, size_t I, double d);
-  char *inData, *outData, *entData0, *entData1;
+  _nrrdApply1DIrregParm parm;
+  double *pos;
   NrrdRange *range;
   airArray *mop;
 
-  /*
-  fprintf(stderr, "!%s: rescale = %d\n", me, rescale);
-  */
   if (!(nout && nmap && nin)) {
     biffAddf(NRRD, "%s: got NULL pointer", me);
     return 1;
@@ -920,119 +1240,39 @@ nrrdApply1DIrregMap(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
   }
 
   if (nacl) {
-    acl = (int *)nacl->data;
-    aclLen = AIR_CAST(unsigned int,nacl->axis[1].size);
+    /* nrrd1DIrregAclCheck has made sure that this is unsigned short */
+    parm.acl = (const unsigned short *)nacl->data;
+    parm.aclLen = AIR_CAST(unsigned int, nacl->axis[1].size);
   } else {
-    acl = NULL;
-    aclLen = 0;
+    parm.acl = NULL;
+    parm.aclLen = 0;
   }
-  pos = _nrrd1DIrregMapDomain(&posLen, &baseI, nmap);
+  pos = _nrrd1DIrregMapDomain(&(parm.posLen), &(parm.baseI), nmap);
   if (!pos) {
     biffAddf(NRRD, "%s: couldn't determine domain", me);
     airMopError(mop); return 1;
   }
   airMopAdd(mop, pos, airFree, airMopAlways);
-  mapLup = nrrdDLookup[nmap->type];
+  parm.pos = pos;
+  parm.range = range;
+  parm.rescale = rescale;
+  parm.mapData = (const char *)nmap->data;
+  parm.inData = (const char *)nin->data;
+  parm.inLoad = nrrdDLoad[nin->type];
+  parm.inSize = AIR_CAST(unsigned int,nrrdElementSize(nin));
+  parm.mapLup = nrrdDLookup[nmap->type];
+  parm.entLen = AIR_CAST(unsigned int,nmap->axis[0].size);    /* entLen is really 1 + entry length */
+  parm.entSize = parm.entLen*AIR_CAST(unsigned int,nrrdElementSize(nmap));
+  parm.colSize = (parm.entLen-1)*AIR_CAST(unsigned int,nrrdTypeSize[typeOut]);
+  parm.outData = (char *)nout->data;
+  parm.outInsert = nrrdDInsert[nout->type];
+  parm.domMin = pos[0];
+  parm.domMax = pos[parm.posLen-1];
 
-  inData = (char *)nin->data;
-  inLoad = nrrdDLoad[nin->type];
-  inSize = AIR_CAST(unsigned int,nrrdElementSize(nin));
-  mapLup = nrrdDLookup[nmap->type];
-  entLen = AIR_CAST(unsigned int,nmap->axis[0].size);    /* entLen is really 1 + entry length */
-  entSize = entLen*AIR_CAST(unsigned int,nrrdElementSize(nmap));
-  colSize = (entLen-1)*AIR_CAST(unsigned int,nrrdTypeSize[typeOut]);
-  outData = (char *)nout->data;
-  outInsert = nrrdDInsert[nout->type];
-  domMin = pos[0];
-  domMax = pos[posLen-1];
-  /*
-  fprintf(stderr, "!%s: domMin, domMax = %g, %g\n", me, domMin, domMax);
-  */
-
-  N = nrrdElementNumber(nin);
-  for (I=0;
-       I<N;
-       I++, inData += inSize, outData += colSize) {
-    val = inLoad(inData);
-    /*
-    fprintf(stderr, "!%s: (%d) val = % 31.15f\n", me, (int)I, val);
-    */
-    if (!AIR_EXISTS(val)) {
-      /* got a non-existent value */
-      if (baseI) {
-        /* and we know how to deal with them */
-        switch (airFPClass_d(val)) {
-        case airFP_NEG_INF:
-          mapIdx = 0;
-          break;
-        case airFP_SNAN:
-        case airFP_QNAN:
-          mapIdx = 1;
-          break;
-        case airFP_POS_INF:
-          mapIdx = 2;
-          break;
-        default:
-          mapIdx = 0;
-          fprintf(stderr, "%s: PANIC: non-existent value/class %g/%d "
-                  "not handled\n",
-                  me, val, airFPClass_d(val));
-          exit(1);
-        }
-        entData0 = (char*)(nmap->data) + mapIdx*entSize;
-        for (i=1; i<entLen; i++) {
-          outInsert(outData, i-1, mapLup(entData0, i));
-        }
-        continue;  /* we're done! (with this value) */
-      } else {
-        /* we don't know how to properly deal with this non-existent value:
-           we use the first entry, and then fall through to code below */
-        mapIdx = 0;
-        mapIdxFrac = 0.0;
-      }
-    } else {
-      /* we have an existent value */
-      if (rescale) {
-        val = (range->min != range->max
-               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
-               : domMin);
-      }
-      val = AIR_CLAMP(domMin, val, domMax);
-      if (acl) {
-        aclIdx = airIndex(domMin, val, domMax, aclLen);
-        lo = acl[0 + 2*aclIdx];
-        hi = acl[1 + 2*aclIdx];
-      } else {
-        lo = 0;
-        hi = posLen-2;
-      }
-      if (lo < hi) {
-        mapIdx = _nrrd1DIrregFindInterval(pos, val, lo, hi);
-      } else {
-        /* acl did its job ==> lo == hi */
-        mapIdx = lo;
-      }
-      /*
-      fprintf(stderr, "!%s:   --> val = %g; lo,hi = %d,%d, mapIdx = %d\n",
-              me, val, lo, hi, mapIdx);
-      */
-    }
-    mapIdxFrac = AIR_AFFINE(pos[mapIdx], val, pos[mapIdx+1], 0.0, 1.0);
-    /*
-    fprintf(stderr, "!%s:    mapIdxFrac = %g\n", me, mapIdxFrac);
-    */
-    entData0 = (char*)(nmap->data) + (baseI+mapIdx)*entSize;
-    entData1 = (char*)(nmap->data) + (baseI+mapIdx+1)*entSize;
-    for (i=1; i<entLen; i++) {
-      val = ((1-mapIdxFrac)*mapLup(entData0, i) +
-             mapIdxFrac*mapLup(entData1, i));
-      /*
-      fprintf(stderr, "!%s: %g * %g   +   %g * %g = %g\n", me,
-              1-mapIdxFrac, mapLup(entData0, i),
-              mapIdxFrac, mapLup(entData1, i), val);
-      */
-      outInsert(outData, i-1, val);
-    }
+  if (_nrrdThreadRun(_nrrdApply1DIrregMapBody, &parm,
+                     nrrdElementNumber(nin))) {
+    biffAddf(NRRD, "%s: trouble mapping", me);
+    airMopError(mop); return 1;
   }
   airMopOkay(mop);
   return 0;
@@ -185,13 +185,100 @@ _nrrdApply2DSetUp(Nrrd *nout, const Nrrd *nin,
   return 0;
 }
 
+/* the state shared by the threads of _nrrdApply2DLutOrRegMap */
+typedef struct {
+  const char *inData;
+  char *outData;
+  const double *mapD;
+  const unsigned int *tab0, *tab1;
+  const NrrdRange *range0, *range1;
+  double (*inLoad)(const void *v), (*outInsert)(void *v, size_t I, double d);
+  double domMin0, domMax0, domMin1, domMax1;
+  size_t N;
+  unsigned int mapLen0, mapLen1, entLen, inSize, outSize;
+  int inType, tabMin, rescale0, rescale1;
+} _nrrdApply2DParm;
+
+/* learning the map indices of one value pair from the tables */
+#define TAB_IDX(TYPE)                                                   \
+  mapIdx0 = parm->tab0[*AIR_CAST(const TYPE *, inData) - parm->tabMin]; \
+  mapIdx1 = parm->tab1[*AIR_CAST(const TYPE *, inData + parm->inSize)   \
+                       - parm->tabMin]
+
+static void
+_nrrdApply2DLutBody(void *_parm, unsigned int threadIdx,
+                    size_t lo, size_t hi) {
+  _nrrdApply2DParm *parm;
+  const char *inData;
+  char *outData;
+  const double *entData;
+  size_t I;
+  double val0, val1;
+  unsigned int i, entLen, mapIdx0, mapIdx1;
+
+  parm = AIR_CAST(_nrrdApply2DParm *, _parm);
+  AIR_UNUSED(threadIdx);
+  inData = parm->inData + 2*lo*parm->inSize;
+  outData = parm->outData + lo*parm->outSize;
+  entLen = parm->entLen;
+  for (I=lo; I<hi; I++) {
+    if (parm->tab0) {
+      /* integral values always exist */
+      switch (parm->inType) {
+      case nrrdTypeChar:   TAB_IDX(signed char);    break;
+      case nrrdTypeUChar:  TAB_IDX(unsigned char);  break;
+      case nrrdTypeShort:  TAB_IDX(signed short);   break;
+      default:             TAB_IDX(unsigned short); break;
+      }
+      entData = parm->mapD + entLen*(mapIdx0 + parm->mapLen0*mapIdx1);
+      for (i=0; i<entLen; i++) {
+        parm->outInsert(outData, i, entData[i]);
+      }
+      inData += 2*parm->inSize;
+      outData += parm->outSize;
+      continue;
+    }
+    val0 = parm->inLoad(inData + 0*parm->inSize);
+    val1 = parm->inLoad(inData + 1*parm->inSize);
+    if (parm->rescale0) {
+      val0 = AIR_AFFINE(parm->range0->min, val0, parm->range0->max,
+                        parm->domMin0, parm->domMax0);
+    }
+    if (parm->rescale1) {
+      val1 = AIR_AFFINE(parm->range1->min, val1, parm->range1->max,
+                        parm->domMin1, parm->domMax1);
+    }
+    if (AIR_EXISTS(val0) && AIR_EXISTS(val1)) {
+      mapIdx0 = airIndexClamp(parm->domMin0, val0, parm->domMax0,
+                              parm->mapLen0);
+      mapIdx1 = airIndexClamp(parm->domMin1, val1, parm->domMax1,
+                              parm->mapLen1);
+      entData = parm->mapD + entLen*(mapIdx0 + parm->mapLen0*mapIdx1);
+      for (i=0; i<entLen; i++) {
+        parm->outInsert(outData, i, entData[i]);
+      }
+    } else {
+      /* copy non-existent values from input to output */
+      for (i=0; i<entLen; i++) {
+        parm->outInsert(outData, i, val0 + val1);  /* HEY this is weird */
+      }
+    }
+    inData += 2*parm->inSize;
+    outData += parm->outSize;
+  }
+  return;
+}
+
 /*
 ** _nrrdApply2DLutOrRegMap()
 **
 ** the guts of nrrdApply2DLut and nrrdApply2DRegMap
 **
-** yikes, does NOT use biff, since we're only supposed to be called
-** after copious error checking.
+** only supposed to be called after copious error checking; the only
+** errors (reported with biff) are from allocating or threading.  The
+** per-value work is split among nrrdStateThreadNum threads, and for
+** 8 and 16 bit integral input, the map index along each map axis is
+** computed once per possible input value.
 **
 ** FOR INSTANCE, this allows nout == nin, which could be a big
 ** problem if mapAxis == 1.
@@ -211,75 +298,114 @@ _nrrdApply2DLutOrRegMap(Nrrd *nout, const Nrrd *nin,
                         const Nrrd *nmap, int ramps,
                         int rescale0, int rescale1) {
   static const char me[]="_nrrdApply2DLutOrRegMap";
-  char *inData, *outData, *mapData, *entData;
-  size_t N, I;
-  double (*inLoad)(const void *v), (*mapLup)(const void *v, size_t I),
-    (*outInsert)(void *v, size_t I, double d),
-    val0, val1, domMin0, domMax0, domMin1, domMax1;
-  unsigned int i, mapAxis, mapLen0, mapLen1, mapIdx0, mapIdx1,
-    entSize, entLen, inSize, outSize;
+  _nrrdApply2DParm parm;
+  unsigned int mapAxis, ti, tabLen, *tab;
+  size_t mi, mapNum;
+  double *mapD, val;
+  airArray *mop;
 
+  if (ramps) {
+    fprintf(stderr, "%s: PANIC: unimplemented\n", me);
+    exit(1);
+  }
   mapAxis = nmap->dim - 2;             /* axis of nmap containing entries */
-  mapData = (char *)nmap->data;        /* map data, as char* */
                                        /* low end of map domain */
-  domMin0 = _nrrdApplyDomainMin(nmap, ramps, mapAxis + 0);
-  domMin1 = _nrrdApplyDomainMin(nmap, ramps, mapAxis + 1);
+  parm.domMin0 = _nrrdApplyDomainMin(nmap, ramps, mapAxis + 0);
+  parm.domMin1 = _nrrdApplyDomainMin(nmap, ramps, mapAxis + 1);
                                        /* high end of map domain */
-  domMax0 = _nrrdApplyDomainMax(nmap, ramps, mapAxis + 0);
-  domMax1 = _nrrdApplyDomainMax(nmap, ramps, mapAxis + 1);
-  mapLen0 = AIR_CAST(unsigned int, nmap->axis[mapAxis+0].size);   /* number of entries in map axis 0 */
-  mapLen1 = AIR_CAST(unsigned int, nmap->axis[mapAxis+1].size);   /* number of entries in map axis 1 */
-  mapLup = nrrdDLookup[nmap->type];    /* how to get doubles out of map */
-  inData = (char *)nin->data;          /* input data, as char* */
-  inLoad = nrrdDLoad[nin->type];       /* how to get doubles out of nin */
-  inSize = AIR_CAST(unsigned int, nrrdElementSize(nin));       /* size of one input value */
-  outData = (char *)nout->data;        /* output data, as char* */
-  outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
-  entLen = (mapAxis                    /* number of elements in one entry */
-            ? AIR_CAST(unsigned int, nmap->axis[0].size)
-            : 1);
-  outSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nout)); /* size of entry in output */
-  entSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nmap)); /* size of entry in map */
+  parm.domMax0 = _nrrdApplyDomainMax(nmap, ramps, mapAxis + 0);
+  parm.domMax1 = _nrrdApplyDomainMax(nmap, ramps, mapAxis + 1);
+                                       /* number of entries in map axis 0 */
+  parm.mapLen0 = AIR_CAST(unsigned int, nmap->axis[mapAxis+0].size);
+                                       /* number of entries in map axis 1 */
+  parm.mapLen1 = AIR_CAST(unsigned int, nmap->axis[mapAxis+1].size);
+  parm.inData = (const char *)nin->data; /* input data, as char* */
+  parm.inLoad = nrrdDLoad[nin->type];  /* how to get doubles out of nin */
+  parm.inType = nin->type;
+                                       /* size of one input value */
+  parm.inSize = AIR_CAST(unsigned int, nrrdElementSize(nin));
+  parm.outData = (char *)nout->data;   /* output data, as char* */
+  parm.outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
+  parm.entLen = (mapAxis               /* number of elements in one entry */
+                 ? AIR_CAST(unsigned int, nmap->axis[0].size)
+                 : 1);
+                                       /* size of entry in output */
+  parm.outSize = parm.entLen*AIR_CAST(unsigned int, nrrdElementSize(nout));
+  parm.range0 = range0;
+  parm.range1 = range1;
+  parm.rescale0 = rescale0;
+  parm.rescale1 = rescale1;
+  parm.tab0 = parm.tab1 = NULL;
+  parm.tabMin = 0;
 
   /*
   fprintf(stderr, "!%s: entLen = %u, mapLen = %u,%u\n", me,
-          entLen, mapLen0, mapLen1);
+          parm.entLen, parm.mapLen0, parm.mapLen1);
   */
 
-  N = nrrdElementNumber(nin)/2;       /* number of value pairs to be mapped */
-  /* _VV = 1; */
-  if (ramps) {
-    fprintf(stderr, "%s: PANIC: unimplemented\n", me);
-    exit(1);
-  } else {
-    /* lookup table */
-    for (I=0; I<N; I++) {
-      val0 = inLoad(inData + 0*inSize);
-      val1 = inLoad(inData + 1*inSize);
+  mop = airMopNew();
+  /* the map, as doubles, so that the inner loop avoids nrrdDLookup */
+  mapNum = AIR_CAST(size_t, parm.entLen)*parm.mapLen0*parm.mapLen1;
+  mapD = AIR_CALLOC(mapNum, double);
+  if (!mapD) {
+    biffAddf(NRRD, "%s: couldn't allocate %u-by-%u map", me,
+             parm.mapLen0, parm.mapLen1);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, mapD, airFree, airMopAlways);
+  for (mi=0; mi<mapNum; mi++) {
+    mapD[mi] = nrrdDLookup[nmap->type](nmap->data, mi);
+  }
+  parm.mapD = mapD;
+  /* number of value pairs to be mapped */
+  parm.N = nrrdElementNumber(nin)/2;
+  switch (nin->type) {
+  case nrrdTypeChar:
+  case nrrdTypeUChar:
+    tabLen = 1 << 8;
+    break;
+  case nrrdTypeShort:
+  case nrrdTypeUShort:
+    tabLen = 1 << 16;
+    break;
+  default:
+    tabLen = 0;
+    break;
+  }
+  if (tabLen && parm.N > 2*tabLen) {
+    /* for 8 and 16 bit integral input, the map index along each axis is
+       learned once per possible input value, and then looked up */
+    tab = AIR_CALLOC(2*tabLen, unsigned int);
+    if (!tab) {
+      biffAddf(NRRD, "%s: couldn't allocate %u-entry tables", me, tabLen);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, tab, airFree, airMopAlways);
+    parm.tabMin = AIR_CAST(int, nrrdTypeMin[nin->type]);
+    for (ti=0; ti<tabLen; ti++) {
+      val = parm.tabMin + AIR_CAST(int, ti);
       if (rescale0) {
-        val0 = AIR_AFFINE(range0->min, val0, range0->max, domMin0, domMax0);
+        val = AIR_AFFINE(range0->min, val, range0->max,
+                         parm.domMin0, parm.domMax0);
       }
+      tab[ti] = airIndexClamp(parm.domMin0, val, parm.domMax0, parm.mapLen0);
+      val = parm.tabMin + AIR_CAST(int, ti);
       if (rescale1) {
-        val1 = AIR_AFFINE(range1->min, val1, range1->max, domMin1, domMax1);
+        val = AIR_AFFINE(range1->min, val, range1->max,
+                         parm.domMin1, parm.domMax1);
       }
-      if (AIR_EXISTS(val0) && AIR_EXISTS(val1)) {
-        mapIdx0 = airIndexClamp(domMin0, val0, domMax0, mapLen0);
-        mapIdx1 = airIndexClamp(domMin1, val1, domMax1, mapLen1);
-        entData = mapData + entSize*(mapIdx0 + mapLen0*mapIdx1);
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, mapLup(entData, i));
-        }
-      } else {
-        /* copy non-existent values from input to output */
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, val0 + val1);  /* HEY this is weird */
-        }
-      }
-      inData += 2*inSize;
-      outData += outSize;
+      tab[ti + tabLen] = airIndexClamp(parm.domMin1, val, parm.domMax1,
+                                       parm.mapLen1);
     }
+    parm.tab0 = tab;
+    parm.tab1 = tab + tabLen;
+  }
+  if (_nrrdThreadRun(_nrrdApply2DLutBody, &parm, parm.N)) {
+    biffAddf(NRRD, "%s: trouble mapping", me);
+    airMopError(mop); return 1;
   }
 
+  airMopOkay(mop);
   return 0;
 }
 
@@ -125,22 +125,122 @@ _nrrdClCv##TA##TB(TA *a, const TB *b, IT N) { \
 **
 ** like _nrrdClCv<Ta><Tb>() and _nrrdConv<Ta><Tb>(), but with the
 ** ability to control if there is rounding and/or clamping. As above,
-** there may be loss of precision with long long input.
+** there may be loss of precision with long long input.  The choice of
+** rounding and clamping is made once, outside the loops, so that each
+** loop body is simple enough for the compiler to vectorize.
 */
+#define CCRD_LOOP(TA, EXPR)                                     \
+  for (ii=0; ii<N; ii++) {                                      \
+    double ccrdTmp = AIR_CAST(double, b[ii]);                   \
+    a[ii] = AIR_CAST(TA, EXPR);                                 \
+  }
 #define CCRD_DEF(TA, TB)                                        \
 static void                                                     \
  _nrrdCcrd##TA##TB(TA *a, const TB *b, IT N,                    \
                    int doClamp, int roundd) {                   \
-   size_t ii;                                                   \
+  size_t ii;                                                    \
+  if (roundd > 0) {                                             \
+    if (doClamp) {                                              \
+      CCRD_LOOP(TA, _nrrdDClamp##TA(_nrrdRoundUp(ccrdTmp)));    \
+    } else {                                                    \
+      CCRD_LOOP(TA, _nrrdRoundUp(ccrdTmp));                     \
+    }                                                           \
+  } else if (roundd < 0) {                                      \
+    if (doClamp) {                                              \
+      CCRD_LOOP(TA, _nrrdDClamp##TA(_nrrdRoundDown(ccrdTmp)));  \
+    } else {                                                    \
+      CCRD_LOOP(TA, _nrrdRoundDown(ccrdTmp));                   \
+    }                                                           \
+  } else {                                                      \
+    if (doClamp) {                                              \
+      CCRD_LOOP(TA, _nrrdDClamp##TA(ccrdTmp));                  \
+    } else {                                                    \
+      CCRD_LOOP(TA, ccrdTmp);                                   \
+    }                                                           \
+  }                                                             \
+}
+
+/*
+** _nrrdQntz<Tb>()
+**
+** the inner loop of nrrdQuantize(): clamps values of type Tb to
+** [min,max], and maps them to 8, 16, or 32 bit unsigned integers,
+** giving exactly what airIndex() (or airIndexULL() for 32 bits) would
+** give with min, max+eps, and 2^bits.  The unusual case of max+eps
+** not being greater than min is passed off to airIndex()
+*/
+#define QNTZ_LOOP(TA, TI, NV)                                   \
   for (ii=0; ii<N; ii++) {                                      \
-    double ccrdTmp = AIR_CAST(double, b[ii]);                   \
-    ccrdTmp = (roundd > 0                                       \
-               ? floor(ccrdTmp + 0.5)                           \
-               : (roundd < 0                                    \
-                  ? ceil(ccrdTmp - 0.5)                         \
-                  : ccrdTmp));                                  \
-    ccrdTmp = (doClamp ? _nrrdDClamp##TA(ccrdTmp) : ccrdTmp);   \
-    a[ii] = AIR_CAST(TA, ccrdTmp);                              \
+    double qntzTmp = AIR_CAST(double, b[ii]);                   \
+    TI qntzIdx;                                                 \
+    qntzTmp = AIR_CLAMP(min, qntzTmp, max);                     \
+    qntzIdx = AIR_CAST(TI, (NV)*(qntzTmp - min)/mnm);           \
+    AIR_CAST(TA *, a)[ii] = AIR_CAST(TA, qntzIdx                \
+                                     - (qntzIdx == (NV)));      \
+  }
+#define QNTZ_DEF(_dummy_, TB)                                   \
+static void                                                     \
+_nrrdQntz##TB(void *a, const TB *b, IT N, unsigned int bits,    \
+              double min, double max, double eps) {             \
+  size_t ii;                                                    \
+  double mnm;                                                   \
+  mnm = max + eps - min;                                        \
+  if (mnm > 0) {                                                \
+    switch (bits) {                                             \
+    case 8:                                                     \
+      QNTZ_LOOP(UC, UI, 256.0);                                 \
+      break;                                                    \
+    case 16:                                                    \
+      QNTZ_LOOP(US, UI, 65536.0);                               \
+      break;                                                    \
+    case 32:                                                    \
+      QNTZ_LOOP(UI, airULLong, 4294967296.0);                   \
+      break;                                                    \
+    }                                                           \
+  } else {                                                      \
+    for (ii=0; ii<N; ii++) {                                    \
+      double qntzTmp = AIR_CAST(double, b[ii]);                 \
+      qntzTmp = AIR_CLAMP(min, qntzTmp, max);                   \
+      switch (bits) {                                           \
+      case 8:                                                   \
+        AIR_CAST(UC *, a)[ii] = AIR_CAST(UC,                    \
+          airIndex(min, qntzTmp, max+eps, 1 << 8));             \
+        break;                                                  \
+      case 16:                                                  \
+        AIR_CAST(US *, a)[ii] = AIR_CAST(US,                    \
+          airIndex(min, qntzTmp, max+eps, 1 << 16));            \
+        break;                                                  \
+      case 32:                                                  \
+        AIR_CAST(UI *, a)[ii] = AIR_CAST(UI,                    \
+          airIndexULL(min, qntzTmp, max+eps, AIR_ULLONG(1) << 32)); \
+        break;                                                  \
+      }                                                         \
+    }                                                           \
+  }                                                             \
+}
+
+/*
+** _nrrdUnqz<Tb>()
+**
+** the inner loop of nrrdUnquantize(): maps (integral) values of type Tb
+** to float or double (according to outType) cell-centered positions
+*/
+#define UNQZ_LOOP(TA)                                           \
+  for (ii=0; ii<N; ii++) {                                      \
+    double unqzTmp = minIn + AIR_CAST(double, b[ii]);           \
+    AIR_CAST(TA *, a)[ii] =                                     \
+      AIR_CAST(TA, NRRD_CELL_POS(minOut, maxOut, numValIn, unqzTmp)); \
+  }
+#define UNQZ_DEF(_dummy_, TB)                                   \
+static void                                                     \
+_nrrdUnqz##TB(void *a, int outType, const TB *b, IT N,          \
+              double minIn, double numValIn,                    \
+              double minOut, double maxOut) {                   \
+  size_t ii;                                                    \
+  if (nrrdTypeFloat == outType) {                               \
+    UNQZ_LOOP(FL);                                              \
+  } else {                                                      \
+    UNQZ_LOOP(DB);                                              \
   }                                                             \
 }
 
@@ -149,6 +249,10 @@ static void                                                     \
 */
 typedef void (*CF)(void *, const void *, IT);
 typedef void (*CN)(void *, const void *, IT, int, int);
+typedef void (*QN)(void *, const void *, IT, unsigned int,
+                   double, double, double);
+typedef void (*UN)(void *, int, const void *, IT,
+                   double, double, double, double);
 
 /*
 ** the individual converter's appearance in the array initialization,
@@ -157,6 +261,8 @@ typedef void (*CN)(void *, const void *, IT, int, int);
 #define CONV_LIST(TA, TB) (CF)_nrrdConv##TA##TB,
 #define CLCV_LIST(TA, TB) (CF)_nrrdClCv##TA##TB,
 #define CCRD_LIST(TA, TB) (CN)_nrrdCcrd##TA##TB,
+#define QNTZ_LIST(_dummy_, TB) (QN)_nrrdQntz##TB,
+#define UNQZ_LIST(_dummy_, TB) (UN)_nrrdUnqz##TB,
 
 /*
 ** the brace-delimited list of all converters _to_ type TA
@@ -242,6 +348,37 @@ nrrdDClamp[NRRD_TYPE_MAX+1])(DB) = {
   _nrrdDClampDB,
   NULL};
 
+/*
+** _nrrdRoundUp, _nrrdRoundDown
+**
+** exactly floor(v + 0.5) and ceil(v - 0.5), respectively, but without
+** the function calls: values small enough to fit in a long long are
+** truncated (towards zero) by a cast, and then fixed up; larger values
+** (and non-existent ones) are already integral, so they pass through.
+*/
+static double
+_nrrdRoundUp(double v) {
+  double tt, ff;
+
+  tt = v + 0.5;
+  if (!(AIR_ABS(tt) < 4503599627370496.0 /* 2^52 */)) {
+    return tt;
+  }
+  ff = AIR_CAST(double, AIR_CAST(airLLong, tt));
+  return ff - (ff > tt);
+}
+
+static double
+_nrrdRoundDown(double v) {
+  double tt, cc;
+
+  tt = v - 0.5;
+  if (!(AIR_ABS(tt) < 4503599627370496.0 /* 2^52 */)) {
+    return tt;
+  }
+  cc = AIR_CAST(double, AIR_CAST(airLLong, tt));
+  return cc + (cc < tt);
+}
 
 /*
 ** Define all the converters.
@@ -249,6 +386,8 @@ nrrdDClamp[NRRD_TYPE_MAX+1])(DB) = {
 MAP1(MAP2, CONV_DEF)
 MAP1(MAP2, CLCV_DEF)
 MAP1(MAP2, CCRD_DEF)
+MAP1(QNTZ_DEF, _dummy_)
+MAP1(UNQZ_DEF, _dummy_)
 
 
 /*
@@ -278,3 +417,17 @@ _nrrdCastClampRound[NRRD_TYPE_MAX+1][NRRD_TYPE_MAX+1] = {
 MAP1(CCRDTO_LIST, _dummy_)
 {NULL}
 };
+
+QN
+_nrrdQuantize[NRRD_TYPE_MAX+1] = {
+NULL,
+MAP1(QNTZ_LIST, _dummy_)
+NULL
+};
+
+UN
+_nrrdUnquantize[NRRD_TYPE_MAX+1] = {
+NULL,
+MAP1(UNQZ_LIST, _dummy_)
+NULL
+};
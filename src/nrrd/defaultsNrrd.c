@@ -68,6 +68,10 @@ int nrrdStateMeasureType = nrrdTypeFloat;
 int nrrdStateMeasureModeBins = 1024;
 int nrrdStateMeasureHistoType = nrrdTypeFloat;
 int nrrdStateDisallowIntegerNonExist = AIR_TRUE;
+/* how many threads to use in the whole-array value loops (conversion,
+   quantization, ...) that can be split across threads; only arrays
+   with enough values (NRRD_THREAD_GRAIN per thread) are split */
+unsigned int nrrdStateThreadNum = 1;
 /* ---- END non-NrrdIO */
 int nrrdStateAlwaysSetContent = AIR_TRUE;
 int nrrdStateDisableContent = AIR_FALSE;
@@ -142,6 +146,8 @@ const char *const nrrdEnvVarStateMeasureHistoType
   = "NRRD_STATE_MEASURE_HISTO_TYPE";
 const char *const nrrdEnvVarStateGrayscaleImage3D
   = "NRRD_STATE_GRAYSCALE_IMAGE_3D";
+const char *const nrrdEnvVarStateThreadNum
+  = "NRRD_STATE_THREAD_NUM";
 
 /*
 **    return
@@ -346,6 +352,8 @@ nrrdStateGetenv(void) {
                  nrrdEnvVarStateMeasureHistoType);
   nrrdGetenvBool(/**/ &nrrdStateGrayscaleImage3D, NULL,
                  nrrdEnvVarStateGrayscaleImage3D);
+  nrrdGetenvUInt(/**/ &nrrdStateThreadNum, NULL,
+                 nrrdEnvVarStateThreadNum);
 
   return;
 }
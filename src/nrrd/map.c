@@ -133,12 +133,85 @@ nrrdMinMaxCleverSet(Nrrd *nrrd) {
 }
 */
 
+/*
+** the per-thread parts of clampRoundConvert, nrrdQuantize, and
+** nrrdUnquantize: each thread processes values [lo,hi) of the array
+** (see _nrrdThreadRun).  nout == nin is fine because the value sizes
+** are then equal, so the threads' ranges of memory are disjoint.
+*/
+typedef struct {
+  void *out;
+  const void *in;
+  size_t outSize, inSize;
+  int outType, inType, doClamp, roundDir;
+  unsigned int bits;
+  double aa, bb, cc, dd;
+} _nrrdMapParm;
+
+static void
+_nrrdConvertBody(void *_parm, unsigned int threadIdx,
+                 size_t lo, size_t hi) {
+  _nrrdMapParm *parm;
+  char *out;
+  const char *in;
+
+  parm = AIR_CAST(_nrrdMapParm *, _parm);
+  AIR_UNUSED(threadIdx);
+  out = AIR_CAST(char *, parm->out) + lo*parm->outSize;
+  in = AIR_CAST(const char *, parm->in) + lo*parm->inSize;
+  if (parm->roundDir) {
+    _nrrdCastClampRound[parm->outType][parm->inType](out, in, hi - lo,
+                                                     parm->doClamp,
+                                                     parm->roundDir);
+  } else if (parm->doClamp) {
+    _nrrdClampConv[parm->outType][parm->inType](out, in, hi - lo);
+  } else {
+    _nrrdConv[parm->outType][parm->inType](out, in, hi - lo);
+  }
+  return;
+}
+
+static void
+_nrrdQuantizeBody(void *_parm, unsigned int threadIdx,
+                  size_t lo, size_t hi) {
+  _nrrdMapParm *parm;
+
+  parm = AIR_CAST(_nrrdMapParm *, _parm);
+  AIR_UNUSED(threadIdx);
+  /* aa, bb, cc are min, max, eps */
+  _nrrdQuantize[parm->inType](AIR_CAST(char *, parm->out) + lo*parm->outSize,
+                              (AIR_CAST(const char *, parm->in)
+                               + lo*parm->inSize),
+                              hi - lo, parm->bits,
+                              parm->aa, parm->bb, parm->cc);
+  return;
+}
+
+static void
+_nrrdUnquantizeBody(void *_parm, unsigned int threadIdx,
+                    size_t lo, size_t hi) {
+  _nrrdMapParm *parm;
+
+  parm = AIR_CAST(_nrrdMapParm *, _parm);
+  AIR_UNUSED(threadIdx);
+  /* aa, bb, cc, dd are minIn, numValIn, minOut, maxOut */
+  _nrrdUnquantize[parm->inType](AIR_CAST(char *, parm->out)
+                                + lo*parm->outSize,
+                                parm->outType,
+                                (AIR_CAST(const char *, parm->in)
+                                 + lo*parm->inSize),
+                                hi - lo,
+                                parm->aa, parm->bb, parm->cc, parm->dd);
+  return;
+}
+
 static int
 clampRoundConvert(Nrrd *nout, const Nrrd *nin, int type,
                   int doClamp, int roundDir) {
   static const char me[]="clampRoundConvert";
   char typeS[AIR_STRLEN_SMALL];
-  size_t num, size[NRRD_DIM_MAX];
+  size_t size[NRRD_DIM_MAX];
+  _nrrdMapParm parm;
 
   if (!( nin && nout
          && !nrrdCheck(nin)
@@ -190,15 +263,18 @@ clampRoundConvert(Nrrd *nout, const Nrrd *nin, int type,
       return 1;
     }
 
-    /* call the appropriate converter */
-    num = nrrdElementNumber(nin);
-    if (roundDir) {
-      _nrrdCastClampRound[nout->type][nin->type](nout->data, nin->data, num,
-                                                 doClamp, roundDir);
-    } else if (doClamp) {
-      _nrrdClampConv[nout->type][nin->type](nout->data, nin->data, num);
-    } else {
-      _nrrdConv[nout->type][nin->type](nout->data, nin->data, num);
+    /* call the appropriate converter, maybe in multiple threads */
+    parm.out = nout->data;
+    parm.in = nin->data;
+    parm.outSize = nrrdTypeSize[nout->type];
+    parm.inSize = nrrdTypeSize[nin->type];
+    parm.outType = nout->type;
+    parm.inType = nin->type;
+    parm.doClamp = doClamp;
+    parm.roundDir = roundDir;
+    if (_nrrdThreadRun(_nrrdConvertBody, &parm, nrrdElementNumber(nin))) {
+      biffAddf(NRRD, "%s: trouble converting", me);
+      return 1;
     }
     nout->blockSize = 0;
 
@@ -313,14 +389,12 @@ int
 nrrdQuantize(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
              unsigned int bits) {
   static const char me[]="nrrdQuantize", func[]="quantize";
-  double valIn, minIn, maxIn, eps;
+  double minIn, maxIn, eps;
   int type=nrrdTypeUnknown;
-  size_t I, num, size[NRRD_DIM_MAX];
-  unsigned char *outUC;
-  unsigned short *outUS;
-  unsigned int *outUI;
+  size_t size[NRRD_DIM_MAX];
   airArray *mop;
   NrrdRange *range;
+  _nrrdMapParm parm;
 
   if (!(nin && nout)) {
     biffAddf(NRRD, "%s: got NULL pointer", me);
@@ -369,37 +443,21 @@ nrrdQuantize(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
   }
 
   /* the skinny */
-  num = nrrdElementNumber(nin);
   minIn = range->min;
   maxIn = range->max;
   eps = (minIn == maxIn ? 1.0 : 0.0);
-  outUC = (unsigned char*)nout->data;
-  outUS = (unsigned short*)nout->data;
-  outUI = (unsigned int*)nout->data;
-  switch(bits) {
-  case 8:
-    for (I=0; I<num; I++) {
-      valIn = nrrdDLookup[nin->type](nin->data, I);
-      valIn = AIR_CLAMP(minIn, valIn, maxIn);
-      outUC[I] = airIndex(minIn, valIn, maxIn+eps, 1 << 8);
-    }
-    break;
-  case 16:
-    for (I=0; I<num; I++) {
-      valIn = nrrdDLookup[nin->type](nin->data, I);
-      valIn = AIR_CLAMP(minIn, valIn, maxIn);
-      outUS[I] = airIndex(minIn, valIn, maxIn+eps, 1 << 16);
-    }
-    break;
-  case 32:
-    for (I=0; I<num; I++) {
-      valIn = nrrdDLookup[nin->type](nin->data, I);
-      valIn = AIR_CLAMP(minIn, valIn, maxIn);
-      outUI[I] = AIR_CAST(unsigned int,
-                          airIndexULL(minIn, valIn, maxIn+eps,
-                                      AIR_ULLONG(1) << 32));
-    }
-    break;
+  parm.out = nout->data;
+  parm.in = nin->data;
+  parm.outSize = nrrdTypeSize[type];
+  parm.inSize = nrrdTypeSize[nin->type];
+  parm.inType = nin->type;
+  parm.bits = bits;
+  parm.aa = minIn;
+  parm.bb = maxIn;
+  parm.cc = eps;
+  if (_nrrdThreadRun(_nrrdQuantizeBody, &parm, nrrdElementNumber(nin))) {
+    biffAddf(NRRD, "%s: trouble quantizing", me);
+    airMopError(mop); return 1;
   }
 
   /* set information in new volume */
@@ -481,9 +539,9 @@ _nrrdTypeNumberOfValues[NRRD_TYPE_MAX+1] = {
 int
 nrrdUnquantize(Nrrd *nout, const Nrrd *nin, int type) {
   static const char me[]="nrrdUnquantize", func[]="unquantize";
-  float *outF;
-  double *outD, minIn, numValIn, minOut, maxOut, valIn;
-  size_t NN, II, size[NRRD_DIM_MAX];
+  double minIn, numValIn, minOut, maxOut;
+  size_t size[NRRD_DIM_MAX];
+  _nrrdMapParm parm;
 
   if (!(nout && nin)) {
     biffAddf(NRRD, "%s: got NULL pointer", me);
@@ -529,23 +587,19 @@ nrrdUnquantize(Nrrd *nout, const Nrrd *nin, int type) {
     minOut = 0.0;
     maxOut = 1.0;
   }
-  outF = (float*)nout->data;
-  outD = (double*)nout->data;
-  NN = nrrdElementNumber(nin);
-  switch(type) {
-  case nrrdTypeFloat:
-    for (II=0; II<NN; II++) {
-      valIn = minIn + nrrdDLookup[nin->type](nin->data, II);
-      outF[II] = AIR_CAST(float,
-                          NRRD_CELL_POS(minOut, maxOut, numValIn, valIn));
-    }
-    break;
-  case nrrdTypeDouble:
-    for (II=0; II<NN; II++) {
-      valIn = minIn + nrrdDLookup[nin->type](nin->data, II);
-      outD[II] = NRRD_CELL_POS(minOut, maxOut, numValIn, valIn);
-    }
-    break;
+  parm.out = nout->data;
+  parm.in = nin->data;
+  parm.outSize = nrrdTypeSize[type];
+  parm.inSize = nrrdTypeSize[nin->type];
+  parm.outType = type;
+  parm.inType = nin->type;
+  parm.aa = minIn;
+  parm.bb = numValIn;
+  parm.cc = minOut;
+  parm.dd = maxOut;
+  if (_nrrdThreadRun(_nrrdUnquantizeBody, &parm, nrrdElementNumber(nin))) {
+    biffAddf(NRRD, "%s: trouble unquantizing", me);
+    return 1;
   }
 
   /* set information in new volume */
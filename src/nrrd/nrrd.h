@@ -470,6 +470,10 @@ typedef struct {
                        practically: the min and max values to use for nrrd
                        calls for which a min and max values are used */
   int hasNonExist;  /* from the nrrdHasNonExist* enum values */
+  double minErr, maxErr;  /* bounds on how far min and max may be from
+                             the values they are supposed to be; non-zero
+                             only after nrrdRangePercentileSet() with a
+                             histogram (hbins > 0), NaN when unknown */
 } NrrdRange;
 
 /*
@@ -708,6 +712,7 @@ NRRD_EXPORT int nrrdStateMeasureType;
 NRRD_EXPORT int nrrdStateMeasureModeBins;
 NRRD_EXPORT int nrrdStateMeasureHistoType;
 NRRD_EXPORT int nrrdStateDisallowIntegerNonExist;
+NRRD_EXPORT unsigned int nrrdStateThreadNum;
 /* ---- END non-NrrdIO */
 NRRD_EXPORT int nrrdStateAlwaysSetContent;
 NRRD_EXPORT int nrrdStateDisableContent;
@@ -735,6 +740,7 @@ NRRD_EXPORT const char *const nrrdEnvVarStateMeasureType;
 NRRD_EXPORT const char *const nrrdEnvVarStateMeasureModeBins;
 NRRD_EXPORT const char *const nrrdEnvVarStateMeasureHistoType;
 NRRD_EXPORT const char *const nrrdEnvVarStateGrayscaleImage3D;
+NRRD_EXPORT const char *const nrrdEnvVarStateThreadNum;
 NRRD_EXPORT int nrrdGetenvBool(int *val, char **envStr,
                                const char *envVar);
 NRRD_EXPORT int nrrdGetenvEnum(int *val, char **envStr, const airEnum *enm,
@@ -1180,6 +1186,14 @@ NRRD_EXPORT int nrrdApplyMulti1DRegMap(Nrrd *nout, const Nrrd *nin,
                                        const NrrdRange *range,
                                        const Nrrd *nmmap,
                                        int typeOut, int rescale);
+NRRD_EXPORT int nrrdApply1DLutQuantize(Nrrd *nout, const Nrrd *nin,
+                                       const NrrdRange *range,
+                                       const Nrrd *nlut, int rescale,
+                                       double qmin, double qmax);
+NRRD_EXPORT int nrrdApply1DRegMapQuantize(Nrrd *nout, const Nrrd *nin,
+                                          const NrrdRange *range,
+                                          const Nrrd *nmap, int rescale,
+                                          double qmin, double qmax);
 NRRD_EXPORT int nrrd1DIrregMapCheck(const Nrrd *nmap);
 NRRD_EXPORT int nrrd1DIrregAclGenerate(Nrrd *nacl, const Nrrd *nmap,
                                        size_t aclLen);
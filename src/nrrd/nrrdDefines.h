@@ -78,6 +78,12 @@ extern "C" {
 /* ---- BEGIN non-NrrdIO */
 /* suffix string that indicates percentile-based min/max */
 #define NRRD_MINMAX_PERC_SUFF "%"
+/* # histogram bins used by nrrdRangePercentileSet to find exact
+   percentiles (when it is given hbins == 0) */
+#define NRRD_RANGE_PERC_EXACT_BINS 65536
+/* fewest values per thread for which nrrdStateThreadNum threads are
+   used in whole-array value loops; smaller arrays use fewer threads */
+#define NRRD_THREAD_GRAIN 262144
 /* ---- END non-NrrdIO */
 #define NRRD_COMMENT_CHAR '#'
 #define NRRD_FILENAME_INCR 32
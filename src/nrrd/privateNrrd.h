@@ -154,6 +154,22 @@ extern void (*_nrrdClampConv[][NRRD_TYPE_MAX+1])(void *, const void *, size_t);
 extern void (*_nrrdCastClampRound[][NRRD_TYPE_MAX+1])(void *, const void *,
                                                       size_t, int doClamp,
                                                       int roundd);
+extern void (*_nrrdQuantize[NRRD_TYPE_MAX+1])(void *, const void *, size_t,
+                                              unsigned int bits,
+                                              double min, double max,
+                                              double eps);
+extern void (*_nrrdUnquantize[NRRD_TYPE_MAX+1])(void *, int outType,
+                                                const void *, size_t,
+                                                double minIn,
+                                                double numValIn,
+                                                double minOut,
+                                                double maxOut);
+
+/* threadNrrd.c */
+extern unsigned int _nrrdThreadNum(size_t num);
+extern int _nrrdThreadRun(void (*body)(void *parm, unsigned int threadIdx,
+                                        size_t lo, size_t hi),
+                          void *parm, size_t num);
 /* ---- END non-NrrdIO */
 
 /* read.c */
@@ -32,6 +32,7 @@ nrrdRangeNew(double min, double max) {
   if (range) {
     range->min = min;
     range->max = max;
+    range->minErr = range->maxErr = 0.0;
     range->hasNonExist = nrrdHasNonExistUnknown;
   }
   return range;
@@ -43,6 +44,8 @@ nrrdRangeCopy(const NrrdRange *rin) {
 
   if (rin) {
     rout = nrrdRangeNew(rin->min, rin->max);
+    rout->minErr = rin->minErr;
+    rout->maxErr = rin->maxErr;
     rout->hasNonExist = rin->hasNonExist;
   }
   return rout;
@@ -61,6 +64,8 @@ nrrdRangeReset(NrrdRange *range) {
   if (range) {
     range->min = AIR_NAN;
     range->max = AIR_NAN;
+    range->minErr = AIR_NAN;
+    range->maxErr = AIR_NAN;
     range->hasNonExist = nrrdHasNonExistUnknown;
   }
 }
@@ -76,6 +81,7 @@ nrrdRangeSet(NrrdRange *range, const Nrrd *nrrd, int blind8BitRange) {
   if (!range) {
     return;
   }
+  range->minErr = range->maxErr = 0.0;
   if (nrrd
       && !airEnumValCheck(nrrdType, nrrd->type)
       && nrrdTypeBlock != nrrd->type) {
@@ -99,11 +105,123 @@ nrrdRangeSet(NrrdRange *range, const Nrrd *nrrd, int blind8BitRange) {
     }
   } else {
     range->min = range->max = AIR_NAN;
+    range->minErr = range->maxErr = AIR_NAN;
     range->hasNonExist = nrrdHasNonExistUnknown;
   }
   return;
 }
 
+/*
+** state for the (threaded) passes over the values of the nrrd that
+** nrrdRangePercentileSet makes.  Each thread has its own histogram
+** (threadNum histograms of bins doubles are in hist), and in the second
+** pass each thread copies the values in the candidate bins cbin[0] (for
+** the lower percentile) and cbin[1] (upper) into its own stretch of
+** cand[0] and cand[1], starting at candOff[0 + 2*ti] and candOff[1 + 2*ti]
+*/
+typedef struct {
+  const Nrrd *nrrd;
+  size_t num;
+  unsigned int bins, threadNum;
+  double min, max, mnm;  /* mnm = max + (min==max) - min, as in nrrdHisto */
+  double *hist;
+  int want[2];
+  unsigned int cbin[2];
+  double *cand[2];
+  size_t *candOff;
+} _nrrdPercParm;
+
+/* same bin index as airIndex(min, val, max+eps, bins) in nrrdHisto */
+#define PERC_IDX                                       \
+  idx = AIR_UINT(bins*(val - min)/mnm);                \
+  idx -= (idx == bins)
+
+#define PERC_CASE(TT, TYPE)                                   \
+  case TT: {                                                  \
+    const TYPE *data = AIR_CAST(const TYPE *, parm->nrrd->data); \
+    for (II=lo; II<hi; II++) {                                \
+      val = AIR_CAST(double, data[II]);                       \
+      PERC_BODY;                                              \
+    }                                                         \
+  } break
+
+#define PERC_SWITCH                                 \
+  switch (parm->nrrd->type) {                       \
+    PERC_CASE(nrrdTypeChar, signed char);           \
+    PERC_CASE(nrrdTypeUChar, unsigned char);        \
+    PERC_CASE(nrrdTypeShort, signed short);         \
+    PERC_CASE(nrrdTypeUShort, unsigned short);      \
+    PERC_CASE(nrrdTypeInt, signed int);             \
+    PERC_CASE(nrrdTypeUInt, unsigned int);          \
+    PERC_CASE(nrrdTypeLLong, airLLong);             \
+    PERC_CASE(nrrdTypeULLong, airULLong);           \
+    PERC_CASE(nrrdTypeFloat, float);                \
+    PERC_CASE(nrrdTypeDouble, double);              \
+  }
+
+static void
+_nrrdPercHistoBody(void *_parm, unsigned int threadIdx,
+                   size_t lo, size_t hi) {
+  _nrrdPercParm *parm;
+  double val, min, max, mnm, *hist;
+  unsigned int idx, bins;
+  size_t II;
+
+  parm = AIR_CAST(_nrrdPercParm *, _parm);
+  bins = parm->bins;
+  min = parm->min;
+  max = parm->max;
+  mnm = parm->mnm;
+  hist = parm->hist + bins*threadIdx;
+#define PERC_BODY                               \
+  if (AIR_IN_CL(min, val, max)) {               \
+    PERC_IDX;                                   \
+    hist[idx] += 1;                             \
+  }
+  PERC_SWITCH;
+#undef PERC_BODY
+  return;
+}
+
+static void
+_nrrdPercCandBody(void *_parm, unsigned int threadIdx,
+                  size_t lo, size_t hi) {
+  _nrrdPercParm *parm;
+  double val, min, max, mnm, *cand0, *cand1;
+  unsigned int idx, bins, cbin0, cbin1;
+  size_t II, off0, off1;
+
+  parm = AIR_CAST(_nrrdPercParm *, _parm);
+  bins = parm->bins;
+  min = parm->min;
+  max = parm->max;
+  mnm = parm->mnm;
+  /* an unwanted side gets a bin index that is never hit */
+  cbin0 = parm->want[0] ? parm->cbin[0] : bins;
+  cbin1 = parm->want[1] ? parm->cbin[1] : bins;
+  cand0 = parm->cand[0];
+  cand1 = parm->cand[1];
+  off0 = parm->candOff[0 + 2*threadIdx];
+  off1 = parm->candOff[1 + 2*threadIdx];
+#define PERC_BODY                               \
+  if (AIR_IN_CL(min, val, max)) {               \
+    PERC_IDX;                                   \
+    if (idx == cbin0) {                         \
+      cand0[off0++] = val;                      \
+    }                                           \
+    if (idx == cbin1) {                         \
+      cand1[off1++] = val;                      \
+    }                                           \
+  }
+  PERC_SWITCH;
+#undef PERC_BODY
+  return;
+}
+
+#undef PERC_IDX
+#undef PERC_CASE
+#undef PERC_SWITCH
+
 /*
 ******** nrrdRangePercentileSet
 **
@@ -111,6 +229,18 @@ nrrdRangeSet(NrrdRange *range, const Nrrd *nrrd, int blind8BitRange) {
 ** nrrd is requested; and the learned information is put into "range"
 ** (overwriting whatever is there!)
 **
+** minPerc and maxPerc are the percentages of values to be below
+** range->min and above range->max, respectively.  With hbins > 0, they
+** are found (as always) from a histogram with hbins bins, and
+** range->minErr and range->maxErr are set to a bound on how far
+** range->min and range->max are from the exact percentile values (the
+** width of the histogram bin, more or less).  With hbins == 0, the
+** exact values are found: a histogram with NRRD_RANGE_PERC_EXACT_BINS
+** bins locates the bin containing each percentile value, and a second
+** pass sorts only the values in that bin, so minErr and maxErr are 0.
+** Either way the passes over the values are threaded (according to
+** nrrdStateThreadNum).
+**
 ** uses biff
 */
 int
@@ -119,9 +249,12 @@ nrrdRangePercentileSet(NrrdRange *range, const Nrrd *nrrd,
                        unsigned int hbins, int blind8BitRange) {
   static const char me[]="nrrdRangePercentileSet";
   airArray *mop;
-  Nrrd *nhist;
-  double allmin, allmax, minval, maxval, *hist, sum, total, sumPerc;
-  unsigned int hi;
+  _nrrdPercParm parm;
+  double allmin, allmax, *hist, total, sumPerc, perc, sum, val, err,
+    blo, bhi, rank[2], before[2];
+  unsigned int hi, ti, side, tbin;
+  size_t cnum[2], cidx;
+  int exact;
 
   if (!(range && nrrd)) {
     biffAddf(NRRD, "%s: got NULL pointer", me);
@@ -134,78 +267,167 @@ nrrdRangePercentileSet(NrrdRange *range, const Nrrd *nrrd,
     /* wanted full range; there is nothing more to do */
     return 0;
   }
-  if (!hbins) {
-    biffAddf(NRRD, "%s: sorry, non-histogram-based percentiles not "
-             "currently implemented (need hbins > 0)", me);
-    return 1;
-  }
-  if (!(hbins >= 5)) {
+  exact = !hbins;
+  if (exact) {
+    hbins = NRRD_RANGE_PERC_EXACT_BINS;
+  } else if (!(hbins >= 5)) {
     biffAddf(NRRD, "%s: # histogram bins %u unreasonably small", me, hbins);
     return 1;
   }
   if (range->hasNonExist) {
-    biffAddf(NRRD, "%s: sorry, can currently do histogram-based percentiles "
+    biffAddf(NRRD, "%s: sorry, can currently do percentiles "
              "only in arrays with no non-existent values", me);
     return 1;
   }
 
+  if (!nrrdElementNumber(nrrd)) {
+    biffAddf(NRRD, "%s: got empty array", me);
+    return 1;
+  }
+
   mop = airMopNew();
   allmin = range->min;
   allmax = range->max;
 
-  nhist = nrrdNew();
-  airMopAdd(mop, nhist, (airMopper)nrrdNuke, airMopAlways);
   /* the histogram is over the entire range of values */
-  if (nrrdHisto(nhist, nrrd, range, NULL, hbins, nrrdTypeDouble)) {
+  parm.nrrd = nrrd;
+  parm.num = nrrdElementNumber(nrrd);
+  parm.bins = hbins;
+  parm.threadNum = _nrrdThreadNum(parm.num);
+  parm.min = allmin;
+  parm.max = allmax;
+  parm.mnm = allmax + (allmin == allmax ? 1.0 : 0.0) - allmin;
+  parm.hist = AIR_CALLOC(AIR_CAST(size_t, hbins)*parm.threadNum, double);
+  parm.candOff = AIR_CALLOC(2*parm.threadNum, size_t);
+  airMopAdd(mop, parm.hist, airFree, airMopAlways);
+  airMopAdd(mop, parm.candOff, airFree, airMopAlways);
+  if (!(parm.hist && parm.candOff)) {
+    biffAddf(NRRD, "%s: couldn't allocate %u histograms of %u bins",
+             me, parm.threadNum, hbins);
+    airMopError(mop); return 1;
+  }
+  if (_nrrdThreadRun(_nrrdPercHistoBody, &parm, parm.num)) {
     biffAddf(NRRD, "%s: trouble making histogram", me);
-    airMopError(mop);
-    return 1;
+    airMopError(mop); return 1;
   }
-  hist = AIR_CAST(double *, nhist->data);
-  total = AIR_CAST(double, nrrdElementNumber(nrrd));
-  if (minPerc) {
-    minval = AIR_NAN;
-    sumPerc = AIR_ABS(minPerc)*total/100.0;
-    sum = hist[0];
-    for (hi=1; hi<hbins; hi++) {
-      sum += hist[hi];
-      if (sum >= sumPerc) {
-        minval = AIR_AFFINE(0, hi-1, hbins-1,
-                            nhist->axis[0].min, nhist->axis[0].max);
+  /* the per-thread histograms are still needed (for the candidate
+     offsets) if exact, so they are summed into a separate one */
+  if (1 == parm.threadNum) {
+    hist = parm.hist;
+  } else {
+    hist = AIR_CALLOC(hbins, double);
+    airMopAdd(mop, hist, airFree, airMopAlways);
+    if (!hist) {
+      biffAddf(NRRD, "%s: couldn't allocate histogram", me);
+      airMopError(mop); return 1;
+    }
+    for (ti=0; ti<parm.threadNum; ti++) {
+      for (hi=0; hi<hbins; hi++) {
+        hist[hi] += parm.hist[hi + hbins*ti];
+      }
+    }
+  }
+  total = AIR_CAST(double, parm.num);
+
+  /* find, for each wanted side, the bin tbin holding the percentile
+     value, the value's rank (from the low end for side 0, from the high
+     end for side 1), and the number of values before the bin (from the
+     same end) */
+  for (side=0; side<=1; side++) {
+    perc = side ? maxPerc : minPerc;
+    parm.want[side] = !!perc;
+    if (!perc) {
+      continue;
+    }
+    sumPerc = AIR_ABS(perc)*total/100.0;
+    sum = 0;
+    for (hi=0; hi<hbins; hi++) {
+      tbin = side ? hbins-1-hi : hi;
+      if (sum + hist[tbin] >= sumPerc) {
         break;
       }
+      sum += hist[tbin];
     }
-    if (hi == hbins || !AIR_EXISTS(minval)) {
-      biffAddf(NRRD, "%s: failed to find lower %g-percentile value",
-               me, minPerc);
-      airMopError(mop);
-      return 1;
+    if (hi == hbins) {
+      biffAddf(NRRD, "%s: failed to find %s %g-percentile value", me,
+               side ? "upper" : "lower", perc);
+      airMopError(mop); return 1;
     }
-    range->min = (minPerc > 0
-                  ? minval
-                  : 2*allmin - minval);
+    parm.cbin[side] = tbin;
+    rank[side] = AIR_MAX(1, ceil(sumPerc));
+    before[side] = sum;
   }
-  if (maxPerc) {
-    maxval = AIR_NAN;
-    sumPerc = AIR_ABS(maxPerc)*total/100.0;
-    sum = hist[hbins-1];
-    for (hi=hbins-1; hi; hi--) {
-      sum += hist[hi-1];
-      if (sum >= sumPerc) {
-        maxval = AIR_AFFINE(0, hi, hbins-1,
-                            nhist->axis[0].min, nhist->axis[0].max);
-        break;
+
+  if (!exact) {
+    /* as always: a location (not exactly a bin edge) in the histogram
+       near the percentile value, with an error bound from the extent of
+       the bin that actually contains it */
+    for (side=0; side<=1; side++) {
+      if (!parm.want[side]) {
+        continue;
+      }
+      tbin = parm.cbin[side];
+      if (!side) {
+        hi = AIR_MAX(1, tbin);
+        val = AIR_AFFINE(0, hi-1, hbins-1, allmin, allmax);
+      } else {
+        hi = AIR_MIN(tbin+1, hbins-1);
+        val = AIR_AFFINE(0, hi, hbins-1, allmin, allmax);
+      }
+      blo = AIR_MAX(allmin, allmin + tbin*parm.mnm/hbins);
+      bhi = AIR_MIN(allmax, allmin + (tbin+1)*parm.mnm/hbins);
+      err = AIR_MAX(AIR_ABS(val - blo), AIR_ABS(val - bhi));
+      if (!side) {
+        range->min = minPerc > 0 ? val : 2*allmin - val;
+        range->minErr = err;
+      } else {
+        range->max = maxPerc > 0 ? val : 2*allmax - val;
+        range->maxErr = err;
       }
     }
-    if (!hi || !AIR_EXISTS(maxval)) {
-      biffAddf(NRRD, "%s: failed to find upper %g-percentile value", me,
-               maxPerc);
-      airMopError(mop);
-      return 1;
+    airMopOkay(mop);
+    return 0;
+  }
+
+  /* exact: second pass to gather the values in the candidate bins */
+  for (side=0; side<=1; side++) {
+    cnum[side] = 0;
+    parm.cand[side] = NULL;
+    if (!parm.want[side]) {
+      continue;
+    }
+    for (ti=0; ti<parm.threadNum; ti++) {
+      parm.candOff[side + 2*ti] = cnum[side];
+      cnum[side] += AIR_CAST(size_t, parm.hist[parm.cbin[side] + hbins*ti]);
+    }
+    parm.cand[side] = AIR_CALLOC(cnum[side], double);
+    airMopAdd(mop, parm.cand[side], airFree, airMopAlways);
+    if (!parm.cand[side]) {
+      char stmp[AIR_STRLEN_SMALL];
+      biffAddf(NRRD, "%s: couldn't allocate %s candidate values", me,
+               airSprintSize_t(stmp, cnum[side]));
+      airMopError(mop); return 1;
+    }
+  }
+  if (_nrrdThreadRun(_nrrdPercCandBody, &parm, parm.num)) {
+    biffAddf(NRRD, "%s: trouble finding candidate values", me);
+    airMopError(mop); return 1;
+  }
+  for (side=0; side<=1; side++) {
+    if (!parm.want[side]) {
+      continue;
+    }
+    qsort(parm.cand[side], cnum[side], sizeof(double),
+          nrrdValCompare[nrrdTypeDouble]);
+    cidx = AIR_CAST(size_t, rank[side] - before[side]) - 1;
+    val = parm.cand[side][side ? cnum[side] - 1 - cidx : cidx];
+    if (!side) {
+      range->min = minPerc > 0 ? val : 2*allmin - val;
+      range->minErr = 0;
+    } else {
+      range->max = maxPerc > 0 ? val : 2*allmax - val;
+      range->maxErr = 0;
     }
-    range->max = (maxPerc > 0
-                  ? maxval
-                  : 2*allmax - maxval);
   }
 
   airMopOkay(mop);
@@ -301,9 +523,11 @@ nrrdRangePercentileFromStringSet(NrrdRange *range, const Nrrd *nrrd,
   /* whatever explicit values were given are now stored */
   if (AIR_EXISTS(minVal)) {
     range->min = minVal;
+    range->minErr = 0.0;
   }
   if (AIR_EXISTS(maxVal)) {
     range->max = maxVal;
+    range->maxErr = 0.0;
   }
 
   airMopOkay(mop);
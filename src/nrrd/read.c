@@ -472,10 +472,20 @@ _nrrdRead(Nrrd *nrrd, FILE *file, const char *string, NrrdIoState *_nio) {
   }
 
   /* try to read the file */
+  /* ---- BEGIN non-NrrdIO */
+  AIR_PROFILE_START(airProfileNrrdRead);
+  /* ---- END non-NrrdIO */
   if (nio->format->read(file, nrrd, nio)) {
     biffAddf(NRRD, "%s: trouble reading %s file", me, nio->format->name);
     airMopError(mop); return 1;
   }
+  /* ---- BEGIN non-NrrdIO */
+  AIR_PROFILE_STOP(airProfileNrrdRead);
+  AIR_PROFILE_COUNT(airProfileNrrdRead,
+                    (nrrd->data
+                     ? nrrdElementNumber(nrrd)*nrrdElementSize(nrrd)
+                     : 0));
+  /* ---- END non-NrrdIO */
 
   /* reshape up grayscale images, if desired */
   if (nio->format->isImage && 2 == nrrd->dim && nrrdStateGrayscaleImage3D) {
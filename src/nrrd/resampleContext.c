@@ -847,6 +847,7 @@ _nrrdResampleVectorFillUpdate(NrrdResampleContext *rsmc) {
           }
         }
         axis->kernel->EVALN(weightData, weightData, nn, axis->kparm);
+        AIR_PROFILE_COUNT(airProfileKernelEval, nn);
         if (ratio < 1) {
           for (ii=0; ii<nn; ii++) {
             weightData[ii] *= ratio;
@@ -864,6 +865,7 @@ _nrrdResampleVectorFillUpdate(NrrdResampleContext *rsmc) {
         }
         axis->kernel->EVALN(weightData, weightData,
                             dotLen*axis->samples, kparm);
+        AIR_PROFILE_COUNT(airProfileKernelEval, dotLen*axis->samples);
 
         /* special handling of "cheap" kernel */
         if (nrrdKernelCheap == axis->kernel) {
@@ -1184,6 +1186,8 @@ _nrrdResampleCore(NrrdResampleContext *rsmc, Nrrd *nout,
 
   mop = airMopNew();
   for (passIdx=0; passIdx<rsmc->passNum; passIdx++) {
+    AIR_PROFILE_COUNT(airProfileResamplePass, 1);
+    AIR_PROFILE_START(airProfileResamplePass);
     if (rsmc->verbose) {
       fprintf(stderr, "%s: -------------- pass %u/%u \n",
               me, passIdx, rsmc->passNum);
@@ -1363,6 +1367,7 @@ _nrrdResampleCore(NrrdResampleContext *rsmc, Nrrd *nout,
       axisIn->nrsmp = nrrdNuke(axisIn->nrsmp);
       /* airMopSub(mop, axisIn->nrsmp, (airMopper)nrrdNuke); */
     }
+    AIR_PROFILE_STOP(airProfileResamplePass);
   } /* for passIdx */
 
   airMopOkay(mop);
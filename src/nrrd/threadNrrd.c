@@ -0,0 +1,109 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "nrrd.h"
+#include "privateNrrd.h"
+
+typedef struct {
+  void (*body)(void *parm, unsigned int threadIdx, size_t lo, size_t hi);
+  void *parm;
+  unsigned int threadIdx;
+  size_t lo, hi;
+} _nrrdThreadTask;
+
+static void *
+_nrrdThreadWorker(void *_task) {
+  _nrrdThreadTask *task;
+
+  task = AIR_CAST(_nrrdThreadTask *, _task);
+  task->body(task->parm, task->threadIdx, task->lo, task->hi);
+  return _task;
+}
+
+/*
+** _nrrdThreadNum
+**
+** how many threads _nrrdThreadRun will use for num values
+*/
+unsigned int
+_nrrdThreadNum(size_t num) {
+  unsigned int threadNum;
+
+  threadNum = nrrdStateThreadNum;
+  if (!airThreadCapable || !threadNum) {
+    threadNum = 1;
+  }
+  if (num/NRRD_THREAD_GRAIN < threadNum) {
+    threadNum = AIR_CAST(unsigned int, AIR_MAX(1, num/NRRD_THREAD_GRAIN));
+  }
+  return threadNum;
+}
+
+/*
+** _nrrdThreadRun
+**
+** calls body(parm, ti, lo, hi) on disjoint index ranges [lo,hi) covering
+** [0,num), for ti in [0,threadNum), where threadNum is _nrrdThreadNum(num)
+** and range ti is [num*ti/threadNum, num*(ti+1)/threadNum).  body must
+** only touch the values in its range (or per-thread state indexed by ti),
+** and must not use biff.  The calling thread does range 0.
+**
+** Returns non-zero (with biff) only if threads couldn't be started; in
+** that case some of the ranges may have been processed (by the threads
+** that did start) and others not, so the output is garbage.
+*/
+int
+_nrrdThreadRun(void (*body)(void *parm, unsigned int threadIdx,
+                            size_t lo, size_t hi),
+               void *parm, size_t num) {
+  static const char me[]="_nrrdThreadRun";
+  _nrrdThreadTask *task;
+  unsigned int ti, threadNum, failIdx;
+
+  threadNum = _nrrdThreadNum(num);
+  if (1 == threadNum) {
+    body(parm, 0, 0, num);
+    return 0;
+  }
+  task = AIR_CALLOC(threadNum, _nrrdThreadTask);
+  if (!task) {
+    biffAddf(NRRD, "%s: couldn't allocate %u task records", me, threadNum);
+    return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    task[ti].body = body;
+    task[ti].parm = parm;
+    task[ti].threadIdx = ti;
+    task[ti].lo = AIR_CAST(size_t, AIR_CAST(airULLong, num)*ti/threadNum);
+    task[ti].hi = AIR_CAST(size_t, AIR_CAST(airULLong, num)*(ti+1)/threadNum);
+  }
+  failIdx = airThreadRun(threadNum, _nrrdThreadWorker,
+                         task, sizeof(_nrrdThreadTask), NULL, NULL);
+  airFree(task);
+  if (failIdx) {
+    biffAddf(NRRD, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    return 1;
+  }
+  return 0;
+}
@@ -945,10 +945,20 @@ _nrrdWrite(FILE *file, char **stringP, const Nrrd *nrrd, NrrdIoState *_nio) {
     }
   } else {
     /* call the writer appropriate for the format */
+    /* ---- BEGIN non-NrrdIO */
+    AIR_PROFILE_START(airProfileNrrdWrite);
+    /* ---- END non-NrrdIO */
     if (nio->format->write(file, nrrd, nio)) {
       biffAddf(NRRD, "%s:", me);
       airMopError(mop); return 1;
     }
+    /* ---- BEGIN non-NrrdIO */
+    AIR_PROFILE_STOP(airProfileNrrdWrite);
+    AIR_PROFILE_COUNT(airProfileNrrdWrite,
+                      (nrrd->data
+                       ? nrrdElementNumber(nrrd)*nrrdElementSize(nrrd)
+                       : 0));
+    /* ---- END non-NrrdIO */
   }
 
   airMopOkay(mop);
@@ -86,6 +86,7 @@ _neighBinPoints(pullTask *task, pullBin *bin, pullPoint *point,
     }
     herBinIdx++;
   }
+  AIR_PROFILE_COUNT(airProfilePullBinVisit, herBinIdx);
   /* also have to consider things in the add queue */
   for (herPointIdx=0; herPointIdx<task->addPointNum; herPointIdx++) {
     herPoint = task->addPoint[herPointIdx];
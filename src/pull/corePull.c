@@ -269,6 +269,7 @@ _pullIterate(pullContext *pctx, int mode) {
   }
 
   time0 = airTime();
+  AIR_PROFILE_START(airProfilePullIter);
   pctx->pointNum = pullPointNumber(pctx);
 
   /* the _pullWorker checks finished after iterBarrierA */
@@ -329,6 +330,8 @@ _pullIterate(pullContext *pctx, int mode) {
   }
 
   pctx->timeIteration = airTime() - time0;
+  AIR_PROFILE_STOP(airProfilePullIter);
+  AIR_PROFILE_COUNT(airProfilePullIter, 1);
 
 #if PULL_HINTER
   if (pullProcessModeDescent == mode && pctx->nhinter) {
@@ -166,6 +166,177 @@ _pushPairwiseEnergy(pushTask *task,
   return 0;
 }
 
+/*
+** _pushPairSetup: with pctx->pairOnce, copies the positions and inverse
+** tensors of all points into contiguous arrays, bin by bin, so that the
+** points of any one bin are adjacent in memory, and makes sure each task
+** has buffers big enough for the coming iteration.
+**
+** Only called by the master thread, before the worker threads start
+*/
+int
+_pushPairSetup(pushContext *pctx) {
+  static const char me[]="_pushPairSetup";
+  unsigned int binIdx, pointIdx, pntNum, pairMax, ti;
+  pushBin *bin;
+  pushPoint *point;
+  pushTask *task;
+
+  pntNum = pairMax = 0;
+  for (binIdx=0; binIdx<pctx->binNum; binIdx++) {
+    bin = pctx->bin + binIdx;
+    bin->pointBase = pntNum;
+    pntNum += bin->pointNum;
+    pairMax = AIR_MAX(pairMax, bin->pointNum);
+  }
+  if (pntNum != pctx->pntNum) {
+    airFree(pctx->pntPos);
+    airFree(pctx->pntInv);
+    pctx->pntPos = AIR_CALLOC(3*pntNum, double);
+    pctx->pntInv = AIR_CALLOC(7*pntNum, double);
+    if (!( pctx->pntPos && pctx->pntInv )) {
+      biffAddf(PUSH, "%s: couldn't allocate arrays for %u points", me, pntNum);
+      pctx->pntNum = 0;
+      return 1;
+    }
+    pctx->pntNum = pntNum;
+  }
+  for (binIdx=0; binIdx<pctx->binNum; binIdx++) {
+    bin = pctx->bin + binIdx;
+    for (pointIdx=0; pointIdx<bin->pointNum; pointIdx++) {
+      point = bin->point[pointIdx];
+      ELL_3V_COPY(pctx->pntPos + 3*(bin->pointBase + pointIdx), point->pos);
+      TEN_T_COPY(pctx->pntInv + 7*(bin->pointBase + pointIdx), point->inv);
+    }
+  }
+  for (ti=0; ti<pctx->threadNum; ti++) {
+    task = pctx->task[ti];
+    if (task->pairFrcLen < pntNum) {
+      airFree(task->pairFrc);
+      task->pairFrc = AIR_CALLOC(4*pntNum, double);
+      task->pairFrcLen = task->pairFrc ? pntNum : 0;
+    }
+    /* at most the points in one bin are paired with a point at once */
+    if (task->pairBufLen < pairMax) {
+      airFree(task->pairBuf);
+      airFree(task->pairIdx);
+      task->pairBuf = AIR_CALLOC(6*pairMax, double);
+      task->pairIdx = AIR_CALLOC(pairMax, unsigned int);
+      task->pairBufLen = (task->pairBuf && task->pairIdx) ? pairMax : 0;
+    }
+    if (!( task->pairFrcLen >= pntNum && task->pairBufLen >= pairMax )) {
+      biffAddf(PUSH, "%s: couldn't allocate buffers for task %u", me, ti);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+** _pushBinPairs: all interactions between the points of myBin and those
+** of herBin (if these are the same bin, each pair within it only once),
+** as read from pctx->pntPos and pctx->pntInv.  The force on each point
+** of the pair is added (with opposite signs) to task->pairFrc, as is
+** half the energy.  The nearby points are first gathered without
+** branching, then the energy is evaluated on all of them at once.
+*/
+static int
+_pushBinPairs(pushTask *task, pushBin *myBin, pushBin *herBin) {
+  static const char me[]="_pushBinPairs";
+  pushContext *pctx;
+  const double *pos, *inv, *myPos;
+  double *frc, *rrBuf, *enrBuf, *magBuf, *wwBuf, maxDiffLenSqrd, iscl,
+    diff[3], mi[7], XX[3], nXX[3], rr, ff[3];
+  unsigned int myPointIdx, myIdx, herIdx, herLo, herHi, pairNum, pi, *pidx;
+
+  pctx = task->pctx;
+  pos = pctx->pntPos;
+  inv = pctx->pntInv;
+  frc = task->pairFrc;
+  pidx = task->pairIdx;
+  rrBuf = task->pairBuf;
+  enrBuf = rrBuf + task->pairBufLen;
+  magBuf = enrBuf + task->pairBufLen;
+  wwBuf = magBuf + task->pairBufLen;
+  maxDiffLenSqrd = (pctx->maxDist)*(pctx->maxDist);
+  iscl = 1.0/(2*pctx->scale);
+  herHi = herBin->pointBase + herBin->pointNum;
+  for (myPointIdx=0; myPointIdx<myBin->pointNum; myPointIdx++) {
+    myIdx = myBin->pointBase + myPointIdx;
+    myPos = pos + 3*myIdx;
+    /* within my own bin, pair only with the points after me */
+    herLo = (myBin == herBin ? myIdx + 1 : herBin->pointBase);
+    pairNum = 0;
+    for (herIdx=herLo; herIdx<herHi; herIdx++) {
+      ELL_3V_SUB(diff, pos + 3*herIdx, myPos);
+      pidx[pairNum] = herIdx;
+      pairNum += (ELL_3V_DOT(diff, diff) <= maxDiffLenSqrd);
+    }
+    if (!pairNum) {
+      continue;
+    }
+    for (pi=0; pi<pairNum; pi++) {
+      herIdx = pidx[pi];
+      ELL_3V_SUB(diff, pos + 3*herIdx, myPos);
+      if (pctx->midPntSmp) {
+        pushPoint _tmpPoint;
+        double det;
+        ELL_3V_SCALE_ADD2(_tmpPoint.pos, 0.5, myPos, 0.5, pos + 3*herIdx);
+        if (_pushProbe(task, &_tmpPoint)) {
+          biffAddf(PUSH, "%s: at midpoint of %u and %u", me,
+                   myBin->point[myPointIdx]->ttaagg,
+                   herBin->point[herIdx - herBin->pointBase]->ttaagg);
+          return 1;
+        }
+        TEN_T_INV(mi, _tmpPoint.ten, det);
+      } else {
+        TEN_T_SCALE_ADD2(mi, 0.5, inv + 7*myIdx, 0.5, inv + 7*herIdx);
+      }
+      TEN_TV_MUL(XX, mi, diff);
+      ELL_3V_NORM(nXX, XX, rr);
+      TEN_TV_MUL(wwBuf + 3*pi, mi, nXX);
+      rrBuf[pi] = rr*iscl;
+    }
+    pctx->ensp->energy->evalN(enrBuf, magBuf, rrBuf, pairNum,
+                              pctx->ensp->parm);
+    for (pi=0; pi<pairNum; pi++) {
+      herIdx = pidx[pi];
+      ELL_3V_SCALE(ff, magBuf[pi]*iscl, wwBuf + 3*pi);
+      ELL_3V_INCR(frc + 4*myIdx, ff);
+      ELL_3V_SCALE_INCR(frc + 4*herIdx, -1, ff);
+      frc[3 + 4*myIdx] += enrBuf[pi]/2;
+      frc[3 + 4*herIdx] += enrBuf[pi]/2;
+    }
+  }
+  return 0;
+}
+
+/*
+** _pushBinPairProcess: the first stage of an iteration with
+** pctx->pairOnce: every pair of points in the bin, or between the bin
+** and its half shell of neighbors, is visited once
+*/
+int
+_pushBinPairProcess(pushTask *task, unsigned int myBinIdx) {
+  static const char me[]="_pushBinPairProcess";
+  pushBin *myBin, **half;
+
+  myBin = task->pctx->bin + myBinIdx;
+  if (_pushBinPairs(task, myBin, myBin)) {
+    biffAddf(PUSH, "%s: within bin %u", me, myBinIdx);
+    return 1;
+  }
+  for (half=myBin->half; *half; half++) {
+    if (_pushBinPairs(task, myBin, *half)) {
+      biffAddf(PUSH, "%s: between bins %u and %u", me, myBinIdx,
+               AIR_UINT(*half - task->pctx->bin));
+      return 1;
+    }
+  }
+  return 0;
+}
+
 #define EPS_PER_MAX_DIST 200
 #define SEEK_MAX_ITER 30
 
@@ -189,7 +360,18 @@ pushBinProcess(pushTask *task, unsigned int myBinIdx) {
     myPoint->enr = 0;
     ELL_3V_SET(myPoint->frc, 0, 0, 0);
 
-    if (1.0 <= task->pctx->neighborTrueProb
+    if (task->pctx->pairOnce) {
+      /* the pair-wise forces were already computed by
+         _pushBinPairProcess; add up what each task found */
+      unsigned int ti, pntIdx;
+      const double *pairFrc;
+      pntIdx = myBin->pointBase + myPointIdx;
+      for (ti=0; ti<task->pctx->threadNum; ti++) {
+        pairFrc = task->pctx->task[ti]->pairFrc + 4*pntIdx;
+        ELL_3V_INCR(myPoint->frc, pairFrc);
+        myPoint->enr += pairFrc[3];
+      }
+    } else if (1.0 <= task->pctx->neighborTrueProb
         || airDrandMT_r(task->rng) <= task->pctx->neighborTrueProb
         || !myPoint->neighArr->len) {
       neighbor = myBin->neighbor;
@@ -329,8 +511,8 @@ pushBinProcess(pushTask *task, unsigned int myBinIdx) {
     ELL_3V_SCALE(delta, task->pctx->step, myPoint->frc);
     ELL_3V_NORM(deltaNorm, delta, deltaLen);
     if (0 == deltaLen) {
-      /* an unforced point, but this isn't an error */
-      return 0;
+      /* an unforced point, but this isn't an error; on to the next */
+      continue;
     }
     if (!(AIR_EXISTS(deltaLen) && ELL_3V_EXISTS(deltaNorm))) {
       biffAddf(PUSH, "%s: deltaLen %g or deltaNorm (%g,%g,%g) doesn't exist",
@@ -379,6 +561,20 @@ pushBinProcess(pushTask *task, unsigned int myBinIdx) {
       }
     }
 
+    /* note points that have moved to a different bin */
+    if (!task->pctx->binSingle) {
+      pushBin *newBin;
+      if (!( newBin = _pushBinLocate(task->pctx, myPoint->pos) )) {
+        biffAddf(PUSH, "%s: can't locate point %u", me, myPoint->ttaagg);
+        return 1;
+      }
+      if (newBin != myBin) {
+        unsigned int idx;
+        idx = airArrayLenIncr(task->movedArr, 1);
+        task->moved[idx] = myPoint;
+      }
+    }
+
     /* the point lived, count it */
     task->pointNum += 1;
   } /* for myPointIdx */
@@ -38,6 +38,8 @@ pushBinInit(pushBin *bin, unsigned int incr) {
                               &(bin->pointNum),
                               sizeof(pushPoint *), incr);
   bin->neighbor = NULL;
+  bin->half = NULL;
+  bin->pointBase = 0;
   return;
 }
 
@@ -53,6 +55,7 @@ pushBinDone(pushBin *bin) {
   }
   bin->pointArr = airArrayNuke(bin->pointArr);
   bin->neighbor = (pushBin **)airFree(bin->neighbor);
+  bin->half = (pushBin **)airFree(bin->half);
   return;
 }
 
@@ -105,9 +108,9 @@ void
 _pushBinPointAdd(pushContext *pctx, pushBin *bin, pushPoint *point) {
   int pntI;
 
-  AIR_UNUSED(pctx);
   pntI = airArrayLenIncr(bin->pointArr, 1);
   bin->point[pntI] = point;
+  point->binIdx = AIR_UINT(bin - pctx->bin);
 
   return;
 }
@@ -127,7 +130,7 @@ _pushBinPointRemove(pushContext *pctx, pushBin *bin, int loseIdx) {
 
 void
 _pushBinNeighborSet(pushBin *bin, pushBin **nei, unsigned int num) {
-  unsigned int neiI;
+  unsigned int neiI, halfNum;
 
   bin->neighbor = (pushBin **)airFree(bin->neighbor);
   bin->neighbor = (pushBin **)calloc(1+num, sizeof(pushBin *));
@@ -135,6 +138,17 @@ _pushBinNeighborSet(pushBin *bin, pushBin **nei, unsigned int num) {
     bin->neighbor[neiI] = nei[neiI];
   }
   bin->neighbor[neiI] = NULL;
+
+  /* the half shell: neighbors later in memory than me */
+  bin->half = (pushBin **)airFree(bin->half);
+  bin->half = (pushBin **)calloc(1+num, sizeof(pushBin *));
+  halfNum = 0;
+  for (neiI=0; neiI<num; neiI++) {
+    if (nei[neiI] > bin) {
+      bin->half[halfNum++] = nei[neiI];
+    }
+  }
+  bin->half[halfNum] = NULL;
   return;
 }
 
@@ -232,3 +246,48 @@ pushRebin(pushContext *pctx) {
 
   return 0;
 }
+
+/*
+** _pushRebinMoved: like pushRebin, but only looks at the points that
+** pushBinProcess noticed moving into a different bin (recorded in the
+** tasks' moved lists), rather than re-locating every point.
+**
+** Like pushRebin, only called by the master thread
+*/
+int
+_pushRebinMoved(pushContext *pctx) {
+  static const char me[]="_pushRebinMoved";
+  unsigned int ti, mi, pointIdx;
+  pushBin *oldBin, *newBin;
+  pushPoint *point;
+  pushTask *task;
+
+  for (ti=0; ti<pctx->threadNum; ti++) {
+    task = pctx->task[ti];
+    for (mi=0; mi<task->movedNum; mi++) {
+      point = task->moved[mi];
+      oldBin = pctx->bin + point->binIdx;
+      for (pointIdx=0; pointIdx<oldBin->pointNum; pointIdx++) {
+        if (point == oldBin->point[pointIdx]) {
+          break;
+        }
+      }
+      if (pointIdx == oldBin->pointNum) {
+        biffAddf(PUSH, "%s: point %u not in its bin %u", me,
+                 point->ttaagg, point->binIdx);
+        return 1;
+      }
+      newBin = _pushBinLocate(pctx, point->pos);
+      if (!newBin) {
+        biffAddf(PUSH, "%s: can't locate point %p %u",
+                 me, AIR_CAST(void*, point), point->ttaagg);
+        return 1;
+      }
+      _pushBinPointRemove(pctx, oldBin, pointIdx);
+      _pushBinPointAdd(pctx, newBin, point);
+    }
+    airArrayLenSet(task->movedArr, 0);
+  }
+
+  return 0;
+}
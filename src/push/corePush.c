@@ -24,41 +24,71 @@
 #include "push.h"
 #include "privatePush.h"
 
+/*
+** get the index of the next non-empty bin to process, according to
+** the given counter, or binNum if there are no more
+*/
+static unsigned int
+_pushBinNext(pushTask *task, unsigned int *binIdxP) {
+  unsigned int binIdx;
+
+  if (task->pctx->threadNum > 1) {
+    airThreadMutexLock(task->pctx->binMutex);
+  }
+  do {
+    binIdx = *binIdxP;
+    if (*binIdxP < task->pctx->binNum) {
+      (*binIdxP)++;
+    }
+  } while (binIdx < task->pctx->binNum
+           && 0 == task->pctx->bin[binIdx].pointNum);
+  if (task->pctx->threadNum > 1) {
+    airThreadMutexUnlock(task->pctx->binMutex);
+  }
+  return binIdx;
+}
+
 /*
 ** this is the core of the worker threads: as long as there are bins
-** left to process, get the next one, and process it
+** left to process, get the next one, and process it.  With pairOnce,
+** this happens in two stages, separated by iterBarrierC: first the
+** pair-wise forces for all bins, then the moving of points in all bins
 */
 int
 _pushProcess(pushTask *task) {
   static const char me[]="_pushProcess";
-  unsigned int binIdx;
-
-  while (task->pctx->binIdx < task->pctx->binNum) {
-    /* get the index of the next bin to process */
-    if (task->pctx->threadNum > 1) {
-      airThreadMutexLock(task->pctx->binMutex);
-    }
-    do {
-      binIdx = task->pctx->binIdx;
-      if (task->pctx->binIdx < task->pctx->binNum) {
-        task->pctx->binIdx++;
+  unsigned int binIdx, *binIdxP;
+
+  if (task->pctx->pairOnce) {
+    int pairErr;
+    pairErr = AIR_FALSE;
+    memset(task->pairFrc, 0, 4*task->pctx->pntNum*sizeof(double));
+    while (task->pctx->binNum
+           != (binIdx = _pushBinNext(task, &(task->pctx->binIdx)))) {
+      if (_pushBinPairProcess(task, binIdx)) {
+        biffAddf(PUSH, "%s(%u): had trouble on pairs in bin %u", me,
+                 task->threadIdx, binIdx);
+        pairErr = AIR_TRUE;
+        break;
       }
-    } while (binIdx < task->pctx->binNum
-             && 0 == task->pctx->bin[binIdx].pointNum);
+    }
+    /* even with an error, all threads have to meet here */
     if (task->pctx->threadNum > 1) {
-      airThreadMutexUnlock(task->pctx->binMutex);
+      airThreadBarrierWait(task->pctx->iterBarrierC);
     }
-    if (binIdx == task->pctx->binNum) {
-      /* no more bins to process! */
-      break;
+    if (pairErr) {
+      return 1;
     }
-
+    binIdxP = &(task->pctx->binMoveIdx);
+  } else {
+    binIdxP = &(task->pctx->binIdx);
+  }
+  while (task->pctx->binNum != (binIdx = _pushBinNext(task, binIdxP))) {
     if (pushBinProcess(task, binIdx)) {
       biffAddf(PUSH, "%s(%u): had trouble on bin %u", me,
                task->threadIdx, binIdx);
       return 1;
     }
-
   }
   return 0;
 }
@@ -213,6 +243,7 @@ pushStart(pushContext *pctx) {
     pctx->binMutex = airThreadMutexNew();
     pctx->iterBarrierA = airThreadBarrierNew(pctx->threadNum);
     pctx->iterBarrierB = airThreadBarrierNew(pctx->threadNum);
+    pctx->iterBarrierC = airThreadBarrierNew(pctx->threadNum);
     /* start threads 1 and up running; they'll all hit iterBarrierA  */
     for (tidx=1; tidx<pctx->threadNum; tidx++) {
       if (pctx->verbose > 1) {
@@ -225,6 +256,7 @@ pushStart(pushContext *pctx) {
     pctx->binMutex = NULL;
     pctx->iterBarrierA = NULL;
     pctx->iterBarrierB = NULL;
+    pctx->iterBarrierC = NULL;
   }
   pctx->iter = 0;
 
@@ -259,6 +291,11 @@ pushIterate(pushContext *pctx) {
   /* the _pushWorker checks finished after iterBarrierA */
   pctx->finished = AIR_FALSE;
   pctx->binIdx=0;
+  pctx->binMoveIdx=0;
+  if (pctx->pairOnce && _pushPairSetup(pctx)) {
+    biffAddf(PUSH, "%s: trouble setting up pair-wise forces", me);
+    return 1;
+  }
   for (ti=0; ti<pctx->threadNum; ti++) {
     pctx->task[ti]->pointNum = 0;
     pctx->task[ti]->energySum = 0;
@@ -298,7 +335,7 @@ pushIterate(pushContext *pctx) {
     pointNum += pctx->task[ti]->pointNum;
   }
   pctx->deltaFrac /= pointNum;
-  if (pushRebin(pctx)) {
+  if (_pushRebinMoved(pctx)) {
     biffAddf(PUSH, "%s: problem with new point locations", me);
     return 1;
   }
@@ -450,7 +487,11 @@ pushFinish(pushContext *pctx) {
     pctx->binMutex = airThreadMutexNix(pctx->binMutex);
     pctx->iterBarrierA = airThreadBarrierNix(pctx->iterBarrierA);
     pctx->iterBarrierB = airThreadBarrierNix(pctx->iterBarrierB);
+    pctx->iterBarrierC = airThreadBarrierNix(pctx->iterBarrierC);
   }
+  pctx->pntPos = (double *)airFree(pctx->pntPos);
+  pctx->pntInv = (double *)airFree(pctx->pntInv);
+  pctx->pntNum = 0;
 
   return 0;
 }
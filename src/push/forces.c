@@ -79,6 +79,22 @@ _pushEnergyUnknownEval(double *enr, double *frc,
   return;
 }
 
+void
+_pushEnergyUnknownEvalN(double *enr, double *frc, const double *dist,
+                        unsigned int num, const double *parm) {
+  static const char me[]="_pushEnergyUnknownEvalN";
+  unsigned int ii;
+
+  AIR_UNUSED(dist);
+  AIR_UNUSED(parm);
+  for (ii=0; ii<num; ii++) {
+    enr[ii] = AIR_NAN;
+    frc[ii] = AIR_NAN;
+  }
+  fprintf(stderr, "%s: ERROR- using unknown energy.\n", me);
+  return;
+}
+
 double
 _pushEnergyUnknownSupport(const double *parm) {
   static const char me[]="_pushEnergyUnknownSupport";
@@ -93,7 +109,8 @@ _pushEnergyUnknown = {
   "unknown",
   0,
   _pushEnergyUnknownEval,
-  _pushEnergyUnknownSupport
+  _pushEnergyUnknownSupport,
+  _pushEnergyUnknownEvalN
 };
 const pushEnergy *const
 pushEnergyUnknown = &_pushEnergyUnknown;
@@ -133,6 +150,27 @@ _pushEnergySpringEval(double *enr, double *frc,
   return;
 }
 
+/*
+** the evalN functions compute all the cases, and then select one,
+** so that the loop body has no branches
+*/
+void
+_pushEnergySpringEvalN(double *enr, double *frc, const double *dist,
+                       unsigned int num, const double *parm) {
+  double xx, pull, enrPull, frcPull;
+  unsigned int ii;
+
+  pull = parm[0];
+  for (ii=0; ii<num; ii++) {
+    xx = dist[ii] - 1.0;
+    enrPull = xx*xx*(xx*xx/(4*pull*pull) - 2*xx/(3*pull) + 1.0/2.0);
+    frcPull = xx*(xx*xx/(pull*pull) - 2*xx/pull + 1);
+    enr[ii] = xx > pull ? 0 : (xx > 0 ? enrPull : xx*xx/2);
+    frc[ii] = xx > pull ? 0 : (xx > 0 ? frcPull : xx);
+  }
+  return;
+}
+
 double
 _pushEnergySpringSupport(const double *parm) {
 
@@ -144,7 +182,8 @@ _pushEnergySpring = {
   SPRING,
   1,
   _pushEnergySpringEval,
-  _pushEnergySpringSupport
+  _pushEnergySpringSupport,
+  _pushEnergySpringEvalN
 };
 const pushEnergy *const
 pushEnergySpring = &_pushEnergySpring;
@@ -176,6 +215,23 @@ _pushEnergyGaussEval(double *enr, double *frc,
   return;
 }
 
+/* same as _GAUSS and _DGAUSS with sig = 1.0 */
+void
+_pushEnergyGaussEvalN(double *enr, double *frc, const double *dist,
+                      unsigned int num, const double *parm) {
+  double cut, xx, ex;
+  unsigned int ii;
+
+  cut = parm[0];
+  for (ii=0; ii<num; ii++) {
+    xx = dist[ii];
+    ex = exp(-xx*xx/2.0);
+    enr[ii] = xx >= cut ? 0 : ex/2.50662827463100050241;
+    frc[ii] = xx >= cut ? 0 : -ex*xx/2.50662827463100050241;
+  }
+  return;
+}
+
 double
 _pushEnergyGaussSupport(const double *parm) {
 
@@ -187,7 +243,8 @@ _pushEnergyGauss = {
   GAUSS,
   1,
   _pushEnergyGaussEval,
-  _pushEnergyGaussSupport
+  _pushEnergyGaussSupport,
+  _pushEnergyGaussEvalN
 };
 const pushEnergy *const
 pushEnergyGauss = &_pushEnergyGauss;
@@ -208,6 +265,20 @@ _pushEnergyCoulombEval(double *enr, double *frc,
   return;
 }
 
+void
+_pushEnergyCoulombEvalN(double *enr, double *frc, const double *dist,
+                        unsigned int num, const double *parm) {
+  double dd;
+  unsigned int ii;
+
+  for (ii=0; ii<num; ii++) {
+    dd = dist[ii];
+    enr[ii] = (dd > parm[0] ? 0 : 1.0/dd);
+    frc[ii] = (dd > parm[0] ? 0 : -1.0/(dd*dd));
+  }
+  return;
+}
+
 double
 _pushEnergyCoulombSupport(const double *parm) {
 
@@ -219,7 +290,8 @@ _pushEnergyCoulomb = {
   COULOMB,
   1,
   _pushEnergyCoulombEval,
-  _pushEnergyCoulombSupport
+  _pushEnergyCoulombSupport,
+  _pushEnergyCoulombEvalN
 };
 const pushEnergy *const
 pushEnergyCoulomb = &_pushEnergyCoulomb;
@@ -242,6 +314,23 @@ _pushEnergyCotanEval(double *enr, double *frc,
   return;
 }
 
+void
+_pushEnergyCotanEvalN(double *enr, double *frc, const double *dist,
+                      unsigned int num, const double *parm) {
+  double pot, cc, dd;
+  unsigned int ii;
+
+  AIR_UNUSED(parm);
+  pot = AIR_PI/2.0;
+  for (ii=0; ii<num; ii++) {
+    dd = dist[ii];
+    cc = 1.0/(FLT_MIN + tan(dd*pot));
+    enr[ii] = dd > 1 ? 0 : cc + dd*pot - pot;
+    frc[ii] = dd > 1 ? 0 : -cc*cc*pot;
+  }
+  return;
+}
+
 double
 _pushEnergyCotanSupport(const double *parm) {
 
@@ -254,7 +343,8 @@ _pushEnergyCotan = {
   COTAN,
   0,
   _pushEnergyCotanEval,
-  _pushEnergyCotanSupport
+  _pushEnergyCotanSupport,
+  _pushEnergyCotanEvalN
 };
 const pushEnergy *const
 pushEnergyCotan = &_pushEnergyCotan;
@@ -275,6 +365,20 @@ _pushEnergyZeroEval(double *enr, double *frc,
   return;
 }
 
+void
+_pushEnergyZeroEvalN(double *enr, double *frc, const double *dist,
+                     unsigned int num, const double *parm) {
+  unsigned int ii;
+
+  AIR_UNUSED(dist);
+  AIR_UNUSED(parm);
+  for (ii=0; ii<num; ii++) {
+    enr[ii] = 0;
+    frc[ii] = 0;
+  }
+  return;
+}
+
 double
 _pushEnergyZeroSupport(const double *parm) {
 
@@ -287,7 +391,8 @@ _pushEnergyZero = {
   ZERO,
   0,
   _pushEnergyZeroEval,
-  _pushEnergyZeroSupport
+  _pushEnergyZeroSupport,
+  _pushEnergyZeroEvalN
 };
 const pushEnergy *const
 pushEnergyZero = &_pushEnergyZero;
@@ -53,6 +53,7 @@ pushPointNew(pushContext *pctx) {
       pnt->neighArr = airArrayNew((pppu.point = &(pnt->neigh), pppu.v),
                                   &(pnt->neighNum),
                                   sizeof(pushPoint *), 10);
+      pnt->binIdx = 0;
     }
   } else {
     pnt = NULL;
@@ -113,6 +114,7 @@ pushContextNew(void) {
 
     pctx->binSingle = AIR_FALSE;
     pctx->binIncr = 512;
+    pctx->pairOnce = AIR_FALSE;
 
     pctx->ksp00 = nrrdKernelSpecNew();
     pctx->ksp11 = nrrdKernelSpecNew();
@@ -133,7 +135,11 @@ pushContextNew(void) {
     ELL_3V_SET(pctx->binsEdge, 0, 0, 0);
     pctx->binNum = 0;
     pctx->binIdx = 0;
+    pctx->binMoveIdx = 0;
     pctx->binMutex = NULL;
+    pctx->pntPos = NULL;
+    pctx->pntInv = NULL;
+    pctx->pntNum = 0;
 
     pctx->step = AIR_NAN;
     pctx->maxDist = AIR_NAN;
@@ -146,6 +152,7 @@ pushContextNew(void) {
 
     pctx->iterBarrierA = NULL;
     pctx->iterBarrierB = NULL;
+    pctx->iterBarrierC = NULL;
 
     pctx->deltaFrac = AIR_NAN;
 
@@ -32,6 +32,7 @@ extern int _pushVerbose;
 extern pushBin *_pushBinLocate(pushContext *pctx, double *pos);
 extern void _pushBinPointAdd(pushContext *pctx,
                              pushBin *bin, pushPoint *point);
+extern int _pushRebinMoved(pushContext *pctx);
 
 /* setup.c */
 extern pushTask *_pushTaskNew(pushContext *pctx, int threadIdx);
@@ -44,6 +45,8 @@ extern int _pushPointSetup(pushContext *pctx);
 
 /* action.c */
 extern int _pushProbe(pushTask *task, pushPoint *point);
+extern int _pushPairSetup(pushContext *pctx);
+extern int _pushBinPairProcess(pushTask *task, unsigned int myBinIdx);
 
 #ifdef __cplusplus
 }
@@ -75,6 +75,7 @@ typedef struct pushPoint_t {
   struct pushPoint_t **neigh;
   unsigned int neighNum;
   airArray *neighArr;
+  unsigned int binIdx;         /* index of bin (in pctx->bin) containing me */
 } pushPoint;
 
 /*
@@ -90,6 +91,12 @@ typedef struct pushBin_t {
   airArray *pointArr;          /* airArray around point and pointNum */
   struct pushBin_t **neighbor; /* pre-computed NULL-terminated list of all
                                   neighboring bins, including myself */
+  struct pushBin_t **half;     /* the "half shell": NULL-terminated list of
+                                  neighboring bins with higher index than
+                                  mine, so that visiting each bin's half
+                                  shell visits each pair of bins once */
+  unsigned int pointBase;      /* with pctx->pairOnce: index of my first
+                                  point in pctx->pntPos and pctx->pntInv */
 } pushBin;
 
 /*
@@ -110,6 +117,16 @@ typedef struct pushTask_t {
   double energySum,            /* sum of energies of points I processed */
     deltaFracSum;              /* contribution to pctx->deltaFrac */
   airRandMTState *rng;         /* state for my RNG */
+  pushPoint **moved;           /* points I moved into a different bin */
+  unsigned int movedNum;
+  airArray *movedArr;          /* airArray around moved and movedNum */
+  double *pairFrc,             /* with pctx->pairOnce: my contributions to
+                                  the force (3 values) and energy (1) of
+                                  every point, in the order of pctx->pntPos */
+    *pairBuf;                  /* per-pair scratch space (6 values each) */
+  unsigned int *pairIdx,       /* which points are paired in pairBuf */
+    pairFrcLen,                /* allocated number of points in pairFrc */
+    pairBufLen;                /* allocated number of pairs in pairBuf */
   void *returnPtr;             /* for airThreadJoin */
 } pushTask;
 
@@ -144,6 +161,10 @@ typedef struct {
   void (*eval)(double *energy, double *force,
                double dist, const double parm[PUSH_ENERGY_PARM_NUM]);
   double (*support)(const double parm[PUSH_ENERGY_PARM_NUM]);
+  /* same as eval(), but on an array of num distances; written without
+     branches so that it can be vectorized */
+  void (*evalN)(double *energy, double *force, const double *dist,
+                unsigned int num, const double parm[PUSH_ENERGY_PARM_NUM]);
 } pushEnergy;
 
 typedef struct {
@@ -214,6 +235,16 @@ typedef struct pushContext_t {
 
   int binSingle;                   /* disable binning (for debugging) */
   unsigned int binIncr;            /* increment for per-bin airArray */
+  int pairOnce;                    /* compute each pair-wise interaction only
+                                      once per iteration (by Newton's third
+                                      law), visiting only the half shell of
+                                      neighboring bins, from positions as of
+                                      the start of the iteration.  Otherwise
+                                      (the default), each point is moved as
+                                      soon as its own force is known, which
+                                      later points may see.  The per-point
+                                      neighbor lists (neighborTrueProb < 1)
+                                      are not used with this */
 
   NrrdKernelSpec *ksp00,           /* for sampling tensor field */
     *ksp11,                        /* for gradient of mask, other 1st derivs */
@@ -237,10 +268,17 @@ typedef struct pushContext_t {
   unsigned int binsEdge[3],        /* # bins along each volume edge,
                                       determined by maxEval and scale */
     binNum,                        /* total # bins in grid */
-    binIdx;                        /* *next* bin of points needing to be
+    binIdx,                        /* *next* bin of points needing to be
                                       processed.  Stage is done when
                                       binIdx == binNum */
+    binMoveIdx;                    /* with pairOnce, the same for the second
+                                      stage: summing forces and moving */
   airThreadMutex *binMutex;        /* mutex around bin */
+  double *pntPos, *pntInv;         /* with pairOnce: positions (3 values) and
+                                      inverse tensors (7) of all points,
+                                      copied into contiguous arrays bin by bin
+                                      at the start of each iteration */
+  unsigned int pntNum;             /* number of points in pntPos, pntInv */
 
   double step,                     /* current working step size */
     maxDist,                       /* max distance btween interacting points */
@@ -250,6 +288,8 @@ typedef struct pushContext_t {
   pushTask **task;                 /* dynamically allocated array of tasks */
   airThreadBarrier *iterBarrierA;  /* barriers between iterations */
   airThreadBarrier *iterBarrierB;  /* barriers between iterations */
+  airThreadBarrier *iterBarrierC;  /* with pairOnce: between computing the
+                                      pair-wise forces and using them */
   double deltaFrac;                /* mean (over all particles in last
                                       iteration) of fraction of distance
                                       actually travelled to distance that it
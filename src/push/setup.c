@@ -172,6 +172,7 @@ pushTask *
 _pushTaskNew(pushContext *pctx, int threadIdx) {
   static const char me[]="_pushTaskNew";
   pushTask *task;
+  pushPtrPtrUnion pppu;
 
   task = (pushTask *)calloc(1, sizeof(pushTask));
   if (task) {
@@ -213,6 +214,16 @@ _pushTaskNew(pushContext *pctx, int threadIdx) {
     task->pointNum = 0;
     task->energySum = 0;
     task->deltaFracSum = 0;
+    task->moved = NULL;
+    task->movedNum = 0;
+    task->movedArr = airArrayNew((pppu.point = &(task->moved), pppu.v),
+                                 &(task->movedNum),
+                                 sizeof(pushPoint *), 64);
+    task->pairFrc = NULL;
+    task->pairBuf = NULL;
+    task->pairIdx = NULL;
+    task->pairFrcLen = 0;
+    task->pairBufLen = 0;
     task->returnPtr = NULL;
 
   }
@@ -228,6 +239,10 @@ _pushTaskNix(pushTask *task) {
       task->thread = airThreadNix(task->thread);
     }
     task->rng = airRandMTStateNix(task->rng);
+    task->movedArr = airArrayNuke(task->movedArr);
+    airFree(task->pairFrc);
+    airFree(task->pairBuf);
+    airFree(task->pairIdx);
     airFree(task);
   }
   return NULL;
@@ -135,6 +135,10 @@ main(int argc, const char *argv[]) {
              &(pctx->binSingle), NULL,
              "turn off spatial binning (which prevents multi-threading "
              "from being useful), for debugging or speed-up measurement");
+  hestOptAdd(&hopt, "once", NULL, airTypeBool, 0, 0,
+             &(pctx->pairOnce), NULL,
+             "compute each pair-wise interaction once per iteration, "
+             "with all points moving only after all forces are known");
 
   hestOptAdd(&hopt, "k00", "kernel", airTypeOther, 1, 1, &ksp00,
              "tent", "kernel for tensor field sampling",
@@ -94,9 +94,12 @@ baggageNew(seekContext *sctx) {
     bag->scldata = NULL;
   }
 
+  bag->zi = 0;
+  bag->zStart = 0;
   bag->xyzwArr = NULL;
   bag->normArr = NULL;
   bag->indxArr = NULL;
+  bag->biffMutex = NULL;
   return bag;
 }
 
@@ -113,8 +116,13 @@ baggageNix(baggage *bag) {
   return NULL;
 }
 
+/*
+** estFrac is the fraction of the volume that will be contributing to
+** the given lpld, for scaling down the pre-allocation estimates
+*/
 static int
-outputInit(seekContext *sctx, baggage *bag, limnPolyData *lpld) {
+outputInit(seekContext *sctx, baggage *bag, limnPolyData *lpld,
+           double estFrac) {
   static const char me[]="outputInit";
   unsigned int estVertNum, estFaceNum, minI, maxI, valI, *spanHist;
   airPtrPtrUnion appu;
@@ -132,8 +140,10 @@ outputInit(seekContext *sctx, baggage *bag, limnPolyData *lpld) {
         estVoxNum += spanHist[minI + sctx->spanSize*maxI];
       }
     }
-    estVertNum = AIR_CAST(unsigned int, estVoxNum*(sctx->vertsPerVoxel));
-    estFaceNum = AIR_CAST(unsigned int, estVoxNum*(sctx->facesPerVoxel));
+    estVertNum = AIR_CAST(unsigned int,
+                          estFrac*estVoxNum*(sctx->vertsPerVoxel));
+    estFaceNum = AIR_CAST(unsigned int,
+                          estFrac*estVoxNum*(sctx->facesPerVoxel));
     if (sctx->verbose) {
       fprintf(stderr, "%s: estimated vox --> vert, face: %u --> %u, %u\n", me,
               estVoxNum, estVertNum, estFaceNum);
@@ -196,6 +206,29 @@ outputInit(seekContext *sctx, baggage *bag, limnPolyData *lpld) {
   return 0;
 }
 
+/*
+** biff is not thread-safe, so with parallel extraction, the errors found
+** by the threads (in shuffleProbe and below) are added to biff only while
+** holding the biffMutex that all the threads share
+*/
+static void
+bagBiffLock(baggage *bag) {
+
+  if (bag->biffMutex) {
+    airThreadMutexLock(bag->biffMutex);
+  }
+  return;
+}
+
+static void
+bagBiffUnlock(baggage *bag) {
+
+  if (bag->biffMutex) {
+    airThreadMutexUnlock(bag->biffMutex);
+  }
+  return;
+}
+
 static double
 sclGet(seekContext *sctx, baggage *bag,
        unsigned int xi, unsigned int yi, unsigned int zi) {
@@ -312,7 +345,9 @@ evecFlipProbe(seekContext *sctx, baggage *bag,
   u = 1.0;
   SETNEXT(u);
   if (dot < wantDot) {
+    bagBiffLock(bag);
     biffAddf(SEEK, "%s: confused at end of edge", me);
+    bagBiffUnlock(bag);
     return 1;
   }
   ELL_3V_COPY(current, next);
@@ -359,7 +394,9 @@ evecFlipShuffleProbe(seekContext *sctx, baggage *bag) {
                  (yi!=0 && sctx->treated[xi+sx*(yi-1)]&0x01)) {
         /* need to treat this */
         if (evecFlipProbe(sctx, bag,    &flipA, xi, yi, 0, 1, 0, 0)) {
+          bagBiffLock(bag);
           biffAddf(SEEK, "%s: problem at (xi,yi) = (%u,%u), zi=0", me, xi, yi);
+          bagBiffUnlock(bag);
           return 1;
         }
         sctx->flip[0 + 5*si] = flipA;
@@ -369,7 +406,9 @@ evecFlipShuffleProbe(seekContext *sctx, baggage *bag) {
       } else if (sctx->treated[si]&0x01 ||
                  (xi!=0 && sctx->treated[xi-1+sx*yi]&0x01)) {
         if (evecFlipProbe(sctx, bag, &flipB, xi, yi, 0, 0, 1, 0)) {
+          bagBiffLock(bag);
           biffAddf(SEEK, "%s: problem at (xi,yi) = (%u,%u), zi=0", me, xi, yi);
+          bagBiffUnlock(bag);
           return 1;
         }
         sctx->flip[1 + 5*si] = flipB;
@@ -378,8 +417,10 @@ evecFlipShuffleProbe(seekContext *sctx, baggage *bag) {
           (yi!=0 && sctx->treated[xi+sx*(yi-1)]&0x01) ||
           (xi!=0 && yi!=0 && sctx->treated[xi-1+sx*(yi-1)]&0x01)) {
         if (evecFlipProbe(sctx, bag,    &flipA, xi, yi, 0, 0, 0, 1)) {
+          bagBiffLock(bag);
           biffAddf(SEEK, "%s: problem at (xi,yi,zi) = (%u,%u,%u)", me,
                    xi, yi, bag->zi);
+          bagBiffUnlock(bag);
           return 1;
         }
         sctx->flip[2 + 5*si] = flipA;
@@ -387,8 +428,10 @@ evecFlipShuffleProbe(seekContext *sctx, baggage *bag) {
       if (sctx->treated[si]&0x01 ||
           (yi!=0 && sctx->treated[xi+sx*(yi-1)]&0x01)) {
         if (evecFlipProbe(sctx, bag, &flipB, xi, yi, 1, 1, 0, 0)) {
+          bagBiffLock(bag);
           biffAddf(SEEK, "%s: problem at (xi,yi,zi) = (%u,%u,%u)", me,
                    xi, yi, bag->zi);
+          bagBiffUnlock(bag);
           return 1;
         }
         sctx->flip[3 + 5*si] = flipB;
@@ -398,8 +441,10 @@ evecFlipShuffleProbe(seekContext *sctx, baggage *bag) {
       if (sctx->treated[si]&0x01 ||
           (xi!=0 && sctx->treated[xi-1+sx*yi]&0x01)) {
         if (evecFlipProbe(sctx, bag, &flipC, xi, yi, 1, 0, 1, 0)) {
+          bagBiffLock(bag);
           biffAddf(SEEK, "%s: problem at (xi,yi,zi) = (%u,%u,%u)", me,
                    xi, yi, bag->zi);
+          bagBiffUnlock(bag);
           return 1;
         }
         sctx->flip[4 + 5*si] = flipC;
@@ -424,7 +469,7 @@ shuffleProbe(seekContext *sctx, baggage *bag) {
   if (!sctx->strengthUse) { /* just request all edges */
     memset(sctx->treated, 0x01, sizeof(char)*sctx->sx*sctx->sy);
   } else {
-    if (!bag->zi) {
+    if (bag->zi == bag->zStart) {
       /* clear full treated array */
       memset(sctx->treated, 0, sizeof(char)*sctx->sx*sctx->sy);
     } else {
@@ -442,12 +487,12 @@ shuffleProbe(seekContext *sctx, baggage *bag) {
       si = xi + sx*yi;
       spi = (xi+1) + (sx+2)*(yi+1);
       /* ================================================= */
-      if (!bag->zi) {
+      if (bag->zi == bag->zStart) {
         /* ----------------- set/probe bottom of initial slab */
         sctx->vidx[0 + 5*si] = -1;
         sctx->vidx[1 + 5*si] = -1;
         if (sctx->gctx) { /* HEY: need this check, what's the right way? */
-          _seekIdxProbe(sctx, bag, xi, yi, 0);
+          _seekIdxProbe(sctx, bag, xi, yi, bag->zi);
         }
         if (sctx->strengthUse) {
           sctx->stng[0 + 2*si] = sctx->strengthSign*sctx->stngAns[0];
@@ -459,11 +504,14 @@ shuffleProbe(seekContext *sctx, baggage *bag) {
         }
         switch (sctx->type) {
         case seekTypeIsocontour:
-          sctx->sclv[0 + 4*spi] = (sclGet(sctx, bag, xi, yi, 0)
+          /* below the first slice, replicate it (as sclGet does above
+             the last slice) */
+          sctx->sclv[0 + 4*spi] = (sclGet(sctx, bag, xi, yi,
+                                          bag->zi ? bag->zi-1 : 0)
                                    - sctx->isovalue);
-          sctx->sclv[1 + 4*spi] = (sclGet(sctx, bag, xi, yi, 0)
+          sctx->sclv[1 + 4*spi] = (sclGet(sctx, bag, xi, yi, bag->zi)
                                    - sctx->isovalue);
-          sctx->sclv[2 + 4*spi] = (sclGet(sctx, bag, xi, yi, 1)
+          sctx->sclv[2 + 4*spi] = (sclGet(sctx, bag, xi, yi, bag->zi+1)
                                    - sctx->isovalue);
           break;
         case seekTypeRidgeSurface:
@@ -565,7 +613,9 @@ shuffleProbe(seekContext *sctx, baggage *bag) {
       || seekTypeMaximalSurface == sctx->type
       || seekTypeMinimalSurface == sctx->type) {
     if (evecFlipShuffleProbe(sctx, bag)) {
+      bagBiffLock(bag);
       biffAddf(SEEK, "%s: trouble at zi=%u\n", me, bag->zi);
+      bagBiffUnlock(bag);
       return 1;
     }
   }
@@ -736,47 +786,140 @@ vvalSurfSet(seekContext *sctx, baggage *bag, double vval[8],
   return;
 }
 
+/* ========================================================== */
+/* NOTE: these things must agree with information in tables.c */
+static const int
+e2v[12][2] = {        /* maps edge index to corner vertex indices */
+  {0, 1},  /*  0 */
+  {0, 2},  /*  1 */
+  {1, 3},  /*  2 */
+  {2, 3},  /*  3 */
+  {0, 4},  /*  4 */
+  {1, 5},  /*  5 */
+  {2, 6},  /*  6 */
+  {3, 7},  /*  7 */
+  {4, 5},  /*  8 */
+  {4, 6},  /*  9 */
+  {5, 7},  /* 10 */
+  {6, 7}   /* 11 */
+};
+static const double
+vccoord[8][3] = {  /* vertex corner coordinates */
+  {0, 0, 0},  /* 0 */
+  {1, 0, 0},  /* 1 */
+  {0, 1, 0},  /* 2 */
+  {1, 1, 0},  /* 3 */
+  {0, 0, 1},  /* 4 */
+  {1, 0, 1},  /* 5 */
+  {0, 1, 1},  /* 6 */
+  {1, 1, 1}   /* 7 */
+};
+/* ========================================================== */
+
+/*
+** adds the vertices and triangles for the voxel at (xi, yi, bag->zi)
+** with (non-trivial) case vcase.  vslot[ei] points to where the index of
+** the vertex on edge ei is (or, if -1, will be) stored, so that vertices
+** are shared with the neighboring voxels
+*/
+static void
+voxelTriangulate(seekContext *sctx, baggage *bag, limnPolyData *lpld,
+                 unsigned char vcase, double vval[8], double vgrad[8][3],
+                 unsigned int xi, unsigned int yi, int *vslot[12]) {
+  double vert[3], tvertA[4], tvertB[4], ww;
+  int ti, ei, vi0, vi1, ecase;
+  const int *tcase;
+  unsigned int vii[3];
+
+  sctx->voxNum++;
+  ecase = seekContour3DTopoHackEdge[vcase];
+  /* create new vertices as needed */
+  for (ei=0; ei<12; ei++) {
+    if ((ecase & (1 << ei))
+        && -1 == *(vslot[ei])) {
+      int ovi;
+      double tvec[3], grad[3], tlen;
+      /* this edge is needed for triangulation,
+         and, we haven't already created a vertex for it */
+      vi0 = e2v[ei][0];
+      vi1 = e2v[ei][1];
+      ww = vval[vi0]/(vval[vi0] - vval[vi1]);
+      ELL_3V_LERP(vert, ww, vccoord[vi0], vccoord[vi1]);
+      ELL_4V_SET(tvertA, vert[0] + xi, vert[1] + yi, vert[2] + bag->zi, 1);
+      ELL_4MV_MUL(tvertB, sctx->txfIdx, tvertA);
+      /* tvertB is now in input index space */
+      ELL_4MV_MUL(tvertA, sctx->shape->ItoW, tvertB);
+      /* tvertA is now in input world space */
+      ELL_4V_HOMOG(tvertA, tvertA);
+      ELL_4V_HOMOG(tvertB, tvertB);
+      ovi = *(vslot[ei]) = airArrayLenIncr(bag->xyzwArr, 1);
+      ELL_4V_SET_TT(lpld->xyzw + 4*ovi, float,
+                    tvertA[0], tvertA[1], tvertA[2], 1.0);
+      /*
+      fprintf(stderr, "!%s: vert %u: %g %g %g\n", me, ovi,
+              tvertA[0], tvertA[1], tvertA[2]);
+      */
+      if (sctx->normalsFind) {
+        airArrayLenIncr(bag->normArr, 1);
+        if (sctx->normAns) {
+          gageProbe(sctx->gctx, tvertB[0], tvertB[1], tvertB[2]);
+          ELL_3V_SCALE_TT(lpld->norm + 3*ovi, float, -1, sctx->normAns);
+          if (sctx->reverse) {
+            ELL_3V_SCALE(lpld->norm + 3*ovi, -1, lpld->norm + 3*ovi);
+          }
+        } else {
+          ELL_3V_LERP(grad, ww, vgrad[vi0], vgrad[vi1]);
+          ELL_3MV_MUL(tvec, sctx->txfNormal, grad);
+          ELL_3V_NORM_TT(lpld->norm + 3*ovi, float, tvec, tlen);
+        }
+      }
+      sctx->vertNum++;
+      /*
+        fprintf(stderr, "%s: vert %d (edge %d) of (%d,%d,%d) "
+        "at %g %g %g\n",
+        me, *(vslot[ei]), ei, xi, yi, zi,
+        vert[0] + xi, vert[1] + yi, vert[2] + bag->zi);
+      */
+    }
+  }
+  /* add triangles */
+  ti = 0;
+  tcase = seekContour3DTopoHackTriangle[vcase];
+  while (-1 != tcase[0 + 3*ti]) {
+    unsigned iii;
+    ELL_3V_SET(vii,
+               *(vslot[tcase[0 + 3*ti]]),
+               *(vslot[tcase[1 + 3*ti]]),
+               *(vslot[tcase[2 + 3*ti]]));
+    if (sctx->reverse) {
+      int tmpi;
+      tmpi = vii[1]; vii[1] = vii[2]; vii[2] = tmpi;
+    }
+    iii = airArrayLenIncr(bag->indxArr, 3);
+    ELL_3V_COPY(lpld->indx + iii, vii);
+    /*
+    fprintf(stderr, "!%s: tri %u: %u %u %u\n",
+            me, iii/3, vii[0], vii[1], vii[2]);
+    */
+    lpld->icnt[0] += 3;
+    sctx->faceNum++;
+    ti++;
+  }
+  return;
+}
+
 static int
 triangulate(seekContext *sctx, baggage *bag, limnPolyData *lpld) {
   /* static const char me[]="triangulate"; */
   unsigned xi, yi, sx, sy, si, spi;
-  /* ========================================================== */
-  /* NOTE: these things must agree with information in tables.c */
-  int e2v[12][2] = {        /* maps edge index to corner vertex indices */
-    {0, 1},  /*  0 */
-    {0, 2},  /*  1 */
-    {1, 3},  /*  2 */
-    {2, 3},  /*  3 */
-    {0, 4},  /*  4 */
-    {1, 5},  /*  5 */
-    {2, 6},  /*  6 */
-    {3, 7},  /*  7 */
-    {4, 5},  /*  8 */
-    {4, 6},  /*  9 */
-    {5, 7},  /* 10 */
-    {6, 7}   /* 11 */
-  };
-  double vccoord[8][3] = {  /* vertex corner coordinates */
-    {0, 0, 0},  /* 0 */
-    {1, 0, 0},  /* 1 */
-    {0, 1, 0},  /* 2 */
-    {1, 1, 0},  /* 3 */
-    {0, 0, 1},  /* 4 */
-    {1, 0, 1},  /* 5 */
-    {0, 1, 1},  /* 6 */
-    {1, 1, 1}   /* 7 */
-  };
-  /* ========================================================== */
 
   sx = AIR_CAST(unsigned int, sctx->sx);
   sy = AIR_CAST(unsigned int, sctx->sy);
 
   for (yi=0; yi<sy-1; yi++) {
-    double vval[8], vgrad[8][3], vert[3], tvertA[4], tvertB[4], ww;
+    double vval[8], vgrad[8][3];
     unsigned char vcase;
-    int ti, vi, ei, vi0, vi1, ecase;
-    const int *tcase;
-    unsigned int vii[3];
+    int vi, ei, *vslot[12];
     for (xi=0; xi<sx-1; xi++) {
       si = xi + sx*yi;
       spi = (xi+1) + (sx+2)*(yi+1);
@@ -808,81 +951,10 @@ triangulate(seekContext *sctx, baggage *bag, limnPolyData *lpld) {
           && !sctx->normAns) {
         voxelGrads(vgrad, sctx->sclv, sx, spi);
       }
-      sctx->voxNum++;
-      ecase = seekContour3DTopoHackEdge[vcase];
-      /* create new vertices as needed */
       for (ei=0; ei<12; ei++) {
-        if ((ecase & (1 << ei))
-            && -1 == sctx->vidx[bag->evti[ei] + 5*si]) {
-          int ovi;
-          double tvec[3], grad[3], tlen;
-          /* this edge is needed for triangulation,
-             and, we haven't already created a vertex for it */
-          vi0 = e2v[ei][0];
-          vi1 = e2v[ei][1];
-          ww = vval[vi0]/(vval[vi0] - vval[vi1]);
-          ELL_3V_LERP(vert, ww, vccoord[vi0], vccoord[vi1]);
-          ELL_4V_SET(tvertA, vert[0] + xi, vert[1] + yi, vert[2] + bag->zi, 1);
-          ELL_4MV_MUL(tvertB, sctx->txfIdx, tvertA);
-          /* tvertB is now in input index space */
-          ELL_4MV_MUL(tvertA, sctx->shape->ItoW, tvertB);
-          /* tvertA is now in input world space */
-          ELL_4V_HOMOG(tvertA, tvertA);
-          ELL_4V_HOMOG(tvertB, tvertB);
-          ovi = sctx->vidx[bag->evti[ei] + 5*si] =
-            airArrayLenIncr(bag->xyzwArr, 1);
-          ELL_4V_SET_TT(lpld->xyzw + 4*ovi, float,
-                        tvertA[0], tvertA[1], tvertA[2], 1.0);
-          /*
-          fprintf(stderr, "!%s: vert %u: %g %g %g\n", me, ovi,
-                  tvertA[0], tvertA[1], tvertA[2]);
-          */
-          if (sctx->normalsFind) {
-            airArrayLenIncr(bag->normArr, 1);
-            if (sctx->normAns) {
-              gageProbe(sctx->gctx, tvertB[0], tvertB[1], tvertB[2]);
-              ELL_3V_SCALE_TT(lpld->norm + 3*ovi, float, -1, sctx->normAns);
-              if (sctx->reverse) {
-                ELL_3V_SCALE(lpld->norm + 3*ovi, -1, lpld->norm + 3*ovi);
-              }
-            } else {
-              ELL_3V_LERP(grad, ww, vgrad[vi0], vgrad[vi1]);
-              ELL_3MV_MUL(tvec, sctx->txfNormal, grad);
-              ELL_3V_NORM_TT(lpld->norm + 3*ovi, float, tvec, tlen);
-            }
-          }
-          sctx->vertNum++;
-          /*
-            fprintf(stderr, "%s: vert %d (edge %d) of (%d,%d,%d) "
-            "at %g %g %g\n",
-            me, sctx->vidx[bag->evti[ei] + 5*si], ei, xi, yi, zi,
-            vert[0] + xi, vert[1] + yi, vert[2] + bag->zi);
-          */
-        }
-      }
-      /* add triangles */
-      ti = 0;
-      tcase = seekContour3DTopoHackTriangle[vcase];
-      while (-1 != tcase[0 + 3*ti]) {
-        unsigned iii;
-        ELL_3V_SET(vii,
-                   sctx->vidx[bag->evti[tcase[0 + 3*ti]] + 5*si],
-                   sctx->vidx[bag->evti[tcase[1 + 3*ti]] + 5*si],
-                   sctx->vidx[bag->evti[tcase[2 + 3*ti]] + 5*si]);
-        if (sctx->reverse) {
-          int tmpi;
-          tmpi = vii[1]; vii[1] = vii[2]; vii[2] = tmpi;
-        }
-        iii = airArrayLenIncr(bag->indxArr, 3);
-        ELL_3V_COPY(lpld->indx + iii, vii);
-        /*
-        fprintf(stderr, "!%s: tri %u: %u %u %u\n",
-                me, iii/3, vii[0], vii[1], vii[2]);
-        */
-        lpld->icnt[0] += 3;
-        sctx->faceNum++;
-        ti++;
+        vslot[ei] = sctx->vidx + bag->evti[ei] + 5*si;
       }
+      voxelTriangulate(sctx, bag, lpld, vcase, vval, vgrad, xi, yi, vslot);
     }
   }
   return 0;
@@ -899,7 +971,7 @@ surfaceExtract(seekContext *sctx, limnPolyData *lpld) {
   sz = AIR_CAST(unsigned int, sctx->sz);
 
   /* this creates the airArrays in bag */
-  if (outputInit(sctx, bag, lpld)) {
+  if (outputInit(sctx, bag, lpld, 1.0)) {
     biffAddf(SEEK, "%s: trouble", me);
     return 1;
   }
@@ -939,6 +1011,507 @@ surfaceExtract(seekContext *sctx, limnPolyData *lpld) {
   return 0;
 }
 
+static int
+cellCompare(const void *_a, const void *_b) {
+  unsigned int a, b;
+
+  a = *AIR_CAST(const unsigned int *, _a);
+  b = *AIR_CAST(const unsigned int *, _b);
+  return (a < b ? -1 : (a > b ? 1 : 0));
+}
+
+/*
+** isocontour extraction that uses the span space index (sctx->nspanIndex)
+** to visit only the cells that can contain the isovalue, instead of
+** sweeping slabs through the whole volume.  The candidate cells are
+** sorted to raster order, and vertices on shared edges are tracked in
+** per-plane arrays, so that the output is identical to surfaceExtract's.
+*/
+static int
+isoIndexExtract(seekContext *sctx, limnPolyData *lpld) {
+  static const char me[]="isoIndexExtract";
+  unsigned int sx, sy, sz, ss, valI, minI, maxI, bb, ci, cellNum,
+    xi, yi, zi, vi, ei, *spanIdx, *cell, *pstamp[2], *zstamp;
+  int *pvidx[2], *zvidx, *vslot[12];
+  double vval[8], vgrad[8][3], ival;
+  unsigned char vcase;
+  baggage *bag;
+  airArray *mop;
+
+  if (!sctx->nspanIndex->data) {
+    biffAddf(SEEK, "%s: don't have span space index; "
+             "need to call seekUpdate?", me);
+    return 1;
+  }
+  mop = airMopNew();
+  bag = baggageNew(sctx);
+  airMopAdd(mop, bag, (airMopper)baggageNix, airMopAlways);
+  /* this creates the airArrays in bag */
+  if (outputInit(sctx, bag, lpld, 1.0)) {
+    biffAddf(SEEK, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  ival = sctx->isovalue;
+  if (!( sctx->range->min <= ival && ival < sctx->range->max )) {
+    /* no cell can have a value above, and a value below, ival */
+    airMopOkay(mop);
+    return 0;
+  }
+  sx = AIR_CAST(unsigned int, sctx->sx);
+  sy = AIR_CAST(unsigned int, sctx->sy);
+  sz = AIR_CAST(unsigned int, sctx->sz);
+  ss = AIR_CAST(unsigned int, sctx->spanSize);
+  spanIdx = AIR_CAST(unsigned int *, sctx->nspanIndex->data);
+
+  /* collect cells from buckets that may straddle ival (with one bucket
+     of slop on either side to be safe from round-off in airIndex) */
+  valI = airIndex(sctx->range->min, ival, sctx->range->max, ss);
+  cellNum = 0;
+  for (maxI=(valI ? valI-1 : 0); maxI<ss; maxI++) {
+    for (minI=0; minI<=AIR_MIN(valI+1, maxI); minI++) {
+      bb = minI + ss*maxI;
+      cellNum += spanIdx[bb+1] - spanIdx[bb];
+    }
+  }
+  cell = AIR_CALLOC(cellNum ? cellNum : 1, unsigned int);
+  airMopAdd(mop, cell, airFree, airMopAlways);
+  pvidx[0] = AIR_CALLOC(2*sx*sy, int);
+  airMopAdd(mop, pvidx[0], airFree, airMopAlways);
+  pvidx[1] = AIR_CALLOC(2*sx*sy, int);
+  airMopAdd(mop, pvidx[1], airFree, airMopAlways);
+  zvidx = AIR_CALLOC(sx*sy, int);
+  airMopAdd(mop, zvidx, airFree, airMopAlways);
+  pstamp[0] = AIR_CALLOC(2*sx*sy, unsigned int);
+  airMopAdd(mop, pstamp[0], airFree, airMopAlways);
+  pstamp[1] = AIR_CALLOC(2*sx*sy, unsigned int);
+  airMopAdd(mop, pstamp[1], airFree, airMopAlways);
+  zstamp = AIR_CALLOC(sx*sy, unsigned int);
+  airMopAdd(mop, zstamp, airFree, airMopAlways);
+  if (!( cell && pvidx[0] && pvidx[1] && zvidx
+         && pstamp[0] && pstamp[1] && zstamp )) {
+    biffAddf(SEEK, "%s: couldn't allocate buffers", me);
+    airMopError(mop); return 1;
+  }
+  cellNum = 0;
+  for (maxI=(valI ? valI-1 : 0); maxI<ss; maxI++) {
+    for (minI=0; minI<=AIR_MIN(valI+1, maxI); minI++) {
+      bb = minI + ss*maxI;
+      memcpy(cell + cellNum, spanIdx + spanIdx[bb],
+             (spanIdx[bb+1] - spanIdx[bb])*sizeof(unsigned int));
+      cellNum += spanIdx[bb+1] - spanIdx[bb];
+    }
+  }
+  qsort(cell, cellNum, sizeof(unsigned int), cellCompare);
+  if (sctx->verbose) {
+    fprintf(stderr, "%s: visiting %u of %u cells\n", me, cellNum,
+            (sx-1)*(sy-1)*(sz-1));
+  }
+
+#define SCL(xx, yy, zz)                                       \
+  (bag->scllup(bag->scldata,                                  \
+               AIR_MIN(sx-1, xx) + sx*(AIR_MIN(sy-1, yy)      \
+                                       + sy*AIR_MIN(sz-1, zz))) - ival)
+  for (ci=0; ci<cellNum; ci++) {
+    vi = cell[ci];
+    xi = vi % sx;
+    yi = (vi/sx) % sy;
+    zi = vi/(sx*sy);
+    vval[0] = SCL(xi + 0, yi + 0, zi + 0);
+    vval[1] = SCL(xi + 1, yi + 0, zi + 0);
+    vval[2] = SCL(xi + 0, yi + 1, zi + 0);
+    vval[3] = SCL(xi + 1, yi + 1, zi + 0);
+    vval[4] = SCL(xi + 0, yi + 0, zi + 1);
+    vval[5] = SCL(xi + 1, yi + 0, zi + 1);
+    vval[6] = SCL(xi + 0, yi + 1, zi + 1);
+    vval[7] = SCL(xi + 1, yi + 1, zi + 1);
+    vcase = 0;
+    for (ei=0; ei<8; ei++) {
+      vcase |= (vval[ei] > 0) << ei;
+    }
+    if (0 == vcase || 255 == vcase) {
+      continue;
+    }
+    if (sctx->normalsFind && !sctx->normAns) {
+      /* same central differences (with clamping at the boundary) as
+         voxelGrads computes from the slab cache */
+      for (ei=0; ei<8; ei++) {
+        unsigned int cx, cy, cz;
+        cx = xi + AIR_CAST(unsigned int, vccoord[ei][0]);
+        cy = yi + AIR_CAST(unsigned int, vccoord[ei][1]);
+        cz = zi + AIR_CAST(unsigned int, vccoord[ei][2]);
+        ELL_3V_SET(vgrad[ei],
+                   SCL(cx+1, cy, cz) - SCL(cx ? cx-1 : 0, cy, cz),
+                   SCL(cx, cy+1, cz) - SCL(cx, cy ? cy-1 : 0, cz),
+                   SCL(cx, cy, cz+1) - SCL(cx, cy, cz ? cz-1 : 0));
+      }
+    }
+    /* find where vertex indices for this cell's edges are stored; a slot
+       whose stamp isn't from the current plane or slab is stale */
+    for (ei=0; ei<12; ei++) {
+      unsigned int uu, ssi, pp, *stamp;
+      int *slot;
+      uu = bag->evti[ei] % 5;
+      ssi = bag->evti[ei]/5 + xi + sx*yi;
+      if (2 == uu) {
+        slot = zvidx + ssi;
+        stamp = zstamp + ssi;
+        pp = zi;
+      } else {
+        pp = zi + (uu >= 3);
+        slot = pvidx[pp % 2] + (1 == uu || 4 == uu) + 2*ssi;
+        stamp = pstamp[pp % 2] + (1 == uu || 4 == uu) + 2*ssi;
+      }
+      if (*stamp != pp+1) {
+        *stamp = pp+1;
+        *slot = -1;
+      }
+      vslot[ei] = slot;
+    }
+    bag->zi = zi;
+    voxelTriangulate(sctx, bag, lpld, vcase, vval, vgrad, xi, yi, vslot);
+  }
+#undef SCL
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** for parallel extraction, each thread gets one of these, with a copy of
+** the seekContext (with its own gage context and slab caches) that is used
+** to handle the slabs zLo through zHi-1, producing its own polydata
+*/
+typedef struct {
+  seekContext *sctx;      /* per-thread copy; the original for thread 0 */
+  baggage *bag;
+  limnPolyData *lpld;
+  unsigned int zLo, zHi;  /* range of slabs handled */
+  int *botVidx;           /* 2 * sx * sy vertex indices of the X and Y edges
+                             on the bottom face of slab zLo, saved before
+                             being shuffled away */
+  int error;
+} slabTask;
+
+static seekContext *
+workerContextNix(seekContext *wctx) {
+
+  if (wctx) {
+    wctx->nvidx = nrrdNuke(wctx->nvidx);
+    wctx->ntreated = nrrdNuke(wctx->ntreated);
+    wctx->nstng = nrrdNuke(wctx->nstng);
+    wctx->nsclv = nrrdNuke(wctx->nsclv);
+    wctx->ngrad = nrrdNuke(wctx->ngrad);
+    wctx->neval = nrrdNuke(wctx->neval);
+    wctx->nevec = nrrdNuke(wctx->nevec);
+    wctx->nflip = nrrdNuke(wctx->nflip);
+    if (wctx->gctx) {
+      wctx->gctx = gageContextNix(wctx->gctx);
+    }
+    airFree(wctx);
+  }
+  return NULL;
+}
+
+/*
+** makes a copy of sctx, suitable only for calling shuffleProbe and
+** triangulate, that shares everything read-only (the flags, shape, derived
+** scalar volume, span space histogram) but has its own copies of the slab
+** caches that the non-T feature types use, and of the gage context
+*/
+static seekContext *
+workerContextNew(seekContext *sctx) {
+  static const char me[]="workerContextNew";
+  seekContext *wctx;
+  unsigned int pvlIdx;
+  int E;
+
+  wctx = AIR_CALLOC(1, seekContext);
+  if (!wctx) {
+    biffAddf(SEEK, "%s: couldn't allocate context", me);
+    return NULL;
+  }
+  memcpy(wctx, sctx, sizeof(seekContext));
+  /* these are all that is owned by wctx, and freed by workerContextNix */
+  wctx->gctx = NULL;
+  wctx->nvidx = wctx->ntreated = wctx->nstng = wctx->nsclv = NULL;
+  wctx->ngrad = wctx->neval = wctx->nevec = wctx->nflip = NULL;
+
+  if (sctx->gctx) {
+    for (pvlIdx=0; pvlIdx<sctx->gctx->pvlNum; pvlIdx++) {
+      if (sctx->gctx->pvl[pvlIdx] == sctx->pvl) {
+        break;
+      }
+    }
+    wctx->gctx = gageContextCopy(sctx->gctx);
+    if (!wctx->gctx) {
+      biffMovef(SEEK, GAGE, "%s: couldn't copy gage context", me);
+      workerContextNix(wctx); return NULL;
+    }
+    wctx->pvl = wctx->gctx->pvl[pvlIdx];
+    /* point answer pointers to same place in new pervolume */
+#define REBASE(P) (P = (P                                              \
+                        ? wctx->pvl->answer + (P - sctx->pvl->answer)  \
+                        : NULL))
+    REBASE(wctx->sclvAns);
+    REBASE(wctx->gradAns);
+    REBASE(wctx->normAns);
+    REBASE(wctx->evalAns);
+    REBASE(wctx->evecAns);
+    REBASE(wctx->stngAns);
+    REBASE(wctx->hessAns);
+#undef REBASE
+  }
+
+  E = 0;
+#define CACHE(NN, PP, TT)                                       \
+  if (!E) {                                                     \
+    wctx->NN = nrrdNew();                                       \
+    if (sctx->PP) {                                             \
+      E |= nrrdCopy(wctx->NN, sctx->NN);                        \
+      wctx->PP = E ? NULL : AIR_CAST(TT *, wctx->NN->data);     \
+    }                                                           \
+  }
+  CACHE(nvidx, vidx, int);
+  CACHE(ntreated, treated, signed char);
+  CACHE(nstng, stng, double);
+  CACHE(nsclv, sclv, double);
+  CACHE(ngrad, grad, double);
+  CACHE(neval, eval, double);
+  CACHE(nevec, evec, double);
+  CACHE(nflip, flip, signed char);
+#undef CACHE
+  if (E) {
+    biffMovef(SEEK, NRRD, "%s: couldn't allocate slab caches", me);
+    workerContextNix(wctx); return NULL;
+  }
+  return wctx;
+}
+
+static void *
+slabWorker(void *_task) {
+  slabTask *task;
+  seekContext *sctx;
+  baggage *bag;
+  unsigned int zi, sx, sy, si;
+
+  task = AIR_CAST(slabTask *, _task);
+  sctx = task->sctx;
+  bag = task->bag;
+  sx = AIR_CAST(unsigned int, sctx->sx);
+  sy = AIR_CAST(unsigned int, sctx->sy);
+  bag->zStart = task->zLo;
+  for (zi=task->zLo; zi<task->zHi; zi++) {
+    bag->zi = zi;
+    if (shuffleProbe(sctx, bag)
+        || triangulate(sctx, bag, task->lpld)) {
+      task->error = AIR_TRUE;
+      break;
+    }
+    if (zi == task->zLo) {
+      for (si=0; si<sx*sy; si++) {
+        task->botVidx[0 + 2*si] = sctx->vidx[0 + 5*si];
+        task->botVidx[1 + 2*si] = sctx->vidx[1 + 5*si];
+      }
+    }
+  }
+  return _task;
+}
+
+/*
+** puts the per-thread polydata together into lpld.  A vertex on an edge
+** on the bottom face of a thread's first slab was also created by the
+** previous thread if its last slab needed that edge; in the serial
+** algorithm that vertex would have been re-used, so here the copy from
+** the later thread is dropped.  The result is the same vertex and
+** triangle ordering as from serial extraction.
+*/
+static int
+slabMerge(seekContext *sctx, limnPolyData *lpld,
+          slabTask *task, unsigned int taskNum) {
+  static const char me[]="slabMerge";
+  unsigned int ti, vi, ii, si, sxy, vertNum, indxNum, vertIdx, indxIdx,
+    *vmap, *vmapLast, bitflag;
+  int vidx, vidxLast;
+  airArray *mop;
+
+  mop = airMopNew();
+  vertNum = indxNum = 0;
+  for (ti=0; ti<taskNum; ti++) {
+    vertNum += task[ti].lpld->xyzwNum;
+    indxNum += task[ti].lpld->indxNum;
+  }
+  bitflag = sctx->normalsFind ? (1 << limnPolyDataInfoNorm) : 0;
+  /* vertNum is an upper bound; xyzwNum and normNum get fixed below */
+  if (limnPolyDataAlloc(lpld, bitflag, vertNum, indxNum, 1)) {
+    biffMovef(SEEK, LIMN, "%s: couldn't allocate output", me);
+    airMopError(mop); return 1;
+  }
+  lpld->type[0] = limnPrimitiveTriangles;
+  lpld->icnt[0] = indxNum;
+
+  sxy = AIR_CAST(unsigned int, sctx->sx*sctx->sy);
+  vmapLast = NULL;
+  vertIdx = indxIdx = 0;
+  for (ti=0; ti<taskNum; ti++) {
+    limnPolyData *tpld;
+    tpld = task[ti].lpld;
+    vmap = AIR_CALLOC(AIR_MAX(1, tpld->xyzwNum), unsigned int);
+    if (!vmap) {
+      biffAddf(SEEK, "%s: couldn't allocate vertex map %u", me, ti);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, vmap, airFree, airMopAlways);
+    for (vi=0; vi<tpld->xyzwNum; vi++) {
+      vmap[vi] = UINT_MAX;
+    }
+    if (ti) {
+      /* weld to the vertices on top face of previous thread's last slab */
+      for (si=0; si<sxy; si++) {
+        for (ii=0; ii<2; ii++) {
+          vidx = task[ti].botVidx[ii + 2*si];
+          vidxLast = task[ti-1].sctx->vidx[3 + ii + 5*si];
+          if (-1 != vidx && -1 != vidxLast) {
+            vmap[vidx] = vmapLast[vidxLast];
+          }
+        }
+      }
+    }
+    for (vi=0; vi<tpld->xyzwNum; vi++) {
+      if (UINT_MAX != vmap[vi]) {
+        continue;
+      }
+      vmap[vi] = vertIdx;
+      ELL_4V_COPY(lpld->xyzw + 4*vertIdx, tpld->xyzw + 4*vi);
+      if (sctx->normalsFind) {
+        ELL_3V_COPY(lpld->norm + 3*vertIdx, tpld->norm + 3*vi);
+      }
+      vertIdx++;
+    }
+    for (ii=0; ii<tpld->indxNum; ii++) {
+      lpld->indx[indxIdx++] = vmap[tpld->indx[ii]];
+    }
+    vmapLast = vmap;
+  }
+  lpld->xyzwNum = vertIdx;
+  if (sctx->normalsFind) {
+    lpld->normNum = vertIdx;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** like surfaceExtract, but with sctx->threadNum threads, each handling a
+** contiguous range of slabs
+*/
+static int
+surfaceExtractParallel(seekContext *sctx, limnPolyData *lpld) {
+  static const char me[]="surfaceExtractParallel";
+  unsigned int ti, taskNum, slabNum, sxy, vertSum, failIdx;
+  slabTask *task;
+  airThreadMutex *mutex;
+  airArray *mop;
+  int E;
+
+  slabNum = AIR_CAST(unsigned int, sctx->sz-1);
+  taskNum = AIR_MIN(sctx->threadNum, slabNum);
+  sxy = AIR_CAST(unsigned int, sctx->sx*sctx->sy);
+
+  mop = airMopNew();
+  task = AIR_CALLOC(taskNum, slabTask);
+  if (!task) {
+    biffAddf(SEEK, "%s: couldn't allocate %u tasks", me, taskNum);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  mutex = airThreadMutexNew();
+  airMopAdd(mop, mutex, (airMopper)airThreadMutexNix, airMopAlways);
+  E = 0;
+  for (ti=0; ti<taskNum; ti++) {
+    slabTask *tt;
+    tt = task + ti;
+    if (!ti) {
+      tt->sctx = sctx;
+    } else {
+      if (!E) {
+        tt->sctx = workerContextNew(sctx);
+        if (tt->sctx) {
+          airMopAdd(mop, tt->sctx, (airMopper)workerContextNix,
+                    airMopAlways);
+        } else {
+          biffAddf(SEEK, "%s: couldn't set up thread %u", me, ti);
+          E = 1;
+        }
+      }
+    }
+    if (!E) {
+      tt->bag = baggageNew(tt->sctx);
+      airMopAdd(mop, tt->bag, (airMopper)baggageNix, airMopAlways);
+      tt->bag->biffMutex = mutex;
+      tt->lpld = limnPolyDataNew();
+      airMopAdd(mop, tt->lpld, (airMopper)limnPolyDataNix, airMopAlways);
+      tt->botVidx = AIR_CALLOC(2*sxy, int);
+      airMopAdd(mop, tt->botVidx, airFree, airMopAlways);
+      tt->zLo = AIR_CAST(unsigned int,
+                         AIR_CAST(size_t, slabNum)*ti/taskNum);
+      tt->zHi = AIR_CAST(unsigned int,
+                         AIR_CAST(size_t, slabNum)*(ti+1)/taskNum);
+      tt->error = AIR_FALSE;
+      if (!tt->botVidx
+          || outputInit(tt->sctx, tt->bag, tt->lpld,
+                        AIR_CAST(double, tt->zHi - tt->zLo)/slabNum)) {
+        biffAddf(SEEK, "%s: couldn't set up output of thread %u", me, ti);
+        E = 1;
+      }
+    }
+  }
+  if (E) {
+    airMopError(mop); return 1;
+  }
+
+  failIdx = airThreadRun(taskNum, slabWorker, task, sizeof(slabTask),
+                         NULL, NULL);
+  if (failIdx) {
+    biffAddf(SEEK, "%s: couldn't start thread %u of %u", me,
+             failIdx, taskNum);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<taskNum; ti++) {
+    if (task[ti].error) {
+      biffAddf(SEEK, "%s: thread %u had trouble on slabs [%u,%u)", me,
+               ti, task[ti].zLo, task[ti].zHi);
+      airMopError(mop); return 1;
+    }
+  }
+
+  vertSum = 0;
+  for (ti=0; ti<taskNum; ti++) {
+    vertSum += task[ti].lpld->xyzwNum;
+  }
+  if (slabMerge(sctx, lpld, task, taskNum)) {
+    biffAddf(SEEK, "%s: trouble merging", me);
+    airMopError(mop); return 1;
+  }
+  /* thread 0 used sctx itself, so its counts are already there */
+  for (ti=1; ti<taskNum; ti++) {
+    sctx->voxNum += task[ti].sctx->voxNum;
+    sctx->faceNum += task[ti].sctx->faceNum;
+    if (sctx->strengthUse) {
+      sctx->strengthSeenMax = AIR_MAX(sctx->strengthSeenMax,
+                                      task[ti].sctx->strengthSeenMax);
+    }
+  }
+  sctx->vertNum = lpld->xyzwNum;
+  if (sctx->verbose) {
+    fprintf(stderr, "%s: %u threads: %u verts (%u welded), %u faces\n", me,
+            taskNum, sctx->vertNum, vertSum - sctx->vertNum, sctx->faceNum);
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
 int
 seekExtract(seekContext *sctx, limnPolyData *lpld) {
   static const char me[]="seekExtract";
@@ -969,17 +1542,32 @@ seekExtract(seekContext *sctx, limnPolyData *lpld) {
 
   /* start time */
   time0 = airTime();
+  AIR_PROFILE_START(airProfileSeekExtract);
 
   switch(sctx->type) {
   case seekTypeIsocontour:
+    if ((sctx->spanIndexUse || sctx->spanIndexGiven)
+        && !sctx->strengthUse) {
+      E = isoIndexExtract(sctx, lpld);
+      break;
+    }
+    /* fall through */
   case seekTypeRidgeSurface:
   case seekTypeValleySurface:
   case seekTypeMinimalSurface:
   case seekTypeMaximalSurface:
   case seekTypeRidgeSurfaceOP:
-  case seekTypeRidgeSurfaceT:
   case seekTypeValleySurfaceOP:
+    if (sctx->threadNum > 1 && airThreadCapable && sctx->sz > 2) {
+      E = surfaceExtractParallel(sctx, lpld);
+    } else {
+      E = surfaceExtract(sctx, lpld);
+    }
+    break;
+  case seekTypeRidgeSurfaceT:
   case seekTypeValleySurfaceT:
+    /* the T-based extraction carries much more state between slabs,
+       which surfaceExtractParallel doesn't (yet) know how to split */
     E = surfaceExtract(sctx, lpld);
     break;
   default:
@@ -995,6 +1583,8 @@ seekExtract(seekContext *sctx, limnPolyData *lpld) {
 
   /* end time */
   sctx->time = airTime() - time0;
+  AIR_PROFILE_STOP(airProfileSeekExtract);
+  AIR_PROFILE_COUNT(airProfileSeekExtract, 1);
 
   sctx->flag[flagResult] = AIR_FALSE;
 
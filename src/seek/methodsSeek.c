@@ -65,6 +65,8 @@ seekContextNew(void) {
        solution is to use multiplicatively scaled dynamic array. But caller
        can also change this value on a per-context basis. */
     sctx->pldArrIncr = 2048;
+    sctx->spanIndexUse = AIR_FALSE;
+    sctx->threadNum = 1;
 
     sctx->nin = NULL;
     sctx->flag = AIR_CAST(int *, calloc(flagLast, sizeof(int)));
@@ -86,6 +88,8 @@ seekContextNew(void) {
     ELL_3M_IDENTITY_SET(sctx->txfNormal);
     sctx->spanSize = 300;
     sctx->nspanHist = nrrdNew();
+    sctx->nspanIndex = nrrdNew();
+    sctx->spanIndexGiven = AIR_FALSE;
     sctx->range = nrrdRangeNew(AIR_NAN, AIR_NAN);
     sctx->sx = 0;
     sctx->sy = 0;
@@ -138,6 +142,7 @@ seekContextNix(seekContext *sctx) {
     sctx->_shape = gageShapeNix(sctx->_shape);
     sctx->nsclDerived = nrrdNuke(sctx->nsclDerived);
     sctx->nspanHist = nrrdNuke(sctx->nspanHist);
+    sctx->nspanIndex = nrrdNuke(sctx->nspanIndex);
     sctx->range = nrrdRangeNix(sctx->range);
     sctx->nvidx = nrrdNuke(sctx->nvidx);
     sctx->nsclv = nrrdNuke(sctx->nsclv);
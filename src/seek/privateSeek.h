@@ -47,6 +47,7 @@ enum {
   flagSlabCacheAlloc,
   flagSclDerived,
   flagSpanSpaceHist,
+  flagSpanIndex,
 
   flagResult,
   flagLast
@@ -56,10 +57,14 @@ typedef struct {
   int evti[12];  /* edge vertex index */
   double (*scllup)(const void *, size_t);
   unsigned int esIdx,  /* eigensystem index */
-    zi;     /* slice index we're currently on */
+    zi,     /* slice index we're currently on */
+    zStart; /* first slice handled with this baggage (non-zero only
+               when each thread handles its own range of slices) */
   int modeSign;
   const void *scldata;
   airArray *xyzwArr, *normArr, *indxArr;
+  airThreadMutex *biffMutex;  /* when non-NULL (in parallel extraction),
+                                 to be held while adding to biff */
 } baggage;
 
 /* extract.c: This one is also needed in textract.c: */
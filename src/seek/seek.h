@@ -111,6 +111,17 @@ typedef struct {
     vertsPerVoxel;              /* approximate; for pre-allocating geometry */
   unsigned int pldArrIncr;      /* increment for airArrays used during the
                                    creation of geometry */
+  int spanIndexUse;             /* for seekTypeIsocontour: build (once per
+                                   input) and use an index of cells sorted
+                                   by span space bucket, so that extraction
+                                   only visits cells that the isovalue
+                                   can intersect */
+  unsigned int threadNum;       /* number of threads to use in seekExtract;
+                                   each handles a contiguous range of slabs
+                                   with its own copies of the gage context
+                                   and slab caches.  Output is the same as
+                                   with one thread. Not (yet) used for
+                                   seekType{Ridge,Valley}SurfaceT */
   /* ------ internal ----- */
   int *flag;                    /* for controlling updates of internal state */
   const Nrrd *nin;              /* either ninscl or gctx->pvl->nin */
@@ -132,6 +143,15 @@ typedef struct {
                                    span space along edge */
   Nrrd *nspanHist;              /* for seekTypeIsocontour: span space
                                    histogram */
+  Nrrd *nspanIndex;             /* if spanIndexUse: 1-D array of unsigned
+                                   ints; the first spanSize*spanSize+1 are
+                                   offsets (into the rest of the array) of
+                                   the cells in each span space bucket, and
+                                   the rest are the cell indices themselves.
+                                   Can be saved with nrrdSave and given back
+                                   (with the same input) to seekSpanIndexSet */
+  int spanIndexGiven;           /* nspanIndex came from seekSpanIndexSet, and
+                                   so shouldn't be re-computed */
   NrrdRange *range;             /* for seekTypeIsocontour: range of scalars */
   size_t sx, sy, sz;            /* actual dimensions of feature grid */
   double txfIdx[16];            /* transforms from the index space of the
@@ -234,6 +254,9 @@ SEEK_EXPORT int seekItemEigensystemSet(seekContext *sctx,
 SEEK_EXPORT int seekItemHessSet(seekContext *sctx, int item);
 SEEK_EXPORT int seekIsovalueSet(seekContext *sctx, double isovalue);
 SEEK_EXPORT int seekEvalDiffThreshSet(seekContext *sctx, double evalDiffThresh);
+SEEK_EXPORT int seekThreadNumSet(seekContext *sctx, unsigned int threadNum);
+SEEK_EXPORT int seekSpanIndexUseSet(seekContext *sctx, int doit);
+SEEK_EXPORT int seekSpanIndexSet(seekContext *sctx, const Nrrd *nidx);
 
 /* updateSeek */
 SEEK_EXPORT int seekUpdate(seekContext *sctx);
@@ -461,3 +461,79 @@ seekEvalDiffThreshSet(seekContext *sctx, double evalDiffThresh) {
   }
   return 0;
 }
+
+/*
+******** seekThreadNumSet
+**
+** sets: number of threads used by seekExtract.  This does not invalidate
+** anything: the per-thread state is created and destroyed by seekExtract
+*/
+int
+seekThreadNumSet(seekContext *sctx, unsigned int threadNum) {
+  static const char me[]="seekThreadNumSet";
+
+  if (!sctx) {
+    biffAddf(SEEK, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!threadNum) {
+    biffAddf(SEEK, "%s: need non-zero threadNum", me);
+    return 1;
+  }
+  sctx->threadNum = threadNum;
+  return 0;
+}
+
+/*
+******** seekSpanIndexUseSet
+**
+** sets: whether to build (for seekTypeIsocontour) an index of the cells
+** in each span space bucket, so that the repeated extraction of
+** isocontours from the same volume only visits the cells that may
+** contain the isosurface
+*/
+int
+seekSpanIndexUseSet(seekContext *sctx, int doit) {
+  static const char me[]="seekSpanIndexUseSet";
+
+  if (!sctx) {
+    biffAddf(SEEK, "%s: got NULL pointer", me);
+    return 1;
+  }
+  doit = !!doit;
+  if (sctx->spanIndexUse != doit) {
+    sctx->spanIndexUse = doit;
+    sctx->flag[flagSpanIndex] = AIR_TRUE;
+  }
+  return 0;
+}
+
+/*
+******** seekSpanIndexSet
+**
+** sets: span space index, as previously computed by seekUpdate with
+** seekSpanIndexUseSet(sctx, AIR_TRUE) and copied out of sctx->nspanIndex,
+** so that it needn't be re-computed.  The index is only checked against
+** the current input in seekUpdate.  Passing NULL forgets any given index.
+** Setting a new input volume (or gage context) also forgets it.
+*/
+int
+seekSpanIndexSet(seekContext *sctx, const Nrrd *nidx) {
+  static const char me[]="seekSpanIndexSet";
+
+  if (!sctx) {
+    biffAddf(SEEK, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (nidx) {
+    if (nrrdCopy(sctx->nspanIndex, nidx)) {
+      biffMovef(SEEK, NRRD, "%s: trouble copying index", me);
+      return 1;
+    }
+    sctx->spanIndexGiven = AIR_TRUE;
+  } else {
+    sctx->spanIndexGiven = AIR_FALSE;
+  }
+  sctx->flag[flagSpanIndex] = AIR_TRUE;
+  return 0;
+}
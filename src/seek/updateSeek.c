@@ -606,13 +606,123 @@ updateSclDerived(seekContext *sctx) {
   return 0;
 }
 
+/*
+** min and max over the 8 corners of the cell with lower corner at vi
+*/
+static void
+cellMinMax(double *minP, double *maxP,
+           double (*lup)(const void *, size_t), const void *data,
+           size_t vi, size_t sx, size_t sy) {
+  double min, max, val;
+
+  val = lup(data, vi + 0 + 0*sx + 0*sx*sy);
+  min = max = val;
+  val = lup(data, vi + 1 + 0*sx + 0*sx*sy);
+  min = AIR_MIN(min, val);
+  max = AIR_MAX(max, val);
+  val = lup(data, vi + 0 + 1*sx + 0*sx*sy);
+  min = AIR_MIN(min, val);
+  max = AIR_MAX(max, val);
+  val = lup(data, vi + 1 + 1*sx + 0*sx*sy);
+  min = AIR_MIN(min, val);
+  max = AIR_MAX(max, val);
+  val = lup(data, vi + 0 + 0*sx + 1*sx*sy);
+  min = AIR_MIN(min, val);
+  max = AIR_MAX(max, val);
+  val = lup(data, vi + 1 + 0*sx + 1*sx*sy);
+  min = AIR_MIN(min, val);
+  max = AIR_MAX(max, val);
+  val = lup(data, vi + 0 + 1*sx + 1*sx*sy);
+  min = AIR_MIN(min, val);
+  max = AIR_MAX(max, val);
+  val = lup(data, vi + 1 + 1*sx + 1*sx*sy);
+  min = AIR_MIN(min, val);
+  max = AIR_MAX(max, val);
+  *minP = min;
+  *maxP = max;
+  return;
+}
+
+/*
+** learns from the key/value pairs in a given span space index whether it
+** was made for the current context, and if so, sets sctx->range from it
+*/
+static int
+spanIndexCheck(seekContext *sctx, const Nrrd *nidx) {
+  static const char me[]="spanIndexCheck";
+  char *str;
+  unsigned int spanSize, size[3];
+  double min, max;
+  int ok;
+
+  if (!( 1 == nidx->dim && nrrdTypeUInt == nidx->type )) {
+    biffAddf(SEEK, "%s: need 1-D %s array (not %u-D %s)", me,
+             airEnumStr(nrrdType, nrrdTypeUInt), nidx->dim,
+             airEnumStr(nrrdType, nidx->type));
+    return 1;
+  }
+  ok = AIR_FALSE;
+  str = nrrdKeyValueGet(nidx, "seekSpanSize");
+  if (str) {
+    ok = (1 == sscanf(str, "%u", &spanSize));
+    if (!nrrdStateKeyValueReturnInternalPointers) free(str);
+  }
+  str = nrrdKeyValueGet(nidx, "seekSize");
+  if (ok && str) {
+    ok = (3 == sscanf(str, "%u %u %u", size + 0, size + 1, size + 2));
+  } else {
+    ok = AIR_FALSE;
+  }
+  if (str && !nrrdStateKeyValueReturnInternalPointers) free(str);
+  str = nrrdKeyValueGet(nidx, "seekSpanRange");
+  if (ok && str) {
+    ok = (2 == sscanf(str, "%lg %lg", &min, &max));
+  } else {
+    ok = AIR_FALSE;
+  }
+  if (str && !nrrdStateKeyValueReturnInternalPointers) free(str);
+  if (!ok) {
+    biffAddf(SEEK, "%s: didn't find seekSpanSize, seekSize, seekSpanRange "
+             "key/value pairs", me);
+    return 1;
+  }
+  if (!( spanSize == sctx->spanSize
+         && size[0] == sctx->sx && size[1] == sctx->sy
+         && size[2] == sctx->sz )) {
+    biffAddf(SEEK, "%s: index for span size %u, volume %u x %u x %u; "
+             "but have span size %u, volume %u x %u x %u", me,
+             spanSize, size[0], size[1], size[2],
+             AIR_CAST(unsigned int, sctx->spanSize),
+             AIR_CAST(unsigned int, sctx->sx),
+             AIR_CAST(unsigned int, sctx->sy),
+             AIR_CAST(unsigned int, sctx->sz));
+    return 1;
+  }
+  if (nidx->axis[0].size != (sctx->spanSize*sctx->spanSize + 1
+                             + (sctx->sx-1)*(sctx->sy-1)*(sctx->sz-1))) {
+    biffAddf(SEEK, "%s: index length %u wrong for span size and volume", me,
+             AIR_CAST(unsigned int, nidx->axis[0].size));
+    return 1;
+  }
+  if (!( AIR_EXISTS(min) && AIR_EXISTS(max) && min <= max )) {
+    biffAddf(SEEK, "%s: bogus range [%g,%g]", me, min, max);
+    return 1;
+  }
+  sctx->range->min = min;
+  sctx->range->max = max;
+  sctx->range->hasNonExist = nrrdHasNonExistFalse;
+  return 0;
+}
+
 static int
 updateSpanSpaceHist(seekContext *sctx) {
   static const char me[]="updateSpanSpaceHist";
-  unsigned int sx, sy, sz, ss, xi, yi, zi, vi, si, minI, maxI, *spanHist;
-  double min, max, val;
+  unsigned int sx, sy, sz, ss, xi, yi, zi, vi, si, minI, maxI, *spanHist,
+    *spanIdx, *fill;
+  double min, max;
   const void *data;
   double (*lup)(const void *, size_t);
+  char stmp[AIR_STRLEN_LARGE];
 
   if (sctx->verbose > 5) {
     fprintf(stderr, "%s: --------------------\n", me);
@@ -622,22 +732,41 @@ updateSpanSpaceHist(seekContext *sctx) {
             sctx->flag[flagSclDerived]);
     fprintf(stderr, "%s: flagNinEtAl = %d\n", me,
             sctx->flag[flagNinEtAl]);
+    fprintf(stderr, "%s: flagSpanIndex = %d\n", me,
+            sctx->flag[flagSpanIndex]);
   }
 
   if (sctx->flag[flagType]
       || sctx->flag[flagSclDerived]
-      || sctx->flag[flagNinEtAl]) {
+      || sctx->flag[flagNinEtAl]
+      || sctx->flag[flagSpanIndex]) {
+    if (sctx->spanIndexGiven
+        && !sctx->flag[flagSpanIndex]
+        && (sctx->flag[flagSclDerived] || sctx->flag[flagNinEtAl])) {
+      /* input changed since the index was given; it is no longer valid */
+      sctx->spanIndexGiven = AIR_FALSE;
+    }
     if (seekTypeIsocontour != sctx->type) {
       nrrdEmpty(sctx->nspanHist);
+      nrrdEmpty(sctx->nspanIndex);
       sctx->range->min = AIR_NAN;
       sctx->range->max = AIR_NAN;
     } else {
-      nrrdRangeSet(sctx->range,
-                   (sctx->ninscl ? sctx->ninscl : sctx->nsclDerived),
-                   nrrdBlind8BitRangeFalse);
-      if (sctx->range->hasNonExist) {
-        biffAddf(SEEK, "%s: scalar volume has non-existent values", me);
-        return 1;
+      ss = AIR_CAST(unsigned int, sctx->spanSize);
+      if (sctx->spanIndexGiven) {
+        /* range and histogram can be learned from index */
+        if (spanIndexCheck(sctx, sctx->nspanIndex)) {
+          biffAddf(SEEK, "%s: given span space index not usable", me);
+          return 1;
+        }
+      } else {
+        nrrdRangeSet(sctx->range,
+                     (sctx->ninscl ? sctx->ninscl : sctx->nsclDerived),
+                     nrrdBlind8BitRangeFalse);
+        if (sctx->range->hasNonExist) {
+          biffAddf(SEEK, "%s: scalar volume has non-existent values", me);
+          return 1;
+        }
       }
       sctx->nspanHist->axis[0].min = sctx->range->min;
       sctx->nspanHist->axis[1].min = sctx->range->min;
@@ -664,45 +793,71 @@ updateSpanSpaceHist(seekContext *sctx) {
       sx = sctx->sx;
       sy = sctx->sy;
       sz = sctx->sz;
-      ss = sctx->spanSize;
-      for (si=0; si<ss*ss; si++) {
-        spanHist[si] = 0;
+      if (sctx->spanIndexGiven) {
+        spanIdx = AIR_CAST(unsigned int*, sctx->nspanIndex->data);
+        for (si=0; si<ss*ss; si++) {
+          spanHist[si] = spanIdx[si+1] - spanIdx[si];
+        }
+      } else {
+        for (si=0; si<ss*ss; si++) {
+          spanHist[si] = 0;
+        }
+        for (zi=0; zi<sz-1; zi++) {
+          for (yi=0; yi<sy-1; yi++) {
+            for (xi=0; xi<sx-1; xi++) {
+              vi = xi + sx*(yi + sy*zi);
+              cellMinMax(&min, &max, lup, data, vi, sx, sy);
+              minI = airIndex(sctx->range->min, min, sctx->range->max, ss);
+              maxI = airIndex(sctx->range->min, max, sctx->range->max, ss);
+              spanHist[minI + ss*maxI]++;
+            }
+          }
+        }
       }
-      for (zi=0; zi<sz-1; zi++) {
-        for (yi=0; yi<sy-1; yi++) {
-          for (xi=0; xi<sx-1; xi++) {
-            vi = xi + sx*(yi + sy*zi);
-            val = lup(data, vi + 0 + 0*sx + 0*sx*sy);
-            min = max = val;
-            val = lup(data, vi + 1 + 0*sx + 0*sx*sy);
-            min = AIR_MIN(min, val);
-            max = AIR_MAX(max, val);
-            val = lup(data, vi + 0 + 1*sx + 0*sx*sy);
-            min = AIR_MIN(min, val);
-            max = AIR_MAX(max, val);
-            val = lup(data, vi + 1 + 1*sx + 0*sx*sy);
-            min = AIR_MIN(min, val);
-            max = AIR_MAX(max, val);
-            val = lup(data, vi + 0 + 0*sx + 1*sx*sy);
-            min = AIR_MIN(min, val);
-            max = AIR_MAX(max, val);
-            val = lup(data, vi + 1 + 0*sx + 1*sx*sy);
-            min = AIR_MIN(min, val);
-            max = AIR_MAX(max, val);
-            val = lup(data, vi + 0 + 1*sx + 1*sx*sy);
-            min = AIR_MIN(min, val);
-            max = AIR_MAX(max, val);
-            val = lup(data, vi + 1 + 1*sx + 1*sx*sy);
-            min = AIR_MIN(min, val);
-            max = AIR_MAX(max, val);
-            minI = airIndex(sctx->range->min, min, sctx->range->max, ss);
-            maxI = airIndex(sctx->range->min, max, sctx->range->max, ss);
-            spanHist[minI + ss*maxI]++;
+      if (sctx->spanIndexUse && !sctx->spanIndexGiven) {
+        /* counting sort of the cells into span space buckets */
+        if (nrrdMaybeAlloc_va(sctx->nspanIndex, nrrdTypeUInt, 1,
+                              AIR_CAST(size_t, ss*ss + 1
+                                       + (sx-1)*(sy-1)*(sz-1)))) {
+          biffMovef(SEEK, NRRD, "%s: couldn't allocate span space index", me);
+          return 1;
+        }
+        spanIdx = AIR_CAST(unsigned int*, sctx->nspanIndex->data);
+        fill = AIR_CALLOC(ss*ss, unsigned int);
+        if (!fill) {
+          biffAddf(SEEK, "%s: couldn't allocate %u counters", me, ss*ss);
+          return 1;
+        }
+        spanIdx[0] = ss*ss + 1;
+        for (si=0; si<ss*ss; si++) {
+          spanIdx[si+1] = spanIdx[si] + spanHist[si];
+        }
+        for (zi=0; zi<sz-1; zi++) {
+          for (yi=0; yi<sy-1; yi++) {
+            for (xi=0; xi<sx-1; xi++) {
+              vi = xi + sx*(yi + sy*zi);
+              cellMinMax(&min, &max, lup, data, vi, sx, sy);
+              minI = airIndex(sctx->range->min, min, sctx->range->max, ss);
+              maxI = airIndex(sctx->range->min, max, sctx->range->max, ss);
+              si = minI + ss*maxI;
+              spanIdx[spanIdx[si] + fill[si]++] = vi;
+            }
           }
         }
+        free(fill);
+        nrrdKeyValueClear(sctx->nspanIndex);
+        sprintf(stmp, "%u", ss);
+        nrrdKeyValueAdd(sctx->nspanIndex, "seekSpanSize", stmp);
+        sprintf(stmp, "%u %u %u", sx, sy, sz);
+        nrrdKeyValueAdd(sctx->nspanIndex, "seekSize", stmp);
+        sprintf(stmp, "%.17g %.17g", sctx->range->min, sctx->range->max);
+        nrrdKeyValueAdd(sctx->nspanIndex, "seekSpanRange", stmp);
+      } else if (!sctx->spanIndexGiven) {
+        nrrdEmpty(sctx->nspanIndex);
       }
     }
     sctx->flag[flagSclDerived] = AIR_FALSE;
+    sctx->flag[flagSpanIndex] = AIR_FALSE;
     sctx->flag[flagSpanSpaceHist] = AIR_TRUE;
   }
   return 0;
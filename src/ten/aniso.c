@@ -1036,13 +1036,36 @@ tenAnisoPlot(Nrrd *nout, int aniso, unsigned int res,
   return 0;
 }
 
+/*
+** _tenAnisoNeedsEigen
+**
+** whether _tenAnisoTen_f[aniso] does its own eigensolve (the others are
+** computed from tensor invariants), in which case volume-level callers
+** are better off with tenEigensolveBatch_f and tenAnisoEval_f
+*/
+static int
+_tenAnisoNeedsEigen(int aniso) {
+
+  return (AIR_IN_CL(tenAniso_Cl1, aniso, tenAniso_Ct2)
+          || AIR_IN_CL(tenAniso_eval0, aniso, tenAniso_eval2));
+}
+
+/*
+******** tenAnisoVolumeParallel
+**
+** like tenAnisoVolume, but measures that need eigenvalues are computed
+** from batches of threadNum-threaded tenEigensolveBatch_f.  Results are
+** the same as for tenAnisoVolume, regardless of threadNum.
+*/
 int
-tenAnisoVolume(Nrrd *nout, const Nrrd *nin, int aniso, double confThresh) {
-  static const char me[]="tenAnisoVolume";
-  size_t N, I;
-  float *out, *in, *tensor;
-  int map[NRRD_DIM_MAX];
+tenAnisoVolumeParallel(Nrrd *nout, const Nrrd *nin, int aniso,
+                       double confThresh, unsigned int threadNum) {
+  static const char me[]="tenAnisoVolumeParallel";
+  size_t N, I, base, num;
+  float *out, *in, *tensor, *evalBuff;
+  int map[NRRD_DIM_MAX], needEigen;
   size_t sx, sy, sz, size[3];
+  airArray *mop;
 
   if (tenTensorCheck(nin, nrrdTypeFloat, AIR_TRUE, AIR_TRUE)) {
     biffAddf(TEN, "%s: didn't get a tensor nrrd", me);
@@ -1064,63 +1087,93 @@ tenAnisoVolume(Nrrd *nout, const Nrrd *nin, int aniso, double confThresh) {
   }
   out = (float *)nout->data;
   in = (float *)nin->data;
-  for (I=0; I<=N-1; I++) {
-    /* tenVerbose = (I == 911327); */
-    tensor = in + I*7;
-    if (tenAniso_Conf != aniso && tensor[0] < confThresh) {
-      out[I] = 0.0;
-      continue;
+  mop = airMopNew();
+  needEigen = _tenAnisoNeedsEigen(aniso);
+  if (needEigen) {
+    evalBuff = AIR_CALLOC(3*AIR_MIN(N, _TEN_EIGEN_BATCH_NUM), float);
+    airMopAdd(mop, evalBuff, airFree, airMopAlways);
+    if (!evalBuff) {
+      biffAddf(TEN, "%s: couldn't allocate eigenvalue buffer", me);
+      airMopError(mop); return 1;
     }
-    /* no longer used
-    tenEigensolve_f(eval, NULL, tensor);
-    if (!(AIR_EXISTS(eval[0]) && AIR_EXISTS(eval[1]) && AIR_EXISTS(eval[2]))) {
-      NRRD_COORD_GEN(coord, size, 3, I);
-      biffAddf(TEN, "%s: not all eigenvalues exist (%g,%g,%g) at sample "
-               "%d = (%d,%d,%d)",
-               me, eval[0], eval[1], eval[2], (int)I,
-               (int)coord[0], (int)coord[1], (int)coord[2]);
-      return 1;
+  } else {
+    evalBuff = NULL;
+  }
+  for (base=0; base<N; base+=num) {
+    num = AIR_MIN(N - base, _TEN_EIGEN_BATCH_NUM);
+    if (needEigen
+        && tenEigensolveBatch_f(evalBuff, NULL, in + 7*base, num,
+                                threadNum)) {
+      biffAddf(TEN, "%s: trouble", me);
+      airMopError(mop); return 1;
     }
-    */
-    out[I] = tenAnisoTen_f(tensor, aniso);
-    if (!AIR_EXISTS(out[I])) {
-      size_t coord[3];
-      NRRD_COORD_GEN(coord, size, 3, I);
-      biffAddf(TEN, "%s: generated non-existent aniso %g from tensor "
-               "(%g) %g %g %g   %g %g   %g at sample %u = (%u,%u,%u)", me,
-               out[I],
-               tensor[0], tensor[1], tensor[2], tensor[3],
-               tensor[4], tensor[5], tensor[6],
-               AIR_CAST(unsigned int, I),
-               AIR_CAST(unsigned int, coord[0]),
-               AIR_CAST(unsigned int, coord[1]),
-               AIR_CAST(unsigned int, coord[2]));
-      return 1;
+    for (I=base; I<base+num; I++) {
+      tensor = in + I*7;
+      if (tenAniso_Conf != aniso && tensor[0] < confThresh) {
+        out[I] = 0.0;
+        continue;
+      }
+      out[I] = (needEigen
+                ? tenAnisoEval_f(evalBuff + 3*(I - base), aniso)
+                : tenAnisoTen_f(tensor, aniso));
+      if (!AIR_EXISTS(out[I])) {
+        size_t coord[3];
+        NRRD_COORD_GEN(coord, size, 3, I);
+        biffAddf(TEN, "%s: generated non-existent aniso %g from tensor "
+                 "(%g) %g %g %g   %g %g   %g at sample %u = (%u,%u,%u)", me,
+                 out[I],
+                 tensor[0], tensor[1], tensor[2], tensor[3],
+                 tensor[4], tensor[5], tensor[6],
+                 AIR_CAST(unsigned int, I),
+                 AIR_CAST(unsigned int, coord[0]),
+                 AIR_CAST(unsigned int, coord[1]),
+                 AIR_CAST(unsigned int, coord[2]));
+        airMopError(mop); return 1;
+      }
     }
   }
   ELL_3V_SET(map, 1, 2, 3);
   if (nrrdAxisInfoCopy(nout, nin, map, NRRD_AXIS_INFO_SIZE_BIT)) {
     biffMovef(TEN, NRRD, "%s: trouble", me);
-    return 1;
+    airMopError(mop); return 1;
   }
   if (nrrdBasicInfoCopy(nout, nin,
                         NRRD_BASIC_INFO_ALL ^ NRRD_BASIC_INFO_SPACE)) {
     biffAddf(NRRD, "%s:", me);
-    return 1;
+    airMopError(mop); return 1;
   }
 
+  airMopOkay(mop);
   return 0;
 }
 
 int
-tenAnisoHistogram(Nrrd *nout, const Nrrd *nin, const Nrrd *nwght,
-                  int right, int version, unsigned int res) {
-  static const char me[]="tenAnisoHistogram";
-  size_t N, I;
+tenAnisoVolume(Nrrd *nout, const Nrrd *nin, int aniso, double confThresh) {
+  static const char me[]="tenAnisoVolume";
+
+  if (tenAnisoVolumeParallel(nout, nin, aniso, confThresh, 1)) {
+    biffAddf(TEN, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+******** tenAnisoHistogramParallel
+**
+** like tenAnisoHistogram, with threadNum threads for the eigensolves
+*/
+int
+tenAnisoHistogramParallel(Nrrd *nout, const Nrrd *nin, const Nrrd *nwght,
+                          int right, int version, unsigned int res,
+                          unsigned int threadNum) {
+  static const char me[]="tenAnisoHistogramParallel";
+  size_t N, I, base, num;
   int csIdx, clIdx, cpIdx;
-  float *tdata, *out, eval[3],
+  float *tdata, *out, *eval, *evalBuff,
     cs, cl, cp, (*wlup)(const void *data, size_t idx), weight;
   unsigned int yres, xi, yi;
+  airArray *mop;
 
   if (tenTensorCheck(nin, nrrdTypeFloat, AIR_TRUE, AIR_TRUE)) {
     biffAddf(TEN, "%s: didn't get a tensor nrrd", me);
@@ -1177,25 +1230,52 @@ tenAnisoHistogram(Nrrd *nout, const Nrrd *nin, const Nrrd *nwght,
     csIdx = tenAniso_Cs2;
   }
   N = nrrdElementNumber(nin)/nrrdKindSize(nrrdKind3DMaskedSymMatrix);
-  for (I=0; I<N; I++) {
-    tenEigensolve_f(eval, NULL, tdata);
-    cl = tenAnisoEval_f(eval, clIdx);
-    cp = tenAnisoEval_f(eval, cpIdx);
-    cs = tenAnisoEval_f(eval, csIdx);
-    if (right) {
-      xi = AIR_CAST(unsigned int, cs*0 + cl*(res-1) + cp*0);
-      yi = AIR_CAST(unsigned int, cs*0 + cl*(yres-1) + cp*(yres-1));
-    } else {
-      xi = AIR_CAST(unsigned int, cs*0 + cl*0 + cp*(res-1));
-      yi = AIR_CAST(unsigned int, cs*0 + cl*(res-1) + cp*(res-1));
+  mop = airMopNew();
+  evalBuff = AIR_CALLOC(3*AIR_MIN(N, _TEN_EIGEN_BATCH_NUM), float);
+  airMopAdd(mop, evalBuff, airFree, airMopAlways);
+  if (!evalBuff) {
+    biffAddf(TEN, "%s: couldn't allocate eigenvalue buffer", me);
+    airMopError(mop); return 1;
+  }
+  for (base=0; base<N; base+=num) {
+    num = AIR_MIN(N - base, _TEN_EIGEN_BATCH_NUM);
+    if (tenEigensolveBatch_f(evalBuff, NULL, tdata, num, threadNum)) {
+      biffAddf(TEN, "%s: trouble", me);
+      airMopError(mop); return 1;
     }
-    weight = wlup ? wlup(nwght->data, I) : 1.0f;
-    if (xi < res && yi < yres-1) {
-      out[xi + res*yi] += tdata[0]*weight;
+    for (I=base; I<base+num; I++) {
+      eval = evalBuff + 3*(I - base);
+      cl = tenAnisoEval_f(eval, clIdx);
+      cp = tenAnisoEval_f(eval, cpIdx);
+      cs = tenAnisoEval_f(eval, csIdx);
+      if (right) {
+        xi = AIR_CAST(unsigned int, cs*0 + cl*(res-1) + cp*0);
+        yi = AIR_CAST(unsigned int, cs*0 + cl*(yres-1) + cp*(yres-1));
+      } else {
+        xi = AIR_CAST(unsigned int, cs*0 + cl*0 + cp*(res-1));
+        yi = AIR_CAST(unsigned int, cs*0 + cl*(res-1) + cp*(res-1));
+      }
+      weight = wlup ? wlup(nwght->data, I) : 1.0f;
+      if (xi < res && yi < yres-1) {
+        out[xi + res*yi] += tdata[0]*weight;
+      }
+      tdata += nrrdKindSize(nrrdKind3DMaskedSymMatrix);
     }
-    tdata += nrrdKindSize(nrrdKind3DMaskedSymMatrix);
   }
 
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+tenAnisoHistogram(Nrrd *nout, const Nrrd *nin, const Nrrd *nwght,
+                  int right, int version, unsigned int res) {
+  static const char me[]="tenAnisoHistogram";
+
+  if (tenAnisoHistogramParallel(nout, nin, nwght, right, version, res, 1)) {
+    biffAddf(TEN, "%s: trouble", me);
+    return 1;
+  }
   return 0;
 }
 
@@ -1215,6 +1295,7 @@ tenEvecRGBParmNew() {
     rgbp->maxSat = 1.0;
     rgbp->typeOut = nrrdTypeFloat;
     rgbp->genAlpha = AIR_FALSE;
+    rgbp->threadNum = 1;
   }
   return rgbp;
 }
@@ -54,8 +54,9 @@ _tenEpiRegSave(const char *fname, Nrrd *nsingle, Nrrd **nmulti,
 int
 _tenEpiRegCheck(Nrrd **nout, Nrrd **ndwi, unsigned int dwiLen, Nrrd *ngrad,
                 int reference,
-                double bwX, double bwY, double DWthr,
-                const NrrdKernel *kern, double *kparm) {
+                double bwX, double bwY, double DWthr, unsigned int shrink,
+                const NrrdKernel *kern, double *kparm,
+                unsigned int threadNum) {
   static const char me[]="_tenEpiRegCheck";
   unsigned int ni;
 
@@ -108,23 +109,192 @@ _tenEpiRegCheck(Nrrd **nout, Nrrd **ndwi, unsigned int dwiLen, Nrrd *ngrad,
              me, bwX, bwY);
     return 1;
   }
+  if (!( shrink >= 1 )) {
+    biffAddf(TEN, "%s: need shrink factor >= 1", me);
+    return 1;
+  }
+  if (!( ndwi[0]->axis[0].size/shrink >= 4
+         && ndwi[0]->axis[1].size/shrink >= 4 )) {
+    char stmp1[AIR_STRLEN_SMALL], stmp2[AIR_STRLEN_SMALL];
+    biffAddf(TEN, "%s: shrink factor %u leaves less than 4x4 of %s x %s "
+             "slices", me, shrink,
+             airSprintSize_t(stmp1, ndwi[0]->axis[0].size),
+             airSprintSize_t(stmp2, ndwi[0]->axis[1].size));
+    return 1;
+  }
+  if (!threadNum) {
+    biffAddf(TEN, "%s: need non-zero threadNum", me);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** The per-DWI (and per-slice) stages below are run by _tenEpiRegRun,
+** which hands out the DWI (or slice) indices one at a time to
+** "threadNum" threads, each calling the stage function on its indices.
+** The stages only write to the outputs for their own index, so the
+** results don't depend on threadNum.  biff is not thread-safe, so the
+** stages don't use biff, nor call anything (like most of nrrd) that
+** does: their outputs are allocated by the callers before the run, and
+** a stage that fails describes why in the given "err" buffer, which
+** _tenEpiRegRun adds to biff once all the threads are done.
+*/
+typedef struct {
+  /* shared (same for all threads) */
+  int (*stage)(char *err, void *parm, unsigned int idx);
+  void *parm;
+  unsigned int idxNum,
+    *idxNext;                     /* next index to hand out, under mutex */
+  int *abort,                     /* set on first error, under mutex */
+    verb;
+  airThreadMutex *mutex;
+  /* per-thread */
+  unsigned int threadIdx,
+    errIdx;                       /* index on which the stage failed */
+  int error;                      /* this thread saw trouble */
+  char err[AIR_STRLEN_MED];       /* the stage's description of it */
+} _tenEpiRegTask;
+
+static void *
+_tenEpiRegWorker(void *_task) {
+  _tenEpiRegTask *task;
+  unsigned int idx;
+
+  task = AIR_CAST(_tenEpiRegTask *, _task);
+  while (1) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    if (*(task->abort)) {
+      idx = task->idxNum;
+    } else {
+      idx = *(task->idxNext);
+      if (idx < task->idxNum) {
+        *(task->idxNext) += 1;
+        if (task->verb) {
+          fprintf(stderr, "%2u ", idx); fflush(stderr);
+        }
+      }
+    }
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (idx == task->idxNum) {
+      break;
+    }
+    if (task->stage(task->err, task->parm, idx)) {
+      task->error = AIR_TRUE;
+      task->errIdx = idx;
+      if (task->mutex) {
+        airThreadMutexLock(task->mutex);
+      }
+      *(task->abort) = AIR_TRUE;
+      if (task->mutex) {
+        airThreadMutexUnlock(task->mutex);
+      }
+      break;
+    }
+  }
+  return _task;
+}
+
+static int
+_tenEpiRegRun(const char *who,
+              int (*stage)(char *err, void *parm, unsigned int idx),
+              void *parm, unsigned int idxNum, unsigned int threadNum,
+              int verb) {
+  static const char me[]="_tenEpiRegRun";
+  _tenEpiRegTask *task;
+  airThreadMutex *mutex;
+  airArray *mop;
+  unsigned int ti, idxNext, failIdx;
+  int abort, hadErr;
+
+  if (!airThreadCapable) {
+    threadNum = 1;
+  }
+  threadNum = AIR_MAX(1, AIR_MIN(threadNum, idxNum));
+  mop = airMopNew();
+  task = AIR_CALLOC(threadNum, _tenEpiRegTask);
+  if (!task) {
+    biffAddf(TEN, "%s: couldn't allocate %u tasks", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (threadNum > 1) {
+    mutex = airThreadMutexNew();
+    airMopAdd(mop, mutex, (airMopper)airThreadMutexNix, airMopAlways);
+  } else {
+    mutex = NULL;
+  }
+  idxNext = 0;
+  abort = AIR_FALSE;
+  for (ti=0; ti<threadNum; ti++) {
+    task[ti].stage = stage;
+    task[ti].parm = parm;
+    task[ti].idxNum = idxNum;
+    task[ti].idxNext = &idxNext;
+    task[ti].abort = &abort;
+    task[ti].verb = verb;
+    task[ti].mutex = mutex;
+    task[ti].threadIdx = ti;
+    task[ti].errIdx = 0;
+    task[ti].error = AIR_FALSE;
+    strcpy(task[ti].err, "");
+  }
+  if (verb) {
+    fprintf(stderr, "%s:\n            ", who); fflush(stderr);
+  }
+  failIdx = airThreadRun(threadNum, _tenEpiRegWorker, task,
+                         sizeof(_tenEpiRegTask), &abort, mutex);
+  if (failIdx) {
+    biffAddf(TEN, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
+  hadErr = AIR_FALSE;
+  for (ti=0; ti<threadNum; ti++) {
+    if (task[ti].error) {
+      biffAddf(TEN, "%s: thread %u had trouble on index %u: %s", me,
+               ti, task[ti].errIdx, task[ti].err);
+      hadErr = AIR_TRUE;
+    }
+  }
+  if (hadErr) {
+    biffAddf(TEN, "%s: trouble in %s with %u threads", me, who, threadNum);
+    airMopError(mop); return 1;
+  }
+  if (verb) {
+    fprintf(stderr, "done\n");
+  }
+  airMopOkay(mop);
   return 0;
 }
 
 /*
 ** this assumes that all nblur[i] are valid nrrds, and does nothing
-** to manage them
+** to manage them.  Each DWI is blurred within its slices, and (with
+** shrink > 1) downsampled by the same factor along X and Y.  The
+** blurring is with the given standard deviations in the original
+** sample units; when downsampling without blurring, the samples are
+** box filtered.  This is not threaded (nrrdResampleExecute uses biff),
+** but one resample context is used for all the DWIs, so the kernel
+** weights are computed only once.
 */
 int
 _tenEpiRegBlur(Nrrd **nblur, Nrrd **ndwi, unsigned int dwiLen,
-               double bwX, double bwY, int verb) {
+               double bwX, double bwY, unsigned int shrink, int verb) {
   static const char me[]="_tenEpiRegBlur";
-  NrrdResampleInfo *rinfo;
+  NrrdResampleContext *rsmc;
+  const NrrdKernel *kern;
+  double bw[2], kparm[NRRD_KERNEL_PARMS_NUM];
   airArray *mop;
-  size_t ni, sx, sy, sz;
-  double savemin[2], savemax[2];
+  unsigned int ai;
+  size_t ni;
+  int E;
 
-  if (!( bwX || bwY )) {
+  if (!( bwX || bwY || shrink > 1 )) {
     if (verb) {
       fprintf(stderr, "%s:\n            ", me); fflush(stderr);
     }
@@ -143,35 +313,44 @@ _tenEpiRegBlur(Nrrd **nblur, Nrrd **ndwi, unsigned int dwiLen,
     }
     return 0;
   }
-  /* else we need to blur */
-  sx = ndwi[0]->axis[0].size;
-  sy = ndwi[0]->axis[1].size;
-  sz = ndwi[0]->axis[2].size;
+  /* else we need to blur (or downsample) */
   mop = airMopNew();
-  rinfo = nrrdResampleInfoNew();
-  airMopAdd(mop, rinfo, (airMopper)nrrdResampleInfoNix, airMopAlways);
-  if (bwX) {
-    rinfo->kernel[0] = nrrdKernelGaussian;
-    rinfo->parm[0][0] = bwX;
-    rinfo->parm[0][1] = 3.0; /* how many stnd devs do we cut-off at */
-  } else {
-    rinfo->kernel[0] = NULL;
+  rsmc = nrrdResampleContextNew();
+  airMopAdd(mop, rsmc, (airMopper)nrrdResampleContextNix, airMopAlways);
+  bw[0] = bwX;
+  bw[1] = bwY;
+  E = AIR_FALSE;
+  if (!E) E |= nrrdResampleInputSet(rsmc, ndwi[0]);
+  for (ai=0; ai<2; ai++) {
+    if (bw[ai]) {
+      kern = nrrdKernelGaussian;
+      /* kernels are stretched by the shrink factor when downsampling */
+      kparm[0] = bw[ai]/shrink;
+      kparm[1] = 3.0; /* how many stnd devs do we cut-off at */
+    } else if (shrink > 1) {
+      kern = nrrdKernelBox;
+      kparm[0] = 1.0;
+    } else {
+      kern = NULL;
+    }
+    if (!E) E |= nrrdResampleKernelSet(rsmc, ai, kern, kparm);
+    if (kern) {
+      /* so that downsampled sample i is at (i+0.5)*shrink - 0.5 */
+      if (!E) E |= nrrdResampleOverrideCenterSet(rsmc, ai, nrrdCenterCell);
+      if (!E) E |= nrrdResampleSamplesSet(rsmc, ai,
+                                          ndwi[0]->axis[ai].size/shrink);
+      if (!E) E |= nrrdResampleRangeFullSet(rsmc, ai);
+    }
+  }
+  if (!E) E |= nrrdResampleKernelSet(rsmc, 2, NULL, NULL);
+  if (!E) E |= nrrdResampleBoundarySet(rsmc, nrrdBoundaryBleed);
+  if (!E) E |= nrrdResampleTypeOutSet(rsmc, nrrdTypeDefault);
+  if (!E) E |= nrrdResampleRenormalizeSet(rsmc, AIR_TRUE);
+  if (!E) E |= nrrdResampleClampSet(rsmc, AIR_TRUE);
+  if (E) {
+    biffMovef(TEN, NRRD, "%s: trouble setting up resampling", me);
+    airMopError(mop); return 1;
   }
-  if (bwY) {
-    rinfo->kernel[1] = nrrdKernelGaussian;
-    rinfo->parm[1][0] = bwY;
-    rinfo->parm[1][1] = 3.0; /* how many stnd devs do we cut-off at */
-  } else {
-    rinfo->kernel[1] = NULL;
-  }
-  rinfo->kernel[2] = NULL;
-  ELL_3V_SET(rinfo->samples, sx, sy, sz);
-  ELL_3V_SET(rinfo->min, 0, 0, 0);
-  ELL_3V_SET(rinfo->max, sx-1, sy-1, sz-1);
-  rinfo->boundary = nrrdBoundaryBleed;
-  rinfo->type = nrrdTypeDefault;
-  rinfo->renormalize = AIR_TRUE;
-  rinfo->clamp = AIR_TRUE;
   if (verb) {
     fprintf(stderr, "%s:\n            ", me); fflush(stderr);
   }
@@ -179,17 +358,14 @@ _tenEpiRegBlur(Nrrd **nblur, Nrrd **ndwi, unsigned int dwiLen,
     if (verb) {
       fprintf(stderr, "%2u ", (unsigned int)ni); fflush(stderr);
     }
-    savemin[0] = ndwi[ni]->axis[0].min; savemax[0] = ndwi[ni]->axis[0].max;
-    savemin[1] = ndwi[ni]->axis[1].min; savemax[1] = ndwi[ni]->axis[1].max;
-    ndwi[ni]->axis[0].min = 0; ndwi[ni]->axis[0].max = sx-1;
-    ndwi[ni]->axis[1].min = 0; ndwi[ni]->axis[1].max = sy-1;
-    if (nrrdSpatialResample(nblur[ni], ndwi[ni], rinfo)) {
+    /* ndwi[0] was already set: setting it again before the context has
+       executed would clear the per-axis settings */
+    if ((ni && nrrdResampleInputSet(rsmc, ndwi[ni]))
+        || nrrdResampleExecute(rsmc, nblur[ni])) {
       biffMovef(TEN, NRRD, "%s: trouble blurring ndwi[%u]",
                 me, (unsigned int)ni);
       airMopError(mop); return 1;
     }
-    ndwi[ni]->axis[0].min = savemin[0]; ndwi[ni]->axis[0].max = savemax[0];
-    ndwi[ni]->axis[1].min = savemin[1]; ndwi[ni]->axis[1].max = savemax[1];
   }
   if (verb) {
     fprintf(stderr, "done\n");
@@ -198,44 +374,128 @@ _tenEpiRegBlur(Nrrd **nblur, Nrrd **ndwi, unsigned int dwiLen,
   return 0;
 }
 
-int
-_tenEpiRegThresholdFind(double *DWthrP, Nrrd **nin, int ninLen,
-                        int save, double expo) {
+typedef struct {
+  Nrrd **nin, **nhist;
+  double *minmax;
+  unsigned int bins;
+} _tenEpiRegHistParm;
+
+static int
+_tenEpiRegRangeOne(char *err, void *_parm, unsigned int ni) {
+  static const char me[]="_tenEpiRegRangeOne";
+  _tenEpiRegHistParm *parm;
+  NrrdRange *range;
+
+  parm = AIR_CAST(_tenEpiRegHistParm *, _parm);
+  /* nrrdRangeNewSet doesn't use biff */
+  range = nrrdRangeNewSet(parm->nin[ni], nrrdBlind8BitRangeFalse);
+  if (!range) {
+    sprintf(err, "%s: couldn't allocate range of DWI %u", me, ni);
+    return 1;
+  }
+  parm->minmax[0 + 2*ni] = range->min;
+  parm->minmax[1 + 2*ni] = range->max;
+  range = nrrdRangeNix(range);
+  return 0;
+}
+
+/*
+** the histogram of DWI ni, into nhist[ni], which has been allocated
+** (as float) with the bins, and min and max set; this does the same
+** counting as nrrdHisto, but without biff
+*/
+static int
+_tenEpiRegHistOne(char *err, void *_parm, unsigned int ni) {
+  _tenEpiRegHistParm *parm;
+  double min, max, eps, val, (*lup)(const void *, size_t);
+  const void *data;
+  float *hist;
+  size_t II, NN;
+
+  AIR_UNUSED(err);
+  parm = AIR_CAST(_tenEpiRegHistParm *, _parm);
+  hist = AIR_CAST(float *, parm->nhist[ni]->data);
+  min = parm->nhist[ni]->axis[0].min;
+  max = parm->nhist[ni]->axis[0].max;
+  eps = (min == max ? 1.0 : 0.0);
+  data = parm->nin[ni]->data;
+  lup = nrrdDLookup[parm->nin[ni]->type];
+  NN = nrrdElementNumber(parm->nin[ni]);
+  for (II=0; II<NN; II++) {
+    val = lup(data, II);
+    if (AIR_EXISTS(val) && AIR_IN_CL(min, val, max)) {
+      hist[airIndex(min, val, max+eps, parm->bins)] += 1;
+    }
+  }
+  return 0;
+}
+
+static int
+_tenEpiRegThresholdFindThreads(double *DWthrP, Nrrd **nin, int ninLen,
+                               int save, double expo,
+                               unsigned int threadNum) {
   static const char me[]="_tenEpiRegThresholdFind";
-  Nrrd *nhist, *ntmp;
+  _tenEpiRegHistParm parm;
+  Nrrd *nhist;
   airArray *mop;
-  int ni, bins, E;
+  int ni, E;
   double min=0, max=0;
-  NrrdRange *range;
 
   mop = airMopNew();
   airMopAdd(mop, nhist=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, ntmp=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+  parm.nin = nin;
+  parm.nhist = AIR_CALLOC(ninLen, Nrrd *);
+  parm.minmax = AIR_CALLOC(2*ninLen, double);
+  if (!( parm.nhist && parm.minmax )) {
+    biffAddf(TEN, "%s: couldn't allocate per-DWI buffers", me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, parm.nhist, airFree, airMopAlways);
+  airMopAdd(mop, parm.minmax, airFree, airMopAlways);
+  for (ni=0; ni<ninLen; ni++) {
+    airMopAdd(mop, parm.nhist[ni]=nrrdNew(), (airMopper)nrrdNuke,
+              airMopAlways);
+  }
 
+  if (_tenEpiRegRun(me, _tenEpiRegRangeOne, &parm, ninLen,
+                    threadNum, AIR_FALSE)) {
+    biffAddf(TEN, "%s: problem finding DWI ranges", me);
+    airMopError(mop); return 1;
+  }
   for (ni=0; ni<ninLen; ni++) {
-    range = nrrdRangeNewSet(nin[ni], nrrdBlind8BitRangeFalse);
     if (!ni) {
-      min = range->min;
-      max = range->max;
+      min = parm.minmax[0];
+      max = parm.minmax[1];
     } else {
-      min = AIR_MIN(min, range->min);
-      max = AIR_MAX(max, range->max);
+      min = AIR_MIN(min, parm.minmax[0 + 2*ni]);
+      max = AIR_MAX(max, parm.minmax[1 + 2*ni]);
     }
-    range = nrrdRangeNix(range);
   }
-  bins = AIR_MIN(1024, (int)(max - min + 1));
-  ntmp->axis[0].min = min;
-  ntmp->axis[0].max = max;
+  parm.bins = AIR_CAST(unsigned int, AIR_MIN(1024, (int)(max - min + 1)));
   for (ni=0; ni<ninLen; ni++) {
-    if (nrrdHisto(ntmp, nin[ni], NULL, NULL, bins, nrrdTypeFloat)) {
-      biffMovef(TEN, NRRD,
-                "%s: problem forming histogram of DWI %d", me, ni);
+    if (nrrdMaybeAlloc_va(parm.nhist[ni], nrrdTypeFloat, 1,
+                          AIR_CAST(size_t, parm.bins))) {
+      biffMovef(TEN, NRRD, "%s: couldn't allocate histogram %d", me, ni);
       airMopError(mop); return 1;
     }
+    parm.nhist[ni]->axis[0].min = min;
+    parm.nhist[ni]->axis[0].max = max;
+    parm.nhist[ni]->axis[0].center = nrrdCenterCell;
+    if (!nrrdStateKindNoop) {
+      parm.nhist[ni]->axis[0].kind = nrrdKindDomain;
+    }
+  }
+  if (_tenEpiRegRun(me, _tenEpiRegHistOne, &parm, ninLen,
+                    threadNum, AIR_FALSE)) {
+    biffAddf(TEN, "%s: problem forming DWI histograms", me);
+    airMopError(mop); return 1;
+  }
+  /* summed in DWI order, regardless of threadNum */
+  for (ni=0; ni<ninLen; ni++) {
     if (!ni) {
-      E = nrrdCopy(nhist, ntmp);
+      E = nrrdCopy(nhist, parm.nhist[ni]);
     } else {
-      E = nrrdArithBinaryOp(nhist, nrrdBinaryOpAdd, nhist, ntmp);
+      E = nrrdArithBinaryOp(nhist, nrrdBinaryOpAdd, nhist, parm.nhist[ni]);
     }
     if (E) {
       biffMovef(TEN, NRRD,
@@ -262,148 +522,418 @@ _tenEpiRegThresholdFind(double *DWthrP, Nrrd **nin, int ninLen,
   return 0;
 }
 
+int
+_tenEpiRegThresholdFind(double *DWthrP, Nrrd **nin, int ninLen,
+                        int save, double expo) {
+
+  return _tenEpiRegThresholdFindThreads(DWthrP, nin, ninLen,
+                                        save, expo, 1);
+}
+
+typedef struct {
+  Nrrd **nthresh, **nblur;
+  double DWthr;
+} _tenEpiRegThreshParm;
+
+static int
+_tenEpiRegThresholdOne(char *err, void *_parm, unsigned int ni) {
+  _tenEpiRegThreshParm *parm;
+  size_t I, NN;
+  float val, (*lup)(const void *, size_t);
+  const void *blur;
+  unsigned char *thr;
+
+  AIR_UNUSED(err);
+  parm = AIR_CAST(_tenEpiRegThreshParm *, _parm);
+  thr = (unsigned char *)(parm->nthresh[ni]->data);
+  blur = parm->nblur[ni]->data;
+  lup = nrrdFLookup[parm->nblur[ni]->type];
+  NN = nrrdElementNumber(parm->nblur[ni]);
+  for (I=0; I<NN; I++) {
+    val = lup(blur, I);
+    val -= AIR_CAST(float, parm->DWthr);
+    thr[I] = (val >= 0 ? 1 : 0);
+  }
+  return 0;
+}
+
 int
 _tenEpiRegThreshold(Nrrd **nthresh, Nrrd **nblur, unsigned int ninLen,
-                    double DWthr, int verb, int progress, double expo) {
+                    double DWthr, unsigned int threadNum,
+                    int verb, int progress, double expo) {
   static const char me[]="_tenEpiRegThreshold";
-  airArray *mop;
-  size_t I, sx, sy, sz, ni;
-  float val;
-  unsigned char *thr;
+  _tenEpiRegThreshParm parm;
+  unsigned int ni;
 
   if (!( AIR_EXISTS(DWthr) )) {
-    if (_tenEpiRegThresholdFind(&DWthr, nblur, ninLen, progress, expo)) {
+    if (_tenEpiRegThresholdFindThreads(&DWthr, nblur, ninLen,
+                                       progress, expo, threadNum)) {
       biffAddf(TEN, "%s: trouble with automatic threshold determination", me);
       return 1;
     }
     fprintf(stderr, "%s: using %g for DWI threshold\n", me, DWthr);
   }
 
-  mop = airMopNew();
-  if (verb) {
-    fprintf(stderr, "%s:\n            ", me); fflush(stderr);
-  }
-  sx = nblur[0]->axis[0].size;
-  sy = nblur[0]->axis[1].size;
-  sz = nblur[0]->axis[2].size;
   for (ni=0; ni<ninLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2u ", (unsigned int)ni); fflush(stderr);
-    }
     if (nrrdMaybeAlloc_va(nthresh[ni], nrrdTypeUChar, 3,
-                          sx, sy, sz)) {
-      biffMovef(TEN, NRRD, "%s: trouble allocating threshold %u",
-                me, (unsigned int)ni);
-      airMopError(mop); return 1;
-    }
-    thr = (unsigned char *)(nthresh[ni]->data);
-    for (I=0; I<sx*sy*sz; I++) {
-      val = nrrdFLookup[nblur[ni]->type](nblur[ni]->data, I);
-      val -= AIR_CAST(float, DWthr);
-      thr[I] = (val >= 0 ? 1 : 0);
+                          nblur[ni]->axis[0].size,
+                          nblur[ni]->axis[1].size,
+                          nblur[ni]->axis[2].size)) {
+      biffMovef(TEN, NRRD, "%s: trouble allocating threshold %u", me, ni);
+      return 1;
     }
   }
-  if (verb) {
-    fprintf(stderr, "done\n");
+  parm.nthresh = nthresh;
+  parm.nblur = nblur;
+  parm.DWthr = DWthr;
+  if (_tenEpiRegRun(me, _tenEpiRegThresholdOne, &parm, ninLen,
+                    threadNum, verb)) {
+    biffAddf(TEN, "%s: trouble thresholding", me);
+    return 1;
   }
-
-  airMopOkay(mop);
   return 0;
 }
 
 /*
-** _tenEpiRegBB: find the biggest bright CC
+** the neighbors that precede a sample in raster order, as (dx, dy, dz),
+** and the connectivity at which they count, in the order in which
+** nrrdCCFind (for 3-D, and so also for 2-D) visits them
 */
-int
-_tenEpiRegBB(Nrrd *nval, Nrrd *nsize) {
-  unsigned char *val;
-  int *size, big;
-  unsigned int ci;
+static const int
+_tenEpiRegCCNbr[13][4] = {
+  {-1,  0,  0, 1}, { 0, -1,  0, 1}, { 0,  0, -1, 1},
+  {-1, -1,  0, 2}, { 1, -1,  0, 2}, { 0, -1, -1, 2}, {-1,  0, -1, 2},
+  { 1,  0, -1, 2}, { 0,  1, -1, 2},
+  {-1, -1, -1, 3}, { 1, -1, -1, 3}, {-1,  1, -1, 3}, { 1,  1, -1, 3}};
 
-  val = (unsigned char *)(nval->data);
-  size = (int *)(nsize->data);
-  big = 0;
-  for (ci=0; ci<nsize->axis[0].size; ci++) {
-    big = val[ci] ? AIR_MAX(big, size[ci]) : big;
-  }
-  return big;
+/*
+** the index of the kk-th neighbor of sample II at (xi,yi,zi), or
+** II itself when that neighbor is outside the sx-by-sy-by-sz block
+*/
+static size_t
+_tenEpiRegCCNbrIdx(size_t II, size_t xi, size_t yi, size_t zi,
+                   size_t sx, size_t sy, unsigned int kk) {
+  const int *dd;
+
+  dd = _tenEpiRegCCNbr[kk];
+  if ((dd[0] < 0 && !xi) || (dd[0] > 0 && xi == sx-1)
+      || (dd[1] < 0 && !yi) || (dd[1] > 0 && yi == sy-1)
+      || (dd[2] < 0 && !zi)) {
+    return II;
+  }
+  /* neighbors all precede II, but the arithmetic is modular anyway */
+  return (II + (dd[0] > 0 ? 1 : 0) - (dd[0] < 0 ? 1 : 0)
+          + (dd[1] > 0 ? sx : 0) - (dd[1] < 0 ? sx : 0)
+          - (dd[2] < 0 ? sx*sy : 0));
 }
 
-int
-_tenEpiRegCC(Nrrd **nthr, int ninLen, int conny, int verb) {
-  static const char me[]="_tenEpiRegCC";
-  Nrrd *nslc, *ncc, *nval, *nsize;
-  airArray *mop;
-  int ni, z, sz, big;
+/*
+** _tenEpiRegCCMerge
+**
+** biff-free (for the threads of _tenEpiRegCC) version of nrrdCCFind,
+** nrrdCCSize, nrrdCCMerge (with maxNeighbor 0) and nrrdCCRevalue, done
+** in place on the 0/1 values in the sx-by-sy-by-sz block "thr", with
+** the same result.  With sz == 1 this is the same as on a 2-D slice.
+** "id" is a buffer for sx*sy*sz CC ids.  *bigP is set to the size of
+** the biggest bright CC; thr is left as is if that's 0.  Otherwise,
+** with valDir > 0, dark CCs no bigger than *bigP/2 are merged into
+** their biggest (bright) neighbor, and with valDir < 0, bright CCs
+** smaller than *bigP are merged into their biggest (dark) neighbor.
+** Like nrrdCCMerge, this finds the biggest neighbor by sorting the CCs
+** on size, and a CC that something merged into isn't merged itself.
+** Returns non-zero only if it couldn't allocate its buffers.
+*/
+static int
+_tenEpiRegCCMerge(unsigned int *bigP, unsigned char *thr,
+                  unsigned int *id, size_t sx, size_t sy, size_t sz,
+                  unsigned int conny, int valDir) {
+  airArray *mop, *eqvArr;
+  unsigned int kk, cur, num, ii, _ii, big, maxSize, *buff, *size, *sizeId,
+    *rank, *top, *map, *hit;
+  unsigned char *val;
+  size_t II, JJ, xi, yi, zi;
+  int match;
 
   mop = airMopNew();
-  airMopAdd(mop, nslc=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nval=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, ncc=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nsize=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  sz = nthr[0]->axis[2].size;
-  if (verb) {
-    fprintf(stderr, "%s:\n            ", me); fflush(stderr);
+  eqvArr = airArrayNew(NULL, NULL, 2*sizeof(unsigned int), 10000);
+  if (!eqvArr) {
+    airMopError(mop); return 1;
   }
-  for (ni=0; ni<ninLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2d ", ni); fflush(stderr);
-    }
-    /* for each volume, we find the biggest bright 3-D CC, and merge
-       down (to dark) all smaller bright pieces.  Then, within each
-       slice, we do 2-D CCs, find the biggest bright CC (size == big),
-       and merge up (to bright) all small dark pieces, where
-       (currently) small is big/2 */
-    big = -1;
-    if (nrrdCCFind(ncc, &nval, nthr[ni], nrrdTypeDefault, conny)
-        || nrrdCCSize(nsize, ncc)
-        || !(big = _tenEpiRegBB(nval, nsize))
-        || nrrdCCMerge(ncc, ncc, nval, -1, big-1, 0, conny)
-        || nrrdCCRevalue(nthr[ni], ncc, nval)) {
-      if (big) {
-        biffMovef(TEN, NRRD,
-                  "%s: trouble with 3-D processing nthr[%d]", me, ni);
-        return 1;
-      } else {
-        biffAddf(TEN, "%s: got size 0 for biggest bright CC of nthr[%d]",
-                 me, ni);
-        return 1;
+  airMopAdd(mop, eqvArr, (airMopper)airArrayNuke, airMopAlways);
+  /* first pass: provisional ids, and the equivalences between them */
+  num = 0;
+  cur = 0;
+  II = 0;
+  for (zi=0; zi<sz; zi++) {
+    for (yi=0; yi<sy; yi++) {
+      for (xi=0; xi<sx; xi++) {
+        match = AIR_FALSE;
+        for (kk=0; kk<13 && _tenEpiRegCCNbr[kk][3] <= AIR_CAST(int, conny);
+             kk++) {
+          JJ = _tenEpiRegCCNbrIdx(II, xi, yi, zi, sx, sy, kk);
+          if (JJ == II || thr[JJ] != thr[II]) {
+            continue;
+          }
+          if (match) {
+            if (cur != id[JJ]) {
+              airEqvAdd(eqvArr, id[JJ], cur);
+            }
+          } else {
+            cur = id[JJ];
+            match = AIR_TRUE;
+          }
+        }
+        if (!match) {
+          cur = num++;
+        }
+        id[II++] = cur;
       }
     }
-    for (z=0; z<sz; z++) {
-      big = -1;
-      if ( nrrdSlice(nslc, nthr[ni], 2, z)
-           || nrrdCCFind(ncc, &nval, nslc, nrrdTypeDefault, conny)
-           || nrrdCCSize(nsize, ncc)
-           || !(big = _tenEpiRegBB(nval, nsize))
-           || nrrdCCMerge(ncc, ncc, nval, 1, big/2, 0, conny)
-           || nrrdCCRevalue(nslc, ncc, nval)
-           || nrrdSplice(nthr[ni], nthr[ni], nslc, 2, z) ) {
-        if (big) {
-          biffMovef(TEN, NRRD, "%s: trouble processing slice %d of nthr[%d]",
-                    me, z, ni);
-          return 1;
-        } else {
-          /* biggest bright CC on this slice had size 0
-             <==> there was no bright CC on this slice, move on */
+  }
+  /* settle the ids, and learn the size and value of each CC */
+  buff = AIR_CALLOC(7*AIR_CAST(size_t, num), unsigned int);
+  val = AIR_CALLOC(num, unsigned char);
+  airMopAdd(mop, buff, airFree, airMopAlways);
+  airMopAdd(mop, val, airFree, airMopAlways);
+  if (!( buff && val )) {
+    airMopError(mop); return 1;
+  }
+  map = buff;
+  size = buff + num;
+  sizeId = buff + 2*num;
+  rank = buff + 4*num;
+  top = buff + 5*num;
+  hit = buff + 6*num;
+  num = airEqvMap(eqvArr, map, num);
+  for (II=0; II<sx*sy*sz; II++) {
+    id[II] = map[id[II]];
+    size[id[II]] += 1;
+    val[id[II]] = thr[II];
+  }
+  big = 0;
+  for (ii=0; ii<num; ii++) {
+    big = val[ii] ? AIR_MAX(big, size[ii]) : big;
+  }
+  *bigP = big;
+  if (!big) {
+    airMopOkay(mop);
+    return 0;
+  }
+  maxSize = valDir > 0 ? big/2 : big - 1;
+  /* rank the CCs by size, the same way as nrrdCCMerge */
+  for (ii=0; ii<num; ii++) {
+    sizeId[0 + 2*ii] = size[ii];
+    sizeId[1 + 2*ii] = ii;
+  }
+  qsort(sizeId, num, 2*sizeof(unsigned int), nrrdValCompare[nrrdTypeUInt]);
+  for (_ii=0; _ii<num; _ii++) {
+    rank[sizeId[1 + 2*_ii]] = _ii;
+  }
+  /* top[ii]: highest rank of CC ii or any of its neighbors */
+  for (ii=0; ii<num; ii++) {
+    top[ii] = rank[ii];
+  }
+  II = 0;
+  for (zi=0; zi<sz; zi++) {
+    for (yi=0; yi<sy; yi++) {
+      for (xi=0; xi<sx; xi++) {
+        for (kk=0; kk<13 && _tenEpiRegCCNbr[kk][3] <= AIR_CAST(int, conny);
+             kk++) {
+          JJ = _tenEpiRegCCNbrIdx(II, xi, yi, zi, sx, sy, kk);
+          if (id[JJ] != id[II]) {
+            top[id[II]] = AIR_MAX(top[id[II]], rank[id[JJ]]);
+            top[id[JJ]] = AIR_MAX(top[id[JJ]], rank[id[II]]);
+          }
         }
+        II++;
       }
     }
   }
-  if (verb) {
-    fprintf(stderr, "done\n");
+  /* merge, going from the smallest CCs to the largest; map is re-used
+     for where each CC goes */
+  for (ii=0; ii<num; ii++) {
+    map[ii] = ii;
+  }
+  for (_ii=0; _ii<num; _ii++) {
+    ii = sizeId[1 + 2*_ii];
+    if (hit[ii]
+        || (maxSize && size[ii] > maxSize)
+        || top[ii] == _ii) {
+      /* already merged into, too big, or no bigger neighbor */
+      continue;
+    }
+    cur = sizeId[1 + 2*top[ii]];
+    if ((AIR_CAST(int, val[cur]) - AIR_CAST(int, val[ii]))*valDir < 0) {
+      continue;
+    }
+    map[ii] = cur;
+    hit[cur] = AIR_TRUE;
+  }
+  for (II=0; II<sx*sy*sz; II++) {
+    thr[II] = val[map[id[II]]];
   }
-
   airMopOkay(mop);
   return 0;
 }
 
+typedef struct {
+  Nrrd **nthr;
+  unsigned int conny;
+} _tenEpiRegCCParm;
+
+static int
+_tenEpiRegCCOne(char *err, void *_parm, unsigned int ni) {
+  static const char me[]="_tenEpiRegCCOne";
+  _tenEpiRegCCParm *parm;
+  unsigned char *thr;
+  unsigned int *id, big;
+  size_t sx, sy, sz, zi;
+
+  parm = AIR_CAST(_tenEpiRegCCParm *, _parm);
+  sx = parm->nthr[ni]->axis[0].size;
+  sy = parm->nthr[ni]->axis[1].size;
+  sz = parm->nthr[ni]->axis[2].size;
+  thr = AIR_CAST(unsigned char *, parm->nthr[ni]->data);
+  id = AIR_CALLOC(sx*sy*sz, unsigned int);
+  if (!id) {
+    sprintf(err, "%s: couldn't allocate CC ids for nthr[%u]", me, ni);
+    return 1;
+  }
+  /* for each volume, we find the biggest bright 3-D CC, and merge
+     down (to dark) all smaller bright pieces.  Then, within each
+     slice, we do 2-D CCs, find the biggest bright CC (size == big),
+     and merge up (to bright) all small dark pieces, where
+     (currently) small is big/2 */
+  if (_tenEpiRegCCMerge(&big, thr, id, sx, sy, sz, parm->conny, -1)) {
+    sprintf(err, "%s: couldn't allocate 3-D CC buffers for nthr[%u]",
+            me, ni);
+    free(id); return 1;
+  }
+  if (!big) {
+    sprintf(err, "%s: got size 0 for biggest bright CC of nthr[%u]",
+            me, ni);
+    free(id); return 1;
+  }
+  for (zi=0; zi<sz; zi++) {
+    /* with big == 0 there was no bright CC on this slice; it is left
+       as is */
+    if (_tenEpiRegCCMerge(&big, thr + sx*sy*zi, id, sx, sy, 1,
+                          parm->conny, 1)) {
+      sprintf(err, "%s: couldn't allocate 2-D CC buffers for slice %u "
+              "of nthr[%u]", me, AIR_CAST(unsigned int, zi), ni);
+      free(id); return 1;
+    }
+  }
+  free(id);
+  return 0;
+}
+
+int
+_tenEpiRegCC(Nrrd **nthr, int ninLen, unsigned int conny,
+             unsigned int threadNum, int verb) {
+  static const char me[]="_tenEpiRegCC";
+  _tenEpiRegCCParm parm;
+
+  parm.nthr = nthr;
+  parm.conny = conny;
+  if (_tenEpiRegRun(me, _tenEpiRegCCOne, &parm, ninLen, threadNum, verb)) {
+    biffAddf(TEN, "%s: trouble with connected components", me);
+    return 1;
+  }
+  return 0;
+}
+
 #define MEAN_X 0
 #define MEAN_Y 1
 #define M_02   2
 #define M_11   3
 #define M_20   4
 
+typedef struct {
+  Nrrd **nmom, **nthresh;
+  size_t sx, sy;          /* slice size of the original DWIs */
+} _tenEpiRegMomParm;
+
+static int
+_tenEpiRegMomentsOne(char *err, void *_parm, unsigned int ni) {
+  static const char me[]="_tenEpiRegMomentsOne";
+  _tenEpiRegMomParm *parm;
+  size_t sx, sy, sz, xi, yi, zi;
+  double N, mx, my, cx, cy, x, y, M02, M11, M20, *mom, scx, scy;
+  float val;
+  unsigned char *thr;
+
+  parm = AIR_CAST(_tenEpiRegMomParm *, _parm);
+  sx = parm->nthresh[ni]->axis[0].size;
+  sy = parm->nthresh[ni]->axis[1].size;
+  sz = parm->nthresh[ni]->axis[2].size;
+  /* with a downsampled nthresh, cell-centered sample xi is at
+     (xi+0.5)*scx - 0.5 in the original DWI; with scx == 1 this is
+     exactly xi */
+  scx = AIR_CAST(double, parm->sx)/sx;
+  scy = AIR_CAST(double, parm->sy)/sy;
+  cx = parm->sx/2.0;
+  cy = parm->sy/2.0;
+  thr = (unsigned char *)(parm->nthresh[ni]->data);
+  mom = (double *)(parm->nmom[ni]->data);
+  for (zi=0; zi<sz; zi++) {
+    /* ------ find mx, my */
+    N = 0;
+    mx = my = 0.0;
+    for (yi=0; yi<sy; yi++) {
+      y = (yi + 0.5)*scy - 0.5;
+      for (xi=0; xi<sx; xi++) {
+        x = (xi + 0.5)*scx - 0.5;
+        val = thr[xi + sx*yi];
+        N += val;
+        mx += x*val;
+        my += y*val;
+      }
+    }
+    if (N == sx*sy) {
+      sprintf(err, "%s: saw only non-zero pixels in nthresh[%u]; "
+              "DWI hreshold too low?", me, ni);
+      return 1;
+    }
+    if (N) {
+      /* there were non-zero pixels */
+      mx /= N;
+      my /= N;
+      /* ------ find M02, M11, M20 */
+      M02 = M11 = M20 = 0.0;
+      for (yi=0; yi<sy; yi++) {
+        y = (yi + 0.5)*scy - 0.5 - cy;
+        for (xi=0; xi<sx; xi++) {
+          val = thr[xi + sx*yi];
+          x = (xi + 0.5)*scx - 0.5 - cx;
+          M02 += y*y*val;
+          M11 += x*y*val;
+          M20 += x*x*val;
+        }
+      }
+      M02 /= N;
+      M11 /= N;
+      M20 /= N;
+      /* ------ set output */
+      mom[MEAN_X] = mx;
+      mom[MEAN_Y] = my;
+      mom[M_02] = M02;
+      mom[M_11] = M11;
+      mom[M_20] = M20;
+    } else {
+      /* there were no non-zero pixels */
+      mom[MEAN_X] = 0;
+      mom[MEAN_Y] = 0;
+      mom[M_02] = 0;
+      mom[M_11] = 0;
+      mom[M_20] = 0;
+    }
+    thr += sx*sy;
+    mom += 5;
+  }
+  return 0;
+}
+
 /*
 ** _tenEpiRegMoments()
 **
@@ -412,95 +942,34 @@ _tenEpiRegCC(Nrrd **nthr, int ninLen, int conny, int verb) {
 **
 **       0       1       2       3       4
 **   mean(x)  mean(y)  M_02    M_11    M_20
+**
+** The moments are always in the sample coordinates of the original
+** (sx by sy) DWI slices, even if nthresh has been downsampled.
 */
 int
 _tenEpiRegMoments(Nrrd **nmom, Nrrd **nthresh, unsigned int ninLen,
-                  int verb) {
+                  size_t sx, size_t sy, unsigned int threadNum, int verb) {
   static const char me[]="_tenEpiRegMoments";
-  size_t sx, sy, sz, xi, yi, zi, ni;
-  double N, mx, my, cx, cy, x, y, M02, M11, M20, *mom;
-  float val;
-  unsigned char *thr;
+  _tenEpiRegMomParm parm;
+  unsigned int ni;
 
-  sx = nthresh[0]->axis[0].size;
-  sy = nthresh[0]->axis[1].size;
-  sz = nthresh[0]->axis[2].size;
-  if (verb) {
-    fprintf(stderr, "%s:\n            ", me); fflush(stderr);
-  }
   for (ni=0; ni<ninLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2u ", (unsigned int)ni); fflush(stderr);
-    }
     if (nrrdMaybeAlloc_va(nmom[ni], nrrdTypeDouble, 2,
-                          AIR_CAST(size_t, 5), sz)) {
-      biffMovef(TEN, NRRD,
-                "%s: couldn't allocate nmom[%u]", me, (unsigned int)ni);
+                          AIR_CAST(size_t, 5), nthresh[ni]->axis[2].size)) {
+      biffMovef(TEN, NRRD, "%s: couldn't allocate nmom[%u]", me, ni);
       return 1;
     }
     nrrdAxisInfoSet_va(nmom[ni], nrrdAxisInfoLabel, "mx,my,h,s,t", "z");
-    thr = (unsigned char *)(nthresh[ni]->data);
-    mom = (double *)(nmom[ni]->data);
-    for (zi=0; zi<sz; zi++) {
-      /* ------ find mx, my */
-      N = 0;
-      mx = my = 0.0;
-      for (yi=0; yi<sy; yi++) {
-        for (xi=0; xi<sx; xi++) {
-          val = thr[xi + sx*yi];
-          N += val;
-          mx += xi*val;
-          my += yi*val;
-        }
-      }
-      if (N == sx*sy) {
-        biffAddf(TEN, "%s: saw only non-zero pixels in nthresh[%u]; "
-                "DWI hreshold too low?", me, (unsigned int)ni);
-        return 1;
-      }
-      if (N) {
-        /* there were non-zero pixels */
-        mx /= N;
-        my /= N;
-        cx = sx/2.0;
-        cy = sy/2.0;
-        /* ------ find M02, M11, M20 */
-        M02 = M11 = M20 = 0.0;
-        for (yi=0; yi<sy; yi++) {
-          for (xi=0; xi<sx; xi++) {
-            val = thr[xi + sx*yi];
-            x = xi - cx;
-            y = yi - cy;
-            M02 += y*y*val;
-            M11 += x*y*val;
-            M20 += x*x*val;
-          }
-        }
-        M02 /= N;
-        M11 /= N;
-        M20 /= N;
-        /* ------ set output */
-        mom[MEAN_X] = mx;
-        mom[MEAN_Y] = my;
-        mom[M_02] = M02;
-        mom[M_11] = M11;
-        mom[M_20] = M20;
-      } else {
-        /* there were no non-zero pixels */
-        mom[MEAN_X] = 0;
-        mom[MEAN_Y] = 0;
-        mom[M_02] = 0;
-        mom[M_11] = 0;
-        mom[M_20] = 0;
-      }
-      thr += sx*sy;
-      mom += 5;
-    }
   }
-  if (verb) {
-    fprintf(stderr, "done\n");
+  parm.nmom = nmom;
+  parm.nthresh = nthresh;
+  parm.sx = sx;
+  parm.sy = sy;
+  if (_tenEpiRegRun(me, _tenEpiRegMomentsOne, &parm, ninLen,
+                    threadNum, verb)) {
+    biffAddf(TEN, "%s: trouble finding moments", me);
+    return 1;
   }
-
   return 0;
 }
 
@@ -747,22 +1216,89 @@ _tenEpiRegEstimHST(Nrrd *nhst, Nrrd *npxfr, int ninLen, Nrrd *ngrad) {
   return 0;
 }
 
+typedef struct {
+  Nrrd **ncc;
+  unsigned int ninLen;
+  float *mess;
+} _tenEpiRegMessParm;
+
+/*
+** finds the "messiness" of one slice; this gives the same result as
+** joining the CCs along a new axis 0, projecting with nrrdMeasureSD
+** and nrrdMeasureL2 along it, and summing (with nrrdProject) those
+** over X and then Y, but without the join.
+*/
+static int
+_tenEpiRegMessOne(char *err, void *_parm, unsigned int zi) {
+  static const char me[]="_tenEpiRegMessOne";
+  _tenEpiRegMessParm *parm;
+  unsigned char *line;
+  float *rowSD, *rowL2, *colSD, *colL2, sd, l2;
+  size_t sx, sy, xi, yi, off;
+  unsigned int ni;
+  airArray *mop;
+
+  parm = AIR_CAST(_tenEpiRegMessParm *, _parm);
+  sx = parm->ncc[0]->axis[0].size;
+  sy = parm->ncc[0]->axis[1].size;
+  mop = airMopNew();
+  line = AIR_CALLOC(parm->ninLen, unsigned char);
+  rowSD = AIR_CALLOC(2*sx, float);
+  colSD = AIR_CALLOC(2*sy, float);
+  airMopAdd(mop, line, airFree, airMopAlways);
+  airMopAdd(mop, rowSD, airFree, airMopAlways);
+  airMopAdd(mop, colSD, airFree, airMopAlways);
+  if (!( line && rowSD && colSD )) {
+    sprintf(err, "%s: couldn't allocate buffers", me);
+    airMopError(mop); return 1;
+  }
+  rowL2 = rowSD + sx;
+  colL2 = colSD + sy;
+  for (yi=0; yi<sy; yi++) {
+    for (xi=0; xi<sx; xi++) {
+      off = xi + sx*(yi + sy*zi);
+      for (ni=0; ni<parm->ninLen; ni++) {
+        line[ni] = AIR_CAST(unsigned char *, parm->ncc[ni]->data)[off];
+      }
+      nrrdMeasureLine[nrrdMeasureSD](rowSD + xi, nrrdTypeFloat,
+                                     line, nrrdTypeUChar, parm->ninLen,
+                                     AIR_NAN, AIR_NAN);
+      nrrdMeasureLine[nrrdMeasureL2](rowL2 + xi, nrrdTypeFloat,
+                                     line, nrrdTypeUChar, parm->ninLen,
+                                     AIR_NAN, AIR_NAN);
+    }
+    nrrdMeasureLine[nrrdMeasureSum](colSD + yi, nrrdTypeFloat,
+                                    rowSD, nrrdTypeFloat, sx,
+                                    AIR_NAN, AIR_NAN);
+    nrrdMeasureLine[nrrdMeasureSum](colL2 + yi, nrrdTypeFloat,
+                                    rowL2, nrrdTypeFloat, sx,
+                                    AIR_NAN, AIR_NAN);
+  }
+  nrrdMeasureLine[nrrdMeasureSum](&sd, nrrdTypeFloat,
+                                  colSD, nrrdTypeFloat, sy,
+                                  AIR_NAN, AIR_NAN);
+  nrrdMeasureLine[nrrdMeasureSum](&l2, nrrdTypeFloat,
+                                  colL2, nrrdTypeFloat, sy,
+                                  AIR_NAN, AIR_NAN);
+  parm->mess[zi] = AIR_CAST(float, AIR_CAST(double, sd)/l2);
+  airMopOkay(mop);
+  return 0;
+}
+
 int
 _tenEpiRegFitHST(Nrrd *nhst, Nrrd **_ncc, int ninLen,
-                 double goodFrac, int prog, int verb) {
+                 double goodFrac, unsigned int threadNum,
+                 int prog, int verb) {
   static const char me[]="_tenEpiRegFitHST";
+  _tenEpiRegMessParm parm;
   airArray *mop;
-  Nrrd *ncc, *ntA, *ntB, *nsd, *nl2;
+  Nrrd *ntA;
   unsigned int cc, sz, zi, sh, hi;
   float *mess, *two, tmp;
   double *hst, x, y, xx, xy, mm, bb;
 
   mop = airMopNew();
-  airMopAdd(mop, ncc=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
   airMopAdd(mop, ntA=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, ntB=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nsd=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nl2=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
   /* do SD and L2 projections of the CCs along the DWI axis,
      integrate these over the X and Y axes of the slices,
      and define per-slice "messiness" as the quotient of the
@@ -771,15 +1307,17 @@ _tenEpiRegFitHST(Nrrd *nhst, Nrrd **_ncc, int ninLen,
     fprintf(stderr, "%s: measuring segmentation uncertainty ... ", me);
     fflush(stderr);
   }
-  if (nrrdJoin(ncc, (const Nrrd*const*)_ncc, ninLen, 0, AIR_TRUE)
-      || nrrdProject(ntA, ncc, 0, nrrdMeasureSD, nrrdTypeFloat)
-      || nrrdProject(ntB, ntA, 0, nrrdMeasureSum, nrrdTypeFloat)
-      || nrrdProject(nsd, ntB, 0, nrrdMeasureSum, nrrdTypeFloat)
-      || nrrdProject(ntA, ncc, 0, nrrdMeasureL2, nrrdTypeFloat)
-      || nrrdProject(ntB, ntA, 0, nrrdMeasureSum, nrrdTypeFloat)
-      || nrrdProject(nl2, ntB, 0, nrrdMeasureSum, nrrdTypeFloat)
-      || nrrdArithBinaryOp(ntA, nrrdBinaryOpDivide, nsd, nl2)) {
-    biffMovef(TEN, NRRD, "%s: trouble doing CC projections", me);
+  sz = _ncc[0]->axis[2].size;
+  if (nrrdMaybeAlloc_va(ntA, nrrdTypeFloat, 1, AIR_CAST(size_t, sz))) {
+    biffMovef(TEN, NRRD, "%s: couldn't allocate messiness", me);
+    airMopError(mop); return 1;
+  }
+  parm.ncc = _ncc;
+  parm.ninLen = ninLen;
+  parm.mess = AIR_CAST(float *, ntA->data);
+  if (_tenEpiRegRun(me, _tenEpiRegMessOne, &parm, sz,
+                    threadNum, AIR_FALSE)) {
+    biffAddf(TEN, "%s: trouble doing CC projections", me);
     airMopError(mop); return 1;
   }
   if (verb) {
@@ -794,7 +1332,6 @@ _tenEpiRegFitHST(Nrrd *nhst, Nrrd **_ncc, int ninLen,
   mess = AIR_CAST(float*, ntA->data);
 
   /* allocate an array of 2 floats per slice */
-  sz = ntA->axis[0].size;
   two = AIR_CAST(float*, calloc(2*sz, sizeof(float)));
   if (!two) {
     biffAddf(TEN, "%s: couldn't allocate tmp buffer", me);
@@ -906,35 +1443,33 @@ _tenEpiRegGetHST(double *hhP, double *ssP, double *ttP,
 /*
 ** _tenEpiRegSliceWarp
 **
-** Apply [hh,ss,tt] transform to nin, putting results in nout, but with
-** some trickiness:
-** - nwght and nidx are already allocated to the the weights (type float)
-**   and indices for resampling nin with "kern" and "kparm"
-** - nout is already allocated to the correct size and type
-** - nin is type float, but output must be type nout->type
-** - nin is been transposed to have the resampled axis fastest in memory,
-**   but nout output will not be transposed
+** Apply [hh,ss,tt] transform to the sx-by-sy slice "in", putting results
+** in "out", but with some trickiness:
+** - wght and idx are buffers for the 2*support*sy weights and indices
+**   for resampling "in" with "kern" and "kparm"
+** - in is type float, but output must be type outType
+** - in has been transposed to have the resampled axis fastest in memory,
+**   but out output will not be transposed
+** This doesn't use biff (it's called from the threads of _tenEpiRegWarp).
 */
-int
-_tenEpiRegSliceWarp(Nrrd *nout, Nrrd *nin, Nrrd *nwght, Nrrd *nidx,
+static void
+_tenEpiRegSliceWarp(void *out, int outType, const float *in,
+                    size_t sx, size_t sy, float *_wght, int *_idx,
                     const NrrdKernel *kern, double *kparm,
                     double hh, double ss, double tt, double cx, double cy) {
-  float *wght, *in, pp, pf, tmp;
+  float *wght, pp, pf, tmp;
   int *idx;
   unsigned int supp;
-  size_t sx, sy, xi, yi, pb, pi;
+  size_t xi, yi, pb, pi;
   double (*ins)(void *, size_t, double), (*clamp)(double);
 
-  sy = nin->axis[0].size;
-  sx = nin->axis[1].size;
   supp = AIR_CAST(unsigned int, kern->support(kparm));
-  ins = nrrdDInsert[nout->type];
-  clamp = nrrdDClamp[nout->type];
+  ins = nrrdDInsert[outType];
+  clamp = nrrdDClamp[outType];
 
-  in = AIR_CAST(float*, nin->data);
   for (xi=0; xi<sx; xi++) {
-    idx = AIR_CAST(int*, nidx->data);
-    wght = AIR_CAST(float*, nwght->data);
+    idx = _idx;
+    wght = _wght;
     for (yi=0; yi<sy; yi++) {
       pp = AIR_CAST(float, hh*(xi - cx) + ss*(yi - cy) + tt + cy);
       pb = AIR_CAST(size_t, floor(pp));
@@ -946,21 +1481,84 @@ _tenEpiRegSliceWarp(Nrrd *nout, Nrrd *nin, Nrrd *nwght, Nrrd *nidx,
       idx += 2*supp;
       wght += 2*supp;
     }
-    idx = AIR_CAST(int*, nidx->data);
-    wght = AIR_CAST(float*, nwght->data);
+    idx = _idx;
+    wght = _wght;
     kern->evalN_f(wght, wght, 2*supp*sy, kparm);
     for (yi=0; yi<sy; yi++) {
       tmp = 0;
       for (pi=0; pi<2*supp; pi++) {
         tmp += in[idx[pi]]*wght[pi];
       }
-      ins(nout->data, xi + sx*yi, clamp(ss*tmp));
+      ins(out, xi + sx*yi, clamp(ss*tmp));
       idx += 2*supp;
       wght += 2*supp;
     }
     in += sy;
   }
 
+  return;
+}
+
+typedef struct {
+  Nrrd **ndone, *npxfr, *nhst, *ngrad, **nin;
+  int reference;
+  const NrrdKernel *kern;
+  double *kparm;
+} _tenEpiRegWarpParm;
+
+/*
+** warps DWI ni into ndone[ni], which has already been allocated (as a
+** copy of nin[ni])
+*/
+static int
+_tenEpiRegWarpOne(char *err, void *_parm, unsigned int ni) {
+  static const char me[]="_tenEpiRegWarpOne";
+  _tenEpiRegWarpParm *parm;
+  const Nrrd *nin;
+  float *fin, *wght, (*lup)(const void *, size_t);
+  int *idx;
+  char *done;
+  airArray *mop;
+  size_t sx, sy, sz, xi, yi, zi, supp, slcSize;
+  double hh, ss, tt, cx, cy;
+
+  parm = AIR_CAST(_tenEpiRegWarpParm *, _parm);
+  nin = parm->nin[ni];
+  sx = nin->axis[0].size;
+  sy = nin->axis[1].size;
+  sz = nin->axis[2].size;
+  cx = sx/2.0;
+  cy = sy/2.0;
+  supp = AIR_CAST(size_t, parm->kern->support(parm->kparm));
+  mop = airMopNew();
+  fin = AIR_CALLOC(sx*sy, float);
+  wght = AIR_CALLOC(2*supp*sy, float);
+  idx = AIR_CALLOC(2*supp*sy, int);
+  airMopAdd(mop, fin, airFree, airMopAlways);
+  airMopAdd(mop, wght, airFree, airMopAlways);
+  airMopAdd(mop, idx, airFree, airMopAlways);
+  if (!( fin && wght && idx )) {
+    sprintf(err, "%s: trouble allocating buffers for ni=%u", me, ni);
+    airMopError(mop); return 1;
+  }
+  lup = nrrdFLookup[nin->type];
+  done = AIR_CAST(char *, parm->ndone[ni]->data);
+  slcSize = sx*sy*nrrdTypeSize[parm->ndone[ni]->type];
+  for (zi=0; zi<sz; zi++) {
+    /* slice zi, as float, and transposed */
+    for (yi=0; yi<sy; yi++) {
+      for (xi=0; xi<sx; xi++) {
+        fin[yi + sy*xi] = lup(nin->data, xi + sx*(yi + sy*zi));
+      }
+    }
+    _tenEpiRegGetHST(&hh, &ss, &tt, parm->reference,
+                     ni, AIR_CAST(int, zi),
+                     parm->npxfr, parm->nhst, parm->ngrad);
+    _tenEpiRegSliceWarp(done + slcSize*zi, parm->ndone[ni]->type, fin,
+                        sx, sy, wght, idx, parm->kern, parm->kparm,
+                        hh, ss, tt, cx, cy);
+  }
+  airMopOkay(mop);
   return 0;
 }
 
@@ -972,79 +1570,51 @@ int
 _tenEpiRegWarp(Nrrd **ndone, Nrrd *npxfr, Nrrd *nhst, Nrrd *ngrad,
                Nrrd **nin, int ninLen,
                int reference, const NrrdKernel *kern, double *kparm,
-               int verb) {
+               unsigned int threadNum, int verb) {
   static const char me[]="_tenEpiRegWarp";
-  Nrrd *ntmp, *nfin, *nslcA, *nslcB, *nwght, *nidx;
-  airArray *mop;
-  int sx, sy, sz, ni, zi, supp;
-  double hh, ss, tt, cx, cy;
+  _tenEpiRegWarpParm parm;
+  int ni;
 
-  mop = airMopNew();
-  airMopAdd(mop, ntmp=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nfin=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nslcA=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nslcB=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nwght=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  airMopAdd(mop, nidx=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-
-  if (verb) {
-    fprintf(stderr, "%s:\n            ", me); fflush(stderr);
-  }
-  sx = nin[0]->axis[0].size;
-  sy = nin[0]->axis[1].size;
-  sz = nin[0]->axis[2].size;
-  cx = sx/2.0;
-  cy = sy/2.0;
-  supp = (int)kern->support(kparm);
-  if (nrrdMaybeAlloc_va(nwght, nrrdTypeFloat, 2,
-                        AIR_CAST(size_t, 2*supp),
-                        AIR_CAST(size_t, sy))
-      || nrrdMaybeAlloc_va(nidx, nrrdTypeInt, 2,
-                           AIR_CAST(size_t, 2*supp),
-                           AIR_CAST(size_t, sy))) {
-    biffMovef(TEN, NRRD, "%s: trouble allocating buffers", me);
-    airMopError(mop); return 1;
-  }
   for (ni=0; ni<ninLen; ni++) {
-    if (verb) {
-      fprintf(stderr, "%2d ", ni); fflush(stderr);
-    }
-    if (nrrdCopy(ndone[ni], nin[ni])
-        || ((!ni) && nrrdSlice(nslcB, ndone[ni], 2, 0)) /* only when 0==ni */
-        || nrrdAxesSwap(ntmp, nin[ni], 0, 1)
-        || nrrdConvert(nfin, ntmp, nrrdTypeFloat)) {
-      biffMovef(TEN, NRRD, "%s: trouble prepping at ni=%d", me, ni);
-      airMopError(mop); return 1;
-    }
-    for (zi=0; zi<sz; zi++) {
-      if (_tenEpiRegGetHST(&hh, &ss, &tt, reference,
-                           ni, zi, npxfr, nhst, ngrad)
-          || nrrdSlice(nslcA, nfin, 2, zi)
-          || _tenEpiRegSliceWarp(nslcB, nslcA, nwght, nidx, kern, kparm,
-                                 hh, ss, tt, cx, cy)
-          || nrrdSplice(ndone[ni], ndone[ni], nslcB, 2, zi)) {
-        biffMovef(TEN, NRRD, "%s: trouble on slice %d if ni=%d", me, zi, ni);
-        /* because the _tenEpiReg calls above don't use biff */
-        airMopError(mop); return 1;
-      }
+    if (nrrdCopy(ndone[ni], nin[ni])) {
+      biffMovef(TEN, NRRD, "%s: trouble allocating output %d", me, ni);
+      return 1;
     }
   }
-  if (verb) {
-    fprintf(stderr, "done\n");
+  parm.ndone = ndone;
+  parm.npxfr = npxfr;
+  parm.nhst = nhst;
+  parm.ngrad = ngrad;
+  parm.nin = nin;
+  parm.reference = reference;
+  parm.kern = kern;
+  parm.kparm = kparm;
+  if (_tenEpiRegRun(me, _tenEpiRegWarpOne, &parm, ninLen, threadNum, verb)) {
+    biffAddf(TEN, "%s: trouble warping", me);
+    return 1;
   }
-
-  airMopOkay(mop);
   return 0;
 }
 
+/*
+******** tenEpiRegister3DParallel
+**
+** registers the given DWIs to correct for the eddy-current distortion
+** in echo-planar imaging.  The per-DWI (and per-slice) stages after the
+** blurring are done with threadNum threads; the result doesn't depend
+** on threadNum.  With shrink > 1, the transforms are estimated from DWIs
+** that have been downsampled by that factor along X and Y (which is much
+** faster, since the segmentation is the bulk of the work); the final
+** resampling is always of the original DWIs.
+*/
 int
-tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
-                 int reference,
-                 double bwX, double bwY, double fitFrac,
-                 double DWthr, int doCC,
-                 const NrrdKernel *kern, double *kparm,
-                 int progress, int verbose) {
-  static const char me[]="tenEpiRegister3D";
+tenEpiRegister3DParallel(Nrrd **nout, Nrrd **nin, unsigned int ninLen,
+                         Nrrd *_ngrad, int reference,
+                         double bwX, double bwY, double fitFrac,
+                         double DWthr, int doCC, unsigned int shrink,
+                         const NrrdKernel *kern, double *kparm,
+                         unsigned int threadNum, int progress, int verbose) {
+  static const char me[]="tenEpiRegister3DParallel";
   airArray *mop;
   Nrrd **nbuffA, **nbuffB, *npxfr, *nhst, *ngrad;
   int hack1, hack2;
@@ -1057,8 +1627,8 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 
   mop = airMopNew();
   if (_tenEpiRegCheck(nout, nin, ninLen, _ngrad, reference,
-                      bwX, bwY, DWthr,
-                      kern, kparm)) {
+                      bwX, bwY, DWthr, shrink,
+                      kern, kparm, threadNum)) {
     biffAddf(TEN, "%s: trouble with input", me);
     airMopError(mop); return 1;
   }
@@ -1085,8 +1655,9 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
   }
 
   /* ------ blur */
-  if (_tenEpiRegBlur(nbuffA, nin, ninLen, bwX, bwY, verbose)) {
-    biffAddf(TEN, "%s: trouble %s", me, (bwX || bwY) ? "blurring" : "copying");
+  if (_tenEpiRegBlur(nbuffA, nin, ninLen, bwX, bwY, shrink, verbose)) {
+    biffAddf(TEN, "%s: trouble %s", me,
+             (bwX || bwY || shrink > 1) ? "blurring" : "copying");
     airMopError(mop); return 1;
   }
   if (progress && _tenEpiRegSave("regtmp-blur.nrrd", NULL,
@@ -1096,7 +1667,7 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 
   /* ------ threshold */
   if (_tenEpiRegThreshold(nbuffB, nbuffA, ninLen,
-                          DWthr, verbose, progress, 1.5)) {
+                          DWthr, threadNum, verbose, progress, 1.5)) {
     biffAddf(TEN, "%s: trouble thresholding", me);
     airMopError(mop); return 1;
   }
@@ -1107,7 +1678,7 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 
   /* ------ connected components */
   if (doCC) {
-    if (_tenEpiRegCC(nbuffB, ninLen, 1, verbose)) {
+    if (_tenEpiRegCC(nbuffB, ninLen, 1, threadNum, verbose)) {
       biffAddf(TEN, "%s: trouble doing connected components", me);
       airMopError(mop); return 1;
     }
@@ -1118,7 +1689,9 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
   }
 
   /* ------ moments */
-  if (_tenEpiRegMoments(nbuffA, nbuffB, ninLen, verbose)) {
+  if (_tenEpiRegMoments(nbuffA, nbuffB, ninLen,
+                        nin[0]->axis[0].size, nin[0]->axis[1].size,
+                        threadNum, verbose)) {
     biffAddf(TEN, "%s: trouble finding moments", me);
     airMopError(mop); return 1;
   }
@@ -1150,7 +1723,8 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 
     if (fitFrac) {
       /* ------ HST parameter fitting */
-      if (_tenEpiRegFitHST(nhst, nbuffB, ninLen, fitFrac, progress, verbose)) {
+      if (_tenEpiRegFitHST(nhst, nbuffB, ninLen, fitFrac,
+                           threadNum, progress, verbose)) {
         biffAddf(TEN, "%s: trouble fitting HST", me);
         airMopError(mop); return 1;
       }
@@ -1163,7 +1737,7 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 
   /* ------ doit */
   if (_tenEpiRegWarp(nout, npxfr, nhst, ngrad, nin, ninLen,
-                     reference, kern, kparm, verbose)) {
+                     reference, kern, kparm, threadNum, verbose)) {
     biffAddf(TEN, "%s: trouble performing final registration", me);
     airMopError(mop); return 1;
   }
@@ -1175,13 +1749,37 @@ tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
 }
 
 int
-tenEpiRegister4D(Nrrd *_nout, Nrrd *_nin, Nrrd *_ngrad,
+tenEpiRegister3D(Nrrd **nout, Nrrd **nin, unsigned int ninLen, Nrrd *_ngrad,
                  int reference,
                  double bwX, double bwY, double fitFrac,
                  double DWthr, int doCC,
                  const NrrdKernel *kern, double *kparm,
                  int progress, int verbose) {
-  static const char me[]="tenEpiRegister4D";
+  static const char me[]="tenEpiRegister3D";
+
+  if (tenEpiRegister3DParallel(nout, nin, ninLen, _ngrad, reference,
+                               bwX, bwY, fitFrac, DWthr, doCC, 1,
+                               kern, kparm, 1, progress, verbose)) {
+    biffAddf(TEN, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+******** tenEpiRegister4DParallel
+**
+** tenEpiRegister3DParallel on the DWIs stacked along one axis of a 4-D
+** array
+*/
+int
+tenEpiRegister4DParallel(Nrrd *_nout, Nrrd *_nin, Nrrd *_ngrad,
+                         int reference,
+                         double bwX, double bwY, double fitFrac,
+                         double DWthr, int doCC, unsigned int shrink,
+                         const NrrdKernel *kern, double *kparm,
+                         unsigned int threadNum, int progress, int verbose) {
+  static const char me[]="tenEpiRegister4DParallel";
   unsigned int ninIdx, ninLen,
     dwiAx, rangeAxisNum, rangeAxisIdx[NRRD_DIM_MAX];
   int dwiIdx;
@@ -1286,12 +1884,12 @@ tenEpiRegister4D(Nrrd *_nout, Nrrd *_nin, Nrrd *_ngrad,
   }
   /* HEY: HACK! */
   ndwigrad->axis[1].size = 1 + AIR_CAST(unsigned int, dwiIdx);
-  if (tenEpiRegister3D(ndwiOut, ndwi, ndwigrad->axis[1].size, ndwigrad,
-                       reference,
-                       bwX, bwY, fitFrac, DWthr,
-                       doCC,
-                       kern, kparm,
-                       progress, verbose)) {
+  if (tenEpiRegister3DParallel(ndwiOut, ndwi, ndwigrad->axis[1].size,
+                               ndwigrad, reference,
+                               bwX, bwY, fitFrac, DWthr,
+                               doCC, shrink,
+                               kern, kparm,
+                               threadNum, progress, verbose)) {
     biffAddf(TEN, "%s: trouble", me);
     airMopError(mop); return 1;
   }
@@ -1343,3 +1941,21 @@ tenEpiRegister4D(Nrrd *_nout, Nrrd *_nin, Nrrd *_ngrad,
   airMopOkay(mop);
   return 0;
 }
+
+int
+tenEpiRegister4D(Nrrd *_nout, Nrrd *_nin, Nrrd *_ngrad,
+                 int reference,
+                 double bwX, double bwY, double fitFrac,
+                 double DWthr, int doCC,
+                 const NrrdKernel *kern, double *kparm,
+                 int progress, int verbose) {
+  static const char me[]="tenEpiRegister4D";
+
+  if (tenEpiRegister4DParallel(_nout, _nin, _ngrad, reference,
+                               bwX, bwY, fitFrac, DWthr, doCC, 1,
+                               kern, kparm, 1, progress, verbose)) {
+    biffAddf(TEN, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
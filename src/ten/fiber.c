@@ -39,9 +39,11 @@
 ** ten2Which (when at the seedpoint) or
 **
 ** Note that for performance reasons, a non-zero return value
-** (indicating error) and the associated use of biff, is only possible
+** (indicating error, an unimplemented tfx->fiberType) is only checked
 ** if seedProbe is non-zero, the reason being that problems can be
 ** detected at the seedpoint, and won't arise after the seedpoint.
+** This doesn't use biff (so that it can be called from the tracing
+** threads of tenFiberMultiTraceParallel); the caller reports the error.
 **
 ** Errors from gage are indicated by *gageRet, which includes leaving
 ** the domain of the volume, which is used to terminate fibers.
@@ -60,6 +62,7 @@ _tenFiberProbe(tenFiberContext *tfx, int *gageRet,
 
   gageShapeWtoI(tfx->gtx->shape, iPos, wPos);
   *gageRet = gageProbe(tfx->gtx, iPos[0], iPos[1], iPos[2]);
+  tfx->probeNum++;
 
   if (tfx->verbose > 2) {
     fprintf(stderr, "%s(%g,%g,%g, %s): hi ----- %s\n", me,
@@ -190,9 +193,7 @@ _tenFiberProbe(tenFiberContext *tfx, int *gageRet,
       }
       break;
     default:
-      biffAddf(TEN, "%s: %s %s (%d) unimplemented!", me,
-              tenDwiFiberType->name,
-              airEnumStr(tenDwiFiberType, tfx->fiberType), tfx->fiberType);
+      /* unimplemented fiberType, reported by caller */
       ret = 1;
     } /* switch (tfx->fiberType) */
   }
@@ -457,16 +458,77 @@ _tenFiberIntegrate[TEN_FIBER_INTG_MAX+1])(tenFiberContext *tfx, double *) = {
   _tenFiberIntegrate_RK4
 };
 
+/*
+** the ways that _fiberTrace can fail; it doesn't use biff (so that it
+** can be called from the tracing threads of tenFiberMultiTraceParallel),
+** and instead returns one of these, which _fiberTraceBiff describes
+*/
+enum {
+  _fiberTraceErrNone,
+  _fiberTraceErrFiberType,   /* tfx->fiberType not implemented */
+  _fiberTraceErrGage,        /* gage problem other than bounds at seed;
+                                see tfx->gtx->errStr and errNum */
+  _fiberTraceErrAlloc        /* couldn't allocate nval or nfiber */
+};
+
+/*
+** adds to biff the description of _fiberTraceXxx error "err", which
+** happened in tracing with tfx
+*/
+static void
+_fiberTraceBiff(const char *me, const tenFiberContext *tfx, int err) {
+
+  switch (err) {
+  case _fiberTraceErrFiberType:
+    biffAddf(TEN, "%s: %s %s (%d) unimplemented!", me,
+             tenDwiFiberType->name,
+             airEnumStr(tenDwiFiberType, tfx->fiberType), tfx->fiberType);
+    break;
+  case _fiberTraceErrGage:
+    biffAddf(TEN, "%s: gage problem on first _tenFiberProbe: %s (%d)",
+             me, tfx->gtx->errStr, tfx->gtx->errNum);
+    break;
+  case _fiberTraceErrAlloc:
+    biffAddf(TEN, "%s: couldn't allocate output", me);
+    break;
+  default:
+    biffAddf(TEN, "%s: unknown error %d", me, err);
+    break;
+  }
+  return;
+}
+
+/*
+** biff-free stand-in for nrrdMaybeAlloc_va(nout, nrrdTypeDouble, 2,
+** size0, size1), for _fiberTrace; both sizes are non-zero
+*/
+static int
+_fiberAlloc(Nrrd *nout, size_t size0, size_t size1) {
+  double *data;
+
+  data = AIR_CAST(double *, malloc(size0*size1*sizeof(double)));
+  if (!data) {
+    return 1;
+  }
+  nrrdEmpty(nout);
+  /* can't fail (and so won't use biff) with non-NULL data and sizes */
+  nrrdWrap_va(nout, data, nrrdTypeDouble, 2, size0, size1);
+  return 0;
+}
+
 /*
 ** modified body of previous tenFiberTraceSet, in order to
-** permit passing the nval for storing desired probed values
+** permit passing the nval for storing desired probed values.
+** Doesn't use biff: returns a _fiberTraceErr value (0 if all's well).
+** The arguments have been checked by _fiberTraceSet (or are known to be
+** okay, as in _tenFiberSingleTrace), and with NULL nfiber, it is up to
+** the caller to set (and then restore) the tenFiberStopNumSteps stop.
 */
 static int
-_fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
-               double *buff, unsigned int halfBuffLen,
-               unsigned int *startIdxP, unsigned int *endIdxP,
-               double seed[3]) {
-  static const char me[]="_fiberTraceSet";
+_fiberTrace(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
+            double *buff, unsigned int halfBuffLen,
+            unsigned int *startIdxP, unsigned int *endIdxP,
+            double seed[3]) {
   airArray *fptsArr[2],      /* airArrays of backward (0) and forward (1)
                                 fiber points */
     *pansArr[2];             /* airArrays of backward (0) and forward (1)
@@ -484,20 +546,12 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
     *valOut;                 /* same for probed values */
   const double *pansP;       /* pointer to gage's probed values */
 
-  int gret, whyStop, buffIdx, fptsIdx, pansIdx, outIdx, oldStop, keepfiber;
+  int gret, whyStop, buffIdx, fptsIdx, pansIdx, outIdx, keepfiber;
   unsigned int i, pansLen;
   airArray *mop;
   airPtrPtrUnion appu;
 
-  if (!(tfx)) {
-    biffAddf(TEN, "%s: got NULL pointer", me);
-    return 1;
-  }
   if (nval) {
-    if (!tfx->fiberProbeItem) {
-      biffAddf(TEN, "%s: want to record probed values but no item set", me);
-      return 1;
-    }
     pansLen = gageAnswerLength(tfx->gtx, tfx->pvl, tfx->fiberProbeItem);
     pansP = gageAnswerPointer(tfx->gtx, tfx->pvl, tfx->fiberProbeItem);
   } else {
@@ -513,20 +567,6 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
   fprintf(stderr, "!%s:  =========================== \n", me);
   */
 
-  /* HEY: a hack to preserve the state inside tenFiberContext so that
-     we have fewer side effects (tfx->maxNumSteps may still be set) */
-  oldStop = tfx->stop;
-  if (!nfiber) {
-    if (!( buff && halfBuffLen > 0 && startIdxP && startIdxP )) {
-      biffAddf(TEN, "%s: need either non-NULL nfiber or fpts buffer info", me);
-      return 1;
-    }
-    if (tenFiberStopSet(tfx, tenFiberStopNumSteps, halfBuffLen)) {
-      biffAddf(TEN, "%s: error setting new fiber stop", me);
-      return 1;
-    }
-  }
-
   /* initialize the quantities which describe the fiber halves */
   tfx->halfLen[0] = tfx->halfLen[1] = 0.0;
   tfx->numSteps[0] = tfx->numSteps[1] = 0;
@@ -542,14 +582,11 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
     ELL_3V_COPY(tmp, seed);
   }
   if (_tenFiberProbe(tfx, &gret, tmp, AIR_TRUE)) {
-    biffAddf(TEN, "%s: first _tenFiberProbe failed", me);
-    return 1;
+    return _fiberTraceErrFiberType;
   }
   if (gret) {
     if (gageErrBoundsSpace != tfx->gtx->errNum) {
-      biffAddf(TEN, "%s: gage problem on first _tenFiberProbe: %s (%d)",
-              me, tfx->gtx->errStr, tfx->gtx->errNum);
-      return 1;
+      return _fiberTraceErrGage;
     } else {
       /* the problem on the first probe was that it was out of bounds,
          which is not a catastrophe; its handled the same as below */
@@ -775,12 +812,9 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
     }
   } else {
     if (nval) {
-      if (nrrdMaybeAlloc_va(nval, nrrdTypeDouble, 2,
-                            AIR_CAST(size_t, pansLen),
-                            AIR_CAST(size_t, (pansArr[0]->len
-                                              + pansArr[1]->len - 1)))) {
-        biffMovef(TEN, NRRD, "%s: couldn't allocate probed value nrrd", me);
-        airMopError(mop); return 1;
+      if (_fiberAlloc(nval, pansLen,
+                      pansArr[0]->len + pansArr[1]->len - 1)) {
+        airMopError(mop); return _fiberTraceErrAlloc;
       }
       valOut = AIR_CAST(double*, nval->data);
       outIdx = 0;
@@ -797,12 +831,9 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
       }
     }
     if (nfiber) {
-      if (nrrdMaybeAlloc_va(nfiber, nrrdTypeDouble, 2,
-                            AIR_CAST(size_t, 3),
-                            AIR_CAST(size_t, (fptsArr[0]->len
-                                              + fptsArr[1]->len - 1)))) {
-        biffMovef(TEN, NRRD, "%s: couldn't allocate fiber nrrd", me);
-        airMopError(mop); return 1;
+      if (_fiberAlloc(nfiber, 3,
+                      fptsArr[0]->len + fptsArr[1]->len - 1)) {
+        airMopError(mop); return _fiberTraceErrAlloc;
       }
       fiber = AIR_CAST(double*, nfiber->data);
       outIdx = 0;
@@ -820,8 +851,49 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
     }
   }
 
-  tfx->stop = oldStop;
   airMopOkay(mop);
+  return _fiberTraceErrNone;
+}
+
+/*
+** checks the arguments to _fiberTrace, and reports its errors with biff
+*/
+static int
+_fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
+               double *buff, unsigned int halfBuffLen,
+               unsigned int *startIdxP, unsigned int *endIdxP,
+               double seed[3]) {
+  static const char me[]="_fiberTraceSet";
+  int oldStop, err;
+
+  if (!(tfx)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (nval && !tfx->fiberProbeItem) {
+    biffAddf(TEN, "%s: want to record probed values but no item set", me);
+    return 1;
+  }
+  /* HEY: a hack to preserve the state inside tenFiberContext so that
+     we have fewer side effects */
+  oldStop = tfx->stop;
+  if (!nfiber) {
+    if (!( buff && halfBuffLen > 0 && startIdxP && startIdxP )) {
+      biffAddf(TEN, "%s: need either non-NULL nfiber or fpts buffer info", me);
+      return 1;
+    }
+    if (tenFiberStopSet(tfx, tenFiberStopNumSteps, halfBuffLen)) {
+      biffAddf(TEN, "%s: error setting new fiber stop", me);
+      return 1;
+    }
+  }
+  err = _fiberTrace(tfx, nval, nfiber, buff, halfBuffLen,
+                    startIdxP, endIdxP, seed);
+  tfx->stop = oldStop;
+  if (err) {
+    _fiberTraceBiff(me, tfx, err);
+    return 1;
+  }
   return 0;
 }
 
@@ -932,23 +1004,13 @@ tenFiberDirectionNumber(tenFiberContext *tfx, double seed[3]) {
 }
 
 /*
-******** tenFiberSingleTrace
-**
-** fiber tracing API that uses new tenFiberSingle, as well as being
-** aware of multi-direction tractography
-**
-** NOTE: this will not try any cleverness in setting "num"
-** according to whether the seedpoint is a non-starter
+** biff-free body of tenFiberSingleTrace, for the tracing threads;
+** returns a _fiberTraceErr value
 */
-int
-tenFiberSingleTrace(tenFiberContext *tfx, tenFiberSingle *tfbs,
-                    double seed[3], unsigned int which) {
-  static const char me[]="tenFiberSingleTrace";
-
-  if (!(tfx && tfbs && seed)) {
-    biffAddf(TEN, "%s: got NULL pointer", me);
-    return 1;
-  }
+static int
+_tenFiberSingleTrace(tenFiberContext *tfx, tenFiberSingle *tfbs,
+                     double seed[3], unsigned int which) {
+  int err;
 
   /* set input fields in tfbs */
   ELL_3V_COPY(tfbs->seedPos, seed);
@@ -958,10 +1020,10 @@ tenFiberSingleTrace(tenFiberContext *tfx, tenFiberSingle *tfbs,
   /* set tfbs->nvert */
   /* no harm in setting this even when there are no multiple fibers */
   tfx->ten2Which = which;
-  if (_fiberTraceSet(tfx, (tfx->fiberProbeItem ? tfbs->nval : NULL),
-                     tfbs->nvert, NULL, 0, NULL, NULL, seed)) {
-    biffAddf(TEN, "%s: problem computing tract", me);
-    return 1;
+  err = _fiberTrace(tfx, (tfx->fiberProbeItem ? tfbs->nval : NULL),
+                    tfbs->nvert, NULL, 0, NULL, NULL, seed);
+  if (err) {
+    return err;
   }
 
   /* set other fields based on tfx output */
@@ -977,6 +1039,33 @@ tenFiberSingleTrace(tenFiberContext *tfx, tenFiberSingle *tfbs,
   return 0;
 }
 
+/*
+******** tenFiberSingleTrace
+**
+** fiber tracing API that uses new tenFiberSingle, as well as being
+** aware of multi-direction tractography
+**
+** NOTE: this will not try any cleverness in setting "num"
+** according to whether the seedpoint is a non-starter
+*/
+int
+tenFiberSingleTrace(tenFiberContext *tfx, tenFiberSingle *tfbs,
+                    double seed[3], unsigned int which) {
+  static const char me[]="tenFiberSingleTrace";
+  int err;
+
+  if (!(tfx && tfbs && seed)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if ((err = _tenFiberSingleTrace(tfx, tfbs, seed, which))) {
+    _fiberTraceBiff(me, tfx, err);
+    biffAddf(TEN, "%s: problem computing tract", me);
+    return 1;
+  }
+  return 0;
+}
+
 typedef union {
   tenFiberSingle **f;
   void **v;
@@ -993,6 +1082,8 @@ tenFiberMultiNew() {
   if (ret) {
     ret->fiber = NULL;
     ret->fiberNum = 0;
+    ret->traceTime = 0;
+    ret->probeNum = 0;
     tfu.f = &(ret->fiber);
     ret->fiberArr = airArrayNew(tfu.v, &(ret->fiberNum),
                                 sizeof(tenFiberSingle), 512 /* incr */);
@@ -1042,21 +1133,161 @@ tenFiberMultiNix(tenFiberMulti *tfm) {
 }
 
 /*
-******** tenFiberMultiTrace
+** number of seedpoints handed to a tracing thread at a time; small enough
+** to balance load when fiber lengths vary a lot, big enough that the
+** mutex is not contended
+*/
+#define _TEN_FIBER_SEED_CHUNK 16
+
+typedef struct {
+  /* shared (same for all threads) */
+  tenFiberMulti *tfml;
+  const double *seedData;
+  const unsigned int *fiberStart; /* seedNum+1 prefix sum of dirNum */
+  unsigned int seedNum;
+  unsigned int *seedNext;         /* next seed to hand out, under mutex */
+  int *abort;                     /* set on first error, under mutex */
+  airThreadMutex *mutex;
+  /* per-thread */
+  tenFiberContext *tfx;
+  unsigned int threadIdx;
+  int error;                      /* this thread saw trouble: a
+                                     _fiberTraceErr value, reported with
+                                     biff only after the threads are done */
+  unsigned int errSeedIdx,        /* seed and direction of the trouble */
+    errDirIdx;
+  int errWhyNowhere;              /* tfx->whyNowhere at the trouble */
+} _tenFiberTask;
+
+/*
+** traces all the fibers from one seed; doesn't use biff, but returns
+** a _fiberTraceErr value, and the direction of the trouble in *dirIdxP
+*/
+static int
+_tenFiberSeedTrace(unsigned int *dirIdxP,
+                   tenFiberContext *tfx, tenFiberMulti *tfml,
+                   const double *seedData, const unsigned int *fiberStart,
+                   unsigned int seedIdx, unsigned int seedNum) {
+  static const char me[]="_tenFiberSeedTrace";
+  tenFiberSingle *tfbs;
+  double seed[3];
+  unsigned int dirNum, dirIdx;
+  int err;
+
+  dirNum = fiberStart[seedIdx+1] - fiberStart[seedIdx];
+  for (dirIdx=0; dirIdx<dirNum; dirIdx++) {
+    tfbs = tfml->fiber + fiberStart[seedIdx] + dirIdx;
+    if (tfx->verbose > 1) {
+      fprintf(stderr, "%s: dir %u/%u on seed %u/%u; # %u\n",
+              me, dirIdx, dirNum, seedIdx, seedNum,
+              fiberStart[seedIdx] + dirIdx);
+    }
+    ELL_3V_COPY(tfbs->seedPos, seedData + 3*seedIdx);
+    tfbs->dirIdx = dirIdx;
+    tfbs->dirNum = dirNum;
+    ELL_3V_COPY(seed, seedData + 3*seedIdx);
+    if ((err = _tenFiberSingleTrace(tfx, tfbs, seed, dirIdx))) {
+      *dirIdxP = dirIdx;
+      return err;
+    }
+    if (tfx->verbose) {
+      if (tenFiberStopUnknown == tfbs->whyNowhere) {
+        fprintf(stderr, "%s: (%g,%g,%g) ->\n"
+                "   steps = %u,%u; len = %g,%g; whyStop = %s,%s\n",
+                me, seed[0], seed[1], seed[2],
+                tfbs->stepNum[0], tfbs->stepNum[1],
+                tfbs->halfLen[0], tfbs->halfLen[1],
+                airEnumStr(tenFiberStop, tfbs->whyStop[0]),
+                airEnumStr(tenFiberStop, tfbs->whyStop[1]));
+      } else {
+        fprintf(stderr, "%s: (%g,%g,%g) -> whyNowhere: %s\n",
+                me, seed[0], seed[1], seed[2],
+                airEnumStr(tenFiberStop, tfbs->whyNowhere));
+      }
+    }
+  }
+  return 0;
+}
+
+static void *
+_tenFiberWorker(void *_task) {
+  _tenFiberTask *task;
+  unsigned int seedLo, seedHi, seedIdx, dirIdx;
+  int err;
+
+  task = AIR_CAST(_tenFiberTask *, _task);
+  while (1) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    if (*(task->abort)) {
+      seedLo = seedHi = task->seedNum;
+    } else {
+      seedLo = *(task->seedNext);
+      seedHi = AIR_MIN(seedLo + _TEN_FIBER_SEED_CHUNK, task->seedNum);
+      *(task->seedNext) = seedHi;
+    }
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (seedLo == seedHi) {
+      break;
+    }
+    for (seedIdx=seedLo; seedIdx<seedHi; seedIdx++) {
+      err = _tenFiberSeedTrace(&dirIdx, task->tfx, task->tfml,
+                               task->seedData, task->fiberStart,
+                               seedIdx, task->seedNum);
+      if (err) {
+        /* biff is not thread-safe, so the trouble is only recorded
+           here, and reported after all the threads are done */
+        task->error = err;
+        task->errSeedIdx = seedIdx;
+        task->errDirIdx = dirIdx;
+        task->errWhyNowhere = task->tfx->whyNowhere;
+        if (task->mutex) {
+          airThreadMutexLock(task->mutex);
+        }
+        *(task->abort) = AIR_TRUE;
+        if (task->mutex) {
+          airThreadMutexUnlock(task->mutex);
+        }
+        return _task;
+      }
+    }
+  }
+  return _task;
+}
+
+/*
+******** tenFiberMultiTraceParallel
 **
-** does tractography for a list of seedpoints
+** does tractography for a list of seedpoints, using "threadNum" threads,
+** each of which has its own copy (via tenFiberContextCopy) of tfx.
+** Seedpoints are handed out to threads in small chunks, but the fibers
+** in tfml are always ordered by seedpoint (and then by direction), so
+** the output does not depend on threadNum.
 **
-** tfml has been returned from tenFiberMultiNew()
+** tfml has been returned from tenFiberMultiNew().  On return,
+** tfml->traceTime and tfml->probeNum record the wall-clock time and the
+** number of gage probes that went into tracing.
+**
+** Contexts that use DWIs can't be copied, so with those (or without
+** pthreads) this silently uses a single thread.
 */
 int
-tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml,
-                   const Nrrd *_nseed) {
-  static const char me[]="tenFiberMultiTrace";
+tenFiberMultiTraceParallel(tenFiberContext *tfx, tenFiberMulti *tfml,
+                           const Nrrd *_nseed, unsigned int threadNum) {
+  static const char me[]="tenFiberMultiTraceParallel";
   airArray *mop;
   const double *seedData;
-  double seed[3];
-  unsigned int seedNum, seedIdx, fibrNum, dirNum, dirIdx;
+  double seed[3], time0;
+  unsigned int seedNum, seedIdx, dirNum, *fiberStart, seedNext,
+    threadIdx, failIdx;
+  int abort, hadErr;
+  size_t probeNum0;
   Nrrd *nseed;
+  _tenFiberTask *task;
+  airThreadMutex *mutex;
 
   if (!(tfx && tfml && _nseed)) {
     biffAddf(TEN, "%s: got NULL pointer", me);
@@ -1072,10 +1303,17 @@ tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml,
             AIR_CAST(unsigned int, _nseed->axis[0].size));
     return 1;
   }
+  if (!threadNum) {
+    biffAddf(TEN, "%s: need non-zero threadNum", me);
+    return 1;
+  }
+  if (tfx->useDwi || !airThreadCapable) {
+    threadNum = 1;
+  }
 
   mop = airMopNew();
 
-  seedNum = _nseed->axis[1].size;
+  seedNum = AIR_CAST(unsigned int, _nseed->axis[1].size);
   if (nrrdTypeDouble == _nseed->type) {
     seedData = AIR_CAST(const double *, _nseed->data);
   } else {
@@ -1083,68 +1321,156 @@ tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml,
     airMopAdd(mop, nseed, AIR_CAST(airMopper, nrrdNuke), airMopAlways);
     if (nrrdConvert(nseed, _nseed, nrrdTypeDouble)) {
       biffMovef(TEN, NRRD, "%s: couldn't convert seed list", me);
-      return 1;
+      airMopError(mop); return 1;
     }
     seedData = AIR_CAST(const double *, nseed->data);
   }
 
-  /* HEY: the correctness of the use of the airArray here is quite subtle */
-  fibrNum = 0;
+  /* learn how many fibers start at each seed, so that every fiber has
+     a fixed slot in tfml->fiber before any tracing starts */
+  fiberStart = AIR_CALLOC(seedNum+1, unsigned int);
+  if (!fiberStart) {
+    biffAddf(TEN, "%s: couldn't allocate fiber index", me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, fiberStart, airFree, airMopAlways);
+  fiberStart[0] = 0;
   for (seedIdx=0; seedIdx<seedNum; seedIdx++) {
+    ELL_3V_COPY(seed, seedData + 3*seedIdx);
     dirNum = tenFiberDirectionNumber(tfx, seed);
     if (!dirNum) {
       biffAddf(TEN, "%s: couldn't learn dirNum at seed (%g,%g,%g)", me,
               seed[0], seed[1], seed[2]);
-      return 1;
+      airMopError(mop); return 1;
     }
-    for (dirIdx=0; dirIdx<dirNum; dirIdx++) {
-      if (tfx->verbose > 1) {
-        fprintf(stderr, "%s: dir %u/%u on seed %u/%u; len %u; # %u\n",
-                me, dirIdx, dirNum, seedIdx, seedNum,
-                tfml->fiberArr->len, fibrNum);
-      }
-      /* tfml->fiberArr->len can never be < fibrNum */
-      if (tfml->fiberArr->len == fibrNum) {
-        airArrayLenIncr(tfml->fiberArr, 1);
-      }
-      ELL_3V_COPY(tfml->fiber[fibrNum].seedPos, seedData + 3*seedIdx);
-      tfml->fiber[fibrNum].dirIdx = dirIdx;
-      tfml->fiber[fibrNum].dirNum = dirNum;
-      ELL_3V_COPY(seed, seedData + 3*seedIdx);
-      if (tenFiberSingleTrace(tfx, &(tfml->fiber[fibrNum]), seed, dirIdx)) {
-        biffAddf(TEN, "%s: trouble on seed (%g,%g,%g) %u/%u, dir %u/%u", me,
-                seed[0], seed[1], seed[2], seedIdx, seedNum, dirIdx, dirNum);
-        return 1;
-      }
-      if (tfx->verbose) {
-        if (tenFiberStopUnknown == tfml->fiber[fibrNum].whyNowhere) {
-          fprintf(stderr, "%s: (%g,%g,%g) ->\n"
-                  "   steps = %u,%u; len = %g,%g; whyStop = %s,%s\n",
-                  me, seed[0], seed[1], seed[2],
-                  tfml->fiber[fibrNum].stepNum[0],
-                  tfml->fiber[fibrNum].stepNum[1],
-                  tfml->fiber[fibrNum].halfLen[0],
-                  tfml->fiber[fibrNum].halfLen[1],
-                  airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyStop[0]),
-                  airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyStop[1]));
-        } else {
-          fprintf(stderr, "%s: (%g,%g,%g) -> whyNowhere: %s\n",
-                  me, seed[0], seed[1], seed[2],
-                  airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyNowhere));
-        }
+    fiberStart[seedIdx+1] = fiberStart[seedIdx] + dirNum;
+  }
+  /* via the callbacks, this clears out any tenFiberSingles beyond what
+     we need, and initializes any new ones; the existing ones are re-used */
+  airArrayLenSet(tfml->fiberArr, fiberStart[seedNum]);
+  if (tfml->fiberArr->len != fiberStart[seedNum]) {
+    biffAddf(TEN, "%s: couldn't allocate %u fibers", me, fiberStart[seedNum]);
+    airMopError(mop); return 1;
+  }
+
+  task = AIR_CALLOC(threadNum, _tenFiberTask);
+  if (!task) {
+    biffAddf(TEN, "%s: couldn't allocate %u tasks", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (threadNum > 1) {
+    mutex = airThreadMutexNew();
+    airMopAdd(mop, mutex, (airMopper)airThreadMutexNix, airMopAlways);
+  } else {
+    mutex = NULL;
+  }
+  seedNext = 0;
+  abort = AIR_FALSE;
+  for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+    task[threadIdx].tfml = tfml;
+    task[threadIdx].seedData = seedData;
+    task[threadIdx].fiberStart = fiberStart;
+    task[threadIdx].seedNum = seedNum;
+    task[threadIdx].seedNext = &seedNext;
+    task[threadIdx].abort = &abort;
+    task[threadIdx].mutex = mutex;
+    task[threadIdx].threadIdx = threadIdx;
+    task[threadIdx].error = _fiberTraceErrNone;
+    task[threadIdx].errSeedIdx = task[threadIdx].errDirIdx = 0;
+    task[threadIdx].errWhyNowhere = tenFiberStopUnknown;
+    if (!threadIdx) {
+      task[threadIdx].tfx = tfx;
+    } else {
+      task[threadIdx].tfx = tenFiberContextCopy(tfx);
+      airMopAdd(mop, task[threadIdx].tfx,
+                (airMopper)tenFiberContextNix, airMopAlways);
+    }
+  }
+
+  probeNum0 = tfx->probeNum;
+  /* the copies' gageContexts start their iv3 counts at zero */
+  gageIv3CountReset(tfx->gtx);
+  time0 = airTime();
+  failIdx = airThreadRun(threadNum, _tenFiberWorker, task,
+                         sizeof(_tenFiberTask), &abort, mutex);
+  tfml->traceTime = airTime() - time0;
+  if (failIdx) {
+    biffAddf(TEN, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
+
+  hadErr = AIR_FALSE;
+  tfml->probeNum = tfx->probeNum - probeNum0;
+  for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+    if (task[threadIdx].error) {
+      /* the tfx of a thread with trouble is as it was at the trouble */
+      seedIdx = task[threadIdx].errSeedIdx;
+      _fiberTraceBiff(me, task[threadIdx].tfx, task[threadIdx].error);
+      biffAddf(TEN, "%s(%u): trouble on seed (%g,%g,%g) %u/%u, dir %u/%u "
+               "(whyNowhere %s)", me, threadIdx, seedData[0 + 3*seedIdx],
+               seedData[1 + 3*seedIdx], seedData[2 + 3*seedIdx],
+               seedIdx, seedNum, task[threadIdx].errDirIdx,
+               fiberStart[seedIdx+1] - fiberStart[seedIdx],
+               airEnumStr(tenFiberStop, task[threadIdx].errWhyNowhere));
+      hadErr = AIR_TRUE;
+    }
+    if (threadIdx) {
+      /* copies start with the probeNum of tfx at the time of copying */
+      tfml->probeNum += task[threadIdx].tfx->probeNum - probeNum0;
+    }
+  }
+  if (hadErr) {
+    biffAddf(TEN, "%s: trouble tracing with %u threads", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  if (tfx->verbose) {
+    fprintf(stderr, "%s: %u fibers from %u seeds in %g sec with %u threads "
+            "(%g fibers/sec, %g probes/sec)\n", me,
+            tfml->fiberNum, seedNum, tfml->traceTime, threadNum,
+            tfml->fiberNum/AIR_MAX(tfml->traceTime, 1e-9),
+            AIR_CAST(double, tfml->probeNum)
+            /AIR_MAX(tfml->traceTime, 1e-9));
+    {
+      char stmp[3][AIR_STRLEN_SMALL];
+      size_t hitNum, shiftNum, fillNum;
+      hitNum = shiftNum = fillNum = 0;
+      for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+        hitNum += task[threadIdx].tfx->gtx->iv3HitNum;
+        shiftNum += task[threadIdx].tfx->gtx->iv3ShiftNum;
+        fillNum += task[threadIdx].tfx->gtx->iv3FillNum;
       }
-      fibrNum++;
+      fprintf(stderr, "%s: iv3 cache: %s hits, %s shifts, %s fills\n", me,
+              airSprintSize_t(stmp[0], hitNum),
+              airSprintSize_t(stmp[1], shiftNum),
+              airSprintSize_t(stmp[2], fillNum));
     }
   }
-  /* if the airArray got to be its length only because of the work above,
-     then the following will be a no-op.  Otherwise, via the callbacks,
-     it will clear out the tenFiberSingle's that we didn't create here */
-  airArrayLenSet(tfml->fiberArr, fibrNum);
 
   airMopOkay(mop);
   return 0;
 }
 
+/*
+******** tenFiberMultiTrace
+**
+** does tractography for a list of seedpoints, with a single thread
+**
+** tfml has been returned from tenFiberMultiNew()
+*/
+int
+tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml,
+                   const Nrrd *nseed) {
+  static const char me[]="tenFiberMultiTrace";
+
+  if (tenFiberMultiTraceParallel(tfx, tfml, nseed, 1)) {
+    biffAddf(TEN, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
+
 static int
 _fiberMultiExtract(tenFiberContext *tfx, Nrrd *nval,
                    limnPolyData *lpld, tenFiberMulti *tfml) {
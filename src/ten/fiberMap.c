@@ -0,0 +1,696 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "ten.h"
+#include "privateTen.h"
+
+/*
+** number of fibers handed to a mapping thread at a time
+*/
+#define _TEN_FIBER_MAP_CHUNK 64
+
+/*
+** the direction color sums are accumulated in fixed point, with this
+** many units per voxel of fiber length.  Integer sums don't depend on
+** the order of addition, which is what makes the maps independent of
+** how fibers are divided among threads.
+*/
+#define _TEN_FIBER_MAP_FIX 16777216.0 /* 2^24 */
+
+/*
+** where the fibers come from: for each fiber, start[] is either the
+** index into pld->indx of its first vertex, or its index in tfml->fiber
+*/
+typedef struct {
+  const limnPolyData *pld;
+  const tenFiberMulti *tfml;
+  unsigned int fiberNum, *start, *vertNum;
+} _tenFiberMapSrc;
+
+
+typedef struct {
+  /* shared (same for all threads) */
+  const _tenFiberMapSrc *src;
+  const gageShape *shape;
+  int indexSpace;                 /* fiber vertices are in index space */
+  unsigned int supersample;
+  const Nrrd *nlabel;
+  unsigned int labelNum;
+  unsigned int *fiberNext;        /* next fiber to hand out, under mutex */
+  int *abort;                     /* set on first error, under mutex */
+  airThreadMutex *mutex;
+  /* per-thread */
+  unsigned int threadIdx;
+  unsigned int *dens,             /* fiber counts per voxel, or NULL */
+    *conn;                        /* labelNum-by-labelNum counts, or NULL */
+  airULLong *rgbw;                /* per voxel: fixed-point sums of w*|dx|,
+                                     w*|dy|, w*|dz|, and w, or NULL */
+  size_t *visit;                  /* voxels visited by the current fiber */
+  size_t visitNum, visitSize;
+  int error;                      /* this thread saw trouble */
+} _tenFiberMapTask;
+
+static void
+_tenFiberMapVert(double pos[3], const _tenFiberMapSrc *src,
+                 unsigned int fi, unsigned int vi) {
+  const float *xyzw;
+  const double *vert;
+
+  if (src->pld) {
+    xyzw = src->pld->xyzw + 4*src->pld->indx[src->start[fi] + vi];
+    ELL_34V_HOMOG(pos, xyzw);
+  } else {
+    vert = AIR_CAST(const double *,
+                    src->tfml->fiber[src->start[fi]].nvert->data);
+    ELL_3V_COPY(pos, vert + 3*vi);
+  }
+  return;
+}
+
+/*
+** sets *voxP to the linear index of the voxel containing index-space
+** position ipos, and returns 1, or returns 0 if ipos is outside the grid
+*/
+static int
+_tenFiberMapVoxel(size_t *voxP, const gageShape *shape,
+                  const double ipos[3]) {
+  double ff;
+  size_t ii[3];
+  unsigned int ai;
+
+  for (ai=0; ai<3; ai++) {
+    ff = floor(ipos[ai] + 0.5);
+    /* this also catches non-existent ipos */
+    if (!( ff >= 0 && ff < shape->size[ai] )) {
+      return 0;
+    }
+    ii[ai] = AIR_CAST(size_t, ff);
+  }
+  *voxP = ii[0] + shape->size[0]*(ii[1] + shape->size[1]*ii[2]);
+  return 1;
+}
+
+/* label 0 is also used for positions outside the grid */
+static unsigned int
+_tenFiberMapLabel(const _tenFiberMapTask *task, const double ipos[3]) {
+  size_t vox;
+
+  if (!_tenFiberMapVoxel(&vox, task->shape, ipos)) {
+    return 0;
+  }
+  return AIR_CAST(unsigned int,
+                  nrrdILookup[task->nlabel->type](task->nlabel->data, vox));
+}
+
+static int
+_tenFiberMapVisitCompare(const void *_a, const void *_b) {
+  size_t aa, bb;
+
+  aa = *AIR_CAST(const size_t *, _a);
+  bb = *AIR_CAST(const size_t *, _b);
+  return (aa < bb ? -1 : (aa > bb ? 1 : 0));
+}
+
+/*
+** _tenFiberMapSample
+**
+** records one sample, at index-space position ipos, of a fiber segment
+** with world-space unit direction dir (NULL if there isn't one), that
+** stands for wght voxels of fiber length.  Returns non-zero (without
+** biff) only if the visit list couldn't be grown.
+*/
+static int
+_tenFiberMapSample(_tenFiberMapTask *task, const double ipos[3],
+                   const double dir[3], double wght) {
+  size_t vox, *visit;
+  airULLong *rgbw;
+
+  if (!_tenFiberMapVoxel(&vox, task->shape, ipos)) {
+    return 0;
+  }
+  if (task->dens
+      && !(task->visitNum && vox == task->visit[task->visitNum-1])) {
+    if (task->visitNum == task->visitSize) {
+      visit = AIR_CAST(size_t *, realloc(task->visit, 2*task->visitSize
+                                         *sizeof(size_t)));
+      if (!visit) {
+        return 1;
+      }
+      task->visit = visit;
+      task->visitSize *= 2;
+    }
+    task->visit[task->visitNum++] = vox;
+  }
+  if (task->rgbw && dir) {
+    rgbw = task->rgbw + 4*vox;
+    rgbw[0] += AIR_CAST(airULLong, wght*AIR_ABS(dir[0])*_TEN_FIBER_MAP_FIX
+                        + 0.5);
+    rgbw[1] += AIR_CAST(airULLong, wght*AIR_ABS(dir[1])*_TEN_FIBER_MAP_FIX
+                        + 0.5);
+    rgbw[2] += AIR_CAST(airULLong, wght*AIR_ABS(dir[2])*_TEN_FIBER_MAP_FIX
+                        + 0.5);
+    rgbw[3] += AIR_CAST(airULLong, wght*_TEN_FIBER_MAP_FIX + 0.5);
+  }
+  return 0;
+}
+
+/*
+** _tenFiberMapFiber
+**
+** voxelizes one fiber: each segment is sampled at the starts of
+** ceil(supersample*len) equal pieces, where len is its index-space
+** length, so every vertex is sampled.  The fiber is counted once in
+** every voxel it visits, no matter how many of its samples land there.
+** Returns non-zero (without biff) on allocation failure.
+*/
+static int
+_tenFiberMapFiber(_tenFiberMapTask *task, unsigned int fi) {
+  double vert[3], ipos[2][3], wpos[2][3], dir[3], pos[3], len, wlen;
+  unsigned int vi, vertNum, si, sampNum, lab[2];
+  size_t ii;
+
+  vertNum = task->src->vertNum[fi];
+  if (!vertNum) {
+    return 0;
+  }
+  task->visitNum = 0;
+  lab[0] = lab[1] = 0;
+  for (vi=0; vi<vertNum; vi++) {
+    if (vi) {
+      ELL_3V_COPY(ipos[0], ipos[1]);
+      ELL_3V_COPY(wpos[0], wpos[1]);
+    }
+    _tenFiberMapVert(vert, task->src, fi, vi);
+    if (task->indexSpace) {
+      ELL_3V_COPY(ipos[1], vert);
+      gageShapeItoW(task->shape, wpos[1], vert);
+    } else {
+      ELL_3V_COPY(wpos[1], vert);
+      gageShapeWtoI(task->shape, ipos[1], vert);
+    }
+    if (task->conn) {
+      if (!vi) {
+        lab[0] = _tenFiberMapLabel(task, ipos[1]);
+      }
+      if (vertNum-1 == vi) {
+        lab[1] = _tenFiberMapLabel(task, ipos[1]);
+      }
+    }
+    if (!vi) {
+      continue;
+    }
+    ELL_3V_SUB(pos, ipos[1], ipos[0]);
+    len = ELL_3V_LEN(pos);
+    if (!( AIR_EXISTS(len) && task->supersample*len < UINT_MAX )) {
+      /* bogus vertex; nothing sensible to do with this segment */
+      continue;
+    }
+    ELL_3V_SUB(dir, wpos[1], wpos[0]);
+    ELL_3V_NORM(dir, dir, wlen);
+    sampNum = AIR_CAST(unsigned int, ceil(task->supersample*len));
+    sampNum = AIR_MAX(1, sampNum);
+    for (si=0; si<sampNum; si++) {
+      ELL_3V_LERP(pos, AIR_CAST(double, si)/sampNum, ipos[0], ipos[1]);
+      if (_tenFiberMapSample(task, pos, wlen ? dir : NULL, len/sampNum)) {
+        return 1;
+      }
+    }
+  }
+  /* the last vertex, which no segment started at */
+  if (_tenFiberMapSample(task, ipos[1], NULL, 0)) {
+    return 1;
+  }
+  if (task->dens && task->visitNum) {
+    qsort(task->visit, task->visitNum, sizeof(size_t),
+          _tenFiberMapVisitCompare);
+    for (ii=0; ii<task->visitNum; ii++) {
+      if (!ii || task->visit[ii] != task->visit[ii-1]) {
+        task->dens[task->visit[ii]]++;
+      }
+    }
+  }
+  if (task->conn) {
+    task->conn[lab[0] + task->labelNum*lab[1]]++;
+    if (lab[0] != lab[1]) {
+      task->conn[lab[1] + task->labelNum*lab[0]]++;
+    }
+  }
+  return 0;
+}
+
+static void *
+_tenFiberMapWorker(void *_task) {
+  static const char me[]="_tenFiberMapWorker";
+  _tenFiberMapTask *task;
+  unsigned int fiberLo, fiberHi, fiberIdx, fiberNum;
+
+  task = AIR_CAST(_tenFiberMapTask *, _task);
+  fiberNum = task->src->fiberNum;
+  while (1) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    if (*(task->abort)) {
+      fiberLo = fiberHi = fiberNum;
+    } else {
+      fiberLo = *(task->fiberNext);
+      fiberHi = AIR_MIN(fiberLo + _TEN_FIBER_MAP_CHUNK, fiberNum);
+      *(task->fiberNext) = fiberHi;
+    }
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (fiberLo == fiberHi) {
+      break;
+    }
+    for (fiberIdx=fiberLo; fiberIdx<fiberHi; fiberIdx++) {
+      if (_tenFiberMapFiber(task, fiberIdx)) {
+        /* biff is not thread-safe, so add to it only under the mutex */
+        if (task->mutex) {
+          airThreadMutexLock(task->mutex);
+        }
+        biffAddf(TEN, "%s(%u): couldn't allocate visit list for fiber %u",
+                 me, task->threadIdx, fiberIdx);
+        task->error = AIR_TRUE;
+        *(task->abort) = AIR_TRUE;
+        if (task->mutex) {
+          airThreadMutexUnlock(task->mutex);
+        }
+        return _task;
+      }
+    }
+  }
+  return _task;
+}
+
+/*
+** sets up one of the output maps, with the spatial axes (and the space
+** orientation) of nref, which has 3 spatial axes at its end
+*/
+static int
+_tenFiberMapOutput(Nrrd *nout, const Nrrd *nref, int type,
+                   unsigned int rgb) {
+  static const char me[]="_tenFiberMapOutput";
+  size_t size[4];
+  int axmap[4];
+  unsigned int ai, baseDim;
+
+  baseDim = nref->dim - 3;
+  size[0] = 3;
+  axmap[0] = -1;
+  for (ai=0; ai<3; ai++) {
+    size[rgb + ai] = nref->axis[baseDim + ai].size;
+    axmap[rgb + ai] = AIR_CAST(int, baseDim + ai);
+  }
+  if (nrrdMaybeAlloc_nva(nout, type, 3 + rgb, size)) {
+    biffMovef(TEN, NRRD, "%s: couldn't allocate output", me);
+    return 1;
+  }
+  if (nrrdAxisInfoCopy(nout, nref, axmap, NRRD_AXIS_INFO_SIZE_BIT)
+      || nrrdBasicInfoCopy(nout, nref,
+                           NRRD_BASIC_INFO_ALL ^ NRRD_BASIC_INFO_SPACE)) {
+    biffMovef(TEN, NRRD, "%s: couldn't copy orientation", me);
+    return 1;
+  }
+  if (rgb) {
+    nout->axis[0].kind = nrrdKind3Color;
+  }
+  return 0;
+}
+
+static int
+_tenFiberMap(Nrrd *ndens, Nrrd *nrgb, Nrrd *nconn,
+             const _tenFiberMapSrc *src, const gageShape *shape,
+             const Nrrd *nref, int indexSpace, const Nrrd *nlabel,
+             unsigned int supersample, unsigned int threadNum) {
+  static const char me[]="_tenFiberMap";
+  airArray *mop;
+  _tenFiberMapTask *task;
+  airThreadMutex *mutex;
+  unsigned int threadIdx, labelNum, fiberNext, *dens, *conn, failIdx;
+  int abort, hadErr, lab;
+  size_t voxNum, connNum, ii, jj;
+  airULLong *rgbw;
+  float *rgb;
+
+  if (!(ndens || nrgb || nconn)) {
+    biffAddf(TEN, "%s: didn't get any output nrrds", me);
+    return 1;
+  }
+  if (!supersample) {
+    biffAddf(TEN, "%s: need non-zero supersample", me);
+    return 1;
+  }
+  if (!threadNum) {
+    biffAddf(TEN, "%s: need non-zero threadNum", me);
+    return 1;
+  }
+  if (!airThreadCapable) {
+    threadNum = 1;
+  }
+  voxNum = AIR_CAST(size_t, shape->size[0])*shape->size[1]*shape->size[2];
+  labelNum = 0;
+  if (nconn) {
+    if (!nlabel) {
+      biffAddf(TEN, "%s: need label volume for connectivity matrix", me);
+      return 1;
+    }
+    if (!( 3 == nlabel->dim
+           && nrrdTypeBlock != nlabel->type
+           && nrrdTypeIsIntegral[nlabel->type] )) {
+      biffAddf(TEN, "%s: label volume must be 3-D (not %u-D) with an "
+               "integral type (not %s)", me, nlabel->dim,
+               airEnumStr(nrrdType, nlabel->type));
+      return 1;
+    }
+    if (!( shape->size[0] == nlabel->axis[0].size
+           && shape->size[1] == nlabel->axis[1].size
+           && shape->size[2] == nlabel->axis[2].size )) {
+      biffAddf(TEN, "%s: label volume size (%u,%u,%u) != grid (%u,%u,%u)",
+               me, AIR_CAST(unsigned int, nlabel->axis[0].size),
+               AIR_CAST(unsigned int, nlabel->axis[1].size),
+               AIR_CAST(unsigned int, nlabel->axis[2].size),
+               shape->size[0], shape->size[1], shape->size[2]);
+      return 1;
+    }
+    for (ii=0; ii<voxNum; ii++) {
+      lab = nrrdILookup[nlabel->type](nlabel->data, ii);
+      if (lab < 0) {
+        char stmp[AIR_STRLEN_SMALL];
+        biffAddf(TEN, "%s: label[%s] = %d < 0", me,
+                 airSprintSize_t(stmp, ii), lab);
+        return 1;
+      }
+      labelNum = AIR_MAX(labelNum, AIR_CAST(unsigned int, lab) + 1);
+    }
+  }
+  connNum = AIR_CAST(size_t, labelNum)*labelNum;
+
+  mop = airMopNew();
+  if ((ndens && _tenFiberMapOutput(ndens, nref, nrrdTypeUInt, 0))
+      || (nrgb && _tenFiberMapOutput(nrgb, nref, nrrdTypeFloat, 1))) {
+    biffAddf(TEN, "%s: trouble setting up output", me);
+    airMopError(mop); return 1;
+  }
+  if (nconn) {
+    if (nrrdMaybeAlloc_va(nconn, nrrdTypeUInt, 2,
+                          AIR_CAST(size_t, labelNum),
+                          AIR_CAST(size_t, labelNum))) {
+      biffMovef(TEN, NRRD, "%s: couldn't allocate connectivity", me);
+      airMopError(mop); return 1;
+    }
+    /* nrrdMaybeAlloc doesn't zero re-used memory */
+    memset(nconn->data, 0, connNum*sizeof(unsigned int));
+  }
+  if (ndens) {
+    memset(ndens->data, 0, voxNum*sizeof(unsigned int));
+  }
+
+  task = AIR_CALLOC(threadNum, _tenFiberMapTask);
+  if (!task) {
+    biffAddf(TEN, "%s: couldn't allocate %u tasks", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (threadNum > 1) {
+    mutex = airThreadMutexNew();
+    airMopAdd(mop, mutex, (airMopper)airThreadMutexNix, airMopAlways);
+  } else {
+    mutex = NULL;
+  }
+  fiberNext = 0;
+  abort = AIR_FALSE;
+  for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+    task[threadIdx].src = src;
+    task[threadIdx].shape = shape;
+    task[threadIdx].indexSpace = indexSpace;
+    task[threadIdx].supersample = supersample;
+    task[threadIdx].nlabel = nlabel;
+    task[threadIdx].labelNum = labelNum;
+    task[threadIdx].fiberNext = &fiberNext;
+    task[threadIdx].abort = &abort;
+    task[threadIdx].mutex = mutex;
+    task[threadIdx].threadIdx = threadIdx;
+    task[threadIdx].error = AIR_FALSE;
+    /* the first thread accumulates counts right into the output */
+    if (!ndens) {
+      dens = NULL;
+    } else if (!threadIdx) {
+      dens = AIR_CAST(unsigned int *, ndens->data);
+    } else {
+      dens = AIR_CALLOC(voxNum, unsigned int);
+      airMopAdd(mop, dens, airFree, airMopAlways);
+    }
+    if (!nconn) {
+      conn = NULL;
+    } else if (!threadIdx) {
+      conn = AIR_CAST(unsigned int *, nconn->data);
+    } else {
+      conn = AIR_CALLOC(connNum, unsigned int);
+      airMopAdd(mop, conn, airFree, airMopAlways);
+    }
+    if (nrgb) {
+      rgbw = AIR_CALLOC(4*voxNum, airULLong);
+      airMopAdd(mop, rgbw, airFree, airMopAlways);
+    } else {
+      rgbw = NULL;
+    }
+    task[threadIdx].visitSize = 64;
+    task[threadIdx].visit = AIR_CALLOC(task[threadIdx].visitSize, size_t);
+    /* the visit list may be realloc'ed, so it isn't in the mop */
+    if (!( (!ndens || dens) && (!nconn || conn) && (!nrgb || rgbw)
+           && task[threadIdx].visit )) {
+      biffAddf(TEN, "%s: couldn't allocate buffers for thread %u",
+               me, threadIdx);
+      for (ii=0; ii<=threadIdx; ii++) {
+        airFree(task[ii].visit);
+      }
+      airMopError(mop); return 1;
+    }
+    task[threadIdx].dens = dens;
+    task[threadIdx].conn = conn;
+    task[threadIdx].rgbw = rgbw;
+  }
+
+  failIdx = airThreadRun(threadNum, _tenFiberMapWorker, task,
+                         sizeof(_tenFiberMapTask), &abort, mutex);
+  hadErr = AIR_FALSE;
+  for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+    hadErr |= task[threadIdx].error;
+    airFree(task[threadIdx].visit);
+  }
+  if (failIdx) {
+    biffAddf(TEN, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
+  if (hadErr) {
+    biffAddf(TEN, "%s: trouble mapping with %u threads", me, threadNum);
+    airMopError(mop); return 1;
+  }
+
+  /* all the sums are of integers, so the order doesn't matter */
+  for (threadIdx=1; threadIdx<threadNum; threadIdx++) {
+    if (ndens) {
+      dens = AIR_CAST(unsigned int *, ndens->data);
+      for (ii=0; ii<voxNum; ii++) {
+        dens[ii] += task[threadIdx].dens[ii];
+      }
+    }
+    if (nconn) {
+      conn = AIR_CAST(unsigned int *, nconn->data);
+      for (ii=0; ii<connNum; ii++) {
+        conn[ii] += task[threadIdx].conn[ii];
+      }
+    }
+    if (nrgb) {
+      for (ii=0; ii<4*voxNum; ii++) {
+        task[0].rgbw[ii] += task[threadIdx].rgbw[ii];
+      }
+    }
+  }
+  if (nrgb) {
+    rgb = AIR_CAST(float *, nrgb->data);
+    rgbw = task[0].rgbw;
+    for (ii=0; ii<voxNum; ii++) {
+      for (jj=0; jj<3; jj++) {
+        rgb[jj + 3*ii] = (rgbw[3 + 4*ii]
+                          ? AIR_CAST(float, AIR_CAST(double, rgbw[jj + 4*ii])
+                                     /AIR_CAST(double, rgbw[3 + 4*ii]))
+                          : 0.0f);
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** tenFiberMultiMap
+**
+** accumulates maps over the grid of the volume in which the fibers in
+** tfml were traced (by tenFiberMultiTrace{,Parallel} with tfx), any of
+** which can be skipped by passing NULL:
+**
+** ndens: 3-D uint volume of fiber density: the number of fibers that
+** pass through each voxel
+**
+** nrgb: 3-by-X-by-Y-by-Z float volume of mean fiber direction color:
+** in each voxel, the length-weighted average of the absolute values
+** of the world-space unit direction of the fibers passing through it
+**
+** nconn: L-by-L uint connectivity matrix, for labels 0 to L-1 in the
+** integral-valued nlabel (which must be sampled on the same grid):
+** entry (i,j) is the number of fibers with one end in label i and the
+** other end in label j.  Ends outside the grid count as label 0.
+**
+** Fibers are voxelized by sampling each segment at least supersample
+** times per voxel of its length.  The work is done by threadNum
+** threads, each with its own accumulation buffers.  Everything is
+** summed as integers, so the output does not depend on threadNum.
+*/
+int
+tenFiberMultiMap(tenFiberContext *tfx, Nrrd *ndens, Nrrd *nrgb, Nrrd *nconn,
+                 tenFiberMulti *tfml, const Nrrd *nlabel,
+                 unsigned int supersample, unsigned int threadNum) {
+  static const char me[]="tenFiberMultiMap";
+  airArray *mop;
+  _tenFiberMapSrc src;
+  unsigned int fiberIdx;
+
+  if (!(tfx && tfml)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (tenFiberMultiCheck(tfml->fiberArr)) {
+    biffAddf(TEN, "%s: problem with fiber array", me);
+    return 1;
+  }
+  mop = airMopNew();
+  src.pld = NULL;
+  src.tfml = tfml;
+  src.start = AIR_CALLOC(tfml->fiberNum + 1, unsigned int);
+  airMopAdd(mop, src.start, airFree, airMopAlways);
+  src.vertNum = AIR_CALLOC(tfml->fiberNum + 1, unsigned int);
+  airMopAdd(mop, src.vertNum, airFree, airMopAlways);
+  if (!(src.start && src.vertNum)) {
+    biffAddf(TEN, "%s: couldn't allocate fiber list", me);
+    airMopError(mop); return 1;
+  }
+  /* skip the fibers that went nowhere */
+  src.fiberNum = 0;
+  for (fiberIdx=0; fiberIdx<tfml->fiberNum; fiberIdx++) {
+    tenFiberSingle *tfs;
+    tfs = tfml->fiber + fiberIdx;
+    if (tenFiberStopUnknown != tfs->whyNowhere) {
+      continue;
+    }
+    src.start[src.fiberNum] = fiberIdx;
+    src.vertNum[src.fiberNum] = AIR_CAST(unsigned int,
+                                         tfs->nvert->axis[1].size);
+    src.fiberNum++;
+  }
+  if (_tenFiberMap(ndens, nrgb, nconn, &src, tfx->gtx->shape, tfx->nin,
+                   tfx->useIndexSpace, nlabel, supersample, threadNum)) {
+    biffAddf(TEN, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** tenFiberPolyDataMap
+**
+** like tenFiberMultiMap, but for fibers given as the line strips of a
+** limnPolyData, such as from tenFiberMultiPolyData.  The grid is that
+** of nref, a 3-D volume or a 4-D volume with a non-spatial first axis
+** (such as a tensor volume).  The fiber vertices are in the world space
+** of nref, or in its index space if indexSpace is non-zero.
+*/
+int
+tenFiberPolyDataMap(Nrrd *ndens, Nrrd *nrgb, Nrrd *nconn,
+                    const limnPolyData *pld, const Nrrd *nref,
+                    int indexSpace, const Nrrd *nlabel,
+                    unsigned int supersample, unsigned int threadNum) {
+  static const char me[]="tenFiberPolyDataMap";
+  airArray *mop;
+  _tenFiberMapSrc src;
+  gageShape *shape;
+  unsigned int primIdx, indxIdx;
+
+  if (!(pld && nref)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!( 3 == nref->dim || 4 == nref->dim )) {
+    biffAddf(TEN, "%s: reference volume must be 3-D or 4-D (not %u-D)",
+             me, nref->dim);
+    return 1;
+  }
+  mop = airMopNew();
+  shape = gageShapeNew();
+  airMopAdd(mop, shape, (airMopper)gageShapeNix, airMopAlways);
+  if (gageShapeSet(shape, nref, nref->dim - 3)) {
+    biffMovef(TEN, GAGE, "%s: trouble with reference volume", me);
+    airMopError(mop); return 1;
+  }
+  src.pld = pld;
+  src.tfml = NULL;
+  src.start = AIR_CALLOC(pld->primNum + 1, unsigned int);
+  airMopAdd(mop, src.start, airFree, airMopAlways);
+  src.vertNum = AIR_CALLOC(pld->primNum + 1, unsigned int);
+  airMopAdd(mop, src.vertNum, airFree, airMopAlways);
+  if (!(src.start && src.vertNum)) {
+    biffAddf(TEN, "%s: couldn't allocate fiber list", me);
+    airMopError(mop); return 1;
+  }
+  src.fiberNum = 0;
+  indxIdx = 0;
+  for (primIdx=0; primIdx<pld->primNum; primIdx++) {
+    if (limnPrimitiveLineStrip == pld->type[primIdx]) {
+      src.start[src.fiberNum] = indxIdx;
+      src.vertNum[src.fiberNum] = pld->icnt[primIdx];
+      src.fiberNum++;
+    } else if (limnPrimitiveNoop != pld->type[primIdx]) {
+      biffAddf(TEN, "%s: primitive %u is %s, not %s", me, primIdx,
+               airEnumStr(limnPrimitive, pld->type[primIdx]),
+               airEnumStr(limnPrimitive, limnPrimitiveLineStrip));
+      airMopError(mop); return 1;
+    }
+    indxIdx += pld->icnt[primIdx];
+  }
+  if (indxIdx > pld->indxNum) {
+    biffAddf(TEN, "%s: primitives need %u indices, but have only %u",
+             me, indxIdx, pld->indxNum);
+    airMopError(mop); return 1;
+  }
+  if (_tenFiberMap(ndens, nrgb, nconn, &src, shape, nref, indexSpace,
+                   nlabel, supersample, threadNum)) {
+    biffAddf(TEN, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
@@ -201,6 +201,7 @@ _tenFiberContextCommonNew(const Nrrd *vol, int useDwi,
   /* ... don't really see the point of initializing the ten2 stuff here;
      its properly done in tenFiberTraceSet() ... */
   tfx->radius = AIR_NAN;
+  tfx->probeNum = 0;
 
   airMopOkay(mop);
   return tfx;
@@ -845,22 +846,20 @@ tenFiberContextCopy(tenFiberContext *oldTfx) {
   tfx->ksp = nrrdKernelSpecCopy(oldTfx->ksp);
   tfx->gtx = gageContextCopy(oldTfx->gtx);
   tfx->pvl = tfx->gtx->pvl[0];  /* HEY! gage API sucks */
-  tfx->gageTen = gageAnswerPointer(tfx->gtx, tfx->pvl, tenGageTensor);
-  tfx->gageEval = gageAnswerPointer(tfx->gtx, tfx->pvl, tenGageEval0);
-  /* HEY: COPY AND PASTE */
-  tfx->gageEvec
-    = gageAnswerPointer(tfx->gtx, tfx->pvl,
-                        (tenFiberTypeEvec0 == tfx->fiberType
-                         ? tenGageEvec0
-                         : (tenFiberTypeEvec1 == tfx->fiberType
-                            ? tenGageEvec1
-                            : tenGageEvec2)));
-  tfx->gageAnisoStop = gageAnswerPointer(tfx->gtx, tfx->pvl,
-                                         tfx->anisoStopType);
-  tfx->gageAnisoSpeed = (tfx->anisoSpeedType
-                         ? gageAnswerPointer(tfx->gtx, tfx->pvl,
-                                             tfx->anisoSpeedType)
-                         : NULL);
+  /* the answer pointers were set (by tenFiberTypeSet, tenFiberStopSet,
+     tenFiberAnisoSpeedSet) to point into oldTfx->pvl->answer; point them
+     to the same place in the new answer buffer, rather than trying to
+     re-learn which gage items they were for */
+#define REBASE(P) (P = (P                                              \
+                        ? tfx->pvl->answer + (P - oldTfx->pvl->answer)  \
+                        : NULL))
+  REBASE(tfx->gageTen);
+  REBASE(tfx->gageEval);
+  REBASE(tfx->gageEvec);
+  REBASE(tfx->gageAnisoStop);
+  REBASE(tfx->gageAnisoSpeed);
+  REBASE(tfx->gageTen2);
+#undef REBASE
   return tfx;
 }
 
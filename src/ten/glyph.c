@@ -59,6 +59,9 @@ tenGlyphParmNew() {
     parm->sliceOffset = 0.0;
     parm->sliceBias = 0.05f;
     parm->sliceGamma = 1.0;
+
+    parm->threadNum = 1;
+    parm->shapeRes = 10;
   }
   return parm;
 }
@@ -102,6 +105,11 @@ tenGlyphParmCheck(tenGlyphParm *parm,
              me, parm->glyphType);
     return 1;
   }
+  if (!( parm->threadNum >= 1 && parm->shapeRes >= 1 )) {
+    biffAddf(TEN, "%s: threadNum (%u) and shapeRes (%u) must be >= 1",
+             me, parm->threadNum, parm->shapeRes);
+    return 1;
+  }
   if (!( parm->glyphScale > 0)) {
     biffAddf(TEN, "%s: glyphScale must be > 0 (not %g)", me, parm->glyphScale);
     return 1;
@@ -180,6 +188,296 @@ tenGlyphParmCheck(tenGlyphParm *parm,
   return 0;
 }
 
+/*
+** The per-glyph computations shared by tenGlyphGen and
+** tenGlyphInstanceGen.  None of these use biff or any state outside
+** their arguments, so they can be called from multiple threads.
+*/
+
+/*
+** sets msFr to the measurement frame transform of nten (or identity)
+*/
+static void
+_tenGlyphMeasurementFrame(double msFr[9], const Nrrd *nten) {
+
+  if (3 == nten->spaceDim
+      && AIR_EXISTS(nten->measurementFrame[0][0])) {
+    /*     msFr        nten->measurementFrame
+    **   0  1  2      [0][0]   [1][0]   [2][0]
+    **   3  4  5      [0][1]   [1][1]   [2][1]
+    **   6  7  8      [0][2]   [1][2]   [2][2]
+    */
+    msFr[0] = nten->measurementFrame[0][0];
+    msFr[3] = nten->measurementFrame[0][1];
+    msFr[6] = nten->measurementFrame[0][2];
+    msFr[1] = nten->measurementFrame[1][0];
+    msFr[4] = nten->measurementFrame[1][1];
+    msFr[7] = nten->measurementFrame[1][2];
+    msFr[2] = nten->measurementFrame[2][0];
+    msFr[5] = nten->measurementFrame[2][1];
+    msFr[8] = nten->measurementFrame[2][2];
+  } else {
+    ELL_3M_IDENTITY_SET(msFr);
+  }
+  return;
+}
+
+/*
+** _tenGlyphLocate
+**
+** finds the world-space (pW) and, without npos, index-space (pI)
+** position of glyph idx.  Returns non-zero if there is a tensor to
+** show there: its data and position exist, and it isn't masked out.
+*/
+static int
+_tenGlyphLocate(double pW[3], double pI[3], const char *me,
+                const tenGlyphParm *parm, const gageShape *shape,
+                const Nrrd *nten, const Nrrd *npos,
+                int idx, int numGlyphs) {
+  const float *tdata;
+
+  tdata = (const float*)(nten->data) + 7*idx;
+  if (!( TEN_T_EXISTS(tdata) )) {
+    /* there's nothing we can do here */
+    if (parm->verbose >= 2) {
+      fprintf(stderr, "%s: glyph %d/%d: non-existent data\n",
+              me, idx, numGlyphs);
+    }
+    return AIR_FALSE;
+  }
+  if (npos) {
+    ELL_3V_COPY(pW, (const float*)(npos->data) + 3*idx);
+    if (!( AIR_EXISTS(pW[0]) && AIR_EXISTS(pW[1]) && AIR_EXISTS(pW[2]) )) {
+      /* position doesn't exist- perhaps because its from the push
+         library, which might kill points by setting coords to nan */
+      return AIR_FALSE;
+    }
+  } else {
+    NRRD_COORD_GEN(pI, shape->size, 3, idx);
+    /* this does take into account full orientation */
+    gageShapeItoW(shape, pW, pI);
+    if (parm->nmask) {
+      if (!( nrrdFLookup[parm->nmask->type](parm->nmask->data, idx)
+             >= parm->maskThresh )) {
+        if (parm->verbose >= 2) {
+          fprintf(stderr, "%s: glyph %d/%d: doesn't meet mask thresh\n",
+                  me, idx, numGlyphs);
+        }
+        return AIR_FALSE;
+      }
+    }
+  }
+  return AIR_TRUE;
+}
+
+/*
+** eigensystem of tdata, with the eigenvectors (rows of evec, and
+** columns of rotEvec) transformed by the measurement frame msFr
+*/
+static void
+_tenGlyphEigen(float eval[3], float evec[9], float rotEvec[9],
+               const float *tdata, const double msFr[9]) {
+  double tmpvec[3];
+
+  tenEigensolve_f(eval, evec, tdata);
+  /* transform eigenvectors by measurement frame */
+  ELL_3MV_MUL(tmpvec, msFr, evec + 0);
+  ELL_3V_COPY_TT(evec + 0, float, tmpvec);
+  ELL_3MV_MUL(tmpvec, msFr, evec + 3);
+  ELL_3V_COPY_TT(evec + 3, float, tmpvec);
+  ELL_3MV_MUL(tmpvec, msFr, evec + 6);
+  ELL_3V_COPY_TT(evec + 6, float, tmpvec);
+  ELL_3V_CROSS(tmpvec, evec + 0, evec + 3);
+  if (0 > ELL_3V_DOT(tmpvec, evec + 6)) {
+    ELL_3V_SCALE(evec + 6, -1, evec + 6);
+  }
+  ELL_3M_TRANSPOSE(rotEvec, evec);
+  return;
+}
+
+/*
+** returns non-zero if the glyph should not be shown, because of
+** its eigenvalue signs, confidence, or anisotropy
+*/
+static int
+_tenGlyphCull(const char *me, const tenGlyphParm *parm,
+              const float eval[3], const float *tdata,
+              int idx, int numGlyphs) {
+
+  if (parm->onlyPositive) {
+    if (eval[2] < 0) {
+      /* didn't have all positive eigenvalues, its outta here */
+      if (parm->verbose >= 2) {
+        fprintf(stderr, "%s: glyph %d/%d: not all evals %g %g %g > 0\n",
+                me, idx, numGlyphs, eval[0], eval[1], eval[2]);
+      }
+      return AIR_TRUE;
+    }
+  }
+  if (!( tdata[0] >= parm->confThresh )) {
+    if (parm->verbose >= 2) {
+      fprintf(stderr, "%s: glyph %d/%d: conf %g < thresh %g\n",
+              me, idx, numGlyphs, tdata[0], parm->confThresh);
+    }
+    return AIR_TRUE;
+  }
+  if (!( tenAnisoEval_f(eval, parm->anisoType) >= parm->anisoThresh )) {
+    if (parm->verbose >= 2) {
+      fprintf(stderr, "%s: glyph %d/%d: aniso[%d] %g < thresh %g\n",
+              me, idx, numGlyphs, parm->anisoType,
+              tenAnisoEval_f(eval, parm->anisoType), parm->anisoThresh);
+    }
+    return AIR_TRUE;
+  }
+  return AIR_FALSE;
+}
+
+/*
+** _tenGlyphAttr
+**
+** finds, for a glyph that will be shown, its transform mA (from glyph
+** to world space), its color rgb, and its shape: the axis along which
+** the glyph is polygonalized, and the superquadric exponents qq[]
+*/
+static void
+_tenGlyphAttr(double mA[16], double rgb[3], int *axisP, double qq[3],
+              const tenGlyphParm *parm, const float eval[3],
+              const float evec[9], const float rotEvec[9],
+              const double pW[3]) {
+  const float *cvec;
+  float absEval[3], glyphScl[3];
+  double mB[16], cl, cp, glyphAniso, R, G, B;
+  int axis;
+
+  glyphAniso = tenAnisoEval_f(eval, parm->colAnisoType);
+
+  /* set transform (in mA) */
+  ELL_3V_ABS(absEval, eval);
+  ELL_4M_IDENTITY_SET(mA);                        /* reset */
+  ELL_3V_SCALE(glyphScl, parm->glyphScale, absEval); /* scale by evals */
+  ELL_4M_SCALE_SET(mB, glyphScl[0], glyphScl[1], glyphScl[2]);
+
+  ell_4m_post_mul_d(mA, mB);
+  ELL_43M_INSET(mB, rotEvec);                     /* rotate by evecs */
+  ell_4m_post_mul_d(mA, mB);
+  ELL_4M_TRANSLATE_SET(mB, pW[0], pW[1], pW[2]);  /* translate */
+  ell_4m_post_mul_d(mA, mB);
+
+  /* set color (in R,G,B) */
+  cvec = evec + 3*(AIR_CLAMP(0, parm->colEvec, 2));
+  R = AIR_ABS(cvec[0]);                           /* standard mapping */
+  G = AIR_ABS(cvec[1]);
+  B = AIR_ABS(cvec[2]);
+  /* desaturate by colMaxSat */
+  R = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, R);
+  G = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, G);
+  B = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, B);
+  /* desaturate some by anisotropy */
+  R = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0,
+                 R, AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, R));
+  G = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0,
+                 G, AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, G));
+  B = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0,
+                 B, AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, B));
+  /* clamp and do gamma */
+  R = AIR_CLAMP(0.0, R, 1.0);
+  G = AIR_CLAMP(0.0, G, 1.0);
+  B = AIR_CLAMP(0.0, B, 1.0);
+  rgb[0] = pow(R, parm->colGamma);
+  rgb[1] = pow(G, parm->colGamma);
+  rgb[2] = pow(B, parm->colGamma);
+
+  /* find axis, and superquad exponents qq[0] and qq[1] (qA and qB) */
+  if (eval[2] > 0) {
+    /* all evals positive */
+    cl = AIR_MIN(0.99, tenAnisoEval_f(eval, tenAniso_Cl1));
+    cp = AIR_MIN(0.99, tenAnisoEval_f(eval, tenAniso_Cp1));
+    if (cl > cp) {
+      axis = 0;
+      qq[0] = pow(1-cp, parm->sqdSharp);
+      qq[1] = pow(1-cl, parm->sqdSharp);
+    } else {
+      axis = 2;
+      qq[0] = pow(1-cl, parm->sqdSharp);
+      qq[1] = pow(1-cp, parm->sqdSharp);
+    }
+    qq[2] = qq[1];
+  } else if (eval[0] < 0) {
+    /* all evals negative */
+    float aef[3];
+    aef[0] = absEval[2];
+    aef[1] = absEval[1];
+    aef[2] = absEval[0];
+    cl = AIR_MIN(0.99, tenAnisoEval_f(aef, tenAniso_Cl1));
+    cp = AIR_MIN(0.99, tenAnisoEval_f(aef, tenAniso_Cp1));
+    if (cl > cp) {
+      axis = 2;
+      qq[0] = pow(1-cp, parm->sqdSharp);
+      qq[1] = pow(1-cl, parm->sqdSharp);
+    } else {
+      axis = 0;
+      qq[0] = pow(1-cl, parm->sqdSharp);
+      qq[1] = pow(1-cp, parm->sqdSharp);
+    }
+    qq[2] = qq[1];
+  } else {
+#define OOSQRT2 0.70710678118654752440
+#define OOSQRT3 0.57735026918962576451
+    /* double poleA[3]={OOSQRT3, OOSQRT3, OOSQRT3}; */
+    double poleB[3]={1, 0, 0};
+    double poleC[3]={OOSQRT2, OOSQRT2, 0};
+    double poleD[3]={OOSQRT3, -OOSQRT3, -OOSQRT3};
+    double poleE[3]={OOSQRT2, 0, -OOSQRT2};
+    double poleF[3]={OOSQRT3, OOSQRT3, -OOSQRT3};
+    double poleG[3]={0, -OOSQRT2, -OOSQRT2};
+    double poleH[3]={0, 0, -1};
+    /* double poleI[3]={-OOSQRT3, -OOSQRT3, -OOSQRT3}; */
+    double funk[3]={0,4,2}, thrn[3]={1,4,4};
+    double octa[3]={0,2,2}, cone[3]={1,2,2};
+    double evalN[3], tmp, bary[3];
+
+    ELL_3V_NORM(evalN, eval, tmp);
+    if (eval[1] >= -eval[2]) {
+      /* inside B-F-C */
+      ell_3v_barycentric_spherical_d(bary, poleB, poleF, poleC, evalN);
+      ELL_3V_SCALE_ADD3(qq, bary[0], octa, bary[1], thrn, bary[2], cone);
+      axis = 2;
+    } else if (eval[0] >= -eval[2]) {
+      /* inside B-D-F */
+      if (eval[1] >= 0) {
+        /* inside B-E-F */
+        ell_3v_barycentric_spherical_d(bary, poleB, poleE, poleF, evalN);
+        ELL_3V_SCALE_ADD3(qq, bary[0], octa, bary[1], funk, bary[2], thrn);
+        axis = 2;
+      } else {
+        /* inside B-D-E */
+        ell_3v_barycentric_spherical_d(bary, poleB, poleD, poleE, evalN);
+        ELL_3V_SCALE_ADD3(qq, bary[0], cone, bary[1], thrn, bary[2], funk);
+        axis = 0;
+      }
+    } else if (eval[0] < -eval[1]) {
+      /* inside D-G-H */
+      ell_3v_barycentric_spherical_d(bary, poleD, poleG, poleH, evalN);
+      ELL_3V_SCALE_ADD3(qq, bary[0], thrn, bary[1], cone, bary[2], octa);
+      axis = 0;
+    } else if (eval[1] < 0) {
+      /* inside E-D-H */
+      ell_3v_barycentric_spherical_d(bary, poleE, poleD, poleH, evalN);
+      ELL_3V_SCALE_ADD3(qq, bary[0], funk, bary[1], thrn, bary[2], octa);
+      axis = 0;
+    } else {
+      /* inside F-E-H */
+      ell_3v_barycentric_spherical_d(bary, poleF, poleE, poleH, evalN);
+      ELL_3V_SCALE_ADD3(qq, bary[0], thrn, bary[1], funk, bary[2], cone);
+      axis = 2;
+    }
+#undef OOSQRT2
+#undef OOSQRT3
+  }
+  *axisP = axis;
+  return;
+}
+
 int
 tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
             tenGlyphParm *parm,
@@ -187,10 +485,9 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
   static const char me[]="tenGlyphGen";
   gageShape *shape;
   airArray *mop;
-  float *tdata, eval[3], evec[9], *cvec, rotEvec[9], mA_f[16],
-    absEval[3], glyphScl[3];
-  double pI[3], pW[3], cl, cp, sRot[16], mA[16], mB[16], msFr[9], tmpvec[3],
-    R, G, B, qA, qB, qC, glyphAniso, sliceGray;
+  float *tdata, eval[3], evec[9], rotEvec[9], mA_f[16];
+  double pI[3], pW[3], sRot[16], mA[16], mB[16], msFr[9],
+    rgb[3], qq[3], sliceGray;
   unsigned int duh;
   int slcCoord[3], idx, glyphIdx, axis, numGlyphs,
     svRGBAfl=AIR_FALSE;
@@ -282,26 +579,7 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
   } else {
     numGlyphs = shape->size[0] * shape->size[1] * shape->size[2];
   }
-  /* find measurement frame transform */
-  if (3 == nten->spaceDim
-      && AIR_EXISTS(nten->measurementFrame[0][0])) {
-    /*     msFr        nten->measurementFrame
-    **   0  1  2      [0][0]   [1][0]   [2][0]
-    **   3  4  5      [0][1]   [1][1]   [2][1]
-    **   6  7  8      [0][2]   [1][2]   [2][2]
-    */
-    msFr[0] = nten->measurementFrame[0][0];
-    msFr[3] = nten->measurementFrame[0][1];
-    msFr[6] = nten->measurementFrame[0][2];
-    msFr[1] = nten->measurementFrame[1][0];
-    msFr[4] = nten->measurementFrame[1][1];
-    msFr[7] = nten->measurementFrame[1][2];
-    msFr[2] = nten->measurementFrame[2][0];
-    msFr[5] = nten->measurementFrame[2][1];
-    msFr[8] = nten->measurementFrame[2][2];
-  } else {
-    ELL_3M_IDENTITY_SET(msFr);
-  }
+  _tenGlyphMeasurementFrame(msFr, nten);
   for (idx=0; idx<numGlyphs; idx++) {
     tdata = (float*)(nten->data) + 7*idx;
     if (parm->verbose >= 2) {
@@ -310,49 +588,11 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
               tdata[1], tdata[2], tdata[3],
               tdata[4], tdata[5], tdata[6]);
     }
-    if (!( TEN_T_EXISTS(tdata) )) {
-      /* there's nothing we can do here */
-      if (parm->verbose >= 2) {
-        fprintf(stderr, "%s: glyph %d/%d: non-existent data\n",
-                me, idx, numGlyphs);
-      }
+    if (!_tenGlyphLocate(pW, pI, me, parm, shape, nten, npos,
+                         idx, numGlyphs)) {
       continue;
     }
-    if (npos) {
-      ELL_3V_COPY(pW, (float*)(npos->data) + 3*idx);
-      if (!( AIR_EXISTS(pW[0]) && AIR_EXISTS(pW[1]) && AIR_EXISTS(pW[2]) )) {
-        /* position doesn't exist- perhaps because its from the push
-           library, which might kill points by setting coords to nan */
-        continue;
-      }
-    } else {
-      NRRD_COORD_GEN(pI, shape->size, 3, idx);
-      /* this does take into account full orientation */
-      gageShapeItoW(shape, pW, pI);
-      if (parm->nmask) {
-        if (!( nrrdFLookup[parm->nmask->type](parm->nmask->data, idx)
-               >= parm->maskThresh )) {
-          if (parm->verbose >= 2) {
-            fprintf(stderr, "%s: glyph %d/%d: doesn't meet mask thresh\n",
-                    me, idx, numGlyphs);
-          }
-          continue;
-        }
-      }
-    }
-    tenEigensolve_f(eval, evec, tdata);
-    /* transform eigenvectors by measurement frame */
-    ELL_3MV_MUL(tmpvec, msFr, evec + 0);
-    ELL_3V_COPY_TT(evec + 0, float, tmpvec);
-    ELL_3MV_MUL(tmpvec, msFr, evec + 3);
-    ELL_3V_COPY_TT(evec + 3, float, tmpvec);
-    ELL_3MV_MUL(tmpvec, msFr, evec + 6);
-    ELL_3V_COPY_TT(evec + 6, float, tmpvec);
-    ELL_3V_CROSS(tmpvec, evec + 0, evec + 3);
-    if (0 > ELL_3V_DOT(tmpvec, evec + 6)) {
-      ELL_3V_SCALE(evec + 6, -1, evec + 6);
-    }
-    ELL_3M_TRANSPOSE(rotEvec, evec);
+    _tenGlyphEigen(eval, evec, rotEvec, tdata, msFr);
     if (parm->doSlice
         && pI[parm->sliceAxis] == parm->slicePos) {
       /* set sliceGray */
@@ -432,169 +672,10 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
         echoListAdd(list, esquare);
       }
     }
-    if (parm->onlyPositive) {
-      if (eval[2] < 0) {
-        /* didn't have all positive eigenvalues, its outta here */
-        if (parm->verbose >= 2) {
-          fprintf(stderr, "%s: glyph %d/%d: not all evals %g %g %g > 0\n",
-                  me, idx, numGlyphs, eval[0], eval[1], eval[2]);
-        }
-        continue;
-      }
-    }
-    if (!( tdata[0] >= parm->confThresh )) {
-      if (parm->verbose >= 2) {
-        fprintf(stderr, "%s: glyph %d/%d: conf %g < thresh %g\n",
-                me, idx, numGlyphs, tdata[0], parm->confThresh);
-      }
-      continue;
-    }
-    if (!( tenAnisoEval_f(eval, parm->anisoType) >= parm->anisoThresh )) {
-      if (parm->verbose >= 2) {
-        fprintf(stderr, "%s: glyph %d/%d: aniso[%d] %g < thresh %g\n",
-                me, idx, numGlyphs, parm->anisoType,
-                tenAnisoEval_f(eval, parm->anisoType), parm->anisoThresh);
-      }
+    if (_tenGlyphCull(me, parm, eval, tdata, idx, numGlyphs)) {
       continue;
     }
-    glyphAniso = tenAnisoEval_f(eval, parm->colAnisoType);
-    /*
-      fprintf(stderr, "%s: eret = %d; evals = %g %g %g\n", me,
-      eret, eval[0], eval[1], eval[2]);
-      ELL_3V_CROSS(tmp1, evec+0, evec+3); tmp2[0] = ELL_3V_LEN(tmp1);
-      ELL_3V_CROSS(tmp1, evec+0, evec+6); tmp2[1] = ELL_3V_LEN(tmp1);
-      ELL_3V_CROSS(tmp1, evec+3, evec+6); tmp2[2] = ELL_3V_LEN(tmp1);
-      fprintf(stderr, "%s: crosses = %g %g %g\n", me,
-      tmp2[0], tmp2[1], tmp2[2]);
-    */
-
-    /* set transform (in mA) */
-    ELL_3V_ABS(absEval, eval);
-    ELL_4M_IDENTITY_SET(mA);                        /* reset */
-    ELL_3V_SCALE(glyphScl, parm->glyphScale, absEval); /* scale by evals */
-    ELL_4M_SCALE_SET(mB, glyphScl[0], glyphScl[1], glyphScl[2]);
-
-    ell_4m_post_mul_d(mA, mB);
-    ELL_43M_INSET(mB, rotEvec);                     /* rotate by evecs */
-    ell_4m_post_mul_d(mA, mB);
-    ELL_4M_TRANSLATE_SET(mB, pW[0], pW[1], pW[2]);  /* translate */
-    ell_4m_post_mul_d(mA, mB);
-
-    /* set color (in R,G,B) */
-    cvec = evec + 3*(AIR_CLAMP(0, parm->colEvec, 2));
-    R = AIR_ABS(cvec[0]);                           /* standard mapping */
-    G = AIR_ABS(cvec[1]);
-    B = AIR_ABS(cvec[2]);
-    /* desaturate by colMaxSat */
-    R = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, R);
-    G = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, G);
-    B = AIR_AFFINE(0.0, parm->colMaxSat, 1.0, parm->colIsoGray, B);
-    /* desaturate some by anisotropy */
-    R = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0,
-                   R, AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, R));
-    G = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0,
-                   G, AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, G));
-    B = AIR_AFFINE(0.0, parm->colAnisoModulate, 1.0,
-                   B, AIR_AFFINE(0.0, glyphAniso, 1.0, parm->colIsoGray, B));
-    /* clamp and do gamma */
-    R = AIR_CLAMP(0.0, R, 1.0);
-    G = AIR_CLAMP(0.0, G, 1.0);
-    B = AIR_CLAMP(0.0, B, 1.0);
-    R = pow(R, parm->colGamma);
-    G = pow(G, parm->colGamma);
-    B = pow(B, parm->colGamma);
-
-    /* find axis, and superquad exponents qA and qB */
-    if (eval[2] > 0) {
-      /* all evals positive */
-      cl = AIR_MIN(0.99, tenAnisoEval_f(eval, tenAniso_Cl1));
-      cp = AIR_MIN(0.99, tenAnisoEval_f(eval, tenAniso_Cp1));
-      if (cl > cp) {
-        axis = 0;
-        qA = pow(1-cp, parm->sqdSharp);
-        qB = pow(1-cl, parm->sqdSharp);
-      } else {
-        axis = 2;
-        qA = pow(1-cl, parm->sqdSharp);
-        qB = pow(1-cp, parm->sqdSharp);
-      }
-      qC = qB;
-    } else if (eval[0] < 0) {
-      /* all evals negative */
-      float aef[3];
-      aef[0] = absEval[2];
-      aef[1] = absEval[1];
-      aef[2] = absEval[0];
-      cl = AIR_MIN(0.99, tenAnisoEval_f(aef, tenAniso_Cl1));
-      cp = AIR_MIN(0.99, tenAnisoEval_f(aef, tenAniso_Cp1));
-      if (cl > cp) {
-        axis = 2;
-        qA = pow(1-cp, parm->sqdSharp);
-        qB = pow(1-cl, parm->sqdSharp);
-      } else {
-        axis = 0;
-        qA = pow(1-cl, parm->sqdSharp);
-        qB = pow(1-cp, parm->sqdSharp);
-      }
-      qC = qB;
-    } else {
-#define OOSQRT2 0.70710678118654752440
-#define OOSQRT3 0.57735026918962576451
-      /* double poleA[3]={OOSQRT3, OOSQRT3, OOSQRT3}; */
-      double poleB[3]={1, 0, 0};
-      double poleC[3]={OOSQRT2, OOSQRT2, 0};
-      double poleD[3]={OOSQRT3, -OOSQRT3, -OOSQRT3};
-      double poleE[3]={OOSQRT2, 0, -OOSQRT2};
-      double poleF[3]={OOSQRT3, OOSQRT3, -OOSQRT3};
-      double poleG[3]={0, -OOSQRT2, -OOSQRT2};
-      double poleH[3]={0, 0, -1};
-      /* double poleI[3]={-OOSQRT3, -OOSQRT3, -OOSQRT3}; */
-      double funk[3]={0,4,2}, thrn[3]={1,4,4};
-      double octa[3]={0,2,2}, cone[3]={1,2,2};
-      double evalN[3], tmp, bary[3];
-      double qq[3];
-
-      ELL_3V_NORM(evalN, eval, tmp);
-      if (eval[1] >= -eval[2]) {
-        /* inside B-F-C */
-        ell_3v_barycentric_spherical_d(bary, poleB, poleF, poleC, evalN);
-        ELL_3V_SCALE_ADD3(qq, bary[0], octa, bary[1], thrn, bary[2], cone);
-        axis = 2;
-      } else if (eval[0] >= -eval[2]) {
-        /* inside B-D-F */
-        if (eval[1] >= 0) {
-          /* inside B-E-F */
-          ell_3v_barycentric_spherical_d(bary, poleB, poleE, poleF, evalN);
-          ELL_3V_SCALE_ADD3(qq, bary[0], octa, bary[1], funk, bary[2], thrn);
-          axis = 2;
-        } else {
-          /* inside B-D-E */
-          ell_3v_barycentric_spherical_d(bary, poleB, poleD, poleE, evalN);
-          ELL_3V_SCALE_ADD3(qq, bary[0], cone, bary[1], thrn, bary[2], funk);
-          axis = 0;
-        }
-      } else if (eval[0] < -eval[1]) {
-        /* inside D-G-H */
-        ell_3v_barycentric_spherical_d(bary, poleD, poleG, poleH, evalN);
-        ELL_3V_SCALE_ADD3(qq, bary[0], thrn, bary[1], cone, bary[2], octa);
-        axis = 0;
-      } else if (eval[1] < 0) {
-        /* inside E-D-H */
-        ell_3v_barycentric_spherical_d(bary, poleE, poleD, poleH, evalN);
-        ELL_3V_SCALE_ADD3(qq, bary[0], funk, bary[1], thrn, bary[2], octa);
-        axis = 0;
-      } else {
-        /* inside F-E-H */
-        ell_3v_barycentric_spherical_d(bary, poleF, poleE, poleH, evalN);
-        ELL_3V_SCALE_ADD3(qq, bary[0], thrn, bary[1], funk, bary[2], cone);
-        axis = 2;
-      }
-      qA = qq[0];
-      qB = qq[1];
-      qC = qq[2];
-#undef OOSQRT2
-#undef OOSQRT3
-    }
+    _tenGlyphAttr(mA, rgb, &axis, qq, parm, eval, evec, rotEvec, pW);
 
     /* add the glyph */
     if (parm->verbose >= 2) {
@@ -604,7 +685,7 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
     if (glyphsLimn) {
       lookIdx = limnObjectLookAdd(glyphsLimn);
       look = glyphsLimn->look + lookIdx;
-      ELL_4V_SET_TT(look->rgba, float, R, G, B, 1);
+      ELL_4V_SET_TT(look->rgba, float, rgb[0], rgb[1], rgb[2], 1);
       ELL_3V_SET(look->kads, parm->ADSP[0], parm->ADSP[1], parm->ADSP[2]);
       look->spow = 0;
       switch(parm->glyphType) {
@@ -623,9 +704,9 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
       default:
         glyphIdx =
           limnObjectPolarSuperquadFancyAdd(glyphsLimn, lookIdx, axis,
-                                           AIR_CAST(float, qA),
-                                           AIR_CAST(float, qB),
-                                           AIR_CAST(float, qC), 0,
+                                           AIR_CAST(float, qq[0]),
+                                           AIR_CAST(float, qq[1]),
+                                           AIR_CAST(float, qq[2]), 0,
                                            2*parm->facetRes,
                                            parm->facetRes);
         break;
@@ -650,13 +731,13 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
       case tenGlyphTypeSuperquad:
       default:
         eglyph = echoObjectNew(glyphsEcho, echoTypeSuperquad);
-        echoSuperquadSet(eglyph, axis, qA, qB);
+        echoSuperquadSet(eglyph, axis, qq[0], qq[1]);
         break;
       }
       echoColorSet(eglyph,
-                   AIR_CAST(echoCol_t, R),
-                   AIR_CAST(echoCol_t, G),
-                   AIR_CAST(echoCol_t, B), 1);
+                   AIR_CAST(echoCol_t, rgb[0]),
+                   AIR_CAST(echoCol_t, rgb[1]),
+                   AIR_CAST(echoCol_t, rgb[2]), 1);
       echoMatterPhongSet(glyphsEcho, eglyph,
                          parm->ADSP[0], parm->ADSP[1],
                          parm->ADSP[2], parm->ADSP[3]);
@@ -678,6 +759,649 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
   return 0;
 }
 
+tenGlyphInstance *
+tenGlyphInstanceNew() {
+  tenGlyphInstance *gin;
+
+  gin = AIR_CALLOC(1, tenGlyphInstance);
+  if (gin) {
+    gin->shape = NULL;
+    gin->shapeNum = 0;
+    gin->shapeArr = airArrayNew(AIR_CAST(void **, &(gin->shape)),
+                                &(gin->shapeNum), sizeof(limnPolyData *), 8);
+    airArrayPointerCB(gin->shapeArr,
+                      AIR_CAST(void *(*)(void), limnPolyDataNew),
+                      AIR_CAST(void *(*)(void *), limnPolyDataNix));
+    gin->nshape = nrrdNew();
+    gin->nxform = nrrdNew();
+    gin->nrgba = nrrdNew();
+  }
+  return gin;
+}
+
+tenGlyphInstance *
+tenGlyphInstanceNix(tenGlyphInstance *gin) {
+
+  if (gin) {
+    airArrayNuke(gin->shapeArr);
+    nrrdNuke(gin->nshape);
+    nrrdNuke(gin->nxform);
+    nrrdNuke(gin->nrgba);
+    airFree(gin);
+  }
+  return NULL;
+}
+
+/*
+** _tenGlyphShapeMake
+**
+** polygonalizes one glyph shape, with unit-length normals, in the same
+** way (and with the same resolution) as tenGlyphGen does for limnObjects
+*/
+static int
+_tenGlyphShapeMake(limnPolyData *pld, const tenGlyphParm *parm,
+                   int axis, double qA, double qB, double qC) {
+  static const char me[]="_tenGlyphShapeMake";
+  unsigned int vi, res;
+  float *xyz, *norm, tmp[3], len;
+  int ret, fancy;
+
+  res = AIR_UINT(parm->facetRes);
+  fancy = AIR_FALSE;
+  switch(parm->glyphType) {
+  case tenGlyphTypeBox:
+    ret = limnPolyDataCube(pld, 1 << limnPolyDataInfoNorm, AIR_TRUE);
+    break;
+  case tenGlyphTypeSphere:
+    ret = limnPolyDataPolarSphere(pld, 1 << limnPolyDataInfoNorm,
+                                  2*res, res);
+    break;
+  case tenGlyphTypeCylinder:
+    ret = limnPolyDataCylinder(pld, 1 << limnPolyDataInfoNorm,
+                               res, AIR_TRUE);
+    break;
+  case tenGlyphTypeSuperquad:
+  default:
+    ret = limnPolyDataSuperquadric(pld, 1 << limnPolyDataInfoNorm,
+                                   AIR_CAST(float, qA), AIR_CAST(float, qB),
+                                   2*res, res);
+    fancy = (qC != qB);
+    break;
+  }
+  if (ret) {
+    biffMovef(TEN, LIMN, "%s: couldn't make %s glyph", me,
+              airEnumStr(tenGlyphType, parm->glyphType));
+    return 1;
+  }
+  if (fancy) {
+    /* as in limnObjectPolarSuperquadFancyAdd: modify profile along
+       y axis to create beta=C */
+    for (vi=0; vi<pld->xyzwNum; vi++) {
+      double yp, ymax;
+      xyz = pld->xyzw + 4*vi;
+      ymax = pow(sqrt(AIR_MAX(0, 1 - pow(AIR_ABS(xyz[2]), 2/qB))), qB);
+      yp = airSgnPow(sin(acos(airSgnPow(xyz[2], 1/qC))), qC);
+      if (ymax) {
+        xyz[1] = AIR_CAST(float, xyz[1]*yp/ymax);
+      }
+    }
+    if (limnPolyDataVertexNormals(pld)) {
+      biffMovef(TEN, LIMN, "%s: couldn't find normals", me);
+      return 1;
+    }
+  }
+  for (vi=0; vi<pld->xyzwNum; vi++) {
+    xyz = pld->xyzw + 4*vi;
+    norm = pld->norm + 3*vi;
+    len = AIR_CAST(float, ELL_3V_LEN(norm));
+    if (len) {
+      ELL_3V_SCALE(norm, 1/len, norm);
+    }
+    if (tenGlyphTypeBox != parm->glyphType) {
+      /* the shapes above have their axis along Z; rotate to axis */
+      switch(axis) {
+      case 0:
+        ELL_3V_SET(tmp, xyz[2], -xyz[1], xyz[0]);
+        ELL_3V_COPY(xyz, tmp);
+        ELL_3V_SET(tmp, norm[2], -norm[1], norm[0]);
+        ELL_3V_COPY(norm, tmp);
+        break;
+      case 1:
+        ELL_3V_SET(tmp, xyz[1], xyz[2], xyz[0]);
+        ELL_3V_COPY(xyz, tmp);
+        ELL_3V_SET(tmp, norm[1], norm[2], norm[0]);
+        ELL_3V_COPY(norm, tmp);
+        break;
+      }
+    }
+  }
+  return 0;
+}
+
+/*
+** The per-glyph work of tenGlyphInstanceGen is done in chunks of
+** _TEN_GLYPH_CHUNK glyphs, handed out one at a time to parm->threadNum
+** threads (as in tenFiberMultiTraceParallel).  Each chunk saves its
+** glyphs into its own record array, so the glyph order (and the output)
+** doesn't depend on threadNum.
+*/
+#define _TEN_GLYPH_CHUNK 4096
+
+typedef struct {
+  float xform[16], qq[3];
+  unsigned char rgba[4];
+  int axis;
+} _tenGlyphRec;
+
+typedef struct {
+  /* shared (same for all threads) */
+  const tenGlyphParm *parm;
+  const gageShape *shape;
+  const Nrrd *nten, *npos;
+  const double *msFr;
+  int numGlyphs;
+  unsigned int chunkNum,
+    *chunkNext;                   /* next chunk to hand out, under mutex */
+  _tenGlyphRec **chunkRec;        /* per-chunk records */
+  unsigned int *chunkRecNum;      /* per-chunk number of records */
+  int *abort;                     /* set on first error, under mutex */
+  airThreadMutex *mutex;
+  /* per-thread */
+  _tenGlyphRec *rec;              /* buffer for one chunk */
+  int error;                      /* couldn't allocate chunk records */
+} _tenGlyphTask;
+
+static void *
+_tenGlyphWorker(void *_task) {
+  static const char me[]="tenGlyphInstanceGen";
+  _tenGlyphTask *task;
+  const float *tdata;
+  float eval[3], evec[9], rotEvec[9];
+  double pI[3], pW[3], mA[16], rgb[3], qq[3];
+  unsigned int ci, recNum;
+  int idx, idxHi, axis;
+  _tenGlyphRec *rec;
+
+  task = AIR_CAST(_tenGlyphTask *, _task);
+  while (1) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    if (*(task->abort)) {
+      ci = task->chunkNum;
+    } else {
+      ci = *(task->chunkNext);
+      if (ci < task->chunkNum) {
+        *(task->chunkNext) += 1;
+      }
+    }
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (ci == task->chunkNum) {
+      break;
+    }
+    recNum = 0;
+    idxHi = AIR_MIN(task->numGlyphs, AIR_CAST(int, (ci+1)*_TEN_GLYPH_CHUNK));
+    for (idx=AIR_CAST(int, ci*_TEN_GLYPH_CHUNK); idx<idxHi; idx++) {
+      if (!_tenGlyphLocate(pW, pI, me, task->parm, task->shape,
+                           task->nten, task->npos, idx, task->numGlyphs)) {
+        continue;
+      }
+      tdata = (const float*)(task->nten->data) + 7*idx;
+      _tenGlyphEigen(eval, evec, rotEvec, tdata, task->msFr);
+      if (_tenGlyphCull(me, task->parm, eval, tdata, idx, task->numGlyphs)) {
+        continue;
+      }
+      _tenGlyphAttr(mA, rgb, &axis, qq, task->parm,
+                    eval, evec, rotEvec, pW);
+      rec = task->rec + recNum++;
+      ELL_4M_COPY_TT(rec->xform, float, mA);
+      ELL_3V_COPY_TT(rec->qq, float, qq);
+      ELL_4V_SET_TT(rec->rgba, unsigned char,
+                    airIndexClamp(0.0, rgb[0], 1.0, 256),
+                    airIndexClamp(0.0, rgb[1], 1.0, 256),
+                    airIndexClamp(0.0, rgb[2], 1.0, 256), 255);
+      rec->axis = axis;
+    }
+    if (recNum) {
+      rec = AIR_CALLOC(recNum, _tenGlyphRec);
+      if (!rec) {
+        if (task->mutex) {
+          airThreadMutexLock(task->mutex);
+        }
+        task->error = AIR_TRUE;
+        *(task->abort) = AIR_TRUE;
+        if (task->mutex) {
+          airThreadMutexUnlock(task->mutex);
+        }
+        return _task;
+      }
+      memcpy(rec, task->rec, recNum*sizeof(_tenGlyphRec));
+      task->chunkRec[ci] = rec;
+    }
+    task->chunkRecNum[ci] = recNum;
+  }
+  return _task;
+}
+
+/*
+** _tenGlyphShapeKey
+**
+** which (quantized) shape a glyph record is: axis, and superquadric
+** exponents as multiples of 1/shapeRes.  Exponents are at least
+** 1/shapeRes, so that no shape is completely degenerate.
+*/
+static void
+_tenGlyphShapeKey(unsigned int key[4], const tenGlyphParm *parm,
+                  const _tenGlyphRec *rec) {
+  unsigned int ii;
+
+  ELL_4V_SET(key, 0, 0, 0, 0);
+  if (tenGlyphTypeBox != parm->glyphType) {
+    key[0] = AIR_UINT(AIR_CLAMP(0, rec->axis, 2));
+  }
+  if (tenGlyphTypeSuperquad == parm->glyphType) {
+    for (ii=0; ii<3; ii++) {
+      key[1+ii] = AIR_MAX(1, AIR_ROUNDUP_UI(rec->qq[ii]*parm->shapeRes));
+    }
+  }
+  return;
+}
+
+/*
+** The quantized shapes (their keys, 4 per shape) are found with an
+** open-addressing hash table of key indices + 1 (0 for empty), which
+** is doubled as needed to stay at most half full
+*/
+typedef struct {
+  unsigned int *key, keyNum, *hash, hashLen;
+  airArray *keyArr;
+} _tenGlyphShapeHash;
+
+static _tenGlyphShapeHash *
+_tenGlyphShapeHashNix(_tenGlyphShapeHash *sh) {
+
+  if (sh) {
+    airArrayNuke(sh->keyArr);
+    airFree(sh->hash);
+    airFree(sh);
+  }
+  return NULL;
+}
+
+static _tenGlyphShapeHash *
+_tenGlyphShapeHashNew(void) {
+  _tenGlyphShapeHash *sh;
+
+  sh = AIR_CALLOC(1, _tenGlyphShapeHash);
+  if (sh) {
+    sh->key = NULL;
+    sh->keyArr = airArrayNew(AIR_CAST(void **, &(sh->key)), &(sh->keyNum),
+                             4*sizeof(unsigned int), 32);
+    sh->hashLen = 64;
+    sh->hash = AIR_CALLOC(sh->hashLen, unsigned int);
+    if (!( sh->keyArr && sh->hash )) {
+      sh = _tenGlyphShapeHashNix(sh);
+    }
+  }
+  return sh;
+}
+
+static unsigned int
+_tenGlyphShapeHashIdx(const _tenGlyphShapeHash *sh,
+                      const unsigned int key[4]) {
+  unsigned int hh;
+
+  hh = ((key[3]*31u + key[2])*31u + key[1])*31u + key[0];
+  hh *= 2654435761u;
+  hh ^= hh >> 16;
+  return hh & (sh->hashLen - 1);
+}
+
+/*
+** returns the index of the shape with the given key, adding it if it
+** is new, or UINT_MAX if the hash table couldn't be re-allocated
+*/
+static unsigned int
+_tenGlyphShapeHashFind(_tenGlyphShapeHash *sh, const unsigned int key[4]) {
+  unsigned int hi, ki, *hash;
+
+  hi = _tenGlyphShapeHashIdx(sh, key);
+  while (sh->hash[hi]) {
+    if (ELL_4V_EQUAL(sh->key + 4*(sh->hash[hi] - 1), key)) {
+      return sh->hash[hi] - 1;
+    }
+    hi = (hi + 1) & (sh->hashLen - 1);
+  }
+  ki = airArrayLenIncr(sh->keyArr, 1);
+  ELL_4V_COPY(sh->key + 4*ki, key);
+  sh->hash[hi] = ki + 1;
+  if (2*sh->keyNum > sh->hashLen) {
+    hash = AIR_CALLOC(2*sh->hashLen, unsigned int);
+    if (!hash) {
+      return UINT_MAX;
+    }
+    airFree(sh->hash);
+    sh->hash = hash;
+    sh->hashLen *= 2;
+    for (ki=0; ki<sh->keyNum; ki++) {
+      hi = _tenGlyphShapeHashIdx(sh, sh->key + 4*ki);
+      while (sh->hash[hi]) {
+        hi = (hi + 1) & (sh->hashLen - 1);
+      }
+      sh->hash[hi] = ki + 1;
+    }
+    ki = sh->keyNum - 1;
+  }
+  return ki;
+}
+
+/*
+******** tenGlyphInstanceGen
+**
+** Like tenGlyphGen, but instead of making (and polygonalizing) a new
+** part for every glyph, this polygonalizes each distinct glyph shape
+** only once, into gin->shape[], and records for every glyph its shape
+** index, transform, and color.  The glyphs are the same as with
+** tenGlyphGen (and in the same order), except that the superquadric
+** exponents are quantized to multiples of 1/parm->shapeRes.  The
+** per-glyph work is spread over parm->threadNum threads; the output
+** does not depend on parm->threadNum.  There is no slice (parm->doSlice).
+*/
+int
+tenGlyphInstanceGen(tenGlyphInstance *gin, tenGlyphParm *parm,
+                    const Nrrd *nten, const Nrrd *npos) {
+  static const char me[]="tenGlyphInstanceGen";
+  gageShape *shape;
+  airArray *mop;
+  _tenGlyphShapeHash *shash;
+  _tenGlyphTask *task;
+  _tenGlyphRec *rec;
+  airThreadMutex *mutex;
+  double msFr[9];
+  unsigned int ci, ri, ti, chunkNum, chunkNext, threadNum, glyphNum,
+    key[4], *skey, ki, *shapeIdx, failIdx;
+  int numGlyphs, abort;
+  float *xform;
+  unsigned char *rgba;
+  char stmp[AIR_STRLEN_SMALL];
+
+  if (!( gin && nten && parm )) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  mop = airMopNew();
+  shape = gageShapeNew();
+  shape->defaultCenter = nrrdCenterCell;
+  airMopAdd(mop, shape, (airMopper)gageShapeNix, airMopAlways);
+  if (npos) {
+    if (!( 2 == nten->dim && 7 == nten->axis[0].size )) {
+      biffAddf(TEN, "%s: nten isn't 2-D 7-by-N array", me);
+      airMopError(mop); return 1;
+    }
+    if (!( 2 == npos->dim && 3 == npos->axis[0].size
+           && nten->axis[1].size == npos->axis[1].size )) {
+      biffAddf(TEN, "%s: npos isn't 2-D 3-by-%s array", me,
+               airSprintSize_t(stmp, nten->axis[1].size));
+      airMopError(mop); return 1;
+    }
+    if (!( nrrdTypeFloat == nten->type && nrrdTypeFloat == npos->type )) {
+      biffAddf(TEN, "%s: nten and npos must be %s, not %s and %s", me,
+               airEnumStr(nrrdType, nrrdTypeFloat),
+               airEnumStr(nrrdType, nten->type),
+               airEnumStr(nrrdType, npos->type));
+      airMopError(mop); return 1;
+    }
+  } else {
+    if (tenTensorCheck(nten, nrrdTypeFloat, AIR_TRUE, AIR_TRUE)) {
+      biffAddf(TEN, "%s: didn't get a valid DT volume", me);
+      airMopError(mop); return 1;
+    }
+  }
+  if (tenGlyphParmCheck(parm, nten, npos, NULL)) {
+    biffAddf(TEN, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  if (parm->doSlice) {
+    biffAddf(TEN, "%s: can't show slice (doSlice) with glyph instances", me);
+    airMopError(mop); return 1;
+  }
+  if (!npos) {
+    if (gageShapeSet(shape, nten, tenGageKind->baseDim)) {
+      biffMovef(TEN, GAGE, "%s: trouble", me);
+      airMopError(mop); return 1;
+    }
+    numGlyphs = shape->size[0] * shape->size[1] * shape->size[2];
+  } else {
+    numGlyphs = AIR_INT(nten->axis[1].size);
+  }
+  _tenGlyphMeasurementFrame(msFr, nten);
+
+  /* find the glyphs, in chunks, with threads */
+  chunkNum = (AIR_UINT(numGlyphs) + _TEN_GLYPH_CHUNK - 1)/_TEN_GLYPH_CHUNK;
+  threadNum = airThreadCapable ? parm->threadNum : 1;
+  threadNum = AIR_MAX(1, AIR_MIN(threadNum, chunkNum));
+  task = AIR_CALLOC(threadNum, _tenGlyphTask);
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (!task) {
+    biffAddf(TEN, "%s: couldn't allocate %u tasks", me, threadNum);
+    airMopError(mop); return 1;
+  }
+  mutex = NULL;
+  if (threadNum > 1) {
+    mutex = airThreadMutexNew();
+    airMopAdd(mop, mutex, (airMopper)airThreadMutexNix, airMopAlways);
+  }
+  task[0].chunkRec = AIR_CALLOC(chunkNum, _tenGlyphRec *);
+  airMopAdd(mop, task[0].chunkRec, airFree, airMopAlways);
+  task[0].chunkRecNum = AIR_CALLOC(chunkNum, unsigned int);
+  airMopAdd(mop, task[0].chunkRecNum, airFree, airMopAlways);
+  if (chunkNum && !(task[0].chunkRec && task[0].chunkRecNum)) {
+    biffAddf(TEN, "%s: couldn't allocate %u chunk records", me, chunkNum);
+    airMopError(mop); return 1;
+  }
+  chunkNext = 0;
+  abort = AIR_FALSE;
+  for (ti=0; ti<threadNum; ti++) {
+    task[ti].parm = parm;
+    task[ti].shape = shape;
+    task[ti].nten = nten;
+    task[ti].npos = npos;
+    task[ti].msFr = msFr;
+    task[ti].numGlyphs = numGlyphs;
+    task[ti].chunkNum = chunkNum;
+    task[ti].chunkNext = &chunkNext;
+    task[ti].chunkRec = task[0].chunkRec;
+    task[ti].chunkRecNum = task[0].chunkRecNum;
+    task[ti].abort = &abort;
+    task[ti].mutex = mutex;
+    task[ti].rec = AIR_CALLOC(_TEN_GLYPH_CHUNK, _tenGlyphRec);
+    airMopAdd(mop, task[ti].rec, airFree, airMopAlways);
+    if (!task[ti].rec) {
+      biffAddf(TEN, "%s: couldn't allocate buffer %u", me, ti);
+      airMopError(mop); return 1;
+    }
+    task[ti].error = AIR_FALSE;
+  }
+  failIdx = airThreadRun(threadNum, _tenGlyphWorker, task,
+                         sizeof(_tenGlyphTask), &abort, mutex);
+  for (ci=0; ci<chunkNum; ci++) {
+    airMopAdd(mop, task[0].chunkRec[ci], airFree, airMopAlways);
+  }
+  if (failIdx) {
+    biffAddf(TEN, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    if (task[ti].error) {
+      biffAddf(TEN, "%s: thread %u couldn't allocate glyph records", me, ti);
+      airMopError(mop); return 1;
+    }
+  }
+
+  glyphNum = 0;
+  for (ci=0; ci<chunkNum; ci++) {
+    glyphNum += task[0].chunkRecNum[ci];
+  }
+  shash = _tenGlyphShapeHashNew();
+  airMopAdd(mop, shash, (airMopper)_tenGlyphShapeHashNix, airMopAlways);
+  if (!shash) {
+    biffAddf(TEN, "%s: couldn't allocate shape hash", me);
+    airMopError(mop); return 1;
+  }
+
+  /* set outputs */
+  if (glyphNum) {
+    if (nrrdMaybeAlloc_va(gin->nshape, nrrdTypeUInt, 1,
+                          AIR_CAST(size_t, glyphNum))
+        || nrrdMaybeAlloc_va(gin->nxform, nrrdTypeFloat, 2,
+                             AIR_CAST(size_t, 16),
+                             AIR_CAST(size_t, glyphNum))
+        || nrrdMaybeAlloc_va(gin->nrgba, nrrdTypeUChar, 2,
+                             AIR_CAST(size_t, 4),
+                             AIR_CAST(size_t, glyphNum))) {
+      biffMovef(TEN, NRRD, "%s: couldn't allocate output for %u glyphs",
+                me, glyphNum);
+      airMopError(mop); return 1;
+    }
+  } else {
+    nrrdEmpty(gin->nshape);
+    nrrdEmpty(gin->nxform);
+    nrrdEmpty(gin->nrgba);
+  }
+  shapeIdx = AIR_CAST(unsigned int *, gin->nshape->data);
+  xform = AIR_CAST(float *, gin->nxform->data);
+  rgba = AIR_CAST(unsigned char *, gin->nrgba->data);
+  glyphNum = 0;
+  for (ci=0; ci<chunkNum; ci++) {
+    for (ri=0; ri<task[0].chunkRecNum[ci]; ri++) {
+      rec = task[0].chunkRec[ci] + ri;
+      _tenGlyphShapeKey(key, parm, rec);
+      shapeIdx[glyphNum] = _tenGlyphShapeHashFind(shash, key);
+      if (UINT_MAX == shapeIdx[glyphNum]) {
+        biffAddf(TEN, "%s: couldn't grow shape hash past %u", me,
+                 shash->hashLen);
+        airMopError(mop); return 1;
+      }
+      ELL_4M_COPY(xform + 16*glyphNum, rec->xform);
+      ELL_4V_COPY(rgba + 4*glyphNum, rec->rgba);
+      glyphNum++;
+    }
+  }
+
+  /* make the shapes */
+  airArrayLenSet(gin->shapeArr, 0);
+  airArrayLenSet(gin->shapeArr, shash->keyNum);
+  for (ki=0; ki<shash->keyNum; ki++) {
+    skey = shash->key + 4*ki;
+    if (_tenGlyphShapeMake(gin->shape[ki], parm, AIR_INT(skey[0]),
+                           AIR_CAST(double, skey[1])/parm->shapeRes,
+                           AIR_CAST(double, skey[2])/parm->shapeRes,
+                           AIR_CAST(double, skey[3])/parm->shapeRes)) {
+      biffAddf(TEN, "%s: trouble making shape %u of %u", me,
+               ki, shash->keyNum);
+      airMopError(mop); return 1;
+    }
+  }
+  if (parm->verbose) {
+    fprintf(stderr, "%s: %u glyphs (of %d) with %u shapes, %u threads\n",
+            me, glyphNum, numGlyphs, shash->keyNum, threadNum);
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** tenGlyphInstancePolyData
+**
+** puts a copy of the right shape, transformed and colored, at every
+** glyph of gin, all in one limnPolyData (with RGBA and normals)
+*/
+int
+tenGlyphInstancePolyData(limnPolyData *pld, const tenGlyphInstance *gin) {
+  static const char me[]="tenGlyphInstancePolyData";
+  const limnPolyData *shp;
+  const unsigned int *shapeIdx;
+  const float *xform, *xf;
+  const unsigned char *rgba;
+  unsigned int gi, glyphNum, vi, ii, pi, vertBase, indxBase, primBase;
+  double vertNum, indxNum, primNum;
+  float nmat[9], col[3][3], *norm, len;
+
+  if (!( pld && gin )) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  glyphNum = (gin->nshape->data
+              ? AIR_UINT(nrrdElementNumber(gin->nshape)) : 0);
+  shapeIdx = AIR_CAST(const unsigned int *, gin->nshape->data);
+  xform = AIR_CAST(const float *, gin->nxform->data);
+  rgba = AIR_CAST(const unsigned char *, gin->nrgba->data);
+  vertNum = indxNum = primNum = 0;
+  for (gi=0; gi<glyphNum; gi++) {
+    if (!( shapeIdx[gi] < gin->shapeNum )) {
+      biffAddf(TEN, "%s: glyph %u shape %u not in [0,%u)", me,
+               gi, shapeIdx[gi], gin->shapeNum);
+      return 1;
+    }
+    shp = gin->shape[shapeIdx[gi]];
+    vertNum += shp->xyzwNum;
+    indxNum += shp->indxNum;
+    primNum += shp->primNum;
+  }
+  if (!( vertNum <= UINT_MAX && indxNum <= UINT_MAX
+         && primNum <= UINT_MAX )) {
+    biffAddf(TEN, "%s: %g vertices, %g indices, or %g primitives is too "
+             "many for a limnPolyData", me, vertNum, indxNum, primNum);
+    return 1;
+  }
+  if (limnPolyDataAlloc(pld, ((1 << limnPolyDataInfoRGBA)
+                              | (1 << limnPolyDataInfoNorm)),
+                        AIR_UINT(vertNum), AIR_UINT(indxNum),
+                        AIR_UINT(primNum))) {
+    biffMovef(TEN, LIMN, "%s: couldn't allocate output", me);
+    return 1;
+  }
+  vertBase = indxBase = primBase = 0;
+  for (gi=0; gi<glyphNum; gi++) {
+    shp = gin->shape[shapeIdx[gi]];
+    xf = xform + 16*gi;
+    /* normals are transformed by the cofactor matrix (the inverse
+       transpose, times the determinant), which exists even when
+       some eigenvalue (and the determinant) is zero */
+    ELL_3V_SET(col[0], xf[0], xf[4], xf[8]);
+    ELL_3V_SET(col[1], xf[1], xf[5], xf[9]);
+    ELL_3V_SET(col[2], xf[2], xf[6], xf[10]);
+    ELL_3V_CROSS(nmat + 0, col[1], col[2]);
+    ELL_3V_CROSS(nmat + 3, col[2], col[0]);
+    ELL_3V_CROSS(nmat + 6, col[0], col[1]);
+    for (vi=0; vi<shp->xyzwNum; vi++) {
+      ELL_4MV_MUL(pld->xyzw + 4*(vertBase + vi), xf, shp->xyzw + 4*vi);
+      norm = pld->norm + 3*(vertBase + vi);
+      ELL_3MV_TMUL(norm, nmat, shp->norm + 3*vi);
+      len = AIR_CAST(float, ELL_3V_LEN(norm));
+      if (len) {
+        ELL_3V_SCALE(norm, 1/len, norm);
+      }
+      ELL_4V_COPY(pld->rgba + 4*(vertBase + vi), rgba + 4*gi);
+    }
+    for (ii=0; ii<shp->indxNum; ii++) {
+      pld->indx[indxBase + ii] = vertBase + shp->indx[ii];
+    }
+    for (pi=0; pi<shp->primNum; pi++) {
+      pld->type[primBase + pi] = shp->type[pi];
+      pld->icnt[primBase + pi] = shp->icnt[pi];
+    }
+    vertBase += shp->xyzwNum;
+    indxBase += shp->indxNum;
+    primBase += shp->primNum;
+  }
+  return 0;
+}
+
 /*
 ** Zone from Eval
 */
@@ -36,6 +36,7 @@ tenGradientParmNew(void) {
     ret->minPotentialChange = 0.000000001;
     ret->minMean = 0.0001;
     ret->minMeanImprovement = 0.00005;
+    ret->theta = 0.0;
     ret->single = AIR_FALSE;
     ret->insertZeroVec = AIR_FALSE;
     ret->verbose = 1;
@@ -47,13 +48,18 @@ tenGradientParmNew(void) {
     ret->maxEdgeShrink = 20;
     ret->minIteration = 0;
     ret->maxIteration = 1000000;
+    ret->restartNum = 1;
+    ret->threadNum = 1;
     ret->step = 0;
     ret->nudge = 0;
     ret->itersUsed = 0;
+    ret->restartBest = 0;
     ret->potential = 0;
     ret->potentialNorm = 0;
     ret->angle = 0;
     ret->edge = 0;
+    ret->potentialChange = 0;
+    ret->velocity = 0;
   }
   return ret;
 }
@@ -100,28 +106,48 @@ tenGradientCheck(const Nrrd *ngrad, int type, unsigned int minnum) {
 }
 
 /*
-******** tenGradientRandom
-**
-** generates num random unit vectors of type double
+** biff is not thread-safe, so the static functions below that can be
+** called from the threads of _tenGradientRestart only add to biff while
+** holding the given biffMutex (which is NULL when not threaded)
 */
-int
-tenGradientRandom(Nrrd *ngrad, unsigned int num, unsigned int seed) {
+static void
+_tenGradientBiffLock(airThreadMutex *biffMutex) {
+
+  if (biffMutex) {
+    airThreadMutexLock(biffMutex);
+  }
+  return;
+}
+
+static void
+_tenGradientBiffUnlock(airThreadMutex *biffMutex) {
+
+  if (biffMutex) {
+    airThreadMutexUnlock(biffMutex);
+  }
+  return;
+}
+
+static int
+_tenGradientRandom(Nrrd *ngrad, unsigned int num, airRandMTState *rng,
+                   airThreadMutex *biffMutex) {
   static const char me[]="tenGradientRandom";
   double *grad, len;
   unsigned int gi;
 
   if (nrrdMaybeAlloc_va(ngrad, nrrdTypeDouble, 2,
                         AIR_CAST(size_t, 3), AIR_CAST(size_t, num))) {
+    _tenGradientBiffLock(biffMutex);
     biffMovef(TEN, NRRD, "%s: couldn't allocate output", me);
+    _tenGradientBiffUnlock(biffMutex);
     return 1;
   }
-  airSrandMT(seed);
   grad = AIR_CAST(double*, ngrad->data);
   for (gi=0; gi<num; gi++) {
     do {
-      grad[0] = AIR_AFFINE(0, airDrandMT(), 1, -1, 1);
-      grad[1] = AIR_AFFINE(0, airDrandMT(), 1, -1, 1);
-      grad[2] = AIR_AFFINE(0, airDrandMT(), 1, -1, 1);
+      grad[0] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -1, 1);
+      grad[1] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -1, 1);
+      grad[2] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -1, 1);
       len = ELL_3V_LEN(grad);
     } while (len > 1 || !len);
     ELL_3V_SCALE(grad, 1.0/len, grad);
@@ -130,6 +156,18 @@ tenGradientRandom(Nrrd *ngrad, unsigned int num, unsigned int seed) {
   return 0;
 }
 
+/*
+******** tenGradientRandom
+**
+** generates num random unit vectors of type double
+*/
+int
+tenGradientRandom(Nrrd *ngrad, unsigned int num, unsigned int seed) {
+
+  airSrandMT(seed);
+  return _tenGradientRandom(ngrad, num, airRandMTStateGlobal, NULL);
+}
+
 /*
 ******** tenGradientIdealEdge
 **
@@ -143,25 +181,28 @@ tenGradientIdealEdge(unsigned int N, int single) {
   return sqrt((!single ? 4 : 8)*AIR_PI/(sqrt(3)*N));
 }
 
-/*
-******** tenGradientJitter
-**
-** moves all gradients by amount dist on tangent plane, in a random
-** direction, and then renormalizes. The distance is a fraction
-** of the ideal edge length (via tenGradientIdealEdge)
-*/
-int
-tenGradientJitter(Nrrd *nout, const Nrrd *nin, double dist) {
+static int
+_tenGradientJitter(Nrrd *nout, const Nrrd *nin, double dist,
+                   airRandMTState *rng, airThreadMutex *biffMutex) {
   static const char me[]="tenGradientJitter";
   double *grad, perp0[3], perp1[3], len, theta, cc, ss, edge;
   unsigned int gi, num;
+  int bad;
 
   if (nrrdConvert(nout, nin, nrrdTypeDouble)) {
+    _tenGradientBiffLock(biffMutex);
     biffMovef(TEN, NRRD, "%s: trouble converting input to double", me);
+    _tenGradientBiffUnlock(biffMutex);
     return 1;
   }
-  if (tenGradientCheck(nout, nrrdTypeDouble, 3)) {
+  /* tenGradientCheck uses biff */
+  _tenGradientBiffLock(biffMutex);
+  bad = tenGradientCheck(nout, nrrdTypeDouble, 3);
+  if (bad) {
     biffAddf(TEN, "%s: didn't get valid gradients", me);
+  }
+  _tenGradientBiffUnlock(biffMutex);
+  if (bad) {
     return 1;
   }
   grad = AIR_CAST(double*, nout->data);
@@ -172,7 +213,7 @@ tenGradientJitter(Nrrd *nout, const Nrrd *nin, double dist) {
     ELL_3V_NORM(grad, grad, len);
     ell_3v_perp_d(perp0, grad);
     ELL_3V_CROSS(perp1, perp0, grad);
-    theta = AIR_AFFINE(0, airDrandMT(), 1, 0, 2*AIR_PI);
+    theta = AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, 2*AIR_PI);
     cc = dist*edge*cos(theta);
     ss = dist*edge*sin(theta);
     ELL_3V_SCALE_ADD3(grad, 1.0, grad, cc, perp0, ss, perp1);
@@ -183,6 +224,20 @@ tenGradientJitter(Nrrd *nout, const Nrrd *nin, double dist) {
   return 0;
 }
 
+/*
+******** tenGradientJitter
+**
+** moves all gradients by amount dist on tangent plane, in a random
+** direction, and then renormalizes. The distance is a fraction
+** of the ideal edge length (via tenGradientIdealEdge)
+*/
+int
+tenGradientJitter(Nrrd *nout, const Nrrd *nin, double dist) {
+
+  airRandMTStateGlobalInit();
+  return _tenGradientJitter(nout, nin, dist, airRandMTStateGlobal, NULL);
+}
+
 void
 tenGradientMeasure(double *pot, double *minAngle, double *minEdge,
                    const Nrrd *npos, tenGradientParm *tgparm,
@@ -246,6 +301,48 @@ tenGradientMeasure(double *pot, double *minAngle, double *minEdge,
   return;
 }
 
+/*
+** the speed limit of _tenGradientUpdate, described below
+*/
+static double
+_tenGradientLimit(const tenGradientParm *tgparm) {
+  double expo;
+
+  expo = tgparm->expo ? tgparm->expo : tgparm->expo_d;
+  return expo*AIR_MIN(sqrt(expo),
+                      log(1 + tgparm->initStep/tgparm->step));
+}
+
+/*
+** moves the point at pp along the force grad, subject to the speed
+** limit, and adds the distance moved to *meanVel.  Returns non-zero
+** (without moving the point) if the force wasn't finite.
+*/
+static int
+_tenGradientMove(double *meanVel, double *pp, const double grad[3],
+                 double edge, double limit, const tenGradientParm *tgparm) {
+  double ngrad[3], newpos[3], diff[3], len, step;
+
+  ELL_3V_NORM(ngrad, grad, len);
+  if (!( AIR_EXISTS(len) )) {
+    return 1;
+  }
+  if (0 == len) {
+    /* if the length of grad[] underflowed to zero, we can
+       legitimately zero out ngrad[] */
+    ELL_3V_SET(ngrad, 0, 0, 0);
+  }
+  step = AIR_MIN(len*tgparm->step, edge/limit);
+  ELL_3V_SCALE_ADD2(newpos,
+                    1.0, pp,
+                    step, ngrad);
+  ELL_3V_NORM(newpos, newpos, len);
+  ELL_3V_SUB(diff, pp, newpos);
+  *meanVel += ELL_3V_LEN(diff);
+  ELL_3V_COPY(pp, newpos);
+  return 0;
+}
+
 /*
 ** Do asynchronous update of positions in "npos', based on force
 ** calculations wherein the distances are normalized "edge".  Using a
@@ -281,8 +378,7 @@ int
 _tenGradientUpdate(double *meanVel, double *edgeMin,
                    Nrrd *npos, double edge, tenGradientParm *tgparm) {
   /* static const char me[]="_tenGradientUpdate"; */
-  double *pos, newpos[3], grad[3], ngrad[3],
-    dir[3], len, rep, step, diff[3], limit, expo;
+  double *pos, grad[3], dir[3], len, rep, limit;
   int num, ii, jj, E;
 
   E = 0;
@@ -290,9 +386,7 @@ _tenGradientUpdate(double *meanVel, double *edgeMin,
   num = AIR_UINT(npos->axis[1].size);
   *meanVel = 0;
   *edgeMin = edge;
-  expo = tgparm->expo ? tgparm->expo : tgparm->expo_d;
-  limit = expo*AIR_MIN(sqrt(expo),
-                       log(1 + tgparm->initStep/tgparm->step));
+  limit = _tenGradientLimit(tgparm);
   for (ii=0; ii<num; ii++) {
     ELL_3V_SET(grad, 0, 0, 0);
     for (jj=0; jj<num; jj++) {
@@ -320,33 +414,489 @@ _tenGradientUpdate(double *meanVel, double *edgeMin,
         ELL_3V_SCALE_INCR(grad, rep/num, dir);
       }
     }
-    ELL_3V_NORM(ngrad, grad, len);
-    if (!( AIR_EXISTS(len) )) {
+    if (_tenGradientMove(meanVel, pos + 3*ii, grad, edge, limit, tgparm)) {
       /* things blew up, either in incremental force
          additions, or in the attempt at normalization */
       E = 1;
       *meanVel = AIR_NAN;
       break;
     }
-    if (0 == len) {
-      /* if the length of grad[] underflowed to zero, we can
-         legitimately zero out ngrad[] */
-      ELL_3V_SET(ngrad, 0, 0, 0);
-    }
-    step = AIR_MIN(len*tgparm->step, edge/limit);
-    ELL_3V_SCALE_ADD2(newpos,
-                      1.0, pos + 3*ii,
-                      step, ngrad);
-    ELL_3V_NORM(newpos, newpos, len);
-    ELL_3V_SUB(diff, pos + 3*ii, newpos);
-    *meanVel += ELL_3V_LEN(diff);
-    ELL_3V_COPY(pos + 3*ii, newpos);
   }
   *meanVel /= num;
 
   return E;
 }
 
+/*
+** With many gradients, the all-pairs force and potential computations
+** above dominate, at O(N^2) per iteration.  When tgparm->theta is
+** non-zero, tenGradientDistribute iterates with the Barnes-Hut
+** approximation: the points (and, unless tgparm->single, their
+** antipodes) are sorted into an octree, and the effect of all the
+** points in an octree cell is approximated by that of their centroid
+** (weighted by their number) whenever the cell width is less than
+** theta times the distance to the centroid.  This is O(N log N) per
+** iteration.
+**
+** The octree, and the list of cells and points that each point
+** interacts with, are made once per iteration (from the positions
+** prior to the update).  The update and the measurements of the
+** potential before and after it all use those same lists, so that the
+** potential being compared is the same function before and after the
+** update; otherwise, points crossing between cells make enough noise
+** in the potential to stall the descent.  Unlike _tenGradientUpdate,
+** the update is synchronous.
+*/
+
+/* most points in an octree leaf, and deepest octree level */
+#define _TEN_GRAD_LEAF_MAX 8
+#define _TEN_GRAD_DEPTH_MAX 24
+
+typedef struct {
+  double sum[3],          /* sum of positions of points in cell */
+    min[3], max[3],       /* bounding box of points in cell */
+    half;                 /* half-width of (cubic) cell */
+  unsigned int lo, hi,    /* points in cell are idx[lo] through idx[hi-1] */
+    child[8];             /* indices of child cells, or 0 if none */
+  int leaf;
+} _tenGradNode;
+
+typedef struct {
+  unsigned int num,       /* number of gradients */
+    pntNum,               /* num, or 2*num with antipodes */
+    nodeNum,              /* number of cells currently in use */
+    interNum;             /* length of interaction lists in use */
+  double *pnt;            /* 3-by-pntNum: gradients, then antipodes */
+  unsigned int *idx,      /* point indices, grouped by cell */
+    *where,               /* inverse of idx */
+    *tmp,
+    *start,               /* interactions of gradient ii are */
+    *inter;               /* inter[start[ii]] through inter[start[ii+1]-1]:
+                             values below pntNum are points, others are
+                             pntNum plus a cell index */
+  _tenGradNode *node;
+  airArray *nodeArr, *interArr;
+} _tenGradTree;
+
+static _tenGradTree *
+_tenGradTreeNix(_tenGradTree *tree) {
+
+  if (tree) {
+    airFree(tree->pnt);
+    airFree(tree->idx);
+    airFree(tree->where);
+    airFree(tree->tmp);
+    airFree(tree->start);
+    airArrayNuke(tree->nodeArr);
+    airArrayNuke(tree->interArr);
+    airFree(tree);
+  }
+  return NULL;
+}
+
+static _tenGradTree *
+_tenGradTreeNew(unsigned int num, int single) {
+  _tenGradTree *tree;
+
+  tree = AIR_CALLOC(1, _tenGradTree);
+  if (!tree) {
+    return NULL;
+  }
+  tree->num = num;
+  tree->pntNum = single ? num : 2*num;
+  tree->nodeNum = 0;
+  tree->interNum = 0;
+  tree->pnt = AIR_CALLOC(3*tree->pntNum, double);
+  tree->idx = AIR_CALLOC(tree->pntNum, unsigned int);
+  tree->where = AIR_CALLOC(tree->pntNum, unsigned int);
+  tree->tmp = AIR_CALLOC(tree->pntNum, unsigned int);
+  tree->start = AIR_CALLOC(num+1, unsigned int);
+  tree->node = NULL;
+  tree->nodeArr = airArrayNew(AIR_CAST(void **, &(tree->node)), NULL,
+                              sizeof(_tenGradNode), 256);
+  tree->inter = NULL;
+  tree->interArr = airArrayNew(AIR_CAST(void **, &(tree->inter)), NULL,
+                               sizeof(unsigned int), 64*num);
+  if (!(tree->pnt && tree->idx && tree->where && tree->tmp && tree->start
+        && tree->nodeArr && tree->interArr)) {
+    return _tenGradTreeNix(tree);
+  }
+  return tree;
+}
+
+/*
+** sets the sum and bounding box of cell ni from its points
+*/
+static void
+_tenGradNodeSum(_tenGradTree *tree, unsigned int ni) {
+  _tenGradNode *node;
+  const double *pp;
+  unsigned int ii;
+
+  node = tree->node + ni;
+  ELL_3V_SET(node->sum, 0, 0, 0);
+  ELL_3V_SET(node->min, 2, 2, 2);
+  ELL_3V_SET(node->max, -2, -2, -2);
+  for (ii=node->lo; ii<node->hi; ii++) {
+    pp = tree->pnt + 3*tree->idx[ii];
+    ELL_3V_INCR(node->sum, pp);
+    ELL_3V_MIN(node->min, node->min, pp);
+    ELL_3V_MAX(node->max, node->max, pp);
+  }
+  return;
+}
+
+/*
+** makes the cell for points idx[lo] through idx[hi-1], and (recursively)
+** its children, and sets *nodeIdx to its index.  Returns non-zero if
+** the cells couldn't be allocated.
+*/
+static int
+_tenGradNodeMake(unsigned int *nodeIdx, _tenGradTree *tree,
+                 unsigned int lo, unsigned int hi,
+                 const double ctr[3], double half, unsigned int depth) {
+  _tenGradNode *node;
+  double *pp, cc[3];
+  unsigned int ni, ii, ci, count[8], start[8], child;
+
+  if (tree->nodeNum == tree->nodeArr->len) {
+    airArrayLenIncr(tree->nodeArr, 1);
+    if (tree->nodeNum == tree->nodeArr->len) {
+      return 1;
+    }
+  }
+  ni = tree->nodeNum++;
+  node = tree->node + ni;
+  node->half = half;
+  node->lo = lo;
+  node->hi = hi;
+  for (ci=0; ci<8; ci++) {
+    node->child[ci] = 0;
+    count[ci] = 0;
+  }
+  _tenGradNodeSum(tree, ni);
+  node->leaf = (hi - lo <= _TEN_GRAD_LEAF_MAX
+                || depth == _TEN_GRAD_DEPTH_MAX);
+  *nodeIdx = ni;
+  if (node->leaf) {
+    return 0;
+  }
+#define OCTANT(pp) ((pp[0] > ctr[0])              \
+                    | ((pp[1] > ctr[1]) << 1)     \
+                    | ((pp[2] > ctr[2]) << 2))
+  for (ii=lo; ii<hi; ii++) {
+    pp = tree->pnt + 3*tree->idx[ii];
+    count[OCTANT(pp)]++;
+  }
+  start[0] = lo;
+  for (ci=1; ci<8; ci++) {
+    start[ci] = start[ci-1] + count[ci-1];
+  }
+  for (ii=lo; ii<hi; ii++) {
+    pp = tree->pnt + 3*tree->idx[ii];
+    tree->tmp[start[OCTANT(pp)]++] = tree->idx[ii];
+  }
+#undef OCTANT
+  memcpy(tree->idx + lo, tree->tmp + lo, (hi - lo)*sizeof(unsigned int));
+  ii = lo;
+  for (ci=0; ci<8; ci++) {
+    if (!count[ci]) {
+      continue;
+    }
+    ELL_3V_SET(cc,
+               ctr[0] + (ci & 1 ? 1 : -1)*half/2,
+               ctr[1] + (ci & 2 ? 1 : -1)*half/2,
+               ctr[2] + (ci & 4 ? 1 : -1)*half/2);
+    if (_tenGradNodeMake(&child, tree, ii, ii + count[ci],
+                         cc, half/2, depth+1)) {
+      return 1;
+    }
+    /* tree->node may have moved */
+    tree->node[ni].child[ci] = child;
+    ii += count[ci];
+  }
+  return 0;
+}
+
+static int
+_tenGradInterAdd(_tenGradTree *tree, unsigned int val) {
+
+  if (tree->interNum == tree->interArr->len) {
+    airArrayLenIncr(tree->interArr, 1);
+    if (tree->interNum == tree->interArr->len) {
+      return 1;
+    }
+  }
+  tree->inter[tree->interNum++] = val;
+  return 0;
+}
+
+/*
+** adds to tree->inter the cells and points of cell ni that point self
+** interacts with; never includes self or its antipode.  Returns
+** non-zero if the list couldn't be allocated.
+*/
+static int
+_tenGradTreeList(_tenGradTree *tree, unsigned int ni, unsigned int self,
+                 double theta) {
+  const _tenGradNode *node;
+  double dir[3], len;
+  unsigned int ii, ci, jj, anti, selfWhere, antiWhere;
+
+  node = tree->node + ni;
+  anti = (tree->pntNum > tree->num ? self + tree->num : self);
+  selfWhere = tree->where[self];
+  antiWhere = tree->where[anti];
+  if (!( (node->lo <= selfWhere && selfWhere < node->hi)
+         || (node->lo <= antiWhere && antiWhere < node->hi) )) {
+    ELL_3V_SCALE_ADD2(dir, 1.0, tree->pnt + 3*self,
+                      -1.0/(node->hi - node->lo), node->sum);
+    len = ELL_3V_LEN(dir);
+    if (2*node->half < theta*len) {
+      return _tenGradInterAdd(tree, tree->pntNum + ni);
+    }
+  }
+  if (!node->leaf) {
+    for (ci=0; ci<8; ci++) {
+      if (tree->node[ni].child[ci]
+          && _tenGradTreeList(tree, tree->node[ni].child[ci], self, theta)) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+  for (ii=node->lo; ii<node->hi; ii++) {
+    jj = tree->idx[ii];
+    if (jj == self || jj == anti) {
+      continue;
+    }
+    if (_tenGradInterAdd(tree, jj)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void
+_tenGradTreePoints(_tenGradTree *tree, const double *pos) {
+  unsigned int ii;
+
+  for (ii=0; ii<tree->num; ii++) {
+    ELL_3V_COPY(tree->pnt + 3*ii, pos + 3*ii);
+    if (tree->pntNum > tree->num) {
+      ELL_3V_SCALE(tree->pnt + 3*(ii + tree->num), -1, pos + 3*ii);
+    }
+  }
+  return;
+}
+
+/*
+** makes the octree and the interaction lists for the given positions
+*/
+static int
+_tenGradTreeBuild(_tenGradTree *tree, const double *pos, double theta,
+                  airThreadMutex *biffMutex) {
+  static const char me[]="_tenGradTreeBuild";
+  double ctr[3] = {0, 0, 0};
+  unsigned int ii, root;
+
+  _tenGradTreePoints(tree, pos);
+  for (ii=0; ii<tree->pntNum; ii++) {
+    tree->idx[ii] = ii;
+  }
+  tree->nodeNum = 0;
+  if (_tenGradNodeMake(&root, tree, 0, tree->pntNum, ctr, 1.0, 0)) {
+    _tenGradientBiffLock(biffMutex);
+    biffAddf(TEN, "%s: couldn't allocate octree cells", me);
+    _tenGradientBiffUnlock(biffMutex);
+    return 1;
+  }
+  for (ii=0; ii<tree->pntNum; ii++) {
+    tree->where[tree->idx[ii]] = ii;
+  }
+  tree->interNum = 0;
+  for (ii=0; ii<tree->num; ii++) {
+    tree->start[ii] = tree->interNum;
+    if (_tenGradTreeList(tree, 0, ii, theta)) {
+      _tenGradientBiffLock(biffMutex);
+      biffAddf(TEN, "%s: couldn't allocate interaction list", me);
+      _tenGradientBiffUnlock(biffMutex);
+      return 1;
+    }
+  }
+  tree->start[tree->num] = tree->interNum;
+  return 0;
+}
+
+/*
+** moves the points of the octree to the given positions, keeping the
+** cells and interaction lists, but updating the cells' sums and
+** bounding boxes
+*/
+static void
+_tenGradTreeMove(_tenGradTree *tree, const double *pos) {
+  unsigned int ni;
+
+  _tenGradTreePoints(tree, pos);
+  for (ni=0; ni<tree->nodeNum; ni++) {
+    _tenGradNodeSum(tree, ni);
+  }
+  return;
+}
+
+/*
+** adds to grad (if non-NULL) the force on gradient self (with distances
+** normalized by edge), and to *pot (if non-NULL) its potential (with
+** distances normalized by potEdge), from everything in its interaction
+** list.  Distances to the points treated exactly go into *edgeMin.
+*/
+static void
+_tenGradTreeSum(double grad[3], double edge, double *pot, double potEdge,
+                double *edgeMin, const _tenGradTree *tree,
+                unsigned int self, const tenGradientParm *tgparm) {
+  const _tenGradNode *node;
+  const double *pp;
+  double dir[3], len, mass;
+  unsigned int ii, vv;
+
+#define REP(edge, len, mm)                                         \
+  (tgparm->expo                                                    \
+   ? airIntPow((edge)/(len), tgparm->expo + (mm))                  \
+   : pow((edge)/(len), tgparm->expo_d + (mm)))
+  pp = tree->pnt + 3*self;
+  for (ii=tree->start[self]; ii<tree->start[self+1]; ii++) {
+    vv = tree->inter[ii];
+    if (vv < tree->pntNum) {
+      ELL_3V_SUB(dir, pp, tree->pnt + 3*vv);
+      ELL_3V_NORM(dir, dir, len);
+      *edgeMin = AIR_MIN(*edgeMin, len);
+      mass = 1;
+    } else {
+      node = tree->node + vv - tree->pntNum;
+      mass = node->hi - node->lo;
+      ELL_3V_SCALE_ADD2(dir, 1.0, pp, -1.0/mass, node->sum);
+      ELL_3V_NORM(dir, dir, len);
+    }
+    if (grad) {
+      ELL_3V_SCALE_INCR(grad, mass*REP(edge, len, 1), dir);
+    }
+    if (pot) {
+      *pot += mass*REP(potEdge, len, 0);
+    }
+  }
+#undef REP
+  return;
+}
+
+/*
+** octree version of _tenGradientUpdate; the octree has been built
+** (by _tenGradTreeBuild) from the positions in npos.  Since it's
+** nearly free, this also measures (as in _tenGradTreeMeasure) the
+** potential *pot prior to the update.
+*/
+static int
+_tenGradTreeUpdate(double *meanVel, double *edgeMin, double *pot,
+                   Nrrd *npos, double edge, tenGradientParm *tgparm,
+                   const _tenGradTree *tree) {
+  double *pos, grad[3], limit, potEdge;
+  unsigned int ii, num;
+
+  pos = AIR_CAST(double *, npos->data);
+  num = AIR_UINT(npos->axis[1].size);
+  *meanVel = 0;
+  *edgeMin = edge;
+  *pot = 0;
+  potEdge = tenGradientIdealEdge(num, tgparm->single);
+  limit = _tenGradientLimit(tgparm);
+  for (ii=0; ii<num; ii++) {
+    ELL_3V_SET(grad, 0, 0, 0);
+    _tenGradTreeSum(grad, edge, pot, potEdge, edgeMin, tree, ii, tgparm);
+    ELL_3V_SCALE(grad, 1.0/num, grad);
+    if (_tenGradientMove(meanVel, pos + 3*ii, grad, edge, limit, tgparm)) {
+      *meanVel = AIR_NAN;
+      return 1;
+    }
+  }
+  *meanVel /= num;
+  if (tgparm->single) {
+    *pot /= 2;
+  }
+  return 0;
+}
+
+/*
+** finds the distance from point self to the nearest other point
+** (excluding its antipode) in cell ni, if closer than *dist
+*/
+static void
+_tenGradTreeNearest(double *dist, const _tenGradTree *tree,
+                    unsigned int ni, unsigned int self) {
+  const _tenGradNode *node;
+  const double *pp;
+  double diff[3], len;
+  unsigned int ii, jj, ci, anti;
+
+  node = tree->node + ni;
+  pp = tree->pnt + 3*self;
+  /* distance from point to bounding box */
+  for (ii=0; ii<3; ii++) {
+    diff[ii] = AIR_MAX(0, AIR_MAX(node->min[ii] - pp[ii],
+                                  pp[ii] - node->max[ii]));
+  }
+  if (ELL_3V_LEN(diff) >= *dist) {
+    return;
+  }
+  if (!node->leaf) {
+    for (ci=0; ci<8; ci++) {
+      if (node->child[ci]) {
+        _tenGradTreeNearest(dist, tree, node->child[ci], self);
+      }
+    }
+    return;
+  }
+  anti = (tree->pntNum > tree->num ? self + tree->num : self);
+  for (ii=node->lo; ii<node->hi; ii++) {
+    jj = tree->idx[ii];
+    if (jj == self || jj == anti) {
+      continue;
+    }
+    ELL_3V_SUB(diff, pp, tree->pnt + 3*jj);
+    len = ELL_3V_LEN(diff);
+    *dist = AIR_MIN(*dist, len);
+  }
+  return;
+}
+
+/*
+** octree version of tenGradientMeasure (with edge normalization), for
+** the positions in npos, using the cells and interaction lists already
+** in the octree.  The minimum angle is found from the (exact) minimum
+** edge length.
+*/
+static void
+_tenGradTreeMeasure(double *pot, double *minAngle, const Nrrd *npos,
+                    tenGradientParm *tgparm, _tenGradTree *tree) {
+  double edge, edgeMin, minEdge;
+  unsigned int ii, num;
+
+  num = AIR_UINT(npos->axis[1].size);
+  _tenGradTreeMove(tree, AIR_CAST(const double *, npos->data));
+  edge = tenGradientIdealEdge(num, tgparm->single);
+  *pot = 0;
+  minEdge = 2;
+  edgeMin = 2;
+  for (ii=0; ii<num; ii++) {
+    _tenGradTreeSum(NULL, edge, pot, edge, &edgeMin, tree, ii, tgparm);
+    _tenGradTreeNearest(&minEdge, tree, 0, ii);
+  }
+  if (tgparm->single) {
+    /* each pair was counted twice */
+    *pot /= 2;
+  }
+  *minAngle = 2*asin(AIR_MIN(minEdge, 2)/2);
+  return;
+}
+
 /*
 ** assign random signs to the vectors and measures the length of their
 ** mean, as quickly as possible
@@ -445,38 +995,39 @@ tenGradientBalance(Nrrd *nout, const Nrrd *nin,
 }
 
 /*
-******** tenGradientDistribute
-**
-** Takes the given list of gradients, normalizes their lengths,
-** optionally jitters their positions, does point repulsion, and then
-** (optionally) selects a combination of directions with minimum vector sum.
-**
-** The complicated part of this is the point repulsion, which uses a
-** gradient descent with variable set size. The progress of the system
-** is measured by decrease in potential (when its measurement doesn't
-** overflow to infinity) or an increase in the minimum angle.  When a
-** step results in negative progress, the step size is halved, and the
-** iteration is attempted again.  Based on the observation that at
-** some points the step size must be made very small to get progress,
-** the step size is cautiously increased ("nudged") at every
-** iteration, to try to avoid using an overly small step.  The amount
-** by which the step is nudged is halved everytime the step is halved,
-** to avoid endless cycling through step sizes.
+** with "balance", this also does the balancing (when tgparm asks for it),
+** which otherwise is left to the caller
 */
-int
-tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
-                      tenGradientParm *tgparm) {
+static int
+_tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
+                       tenGradientParm *tgparm, airRandMTState *rng,
+                       int balance, airThreadMutex *biffMutex) {
   static const char me[]="tenGradientDistribute";
   char filename[AIR_STRLEN_SMALL];
   unsigned int ii, num, iter, oldIdx, newIdx, edgeShrink;
   airArray *mop;
   Nrrd *npos[2];
+  _tenGradTree *tree;
   double *pos, len, meanVelocity, pot, potNew, potD,
     edge, edgeMin, angle, angleNew;
-  int E;
+  int E, bad;
 
-  if (!nout || tenGradientCheck(nin, nrrdTypeUnknown, 2) || !tgparm) {
+  /* tenGradientCheck uses biff */
+  _tenGradientBiffLock(biffMutex);
+  bad = (!nout || tenGradientCheck(nin, nrrdTypeUnknown, 2) || !tgparm);
+  if (bad) {
     biffAddf(TEN, "%s: got NULL pointer or invalid input", me);
+  }
+  _tenGradientBiffUnlock(biffMutex);
+  if (bad) {
+    return 1;
+  }
+  if (!( AIR_EXISTS(tgparm->theta)
+         && 0 <= tgparm->theta && tgparm->theta <= 1 )) {
+    _tenGradientBiffLock(biffMutex);
+    biffAddf(TEN, "%s: octree opening angle theta %g not in [0,1]", me,
+             tgparm->theta);
+    _tenGradientBiffUnlock(biffMutex);
     return 1;
   }
 
@@ -488,7 +1039,9 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
   airMopAdd(mop, npos[1], (airMopper)nrrdNuke, airMopAlways);
   if (nrrdConvert(npos[0], nin, nrrdTypeDouble)
       || nrrdConvert(npos[1], nin, nrrdTypeDouble)) {
+    _tenGradientBiffLock(biffMutex);
     biffMovef(TEN, NRRD, "%s: trouble allocating temp buffers", me);
+    _tenGradientBiffUnlock(biffMutex);
     airMopError(mop); return 1;
   }
 
@@ -498,10 +1051,26 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
     pos += 3;
   }
   if (tgparm->jitter) {
-    if (tenGradientJitter(npos[0], npos[0], tgparm->jitter)) {
+    if (_tenGradientJitter(npos[0], npos[0], tgparm->jitter, rng,
+                           biffMutex)) {
+      _tenGradientBiffLock(biffMutex);
       biffAddf(TEN, "%s: problem jittering input", me);
+      _tenGradientBiffUnlock(biffMutex);
+      airMopError(mop); return 1;
+    }
+  }
+
+  if (tgparm->theta) {
+    tree = _tenGradTreeNew(num, tgparm->single);
+    if (!tree) {
+      _tenGradientBiffLock(biffMutex);
+      biffAddf(TEN, "%s: couldn't allocate octree", me);
+      _tenGradientBiffUnlock(biffMutex);
       airMopError(mop); return 1;
     }
+    airMopAdd(mop, tree, (airMopper)_tenGradTreeNix, airMopAlways);
+  } else {
+    tree = NULL;
   }
 
   /* initialize things prior to first iteration; have to
@@ -512,8 +1081,19 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
   newIdx = 1;
   tgparm->step = tgparm->initStep;
   tgparm->nudge = 0.1;
-  tenGradientMeasure(&pot, &angle, NULL,
-                     npos[oldIdx], tgparm, AIR_TRUE);
+  if (tree) {
+    if (_tenGradTreeBuild(tree, AIR_CAST(double *, npos[oldIdx]->data),
+                          tgparm->theta, biffMutex)) {
+      _tenGradientBiffLock(biffMutex);
+      biffAddf(TEN, "%s: trouble making octree", me);
+      _tenGradientBiffUnlock(biffMutex);
+      airMopError(mop); return 1;
+    }
+    _tenGradTreeMeasure(&pot, &angle, npos[oldIdx], tgparm, tree);
+  } else {
+    tenGradientMeasure(&pot, &angle, NULL,
+                       npos[oldIdx], tgparm, AIR_TRUE);
+  }
   for (iter = 0;
        ((!!tgparm->minIteration && iter < tgparm->minIteration)
         ||
@@ -529,16 +1109,31 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
     memcpy(npos[newIdx]->data, npos[oldIdx]->data, 3*num*sizeof(double));
     edge = tenGradientIdealEdge(num, tgparm->single);
     edgeShrink = 0;
+    if (tree && iter
+        && _tenGradTreeBuild(tree, AIR_CAST(double *, npos[oldIdx]->data),
+                             tgparm->theta, biffMutex)) {
+      _tenGradientBiffLock(biffMutex);
+      biffAddf(TEN, "%s: trouble making octree at iter %u", me, iter);
+      _tenGradientBiffUnlock(biffMutex);
+      airMopError(mop); return 1;
+    }
     /* try to do a position update, which will fail if repulsion values
        explode, from having an insufficiently small edge normalization,
        so retry with smaller edge next time */
     do {
-      E = _tenGradientUpdate(&meanVelocity, &edgeMin,
-                             npos[newIdx], edge, tgparm);
+      /* with the octree, this also re-measures the current potential
+         with the new octree, so that it is comparable to potNew */
+      E = (tree
+           ? _tenGradTreeUpdate(&meanVelocity, &edgeMin, &pot,
+                                npos[newIdx], edge, tgparm, tree)
+           : _tenGradientUpdate(&meanVelocity, &edgeMin,
+                                npos[newIdx], edge, tgparm));
       if (E) {
         if (edgeShrink > tgparm->maxEdgeShrink) {
+          _tenGradientBiffLock(biffMutex);
           biffAddf(TEN, "%s: %u > %u edge shrinks (%g), update still failed",
                   me, edgeShrink, tgparm->maxEdgeShrink, edge);
+          _tenGradientBiffUnlock(biffMutex);
           airMopError(mop); return 1;
         }
         edgeShrink++;
@@ -547,8 +1142,12 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
         edge = edgeMin;
       }
     } while (E);
-    tenGradientMeasure(&potNew, &angleNew, NULL,
-                       npos[newIdx], tgparm, AIR_TRUE);
+    if (tree) {
+      _tenGradTreeMeasure(&potNew, &angleNew, npos[newIdx], tgparm, tree);
+    } else {
+      tenGradientMeasure(&potNew, &angleNew, NULL,
+                         npos[newIdx], tgparm, AIR_TRUE);
+    }
     if ((AIR_EXISTS(pot) && AIR_EXISTS(potNew) && potNew <= pot)
         || angleNew >= angle) {
       /* there was progress of some kind, either through potential
@@ -570,7 +1169,9 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
         }
         if (nrrdSave(filename, npos[newIdx], NULL)) {
           char *serr;
+          _tenGradientBiffLock(biffMutex);
           serr = biffGetDone(NRRD);
+          _tenGradientBiffUnlock(biffMutex);
           if (tgparm->verbose) { /* perhaps shouldn't have this check */
             fprintf(stderr, "%s: iter=%d, couldn't save snapshot:\n%s"
                     "continuing ...\n", me, iter, serr);
@@ -603,11 +1204,12 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
      npos[newIdx]) ==> the final results are in npos[oldIdx] */
 
   if (tgparm->verbose) {
-    fprintf(stderr, "%s: .......................... done distribution:\n"
+    fprintf(stderr, "%s: .......................... done %sdistribution:\n"
             "  (%d && %d) || (%d \n"
             "               && (%d || %d || %d) \n"
             "               && (%d || %d) \n"
             "               && %d) is false\n", me,
+            tree ? "approximate " : "",
             !!tgparm->minIteration, iter < tgparm->minIteration,
             iter < tgparm->maxIteration,
             !tgparm->minPotentialChange,
@@ -621,6 +1223,7 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
             2*sin(angle/2), tenGradientIdealEdge(num, tgparm->single));
   }
 
+  /* these are exact, regardless of tgparm->theta */
   tenGradientMeasure(&pot, NULL, NULL, npos[oldIdx], tgparm, AIR_FALSE);
   tgparm->potential = pot;
   tenGradientMeasure(&pot, &angle, &edge, npos[oldIdx], tgparm, AIR_TRUE);
@@ -628,14 +1231,19 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
   tgparm->angle = angle;
   tgparm->edge = edge;
   tgparm->itersUsed = iter;
+  tgparm->potentialChange = potD;
+  tgparm->velocity = meanVelocity;
 
-  if ((tgparm->minMeanImprovement || tgparm->minMean)
+  if (balance
+      && (tgparm->minMeanImprovement || tgparm->minMean)
       && !tgparm->single) {
     if (tgparm->verbose) {
       fprintf(stderr, "%s: optimizing balance:\n", me);
     }
     if (tenGradientBalance(nout, npos[oldIdx], tgparm)) {
+      _tenGradientBiffLock(biffMutex);
       biffAddf(TEN, "%s: failed to minimize vector sum of gradients", me);
+      _tenGradientBiffUnlock(biffMutex);
       airMopError(mop); return 1;
     }
     if (tgparm->verbose) {
@@ -646,7 +1254,9 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
       fprintf(stderr, "%s: .......................... (no balancing)\n", me);
     }
     if (nrrdConvert(nout, npos[oldIdx], nrrdTypeDouble)) {
+      _tenGradientBiffLock(biffMutex);
       biffMovef(TEN, NRRD, "%s: couldn't set output", me);
+      _tenGradientBiffUnlock(biffMutex);
       airMopError(mop); return 1;
     }
   }
@@ -655,9 +1265,224 @@ tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
   return 0;
 }
 
+/*
+******** tenGradientDistribute
+**
+** Takes the given list of gradients, normalizes their lengths,
+** optionally jitters their positions, does point repulsion, and then
+** (optionally) selects a combination of directions with minimum vector sum.
+**
+** The complicated part of this is the point repulsion, which uses a
+** gradient descent with variable set size. The progress of the system
+** is measured by decrease in potential (when its measurement doesn't
+** overflow to infinity) or an increase in the minimum angle.  When a
+** step results in negative progress, the step size is halved, and the
+** iteration is attempted again.  Based on the observation that at
+** some points the step size must be made very small to get progress,
+** the step size is cautiously increased ("nudged") at every
+** iteration, to try to avoid using an overly small step.  The amount
+** by which the step is nudged is halved everytime the step is halved,
+** to avoid endless cycling through step sizes.
+**
+** With non-zero tgparm->theta, the forces and potential in the descent
+** are found with the octree approximation described above, which is
+** much faster with many gradients. The potential and angle in the
+** output fields of tgparm are exact either way.  For the last bit of
+** accuracy, the output can be given back to tenGradientDistribute with
+** theta 0 (and no jitter).
+*/
+int
+tenGradientDistribute(Nrrd *nout, const Nrrd *nin,
+                      tenGradientParm *tgparm) {
+
+  airRandMTStateGlobalInit();
+  return _tenGradientDistribute(nout, nin, tgparm, airRandMTStateGlobal,
+                                AIR_TRUE, NULL);
+}
+
+typedef struct {
+  /* shared (same for all threads) */
+  unsigned int num, restartNum;
+  Nrrd **nres;                  /* restartNum outputs */
+  tenGradientParm *parm;        /* restartNum parms */
+  unsigned int *restartNext;    /* next restart to do, under mutex */
+  int *abort;                   /* set on first error, under mutex */
+  airThreadMutex *mutex;
+  /* per-thread */
+  unsigned int threadIdx;
+  int error;                    /* this thread saw trouble */
+} _tenGradientTask;
+
+static void *
+_tenGradientWorker(void *_task) {
+  static const char me[]="_tenGradientWorker";
+  _tenGradientTask *task;
+  airRandMTState *rng;
+  Nrrd *nin;
+  unsigned int ri;
+  int E;
+
+  task = AIR_CAST(_tenGradientTask *, _task);
+  while (1) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    if (*(task->abort)) {
+      ri = task->restartNum;
+    } else {
+      ri = *(task->restartNext);
+      *(task->restartNext) = AIR_MIN(ri + 1, task->restartNum);
+    }
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (ri == task->restartNum) {
+      break;
+    }
+    /* each restart has its own random number generator, seeded
+       so that the results don't depend on the number of threads */
+    nin = nrrdNew();
+    rng = airRandMTStateNew(task->parm[ri].seed);
+    E = (_tenGradientRandom(nin, task->num, rng, task->mutex)
+         || _tenGradientDistribute(task->nres[ri], nin, task->parm + ri, rng,
+                                   AIR_FALSE, task->mutex));
+    airRandMTStateNix(rng);
+    nrrdNuke(nin);
+    if (E) {
+      _tenGradientBiffLock(task->mutex);
+      biffAddf(TEN, "%s(%u): trouble on restart %u (seed %u)", me,
+               task->threadIdx, ri, task->parm[ri].seed);
+      task->error = AIR_TRUE;
+      *(task->abort) = AIR_TRUE;
+      _tenGradientBiffUnlock(task->mutex);
+      return _task;
+    }
+  }
+  return _task;
+}
+
+/*
+** does tgparm->restartNum runs of random initialization and distribution,
+** the ri-th with seed tgparm->seed + ri, on tgparm->threadNum threads,
+** and puts the one with the lowest potential in nout.  The threads don't
+** balance their results (tenGradientBalance uses biff); only the best
+** one is balanced, afterwards, which gives the same output.
+*/
+static int
+_tenGradientRestart(Nrrd *nout, unsigned int num, tenGradientParm *tgparm) {
+  static const char me[]="_tenGradientRestart";
+  airArray *mop;
+  Nrrd **nres;
+  tenGradientParm *parm, save;
+  _tenGradientTask *task;
+  airThreadMutex *mutex;
+  unsigned int ri, best, restartNext, threadIdx, threadNum, failIdx;
+  int abort, hadErr;
+
+  mop = airMopNew();
+  threadNum = airThreadCapable ? tgparm->threadNum : 1;
+  threadNum = AIR_MIN(threadNum, tgparm->restartNum);
+  nres = AIR_CALLOC(tgparm->restartNum, Nrrd *);
+  parm = AIR_CALLOC(tgparm->restartNum, tenGradientParm);
+  task = AIR_CALLOC(threadNum, _tenGradientTask);
+  airMopAdd(mop, nres, airFree, airMopAlways);
+  airMopAdd(mop, parm, airFree, airMopAlways);
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (!(nres && parm && task)) {
+    biffAddf(TEN, "%s: couldn't allocate for %u restarts", me,
+             tgparm->restartNum);
+    airMopError(mop); return 1;
+  }
+  for (ri=0; ri<tgparm->restartNum; ri++) {
+    nres[ri] = nrrdNew();
+    airMopAdd(mop, nres[ri], (airMopper)nrrdNuke, airMopAlways);
+    parm[ri] = *tgparm;
+    parm[ri].seed = tgparm->seed + ri;
+    /* the verbose output of simultaneous restarts would be a mess */
+    parm[ri].verbose = 0;
+  }
+  if (threadNum > 1) {
+    mutex = airThreadMutexNew();
+    airMopAdd(mop, mutex, (airMopper)airThreadMutexNix, airMopAlways);
+  } else {
+    mutex = NULL;
+  }
+  restartNext = 0;
+  abort = AIR_FALSE;
+  for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+    task[threadIdx].num = num;
+    task[threadIdx].restartNum = tgparm->restartNum;
+    task[threadIdx].nres = nres;
+    task[threadIdx].parm = parm;
+    task[threadIdx].restartNext = &restartNext;
+    task[threadIdx].abort = &abort;
+    task[threadIdx].mutex = mutex;
+    task[threadIdx].threadIdx = threadIdx;
+    task[threadIdx].error = AIR_FALSE;
+  }
+  failIdx = airThreadRun(threadNum, _tenGradientWorker, task,
+                         sizeof(_tenGradientTask), &abort, mutex);
+  if (failIdx) {
+    biffAddf(TEN, "%s: couldn't start thread %u of %u", me,
+             failIdx, threadNum);
+    airMopError(mop); return 1;
+  }
+  hadErr = AIR_FALSE;
+  for (threadIdx=0; threadIdx<threadNum; threadIdx++) {
+    hadErr |= task[threadIdx].error;
+  }
+  if (hadErr) {
+    biffAddf(TEN, "%s: trouble with %u restarts on %u threads", me,
+             tgparm->restartNum, threadNum);
+    airMopError(mop); return 1;
+  }
+
+  /* ties go to the earlier restart */
+  best = 0;
+  for (ri=0; ri<tgparm->restartNum; ri++) {
+    if (tgparm->verbose) {
+      fprintf(stderr, "%s: restart %u (seed %u): potential = %g, "
+              "angle = %g, iters = %u\n", me, ri,
+              parm[ri].seed, parm[ri].potentialNorm, parm[ri].angle,
+              parm[ri].itersUsed);
+    }
+    if (parm[ri].potential < parm[best].potential) {
+      best = ri;
+    }
+  }
+  if ((parm[best].minMeanImprovement || parm[best].minMean)
+      && !parm[best].single) {
+    /* same seed as if it had been balanced in its thread */
+    if (tenGradientBalance(nout, nres[best], parm + best)) {
+      biffAddf(TEN, "%s: failed to minimize vector sum of gradients", me);
+      airMopError(mop); return 1;
+    }
+  } else {
+    if (nrrdCopy(nout, nres[best])) {
+      biffMovef(TEN, NRRD, "%s: couldn't set output", me);
+      airMopError(mop); return 1;
+    }
+  }
+  /* learn the outputs of the best restart, but keep the inputs */
+  save = *tgparm;
+  *tgparm = parm[best];
+  tgparm->seed = save.seed;
+  tgparm->verbose = save.verbose;
+  tgparm->restartBest = best;
+
+  airMopOkay(mop);
+  return 0;
+}
+
 /*
 ** note that if tgparm->insertZeroVec, there will be one sample more
 ** along axis 1 of nout than the requested #gradients "num"
+**
+** With tgparm->restartNum > 1, the distribution is done that many times
+** (on up to tgparm->threadNum threads), from different random initial
+** gradients (using seeds tgparm->seed, tgparm->seed+1, ...), and the
+** result with the lowest potential is kept; tgparm->restartBest says
+** which one that was.  The outcome does not depend on threadNum.
 */
 int
 tenGradientGenerate(Nrrd *nout, unsigned int num, tenGradientParm *tgparm) {
@@ -674,14 +1499,29 @@ tenGradientGenerate(Nrrd *nout, unsigned int num, tenGradientParm *tgparm) {
             "(not %d)", me, num);
     return 1;
   }
+  if (!( tgparm->restartNum >= 1 && tgparm->threadNum >= 1 )) {
+    biffAddf(TEN, "%s: need non-zero restartNum (not %u) and "
+             "threadNum (not %u)", me, tgparm->restartNum,
+             tgparm->threadNum);
+    return 1;
+  }
   mop = airMopNew();
   nin = nrrdNew();
   airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
 
-  if (tenGradientRandom(nin, num, tgparm->seed)
-      || tenGradientDistribute(nout, nin, tgparm)) {
-    biffAddf(TEN, "%s: trouble", me);
-    airMopError(mop); return 1;
+  if (1 == tgparm->restartNum) {
+    if (tenGradientRandom(nin, num, tgparm->seed)
+        || _tenGradientDistribute(nout, nin, tgparm, airRandMTStateGlobal,
+                                  AIR_TRUE, NULL)) {
+      biffAddf(TEN, "%s: trouble", me);
+      airMopError(mop); return 1;
+    }
+    tgparm->restartBest = 0;
+  } else {
+    if (_tenGradientRestart(nout, num, tgparm)) {
+      biffAddf(TEN, "%s: trouble", me);
+      airMopError(mop); return 1;
+    }
   }
   if (tgparm->insertZeroVec) {
     /* this is potentially confusing: the second axis (axis 1)
@@ -31,10 +31,12 @@ tenEvecRGB(Nrrd *nout, const Nrrd *nin,
   static const char me[]="tenEvecRGB";
   size_t size[NRRD_DIM_MAX];
   float (*lup)(const void *, size_t), (*ins)(void *, size_t, float);
-  float ten[7], eval[3], evec[9], RGB[3];
-  size_t II, NN;
+  float RGB[3], *tenBuff, *evalBuff, *evecBuff;
+  const float *ten, *tdata, *eval, *evec;
+  size_t II, NN, base, num, bnum, cc;
   unsigned char *odataUC;
   unsigned short *odataUS;
+  airArray *mop;
 
   if (!(nout && nin)) {
     biffAddf(TEN, "%s: got NULL pointer (%p,%p)",
@@ -67,51 +69,84 @@ tenEvecRGB(Nrrd *nout, const Nrrd *nin,
   NN = nrrdElementNumber(nin)/7;
   lup = nrrdFLookup[nin->type];
   ins = nrrdFInsert[nout->type];
-  for (II=0; II<NN; II++) {
-    TEN_T_SET(ten, lup(nin->data, 0 + 7*II),
-              lup(nin->data, 1 + 7*II), lup(nin->data, 2 + 7*II),
-              lup(nin->data, 3 + 7*II), lup(nin->data, 4 + 7*II),
-              lup(nin->data, 5 + 7*II), lup(nin->data, 6 + 7*II));
-    tenEigensolve_f(eval, evec, ten);
-    tenEvecRGBSingle_f(RGB, ten[0], eval, evec + 3*(rgbp->which), rgbp);
-    switch (nout->type) {
-    case nrrdTypeUChar:
-      odataUC[0 + size[0]*II] = airIndexClamp(0.0, RGB[0], 1.0, 256);
-      odataUC[1 + size[0]*II] = airIndexClamp(0.0, RGB[1], 1.0, 256);
-      odataUC[2 + size[0]*II] = airIndexClamp(0.0, RGB[2], 1.0, 256);
-      if (rgbp->genAlpha) {
-        odataUC[3 + size[0]*II] = 255;
-      }
-      break;
-    case nrrdTypeUShort:
-      odataUS[0 + size[0]*II] = airIndexClamp(0.0, RGB[0], 1.0, 65536);
-      odataUS[1 + size[0]*II] = airIndexClamp(0.0, RGB[1], 1.0, 65536);
-      odataUS[2 + size[0]*II] = airIndexClamp(0.0, RGB[2], 1.0, 65536);
-      if (rgbp->genAlpha) {
-        odataUS[3 + size[0]*II] = 65535;
+  mop = airMopNew();
+  bnum = AIR_MIN(NN, _TEN_EIGEN_BATCH_NUM);
+  evalBuff = AIR_CALLOC(3*bnum, float);
+  airMopAdd(mop, evalBuff, airFree, airMopAlways);
+  evecBuff = AIR_CALLOC(9*bnum, float);
+  airMopAdd(mop, evecBuff, airFree, airMopAlways);
+  if (nrrdTypeFloat != nin->type) {
+    tenBuff = AIR_CALLOC(7*bnum, float);
+    airMopAdd(mop, tenBuff, airFree, airMopAlways);
+  } else {
+    /* will use input data directly */
+    tenBuff = NULL;
+  }
+  if (!(evalBuff && evecBuff
+        && (nrrdTypeFloat == nin->type || tenBuff))) {
+    biffAddf(TEN, "%s: couldn't allocate buffers", me);
+    airMopError(mop); return 1;
+  }
+  for (base=0; base<NN; base+=num) {
+    num = AIR_MIN(NN - base, bnum);
+    if (nrrdTypeFloat == nin->type) {
+      tdata = AIR_CAST(const float *, nin->data) + 7*base;
+    } else {
+      for (cc=0; cc<7*num; cc++) {
+        tenBuff[cc] = lup(nin->data, cc + 7*base);
       }
-      break;
-    default:
-      ins(nout->data, 0 + size[0]*II, RGB[0]);
-      ins(nout->data, 1 + size[0]*II, RGB[1]);
-      ins(nout->data, 2 + size[0]*II, RGB[2]);
-      if (rgbp->genAlpha) {
-        ins(nout->data, 3 + size[0]*II, 1.0);
+      tdata = tenBuff;
+    }
+    if (tenEigensolveBatch_f(evalBuff, evecBuff, tdata, num,
+                             rgbp->threadNum)) {
+      biffAddf(TEN, "%s: trouble", me);
+      airMopError(mop); return 1;
+    }
+    for (II=base; II<base+num; II++) {
+      ten = tdata + 7*(II - base);
+      eval = evalBuff + 3*(II - base);
+      evec = evecBuff + 9*(II - base);
+      tenEvecRGBSingle_f(RGB, ten[0], eval, evec + 3*(rgbp->which), rgbp);
+      switch (nout->type) {
+      case nrrdTypeUChar:
+        odataUC[0 + size[0]*II] = airIndexClamp(0.0, RGB[0], 1.0, 256);
+        odataUC[1 + size[0]*II] = airIndexClamp(0.0, RGB[1], 1.0, 256);
+        odataUC[2 + size[0]*II] = airIndexClamp(0.0, RGB[2], 1.0, 256);
+        if (rgbp->genAlpha) {
+          odataUC[3 + size[0]*II] = 255;
+        }
+        break;
+      case nrrdTypeUShort:
+        odataUS[0 + size[0]*II] = airIndexClamp(0.0, RGB[0], 1.0, 65536);
+        odataUS[1 + size[0]*II] = airIndexClamp(0.0, RGB[1], 1.0, 65536);
+        odataUS[2 + size[0]*II] = airIndexClamp(0.0, RGB[2], 1.0, 65536);
+        if (rgbp->genAlpha) {
+          odataUS[3 + size[0]*II] = 65535;
+        }
+        break;
+      default:
+        ins(nout->data, 0 + size[0]*II, RGB[0]);
+        ins(nout->data, 1 + size[0]*II, RGB[1]);
+        ins(nout->data, 2 + size[0]*II, RGB[2]);
+        if (rgbp->genAlpha) {
+          ins(nout->data, 3 + size[0]*II, 1.0);
+        }
+        break;
       }
-      break;
     }
   }
   if (nrrdAxisInfoCopy(nout, nin, NULL, (NRRD_AXIS_INFO_SIZE_BIT))) {
     biffMovef(TEN, NRRD, "%s: couldn't copy axis info", me);
-    return 1;
+    airMopError(mop); return 1;
   }
   nout->axis[0].kind = nrrdKind3Color;
   if (nrrdBasicInfoCopy(nout, nin,
                         NRRD_BASIC_INFO_ALL ^ NRRD_BASIC_INFO_SPACE)) {
     biffAddf(TEN, "%s:", me);
-    return 1;
+    airMopError(mop); return 1;
   }
 
+  airMopOkay(mop);
   return 0;
 }
 
@@ -151,15 +186,22 @@ tenEvqSingle(float vec[3], float scl) {
   return ret;
 }
 
+/*
+******** tenEvqVolumeParallel
+**
+** like tenEvqVolume, with threadNum threads for the eigensolves
+*/
 int
-tenEvqVolume(Nrrd *nout,
-             const Nrrd *nin, int which, int aniso, int scaleByAniso) {
-  static const char me[]="tenEvqVolume";
+tenEvqVolumeParallel(Nrrd *nout,
+                     const Nrrd *nin, int which, int aniso, int scaleByAniso,
+                     unsigned int threadNum) {
+  static const char me[]="tenEvqVolumeParallel";
   int map[3];
   short *qdata;
   const float *tdata;
-  float eval[3], evec[9], an;
-  size_t N, I, sx, sy, sz;
+  float *eval, *evec, *evalBuff, *evecBuff, an;
+  size_t N, I, sx, sy, sz, base, num;
+  airArray *mop;
 
   if (!(nout && nin)) {
     biffAddf(TEN, "%s: got NULL pointer", me);
@@ -190,28 +232,58 @@ tenEvqVolume(Nrrd *nout,
   N = sx*sy*sz;
   tdata = (float *)nin->data;
   qdata = (short *)nout->data;
-  for (I=0; I<N; I++) {
-    tenEigensolve_f(eval, evec, tdata);
-    if (scaleByAniso) {
-      an = tenAnisoEval_f(eval, aniso);
-    } else {
-      an = 1.0;
+  mop = airMopNew();
+  evalBuff = AIR_CALLOC(3*AIR_MIN(N, _TEN_EIGEN_BATCH_NUM), float);
+  airMopAdd(mop, evalBuff, airFree, airMopAlways);
+  evecBuff = AIR_CALLOC(9*AIR_MIN(N, _TEN_EIGEN_BATCH_NUM), float);
+  airMopAdd(mop, evecBuff, airFree, airMopAlways);
+  if (!(evalBuff && evecBuff)) {
+    biffAddf(TEN, "%s: couldn't allocate buffers", me);
+    airMopError(mop); return 1;
+  }
+  for (base=0; base<N; base+=num) {
+    num = AIR_MIN(N - base, _TEN_EIGEN_BATCH_NUM);
+    if (tenEigensolveBatch_f(evalBuff, evecBuff, tdata, num, threadNum)) {
+      biffAddf(TEN, "%s: trouble", me);
+      airMopError(mop); return 1;
+    }
+    for (I=base; I<base+num; I++) {
+      eval = evalBuff + 3*(I - base);
+      evec = evecBuff + 9*(I - base);
+      if (scaleByAniso) {
+        an = tenAnisoEval_f(eval, aniso);
+      } else {
+        an = 1.0;
+      }
+      qdata[I] = tenEvqSingle(evec+ 3*which, an);
+      tdata += 7;
     }
-    qdata[I] = tenEvqSingle(evec+ 3*which, an);
-    tdata += 7;
   }
   ELL_3V_SET(map, 1, 2, 3);
   if (nrrdAxisInfoCopy(nout, nin, map, (NRRD_AXIS_INFO_SIZE_BIT
                                         | NRRD_AXIS_INFO_KIND_BIT) )) {
     biffMovef(TEN, NRRD, "%s: trouble", me);
-    return 1;
+    airMopError(mop); return 1;
   }
   if (nrrdBasicInfoCopy(nout, nin,
                         NRRD_BASIC_INFO_ALL ^ NRRD_BASIC_INFO_SPACE)) {
     biffAddf(TEN, "%s:", me);
-    return 1;
+    airMopError(mop); return 1;
   }
 
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+tenEvqVolume(Nrrd *nout,
+             const Nrrd *nin, int which, int aniso, int scaleByAniso) {
+  static const char me[]="tenEvqVolume";
+
+  if (tenEvqVolumeParallel(nout, nin, which, aniso, scaleByAniso, 1)) {
+    biffAddf(TEN, "%s: trouble", me);
+    return 1;
+  }
   return 0;
 }
 
@@ -89,6 +89,10 @@ extern "C" {
     nrrdNuke(npadtmp);                                                  \
   }
 
+/* number of tensors handed to each call of tenEigensolveBatch_f by
+   volume-level functions, which bounds the size of their buffers */
+#define _TEN_EIGEN_BATCH_NUM 65536
+
 /* qseg.c: 2-tensor estimation */
 extern void _tenQball(const double b, const int gradcount,
                       const double svals[], const double grads[],
@@ -147,6 +151,9 @@ extern int tenQGLInterpN(double tenOut[7],
                          const double *wght,
                          unsigned int NN, int ptype, tenInterpParm *tip);
 
+/* fiber.c */
+extern int tenFiberMultiCheck(airArray *arr);
+
 /* experSpec.c */
 TEN_EXPORT double _tenExperSpec_sqe(const double *dwiMeas,
                                     const double *dwiSim,
@@ -10,6 +10,7 @@ set(TEN_SOURCES
   epireg.c
   estimate.c
   fiber.c
+  fiberMap.c
   fiberMethods.c
   glyph.c
   grads.c
@@ -45,6 +46,7 @@ set(TEN_SOURCES
   tendExp.c
   tendExpand.c
   tendFiber.c
+  tendFibmap.c
   tendFlotsam.c
   tendGlyph.c
   tendGrads.c
@@ -191,8 +191,32 @@ typedef struct {
   size_t slicePos;
   int doSlice, sliceAnisoType;
   float sliceOffset, sliceBias, sliceGamma;
+
+  /* tenGlyphInstanceGen finds the per-glyph transforms, colors, and
+     shapes with threadNum threads.  It quantizes superquadric exponents
+     to multiples of 1/shapeRes, so that only one glyph per quantized
+     shape has to be polygonalized */
+  unsigned int threadNum, shapeRes;
 } tenGlyphParm;
 
+/*
+******** tenGlyphInstance struct
+**
+** output of tenGlyphInstanceGen: a small library of glyph shapes, each
+** polygonalized once (with normals) in its own frame, and for each of
+** the glyphs shown, which shape it is, and its transform and color.
+** tenGlyphInstancePolyData turns this into one limnPolyData.
+*/
+typedef struct {
+  limnPolyData **shape;  /* shapeNum glyph shapes */
+  unsigned int shapeNum;
+  Nrrd *nshape,          /* 1-D N array of uint indices into shape[] */
+    *nxform,             /* 16-by-N float array of 4x4 transforms, as
+                            used by ELL_4MV_MUL, from shape to world */
+    *nrgba;              /* 4-by-N uchar array of colors */
+  airArray *shapeArr;
+} tenGlyphInstance;
+
 #define TEN_ANISO_DESC \
   "All the Westin metrics come in two versions.  Currently supported:\n " \
   "\b\bo \"cl1\", \"cl2\": Westin's linear\n " \
@@ -673,6 +697,8 @@ typedef struct {
                          copied directly to output */
     genAlpha;         /* when output value set is flexible, create RGBA
                          values instead of just RGB */
+  unsigned int threadNum; /* number of threads for eigensolving in
+                             tenEvecRGB */
 } tenEvecRGBParm;
 
 /*
@@ -864,7 +890,8 @@ typedef struct {
   int whyStop[2],       /* why backward/forward (0/1) tracing stopped
                            (from tenFiberStop* enum) */
     whyNowhere;         /* why fiber never got started (from tenFiberStop*) */
-
+  size_t probeNum;      /* running count of gage probes done with this
+                           context, for measuring throughput */
 } tenFiberContext;
 
 /*
@@ -897,6 +924,9 @@ typedef struct {
   tenFiberSingle *fiber;
   unsigned int fiberNum;
   airArray *fiberArr;
+  /* ------- output of last tenFiberMultiTrace{,Parallel} */
+  double traceTime;     /* wall-clock seconds spent tracing */
+  size_t probeNum;      /* total number of gage probes, over all threads */
 } tenFiberMulti;
 
 /*
@@ -964,9 +994,14 @@ typedef struct {
                              end of first distribution phase */
     minMean,              /* mean gradient length that signifies end of
                              secondary balancing phase */
-    minMeanImprovement;   /* magnitude of improvement (reduction) of mean
+    minMeanImprovement,   /* magnitude of improvement (reduction) of mean
                              gradient length that signifies end of
                              secondary balancing phase */
+    theta;                /* if non-zero, the opening angle (cell size
+                             over distance) of the Barnes-Hut octree
+                             approximation of the repulsion, used in
+                             place of the exact all-pairs computation.
+                             0 (the default) means exact */
   int single,             /* distribute single points, instead of
                              anti-podal pairs of points */
     insertZeroVec,        /* when computing output in
@@ -988,8 +1023,12 @@ typedef struct {
                              which can be useful for high exponents,
                              for which potential measurements can
                              easily go to infinity */
-    maxIteration;         /* bail if we haven't converged by this number
+    maxIteration,         /* bail if we haven't converged by this number
                              of iterations */
+    restartNum,           /* number of random initial distributions that
+                             tenGradientGenerate starts from, keeping the
+                             result with the lowest potential */
+    threadNum;            /* number of threads used for those restarts */
   double expo_d;          /* floating point exponent.  If expo is zero,
                              this is the value that matters */
   /* ----------------------- INTERNAL */
@@ -997,11 +1036,15 @@ typedef struct {
                              the algorithm depending on progress) */
     nudge;                /* how to increase realDT with each iteration */
   /* ----------------------- OUTPUT */
-  unsigned int itersUsed; /* total number of iterations */
+  unsigned int itersUsed, /* total number of iterations */
+    restartBest;          /* which restart of tenGradientGenerate gave
+                             the output */
   double potential,       /* potential, without edge normalization */
     potentialNorm,        /* potential, with edge normalization */
     angle,                /* minimum angle */
-    edge;                 /* minimum edge length */
+    edge,                 /* minimum edge length */
+    potentialChange,      /* fractional change in potential, and */
+    velocity;             /* mean velocity, at the last iteration */
 } tenGradientParm;
 
 /*
@@ -1347,6 +1390,13 @@ TEN_EXPORT int tenGlyphGen(limnObject *glyphs, echoScene *scene,
                            tenGlyphParm *parm,
                            const Nrrd *nten, const Nrrd *npos,
                            const Nrrd *nslc);
+TEN_EXPORT tenGlyphInstance *tenGlyphInstanceNew(void);
+TEN_EXPORT tenGlyphInstance *tenGlyphInstanceNix(tenGlyphInstance *gin);
+TEN_EXPORT int tenGlyphInstanceGen(tenGlyphInstance *gin,
+                                   tenGlyphParm *parm,
+                                   const Nrrd *nten, const Nrrd *npos);
+TEN_EXPORT int tenGlyphInstancePolyData(limnPolyData *pld,
+                                        const tenGlyphInstance *gin);
 TEN_EXPORT unsigned int tenGlyphBqdZoneEval(const double eval[3]);
 TEN_EXPORT void tenGlyphBqdUvEval(double uv[2], const double eval[3]);
 TEN_EXPORT void tenGlyphBqdEvalUv(double eval[3], const double uv[2]);
@@ -1370,6 +1420,9 @@ TEN_EXPORT int tenEigensolve_f(float eval[3], float evec[9],
                                const float ten[7]);
 TEN_EXPORT int tenEigensolve_d(double eval[3], double evec[9],
                                const double ten[7]);
+TEN_EXPORT int tenEigensolveBatch_f(float *eval, float *evec,
+                                    const float *ten, size_t num,
+                                    unsigned int threadNum);
 TEN_EXPORT void tenMakeSingle_f(float ten[7],
                                 float conf, const float eval[3],
                                 const float evec[9]);
@@ -1519,9 +1572,17 @@ TEN_EXPORT int tenAnisoPlot(Nrrd *nout, int aniso, unsigned int res,
                             int hflip, int whole, int nanout);
 TEN_EXPORT int tenAnisoVolume(Nrrd *nout, const Nrrd *nin,
                               int aniso, double confThresh);
+TEN_EXPORT int tenAnisoVolumeParallel(Nrrd *nout, const Nrrd *nin,
+                                      int aniso, double confThresh,
+                                      unsigned int threadNum);
 TEN_EXPORT int tenAnisoHistogram(Nrrd *nout, const Nrrd *nin,
                                  const Nrrd *nwght, int right,
                                  int version, unsigned int resolution);
+TEN_EXPORT int tenAnisoHistogramParallel(Nrrd *nout, const Nrrd *nin,
+                                         const Nrrd *nwght, int right,
+                                         int version,
+                                         unsigned int resolution,
+                                         unsigned int threadNum);
 TEN_EXPORT tenEvecRGBParm *tenEvecRGBParmNew(void);
 TEN_EXPORT tenEvecRGBParm *tenEvecRGBParmNix(tenEvecRGBParm *rgbp);
 TEN_EXPORT int tenEvecRGBParmCheck(const tenEvecRGBParm *rgbp);
@@ -1538,6 +1599,9 @@ TEN_EXPORT int tenEvecRGB(Nrrd *nout, const Nrrd *nin,
 TEN_EXPORT short tenEvqSingle_f(float vec[3], float scl);
 TEN_EXPORT int tenEvqVolume(Nrrd *nout, const Nrrd *nin, int which,
                             int aniso, int scaleByAniso);
+TEN_EXPORT int tenEvqVolumeParallel(Nrrd *nout, const Nrrd *nin, int which,
+                                    int aniso, int scaleByAniso,
+                                    unsigned int threadNum);
 TEN_EXPORT int tenBMatrixCheck(const Nrrd *nbmat,
                                int type, unsigned int minnum);
 TEN_EXPORT int _tenFindValley(double *valP, const Nrrd *nhist,
@@ -1595,14 +1659,40 @@ TEN_EXPORT tenFiberMulti *tenFiberMultiNew(void);
 TEN_EXPORT tenFiberMulti *tenFiberMultiNix(tenFiberMulti *tfm);
 TEN_EXPORT int tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml,
                                   const Nrrd *nseed);
+TEN_EXPORT int tenFiberMultiTraceParallel(tenFiberContext *tfx,
+                                          tenFiberMulti *tfml,
+                                          const Nrrd *nseed,
+                                          unsigned int threadNum);
 TEN_EXPORT int tenFiberMultiPolyData(tenFiberContext *tfx,
                                      limnPolyData *lpld, tenFiberMulti *tfml);
 TEN_EXPORT int tenFiberMultiProbeVals(tenFiberContext *tfx,
                                       Nrrd *nval, tenFiberMulti *tfml);
 
+/* fiberMap.c */
+TEN_EXPORT int tenFiberMultiMap(tenFiberContext *tfx,
+                                Nrrd *ndens, Nrrd *nrgb, Nrrd *nconn,
+                                tenFiberMulti *tfml, const Nrrd *nlabel,
+                                unsigned int supersample,
+                                unsigned int threadNum);
+TEN_EXPORT int tenFiberPolyDataMap(Nrrd *ndens, Nrrd *nrgb, Nrrd *nconn,
+                                   const limnPolyData *pld, const Nrrd *nref,
+                                   int indexSpace, const Nrrd *nlabel,
+                                   unsigned int supersample,
+                                   unsigned int threadNum);
+
 /* epireg.c */
 TEN_EXPORT int _tenEpiRegThresholdFind(double *DWthrP, Nrrd **nin,
                                        int ninLen, int save, double expo);
+TEN_EXPORT int tenEpiRegister3DParallel(Nrrd **nout, Nrrd **ndwi,
+                                        unsigned int dwiLen, Nrrd *ngrad,
+                                        int reference,
+                                        double bwX, double bwY,
+                                        double fitFrac, double DWthr,
+                                        int doCC, unsigned int shrink,
+                                        const NrrdKernel *kern,
+                                        double *kparm,
+                                        unsigned int threadNum,
+                                        int progress, int verbose);
 TEN_EXPORT int tenEpiRegister3D(Nrrd **nout, Nrrd **ndwi,
                                 unsigned int dwiLen, Nrrd *ngrad,
                                 int reference,
@@ -1611,6 +1701,15 @@ TEN_EXPORT int tenEpiRegister3D(Nrrd **nout, Nrrd **ndwi,
                                 int doCC,
                                 const NrrdKernel *kern, double *kparm,
                                 int progress, int verbose);
+TEN_EXPORT int tenEpiRegister4DParallel(Nrrd *nout, Nrrd *nin, Nrrd *ngrad,
+                                        int reference,
+                                        double bwX, double bwY,
+                                        double fitFrac, double DWthr,
+                                        int doCC, unsigned int shrink,
+                                        const NrrdKernel *kern,
+                                        double *kparm,
+                                        unsigned int threadNum,
+                                        int progress, int verbose);
 TEN_EXPORT int tenEpiRegister4D(Nrrd *nout, Nrrd *nin, Nrrd *ngrad,
                                 int reference,
                                 double bwX, double bwY,
@@ -1803,6 +1902,7 @@ F(point) \
 F(slice) \
 F(norm) \
 F(fiber) \
+F(fibmap) \
 F(eval) \
 F(evalpow) \
 F(evalclamp) \
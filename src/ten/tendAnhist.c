@@ -40,6 +40,7 @@ tend_anhistMain(int argc, const char **argv, const char *me,
   airArray *mop;
 
   int version, res, right;
+  unsigned int threadNum;
   Nrrd *nin, *nout, *nwght;
   char *outS;
 
@@ -57,6 +58,9 @@ tend_anhistMain(int argc, const char **argv, const char *me,
   hestOptAdd(&hopt, "right", NULL, airTypeInt, 0, 0, &right, NULL,
              "sample a right-triangle-shaped region, instead of "
              "a roughly equilateral triangle. ");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1,
+             &threadNum, "1",
+             "number of threads to use for eigensolving");
   hestOptAdd(&hopt, "i", "nin", airTypeOther, 1, 1, &nin, "-",
              "input diffusion tensor volume", NULL, NULL, nrrdHestNrrd);
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
@@ -71,7 +75,8 @@ tend_anhistMain(int argc, const char **argv, const char *me,
   nout = nrrdNew();
   airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
 
-  if (tenAnisoHistogram(nout, nin, nwght, right, version, res)) {
+  if (tenAnisoHistogramParallel(nout, nin, nwght, right, version, res,
+                                threadNum)) {
     airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble making histogram:\n%s\n", me, err);
     airMopError(mop); return 1;
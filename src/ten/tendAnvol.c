@@ -42,12 +42,17 @@ tend_anvolMain(int argc, const char **argv, const char *me,
   Nrrd *nin, *nout;
   char *outS;
   float thresh;
+  unsigned int threadNum;
 
   hestOptAdd(&hopt, "a", "aniso", airTypeEnum, 1, 1, &aniso, NULL,
              "Which anisotropy metric to plot.  " TEN_ANISO_DESC,
              NULL, tenAniso);
   hestOptAdd(&hopt, "t", "thresh", airTypeFloat, 1, 1, &thresh, "0.5",
              "confidence threshold");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1,
+             &threadNum, "1",
+             "number of threads to use for eigensolving, for the "
+             "anisotropy metrics that need eigenvalues");
   hestOptAdd(&hopt, "i", "nin", airTypeOther, 1, 1, &nin, "-",
              "input diffusion tensor volume", NULL, NULL, nrrdHestNrrd);
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
@@ -61,7 +66,7 @@ tend_anvolMain(int argc, const char **argv, const char *me,
 
   nout = nrrdNew();
   airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
-  if (tenAnisoVolume(nout, nin, aniso, thresh)) {
+  if (tenAnisoVolumeParallel(nout, nin, aniso, thresh, threadNum)) {
     airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble making aniso volume:\n%s\n", me, err);
     airMopError(mop); return 1;
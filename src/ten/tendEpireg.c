@@ -49,7 +49,7 @@ tend_epiregMain(int argc, const char **argv, const char *me,
   char *gradS;
   NrrdKernelSpec *ksp;
   Nrrd **nin, **nout3D, *nout4D, *ngrad, *ngradKVP, *nbmatKVP;
-  unsigned int ni, ninLen, *skip, skipNum;
+  unsigned int ni, ninLen, *skip, skipNum, shrink, threadNum;
   int ref, noverbose, progress, nocc, baseNum;
   float bw[2], thr, fitFrac;
   double bvalue;
@@ -103,6 +103,16 @@ tend_epiregMain(int argc, const char **argv, const char *me,
              "quality.  This option controls how many of the (best) slices "
              "contribute to the fitting.  Use \"0\" to disable distortion "
              "parameter fitting. ");
+  hestOptAdd(&hopt, "sh", "shrink", airTypeUInt, 1, 1, &shrink, "1",
+             "estimate the distortion from DWIs downsampled by this "
+             "factor along X and Y, which speeds up the segmentation "
+             "and moment calculation considerably. The blurring "
+             "standard deviations (\"-bw\") are still in the units of "
+             "the original samples, and the registered DWIs are "
+             "always resampled at the original resolution.");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &threadNum, "1",
+             "number of threads to use for the per-DWI (and per-slice) "
+             "processing; the output doesn't depend on this");
   hestOptAdd(&hopt, "k", "kernel", airTypeOther, 1, 1, &ksp, "cubic:0,0.5",
              "kernel for resampling DWIs along the phase-encoding "
              "direction during final registration stage",
@@ -163,17 +173,17 @@ tend_epiregMain(int argc, const char **argv, const char *me,
     airMopAdd(mop, nout3D[ni], (airMopper)nrrdNuke, airMopAlways);
   }
   if (1 == ninLen) {
-    rret = tenEpiRegister4D(nout4D, nin[0], ngrad,
-                            ref,
-                            bw[0], bw[1], fitFrac, thr, !nocc,
-                            ksp->kernel, ksp->parm,
-                            progress, !noverbose);
+    rret = tenEpiRegister4DParallel(nout4D, nin[0], ngrad,
+                                    ref,
+                                    bw[0], bw[1], fitFrac, thr, !nocc,
+                                    shrink, ksp->kernel, ksp->parm,
+                                    threadNum, progress, !noverbose);
   } else {
-    rret = tenEpiRegister3D(nout3D, nin, ninLen, ngrad,
-                            ref,
-                            bw[0], bw[1], fitFrac, thr, !nocc,
-                            ksp->kernel, ksp->parm,
-                            progress, !noverbose);
+    rret = tenEpiRegister3DParallel(nout3D, nin, ninLen, ngrad,
+                                    ref,
+                                    bw[0], bw[1], fitFrac, thr, !nocc,
+                                    shrink, ksp->kernel, ksp->parm,
+                                    threadNum, progress, !noverbose);
   }
   if (rret) {
     airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
@@ -40,8 +40,9 @@ tend_evecMain(int argc, const char **argv, const char *me,
   int ret, *comp, compLen, cc;
   Nrrd *nin, *nout;
   char *outS;
-  float thresh, *edata, *tdata, eval[3], evec[9], scl;
-  size_t N, I, sx, sy, sz;
+  float thresh, *edata, *tdata, *evalBuff, *evecBuff, *evec, scl;
+  size_t N, I, sx, sy, sz, base, num;
+  unsigned int threadNum;
 
   hestOptAdd(&hopt, "c", "c0 ", airTypeInt, 1, 3, &comp, NULL,
              "which eigenvalues should be saved out. \"0\" for the "
@@ -50,6 +51,8 @@ tend_evecMain(int argc, const char **argv, const char *me,
              &compLen);
   hestOptAdd(&hopt, "t", "thresh", airTypeFloat, 1, 1, &thresh, "0.5",
              "confidence threshold");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &threadNum, "1",
+             "number of threads to use for eigensolving");
   hestOptAdd(&hopt, "i", "nin", airTypeOther, 1, 1, &nin, "-",
              "input diffusion tensor volume", NULL, NULL, nrrdHestNrrd);
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
@@ -91,22 +94,29 @@ tend_evecMain(int argc, const char **argv, const char *me,
   N = sx*sy*sz;
   edata = (float *)nout->data;
   tdata = (float *)nin->data;
-  if (1 == compLen) {
-    for (I=0; I<N; I++) {
-      tenEigensolve_f(eval, evec, tdata);
-      scl = AIR_CAST(float, tdata[0] >= thresh);
-      ELL_3V_SCALE(edata, scl, evec+3*comp[0]);
-      edata += 3;
-      tdata += 7;
+  evalBuff = AIR_CALLOC(3*AIR_MIN(N, _TEN_EIGEN_BATCH_NUM), float);
+  airMopAdd(mop, evalBuff, airFree, airMopAlways);
+  evecBuff = AIR_CALLOC(9*AIR_MIN(N, _TEN_EIGEN_BATCH_NUM), float);
+  airMopAdd(mop, evecBuff, airFree, airMopAlways);
+  if (!(evalBuff && evecBuff)) {
+    fprintf(stderr, "%s: couldn't allocate eigensystem buffers\n", me);
+    airMopError(mop); return 1;
+  }
+  for (base=0; base<N; base+=num) {
+    num = AIR_MIN(N - base, _TEN_EIGEN_BATCH_NUM);
+    if (tenEigensolveBatch_f(evalBuff, evecBuff, tdata, num, threadNum)) {
+      airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble eigensolving:\n%s\n", me, err);
+      airMopError(mop); return 1;
     }
-  } else {
-    for (I=0; I<N; I++) {
-      tenEigensolve_f(eval, evec, tdata);
+    evec = evecBuff;
+    for (I=0; I<num; I++) {
       scl = AIR_CAST(float, tdata[0] >= thresh);
       for (cc=0; cc<compLen; cc++) {
         ELL_3V_SCALE(edata+3*cc, scl, evec+3*comp[cc]);
       }
       edata += 3*compLen;
+      evec += 9;
       tdata += 7;
     }
   }
@@ -63,6 +63,9 @@ tend_evecrgbMain(int argc, const char **argv, const char *me,
              "decreases (while confidence remains 1.0)");
   hestOptAdd(&hopt, "gam", "gamma", airTypeDouble, 1, 1, &(rgbp->gamma), "1",
              "gamma to use on color components");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1,
+             &(rgbp->threadNum), "1",
+             "number of threads to use for eigensolving");
   hestOptAdd(&hopt, "i", "nin", airTypeOther, 1, 1, &nin, "-",
              "input diffusion tensor volume", NULL, NULL, nrrdHestNrrd);
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
@@ -43,6 +43,7 @@ tend_evqMain(int argc, const char **argv, const char *me,
   airArray *mop;
 
   int which, aniso, dontScaleByAniso;
+  unsigned int threadNum;
   Nrrd *nin, *nout;
   char *outS;
 
@@ -59,6 +60,9 @@ tend_evqMain(int argc, const char **argv, const char *me,
              "Don't attenuate the color by anisotropy.  By default (not "
              "using this option), regions with low or no anisotropy are "
              "very dark colors or black");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1,
+             &threadNum, "1",
+             "number of threads to use for eigensolving");
   hestOptAdd(&hopt, "i", "nin", airTypeOther, 1, 1, &nin, "-",
              "input diffusion tensor volume", NULL, NULL, nrrdHestNrrd);
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
@@ -72,7 +76,8 @@ tend_evqMain(int argc, const char **argv, const char *me,
 
   nout = nrrdNew();
   airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
-  if (tenEvqVolume(nout, nin, which, aniso, !dontScaleByAniso)) {
+  if (tenEvqVolumeParallel(nout, nin, which, aniso, !dontScaleByAniso,
+                           threadNum)) {
     airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble quantizing eigenvectors:\n%s\n", me, err);
     airMopError(mop); return 1;
@@ -47,7 +47,7 @@ tend_fiberMain(int argc, const char **argv, const char *me,
   int E, intg, useDwi, allPaths, verbose, worldSpace, worldSpaceOut,
     ftype, ftypeDef;
   Nrrd *nin, *nseed, *nmat, *_nmat;
-  unsigned int si, stopLen, whichPath;
+  unsigned int si, stopLen, whichPath, threadNum;
   double matx[16]={1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
   tenFiberMulti *tfml;
   limnPolyData *fiberPld;
@@ -109,6 +109,10 @@ tend_fiberMain(int argc, const char **argv, const char *me,
              &stopLen, NULL, tendFiberStopCB);
   hestOptAdd(&hopt, "v", "verbose", airTypeInt, 1, 1, &verbose, "0",
              "verbosity level");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1,
+             &threadNum, "1",
+             "number of threads to trace with, when given multiple seed "
+             "points via \"-ns\" (DWI tracing always uses one thread)");
   hestOptAdd(&hopt, "nmat", "transform", airTypeOther, 1, 1, &_nmat, "",
              "a 4x4 homogenous transform matrix (as a nrrd, or just a text "
              "file) given with this option will be applied to the output "
@@ -273,7 +277,7 @@ tend_fiberMain(int argc, const char **argv, const char *me,
     */
     fiberPld = limnPolyDataNew();
     airMopAdd(mop, fiberPld, (airMopper)limnPolyDataNix, airMopAlways);
-    if (tenFiberMultiTrace(tfx, tfml, nseed)
+    if (tenFiberMultiTraceParallel(tfx, tfml, nseed, threadNum)
         || tenFiberMultiPolyData(tfx, fiberPld, tfml)) {
       airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
       fprintf(stderr, "%s: trouble:\n%s\n", me, err);
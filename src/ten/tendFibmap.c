@@ -0,0 +1,127 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "ten.h"
+#include "privateTen.h"
+
+#define INFO "Fiber density, direction color, and connectivity maps"
+static const char *_tend_fibmapInfoL =
+  (INFO
+   ", from fibers (such as from \"tend fiber -ap\") saved as polydata. "
+   "The maps are on the grid of a given reference volume. Each fiber "
+   "counts once in the density of every voxel it passes through.\n "
+   "* Uses tenFiberPolyDataMap");
+
+int
+tend_fibmapMain(int argc, const char **argv, const char *me,
+                hestParm *hparm) {
+  int pret;
+  hestOpt *hopt = NULL;
+  char *perr, *err;
+  airArray *mop;
+
+  limnPolyData *pld;
+  Nrrd *nref, *nlabel, *ndens, *nrgb, *nconn;
+  char *densS, *rgbS, *connS;
+  int indexSpace;
+  unsigned int supersample, threadNum;
+
+  hestOptAdd(&hopt, "i", "fibers", airTypeOther, 1, 1, &pld, NULL,
+             "input fibers, as line strips in an LMPD polydata file",
+             NULL, NULL, limnHestPolyDataLMPD);
+  hestOptAdd(&hopt, "r", "nref", airTypeOther, 1, 1, &nref, NULL,
+             "reference volume, the grid of which is used for the maps: "
+             "either 3-D, or 4-D with a non-spatial first axis (such as "
+             "the tensor volume that the fibers were traced in)",
+             NULL, NULL, nrrdHestNrrd);
+  hestOptAdd(&hopt, "isp", NULL, airTypeInt, 0, 0, &indexSpace, NULL,
+             "fiber vertices are in the index space of the reference "
+             "volume (as from \"tend fiber\" without \"-wsp\"), rather "
+             "than its world space");
+  hestOptAdd(&hopt, "ss", "supersample", airTypeUInt, 1, 1, &supersample,
+             "4", "minimum number of samples per voxel length along "
+             "each fiber segment");
+  hestOptAdd(&hopt, "l", "nlabel", airTypeOther, 1, 1, &nlabel, "",
+             "3-D volume of integer labels (on the same grid as the "
+             "reference volume), needed for \"-oc\"",
+             NULL, NULL, nrrdHestNrrd);
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1,
+             &threadNum, "1",
+             "number of threads to use; the maps don't depend on this");
+  hestOptAdd(&hopt, "od", "density", airTypeString, 1, 1, &densS, "",
+             "if given, output fiber density (number of fibers through "
+             "each voxel) to this file");
+  hestOptAdd(&hopt, "or", "rgb", airTypeString, 1, 1, &rgbS, "",
+             "if given, output mean fiber direction color (average "
+             "absolute value of unit fiber direction in each voxel) to "
+             "this file");
+  hestOptAdd(&hopt, "oc", "connect", airTypeString, 1, 1, &connS, "",
+             "if given, output connectivity matrix (number of fibers "
+             "between each pair of labels in \"-l\", with label 0 also "
+             "used for fiber ends outside the volume) to this file");
+
+  mop = airMopNew();
+  airMopAdd(mop, hopt, (airMopper)hestOptFree, airMopAlways);
+  USAGE(_tend_fibmapInfoL);
+  JUSTPARSE();
+  airMopAdd(mop, hopt, (airMopper)hestParseFree, airMopAlways);
+
+  if (!( airStrlen(densS) || airStrlen(rgbS) || airStrlen(connS) )) {
+    fprintf(stderr, "%s: didn't get any of \"-od\", \"-or\", \"-oc\"\n", me);
+    airMopError(mop); return 1;
+  }
+  if (airStrlen(connS) && !nlabel) {
+    fprintf(stderr, "%s: need label volume \"-l\" for \"-oc\"\n", me);
+    airMopError(mop); return 1;
+  }
+  ndens = nrgb = nconn = NULL;
+  if (airStrlen(densS)) {
+    ndens = nrrdNew();
+    airMopAdd(mop, ndens, (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (airStrlen(rgbS)) {
+    nrgb = nrrdNew();
+    airMopAdd(mop, nrgb, (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (airStrlen(connS)) {
+    nconn = nrrdNew();
+    airMopAdd(mop, nconn, (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (tenFiberPolyDataMap(ndens, nrgb, nconn, pld, nref, indexSpace,
+                          nlabel, supersample, threadNum)) {
+    airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble making maps:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+  if ((ndens && nrrdSave(densS, ndens, NULL))
+      || (nrgb && nrrdSave(rgbS, nrgb, NULL))
+      || (nconn && nrrdSave(connS, nconn, NULL))) {
+    airMopAdd(mop, err=biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble writing:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+TEND_CMD(fibmap, INFO);
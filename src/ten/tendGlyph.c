@@ -36,7 +36,10 @@ static const char *_tend_glyphInfoL =
    "in LaTeX, or viewing with ghostview, or distilling into PDF. "
    "The ray-traced output is a 5 channel (R,G,B,A,T) float nrrd, suitable for "
    "\"unu crop -min 0 0 0 -max 2 M M \" followed by "
-   "\"unu gamma\" and/or \"unu quantize -b 8\".");
+   "\"unu gamma\" and/or \"unu quantize -b 8\". "
+   "With \"-pd\", the output is instead polygonal data (see \"-pd\"), "
+   "which is much faster to make for many glyphs, since each distinct "
+   "glyph shape is polygonalized only once.");
 
 #define _LIMNMAGIC "LIMN0000"
 
@@ -99,7 +102,7 @@ _tendGlyphReadCams(int imgSize[2], limnCamera **camP,
 int
 tend_glyphMain(int argc, const char **argv, const char *me,
                hestParm *hparm) {
-  int pret, doRT = AIR_FALSE;
+  int pret, doRT = AIR_FALSE, doPD = AIR_FALSE;
   hestOpt *hopt = NULL;
   char *perr, *err;
   airArray *mop;
@@ -108,6 +111,8 @@ tend_glyphMain(int argc, const char **argv, const char *me,
   char *outS;
   limnCamera *cam, *hackcams;
   limnObject *glyph;
+  limnPolyData *pld;
+  tenGlyphInstance *ginst;
   limnWindow *win;
   echoObject *rect=NULL;
   echoScene *scene;
@@ -147,6 +152,10 @@ tend_glyphMain(int argc, const char **argv, const char *me,
   hestOptAdd(&hopt, "rt", NULL, airTypeFloat, 0, 0, &doRT, NULL,
              "generate ray-traced output.  By default (not using this "
              "option), postscript output is generated.");
+  hestOptAdd(&hopt, "pd", NULL, airTypeInt, 0, 0, &doPD, NULL,
+             "generate polygonal output: a limnPolyData (with colors and "
+             "normals), saved as an \".lmpd\" file.  Camera and "
+             "rendering options are ignored, and there is no slice.");
 
   hestOptAdd(&hopt, "v", "level", airTypeInt, 1, 1, &(gparm->verbose), "0",
              "verbosity level");
@@ -191,6 +200,10 @@ tend_glyphMain(int argc, const char **argv, const char *me,
              "mean that edges form more easily");
   hestOptAdd(&hopt, "gsc", "scale", airTypeFloat, 1, 1, &(gparm->glyphScale),
              "0.01", "over-all glyph size in world-space");
+  hestOptAdd(&hopt, "sres", "res", airTypeUInt, 1, 1, &(gparm->shapeRes),
+             "10", "(* polygonal only *) superquadric exponents are "
+             "quantized to multiples of 1/res, so that glyphs can share "
+             "the polygonalization of their (quantized) shape");
 
   /* how glyphs will be colored */
   hestOptAdd(&hopt, "c", "evector #", airTypeInt, 1, 1, &(gparm->colEvec), "0",
@@ -302,8 +315,8 @@ tend_glyphMain(int argc, const char **argv, const char *me,
   if (airThreadCapable) {
     hestOptAdd(&hopt, "nt", "# threads", airTypeInt, 1, 1,
                &(eparm->numThreads), "1",
-               "(* ray-traced only *) "
-               "number of threads to be used for rendering");
+               "number of threads to be used for rendering (or for "
+               "finding glyphs, with \"-pd\")");
   }
   hestOptAdd(&hopt, "al", "B U V N E", airTypeFloat, 5, 5, buvne,
              "0 -1 -1 -4 0.7",
@@ -334,7 +347,7 @@ tend_glyphMain(int argc, const char **argv, const char *me,
   airMopAdd(mop, hopt, (airMopper)hestParseFree, airMopAlways);
 
   /* set up slicing stuff */
-  if (!( -1 == slice[0] && -1 == slice[1] )) {
+  if (!doPD && !( -1 == slice[0] && -1 == slice[1] )) {
     gparm->doSlice = AIR_TRUE;
     gparm->sliceAxis = slice[0];
     gparm->slicePos = slice[1];
@@ -350,6 +363,26 @@ tend_glyphMain(int argc, const char **argv, const char *me,
   if (gparm->verbose) {
     fprintf(stderr, "%s: verbose = %d\n", me, gparm->verbose);
   }
+  if (doPD) {
+    gparm->threadNum = AIR_UINT(AIR_MAX(1, eparm->numThreads));
+    ginst = tenGlyphInstanceNew();
+    airMopAdd(mop, ginst, (airMopper)tenGlyphInstanceNix, airMopAlways);
+    pld = limnPolyDataNew();
+    airMopAdd(mop, pld, (airMopper)limnPolyDataNix, airMopAlways);
+    if (tenGlyphInstanceGen(ginst, gparm, nin, npos)
+        || tenGlyphInstancePolyData(pld, ginst)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble generating glyphs:\n%s\n", me, err);
+      airMopError(mop); return 1;
+    }
+    if (limnPolyDataSave(outS, pld)) {
+      airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble saving glyphs:\n%s\n", me, err);
+      airMopError(mop); return 1;
+    }
+    airMopOkay(mop);
+    return 0;
+  }
   if (tenGlyphGen(doRT ? NULL : glyph,
                   doRT ? scene : NULL,
                   gparm,
@@ -37,7 +37,10 @@ static const char *_tend_gradsInfoL =
    "tries sign changes in gradient directions in trying to find an optimally "
    "balanced set of directions.  This uses a randomized search, so if it "
    "doesn't seem to be finishing in a reasonable amount of time, try "
-   "restarting with a different \"-seed\".");
+   "restarting with a different \"-seed\". For many directions, "
+   "\"-theta\" speeds up the repulsion with an octree approximation, "
+   "and \"-restarts\" tries several random starts (in parallel with "
+   "\"-nt\") and keeps the best.");
 
 int
 tend_gradsMain(int argc, const char **argv, const char *me,
@@ -107,6 +110,22 @@ tend_gradsMain(int argc, const char **argv, const char *me,
              &(tgparm->minMean), "0.0001",
              "if length of mean gradient falls below this, finish "
              "the balancing phase");
+  hestOptAdd(&hopt, "theta", "angle", airTypeDouble, 1, 1,
+             &(tgparm->theta), "0",
+             "if non-zero, use a Barnes-Hut octree approximation of the "
+             "repulsion, with this opening angle (the ratio of cell size "
+             "to distance, e.g. 0.5), instead of the exact computation. "
+             "Worthwhile for hundreds of directions or more. For the "
+             "last bit of accuracy, follow with a second pass (\"-i\", "
+             "\"-jitter 0\") without it.");
+  hestOptAdd(&hopt, "restarts", "# restarts", airTypeUInt, 1, 1,
+             &(tgparm->restartNum), "1",
+             "when not given \"-i\", the number of different random "
+             "initial distributions (seeds \"-seed\", \"-seed\"+1, ...) "
+             "to run, keeping the one with the lowest potential");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1,
+             &(tgparm->threadNum), "1",
+             "number of threads over which to spread the restarts");
   hestOptAdd(&hopt, "izv", "insert", airTypeBool, 1, 1,
              &(tgparm->insertZeroVec), "false",
              "adding zero vector at beginning of grads");
@@ -140,6 +159,18 @@ tend_gradsMain(int argc, const char **argv, const char *me,
     fprintf(stderr, "%s: trouble making distribution:\n%s\n", me, err);
     airMopError(mop); return 1;
   }
+  if (tgparm->verbose) {
+    fprintf(stderr, "%s: %u iterations; potential = %g "
+            "(last change %g), velocity = %g, min angle = %g deg",
+            me, tgparm->itersUsed, tgparm->potentialNorm,
+            tgparm->potentialChange, tgparm->velocity,
+            180*tgparm->angle/AIR_PI);
+    if (!nin && tgparm->restartNum > 1) {
+      fprintf(stderr, "; from restart %u of %u", tgparm->restartBest,
+              tgparm->restartNum);
+    }
+    fprintf(stderr, "\n");
+  }
 
   if (nrrdSave(outS, nout, NULL)) {
     airMopAdd(mop, err=biffGetDone(NRRD), airFree, airMopAlways);
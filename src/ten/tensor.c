@@ -482,7 +482,54 @@ tenEigensolve_d(double _eval[3], double evec[9], const double t[7]) {
   return ret;
 }
 
+/*
+******** tenEigensolveBatch_f
+**
+** for num tensors stored contiguously in ten (7 floats each), does the
+** same as calling tenEigensolve_f on each one, but (via
+** ell_3ms_eigensolve_batch_f) more efficiently and with threadNum
+** threads.  eval must have room for 3*num floats; evec is either NULL
+** (if only eigenvalues are needed) or has room for 9*num floats.
+**
+** This DOES use biff
+*/
+int
+tenEigensolveBatch_f(float *eval, float *evec, const float *ten,
+                     size_t num, unsigned int threadNum) {
+  static const char me[]="tenEigensolveBatch_f";
+  int *roots;
+  size_t II;
 
+  if (!(eval && ten)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!num) {
+    return 0;
+  }
+  roots = AIR_CALLOC(num, int);
+  if (!roots) {
+    biffAddf(TEN, "%s: couldn't allocate %u roots", me,
+             AIR_CAST(unsigned int, num));
+    return 1;
+  }
+  if (ell_3ms_eigensolve_batch_f(eval, evec, roots, ten + 1, 7, num,
+                                 AIR_TRUE, AIR_TRUE, threadNum)) {
+    biffMovef(TEN, ELL, "%s: trouble", me);
+    free(roots);
+    return 1;
+  }
+  if (evec) {
+    /* tenEigensolve_f does some additional fixing with repeated roots */
+    for (II=0; II<num; II++) {
+      if (ell_cubic_root_single_double == roots[II]) {
+        tenEigensolve_f(eval + 3*II, evec + 9*II, ten + 7*II);
+      }
+    }
+  }
+  free(roots);
+  return 0;
+}
 
 /*  lop A
     fprintf(stderr, "###################################  I = %d\n", (int)I);
@@ -32,7 +32,7 @@
 const unsigned int _tijk_max_candidates_2d=8;
 
 #define _CANDIDATES_2D(TYPE, SUF)                 \
-  static TYPE _candidates_2d_##SUF[16] = {        \
+  TYPE _tijk_candidates_2d_##SUF[16] = {          \
     1.0, 0.0,                                     \
     0.92387953251128674, 0.38268343236508978,     \
     0.70710678118654757, 0.70710678118654746,     \
@@ -49,7 +49,7 @@ _CANDIDATES_2D(float, f)
 const unsigned int _tijk_max_candidates_3d=30;
 
 #define _CANDIDATES_3D(TYPE, SUF)             \
-  static TYPE _candidates_3d_##SUF[90] = {    \
+  TYPE _tijk_candidates_3d_##SUF[90] = {      \
     -0.546405, 0.619202, 0.563943,            \
     -0.398931,-0.600006, 0.693432,            \
     0.587973, 0.521686, 0.618168,             \
@@ -96,7 +96,7 @@ _CANDIDATES_3D(float, f)
                                  const tijk_type *type) {           \
     TYPE absmax=-1;                                                 \
     unsigned int i;                                                 \
-    TYPE *candidate=_candidates_##DIM##d_##SUF;                     \
+    TYPE *candidate=_tijk_candidates_##DIM##d_##SUF;                \
     if (type->dim!=DIM || type->sym==NULL)                          \
       return 1;                                                     \
     for (i=0; i<_tijk_max_candidates_##DIM##d; i++) {               \
@@ -129,7 +129,7 @@ _TIJK_INIT_RANK1(float, f, 3)
                                const tijk_type *type) {           \
     TYPE max=0;                                                   \
     unsigned int i;                                               \
-    TYPE *candidate=_candidates_##DIM##d_##SUF;                   \
+    TYPE *candidate=_tijk_candidates_##DIM##d_##SUF;              \
     if (type->dim!=DIM || type->sym==NULL)                        \
       return 1;                                                   \
     *s=max=(*type->sym->s_form_##SUF)(ten, candidate);            \
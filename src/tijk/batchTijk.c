@@ -0,0 +1,438 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "tijk.h"
+#include "privateTijk.h"
+
+#include "convertQuietPush.h"
+
+/* Batched versions of per-tensor functions, operating on N tensors
+ * that are stored contiguously (i.e., tensor n starts at n*type->num).
+ *
+ * Tensors are processed in blocks of _TIJK_BATCH_LEN, and the innermost
+ * loops run over the tensors within a block, so that they are free of
+ * data-dependent control flow and can be vectorized by the compiler.
+ * Evaluating a linear functional (such as the homogeneous form at a given
+ * direction, or an SH series at a given (theta,phi)) for many tensors is
+ * done by first computing a "basis" that represents the functional, and
+ * then applying it to all tensors, which amounts to a matrix product.
+ *
+ * Results agree with the per-tensor functions up to rounding (the order
+ * of summation is different).
+ */
+
+#define _TIJK_BATCH_LEN 64
+
+/* weights such that tsp(A,B) = sum_i w[i]*A[i]*B[i] */
+#define _TIJK_BATCH_WEIGHTS(TYPE, SUF)                                  \
+  static void                                                           \
+  _tijk_batch_weights_##SUF(TYPE *wght, const tijk_type *type) {        \
+    unsigned int ii;                                                    \
+    for (ii=0; ii<type->num; ii++) {                                    \
+      wght[ii]=(NULL!=type->mult) ? type->mult[ii] : 1;                 \
+    }                                                                   \
+  }
+
+_TIJK_BATCH_WEIGHTS(double, d)
+_TIJK_BATCH_WEIGHTS(float, f)
+
+/* Computes the tensor scalar product of N pairs of tensors:
+ * res[n] = tsp(A+n*type->num, B+n*type->num)
+ * res needs to have space for N values.
+ */
+#define _TIJK_TSP_BATCH(TYPE, SUF)                                      \
+  void                                                                  \
+  tijk_tsp_batch_##SUF(TYPE *res, const TYPE *A, const TYPE *B,         \
+                       const tijk_type *type, const unsigned int N) {   \
+    TYPE wght[TIJK_TYPE_MAX_NUM], acc[_TIJK_BATCH_LEN];                 \
+    unsigned int num=type->num, base, blen, bi, ii;                     \
+    _tijk_batch_weights_##SUF(wght, type);                              \
+    for (base=0; base<N; base+=_TIJK_BATCH_LEN) {                       \
+      const TYPE *AA=A+base*num, *BB=B+base*num;                        \
+      blen=AIR_MIN(_TIJK_BATCH_LEN, N-base);                            \
+      for (bi=0; bi<blen; bi++)                                         \
+        acc[bi]=0;                                                      \
+      for (ii=0; ii<num; ii++) {                                        \
+        TYPE ww=wght[ii];                                               \
+        for (bi=0; bi<blen; bi++)                                       \
+          acc[bi]+=ww*AA[bi*num+ii]*BB[bi*num+ii];                      \
+      }                                                                 \
+      for (bi=0; bi<blen; bi++)                                         \
+        res[base+bi]=acc[bi];                                           \
+    }                                                                   \
+  }
+
+_TIJK_TSP_BATCH(double, d)
+_TIJK_TSP_BATCH(float, f)
+
+/* Computes the norms of N tensors: res[n] = norm(A+n*type->num)
+ * res needs to have space for N values.
+ */
+#define _TIJK_NORM_BATCH(TYPE, SUF)                                     \
+  void                                                                  \
+  tijk_norm_batch_##SUF(TYPE *res, const TYPE *A,                       \
+                        const tijk_type *type, const unsigned int N) {  \
+    unsigned int nn;                                                    \
+    tijk_tsp_batch_##SUF(res, A, A, type, N);                           \
+    for (nn=0; nn<N; nn++)                                              \
+      res[nn]=sqrt(res[nn]);                                            \
+  }
+
+_TIJK_NORM_BATCH(double, d)
+_TIJK_NORM_BATCH(float, f)
+
+/* Applies a basis to N tensors (or other coefficient vectors):
+ * res[n*bNum+j] = sum_i basis[j*len+i]*ten[n*len+i]
+ * basis has bNum rows of length len (e.g., from tijk_s_form_basis or
+ *   tijk_eval_esh_basis), ten holds N vectors of length len.
+ * res needs to have space for N*bNum values.
+ * returns 0 upon success, 1 if memory allocation failed.
+ */
+#define _TIJK_BASIS_EVAL_BATCH(TYPE, SUF)                               \
+  int                                                                   \
+  tijk_basis_eval_batch_##SUF(TYPE *res, const TYPE *basis,             \
+                              const unsigned int bNum, const TYPE *ten, \
+                              const unsigned int len,                   \
+                              const unsigned int N) {                   \
+    TYPE *tt, acc[_TIJK_BATCH_LEN];                                     \
+    /* stride in tt; no need for a full block when N is small */        \
+    const unsigned int bstr=AIR_MAX(1, AIR_MIN(N, _TIJK_BATCH_LEN));    \
+    unsigned int base, blen, bi, ii, jj;                                \
+    tt=AIR_CALLOC(len*bstr, TYPE);                                      \
+    if (NULL==tt)                                                       \
+      return 1;                                                         \
+    for (base=0; base<N; base+=_TIJK_BATCH_LEN) {                       \
+      blen=AIR_MIN(_TIJK_BATCH_LEN, N-base);                            \
+      /* transpose block, so that tensors are the fastest axis */       \
+      for (bi=0; bi<blen; bi++) {                                       \
+        const TYPE *src=ten+(base+bi)*len;                              \
+        for (ii=0; ii<len; ii++)                                        \
+          tt[ii*bstr+bi]=src[ii];                                       \
+      }                                                                 \
+      for (jj=0; jj<bNum; jj++) {                                       \
+        const TYPE *row=basis+jj*len;                                   \
+        for (bi=0; bi<blen; bi++)                                       \
+          acc[bi]=0;                                                    \
+        for (ii=0; ii<len; ii++) {                                      \
+          TYPE ww=row[ii];                                              \
+          const TYPE *col=tt+ii*bstr;                                   \
+          for (bi=0; bi<blen; bi++)                                     \
+            acc[bi]+=ww*col[bi];                                        \
+        }                                                               \
+        for (bi=0; bi<blen; bi++)                                       \
+          res[(base+bi)*bNum+jj]=acc[bi];                               \
+      }                                                                 \
+    }                                                                   \
+    free(tt);                                                           \
+    return 0;                                                           \
+  }
+
+_TIJK_BASIS_EVAL_BATCH(double, d)
+_TIJK_BASIS_EVAL_BATCH(float, f)
+
+/* Computes a basis for evaluating the homogeneous form of a symmetric
+ * tensor at vNum (unit-length) directions vs, such that
+ * s_form(ten, vs+j*type->dim) = sum_i res[j*type->num+i]*ten[i]
+ * res needs to have space for vNum*type->num values.
+ * returns 0 upon success, 1 if type is not symmetric.
+ */
+#define _TIJK_S_FORM_BASIS(TYPE, SUF)                                   \
+  int                                                                   \
+  tijk_s_form_basis_##SUF(TYPE *res, const TYPE *vs,                    \
+                          const unsigned int vNum,                      \
+                          const tijk_type *type) {                      \
+    unsigned int ii, jj;                                                \
+    if (type->sym==NULL || type->mult==NULL)                            \
+      return 1;                                                         \
+    for (jj=0; jj<vNum; jj++) {                                         \
+      TYPE *row=res+jj*type->num;                                       \
+      (*type->sym->make_rank1_##SUF)(row, 1.0, vs+jj*type->dim);        \
+      for (ii=0; ii<type->num; ii++)                                    \
+        row[ii]*=type->mult[ii];                                        \
+    }                                                                   \
+    return 0;                                                           \
+  }
+
+_TIJK_S_FORM_BASIS(double, d)
+_TIJK_S_FORM_BASIS(float, f)
+
+/* Evaluates the homogeneous forms of N symmetric tensors at vNum
+ * directions: res[n*vNum+j] = s_form(ten+n*type->num, vs+j*type->dim)
+ * res needs to have space for N*vNum values.
+ * returns 0 upon success, 1 upon erroneous parameters or if memory
+ *   allocation failed.
+ */
+#define _TIJK_S_FORM_BATCH(TYPE, SUF)                                   \
+  int                                                                   \
+  tijk_s_form_batch_##SUF(TYPE *res, const TYPE *ten,                   \
+                          const unsigned int N, const TYPE *vs,         \
+                          const unsigned int vNum,                      \
+                          const tijk_type *type) {                      \
+    TYPE *basis;                                                        \
+    int retval;                                                         \
+    if (type->sym==NULL)                                                \
+      return 1;                                                         \
+    basis=AIR_CALLOC(vNum*type->num, TYPE);                             \
+    if (NULL==basis)                                                    \
+      return 1;                                                         \
+    tijk_s_form_basis_##SUF(basis, vs, vNum, type);                     \
+    retval=tijk_basis_eval_batch_##SUF(res, basis, vNum, ten,           \
+                                       type->num, N);                   \
+    free(basis);                                                        \
+    return retval;                                                      \
+  }
+
+_TIJK_S_FORM_BATCH(double, d)
+_TIJK_S_FORM_BATCH(float, f)
+
+/* Evaluates N even-order SH series of the given order at tpNum
+ * directions (given as theta/phi pairs):
+ * res[n*tpNum+j] = tijk_eval_esh(coeffs+n*len, order, thetaphi[2*j],
+ *                                thetaphi[2*j+1])
+ * where len=tijk_esh_len[order/2].
+ * res needs to have space for N*tpNum values.
+ * returns 0 upon success, 1 upon erroneous parameters or if memory
+ *   allocation failed.
+ */
+#define _TIJK_EVAL_ESH_BATCH(TYPE, SUF)                                 \
+  int                                                                   \
+  tijk_eval_esh_batch_##SUF(TYPE *res, const TYPE *coeffs,              \
+                            const unsigned int N,                       \
+                            const unsigned int order,                   \
+                            const TYPE *thetaphi,                       \
+                            const unsigned int tpNum) {                 \
+    TYPE *basis;                                                        \
+    unsigned int len, jj;                                               \
+    int retval;                                                         \
+    if (order>tijk_max_esh_order || order%2!=0)                         \
+      return 1;                                                         \
+    len=tijk_esh_len[order/2];                                          \
+    basis=AIR_CALLOC(tpNum*len, TYPE);                                  \
+    if (NULL==basis)                                                    \
+      return 1;                                                         \
+    for (jj=0; jj<tpNum; jj++)                                          \
+      tijk_eval_esh_basis_##SUF(basis+jj*len, order,                    \
+                                thetaphi[2*jj], thetaphi[2*jj+1]);      \
+    retval=tijk_basis_eval_batch_##SUF(res, basis, tpNum, coeffs,       \
+                                       len, N);                         \
+    free(basis);                                                        \
+    return retval;                                                      \
+  }
+
+_TIJK_EVAL_ESH_BATCH(double, d)
+_TIJK_EVAL_ESH_BATCH(float, f)
+
+/* Same as tijk_init_rank1_3d, for N tensors: all candidate directions
+ * are evaluated for all tensors at once.
+ * s and v need to have space for N and 3*N values, respectively.
+ * returns 0 upon success, 1 upon erroneous parameters or if memory
+ *   allocation failed.
+ */
+#define _TIJK_INIT_RANK1_3D_BATCH(TYPE, SUF)                            \
+  int                                                                   \
+  tijk_init_rank1_3d_batch_##SUF(TYPE *s, TYPE *v, const TYPE *ten,     \
+                                 const tijk_type *type,                 \
+                                 const unsigned int N) {                \
+    const unsigned int cnum=_tijk_max_candidates_3d;                    \
+    TYPE *vals;                                                         \
+    unsigned int nn, ci;                                                \
+    if (type->dim!=3 || type->sym==NULL)                                \
+      return 1;                                                         \
+    vals=AIR_CALLOC(cnum*AIR_MIN(N, _TIJK_BATCH_LEN), TYPE);            \
+    if (NULL==vals)                                                     \
+      return 1;                                                         \
+    for (nn=0; nn<N; nn+=_TIJK_BATCH_LEN) {                             \
+      unsigned int blen=AIR_MIN(_TIJK_BATCH_LEN, N-nn), bi;             \
+      if (tijk_s_form_batch_##SUF(vals, ten+nn*type->num, blen,         \
+                                  _tijk_candidates_3d_##SUF, cnum,      \
+                                  type)) {                              \
+        free(vals);                                                     \
+        return 1;                                                       \
+      }                                                                 \
+      for (bi=0; bi<blen; bi++) {                                       \
+        const TYPE *val=vals+bi*cnum;                                   \
+        TYPE absmax=-1;                                                 \
+        unsigned int best=0;                                            \
+        for (ci=0; ci<cnum; ci++) {                                     \
+          if (fabs(val[ci])>absmax) {                                   \
+            absmax=fabs(val[ci]);                                       \
+            best=ci;                                                    \
+          }                                                             \
+        }                                                               \
+        s[nn+bi]=val[best];                                             \
+        ELL_3V_COPY(v+3*(nn+bi), _tijk_candidates_3d_##SUF+3*best);     \
+      }                                                                 \
+    }                                                                   \
+    free(vals);                                                         \
+    return 0;                                                           \
+  }
+
+_TIJK_INIT_RANK1_3D_BATCH(double, d)
+_TIJK_INIT_RANK1_3D_BATCH(float, f)
+
+/* Same as tijk_refine_rank1_3d, for N tensors.
+ * s and v hold N scalars and N (unit-len) vectors, and will be updated.
+ * returns 0 upon success
+ *         1 when given wrong parameters
+ *         2 when the Armijo scheme failed for at least one tensor (all
+ *           others have still been refined)
+ */
+#define _TIJK_REFINE_RANK1_3D_BATCH(TYPE, SUF)                          \
+  int                                                                   \
+  tijk_refine_rank1_3d_batch_##SUF(TYPE *s, TYPE *v, const TYPE *ten,   \
+                                   const tijk_type *type,               \
+                                   const tijk_refine_rank1_parm *parm,  \
+                                   const unsigned int N) {              \
+    unsigned int nn;                                                    \
+    int retval=0;                                                       \
+    if (type->dim!=3 || type->sym==NULL)                                \
+      return 1;                                                         \
+    for (nn=0; nn<N; nn++) {                                            \
+      if (tijk_refine_rank1_3d_##SUF(s+nn, v+3*nn, ten+nn*type->num,    \
+                                     type, parm))                       \
+        retval=2;                                                       \
+    }                                                                   \
+    return retval;                                                      \
+  }
+
+_TIJK_REFINE_RANK1_3D_BATCH(double, d)
+_TIJK_REFINE_RANK1_3D_BATCH(float, f)
+
+/* information passed to each thread of tijk_approx_rankk_3d_batch */
+typedef struct {
+  const tijk_type *type;
+  const tijk_refine_rankk_parm *parm;
+  unsigned int k, lo, hi;       /* rank, and range of tensors to process */
+  void *ls, *vs, *res;          /* outputs (possibly NULL) */
+  const void *ten;              /* input */
+  int retval;
+} _tijkBatchTask;
+
+#define _TIJK_APPROX_RANKK_3D_WORKER(TYPE, SUF)                         \
+  static void *                                                         \
+  _tijk_approx_rankk_3d_worker_##SUF(void *_task) {                     \
+    _tijkBatchTask *task=(_tijkBatchTask *)_task;                       \
+    const tijk_type *type=task->type;                                   \
+    const unsigned int k=task->k, num=type->num;                        \
+    const TYPE *ten=(const TYPE *)task->ten;                            \
+    TYPE *ls=(TYPE *)task->ls, *vs=(TYPE *)task->vs,                    \
+      *res=(TYPE *)task->res, *lsbuf, *vsbuf, *resbuf, *tens;           \
+    unsigned int nn, ii;                                                \
+    /* scratch for the outputs that were not requested */               \
+    lsbuf=AIR_CALLOC(k, TYPE);                                          \
+    vsbuf=AIR_CALLOC(3*k, TYPE);                                        \
+    resbuf=AIR_CALLOC(num, TYPE);                                       \
+    tens=AIR_CALLOC(k*num, TYPE);                                       \
+    if (!( lsbuf && vsbuf && resbuf && tens )) {                        \
+      task->retval=1;                                                   \
+      goto cleanup_and_exit;                                            \
+    }                                                                   \
+    for (nn=task->lo; nn<task->hi; nn++) {                              \
+      const TYPE *tt=ten+nn*num;                                        \
+      TYPE *ll=ls ? ls+nn*k : lsbuf;                                    \
+      TYPE *vv=vs ? vs+nn*3*k : vsbuf;                                  \
+      TYPE *rr=res ? res+nn*num : resbuf;                               \
+      TYPE orignorm, newnorm;                                           \
+      orignorm=newnorm=(*type->norm_##SUF)(tt);                         \
+      for (ii=0; ii<k; ii++)                                            \
+        ll[ii]=0.0;                                                     \
+      memcpy(rr, tt, sizeof(TYPE)*num);                                 \
+      if (orignorm<task->parm->eps_res || k==0)                         \
+        continue; /* nothing to do */                                   \
+      tijk_refine_rankk_3d_##SUF(ll, vv, tens, rr, &newnorm, orignorm,  \
+                                 type, k, task->parm);                  \
+    }                                                                   \
+  cleanup_and_exit:                                                     \
+    airFree(lsbuf);                                                     \
+    airFree(vsbuf);                                                     \
+    airFree(resbuf);                                                    \
+    airFree(tens);                                                      \
+    return _task;                                                       \
+  }
+
+_TIJK_APPROX_RANKK_3D_WORKER(double, d)
+_TIJK_APPROX_RANKK_3D_WORKER(float, f)
+
+/* Same as tijk_approx_rankk_3d, for N tensors, using threadNum threads
+ * (each of which handles a contiguous range of tensors).
+ * ls, vs, and res can be NULL; otherwise, they need to have space for
+ *   N*k, N*3*k, and N*type->num values, respectively.
+ * returns 0 upon success, 1 upon error (including failure to start
+ *   a thread)
+ */
+#define _TIJK_APPROX_RANKK_3D_BATCH(TYPE, SUF)                          \
+  int                                                                   \
+  tijk_approx_rankk_3d_batch_##SUF(TYPE *ls, TYPE *vs, TYPE *res,       \
+                                   const TYPE *ten,                     \
+                                   const tijk_type *type,               \
+                                   const unsigned int k,                \
+                                   const tijk_refine_rankk_parm *parm,  \
+                                   const unsigned int N,                \
+                                   unsigned int threadNum) {            \
+    tijk_refine_rankk_parm *myparm=NULL;                                \
+    _tijkBatchTask *task;                                               \
+    unsigned int ti;                                                    \
+    int retval=0;                                                       \
+    if (type->dim!=3 || type->sym==NULL)                                \
+      return 1;                                                         \
+    if (parm==NULL) {                                                   \
+      parm=myparm=tijk_refine_rankk_parm_new();                         \
+      if (NULL==myparm)                                                 \
+        return 1;                                                       \
+    }                                                                   \
+    threadNum=AIR_MAX(1, AIR_MIN(threadNum, N));                        \
+    task=AIR_CALLOC(threadNum, _tijkBatchTask);                         \
+    if (NULL==task) {                                                   \
+      retval=1;                                                         \
+      goto cleanup_and_exit;                                            \
+    }                                                                   \
+    for (ti=0; ti<threadNum; ti++) {                                    \
+      task[ti].type=type;                                               \
+      task[ti].parm=parm;                                               \
+      task[ti].k=k;                                                     \
+      task[ti].lo=AIR_UINT(AIR_CAST(airULLong, N)*ti/threadNum);        \
+      task[ti].hi=AIR_UINT(AIR_CAST(airULLong, N)*(ti+1)/threadNum);    \
+      task[ti].ls=ls;                                                   \
+      task[ti].vs=vs;                                                   \
+      task[ti].res=res;                                                 \
+      task[ti].ten=ten;                                                 \
+      task[ti].retval=0;                                                \
+    }                                                                   \
+    if (airThreadRun(threadNum, _tijk_approx_rankk_3d_worker_##SUF,     \
+                     task, sizeof(_tijkBatchTask), NULL, NULL)) {       \
+      retval=1; /* couldn't start all threads */                        \
+      goto cleanup_and_exit;                                            \
+    }                                                                   \
+    for (ti=0; ti<threadNum; ti++) {                                    \
+      retval|=task[ti].retval;                                          \
+    }                                                                   \
+  cleanup_and_exit:                                                     \
+    airFree(task);                                                      \
+    tijk_refine_rankk_parm_nix(myparm);                                 \
+    return retval;                                                      \
+  }
+
+_TIJK_APPROX_RANKK_3D_BATCH(double, d)
+_TIJK_APPROX_RANKK_3D_BATCH(float, f)
+
+#include "convertQuietPop.h"
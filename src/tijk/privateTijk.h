@@ -87,5 +87,12 @@
   };                                                          \
   const tijk_type *const tijk_##name = &_tijk_##name;
 
+/* approxTijk.c: candidate directions used by tijk_init_{rank1,max} */
+extern const unsigned int _tijk_max_candidates_2d;
+extern const unsigned int _tijk_max_candidates_3d;
+extern double _tijk_candidates_2d_d[16];
+extern float _tijk_candidates_2d_f[16];
+extern double _tijk_candidates_3d_d[90];
+extern float _tijk_candidates_3d_f[90];
 
 #endif /* TIJK_PRIVATE_HAS_BEEN_INCLUDED */
@@ -4,6 +4,7 @@ set(TIJK_SOURCES
   2dTijk.c
   3dTijk.c
   approxTijk.c
+  batchTijk.c
   enumsTijk.c
   fsTijk.c
   miscTijk.c
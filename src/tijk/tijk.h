@@ -368,6 +368,86 @@ TIJK_EXPORT int tijk_approx_heur_3d_f(float *ls, float *vs, float *res,
                                       const unsigned int k,
                                       const tijk_approx_heur_parm *parm);
 
+/* batchTijk.c */
+TIJK_EXPORT void tijk_tsp_batch_d(double *res, const double *A,
+                                  const double *B, const tijk_type *type,
+                                  const unsigned int N);
+TIJK_EXPORT void tijk_tsp_batch_f(float *res, const float *A,
+                                  const float *B, const tijk_type *type,
+                                  const unsigned int N);
+TIJK_EXPORT void tijk_norm_batch_d(double *res, const double *A,
+                                   const tijk_type *type,
+                                   const unsigned int N);
+TIJK_EXPORT void tijk_norm_batch_f(float *res, const float *A,
+                                   const tijk_type *type,
+                                   const unsigned int N);
+TIJK_EXPORT int tijk_basis_eval_batch_d(double *res, const double *basis,
+                                        const unsigned int bNum,
+                                        const double *ten,
+                                        const unsigned int len,
+                                        const unsigned int N);
+TIJK_EXPORT int tijk_basis_eval_batch_f(float *res, const float *basis,
+                                        const unsigned int bNum,
+                                        const float *ten,
+                                        const unsigned int len,
+                                        const unsigned int N);
+TIJK_EXPORT int tijk_s_form_basis_d(double *res, const double *vs,
+                                    const unsigned int vNum,
+                                    const tijk_type *type);
+TIJK_EXPORT int tijk_s_form_basis_f(float *res, const float *vs,
+                                    const unsigned int vNum,
+                                    const tijk_type *type);
+TIJK_EXPORT int tijk_s_form_batch_d(double *res, const double *ten,
+                                    const unsigned int N, const double *vs,
+                                    const unsigned int vNum,
+                                    const tijk_type *type);
+TIJK_EXPORT int tijk_s_form_batch_f(float *res, const float *ten,
+                                    const unsigned int N, const float *vs,
+                                    const unsigned int vNum,
+                                    const tijk_type *type);
+TIJK_EXPORT int tijk_eval_esh_batch_d(double *res, const double *coeffs,
+                                      const unsigned int N,
+                                      const unsigned int order,
+                                      const double *thetaphi,
+                                      const unsigned int tpNum);
+TIJK_EXPORT int tijk_eval_esh_batch_f(float *res, const float *coeffs,
+                                      const unsigned int N,
+                                      const unsigned int order,
+                                      const float *thetaphi,
+                                      const unsigned int tpNum);
+TIJK_EXPORT int tijk_init_rank1_3d_batch_d(double *s, double *v,
+                                           const double *ten,
+                                           const tijk_type *type,
+                                           const unsigned int N);
+TIJK_EXPORT int tijk_init_rank1_3d_batch_f(float *s, float *v,
+                                           const float *ten,
+                                           const tijk_type *type,
+                                           const unsigned int N);
+TIJK_EXPORT int tijk_refine_rank1_3d_batch_d(double *s, double *v,
+                                             const double *ten,
+                                             const tijk_type *type,
+                                             const tijk_refine_rank1_parm *parm,
+                                             const unsigned int N);
+TIJK_EXPORT int tijk_refine_rank1_3d_batch_f(float *s, float *v,
+                                             const float *ten,
+                                             const tijk_type *type,
+                                             const tijk_refine_rank1_parm *parm,
+                                             const unsigned int N);
+TIJK_EXPORT int tijk_approx_rankk_3d_batch_d(double *ls, double *vs,
+                                             double *res, const double *ten,
+                                             const tijk_type *type,
+                                             const unsigned int k,
+                                             const tijk_refine_rankk_parm *parm,
+                                             const unsigned int N,
+                                             unsigned int threadNum);
+TIJK_EXPORT int tijk_approx_rankk_3d_batch_f(float *ls, float *vs,
+                                             float *res, const float *ten,
+                                             const tijk_type *type,
+                                             const unsigned int k,
+                                             const tijk_refine_rankk_parm *parm,
+                                             const unsigned int N,
+                                             unsigned int threadNum);
+
 /* shTijk.c */
 /* at position i, number of coefficients for order 2*i */
 TIJK_EXPORT const unsigned int tijk_esh_len[];
@@ -42,7 +42,7 @@ unrrdu_cksumDoit(const char *me, char *inS, int endian,
 
   mop = airMopNew();
   airMopAdd(mop, nrrd=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  if (nrrdLoad(nrrd, inS, NULL)) {
+  if (_unrrduPipeLoad(nrrd, inS, NULL)) {
     biffMovef(me, NRRD, "%s: trouble loading \"%s\"", me, inS);
     airMopError(mop); return 1;
   }
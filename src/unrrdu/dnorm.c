@@ -319,7 +319,7 @@ unrrdu_dnormMain(int argc, const char **argv, const char *me,
                           -1.0, mean);
   }
 
-  if (nrrdSave(outS, nout, nio)) {
+  if (_unrrduPipeSave(outS, nout, nio)) {
     airMopAdd(mop, err = biffGet(NRRD), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble saving \"%s\":\n%s",
             me, outS, err);
@@ -33,7 +33,7 @@ static const char *_unrrdu_lutInfoL =
  "the output has one more dimension than the input, and each "
  "value is mapped to a scanline (along axis 0) from the "
  "lookup table.\n "
- "* Uses nrrdApply1DLut");
+ "* Uses nrrdApply1DLut, nrrdApply1DLutQuantize");
 
 int
 unrrdu_lutMain(int argc, const char **argv, const char *me,
@@ -42,8 +42,8 @@ unrrdu_lutMain(int argc, const char **argv, const char *me,
   char *out, *err;
   Nrrd *nin, *nlut, *nout;
   airArray *mop;
-  int typeOut, rescale, pret, blind8BitRange;
-  double min, max;
+  int typeOut, rescale, pret, blind8BitRange, quantize;
+  double min, max, qrange[2];
   NrrdRange *range=NULL;
 
   hestOptAdd(&opt, "m,map", "lut", airTypeOther, 1, 1, &nlut, NULL,
@@ -74,6 +74,16 @@ unrrdu_lutMain(int argc, const char **argv, const char *me,
              "By default (not using this option), the output type "
              "is the lut's type.",
              NULL, NULL, &unrrduHestMaybeTypeCB);
+  hestOptAdd(&opt, "q,quantize", NULL, airTypeInt, 0, 0, &quantize, NULL,
+             "quantize the output to 8 bits while applying the lut; "
+             "this gives the same values as applying the lut with "
+             "\"-t double\" and then \"unu quantize -b 8\" with the "
+             "range given by \"-qr\", but faster.  The output type is "
+             "then unsigned char, regardless of \"-t\".");
+  hestOptAdd(&opt, "qr,qrange", "min max", airTypeDouble, 2, 2, qrange,
+             "nan nan",
+             "with \"-q\": range of lut values to quantize.  By default, "
+             "this is the range of values in the lut.");
   OPT_ADD_NIN(nin, "input nrrd");
   OPT_ADD_NOUT(out, "output nrrd");
 
@@ -101,7 +111,9 @@ unrrdu_lutMain(int argc, const char **argv, const char *me,
   if (nrrdTypeDefault == typeOut) {
     typeOut = nlut->type;
   }
-  if (nrrdApply1DLut(nout, nin, range, nlut, typeOut, rescale)) {
+  if (quantize
+      ? nrrdApply1DLutQuantize(nout, nin, range, nlut, rescale, qrange[0], qrange[1])
+      : nrrdApply1DLut(nout, nin, range, nlut, typeOut, rescale)) {
     airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble applying LUT:\n%s", me, err);
     airMopError(mop);
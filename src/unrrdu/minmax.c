@@ -28,26 +28,41 @@
 static const char *_unrrdu_minmaxInfoL =
 (INFO ". Unlike other commands, this doesn't produce a nrrd.  It only "
  "prints to standard out the min and max values found in the input nrrd(s), "
- "and it also indicates if there are non-existent values.\n "
- "* Uses nrrdRangeNewSet");
+ "and it also indicates if there are non-existent values. With \"-min\" "
+ "or \"-max\", percentiles are printed instead of the full range, along "
+ "with a bound on their error (when found with a histogram).\n "
+ "* Uses nrrdRangePercentileFromStringSet");
 
 int
-unrrdu_minmaxDoit(const char *me, char *inS, int blind8BitRange, FILE *fout) {
+unrrdu_minmaxDoit(const char *me, char *inS, int blind8BitRange,
+                  const char *minStr, const char *maxStr, unsigned int hbins,
+                  FILE *fout) {
   Nrrd *nrrd;
   NrrdRange *range;
   airArray *mop;
 
   mop = airMopNew();
   airMopAdd(mop, nrrd=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  if (nrrdLoad(nrrd, inS, NULL)) {
+  if (_unrrduPipeLoad(nrrd, inS, NULL)) {
     biffMovef(me, NRRD, "%s: trouble loading \"%s\"", me, inS);
     airMopError(mop); return 1;
   }
 
-  range = nrrdRangeNewSet(nrrd, blind8BitRange);
+  range = nrrdRangeNew(AIR_NAN, AIR_NAN);
   airMopAdd(mop, range, (airMopper)nrrdRangeNix, airMopAlways);
+  if (nrrdRangePercentileFromStringSet(range, nrrd, minStr, maxStr,
+                                       hbins, blind8BitRange)) {
+    biffMovef(me, NRRD, "%s: trouble finding range of \"%s\"", me, inS);
+    airMopError(mop); return 1;
+  }
   airSinglePrintf(fout, NULL, "min: %.17g\n", range->min);
   airSinglePrintf(fout, NULL, "max: %.17g\n", range->max);
+  if (range->minErr || range->maxErr) {
+    airSinglePrintf(fout, NULL, "# min within %g of exact percentile\n",
+                    range->minErr);
+    airSinglePrintf(fout, NULL, "# max within %g of exact percentile\n",
+                    range->maxErr);
+  }
   if (range->min == range->max) {
     if (0 == range->min) {
       fprintf(fout, "# min == max == 0.0 exactly\n");
@@ -67,10 +82,10 @@ int
 unrrdu_minmaxMain(int argc, const char **argv, const char *me,
                   hestParm *hparm) {
   hestOpt *opt = NULL;
-  char *err, **inS;
+  char *err, **inS, *minStr, *maxStr;
   airArray *mop;
   int pret, blind8BitRange;
-  unsigned int ni, ninLen;
+  unsigned int ni, ninLen, hbins;
 #define B8DEF "false"
 
   mop = airMopNew();
@@ -84,6 +99,22 @@ unrrdu_minmaxMain(int argc, const char **argv, const char *me,
              "(" B8DEF ") is potentialy over-riding the effect of "
              "environment variable NRRD_STATE_BLIND_8_BIT_RANGE; "
              "see \"unu env\"");
+  hestOptAdd(&opt, "min,minimum", "value", airTypeString, 1, 1,
+             &minStr, "nan",
+             "if given with a \"" NRRD_MINMAX_PERC_SUFF "\" suffix, print "
+             "instead of the lowest value the value below which this "
+             "percentage of the values lie (e.g. \"1" NRRD_MINMAX_PERC_SUFF
+             "\"), as in \"unu quantize -min\"");
+  hestOptAdd(&opt, "max,maximum", "value", airTypeString, 1, 1,
+             &maxStr, "nan",
+             "if given with a \"" NRRD_MINMAX_PERC_SUFF "\" suffix, print "
+             "instead of the highest value the value above which this "
+             "percentage of the values lie, as in \"unu quantize -max\"");
+  hestOptAdd(&opt, "hb,bins", "bins", airTypeUInt, 1, 1, &hbins, "0",
+             "number of bins in histogram of values, for finding "
+             "percentiles approximately (with a bound on the error that "
+             "is also printed). By default (\"0\"), the exact percentile "
+             "values are found, which takes one more pass over the values.");
   hestOptAdd(&opt, NULL, "nin1", airTypeString, 1, -1, &inS, NULL,
              "input nrrd(s)", &ninLen);
   airMopAdd(mop, opt, (airMopper)hestOptFree, airMopAlways);
@@ -96,7 +127,8 @@ unrrdu_minmaxMain(int argc, const char **argv, const char *me,
     if (ninLen > 1) {
       fprintf(stdout, "==> %s <==\n", inS[ni]);
     }
-    if (unrrdu_minmaxDoit(me, inS[ni], blind8BitRange, stdout)) {
+    if (unrrdu_minmaxDoit(me, inS[ni], blind8BitRange, minStr, maxStr,
+                          hbins, stdout)) {
       airMopAdd(mop, err = biffGetDone(me), airFree, airMopAlways);
       fprintf(stderr, "%s: trouble with \"%s\":\n%s",
               me, inS[ni], err);
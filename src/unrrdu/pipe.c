@@ -0,0 +1,293 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "unrrdu.h"
+#include "privateUnrrdu.h"
+
+#define INFO "Run a sequence of unu commands in one process"
+static const char *_unrrdu_pipeInfoL =
+(INFO
+ ", passing nrrds between them in memory rather than through a shell "
+ "pipe. The arguments are unu commands, with their usual options, "
+ "separated by \"" UNRRDU_PIPE_SEP "\"; for example:\n "
+ "\"unu\tpipe\tresample\t-s\tx2\tx2\t-i\tin.nrrd\t" UNRRDU_PIPE_SEP
+ "\tquantize\t-b\t8\t" UNRRDU_PIPE_SEP "\tsave\t-f\tpng\t-o\tout.png\" "
+ "does the same as \"unu\tresample\t-s\tx2\tx2\t-i\tin.nrrd\t|\t"
+ "unu\tquantize\t-b\t8\t|\tunu\tsave\t-f\tpng\t-o\tout.png\", "
+ "but without formatting, writing, reading, and parsing the intermediate "
+ "results. In every command but the last, output to \"-\" (the default) "
+ "is handed to the next command, and in every command but the first, "
+ "input from \"-\" (the default) is taken from the previous command. "
+ "The output nrrd of one command becomes the input of the next "
+ "without its data being copied, but buffers are not re-used in place: "
+ "each command still allocates its own output, and the pipe holds at "
+ "most one command's input and output at a time. Output format, "
+ "encoding, and endianness only matter for the last command.\n "
+ "* Uses the \"main\" functions of the other unu commands");
+
+/*
+** The state of the pipe: the nrrd handed to the current stage by the
+** previous one, the nrrd the current stage hands to the next, and
+** whether "-" means the pipe (rather than stdin or stdout) for input
+** and output in the current stage.  unu is single-threaded, and the
+** pipe is not re-entrant, so static state is fine here.
+**
+** Nrrds are handed from one stage to the next without copying, but
+** buffers are not re-used in place across stages: each command still
+** allocates its own output (as its "main" function always has), and the
+** input it was handed is freed when the command returns.  So at most
+** the input and output of one stage are in memory at once.
+*/
+static Nrrd *_unrrduPipeNrrdIn = NULL, *_unrrduPipeNrrdOut = NULL;
+static int _unrrduPipeIn = AIR_FALSE, _unrrduPipeOut = AIR_FALSE;
+static hestCB *_unrrduPipeHestNrrdOrig = NULL;
+
+/*
+** _unrrduPipeMove
+**
+** makes ndst describe the same array as nsrc, taking over nsrc's data
+** (which is not copied); nsrc is left without data, so that nuking it
+** later does no harm.
+*/
+static int
+_unrrduPipeMove(Nrrd *ndst, Nrrd *nsrc) {
+  static const char me[]="_unrrduPipeMove";
+  size_t size[NRRD_DIM_MAX];
+
+  nrrdAxisInfoGet_nva(nsrc, nrrdAxisInfoSize, size);
+  if (nrrdWrap_nva(ndst, nsrc->data, nsrc->type, nsrc->dim, size)) {
+    biffAddf(NRRD, "%s: couldn't set up output", me);
+    return 1;
+  }
+  nrrdAxisInfoCopy(ndst, nsrc, NULL, NRRD_AXIS_INFO_SIZE_BIT);
+  nrrdBasicInfoInit(ndst, NRRD_BASIC_INFO_DATA_BIT);
+  if (nrrdBasicInfoCopy(ndst, nsrc, NRRD_BASIC_INFO_DATA_BIT)) {
+    biffAddf(NRRD, "%s: trouble copying basic info", me);
+    ndst->data = NULL;
+    return 1;
+  }
+  nsrc->data = NULL;
+  return 0;
+}
+
+/*
+** _unrrduPipeSave
+**
+** what the SAVE() macro uses instead of nrrdSave(): inside all but the
+** last stage of "unu pipe", saving to "-" hands the nrrd to the next
+** stage; otherwise this is just nrrdSave().  Errors go to NRRD.
+*/
+int
+_unrrduPipeSave(const char *outS, Nrrd *nout, NrrdIoState *nio) {
+  static const char me[]="_unrrduPipeSave";
+  Nrrd *npass;
+
+  if (!(_unrrduPipeOut && outS && !strcmp("-", outS))) {
+    return nrrdSave(outS, nout, nio);
+  }
+  if (_unrrduPipeNrrdOut) {
+    biffAddf(NRRD, "%s: already passed a nrrd to the next command", me);
+    return 1;
+  }
+  npass = nrrdNew();
+  if (_unrrduPipeMove(npass, nout)) {
+    biffAddf(NRRD, "%s: trouble passing nrrd", me);
+    nrrdNuke(npass);
+    return 1;
+  }
+  if (nio && airEndianUnknown != nio->endian
+      && airMyEndian() != nio->endian) {
+    /* the command (e.g. unu save -en) swapped the data in anticipation
+       of writing it; undo that since it stays in memory */
+    nrrdSwapEndian(npass);
+  }
+  _unrrduPipeNrrdOut = npass;
+  return 0;
+}
+
+/*
+** _unrrduPipeLoad
+**
+** like nrrdLoad(), but inside all but the first stage of "unu pipe",
+** loading "-" gets the nrrd handed over by the previous stage
+*/
+int
+_unrrduPipeLoad(Nrrd *nin, const char *inS, NrrdIoState *nio) {
+  static const char me[]="_unrrduPipeLoad";
+
+  if (!(_unrrduPipeIn && inS && !strcmp("-", inS))) {
+    return nrrdLoad(nin, inS, nio);
+  }
+  if (!_unrrduPipeNrrdIn) {
+    biffAddf(NRRD, "%s: previous command didn't output (to \"-\") "
+             "a nrrd to read", me);
+    return 1;
+  }
+  if (_unrrduPipeMove(nin, _unrrduPipeNrrdIn)) {
+    biffAddf(NRRD, "%s: trouble getting nrrd", me);
+    return 1;
+  }
+  _unrrduPipeNrrdIn = nrrdNuke(_unrrduPipeNrrdIn);
+  return 0;
+}
+
+/*
+** the stand-in for nrrdHestNrrd while running the stages of a pipe;
+** the nrrd from the previous stage is handed over as is, and hest
+** takes ownership of it (so it is nrrdNuke'd by hestParseFree)
+*/
+static int
+_unrrduPipeHestNrrdParse(void *ptr, char *str, char err[AIR_STRLEN_HUGE]) {
+  static const char me[]="_unrrduPipeHestNrrdParse";
+  Nrrd **nrrdP;
+
+  if (!(ptr && str)) {
+    sprintf(err, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!(_unrrduPipeIn && !strcmp("-", str))) {
+    return _unrrduPipeHestNrrdOrig->parse(ptr, str, err);
+  }
+  if (!_unrrduPipeNrrdIn) {
+    sprintf(err, "%s: previous command didn't output (to \"-\") "
+            "a nrrd to read", me);
+    return 1;
+  }
+  nrrdP = (Nrrd **)ptr;
+  *nrrdP = _unrrduPipeNrrdIn;
+  _unrrduPipeNrrdIn = NULL;
+  return 0;
+}
+
+static hestCB
+_unrrduPipeHestNrrd = {
+  sizeof(Nrrd *),
+  "nrrd",
+  _unrrduPipeHestNrrdParse,
+  (airMopper)nrrdNuke
+};
+
+int
+unrrdu_pipeMain(int argc, const char **argv, const char *me,
+                hestParm *hparm) {
+  char *stageMe;
+  const char **stageArgv;
+  const unrrduCmd *cmd;
+  airArray *mop;
+  int ret, argi, stageStart, stageArgc, stageIdx, stageNum, ci;
+
+  if (!argc) {
+    hestInfo(stdout, me, _unrrdu_pipeInfoL, hparm);
+    fprintf(stdout, "\nUsage: %s <cmd> [<opts>] " UNRRDU_PIPE_SEP
+            " <cmd> [<opts>] " UNRRDU_PIPE_SEP " ...\n", me);
+    return 0;
+  }
+  if (_unrrduPipeHestNrrdOrig) {
+    fprintf(stderr, "%s: can't nest \"pipe\" inside itself\n", me);
+    return 1;
+  }
+
+  /* count and check the stages before running any of them */
+  stageNum = 0;
+  stageStart = 0;
+  for (argi=0; argi<=argc; argi++) {
+    if (argi < argc && strcmp(UNRRDU_PIPE_SEP, argv[argi])) {
+      continue;
+    }
+    if (argi == stageStart) {
+      fprintf(stderr, "%s: got empty command (#%d)\n", me, stageNum);
+      return 1;
+    }
+    for (ci=0; unrrduCmdList[ci]; ci++) {
+      if (!strcmp(argv[stageStart], unrrduCmdList[ci]->name)) {
+        break;
+      }
+    }
+    if (!unrrduCmdList[ci]) {
+      fprintf(stderr, "%s: unrecognized command \"%s\" (#%d)\n", me,
+              argv[stageStart], stageNum);
+      return 1;
+    }
+    if (&unrrdu_pipeCmd == unrrduCmdList[ci]) {
+      fprintf(stderr, "%s: can't nest \"pipe\" inside itself\n", me);
+      return 1;
+    }
+    stageNum++;
+    stageStart = argi+1;
+  }
+
+  mop = airMopNew();
+  stageMe = AIR_CALLOC(strlen(me) + AIR_STRLEN_SMALL + 2, char);
+  airMopAdd(mop, stageMe, airFree, airMopAlways);
+  /* hestParse() wants a NULL-terminated argv, so each stage gets a copy */
+  stageArgv = AIR_CALLOC(AIR_CAST(size_t, argc) + 1, const char *);
+  airMopAdd(mop, AIR_CAST(void *, stageArgv), airFree, airMopAlways);
+  _unrrduPipeHestNrrdOrig = nrrdHestNrrd;
+  nrrdHestNrrd = &_unrrduPipeHestNrrd;
+  ret = 0;
+  stageIdx = 0;
+  stageStart = 0;
+  for (argi=0; argi<=argc; argi++) {
+    if (argi < argc && strcmp(UNRRDU_PIPE_SEP, argv[argi])) {
+      continue;
+    }
+    for (ci=0; strcmp(argv[stageStart], unrrduCmdList[ci]->name); ci++)
+      ;
+    cmd = unrrduCmdList[ci];
+    stageArgc = argi - stageStart - 1;
+    memcpy(stageArgv, argv + stageStart + 1, stageArgc*sizeof(const char *));
+    stageArgv[stageArgc] = NULL;
+    sprintf(stageMe, "%s %s", me, cmd->name);
+    _unrrduPipeIn = (stageIdx > 0);
+    _unrrduPipeOut = (stageIdx < stageNum-1);
+    ret = cmd->main(stageArgc, stageArgv, stageMe, hparm);
+    if (ret) {
+      break;
+    }
+    if (!stageArgc) {
+      /* the command just printed its usage info; that's all */
+      break;
+    }
+    if (_unrrduPipeNrrdIn) {
+      fprintf(stderr, "%s: WARNING: command #%d (%s) didn't read (from "
+              "\"-\") the output of the previous command\n",
+              me, stageIdx, cmd->name);
+      _unrrduPipeNrrdIn = nrrdNuke(_unrrduPipeNrrdIn);
+    }
+    _unrrduPipeNrrdIn = _unrrduPipeNrrdOut;
+    _unrrduPipeNrrdOut = NULL;
+    stageIdx++;
+    stageStart = argi+1;
+  }
+  /* the stages report their own errors; here we just clean up */
+  _unrrduPipeNrrdIn = nrrdNuke(_unrrduPipeNrrdIn);
+  _unrrduPipeNrrdOut = nrrdNuke(_unrrduPipeNrrdOut);
+  _unrrduPipeIn = _unrrduPipeOut = AIR_FALSE;
+  nrrdHestNrrd = _unrrduPipeHestNrrdOrig;
+  _unrrduPipeHestNrrdOrig = NULL;
+
+  airMopOkay(mop);
+  return ret;
+}
+
+UNRRDU_CMD(pipe, INFO);
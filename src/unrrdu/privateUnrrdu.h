@@ -45,6 +45,13 @@ extern "C" {
    the hack in the first place , and will inspire fixing it again */
 #define UNRRDU_QUIET_QUIT_STR "[nrrd] _nrrdRead: immediately hit EOF"
 
+/* pipe.c: the argument separating commands in "unu pipe", and the
+   stand-ins for nrrdSave() and nrrdLoad() that know about the pipe
+   (nrrdHestNrrd is also temporarily replaced while a pipe runs) */
+#define UNRRDU_PIPE_SEP "::"
+extern int _unrrduPipeSave(const char *outS, Nrrd *nout, NrrdIoState *nio);
+extern int _unrrduPipeLoad(Nrrd *nin, const char *inS, NrrdIoState *nio);
+
 /*
 ** OPT_ADD_XXX
 **
@@ -142,7 +149,7 @@ in the error messages.
   }
 
 #define SAVE(outS, nout, io) \
-  if (nrrdSave((outS), (nout), (io))) { \
+  if (_unrrduPipeSave((outS), (nout), (io))) { \
     airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways); \
     fprintf(stderr, "%s: error saving nrrd to \"%s\":\n%s\n", me, (outS), err); \
     airMopError(mop); \
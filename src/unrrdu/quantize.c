@@ -89,7 +89,9 @@ unrrdu_quantizeMain(int argc, const char **argv, const char *me,
              "or max by percentiles.  This has to be large enough so that "
              "any errant very high or very low values do not compress the "
              "interesting part of the histogram to an inscrutably small "
-             "number of bins.");
+             "number of bins. Use \"0\" to find the exact percentile "
+             "values (by sorting only the values near them) instead of "
+             "locations in the histogram.");
   hestOptAdd(&opt, "blind8", "bool", airTypeBool, 1, 1, &blind8BitRange,
              nrrdStateBlind8BitRange ? "true" : "false",
              "if not using \"-min\" or \"-max\", whether to know "
@@ -40,7 +40,7 @@ static const char *_unrrdu_rmapInfoL =
  "interpolating between map points, either scalar values "
  "(\"grayscale\"), or scanlines along axis 0 "
  "(\"color\").\n "
- "* Uses nrrdApply1DRegMap");
+ "* Uses nrrdApply1DRegMap, nrrdApply1DRegMapQuantize");
 
 int
 unrrdu_rmapMain(int argc, const char **argv, const char *me,
@@ -50,8 +50,8 @@ unrrdu_rmapMain(int argc, const char **argv, const char *me,
   Nrrd *nin, *nmap, *nout;
   airArray *mop;
   NrrdRange *range=NULL;
-  int typeOut, rescale, pret, blind8BitRange;
-  double min, max;
+  int typeOut, rescale, pret, blind8BitRange, quantize;
+  double min, max, qrange[2];
 
   hestOptAdd(&opt, "m,map", "map", airTypeOther, 1, 1, &nmap, NULL,
              "regular map to map input nrrd through",
@@ -85,6 +85,16 @@ unrrdu_rmapMain(int argc, const char **argv, const char *me,
              "By default (not using this option), the output type "
              "is the map's type.",
              NULL, NULL, &unrrduHestMaybeTypeCB);
+  hestOptAdd(&opt, "q,quantize", NULL, airTypeInt, 0, 0, &quantize, NULL,
+             "quantize the output to 8 bits while applying the map; "
+             "this gives the same values as applying the map with "
+             "\"-t double\" and then \"unu quantize -b 8\" with the "
+             "range given by \"-qr\", but faster.  The output type is "
+             "then unsigned char, regardless of \"-t\".");
+  hestOptAdd(&opt, "qr,qrange", "min max", airTypeDouble, 2, 2, qrange,
+             "nan nan",
+             "with \"-q\": range of map values to quantize.  By default, "
+             "this is the range of values in the map.");
   OPT_ADD_NIN(nin, "input nrrd");
   OPT_ADD_NOUT(out, "output nrrd");
 
@@ -118,7 +128,9 @@ unrrdu_rmapMain(int argc, const char **argv, const char *me,
   if (nrrdTypeDefault == typeOut) {
     typeOut = nmap->type;
   }
-  if (nrrdApply1DRegMap(nout, nin, range, nmap, typeOut, rescale)) {
+  if (quantize
+      ? nrrdApply1DRegMapQuantize(nout, nin, range, nmap, rescale, qrange[0], qrange[1])
+      : nrrdApply1DRegMap(nout, nin, range, nmap, typeOut, rescale)) {
     airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble applying map:\n%s", me, err);
     airMopError(mop);
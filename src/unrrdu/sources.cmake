@@ -57,6 +57,7 @@ set(UNRRDU_SOURCES
   mrmap.c
   pad.c
   permute.c
+  pipe.c
   privateUnrrdu.h
   project.c
   quantize.c
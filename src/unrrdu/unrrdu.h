@@ -175,7 +175,8 @@ F(grid) \
 F(hack) \
 F(aabplot) \
 F(undos) \
-F(save)
+F(save) \
+F(pipe)
 /* these two have been removed since no one uses them
 F(block) \
 F(unblock) \